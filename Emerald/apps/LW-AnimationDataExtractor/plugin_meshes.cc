@@ -325,6 +325,8 @@ volatile void BakeMeshGLBlobWorkerThreadEntryPoint(void* arg)
     SetActivityDescription(text_buffer);
 
     mesh_create_single_indexed_representation(arg_ptr->new_mesh);
+    mesh_optimize                            (arg_ptr->new_mesh,
+                                              MESH_OPTIMIZATION_FLAGS_ALL);
 
     /* Release data defined for data streams. It will no longer be needed for anything,
      * now that we've baked the blob */
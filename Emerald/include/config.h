@@ -14,3 +14,7 @@
 
 /* Defined if SH light editor codebase is to be included */
 /* #undef INCLUDE_SH_LIGHT_EDITOR */
+
+/* Defined if global operator new should be replaced with a version which counts the calls. The number
+ * of calls made during the last frame can then be queried from the frame arena module */
+/* #undef INCLUDE_HEAP_ALLOCATION_COUNTER */
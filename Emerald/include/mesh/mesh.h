@@ -208,11 +208,51 @@ PUBLIC EMERALD_API bool mesh_fill_ral_buffers(mesh        instance,
  */
 PUBLIC EMERALD_API void mesh_free_single_indexed_representation(mesh instance);
 
-/** TODO
+/** Generates levels of detail for all layer passes of a mesh.
+ *
+ *  Each level is created by simplifying the original triangles of each layer pass with
+ *  mesh_simplifier_simplify(), and then optimizing it for the post-transform vertex cache. Vertices which
+ *  lie on attribute seams or open borders are preserved. All levels share the vertex data of the original
+ *  mesh. Their index data is appended to the single-indexed representation, so it is uploaded by
+ *  mesh_fill_ral_buffers() and preserved by mesh_save().
+ *
+ *  Must be called after mesh_create_single_indexed_representation() and mesh_optimize() (if used), and
+ *  before mesh_fill_ral_buffers(). All layer passes must describe triangle lists.
+ *
+ *  Use mesh_get_layer_pass_lod_property() to retrieve index ranges of the generated levels, and
+ *  mesh_select_lod() to pick a level for rendering.
+ *
+ *  NOTE: Can only be called against regular meshes.
+ *
+ *  @param instance      Mesh to generate the levels of detail for.
+ *  @param n_levels      Number of levels to generate, excluding the original mesh. Must be smaller
+ *                       than MESH_MAX_LODS.
+ *  @param target_ratios @param n_levels ratios of the number of triangles each level should keep, relative
+ *                       to the original mesh. Each ratio must lie in (0, 1) and be smaller than the
+ *                       previous one. Levels may keep more triangles, if the surface cannot be simplified
+ *                       any further without touching seams or borders.
+ *
+ *  @return true if successful, false otherwise.
+ */
+PUBLIC EMERALD_API bool mesh_generate_lods(mesh         instance,
+                                           uint32_t     n_levels,
+                                           const float* target_ratios);
+
+/** Generates per-vertex normal data for all layers which do not define normals yet.
+ *
+ *  Vertices whose locations differ by no more than 1e-5 on every axis are considered shared. For each
+ *  vertex, normals of all polygons of the same layer pass which share it are averaged, as long as
+ *  the angle between them and the vertex's polygon normal does not exceed the vertex smoothing angle
+ *  of the layer pass' material.
  *
  *  NOTE: Can only be called against regular meshes.
+ *
+ *  @param mesh      Mesh to generate the normal data for.
+ *  @param weighting Tells how polygon normals should be weighted. The setting is retained and used
+ *                   whenever the normal data needs to be re-generated.
  */
-PUBLIC EMERALD_API void mesh_generate_normal_data(mesh mesh);
+PUBLIC EMERALD_API void mesh_generate_normal_data(mesh                  mesh,
+                                                  mesh_normal_weighting weighting = MESH_NORMAL_WEIGHTING_UNIFORM);
 
 /** Retrieves properties of an already added layer data stream, defined for specified mesh layer.
  *
@@ -255,6 +295,36 @@ PUBLIC EMERALD_API bool mesh_get_layer_data_stream_property(mesh
                                                             mesh_layer_data_stream_property property,
                                                             void*                           out_result_ptr);
 
+/** Retrieves a property of a level of detail of a layer pass. The following properties describe the
+ *  level's own index range:
+ *
+ *  - MESH_LAYER_PROPERTY_BO_ELEMENTS_OFFSET
+ *  - MESH_LAYER_PROPERTY_BO_ELEMENTS_DATA_MAX_INDEX
+ *  - MESH_LAYER_PROPERTY_BO_ELEMENTS_DATA_MIN_INDEX
+ *  - MESH_LAYER_PROPERTY_N_ELEMENTS
+ *  - MESH_LAYER_PROPERTY_N_TRIANGLES
+ *
+ *  All other properties are shared by all levels, and are retrieved with mesh_get_layer_pass_property().
+ *  Level 0 describes the original layer pass.
+ *
+ *  NOTE: Can only be called against regular meshes.
+ *
+ *  @param instance       Mesh to issue the query against.
+ *  @param n_layer        Index of the layer.
+ *  @param n_pass         Index of the layer pass.
+ *  @param n_lod          Level of detail. Must be smaller than MESH_PROPERTY_N_LODS.
+ *  @param property       Property to retrieve.
+ *  @param out_result_ptr Deref will be set to the property value.
+ *
+ *  @return true if successful, false otherwise.
+ */
+PUBLIC EMERALD_API bool mesh_get_layer_pass_lod_property(mesh                instance,
+                                                         uint32_t            n_layer,
+                                                         uint32_t            n_pass,
+                                                         uint32_t            n_lod,
+                                                         mesh_layer_property property,
+                                                         void*               out_result_ptr);
+
 /** TODO
  *
  *  NOTE: Can only be called against GPU stream & regular meshes.
@@ -294,6 +364,33 @@ PUBLIC EMERALD_API mesh mesh_load_with_serializer(ral_context            context
                                                   system_hash64map       material_id_to_mesh_material_map,
                                                   system_hash64map       mesh_name_to_mesh_map);
 
+/** Reorders the single-indexed representation of a mesh, so that it renders faster:
+ *
+ *  - MESH_OPTIMIZATION_FLAGS_VERTEX_CACHE reorders triangles of each layer pass to improve post-transform
+ *                                         vertex cache efficiency.
+ *  - MESH_OPTIMIZATION_FLAGS_OVERDRAW     reorders clusters of triangles of each layer pass, so that
+ *                                         triangles facing away from the mesh's center are drawn first.
+ *  - MESH_OPTIMIZATION_FLAGS_VERTEX_FETCH renumbers vertices in the order they are first used in, and
+ *                                         reorders all data streams accordingly.
+ *
+ *  The work is done on the CPU and the result only depends on the mesh contents. Since the optimized
+ *  data replaces the single-indexed representation, it is preserved by mesh_save() and the blob caches
+ *  which store the mesh in the serialized form.
+ *
+ *  Must be called after mesh_create_single_indexed_representation() and before mesh_fill_ral_buffers().
+ *  Layer passes which do not describe triangle lists are left intact.
+ *
+ *  NOTE: Can only be called against regular meshes.
+ *
+ *  @param instance           Mesh to optimize.
+ *  @param flags              Optimization passes to run.
+ *  @param out_statistics_ptr If not NULL, deref will be filled with post-transform vertex cache efficiency
+ *                            of all layer passes, before and after the optimization.
+ */
+PUBLIC EMERALD_API void mesh_optimize(mesh                          instance,
+                                      mesh_optimization_flags       flags,
+                                      mesh_optimization_statistics* out_statistics_ptr = nullptr);
+
 /** TODO
  *
  *  NOTE: Can only be called against regular meshes.
@@ -316,6 +413,22 @@ PUBLIC EMERALD_API bool mesh_save_with_serializer(mesh                   instanc
                                                   system_file_serializer serializer,
                                                   system_hash64map       mesh_material_to_id_map);
 
+/** Picks the coarsest level of detail, whose error does not exceed the specified screen-space error.
+ *
+ *  If the mesh is instantiated, levels of detail of the instantiation parent are considered.
+ *
+ *  NOTE: Can only be called against regular meshes.
+ *
+ *  @param instance               Mesh to pick the level of detail for.
+ *  @param model_to_screen_scale  Number of pixels a model-space unit covers on screen at the mesh's location.
+ *  @param max_screen_space_error Maximum error allowed, in pixels.
+ *
+ *  @return Index of the level of detail to use. 0 stands for the original mesh.
+ */
+PUBLIC EMERALD_API uint32_t mesh_select_lod(mesh  instance,
+                                            float model_to_screen_scale,
+                                            float max_screen_space_error);
+
 /** TODO.
  *
  *  Releases any layer/layer pass data that was set for the mesh and marks the mesh
@@ -387,6 +500,18 @@ PUBLIC EMERALD_API void mesh_set_layer_property(mesh                instance,
                                                 mesh_layer_property property,
                                                 const void*         data);
 
+/** Configures the encoding mesh_save() should use to store data of the specified stream. The stream is
+ *  always decoded back to floats at load time.
+ *
+ *  The encoding must be supported for the number of components the stream uses, see
+ *  mesh_codec_is_stream_encoding_supported().
+ *
+ *  NOTE: Can only be called against regular meshes.
+ */
+PUBLIC EMERALD_API void mesh_set_processed_data_stream_encoding(mesh                            mesh,
+                                                                mesh_layer_data_stream_type     stream_type,
+                                                                mesh_layer_data_stream_encoding encoding);
+
 /** TODO
  *
  *  NOTE: Can only be called against regular meshes.
@@ -0,0 +1,105 @@
+/**
+ *
+ * Emerald (kbi/elude @2016)
+ *
+ * Encoders & decoders for the compact representation of mesh data, as used by the mesh file format.
+ *
+ * Vertex data streams are encoded as described by mesh_layer_data_stream_encoding. Index data is encoded
+ * as described by mesh_index_encoding. Decoders walk the encoded data once, front to back, and write the
+ * results directly into the destination buffer, so they can work on memory-mapped files without any
+ * intermediate copies.
+ */
+#ifndef MESH_CODEC_H
+#define MESH_CODEC_H
+
+#include "mesh/mesh_types.h"
+
+
+/** Decodes index data encoded with mesh_codec_encode_indices().
+ *
+ *  @param encoding          Encoding used for the data.
+ *  @param encoded_data      Encoded data.
+ *  @param encoded_data_size Number of bytes available in @param encoded_data.
+ *  @param n_indices         Number of indices to decode.
+ *  @param index_size        Size of a single decoded index. Must be 1, 2 or 4.
+ *  @param out_index_data    Deref will be filled with @param n_indices indices, each @param index_size
+ *                           bytes long.
+ *
+ *  @return Number of bytes consumed, or 0 if the encoded data is corrupt.
+ */
+PUBLIC EMERALD_API uint32_t mesh_codec_decode_indices(mesh_index_encoding  encoding,
+                                                      const unsigned char* encoded_data,
+                                                      uint32_t             encoded_data_size,
+                                                      uint32_t             n_indices,
+                                                      uint32_t             index_size,
+                                                      void*                out_index_data);
+
+/** Decodes a data stream encoded with mesh_codec_encode_stream().
+ *
+ *  @param encoding          Encoding used for the data.
+ *  @param encoded_data      Encoded data.
+ *  @param encoded_data_size Number of bytes available in @param encoded_data.
+ *  @param n_components      Number of components per item.
+ *  @param n_items           Number of items to decode.
+ *  @param out_stride        Distance between consecutive decoded items, in bytes.
+ *  @param out_data          Deref will be filled with @param n_items items, each described by
+ *                           @param n_components floats.
+ *
+ *  @return Number of bytes consumed, or 0 if the encoded data is corrupt.
+ */
+PUBLIC EMERALD_API uint32_t mesh_codec_decode_stream(mesh_layer_data_stream_encoding encoding,
+                                                     const unsigned char*            encoded_data,
+                                                     uint32_t                        encoded_data_size,
+                                                     uint32_t                        n_components,
+                                                     uint32_t                        n_items,
+                                                     uint32_t                        out_stride,
+                                                     float*                          out_data);
+
+/** Encodes index data.
+ *
+ *  @param encoding   Encoding to use.
+ *  @param index_data Indices to encode, each @param index_size bytes long.
+ *  @param index_size Size of a single index. Must be 1, 2 or 4.
+ *  @param n_indices  Number of indices to encode.
+ *  @param out_data   Deref will be filled with the encoded data. Can be NULL, in which case only the size
+ *                    of the encoded data is calculated.
+ *
+ *  @return Number of bytes needed to hold the encoded data.
+ */
+PUBLIC EMERALD_API uint32_t mesh_codec_encode_indices(mesh_index_encoding encoding,
+                                                      const void*         index_data,
+                                                      uint32_t            index_size,
+                                                      uint32_t            n_indices,
+                                                      unsigned char*      out_data);
+
+/** Encodes a data stream.
+ *
+ *  @param encoding     Encoding to use. Must be supported for @param n_components, see
+ *                      mesh_codec_is_stream_encoding_supported().
+ *  @param data         Data to encode.
+ *  @param n_components Number of components per item.
+ *  @param n_items      Number of items to encode.
+ *  @param stride       Distance between consecutive items in @param data, in bytes.
+ *  @param out_data     Deref will be filled with the encoded data. Can be NULL, in which case only the size
+ *                      of the encoded data is calculated.
+ *
+ *  @return Number of bytes needed to hold the encoded data.
+ */
+PUBLIC EMERALD_API uint32_t mesh_codec_encode_stream(mesh_layer_data_stream_encoding encoding,
+                                                     const float*                    data,
+                                                     uint32_t                        n_components,
+                                                     uint32_t                        n_items,
+                                                     uint32_t                        stride,
+                                                     unsigned char*                  out_data);
+
+/** Tells whether a stream encoding can be used for items built of the specified number of components.
+ *
+ *  @param encoding     Encoding to check.
+ *  @param n_components Number of components per item.
+ *
+ *  @return true if the encoding is supported, false otherwise.
+ */
+PUBLIC EMERALD_API bool mesh_codec_is_stream_encoding_supported(mesh_layer_data_stream_encoding encoding,
+                                                                uint32_t                        n_components);
+
+#endif /* MESH_CODEC_H */
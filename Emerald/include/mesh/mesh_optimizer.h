@@ -0,0 +1,88 @@
+/**
+ *
+ * Emerald (kbi/elude @2016)
+ *
+ * Reordering routines for indexed triangle lists, which make them cheaper to render:
+ *
+ * - vertex cache optimization reorders triangles, so that vertices tend to be reused while they are
+ *   still held in the post-transform cache. Tom Forsyth's linear-speed algorithm is used.
+ * - overdraw optimization splits a triangle list into clusters, which do not notably hurt cache
+ *   efficiency, and sorts them so that clusters facing away from the center of the mesh are drawn
+ *   first. This follows Sander et al.'s "Fast triangle reordering for vertex locality and reduced
+ *   overdraw".
+ * - vertex fetch optimization renumbers vertices in the order in which they are first used.
+ *
+ * All routines run on the CPU and are deterministic.
+ */
+#ifndef MESH_OPTIMIZER_H
+#define MESH_OPTIMIZER_H
+
+#include "mesh/mesh_types.h"
+
+/* Size of the FIFO post-transform vertex cache simulated by mesh_optimizer_get_vertex_cache_statistics() */
+#define MESH_OPTIMIZER_FIFO_CACHE_SIZE (16)
+
+/** Simulates a FIFO post-transform vertex cache of MESH_OPTIMIZER_FIFO_CACHE_SIZE entries for a triangle
+ *  list. Average cache miss ratio (ACMR) can then be calculated as the number of transformed vertices
+ *  divided by the number of triangles. Average transformed vertex ratio (ATVR) is the number of transformed
+ *  vertices divided by the number of used vertices. Both values are 1.0 for the perfect ordering.
+ *
+ *  @param index_data                     Triangle list indices.
+ *  @param n_indices                      Number of indices. Must be a multiple of 3.
+ *  @param n_vertices                     Number of vertices. All indices must be smaller than this value.
+ *  @param out_n_transformed_vertices_ptr Deref will be set to the number of vertices which would need to
+ *                                        be transformed, if the list was drawn. Must not be NULL.
+ *  @param out_n_used_vertices_ptr        Deref will be set to the number of unique vertices used by the
+ *                                        list. Must not be NULL.
+ */
+PUBLIC EMERALD_API void mesh_optimizer_get_vertex_cache_statistics(const uint32_t* index_data,
+                                                                   uint32_t        n_indices,
+                                                                   uint32_t        n_vertices,
+                                                                   uint32_t*       out_n_transformed_vertices_ptr,
+                                                                   uint32_t*       out_n_used_vertices_ptr);
+
+/** Builds a vertex remapping table, which renumbers vertices in the order in which they are first used
+ *  by a triangle list. Vertices which are not used at all are moved to the end, retaining their order.
+ *
+ *  @param index_data Triangle list indices.
+ *  @param n_indices  Number of indices.
+ *  @param n_vertices Number of vertices. All indices must be smaller than this value.
+ *  @param out_remap  Deref will be filled with the new index of each vertex. Must be able to hold
+ *                    @param n_vertices entries.
+ *
+ *  @return Number of vertices used by the triangle list.
+ */
+PUBLIC EMERALD_API uint32_t mesh_optimizer_get_vertex_fetch_remap(const uint32_t* index_data,
+                                                                  uint32_t        n_indices,
+                                                                  uint32_t        n_vertices,
+                                                                  uint32_t*       out_remap);
+
+/** Reorders triangles to reduce overdraw. Should be called after mesh_optimizer_optimize_vertex_cache(),
+ *  since clusters are formed by looking at the existing triangle order.
+ *
+ *  @param index_data    Triangle list indices. Will be reordered in place.
+ *  @param n_indices     Number of indices. Must be a multiple of 3.
+ *  @param n_vertices    Number of vertices. All indices must be smaller than this value.
+ *  @param vertex_data   Vertex locations. Each vertex is described by 3 floats.
+ *  @param vertex_stride Distance between consecutive vertex locations, in bytes.
+ *  @param threshold     Maximum ratio by which each cluster's ACMR may grow, as a result of the mesh being
+ *                       split into smaller clusters. 1.05 is a good default.
+ */
+PUBLIC EMERALD_API void mesh_optimizer_optimize_overdraw(uint32_t*    index_data,
+                                                         uint32_t     n_indices,
+                                                         uint32_t     n_vertices,
+                                                         const float* vertex_data,
+                                                         uint32_t     vertex_stride,
+                                                         float        threshold);
+
+/** Reorders triangles, so that the post-transform vertex cache is used efficiently.
+ *
+ *  @param index_data Triangle list indices. Will be reordered in place.
+ *  @param n_indices  Number of indices. Must be a multiple of 3.
+ *  @param n_vertices Number of vertices. All indices must be smaller than this value.
+ */
+PUBLIC EMERALD_API void mesh_optimizer_optimize_vertex_cache(uint32_t* index_data,
+                                                             uint32_t  n_indices,
+                                                             uint32_t  n_vertices);
+
+#endif /* MESH_OPTIMIZER_H */
@@ -0,0 +1,50 @@
+/**
+ *
+ * Emerald (kbi/elude @2016)
+ *
+ * Triangle list simplification, used to generate levels of detail of regular meshes.
+ *
+ * Edges are collapsed in the order of increasing quadric error, as described in Garland & Heckbert's
+ * "Surface Simplification Using Quadric Error Metrics". A vertex is always collapsed onto one of its
+ * neighbours, so the simplified triangle list refers to a subset of the original vertices and can share
+ * vertex data with the original list.
+ *
+ * Vertices whose location is shared with other vertices (which is how attribute seams, eg. UV or normal
+ * discontinuities, are represented in single-indexed data) and vertices lying on open borders are never
+ * removed. Collapses which would flip triangles or make the surface non-manifold are rejected.
+ *
+ * All routines run on the CPU and are deterministic.
+ */
+#ifndef MESH_SIMPLIFIER_H
+#define MESH_SIMPLIFIER_H
+
+#include "mesh/mesh_types.h"
+
+
+/** Simplifies a triangle list.
+ *
+ *  @param index_data       Triangle list indices.
+ *  @param n_indices        Number of indices. Must be a multiple of 3.
+ *  @param n_vertices       Number of vertices. All indices must be smaller than this value.
+ *  @param vertex_data      Vertex locations. Each vertex is described by 3 floats.
+ *  @param vertex_stride    Distance between consecutive vertex locations, in bytes.
+ *  @param target_n_indices Number of indices the simplified triangle list should not exceed. The result
+ *                          may use more indices, if no more edges can be collapsed.
+ *  @param out_index_data   Deref will be filled with the simplified triangle list. Must be able to hold
+ *                          @param n_indices entries. Can be the same as @param index_data.
+ *  @param out_error_ptr    If not NULL, deref will be set to the maximum distance between a vertex of the
+ *                          simplified triangle list and the planes of the original triangles it replaces,
+ *                          in the units used by @param vertex_data.
+ *
+ *  @return Number of indices written to @param out_index_data.
+ */
+PUBLIC EMERALD_API uint32_t mesh_simplifier_simplify(const uint32_t* index_data,
+                                                     uint32_t        n_indices,
+                                                     uint32_t        n_vertices,
+                                                     const float*    vertex_data,
+                                                     uint32_t        vertex_stride,
+                                                     uint32_t        target_n_indices,
+                                                     uint32_t*       out_index_data,
+                                                     float*          out_error_ptr);
+
+#endif /* MESH_SIMPLIFIER_H */
@@ -57,6 +57,13 @@ typedef enum
     /* not settable, _mesh_index_type */
     MESH_PROPERTY_BO_INDEX_TYPE,
 
+    /* settable, mesh_index_encoding.
+     *
+     * Tells how index data should be encoded by mesh_save(). Only used for regular meshes.
+     *
+     * Default value: MESH_INDEX_ENCODING_RAW */
+    MESH_PROPERTY_BO_INDEX_ENCODING,
+
     /* not settable, void* */
     MESH_PROPERTY_BO_PROCESSED_DATA,
 
@@ -96,6 +103,14 @@ typedef enum
      */
     MESH_PROPERTY_GET_PRESENT_TASK_FOR_CUSTOM_MESH_FUNC_USER_ARG,
 
+    /* not settable, const float*
+     *
+     * Holds MESH_PROPERTY_N_LODS entries. Entry n tells the maximum distance between the surface
+     * described by LOD n and the original surface, in model space units. Entry 0 is always 0.
+     *
+     * Only used for regular meshes. */
+    MESH_PROPERTY_LOD_ERRORS,
+
     /* not settable, system_resizable_vector - DO NOT MODIFY OR RELEASE */
     MESH_PROPERTY_MATERIALS,
 
@@ -108,6 +123,12 @@ typedef enum
     /* not settable, uint32_t */
     MESH_PROPERTY_N_LAYERS,
 
+    /* not settable, uint32_t
+     *
+     * Number of levels of detail, including the original mesh. Equal to 1, unless
+     * mesh_generate_lods() has been called for the mesh. */
+    MESH_PROPERTY_N_LODS,
+
     /* settable ONCE, uint32_t */
     MESH_PROPERTY_N_SH_BANDS,
 
@@ -147,6 +168,13 @@ typedef enum
      */
     MESH_LAYER_DATA_STREAM_PROPERTY_BUFFER_RAL_STRIDE,
 
+    /* not settable, mesh_layer_data_stream_encoding.
+     *
+     * Only used by regular meshes. The value is shared by all layers. Use
+     * mesh_set_processed_data_stream_encoding() to change it.
+     */
+    MESH_LAYER_DATA_STREAM_PROPERTY_ENCODING,
+
     /* not settable, uint32_t */
     MESH_LAYER_DATA_STREAM_PROPERTY_N_COMPONENTS,
 
@@ -246,6 +274,49 @@ typedef enum
     MESH_LAYER_DATA_STREAM_DATA_TYPE_UNKNOWN
 } mesh_layer_data_stream_data_type;
 
+/* Tells how a data stream of a regular mesh is encoded, when the mesh is saved. Stream data is always
+ * decoded back to 32-bit floats when the mesh is loaded.
+ *
+ * NOTE: Re-arranging the order of the enums invalidates mesh files which use the encodings.
+ */
+typedef enum
+{
+    /* 32-bit floats. Lossless. Default. */
+    MESH_LAYER_DATA_STREAM_ENCODING_FLOAT,
+
+    /* 16-bit floats. Values out of the half-float range are clamped to infinity. */
+    MESH_LAYER_DATA_STREAM_ENCODING_HALF_FLOAT,
+
+    /* 16-bit signed normalized values, relative to the bounding box of the stream data. The bounding box
+     * is stored alongside the encoded values. */
+    MESH_LAYER_DATA_STREAM_ENCODING_SNORM16_BOUNDS,
+
+    /* Unit vectors, mapped to an octahedron and stored as two 16-bit signed normalized values. Only
+     * supported for 3-component streams. Decoded vectors are always normalized. */
+    MESH_LAYER_DATA_STREAM_ENCODING_OCTAHEDRAL_SNORM16,
+
+    /* Always last */
+    MESH_LAYER_DATA_STREAM_ENCODING_COUNT
+} mesh_layer_data_stream_encoding;
+
+/* Tells how index data of a regular mesh is encoded, when the mesh is saved.
+ *
+ * NOTE: Re-arranging the order of the enums invalidates mesh files which use the encodings.
+ */
+typedef enum
+{
+    /* Indices are stored as they are. Default. */
+    MESH_INDEX_ENCODING_RAW,
+
+    /* Differences between consecutive indices are stored as zigzag-encoded variable-length integers
+     * (7 bits per byte). Works best for indices which refer to vertices stored in the order of first
+     * use, see mesh_optimize(). */
+    MESH_INDEX_ENCODING_DELTA_VARINT,
+
+    /* Always last */
+    MESH_INDEX_ENCODING_COUNT
+} mesh_index_encoding;
+
 typedef enum
 {
     /** NOTE: Re-arranging the order oir adding new stream types invalidates COLLADA mesh blobs.
@@ -282,6 +353,20 @@ typedef enum
     MESH_TYPE_UNKNOWN
 } mesh_type;
 
+/* Tells how normals of the polygons sharing a vertex are weighted, when they are averaged
+ * to form the vertex normal. */
+typedef enum
+{
+    /* All polygons contribute equally. */
+    MESH_NORMAL_WEIGHTING_UNIFORM,
+
+    /* Polygons contribute proportionally to their area. */
+    MESH_NORMAL_WEIGHTING_AREA,
+
+    /* Polygons contribute proportionally to the angle they span at the vertex. */
+    MESH_NORMAL_WEIGHTING_ANGLE,
+} mesh_normal_weighting;
+
 typedef enum
 {
     MESH_VERTEX_ORDERING_CW,
@@ -300,6 +385,36 @@ const int MESH_CREATION_FLAGS_SAVE_SUPPORT              = 0x1;
 const int MESH_CREATION_FLAGS_KDTREE_GENERATION_SUPPORT = 0x2;
 const int MESH_CREATION_FLAGS_LOAD_ASYNC                = 0x4;
 
+/* Maximum number of levels of detail a mesh can hold, including the original mesh. */
+const int MESH_MAX_LODS = 8;
+
+/* Mesh optimization flags. Tell which passes mesh_optimize() should run. */
+typedef int mesh_optimization_flags;
+
+/* Reorders triangles of each layer pass, so that the post-transform vertex cache is used efficiently. */
+const int MESH_OPTIMIZATION_FLAGS_VERTEX_CACHE = 0x1;
+/* Reorders clusters of triangles of each layer pass, so that fewer fragments get overdrawn. */
+const int MESH_OPTIMIZATION_FLAGS_OVERDRAW     = 0x2;
+/* Reorders vertex data in the order in which vertices are first used by the index data. */
+const int MESH_OPTIMIZATION_FLAGS_VERTEX_FETCH = 0x4;
+
+const int MESH_OPTIMIZATION_FLAGS_ALL          = MESH_OPTIMIZATION_FLAGS_VERTEX_CACHE |
+                                                 MESH_OPTIMIZATION_FLAGS_OVERDRAW     |
+                                                 MESH_OPTIMIZATION_FLAGS_VERTEX_FETCH;
+
+/* Post-transform vertex cache efficiency, as reported by mesh_optimize().
+ *
+ * ACMR (average cache miss ratio) is the number of transformed vertices per triangle.
+ * ATVR (average transformed vertex ratio) is the number of transformed vertices per used vertex.
+ */
+typedef struct
+{
+    float acmr_after;
+    float acmr_before;
+    float atvr_after;
+    float atvr_before;
+} mesh_optimization_statistics;
+
 typedef uint32_t mesh_layer_id;
 typedef uint32_t mesh_layer_pass_id;
 
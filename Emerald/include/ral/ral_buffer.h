@@ -47,16 +47,17 @@ typedef struct ral_buffer_clear_region_callback_arg
 
 typedef struct ral_buffer_client_sourced_update_info_callback_arg
 {
-    bool                                                                 async;
-    ral_buffer                                                           buffer;
-    bool                                                                 sync_other_contexts;
-    std::vector<std::shared_ptr<ral_buffer_client_sourced_update_info> > updates;
+    bool                                                                        async;
+    ral_buffer                                                                  buffer;
+    bool                                                                        sync_other_contexts;
+    const std::vector<std::shared_ptr<ral_buffer_client_sourced_update_info> >* updates; /* owned by the caller; only valid for the duration of the call-back */
 
     ral_buffer_client_sourced_update_info_callback_arg()
     {
         async               = false;
         buffer              = NULL;
         sync_other_contexts = false;
+        updates             = NULL;
     }
 } ral_buffer_client_sourced_update_info_callback_arg;
 
@@ -145,9 +146,9 @@ PUBLIC EMERALD_API void ral_buffer_get_property(const ral_buffer    buffer,
 PUBLIC void ral_buffer_release(ral_buffer& buffer);
 
 /** TODO */
-PUBLIC EMERALD_API bool ral_buffer_set_data_from_client_memory(ral_buffer                                                           buffer,
-                                                               std::vector<std::shared_ptr<ral_buffer_client_sourced_update_info> > updates,
-                                                               bool                                                                 async,
-                                                               bool                                                                 sync_other_contexts);
+PUBLIC EMERALD_API bool ral_buffer_set_data_from_client_memory(ral_buffer                                                                  buffer,
+                                                               const std::vector<std::shared_ptr<ral_buffer_client_sourced_update_info> >& updates,
+                                                               bool                                                                        async,
+                                                               bool                                                                        sync_other_contexts);
 
 #endif /* RAL_BUFFER_H */
\ No newline at end of file
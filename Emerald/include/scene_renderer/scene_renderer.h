@@ -34,6 +34,14 @@ typedef enum
     /* general property; scene_graph */
     SCENE_RENDERER_PROPERTY_GRAPH,
 
+    /* general property; float.
+     *
+     * Maximum screen-space error, in pixels, a mesh level of detail may introduce. Regular meshes are drawn
+     * using the coarsest level of detail which meets the requirement. Also see mesh_select_lod().
+     *
+     * Default value: 1.0. Settable. */
+    SCENE_RENDERER_PROPERTY_LOD_MAX_SCREEN_SPACE_ERROR,
+
     /* indexed property; key: mesh id // value: mesh */
     SCENE_RENDERER_PROPERTY_MESH_INSTANCE,
 
@@ -216,6 +216,8 @@ PUBLIC void scene_renderer_uber_link(scene_renderer_uber uber);
 
 /** TODO.
  *
+ *  @param n_lod Level of detail to draw regular meshes with. Must be smaller than the mesh's
+ *               MESH_PROPERTY_N_LODS value. Pass 0 to use the original mesh.
  **/
 PUBLIC void scene_renderer_uber_render_mesh(mesh                             mesh_gpu,
                                             system_matrix4x4                 model,
@@ -223,6 +225,7 @@ PUBLIC void scene_renderer_uber_render_mesh(mesh                             mes
                                             scene_renderer_uber              uber,
                                             mesh_material                    material,
                                             system_time                      time,
+                                            uint32_t                         n_lod,
                                             const ral_gfx_state_create_info* ref_gfx_state_create_info_ptr);
 
 /** TODO */
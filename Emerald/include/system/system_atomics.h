@@ -75,5 +75,193 @@ inline unsigned int system_atomics_increment(volatile unsigned int* value_ptr)
     return previous_value;
 }
 
+/** Atomically replaces *value_ptr with new_value, if *value_ptr equals expected_value.
+ *  Acts as a full memory barrier.
+ *
+ *  @return true if the exchange took place, false otherwise.
+ */
+inline bool system_atomics_compare_exchange(volatile unsigned int* value_ptr,
+                                            unsigned int           expected_value,
+                                            unsigned int           new_value)
+{
+    bool result;
+
+    #ifdef _WIN32
+    {
+        result = (::InterlockedCompareExchange((volatile LONG*) value_ptr,
+                                               (LONG)           new_value,
+                                               (LONG)           expected_value) == (LONG) expected_value);
+    }
+    #else
+    {
+        result = __sync_bool_compare_and_swap(value_ptr,
+                                              expected_value,
+                                              new_value);
+    }
+    #endif
+
+    return result;
+}
+
+/** 64-bit flavour of system_atomics_compare_exchange() */
+inline bool system_atomics_compare_exchange_uint64(volatile __uint64* value_ptr,
+                                                   __uint64           expected_value,
+                                                   __uint64           new_value)
+{
+    bool result;
+
+    #ifdef _WIN32
+    {
+        result = (::InterlockedCompareExchange64((volatile LONGLONG*) value_ptr,
+                                                 (LONGLONG)           new_value,
+                                                 (LONGLONG)           expected_value) == (LONGLONG) expected_value);
+    }
+    #else
+    {
+        result = __sync_bool_compare_and_swap(value_ptr,
+                                              expected_value,
+                                              new_value);
+    }
+    #endif
+
+    return result;
+}
+
+/** Pointer flavour of system_atomics_compare_exchange() */
+inline bool system_atomics_compare_exchange_pointer(void* volatile* value_ptr,
+                                                    void*           expected_value,
+                                                    void*           new_value)
+{
+    bool result;
+
+    #ifdef _WIN32
+    {
+        result = (::InterlockedCompareExchangePointer(value_ptr,
+                                                      new_value,
+                                                      expected_value) == expected_value);
+    }
+    #else
+    {
+        result = __sync_bool_compare_and_swap(value_ptr,
+                                              expected_value,
+                                              new_value);
+    }
+    #endif
+
+    return result;
+}
+
+/** Issues a full (sequentially consistent) memory barrier. */
+inline void system_atomics_memory_barrier()
+{
+    #ifdef _WIN32
+    {
+        ::MemoryBarrier();
+    }
+    #else
+    {
+        __sync_synchronize();
+    }
+    #endif
+}
+
+/** Reads *value_ptr with acquire semantics. */
+inline unsigned int system_atomics_load_acquire(volatile unsigned int* value_ptr)
+{
+    unsigned int result;
+
+    #ifdef _WIN32
+    {
+        /* MSVC guarantees acquire semantics for volatile reads */
+        result = *value_ptr;
+    }
+    #else
+    {
+        result = __atomic_load_n(value_ptr,
+                                 __ATOMIC_ACQUIRE);
+    }
+    #endif
+
+    return result;
+}
+
+/** 64-bit flavour of system_atomics_load_acquire().
+ *
+ *  NOTE: On 32-bit targets, the two halves of the value may be read separately. Only use this function
+ *        to obtain the expected value for a subsequent system_atomics_compare_exchange_uint64() call.
+ */
+inline __uint64 system_atomics_load_acquire_uint64(volatile __uint64* value_ptr)
+{
+    __uint64 result;
+
+    #ifdef _WIN32
+    {
+        result = *value_ptr;
+    }
+    #else
+    {
+        result = __atomic_load_n(value_ptr,
+                                 __ATOMIC_ACQUIRE);
+    }
+    #endif
+
+    return result;
+}
+
+/** Pointer flavour of system_atomics_load_acquire(). */
+inline void* system_atomics_load_acquire_pointer(void* volatile* value_ptr)
+{
+    void* result;
+
+    #ifdef _WIN32
+    {
+        result = *value_ptr;
+    }
+    #else
+    {
+        result = __atomic_load_n(value_ptr,
+                                 __ATOMIC_ACQUIRE);
+    }
+    #endif
+
+    return result;
+}
+
+/** Writes new_value to *value_ptr with release semantics. */
+inline void system_atomics_store_release(volatile unsigned int* value_ptr,
+                                         unsigned int           new_value)
+{
+    #ifdef _WIN32
+    {
+        /* MSVC guarantees release semantics for volatile writes */
+        *value_ptr = new_value;
+    }
+    #else
+    {
+        __atomic_store_n(value_ptr,
+                         new_value,
+                         __ATOMIC_RELEASE);
+    }
+    #endif
+}
+
+
+/** Pointer flavour of system_atomics_store_release(). */
+inline void system_atomics_store_release_pointer(void* volatile* value_ptr,
+                                                 void*           new_value)
+{
+    #ifdef _WIN32
+    {
+        *value_ptr = new_value;
+    }
+    #else
+    {
+        __atomic_store_n(value_ptr,
+                         new_value,
+                         __ATOMIC_RELEASE);
+    }
+    #endif
+}
+
 
 #endif /* SYSTEM_ATOMICS_H */
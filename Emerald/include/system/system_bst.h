@@ -2,6 +2,11 @@
  *
  * Emerald (kbi/elude @2012-2015)
  *
+ * Ordered key->value map. Internally, the data is stored in a B-tree, so the tree stays balanced regardless
+ * of the order in which the keys are inserted. Keys and values are copied into the tree's nodes, which are
+ * taken from a pooled allocator.
+ *
+ * Concurrent system_bst_get() calls are safe, as long as no other thread inserts into the tree at the same time.
  */
 #ifndef SYSTEM_BST_H
 #define SYSTEM_BST_H
@@ -9,7 +14,18 @@
 #include "system_types.h"
 
 
-/** TODO */
+/** Creates a new BST instance, which uses user-provided functions to compare keys.
+ *
+ *  @param key_size        Size of a single key, in bytes.
+ *  @param value_size      Size of a single value, in bytes.
+ *  @param key_lower_func  Function which should return true if the first key is lower than the second one.
+ *                         Must define a strict weak ordering.
+ *  @param key_equals_func Function which should return true if both keys are equal.
+ *  @param initial_key     First key to store in the tree.
+ *  @param initial_value   Value to associate with @param initial_key.
+ *
+ *  @return BST instance.
+ */
 PUBLIC EMERALD_API system_bst system_bst_create(size_t                       key_size,
                                                 size_t                       value_size,
                                                 system_bst_value_lower_func  key_lower_func,
@@ -17,17 +33,50 @@ PUBLIC EMERALD_API system_bst system_bst_create(size_t                       key
                                                 system_bst_key               initial_key,
                                                 system_bst_value             initial_value);
 
-/** TODO */
+/** Creates a new BST instance for keys of one of the built-in types. Comparisons of such keys are inlined,
+ *  so this function should be preferred over system_bst_create() whenever possible.
+ *
+ *  @param key_type      Type of the keys. Must not be SYSTEM_BST_KEY_TYPE_CUSTOM.
+ *  @param key_size      Size of a single key, in bytes. Must be a multiple of the array component's size.
+ *  @param value_size    Size of a single value, in bytes.
+ *  @param initial_key   First key to store in the tree.
+ *  @param initial_value Value to associate with @param initial_key.
+ *
+ *  @return BST instance.
+ */
+PUBLIC EMERALD_API system_bst system_bst_create_for_key_type(system_bst_key_type key_type,
+                                                             size_t              key_size,
+                                                             size_t              value_size,
+                                                             system_bst_key      initial_key,
+                                                             system_bst_value    initial_value);
+
+/** Looks up a value associated with the specified key.
+ *
+ *  @param bst   BST instance.
+ *  @param key   Key to look for.
+ *  @param value If not NULL and the key is found, the value will be copied to the buffer under this location.
+ *
+ *  @return true if the key was found, false otherwise.
+ */
 PUBLIC EMERALD_API bool system_bst_get(system_bst        bst,
                                        system_bst_key    key,
                                        system_bst_value* value);
 
-/** TODO */
+/** Stores a new key->value pair in the tree. If the key is already stored in the tree, the call is a nop
+ *  and the value associated with the key earlier is retained.
+ *
+ *  @param bst   BST instance.
+ *  @param key   Key to insert.
+ *  @param value Value to associate with @param key.
+ */
 PUBLIC EMERALD_API void system_bst_insert(system_bst       bst,
                                           system_bst_key   key,
                                           system_bst_value value);
 
-/** TODO */
+/** Releases a BST instance.
+ *
+ *  @param bst BST instance to release.
+ */
 PUBLIC EMERALD_API void system_bst_release(system_bst bst);
 
 #endif /* SYSTEM_BST_H */
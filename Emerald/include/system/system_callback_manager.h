@@ -31,23 +31,74 @@ typedef enum
     CALLBACK_SYNCHRONICITY_UNKNOWN
 } _callback_synchronicity;
 
+typedef enum
+{
+    /* settable, bool. Default value: false.
+     *
+     * If true, an asynchronous notification is dropped if an identical notification (carrying the same
+     * callback_proc_data contents) is still waiting to be executed by the thread pool. This collapses
+     * bursts of repeated notifications, e.g. within a single frame, into a single dispatch.
+     *
+     * Synchronous subscribers are always called back.
+     */
+    SYSTEM_CALLBACK_MANAGER_CALLBACK_PROPERTY_COALESCE_ASYNC_CALLS,
+
+    /* not settable, __uint64.
+     *
+     * Highest number of microseconds which passed between a call-back and the moment its asynchronous
+     * dispatch started executing.
+     */
+    SYSTEM_CALLBACK_MANAGER_CALLBACK_PROPERTY_MAX_ASYNC_LATENCY_USEC,
+
+    /* not settable, __uint64.
+     *
+     * Number of asynchronous dispatches submitted to the thread pool. A single dispatch calls back all
+     * asynchronous subscribers.
+     */
+    SYSTEM_CALLBACK_MANAGER_CALLBACK_PROPERTY_N_ASYNC_DISPATCHES,
+
+    /* not settable, __uint64. Number of times asynchronous subscribers have been called back. */
+    SYSTEM_CALLBACK_MANAGER_CALLBACK_PROPERTY_N_ASYNC_INVOCATIONS,
+
+    /* not settable, __uint64. Number of system_callback_manager_call_back() calls made for the callback ID. */
+    SYSTEM_CALLBACK_MANAGER_CALLBACK_PROPERTY_N_CALLS,
+
+    /* not settable, __uint64. Number of asynchronous dispatches dropped due to coalescing. */
+    SYSTEM_CALLBACK_MANAGER_CALLBACK_PROPERTY_N_COALESCED_CALLS,
+
+    /* not settable, __uint64. Number of times synchronous subscribers have been called back. */
+    SYSTEM_CALLBACK_MANAGER_CALLBACK_PROPERTY_N_SYNC_INVOCATIONS,
+
+    /* not settable, __uint64.
+     *
+     * Total number of microseconds which passed between call-backs and the moments their asynchronous
+     * dispatches started executing. Divide by N_ASYNC_DISPATCHES to get the average latency.
+     */
+    SYSTEM_CALLBACK_MANAGER_CALLBACK_PROPERTY_TOTAL_ASYNC_LATENCY_USEC
+} system_callback_manager_callback_property;
+
 /** Defines a call-back function pointer type */
 typedef void (*PFNSYSTEMCALLBACKPROC)(const void* callback_data,
                                             void* user_arg);
 
-/** TODO.
+/** Calls back all subscribers of the specified callback ID.
+ *
+ *  Synchronous subscribers are called back from within this function. All asynchronous subscribers are
+ *  called back, one after another, from a single thread pool task. Subscriptions are read from an immutable
+ *  snapshot, so this function does not lock, and subscribers are free to (un)subscribe from within
+ *  their call-back handlers.
  *
  *  Internal usage only.
  **/
-PUBLIC void system_callback_manager_call_back(system_callback_manager callback_manager,
-                                              int                     callback_id,
-                                              const void*             callback_proc_data);
+PUBLIC EMERALD_API void system_callback_manager_call_back(system_callback_manager callback_manager,
+                                                          int                     callback_id,
+                                                          const void*             callback_proc_data);
 
-/** TODO.
+/** Creates a new call-back manager.
  *
  *  Internal usage only.
  **/
-PUBLIC system_callback_manager system_callback_manager_create(_callback_id max_callback_id);
+PUBLIC EMERALD_API system_callback_manager system_callback_manager_create(_callback_id max_callback_id);
 
 /** TODO */
 PUBLIC void system_callback_manager_deinit();
@@ -55,6 +106,18 @@ PUBLIC void system_callback_manager_deinit();
 /** TODO */
 PUBLIC EMERALD_API system_callback_manager system_callback_manager_get();
 
+/** Retrieves a property value of the specified callback ID.
+ *
+ *  @param callback_manager Callback manager to use.
+ *  @param callback_id      Callback ID to use.
+ *  @param property         Property to query.
+ *  @param out_result_ptr   Deref will be set to the requested value. Must not be NULL.
+ */
+PUBLIC EMERALD_API void system_callback_manager_get_callback_property(system_callback_manager                   callback_manager,
+                                                                      int                                       callback_id,
+                                                                      system_callback_manager_callback_property property,
+                                                                      void*                                     out_result_ptr);
+
 /** TODO */
 PUBLIC void system_callback_manager_init();
 
@@ -62,7 +125,19 @@ PUBLIC void system_callback_manager_init();
  *
  *  Internal usage only.
  **/
-PUBLIC void system_callback_manager_release(system_callback_manager callback_manager);
+PUBLIC EMERALD_API void system_callback_manager_release(system_callback_manager callback_manager);
+
+/** Updates a property value of the specified callback ID.
+ *
+ *  @param callback_manager Callback manager to use.
+ *  @param callback_id      Callback ID to use.
+ *  @param property         Property to update. Must be settable.
+ *  @param data             New property value. Must not be NULL.
+ */
+PUBLIC EMERALD_API void system_callback_manager_set_callback_property(system_callback_manager                   callback_manager,
+                                                                      int                                       callback_id,
+                                                                      system_callback_manager_callback_property property,
+                                                                      const void*                               data);
 
 /** TODO.
  *
@@ -81,8 +156,11 @@ PUBLIC EMERALD_API void system_callback_manager_subscribe_for_callbacks(system_c
  *  NOTE: Subscriptions are ref-counted. The specified subscription will only be cancelled once this function is
  *        called for exactly the same number of times the _subscribe_ func was called for the specified configuration.
  *
+ *  NOTE: Once a subscription is cancelled, the function waits until other threads have finished calling it back
+ *        synchronously. Asynchronous dispatches which have already been submitted may still call it back.
+ *
  *  @param allow_deferred_execution If true, the action is going to be delegated to a worker thread, should the
- *                                  function need to lock, waiting for a mutex to be released for write access.
+ *                                  function need to wait for other threads to finish calling back subscribers.
  *
  */
 PUBLIC EMERALD_API void system_callback_manager_unsubscribe_from_callbacks(system_callback_manager callback_manager,
@@ -11,6 +11,10 @@
 
 typedef enum
 {
+    /* bool. True if the CPU supports AVX2 and FMA3 instructions, and the OS preserves
+     *       the YMM registers across context switches. */
+    SYSTEM_CAPABILITIES_PROPERTY_CPU_SUPPORTS_AVX2,
+
     /* unsigned int */
     SYSTEM_CAPABILITIES_PROPERTY_NUMBER_OF_CPU_CORES,
 } system_capabilities_property;
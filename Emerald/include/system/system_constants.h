@@ -28,8 +28,27 @@
 /* Defines amount of precached entries for window handle storage */
 #define BASE_WINDOW_STORAGE (2)
 
-/* Defines amount of threads active in thread pool */
-#define THREAD_POOL_AMOUNT_OF_THREADS (4)
+/* Defines amount of threads active in thread pool. Set to 0 to spawn one worker thread per CPU core, as reported
+ * by system_capabilities, but no fewer than THREAD_POOL_MIN_AMOUNT_OF_THREADS. Can be overridden at run-time by setting the environment variable named by
+ * THREAD_POOL_AMOUNT_OF_THREADS_ENV_VARIABLE to the requested number of threads.
+ */
+#define THREAD_POOL_AMOUNT_OF_THREADS              (0)
+#define THREAD_POOL_AMOUNT_OF_THREADS_ENV_VARIABLE ("EMERALD_THREAD_POOL_THREADS")
+
+/* Defines maximum amount of threads the thread pool can be configured to use. */
+#define THREAD_POOL_MAX_AMOUNT_OF_THREADS (256)
+
+/* Defines minimum amount of threads the thread pool spawns if the amount is derived from the number of CPU cores.
+ * Some of the engine's tasks block until other tasks finish, so the thread pool must not be too narrow.
+ */
+#define THREAD_POOL_MIN_AMOUNT_OF_THREADS (4)
+
+/* Set to true to pin the n-th thread pool worker thread to CPU core (n % number of CPU cores). Can be overridden
+ * at run-time by setting the environment variable named by THREAD_POOL_PIN_WORKER_THREADS_ENV_VARIABLE to
+ * 0 or 1.
+ */
+#define THREAD_POOL_PIN_WORKER_THREADS              (false)
+#define THREAD_POOL_PIN_WORKER_THREADS_ENV_VARIABLE ("EMERALD_THREAD_POOL_PIN_THREADS")
 
 /* Defines amount of precached task descriptors to be used by thread pool. */
 #define THREAD_POOL_PREALLOCATED_TASK_DESCRIPTORS (64)
@@ -46,9 +65,54 @@
 /* Defines amount of preallocated order descriptors */
 #define THREAD_POOL_PREALLOCATED_ORDER_DESCRIPTORS (THREAD_POOL_PREALLOCATED_TASK_CONTAINERS * THREAD_POOL_TASK_PRIORITY_COUNT)
 
+/* Set to true to have the thread pool schedule orders using per-worker work-stealing deques. When false, all
+ * orders go through a single, critical section-protected queue. Can be overridden at run-time by setting the
+ * environment variable named by THREAD_POOL_USE_WORK_STEALING_ENV_VARIABLE to 0 or 1.
+ */
+#define THREAD_POOL_USE_WORK_STEALING              (true)
+#define THREAD_POOL_USE_WORK_STEALING_ENV_VARIABLE ("EMERALD_THREAD_POOL_WORK_STEALING")
+
+/* Defines capacity of a single per-worker, per-priority work-stealing deque. Must be a power of two. Orders which
+ * do not fit in the deque are redirected to the shared queue.
+ */
+#define THREAD_POOL_WORK_STEALING_DEQUE_CAPACITY (1024)
+
 /* Defines start capacity for file serializer's writing facility. */
 #define FILE_SERIALIZER_START_CAPACITY (65536)
 
+/* Defines minimum number of elements a resizable vector needs to hold, for system_resizable_vector_sort() to sort it
+ * using all thread pool workers. Smaller vectors are sorted on the calling thread. */
+#define RESIZABLE_VECTOR_PARALLEL_SORT_THRESHOLD (65536)
+
+/* Defines maximum number of keys stored in a single system_bst node. Must be odd. */
+#define BST_MAX_KEYS_PER_NODE (31)
+
+/* Defines amount of system_bst nodes to preallocate space for in a single go. */
+#define BST_N_NODES_TO_PREALLOC (64)
+
+/* Defines size of a single, independently compressed chunk of a packed file, in bytes. Packed files are
+ * decompressed in units of whole chunks. */
+#define FILE_PACKER_CHUNK_SIZE (256 * 1024)
+
+/* Defines how many chunks the file packer reads & compresses in a single batch. The chunks of a batch
+ * are compressed in parallel. */
+#define FILE_PACKER_N_CHUNKS_PER_BATCH (32)
+
+/* Defines how many decompressed chunks a single file unpacker caches. Only chunks which are shared by
+ * more than one file go through the cache. */
+#define FILE_UNPACKER_N_CACHED_CHUNKS (16)
+
+/* Defines how long the file monitor waits for further notifications concerning a modified file, before it
+ * issues a call-back for the file, in miliseconds. Used for files, for which no other window has been specified. */
+#define FILE_MONITOR_DEFAULT_COALESCING_WINDOW_MSEC (50)
+
+/* Defines maximum delay between the first notification concerning a modified file and the corresponding call-back,
+ * in miliseconds, for files which keep on being modified. Longer coalescing windows take precedence. */
+#define FILE_MONITOR_MAX_COALESCING_DELAY_MSEC (1000)
+
+/* Defines how many file monitor call-backs a single thread pool task executes. */
+#define FILE_MONITOR_N_CALLBACKS_PER_TASK (16)
+
 /* Define log level threshold. Logs with level lower than this value will be dropped on pre-processor phase. */
 #define LOGLEVEL_BASE (LOGLEVEL_INFORMATION)
 
@@ -67,10 +131,41 @@
 /* Defines maximum length of a single log entry. */
 #define LOG_MAX_LENGTH (32768)
 
-/* Defines default amount of bins used for a single 64-bit hash-map */
-#define HASH64MAP_BINS_AMOUNT (16)
+/* Defines how many log entries each thread can have queued before new ones start being dropped.
+ * Must be a power of two. */
+#define LOG_RING_BUFFER_CAPACITY (256)
+
+/* Defines how many bytes of captured arguments are stored within a queued log entry. Entries
+ * which need more space allocate it from the heap. */
+#define LOG_ENTRY_INLINE_DATA_SIZE (192)
+
+/* Defines how many groups of the old lookup table a single 64-bit hash-map insert or remove call
+ * migrates to the new table, while the hash-map is being grown. */
+#define HASH64MAP_N_GROUPS_MIGRATED_PER_CALL (4)
+
+/* Defines default capacity of a single 64-bit hash-map's entry array */
+#define HASH64MAP_START_N_ENTRIES (8)
+
+/* Defines default amount of lookup table slots used for a single 64-bit hash-map.
+ * Must be a power of two, not smaller than 16. */
+#define HASH64MAP_START_N_SLOTS (16)
+
+/* Defines how many blocks are moved between a thread's resource pool magazine and the pool's global
+ * free list at a time. */
+#define RESOURCE_POOL_BATCH_SIZE (32)
+
+/* Defines how many blocks a single thread's resource pool magazine can hold. Must be larger than
+ * RESOURCE_POOL_BATCH_SIZE. */
+#define RESOURCE_POOL_MAGAZINE_CAPACITY (2 * RESOURCE_POOL_BATCH_SIZE)
+
+/* Defines how many threads can use their own resource pool magazines. Any other threads fall back
+ * to a single, critical section-protected magazine. Every thread pool worker must get its own slot, even
+ * with THREAD_POOL_MAX_AMOUNT_OF_THREADS workers, so the table leaves room for the remaining threads
+ * (main thread, rendering threads, etc.) on top of that. Magazines are only allocated for slots in use. */
+#define RESOURCE_POOL_MAX_THREAD_SLOTS (THREAD_POOL_MAX_AMOUNT_OF_THREADS + 64)
 
-/* Defines default amount of entries in a single 64-bit hash-map's bin */
-#define HASH64MAP_BIN_ENTRIES_AMOUNT (16)
+/* Defines size of the first chunk allocated for a thread's frame arena. Arenas which outgrow
+ * their chunk during a frame are consolidated into a single larger chunk when the next frame starts. */
+#define FRAME_ARENA_CHUNK_SIZE (64 * 1024)
 
 #endif /* SYSTEM_CONSTANTS_H */
@@ -8,8 +8,27 @@
 
 #include "system_types.h"
 
+/** Call-back used by system_dag_process_node_values_by_level().
+ *
+ *  @param value    Value of the DAG node to process.
+ *  @param user_arg User argument, as passed to system_dag_process_node_values_by_level().
+ */
+typedef void (*PFNSYSTEMDAGNODEVALUEPROC)(system_dag_node_value value,
+                                          void*                 user_arg);
 
-/** TODO */
+/** Adds a new connection to the DAG. Node @param dst will be placed after node @param src in the
+ *  topological order.
+ *
+ *  If the DAG has been solved before, the topological order is updated in place, so that only the nodes
+ *  located between @param dst and @param src in the current order are visited. If the connection
+ *  introduces a cycle, the DAG is marked as dirty and the next system_dag_solve() call will fail.
+ *
+ *  @param dag DAG instance.
+ *  @param src Source node.
+ *  @param dst Destination node.
+ *
+ *  @return Connection handle.
+ */
 PUBLIC EMERALD_API system_dag_connection system_dag_add_connection(system_dag      dag,
                                                                    system_dag_node src,
                                                                    system_dag_node dst);
@@ -64,7 +83,40 @@ PUBLIC EMERALD_API bool system_dag_get_connections(system_dag             dag,
                                                    uint32_t*              out_opt_n_connections_ptr,
                                                    system_dag_connection* out_opt_connections_ptr);
 
-/** TODO */
+/** Returns the number of dependency levels of the DAG. Level 0 holds nodes without incoming connections.
+ *  Level n holds nodes, for which the longest path leading to them from a level 0 node is made of
+ *  n connections. Nodes assigned to the same level do not depend on each other.
+ *
+ *  The levels are recomputed on demand, after connections have been modified.
+ *
+ *  @param dag              DAG instance.
+ *  @param out_n_levels_ptr Deref will be set to the number of levels. Must not be NULL.
+ *
+ *  @return true if successful, false if the graph is not a DAG.
+ */
+PUBLIC EMERALD_API bool system_dag_get_n_levels(system_dag dag,
+                                                uint32_t*  out_n_levels_ptr);
+
+/** Retrieves values of all nodes assigned to the specified dependency level. Please see system_dag_get_n_levels()
+ *  for more details.
+ *
+ *  @param dag     DAG instance.
+ *  @param n_level Index of the level to use.
+ *  @param result  Vector to store the node values in. Any elements stored in the vector prior to the call are removed.
+ *
+ *  @return true if successful, false if the graph is not a DAG or @param n_level is invalid.
+ */
+PUBLIC EMERALD_API bool system_dag_get_level_node_values(system_dag              dag,
+                                                         uint32_t                n_level,
+                                                         system_resizable_vector result);
+
+/** Retrieves values of all nodes, sorted in topological order. The DAG is solved first, if it is dirty.
+ *
+ *  @param dag    DAG instance.
+ *  @param result Vector to store the node values in. Any elements stored in the vector prior to the call are removed.
+ *
+ *  @return true if successful, false if the graph is not a DAG.
+ */
 PUBLIC EMERALD_API bool system_dag_get_topologically_sorted_node_values(system_dag              dag,
                                                                         system_resizable_vector result);
 
@@ -84,16 +136,43 @@ PUBLIC EMERALD_API bool system_dag_is_connection_defined(system_dag      dag,
                                                          system_dag_node src,
                                                          system_dag_node dst);
 
-/** TODO */
+/** Tells if the topological order of the DAG needs to be recomputed from scratch by system_dag_solve().
+ *  This is the case for DAGs which have not been solved yet, and for graphs in which a cycle has been detected.
+ *
+ *  @param dag DAG instance.
+ *
+ *  @return As per description.
+ */
 PUBLIC EMERALD_API bool system_dag_is_dirty(system_dag dag);
 
+/** Calls @param pfn_proc for values of all nodes, one dependency level after another. Values of nodes assigned
+ *  to the same level are processed in parallel, using all thread pool workers, so @param pfn_proc must be safe
+ *  to call from multiple threads at the same time. The function returns after all nodes have been processed.
+ *
+ *  @param dag      DAG instance.
+ *  @param pfn_proc Call-back to use.
+ *  @param user_arg Argument to pass with the call-back.
+ *
+ *  @return true if successful, false if the graph is not a DAG.
+ */
+PUBLIC EMERALD_API bool system_dag_process_node_values_by_level(system_dag                dag,
+                                                                PFNSYSTEMDAGNODEVALUEPROC pfn_proc,
+                                                                void*                     user_arg);
+
 /** TODO */
 PUBLIC EMERALD_API void system_dag_release(system_dag dag);
 
 /** TODO */
 PUBLIC EMERALD_API void system_dag_reset_connections(system_dag dag);
 
-/** TODO */
+/** Makes sure the topological order of the DAG nodes is up-to-date. A full topological sort is only
+ *  executed if the DAG is dirty. Otherwise, the order has already been updated by the functions which
+ *  modified the DAG, and the call is a nop.
+ *
+ *  @param dag DAG instance.
+ *
+ *  @return true if successful, false if the graph is not a DAG.
+ */
 PUBLIC EMERALD_API bool system_dag_solve(system_dag dag);
 
 #endif /* SYSTEM_DAG_H */
@@ -9,6 +9,12 @@
 #include "system/system_types.h"
 #include "system/system_time.h"
 
+/* Linux events are implemented directly on top of futexes, unless the emulation layer
+ * (system_event_monitor) has been explicitly requested. */
+#if defined(__linux__) && !defined(USE_EMULATED_EVENTS)
+    #define USE_FUTEX_EVENTS
+#endif
+
 typedef enum
 {
     #ifdef _WIN32
@@ -74,6 +80,30 @@ PUBLIC EMERALD_API system_event system_event_create(bool manual_reset);
  */
 PUBLIC EMERALD_API system_event system_event_create_from_thread(system_thread thread);
 
+#ifdef USE_FUTEX_EVENTS
+    /** Creates a thread event for a thread which is about to be spawned by system_threads. The thread
+     *  signals the event with _system_event_signal_thread_exit() right before it quits, and then
+     *  releases it.
+     *
+     *  Internal use only.
+     */
+    PUBLIC system_event _system_event_create_for_spawned_thread();
+
+    /** Assigns the spawned thread to an event created with _system_event_create_for_spawned_thread().
+     *
+     *  Internal use only.
+     */
+    PUBLIC void _system_event_set_spawned_thread(system_event  event,
+                                                 system_thread thread);
+
+    /** Signals a thread event, on behalf of the thread which is about to quit, and releases the thread's
+     *  reference to the event.
+     *
+     *  Internal use only.
+     */
+    PUBLIC void _system_event_signal_thread_exit(system_event event);
+#endif
+
 /** TODO
  *
  *  Internal use only.
@@ -8,6 +8,7 @@
 #ifndef SYSTEM_FILE_MONITOR_H
 #define SYSTEM_FILE_MONITOR_H
 
+#include "system_constants.h"
 #include "system_types.h"
 
 typedef void (*PFNFILECHANGEDETECTEDPROC)(system_hashed_ansi_string file_name,
@@ -20,19 +21,33 @@ PUBLIC void system_file_monitor_deinit();
 /** TODO */
 PUBLIC void system_file_monitor_init();
 
-/** TODO.
+/** Registers or unregisters a call-back, which should be called whenever the specified file is modified.
+ *
+ *  Under Linux, notifications are coalesced: the call-back is only issued after the file has not been
+ *  modified for @param coalescing_window_msec miliseconds, so that a burst of writes results in a single
+ *  call-back. If the file keeps on being modified, the call-back is issued no later than
+ *  FILE_MONITOR_MAX_COALESCING_DELAY_MSEC miliseconds after the first notification. Call-backs are executed
+ *  from thread pool workers, possibly at the same time for different files.
  *
  *  NOTE: File monitor may issue spurious, platform-specific callbacks. These should be treated as
  *        hints by the user. System-specific caching is likely to interfere with the file monitor.
  *
  *        Always ensure to unregister a subscription, before you proceed with destruction of variables
- *        that the call-back handler could use, were it called.
+ *        that the call-back handler could use, were it called. Unregistering waits for call-backs which
+ *        are being executed to finish, so it must not be done from within a call-back.
  *
+ *  @param file_name              Name of the file to monitor.
+ *  @param should_enable          true to register the call-back, false to unregister it.
+ *  @param pfn_file_changed_proc  Call-back to use. Ignored if @param should_enable is false.
+ *  @param user_arg               User argument to pass with the call-back. Ignored if @param should_enable is false.
+ *  @param coalescing_window_msec Coalescing window to use for the file. Ignored if @param should_enable is false,
+ *                                as well as under Windows.
  */
 PUBLIC EMERALD_API void system_file_monitor_monitor_file_changes(system_hashed_ansi_string file_name,
                                                                  bool                      should_enable,
                                                                  PFNFILECHANGEDETECTEDPROC pfn_file_changed_proc,
-                                                                 void*                     user_arg);
+                                                                 void*                     user_arg,
+                                                                 uint32_t                  coalescing_window_msec = FILE_MONITOR_DEFAULT_COALESCING_WINDOW_MSEC);
 
 
 #endif /* SYSTEM_FILE_MONITOR_H */
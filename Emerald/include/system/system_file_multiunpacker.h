@@ -7,12 +7,30 @@
  * The object supports a wait operation which waits for all load ops to finish before returning
  * execution flow to the caller.
  *
+ * Consumers can also subscribe to individual files. A subscribed file is unpacked on the thread
+ * pool as soon as the packed file holding it has been opened, and is then handed over to the
+ * consumer's call-back. This lets consumers (eg. gfx_image_create_from_file(), mesh_load_with_serializer()
+ * or scene_multiloader_create_from_system_file_serializers() ) decode a file while other files are
+ * still being read & decompressed.
+ *
  */
 #ifndef SYSTEM_FILE_MULTIUNPACKER_H
 #define SYSTEM_FILE_MULTIUNPACKER_H
 
 #include "system/system_types.h"
 
+/** Call-back function pointer type used for file subscriptions. Called from a thread pool thread.
+ *
+ *  @param file_name  Name of the file the subscription has been made for.
+ *  @param unpacker   Unpacker which holds the file, or NULL if none of the packed files holds it.
+ *  @param serializer Serializer holding the unpacked file contents, or NULL if the file could not
+ *                    be unpacked. Owned by @param unpacker.
+ *  @param user_arg   User-specified argument.
+ */
+typedef void (*PFNSYSTEMFILEMULTIUNPACKERFILEREADYPROC)(system_hashed_ansi_string file_name,
+                                                        system_file_unpacker      unpacker,
+                                                        system_file_serializer    serializer,
+                                                        void*                     user_arg);
 
 typedef enum _system_file_multiunpacker_property
 {
@@ -34,7 +52,27 @@ PUBLIC EMERALD_API void system_file_multiunpacker_get_indexed_property(system_fi
                                                                        _system_file_multiunpacker_property property,
                                                                        void*                               out_result);
 
-/** TODO */
+/** Subscribes to a single file stored in one of the packed files. The call-back is invoked exactly once,
+ *  from a thread pool thread, as soon as the file has been unpacked. Call-backs for different files
+ *  may be invoked in parallel.
+ *
+ *  Subscriptions can be made at any time before the multiunpacker is released.
+ *
+ *  @param multiunpacker       Multiunpacker instance.
+ *  @param file_name           Name of the file to subscribe to. Needs to be an exact match.
+ *  @param pfn_file_ready_proc Call-back to invoke. Must not be NULL.
+ *  @param user_arg            Argument to pass with the call-back.
+ */
+PUBLIC EMERALD_API void system_file_multiunpacker_subscribe_to_file(system_file_multiunpacker               multiunpacker,
+                                                                    system_hashed_ansi_string               file_name,
+                                                                    PFNSYSTEMFILEMULTIUNPACKERFILEREADYPROC pfn_file_ready_proc,
+                                                                    void*                                   user_arg);
+
+/** Blocks until all packed files have been opened and all call-backs of the subscriptions made so far
+ *  have returned.
+ *
+ *  @param multiunpacker Multiunpacker instance.
+ */
 PUBLIC EMERALD_API void system_file_multiunpacker_wait_till_ready(system_file_multiunpacker multiunpacker);
 
 /** TODO */
@@ -8,6 +8,24 @@
 
 #include "system/system_types.h"
 
+/* Packed file format. Internal usage only.
+ *
+ * v1 files hold a single zlib stream, which is preceded by the number of bytes in the decoded stream.
+ *
+ * v2 files start with an uncompressed index, followed by independently compressed chunks of the
+ * concatenated file data:
+ *
+ *   uint32_t magic, version, chunk_size, n_files, n_chunks;
+ *   uint64_t n_total_unpacked_bytes;
+ *
+ *   for each file:  uint32_t name_length; char name[name_length]; uint64_t data_offset; uint32_t size, crc32;
+ *   for each chunk: uint64_t packed_data_offset; uint32_t packed_size, unpacked_size;
+ *
+ *   compressed chunk data. Chunk offsets are relative to the start of the chunk data.
+ */
+#define SYSTEM_FILE_PACKER_FORMAT_MAGIC   (0x4B415045) /* "EPAK" */
+#define SYSTEM_FILE_PACKER_FORMAT_VERSION (2)
+
 
 /** TODO */
 PUBLIC EMERALD_API bool system_file_packer_add_file(system_file_packer        packer,
@@ -19,7 +37,14 @@ PUBLIC EMERALD_API system_file_packer system_file_packer_create();
 /** TODO */
 PUBLIC EMERALD_API void system_file_packer_release(system_file_packer packer);
 
-/** TODO */
+/** Packs all files added to the packer into a single file, using the v2 packed file format. File data is split
+ *  into chunks of FILE_PACKER_CHUNK_SIZE bytes, which are compressed in parallel using the thread pool.
+ *
+ *  @param packer                 Packer instance to use.
+ *  @param target_packed_filename Name of the file to create.
+ *
+ *  @return true if successful, false otherwise.
+ */
 PUBLIC EMERALD_API bool system_file_packer_save(system_file_packer        packer,
                                                 system_hashed_ansi_string target_packed_filename);
 
@@ -8,7 +8,9 @@
  *
  *         1) File mode, where an actual file is read from or
  *            written to.
- *         2) Memory region mode, where the serializer acts as
+ *         2) Mapped file mode, where a file is mapped into the process'
+ *            address space and read without being copied.
+ *         3) Memory region mode, where the serializer acts as
  *            a shim layer for load & store ops.
  *
  * For:
@@ -51,7 +53,18 @@ typedef enum
      */
     SYSTEM_FILE_SERIALIZER_PROPERTY_FILE_PATH_AND_NAME,
 
-    /* not settable, const char*. Internal usage only. */
+    /* not settable, bool.
+     *
+     * true if the serializer has been created with system_file_serializer_create_for_reading_mapped_file()
+     * and the raw storage points directly into the file mapping.
+     */
+    SYSTEM_FILE_SERIALIZER_PROPERTY_IS_MAPPED,
+
+    /* not settable, const char*. Internal usage only.
+     *
+     * Raw storage of file serializers is followed by a terminator. This does NOT apply to mapped file
+     * serializers.
+     */
     SYSTEM_FILE_SERIALIZER_PROPERTY_RAW_STORAGE,
 
     /* not settable, size_t */
@@ -79,6 +92,21 @@ PUBLIC EMERALD_API system_file_serializer system_file_serializer_create_for_read
 PUBLIC EMERALD_API system_file_serializer system_file_serializer_create_for_reading(system_hashed_ansi_string file_name,
                                                                                     bool                      async_read = true);
 
+/** Creates a file serializer instance for reading a file, which is mapped into the process' address space
+ *  instead of being copied to a heap buffer. File pages are only read from the disk when they are first
+ *  accessed, and can be evicted by the OS under memory pressure, which makes this mode a good fit for
+ *  large binary blobs which are parsed once.
+ *
+ *  Use system_file_serializer_read_no_copy() to access the file contents without copying them.
+ *
+ *  NOTE: Unlike with system_file_serializer_create_for_reading(), the raw storage is not null-terminated.
+ *
+ *  @param system_hashed_ansi_string File name (with path, if necessary)
+ *
+ *  @return File serializer instance. If the file could not be mapped, reads from the serializer will fail.
+ */
+PUBLIC EMERALD_API system_file_serializer system_file_serializer_create_for_reading_mapped_file(system_hashed_ansi_string file_name);
+
 /** Creates a file serializer instance for writing a file.
  *
  *  @param system_hashed_ansi_string File name (with path, if necessary)
@@ -114,6 +142,22 @@ PUBLIC EMERALD_API bool system_file_serializer_read(system_file_serializer seria
                                                     uint32_t               n_bytes,
                                                     void*                  out_result);
 
+/** Returns a pointer to the next @param n_bytes bytes of the serializer's storage and moves the reading pointer,
+ *  as system_file_serializer_read() would. No data is copied.
+ *
+ *  The returned pointer remains valid for as long as the serializer is alive. Callers which need to access the
+ *  data for longer should retain the serializer. The data must not be modified.
+ *
+ *  @param system_file_serializer File serializer instance to use.
+ *  @param uint32_t               Amount of bytes to read.
+ *  @param const void**           Deref will be set to the location of the data. Not touched if the call fails.
+ *
+ *  @return true if successful, false otherwise
+ */
+PUBLIC EMERALD_API bool system_file_serializer_read_no_copy(system_file_serializer serializer,
+                                                            uint32_t               n_bytes,
+                                                            const void**           out_data_ptr);
+
 /** TODO */
 PUBLIC EMERALD_API bool system_file_serializer_read_curve_container(system_file_serializer    serializer,
                                                                     system_hashed_ansi_string object_manager_path,
@@ -11,7 +11,14 @@
 
 typedef enum
 {
+    /* not settable, system_file_serializer.
+     *
+     * For v2 packed files, the first query decompresses the file. Chunks of the file are decompressed
+     * in parallel, using the thread pool. The serializer is owned by the unpacker.
+     */
     SYSTEM_FILE_UNPACKER_FILE_PROPERTY_FILE_SERIALIZER,
+
+    /* not settable, system_hashed_ansi_string */
     SYSTEM_FILE_UNPACKER_FILE_PROPERTY_NAME
 } system_file_unpacker_file_property;
 
@@ -24,10 +31,14 @@ typedef enum
     SYSTEM_FILE_UNPACKER_PROPERTY_N_OF_EMBEDDED_FILES
 } system_file_unpacker_property;
 
-/** TODO.
+/** Opens a packed file created with system_file_packer.
+ *
+ *  v1 packed files are fully decompressed before the call leaves. For v2 packed files, only the index is read
+ *  at creation time. Files are decompressed when their serializer is requested for the first time.
  *
- *  The call does not leave until the unpacking process finishes!
+ *  @param packed_filename Name of the packed file to open.
  *
+ *  @return New unpacker instance, or NULL if the file could not be opened.
  **/
 PUBLIC EMERALD_API system_file_unpacker system_file_unpacker_create(system_hashed_ansi_string packed_filename);
 
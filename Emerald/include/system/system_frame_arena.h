@@ -0,0 +1,167 @@
+/**
+ *
+ *  Emerald (kbi/elude @2016)
+ *
+ *  @brief Frame arenas serve allocations, which only need to live until the end of the frame
+ *         they were made in. Each thread owns an arena, so allocating only needs to bump a pointer
+ *         and never takes a lock. All arenas are reset when the next frame starts. Chunks are only
+ *         returned to the heap when the owning thread quits, so once the arenas have grown to
+ *         accommodate a typical frame, they stop touching the heap altogether.
+ *
+ *         Frames are started and finished by the rendering handler. Nothing allocated from a frame
+ *         arena may be accessed after system_frame_arena_end_frame() is called.
+ */
+#ifndef SYSTEM_FRAME_ARENA_H
+#define SYSTEM_FRAME_ARENA_H
+
+#include "system/system_types.h"
+#include <new>
+#include <type_traits>
+
+typedef enum
+{
+    /* unsigned int. Number of allocations served by frame arenas during the last completed frame. */
+    SYSTEM_FRAME_ARENA_PROPERTY_N_ALLOCATIONS_LAST_FRAME,
+
+    /* __uint64. Number of bytes handed out by frame arenas during the last completed frame. */
+    SYSTEM_FRAME_ARENA_PROPERTY_N_BYTES_ALLOCATED_LAST_FRAME,
+
+    /* unsigned int. Number of chunks frame arenas had to allocate from the heap during the last
+     *               completed frame. Drops to zero once the arenas are large enough. */
+    SYSTEM_FRAME_ARENA_PROPERTY_N_CHUNK_ALLOCATIONS_LAST_FRAME,
+
+    /* unsigned int. Number of operator new calls made by any thread during the last completed frame.
+     *               Only counted if Emerald is built with INCLUDE_HEAP_ALLOCATION_COUNTER defined.
+     *               Always 0 otherwise.
+     */
+    SYSTEM_FRAME_ARENA_PROPERTY_N_HEAP_ALLOCATIONS_LAST_FRAME,
+
+    /* unsigned int. Number of frames completed so far. */
+    SYSTEM_FRAME_ARENA_PROPERTY_N_FRAMES_COMPLETED,
+} system_frame_arena_property;
+
+
+/** Allocates memory from the calling thread's frame arena. The memory stays valid until
+ *  the current frame ends. It must not be released by the caller.
+ *
+ *  Must only be called while a frame is in progress. Use system_frame_arena_is_frame_in_progress()
+ *  to determine whether the call is allowed, if the caller can also be used outside the rendering loop.
+ *
+ *  @param size      Number of bytes to allocate.
+ *  @param alignment Required alignment of the returned pointer. Must be a power of two.
+ *
+ *  @return Pointer to the allocated memory, or NULL if no frame is in progress.
+ */
+PUBLIC EMERALD_API void* system_frame_arena_alloc(size_t size,
+                                                  size_t alignment = sizeof(void*) );
+
+/** Starts a new frame. All allocations made by any of the threads during the previous frame become
+ *  invalid. Each thread's arena is reset the first time the thread allocates in the new frame.
+ *
+ *  Called by the rendering handler. Frames of different rendering handlers may overlap, in which case
+ *  the arenas are not reset until all of them have ended.
+ */
+PUBLIC EMERALD_API void system_frame_arena_begin_frame();
+
+/** Finishes the frame started with system_frame_arena_begin_frame(). Once no frame is in progress,
+ *  updates the statistics which can be queried with system_frame_arena_get_property().
+ */
+PUBLIC EMERALD_API void system_frame_arena_end_frame();
+
+/** Retrieves a frame arena property value. Please see system_frame_arena_property documentation
+ *  for the list of supported properties and their types.
+ *
+ *  @param property Property to query.
+ *  @param out_result_ptr Deref will be set to the requested value. Must not be NULL.
+ */
+PUBLIC EMERALD_API void system_frame_arena_get_property(system_frame_arena_property property,
+                                                        void*                       out_result_ptr);
+
+/** Tells whether a frame is in progress, in which case system_frame_arena_alloc() can be used.
+ *
+ *  @return As per description.
+ */
+PUBLIC EMERALD_API bool system_frame_arena_is_frame_in_progress();
+
+/** Returns the calling thread's arena chunks to the heap. Called by system_threads for each thread
+ *  which is about to quit.
+ */
+PUBLIC void _system_frame_arena_release_thread_arena();
+
+/** Initializes frame arena module. Only called once per process */
+PUBLIC void _system_frame_arena_init();
+
+/** Deinitializes frame arena module. Only called once per process */
+PUBLIC void _system_frame_arena_deinit();
+
+
+/** STL allocator which serves allocations from the frame arena, if a frame was in progress
+ *  at the time the allocator was created, and from the heap otherwise. Containers which use it
+ *  for per-frame temporaries can thus also be used outside the rendering loop.
+ *
+ *  Containers whose allocator is frame arena-backed must be destroyed before the frame ends.
+ */
+template<typename T>
+class system_frame_arena_allocator
+{
+public:
+    typedef T value_type;
+
+    template<typename U>
+    struct rebind
+    {
+        typedef system_frame_arena_allocator<U> other;
+    };
+
+    system_frame_arena_allocator()
+        :is_frame_arena_backed(system_frame_arena_is_frame_in_progress() )
+    {
+        /* Stub */
+    }
+
+    template<typename U>
+    system_frame_arena_allocator(const system_frame_arena_allocator<U>& allocator)
+        :is_frame_arena_backed(allocator.is_frame_arena_backed)
+    {
+        /* Stub */
+    }
+
+    T* allocate(size_t n)
+    {
+        if (is_frame_arena_backed)
+        {
+            return static_cast<T*>(system_frame_arena_alloc(n * sizeof(T),
+                                                            std::alignment_of<T>::value) );
+        }
+
+        return static_cast<T*>(::operator new(n * sizeof(T) ) );
+    }
+
+    void deallocate(T*     ptr,
+                    size_t n)
+    {
+        /* Frame arena memory is reclaimed when the next frame starts */
+        if (!is_frame_arena_backed)
+        {
+            ::operator delete(ptr);
+        }
+    }
+
+    bool is_frame_arena_backed;
+};
+
+template<typename T, typename U>
+bool operator==(const system_frame_arena_allocator<T>& allocator1,
+                const system_frame_arena_allocator<U>& allocator2)
+{
+    return allocator1.is_frame_arena_backed == allocator2.is_frame_arena_backed;
+}
+
+template<typename T, typename U>
+bool operator!=(const system_frame_arena_allocator<T>& allocator1,
+                const system_frame_arena_allocator<U>& allocator2)
+{
+    return allocator1.is_frame_arena_backed != allocator2.is_frame_arena_backed;
+}
+
+#endif /* SYSTEM_FRAME_ARENA_H */
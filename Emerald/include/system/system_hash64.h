@@ -10,6 +10,9 @@
 
 
 /** Calculates a 64-bit hash for a raw text pointer.
+ *
+ *  The hash is well-distributed in all bits, but different strings can still produce the same
+ *  hash. Callers must compare the actual contents if they need to tell two strings apart.
  *
  *  This function is not exported.
  *
@@ -8,6 +8,23 @@
 
 #include "system/system_types.h"
 
+typedef enum
+{
+    /* float. Fraction of create requests which returned an already existing string. */
+    SYSTEM_HASHED_ANSI_STRING_PROPERTY_HIT_RATE,
+
+    /* __uint64. Number of create requests served from per-thread caches, without looking up
+     *           the shared string table. */
+    SYSTEM_HASHED_ANSI_STRING_PROPERTY_N_CACHE_HITS,
+
+    /* __uint64. Number of create requests. */
+    SYSTEM_HASHED_ANSI_STRING_PROPERTY_N_LOOKUPS,
+
+    /* unsigned int. Number of unique strings created so far. */
+    SYSTEM_HASHED_ANSI_STRING_PROPERTY_N_STRINGS,
+} system_hashed_ansi_string_property;
+
+
 /** Returns true if a given hashed ansi string contains another hashed ansi string.
  *
  *  @param system_hashed_ansi_string String to search for given sub-string.
@@ -22,7 +39,10 @@ PUBLIC EMERALD_API bool system_hashed_ansi_string_contains(system_hashed_ansi_st
  *  Text is copied by value so make sure input argument is valid.
  *
  *  If input text has already been used to create a hashed ansi string, existing instance
- *  will be returned.
+ *  will be returned. Strings are compared by contents, so two different strings are never
+ *  merged, even if their hashes are equal.
+ *
+ *  This function is thread-safe. Looking up existing strings does not take any locks.
  *
  *  @param const char* Text to store.
  *
@@ -71,6 +91,17 @@ PUBLIC EMERALD_API uint32_t system_hashed_ansi_string_get_length(system_hashed_a
  */
 PUBLIC EMERALD_API const char* system_hashed_ansi_string_get_buffer(system_hashed_ansi_string string);
 
+/** Retrieves a statistic describing all hashed ansi strings created so far.
+ *
+ *  Each thread adds its requests to the statistics in batches. Requests made by the calling
+ *  thread are always accounted for, but the most recent requests made by other threads may not be.
+ *
+ *  @param property       Property to query.
+ *  @param out_result_ptr Deref will be set to the requested value. Must not be NULL.
+ */
+PUBLIC EMERALD_API void system_hashed_ansi_string_get_property(system_hashed_ansi_string_property property,
+                                                               void*                              out_result_ptr);
+
 /** Tells whether given hashed ansi string encapsulates the same text as stored at user-provided location.
  *
  *  @param system_hashed_ansi_string Hashed ansi string to use for comparison.
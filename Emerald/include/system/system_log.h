@@ -1,52 +1,170 @@
 /**
  *
- * Emerald (kbi/elude @2012-2015)
+ * Emerald (kbi/elude @2012-2016)
  *
+ *  @brief Log entries are not formatted by the thread which reports them. Instead, the format string
+ *         and copies of the arguments are pushed to a lock-free ring buffer owned by the calling
+ *         thread. A background thread drains all ring buffers, formats the entries and writes them
+ *         to stdout and the log file.
+ *
+ *         If a thread's ring buffer is full, the entry is dropped and counted. Entries are ordered
+ *         by the time they were reported.
+ *
+ *         Format strings must be string literals, since they are only read by the writer thread.
  */
 #ifndef SYSTEM_CRITICAL_LOG_H
 #define SYSTEM_CRITICAL_LOG_H
 
 #include <string.h>
+#include <type_traits>
 #include "system_constants.h"
 #include "system_critical_section.h"
 #include "system_types.h"
 
-/* TODO: Use TLS */
-#ifdef EMERALD_EXPORTS
-    extern system_critical_section log_file_handle_cs;
-#else
-    static system_critical_section log_file_handle_cs = system_critical_section_create();
-#endif
+typedef enum
+{
+    /* system_log_priority. Entries with a lower priority are dropped before their arguments are captured.
+     *
+     * Settable with system_log_set_level(). */
+    SYSTEM_LOG_PROPERTY_LEVEL,
+
+    /* __uint64. Number of entries dropped, because the ring buffer of the reporting thread was full. */
+    SYSTEM_LOG_PROPERTY_N_DROPPED_ENTRIES,
+
+    /* __uint64. Number of entries written so far. */
+    SYSTEM_LOG_PROPERTY_N_WRITTEN_ENTRIES,
+} system_log_property;
+
+/* Types of captured log entry arguments. Internal use only. */
+typedef enum
+{
+    _SYSTEM_LOG_ARG_TYPE_DOUBLE,
+    _SYSTEM_LOG_ARG_TYPE_INTEGER,
+    _SYSTEM_LOG_ARG_TYPE_POINTER,
+    _SYSTEM_LOG_ARG_TYPE_STRING,
+} _system_log_arg_type;
+
+/* A log entry argument, captured by the reporting thread. Internal use only. */
+typedef struct
+{
+    _system_log_arg_type type;
+
+    union
+    {
+        double      double_value;
+        __int64     integer_value;
+        const void* pointer_value;
+        const char* string_value;
+    };
+} _system_log_arg;
+
+/* Entries with a lower priority are dropped. Internal use only - please use system_log_set_level() instead. */
+extern EMERALD_API volatile int _system_log_level;
+
+
+/** Pushes a log entry to the calling thread's ring buffer. Strings passed as arguments are copied.
+ *
+ *  NOTE: Internal use only. Please use LOG_* macros instead.
+ */
+PUBLIC EMERALD_API void _system_log_post(system_log_priority    level,
+                                         bool                   include_prefix,
+                                         const char*            file,
+                                         int                    line,
+                                         const char*            format,
+                                         unsigned int           n_args,
+                                         const _system_log_arg* args);
+
+/* Functions which capture printf() arguments. Internal use only. */
+inline _system_log_arg _system_log_make_arg(const char* value)
+{
+    _system_log_arg result;
+
+    result.type         = _SYSTEM_LOG_ARG_TYPE_STRING;
+    result.string_value = value;
+
+    return result;
+}
+
+inline _system_log_arg _system_log_make_arg(char* value)
+{
+    return _system_log_make_arg( (const char*) value);
+}
+
+inline _system_log_arg _system_log_make_arg(double value)
+{
+    _system_log_arg result;
+
+    result.type         = _SYSTEM_LOG_ARG_TYPE_DOUBLE;
+    result.double_value = value;
+
+    return result;
+}
+
+inline _system_log_arg _system_log_make_arg(float value)
+{
+    return _system_log_make_arg( (double) value);
+}
+
+inline _system_log_arg _system_log_make_arg(long double value)
+{
+    return _system_log_make_arg( (double) value);
+}
+
+template<typename T>
+inline typename std::enable_if<std::is_integral<T>::value || std::is_enum<T>::value, _system_log_arg>::type _system_log_make_arg(T value)
+{
+    _system_log_arg result;
+
+    result.type          = _SYSTEM_LOG_ARG_TYPE_INTEGER;
+    result.integer_value = (__int64) value;
+
+    return result;
+}
+
+template<typename T>
+inline _system_log_arg _system_log_make_arg(T* value)
+{
+    _system_log_arg result;
+
+    result.type          = _SYSTEM_LOG_ARG_TYPE_POINTER;
+    result.pointer_value = (const void*) value;
+
+    return result;
+}
+
+template<typename... Args>
+inline void _system_log_post_args(system_log_priority level,
+                                  bool                include_prefix,
+                                  const char*         file,
+                                  int                 line,
+                                  const char*         format,
+                                  Args...             args)
+{
+    /* The extra item makes sure the array is never empty */
+    const _system_log_arg captured_args[] =
+    {
+        _system_log_make_arg(args)...,
+        _system_log_make_arg(0)
+    };
+
+    _system_log_post(level,
+                     include_prefix,
+                     file,
+                     line,
+                     format,
+                     sizeof...(Args),
+                     captured_args);
+}
 
 #define _LOG(include_prefix, level,file,line,text,...)        \
-    if (level >= LOGLEVEL_BASE && log_file_handle_cs != NULL) \
+    if (level >= LOGLEVEL_BASE && level >= _system_log_level) \
     {                                                         \
-        system_critical_section_enter(log_file_handle_cs);    \
-                                                              \
-        static char log_helper[LOG_MAX_LENGTH];               \
-                                                              \
-        memset   (log_helper,                                 \
-                  0,                                          \
-                  LOG_MAX_LENGTH);                            \
-                                                              \
-        if (include_prefix)                                   \
-            snprintf (log_helper,                             \
-                      LOG_MAX_LENGTH,                         \
-                      "[File %s // line %d]: " text,          \
-                      file,                                   \
-                      line,                                   \
-                    ##__VA_ARGS__);                           \
-        else                                                  \
-            snprintf (log_helper,                             \
-                      LOG_MAX_LENGTH,                         \
-                      text,                                   \
-                    ##__VA_ARGS__);                           \
-                                                              \
-        system_log_write(level,                               \
-                         log_helper,                          \
-                         include_prefix);                     \
-                                                              \
-        system_critical_section_leave(log_file_handle_cs);    \
+        _system_log_post_args(level,                          \
+                              include_prefix,                 \
+                              file,                           \
+                              line,                           \
+                              text,                           \
+                            ##__VA_ARGS__);                   \
     }
 
 #define LOG_TRACE(text,...) _LOG(true,                 \
@@ -80,7 +198,7 @@
                                  text,                 \
                                ##__VA_ARGS__)
 
-/** Creates a new log file, initalizes cache, starts logging thread.
+/** Creates a new log file and starts the writer thread.
  *  Should only be started once.
  *
  *  NOTE: This function is not exported - it should be launched from
@@ -88,7 +206,7 @@
  */
 PUBLIC void _system_log_init();
 
-/** Closes the log file, shuts down logging thread, frees cache.
+/** Writes all pending entries, closes the log file and shuts down the writer thread.
  *  Should only be called once.
  *
  *  NOTE: This function is not expotred - it should be launched from
@@ -96,7 +214,34 @@ PUBLIC void _system_log_init();
  */
 PUBLIC void _system_log_deinit();
 
-/** Inserts new entry into a log file. 
+/** Releases the calling thread's ring buffer, once all entries it holds have been written.
+ *  Called by system_threads for each thread which is about to quit.
+ */
+PUBLIC void _system_log_release_thread_ring();
+
+/** Blocks until all entries reported so far have been written. */
+PUBLIC EMERALD_API void system_log_flush();
+
+/** Retrieves a log property value.
+ *
+ *  @param property       Property to query.
+ *  @param out_result_ptr Deref will be set to the requested value. Must not be NULL.
+ */
+PUBLIC EMERALD_API void system_log_get_property(system_log_property property,
+                                                void*               out_result_ptr);
+
+/** Sets the lowest priority of entries which should be logged. Entries with a lower
+ *  priority are dropped by the reporting thread, before any arguments are processed.
+ *
+ *  Entries with priority lower than LOGLEVEL_BASE are always dropped.
+ *
+ *  @param level New minimum priority.
+ */
+PUBLIC EMERALD_API void system_log_set_level(system_log_priority level);
+
+/** Inserts new entry into a log file. Entries queued before the call are written first.
+ *  The entry is written immediately, so this function should be used for messages which
+ *  must not be lost if the process crashes, e.g. assertion failures.
  *
  *  NOTE: This function DOES NOT perform any removal of incoming entries.
  *        Levels are only used to prefixing the entry with level info.
@@ -0,0 +1,648 @@
+/**
+ *
+ * Emerald (kbi/elude @2016)
+ *
+ * @brief Value-type 4x4 matrix. Unlike system_matrix4x4, which is a handle to a pooled
+ *        object, these matrices can live on the stack or be embedded in other structures,
+ *        so creating or copying one costs nothing more than 64 bytes of memory traffic.
+ *
+ *        Data is stored in row-major order, exactly like system_matrix4x4 does it, so values
+ *        can be moved between the two APIs with system_matrix4x4_get_row_major_data() and
+ *        system_matrix4x4_set_from_row_major_raw(). Matrices transform column vectors.
+ *
+ *        All functions are inlined. SSE2 is used whenever the compiler targets it, AVX is
+ *        additionally used for multiplication if the build enables it. None of the functions
+ *        require the operands to be aligned, but keeping them 16-byte aligned is faster.
+ */
+#ifndef SYSTEM_MATH_MATRIX4X4_H
+#define SYSTEM_MATH_MATRIX4X4_H
+
+#include "system/system_matrix4x4.h"
+#include "system/system_types.h"
+#include <math.h>
+#include <string.h>
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+    #include <emmintrin.h>
+
+    #define SYSTEM_MATH_MATRIX4X4_USE_SSE
+#endif
+
+#if defined(SYSTEM_MATH_MATRIX4X4_USE_SSE) && defined(__AVX__)
+    #include <immintrin.h>
+
+    #define SYSTEM_MATH_MATRIX4X4_USE_AVX
+#endif
+
+#ifdef _MSC_VER
+    #define SYSTEM_MATH_ALIGN16 __declspec(align(16))
+#else
+    #define SYSTEM_MATH_ALIGN16 __attribute__((aligned(16)))
+#endif
+
+#define SYSTEM_MATH_MATRIX4X4_N_CLIPPING_PLANES (SYSTEM_MATRIX4X4_CLIPPING_PLANE_TOP + 1)
+
+
+typedef struct SYSTEM_MATH_ALIGN16 system_math_matrix4x4
+{
+    /* data[row * 4 + column] */
+    float data[16];
+} system_math_matrix4x4;
+
+
+#ifdef SYSTEM_MATH_MATRIX4X4_USE_SSE
+    #define SYSTEM_MATH_MATRIX4X4_SWIZZLE(v, x, y, z, w) _mm_castsi128_ps(_mm_shuffle_epi32(_mm_castps_si128(v), _MM_SHUFFLE(w, z, y, x) ))
+    #define SYSTEM_MATH_MATRIX4X4_SHUFFLE(a, b, x, y, z, w) _mm_shuffle_ps(a, b, _MM_SHUFFLE(w, z, y, x) )
+
+    /** Returns a 2x2 row-major product A * B. */
+    inline __m128 _system_math_matrix4x4_mat2_mul(__m128 a,
+                                                  __m128 b)
+    {
+        return _mm_add_ps(_mm_mul_ps(a,                                            SYSTEM_MATH_MATRIX4X4_SWIZZLE(b, 0, 3, 0, 3) ),
+                          _mm_mul_ps(SYSTEM_MATH_MATRIX4X4_SWIZZLE(a, 1, 0, 3, 2), SYSTEM_MATH_MATRIX4X4_SWIZZLE(b, 2, 1, 2, 1) ));
+    }
+
+    /** Returns a 2x2 row-major product adj(A) * B. */
+    inline __m128 _system_math_matrix4x4_mat2_adj_mul(__m128 a,
+                                                      __m128 b)
+    {
+        return _mm_sub_ps(_mm_mul_ps(SYSTEM_MATH_MATRIX4X4_SWIZZLE(a, 3, 3, 0, 0), b),
+                          _mm_mul_ps(SYSTEM_MATH_MATRIX4X4_SWIZZLE(a, 1, 1, 2, 2), SYSTEM_MATH_MATRIX4X4_SWIZZLE(b, 2, 3, 0, 1) ));
+    }
+
+    /** Returns a 2x2 row-major product A * adj(B). */
+    inline __m128 _system_math_matrix4x4_mat2_mul_adj(__m128 a,
+                                                      __m128 b)
+    {
+        return _mm_sub_ps(_mm_mul_ps(a,                                            SYSTEM_MATH_MATRIX4X4_SWIZZLE(b, 3, 0, 3, 0) ),
+                          _mm_mul_ps(SYSTEM_MATH_MATRIX4X4_SWIZZLE(a, 1, 0, 3, 2), SYSTEM_MATH_MATRIX4X4_SWIZZLE(b, 2, 1, 2, 1) ));
+    }
+
+    /** Returns (x+y+z+w) in all four components. */
+    inline __m128 _system_math_matrix4x4_sum4(__m128 v)
+    {
+        v = _mm_add_ps(v, SYSTEM_MATH_MATRIX4X4_SWIZZLE(v, 2, 3, 0, 1) );
+        v = _mm_add_ps(v, SYSTEM_MATH_MATRIX4X4_SWIZZLE(v, 1, 0, 3, 2) );
+
+        return v;
+    }
+#endif
+
+
+/** Extracts all six clipping planes of a (model-)view-projection matrix. Planes are stored in
+ *  the order defined by system_matrix4x4_clipping_plane. Each plane is normalized, so that the
+ *  length of its normal is 1, in which case the plane equation yields the signed distance from
+ *  the plane. Points inside the frustum are on the positive side of all planes.
+ *
+ *  Matches the results of system_matrix4x4_get_clipping_plane(), followed by a
+ *  system_math_vector_normalize4_use_vec3_length() call.
+ *
+ *  @param mvp                  Matrix to use.
+ *  @param out_plane_coeffs_ptr Deref will be filled with SYSTEM_MATH_MATRIX4X4_N_CLIPPING_PLANES
+ *                              (A, B, C, D) plane equations.
+ */
+inline void system_math_matrix4x4_get_clipping_planes(const system_math_matrix4x4* mvp_ptr,
+                                                      float                        out_plane_coeffs_ptr[SYSTEM_MATH_MATRIX4X4_N_CLIPPING_PLANES][4])
+{
+    /* Plane = row3 + sign * row_index */
+    static const int   row_indices[SYSTEM_MATH_MATRIX4X4_N_CLIPPING_PLANES] = {1,     2,     0,    2,    0,     1};
+    static const float signs      [SYSTEM_MATH_MATRIX4X4_N_CLIPPING_PLANES] = {1.0f, -1.0f,  1.0f, 1.0f, -1.0f, -1.0f};
+
+    for (unsigned int n_plane = 0;
+                      n_plane < SYSTEM_MATH_MATRIX4X4_N_CLIPPING_PLANES;
+                    ++n_plane)
+    {
+        float*       plane_ptr = out_plane_coeffs_ptr[n_plane];
+        const float* row_ptr   = mvp_ptr->data + row_indices[n_plane] * 4;
+
+#ifdef SYSTEM_MATH_MATRIX4X4_USE_SSE
+        __m128 plane      = _mm_add_ps(_mm_loadu_ps(mvp_ptr->data + 12),
+                                       _mm_mul_ps (_mm_set1_ps (signs[n_plane]),
+                                                   _mm_loadu_ps(row_ptr) ));
+        __m128 normal     = _mm_and_ps (plane,
+                                        _mm_castsi128_ps(_mm_set_epi32(0, -1, -1, -1) ));
+        __m128 length_sqr = _system_math_matrix4x4_sum4(_mm_mul_ps(normal, normal) );
+
+        _mm_storeu_ps(plane_ptr,
+                      _mm_div_ps(plane,
+                                 _mm_sqrt_ps(length_sqr) ));
+#else
+        float length;
+
+        for (unsigned int n_component = 0;
+                          n_component < 4;
+                        ++n_component)
+        {
+            plane_ptr[n_component] = mvp_ptr->data[12 + n_component] + signs[n_plane] * row_ptr[n_component];
+        }
+
+        length = sqrtf(plane_ptr[0] * plane_ptr[0] +
+                       plane_ptr[1] * plane_ptr[1] +
+                       plane_ptr[2] * plane_ptr[2]);
+
+        for (unsigned int n_component = 0;
+                          n_component < 4;
+                        ++n_component)
+        {
+            plane_ptr[n_component] /= length;
+        }
+#endif
+    }
+}
+
+/** Inverts a matrix.
+ *
+ *  @param matrix_ptr     Matrix to invert.
+ *  @param out_result_ptr Deref will be set to the inverse. May be equal to @param matrix_ptr.
+ *                        Not modified if the matrix is singular.
+ *
+ *  @return true if successful, false if the matrix is singular.
+ */
+inline bool system_math_matrix4x4_invert(const system_math_matrix4x4* matrix_ptr,
+                                               system_math_matrix4x4* out_result_ptr)
+{
+#ifdef SYSTEM_MATH_MATRIX4X4_USE_SSE
+    /* Block-wise inversion. The matrix is split into 2x2 sub-matrices:
+     *
+     * M = | A B |
+     *     | C D |
+     *
+     * and the inverse is built from their adjugates and determinants.
+     */
+    const __m128 row0 = _mm_loadu_ps(matrix_ptr->data + 0);
+    const __m128 row1 = _mm_loadu_ps(matrix_ptr->data + 4);
+    const __m128 row2 = _mm_loadu_ps(matrix_ptr->data + 8);
+    const __m128 row3 = _mm_loadu_ps(matrix_ptr->data + 12);
+
+    const __m128 a = _mm_movelh_ps(row0, row1);
+    const __m128 b = _mm_movehl_ps(row1, row0);
+    const __m128 c = _mm_movelh_ps(row2, row3);
+    const __m128 d = _mm_movehl_ps(row3, row2);
+
+    /* (|A|, |B|, |C|, |D|) */
+    const __m128 det_sub = _mm_sub_ps(_mm_mul_ps(SYSTEM_MATH_MATRIX4X4_SHUFFLE(row0, row2, 0, 2, 0, 2),
+                                                 SYSTEM_MATH_MATRIX4X4_SHUFFLE(row1, row3, 1, 3, 1, 3) ),
+                                      _mm_mul_ps(SYSTEM_MATH_MATRIX4X4_SHUFFLE(row0, row2, 1, 3, 1, 3),
+                                                 SYSTEM_MATH_MATRIX4X4_SHUFFLE(row1, row3, 0, 2, 0, 2) ));
+    const __m128 det_a   = SYSTEM_MATH_MATRIX4X4_SWIZZLE(det_sub, 0, 0, 0, 0);
+    const __m128 det_b   = SYSTEM_MATH_MATRIX4X4_SWIZZLE(det_sub, 1, 1, 1, 1);
+    const __m128 det_c   = SYSTEM_MATH_MATRIX4X4_SWIZZLE(det_sub, 2, 2, 2, 2);
+    const __m128 det_d   = SYSTEM_MATH_MATRIX4X4_SWIZZLE(det_sub, 3, 3, 3, 3);
+
+    const __m128 d_c = _system_math_matrix4x4_mat2_adj_mul(d, c);
+    const __m128 a_b = _system_math_matrix4x4_mat2_adj_mul(a, b);
+
+          __m128 x = _mm_sub_ps(_mm_mul_ps(det_d, a), _system_math_matrix4x4_mat2_mul    (b, d_c) );
+          __m128 w = _mm_sub_ps(_mm_mul_ps(det_a, d), _system_math_matrix4x4_mat2_mul    (c, a_b) );
+          __m128 y = _mm_sub_ps(_mm_mul_ps(det_b, c), _system_math_matrix4x4_mat2_mul_adj(d, a_b) );
+          __m128 z = _mm_sub_ps(_mm_mul_ps(det_c, b), _system_math_matrix4x4_mat2_mul_adj(a, d_c) );
+
+    /* |M| = |A| |D| + |B| |C| - tr(adj(A) B adj(D) C) */
+    const __m128 trace = _system_math_matrix4x4_sum4(_mm_mul_ps(a_b,
+                                                                SYSTEM_MATH_MATRIX4X4_SWIZZLE(d_c, 0, 2, 1, 3) ));
+    const __m128 det   = _mm_sub_ps(_mm_add_ps(_mm_mul_ps(det_a, det_d),
+                                               _mm_mul_ps(det_b, det_c) ),
+                                    trace);
+
+    if (fabs(_mm_cvtss_f32(det) ) <= 1e-7f)
+    {
+        return false;
+    }
+
+    const __m128 inv_det = _mm_div_ps(_mm_setr_ps(1.0f, -1.0f, -1.0f, 1.0f),
+                                      det);
+
+    x = _mm_mul_ps(x, inv_det);
+    y = _mm_mul_ps(y, inv_det);
+    z = _mm_mul_ps(z, inv_det);
+    w = _mm_mul_ps(w, inv_det);
+
+    /* Apply the adjugate to the blocks and put them back together */
+    _mm_storeu_ps(out_result_ptr->data + 0,  SYSTEM_MATH_MATRIX4X4_SHUFFLE(x, y, 3, 1, 3, 1) );
+    _mm_storeu_ps(out_result_ptr->data + 4,  SYSTEM_MATH_MATRIX4X4_SHUFFLE(x, y, 2, 0, 2, 0) );
+    _mm_storeu_ps(out_result_ptr->data + 8,  SYSTEM_MATH_MATRIX4X4_SHUFFLE(z, w, 3, 1, 3, 1) );
+    _mm_storeu_ps(out_result_ptr->data + 12, SYSTEM_MATH_MATRIX4X4_SHUFFLE(z, w, 2, 0, 2, 0) );
+#else
+    /* Cofactor expansion using 2x2 sub-determinants of the top and bottom row pairs */
+    const float* m = matrix_ptr->data;
+    float        result[16];
+
+    const float s0 = m[0] * m[5]  - m[4]  * m[1];
+    const float s1 = m[0] * m[6]  - m[4]  * m[2];
+    const float s2 = m[0] * m[7]  - m[4]  * m[3];
+    const float s3 = m[1] * m[6]  - m[5]  * m[2];
+    const float s4 = m[1] * m[7]  - m[5]  * m[3];
+    const float s5 = m[2] * m[7]  - m[6]  * m[3];
+    const float c5 = m[10] * m[15] - m[14] * m[11];
+    const float c4 = m[9]  * m[15] - m[13] * m[11];
+    const float c3 = m[9]  * m[14] - m[13] * m[10];
+    const float c2 = m[8]  * m[15] - m[12] * m[11];
+    const float c1 = m[8]  * m[14] - m[12] * m[10];
+    const float c0 = m[8]  * m[13] - m[12] * m[9];
+    const float det = s0 * c5 - s1 * c4 + s2 * c3 + s3 * c2 - s4 * c1 + s5 * c0;
+
+    if (fabs(det) <= 1e-7f)
+    {
+        return false;
+    }
+
+    const float inv_det = 1.0f / det;
+
+    result[0]  = ( m[5]  * c5 - m[6]  * c4 + m[7]  * c3) * inv_det;
+    result[1]  = (-m[1]  * c5 + m[2]  * c4 - m[3]  * c3) * inv_det;
+    result[2]  = ( m[13] * s5 - m[14] * s4 + m[15] * s3) * inv_det;
+    result[3]  = (-m[9]  * s5 + m[10] * s4 - m[11] * s3) * inv_det;
+    result[4]  = (-m[4]  * c5 + m[6]  * c2 - m[7]  * c1) * inv_det;
+    result[5]  = ( m[0]  * c5 - m[2]  * c2 + m[3]  * c1) * inv_det;
+    result[6]  = (-m[12] * s5 + m[14] * s2 - m[15] * s1) * inv_det;
+    result[7]  = ( m[8]  * s5 - m[10] * s2 + m[11] * s1) * inv_det;
+    result[8]  = ( m[4]  * c4 - m[5]  * c2 + m[7]  * c0) * inv_det;
+    result[9]  = (-m[0]  * c4 + m[1]  * c2 - m[3]  * c0) * inv_det;
+    result[10] = ( m[12] * s4 - m[13] * s2 + m[15] * s0) * inv_det;
+    result[11] = (-m[8]  * s4 + m[9]  * s2 - m[11] * s0) * inv_det;
+    result[12] = (-m[4]  * c3 + m[5]  * c1 - m[6]  * c0) * inv_det;
+    result[13] = ( m[0]  * c3 - m[1]  * c1 + m[2]  * c0) * inv_det;
+    result[14] = (-m[12] * s3 + m[13] * s1 - m[14] * s0) * inv_det;
+    result[15] = ( m[8]  * s3 - m[9]  * s1 + m[10] * s0) * inv_det;
+
+    memcpy(out_result_ptr->data,
+           result,
+           sizeof(result) );
+#endif
+
+    return true;
+}
+
+/** Tells whether an axis-aligned box lies entirely outside the frustum described by a
+ *  (model-)view-projection matrix. The box is expected to be defined in the space the
+ *  matrix transforms from, so passing an MVP and a model-space AABB tests the box's
+ *  world-space OBB against the camera frustum.
+ *
+ *  This is equivalent to transforming all eight corners of the box and checking whether
+ *  all of them are on the negative side of any of the clipping planes, but only needs to
+ *  evaluate one (center, extent) pair per plane.
+ *
+ *  @param mvp_ptr      Matrix to extract clipping planes from.
+ *  @param aabb_min_ptr Minimum XYZ coordinates of the box.
+ *  @param aabb_max_ptr Maximum XYZ coordinates of the box.
+ *
+ *  @return true if the box is outside the frustum and can be culled, false otherwise.
+ */
+inline bool system_math_matrix4x4_is_aabb_outside_frustum(const system_math_matrix4x4* mvp_ptr,
+                                                          const float*                 aabb_min_ptr,
+                                                          const float*                 aabb_max_ptr)
+{
+    static const int   row_indices[SYSTEM_MATH_MATRIX4X4_N_CLIPPING_PLANES] = {1,     2,     0,    2,    0,     1};
+    static const float signs      [SYSTEM_MATH_MATRIX4X4_N_CLIPPING_PLANES] = {1.0f, -1.0f,  1.0f, 1.0f, -1.0f, -1.0f};
+
+    const float center[4] =
+    {
+        (aabb_max_ptr[0] + aabb_min_ptr[0]) * 0.5f,
+        (aabb_max_ptr[1] + aabb_min_ptr[1]) * 0.5f,
+        (aabb_max_ptr[2] + aabb_min_ptr[2]) * 0.5f,
+        1.0f
+    };
+    const float extent[4] =
+    {
+        (aabb_max_ptr[0] - aabb_min_ptr[0]) * 0.5f,
+        (aabb_max_ptr[1] - aabb_min_ptr[1]) * 0.5f,
+        (aabb_max_ptr[2] - aabb_min_ptr[2]) * 0.5f,
+        0.0f
+    };
+
+#ifdef SYSTEM_MATH_MATRIX4X4_USE_SSE
+    const __m128 abs_mask    = _mm_castsi128_ps(_mm_set1_epi32(0x7FFFFFFF) );
+    const __m128 center_sse  = _mm_loadu_ps(center);
+    const __m128 extent_sse  = _mm_loadu_ps(extent);
+    const __m128 row3        = _mm_loadu_ps(mvp_ptr->data + 12);
+#endif
+
+    for (unsigned int n_plane = 0;
+                      n_plane < SYSTEM_MATH_MATRIX4X4_N_CLIPPING_PLANES;
+                    ++n_plane)
+    {
+        const float* row_ptr = mvp_ptr->data + row_indices[n_plane] * 4;
+
+        /* The corner which lies furthest along the plane normal is at
+         * center + sum(sign(normal[i]) * extent[i]). If even that one is outside, all others are too. */
+#ifdef SYSTEM_MATH_MATRIX4X4_USE_SSE
+        const __m128 plane    = _mm_add_ps(row3,
+                                           _mm_mul_ps(_mm_set1_ps (signs[n_plane]),
+                                                      _mm_loadu_ps(row_ptr) ));
+        const __m128 distance = _system_math_matrix4x4_sum4(_mm_add_ps(_mm_mul_ps(plane,
+                                                                                  center_sse),
+                                                                       _mm_mul_ps(_mm_and_ps(plane,
+                                                                                             abs_mask),
+                                                                                  extent_sse) ));
+
+        if (_mm_cvtss_f32(distance) < 0.0f)
+        {
+            return true;
+        }
+#else
+        float distance = 0.0f;
+
+        for (unsigned int n_component = 0;
+                          n_component < 4;
+                        ++n_component)
+        {
+            const float plane_coeff = mvp_ptr->data[12 + n_component] + signs[n_plane] * row_ptr[n_component];
+
+            distance += plane_coeff * center[n_component] + fabsf(plane_coeff) * extent[n_component];
+        }
+
+        if (distance < 0.0f)
+        {
+            return true;
+        }
+#endif
+    }
+
+    return false;
+}
+
+/** Multiplies two matrices.
+ *
+ *  @param a_ptr          Left-hand matrix.
+ *  @param b_ptr          Right-hand matrix.
+ *  @param out_result_ptr Deref will be set to a * b. May be equal to @param a_ptr or @param b_ptr.
+ */
+inline void system_math_matrix4x4_mul(const system_math_matrix4x4* a_ptr,
+                                      const system_math_matrix4x4* b_ptr,
+                                            system_math_matrix4x4* out_result_ptr)
+{
+#if defined(SYSTEM_MATH_MATRIX4X4_USE_AVX)
+    /* Computes two result rows at once. Each 128-bit lane holds one row of A and
+     * is multiplied by a copy of B's rows. */
+    const __m256 b0 = _mm256_broadcast_ps(reinterpret_cast<const __m128*>(b_ptr->data + 0) );
+    const __m256 b1 = _mm256_broadcast_ps(reinterpret_cast<const __m128*>(b_ptr->data + 4) );
+    const __m256 b2 = _mm256_broadcast_ps(reinterpret_cast<const __m128*>(b_ptr->data + 8) );
+    const __m256 b3 = _mm256_broadcast_ps(reinterpret_cast<const __m128*>(b_ptr->data + 12) );
+
+    const __m256 a01 = _mm256_loadu_ps(a_ptr->data + 0);
+    const __m256 a23 = _mm256_loadu_ps(a_ptr->data + 8);
+
+    const __m256 result01 = _mm256_add_ps(_mm256_add_ps(_mm256_mul_ps(_mm256_permute_ps(a01, 0x00), b0),
+                                                        _mm256_mul_ps(_mm256_permute_ps(a01, 0x55), b1) ),
+                                          _mm256_add_ps(_mm256_mul_ps(_mm256_permute_ps(a01, 0xAA), b2),
+                                                        _mm256_mul_ps(_mm256_permute_ps(a01, 0xFF), b3) ));
+    const __m256 result23 = _mm256_add_ps(_mm256_add_ps(_mm256_mul_ps(_mm256_permute_ps(a23, 0x00), b0),
+                                                        _mm256_mul_ps(_mm256_permute_ps(a23, 0x55), b1) ),
+                                          _mm256_add_ps(_mm256_mul_ps(_mm256_permute_ps(a23, 0xAA), b2),
+                                                        _mm256_mul_ps(_mm256_permute_ps(a23, 0xFF), b3) ));
+
+    _mm256_storeu_ps(out_result_ptr->data + 0, result01);
+    _mm256_storeu_ps(out_result_ptr->data + 8, result23);
+#elif defined(SYSTEM_MATH_MATRIX4X4_USE_SSE)
+    const __m128 b0 = _mm_loadu_ps(b_ptr->data + 0);
+    const __m128 b1 = _mm_loadu_ps(b_ptr->data + 4);
+    const __m128 b2 = _mm_loadu_ps(b_ptr->data + 8);
+    const __m128 b3 = _mm_loadu_ps(b_ptr->data + 12);
+    __m128       result[4];
+
+    /* result.row[n] = sum(a[n][k] * b.row[k]) */
+    for (unsigned int n_row = 0;
+                      n_row < 4;
+                    ++n_row)
+    {
+        const __m128 a_row = _mm_loadu_ps(a_ptr->data + n_row * 4);
+
+        result[n_row] = _mm_add_ps(_mm_add_ps(_mm_mul_ps(SYSTEM_MATH_MATRIX4X4_SWIZZLE(a_row, 0, 0, 0, 0), b0),
+                                              _mm_mul_ps(SYSTEM_MATH_MATRIX4X4_SWIZZLE(a_row, 1, 1, 1, 1), b1) ),
+                                   _mm_add_ps(_mm_mul_ps(SYSTEM_MATH_MATRIX4X4_SWIZZLE(a_row, 2, 2, 2, 2), b2),
+                                              _mm_mul_ps(SYSTEM_MATH_MATRIX4X4_SWIZZLE(a_row, 3, 3, 3, 3), b3) ));
+    }
+
+    for (unsigned int n_row = 0;
+                      n_row < 4;
+                    ++n_row)
+    {
+        _mm_storeu_ps(out_result_ptr->data + n_row * 4,
+                      result[n_row]);
+    }
+#else
+    float result[16];
+
+    for (unsigned int n_row = 0;
+                      n_row < 4;
+                    ++n_row)
+    {
+        for (unsigned int n_column = 0;
+                          n_column < 4;
+                        ++n_column)
+        {
+            result[n_row * 4 + n_column] = a_ptr->data[n_row * 4 + 0] * b_ptr->data[0  + n_column] +
+                                           a_ptr->data[n_row * 4 + 1] * b_ptr->data[4  + n_column] +
+                                           a_ptr->data[n_row * 4 + 2] * b_ptr->data[8  + n_column] +
+                                           a_ptr->data[n_row * 4 + 3] * b_ptr->data[12 + n_column];
+        }
+    }
+
+    memcpy(out_result_ptr->data,
+           result,
+           sizeof(result) );
+#endif
+}
+
+/** Sets a matrix to identity.
+ *
+ *  @param out_result_ptr Matrix to update.
+ */
+inline void system_math_matrix4x4_set_identity(system_math_matrix4x4* out_result_ptr)
+{
+    static const float identity[16] =
+    {
+        1.0f, 0.0f, 0.0f, 0.0f,
+        0.0f, 1.0f, 0.0f, 0.0f,
+        0.0f, 0.0f, 1.0f, 0.0f,
+        0.0f, 0.0f, 0.0f, 1.0f
+    };
+
+    memcpy(out_result_ptr->data,
+           identity,
+           sizeof(identity) );
+}
+
+/** Sets a matrix from 16 floats stored in row-major order, as returned by
+ *  system_matrix4x4_get_row_major_data().
+ *
+ *  @param row_major_data_ptr Data to use.
+ *  @param out_result_ptr     Matrix to update.
+ */
+inline void system_math_matrix4x4_set_from_row_major(const float*                 row_major_data_ptr,
+                                                           system_math_matrix4x4* out_result_ptr)
+{
+    memcpy(out_result_ptr->data,
+           row_major_data_ptr,
+           sizeof(out_result_ptr->data) );
+}
+
+/** Sets a matrix to a rotation around an arbitrary axis. The axis is normalized if needed.
+ *
+ *  @param angle          Rotation angle, in radians.
+ *  @param xyz_ptr        Rotation axis.
+ *  @param out_result_ptr Matrix to update.
+ */
+inline void system_math_matrix4x4_set_rotation(float                  angle,
+                                               const float*           xyz_ptr,
+                                               system_math_matrix4x4* out_result_ptr)
+{
+    const float c           = cosf(angle);
+    const float s           = sinf(angle);
+    const float length_sqr  = xyz_ptr[0] * xyz_ptr[0] + xyz_ptr[1] * xyz_ptr[1] + xyz_ptr[2] * xyz_ptr[2];
+    const float inv_length  = (length_sqr > 0.0f) ? (1.0f / sqrtf(length_sqr) ) : 0.0f;
+    const float x           = xyz_ptr[0] * inv_length;
+    const float y           = xyz_ptr[1] * inv_length;
+    const float z           = xyz_ptr[2] * inv_length;
+    const float one_minus_c = 1.0f - c;
+    float*      data_ptr    = out_result_ptr->data;
+
+    data_ptr[0]  = x * x * one_minus_c + c;
+    data_ptr[1]  = x * y * one_minus_c - z * s;
+    data_ptr[2]  = x * z * one_minus_c + y * s;
+    data_ptr[3]  = 0.0f;
+    data_ptr[4]  = x * y * one_minus_c + z * s;
+    data_ptr[5]  = y * y * one_minus_c + c;
+    data_ptr[6]  = y * z * one_minus_c - x * s;
+    data_ptr[7]  = 0.0f;
+    data_ptr[8]  = x * z * one_minus_c - y * s;
+    data_ptr[9]  = y * z * one_minus_c + x * s;
+    data_ptr[10] = z * z * one_minus_c + c;
+    data_ptr[11] = 0.0f;
+    data_ptr[12] = 0.0f;
+    data_ptr[13] = 0.0f;
+    data_ptr[14] = 0.0f;
+    data_ptr[15] = 1.0f;
+}
+
+/** Sets a matrix to a scaling matrix.
+ *
+ *  @param xyz_ptr        Scale factors to use.
+ *  @param out_result_ptr Matrix to update.
+ */
+inline void system_math_matrix4x4_set_scale(const float*           xyz_ptr,
+                                            system_math_matrix4x4* out_result_ptr)
+{
+    system_math_matrix4x4_set_identity(out_result_ptr);
+
+    out_result_ptr->data[0]  = xyz_ptr[0];
+    out_result_ptr->data[5]  = xyz_ptr[1];
+    out_result_ptr->data[10] = xyz_ptr[2];
+}
+
+/** Sets a matrix to a translation matrix.
+ *
+ *  @param xyz_ptr        Translation vector.
+ *  @param out_result_ptr Matrix to update.
+ */
+inline void system_math_matrix4x4_set_translation(const float*           xyz_ptr,
+                                                  system_math_matrix4x4* out_result_ptr)
+{
+    system_math_matrix4x4_set_identity(out_result_ptr);
+
+    out_result_ptr->data[3]  = xyz_ptr[0];
+    out_result_ptr->data[7]  = xyz_ptr[1];
+    out_result_ptr->data[11] = xyz_ptr[2];
+}
+
+/** Transforms an axis-aligned box by a matrix and returns an axis-aligned box, which
+ *  encloses the result. This gives the same result as transforming all eight corners and
+ *  taking their per-component minimum and maximum, as long as the matrix is affine.
+ *
+ *  @param matrix_ptr       Matrix to use. Must be affine.
+ *  @param aabb_min_ptr     Minimum XYZ coordinates of the box.
+ *  @param aabb_max_ptr     Maximum XYZ coordinates of the box.
+ *  @param out_aabb_min_ptr Deref will be set to minimum XYZ coordinates of the transformed box.
+ *  @param out_aabb_max_ptr Deref will be set to maximum XYZ coordinates of the transformed box.
+ */
+inline void system_math_matrix4x4_transform_aabb(const system_math_matrix4x4* matrix_ptr,
+                                                 const float*                 aabb_min_ptr,
+                                                 const float*                 aabb_max_ptr,
+                                                 float*                       out_aabb_min_ptr,
+                                                 float*                       out_aabb_max_ptr)
+{
+    /* Start with the translation and then, for each axis, add whichever of the
+     * two candidate contributions is smaller or larger (Arvo's method). */
+    float result_max[3];
+    float result_min[3];
+
+    for (unsigned int n_row = 0;
+                      n_row < 3;
+                    ++n_row)
+    {
+        result_max[n_row] = matrix_ptr->data[n_row * 4 + 3];
+        result_min[n_row] = matrix_ptr->data[n_row * 4 + 3];
+
+        for (unsigned int n_column = 0;
+                          n_column < 3;
+                        ++n_column)
+        {
+            const float contribution1 = matrix_ptr->data[n_row * 4 + n_column] * aabb_min_ptr[n_column];
+            const float contribution2 = matrix_ptr->data[n_row * 4 + n_column] * aabb_max_ptr[n_column];
+
+            if (contribution1 < contribution2)
+            {
+                result_min[n_row] += contribution1;
+                result_max[n_row] += contribution2;
+            }
+            else
+            {
+                result_min[n_row] += contribution2;
+                result_max[n_row] += contribution1;
+            }
+        }
+    }
+
+    memcpy(out_aabb_max_ptr,
+           result_max,
+           sizeof(result_max) );
+    memcpy(out_aabb_min_ptr,
+           result_min,
+           sizeof(result_min) );
+}
+
+/** Multiplies a matrix by a 4-component column vector.
+ *
+ *  @param matrix_ptr     Matrix to use.
+ *  @param vector_ptr     Vector to transform.
+ *  @param out_result_ptr Deref will be set to the transformed vector. May be equal to @param vector_ptr.
+ */
+inline void system_math_matrix4x4_transform_vector4(const system_math_matrix4x4* matrix_ptr,
+                                                    const float*                 vector_ptr,
+                                                    float*                       out_result_ptr)
+{
+#ifdef SYSTEM_MATH_MATRIX4X4_USE_SSE
+    /* Use the transposed form, so that the result can be accumulated without horizontal adds */
+    __m128 row0 = _mm_loadu_ps(matrix_ptr->data + 0);
+    __m128 row1 = _mm_loadu_ps(matrix_ptr->data + 4);
+    __m128 row2 = _mm_loadu_ps(matrix_ptr->data + 8);
+    __m128 row3 = _mm_loadu_ps(matrix_ptr->data + 12);
+    __m128 v    = _mm_loadu_ps(vector_ptr);
+
+    _MM_TRANSPOSE4_PS(row0, row1, row2, row3);
+
+    _mm_storeu_ps(out_result_ptr,
+                  _mm_add_ps(_mm_add_ps(_mm_mul_ps(row0, SYSTEM_MATH_MATRIX4X4_SWIZZLE(v, 0, 0, 0, 0) ),
+                                        _mm_mul_ps(row1, SYSTEM_MATH_MATRIX4X4_SWIZZLE(v, 1, 1, 1, 1) )),
+                             _mm_add_ps(_mm_mul_ps(row2, SYSTEM_MATH_MATRIX4X4_SWIZZLE(v, 2, 2, 2, 2) ),
+                                        _mm_mul_ps(row3, SYSTEM_MATH_MATRIX4X4_SWIZZLE(v, 3, 3, 3, 3) ))) );
+#else
+    float result[4];
+
+    for (unsigned int n_row = 0;
+                      n_row < 4;
+                    ++n_row)
+    {
+        result[n_row] = matrix_ptr->data[n_row * 4 + 0] * vector_ptr[0] +
+                        matrix_ptr->data[n_row * 4 + 1] * vector_ptr[1] +
+                        matrix_ptr->data[n_row * 4 + 2] * vector_ptr[2] +
+                        matrix_ptr->data[n_row * 4 + 3] * vector_ptr[3];
+    }
+
+    memcpy(out_result_ptr,
+           result,
+           sizeof(result) );
+#endif
+}
+
+#endif /* SYSTEM_MATH_MATRIX4X4_H */
@@ -21,6 +21,24 @@ enum system_matrix4x4_clipping_plane
 
 };
 
+/** Implementations available for the batch functions (system_matrix4x4_multiply_many(),
+ *  system_matrix4x4_transform_aabbs() and system_matrix4x4_transform_points_soa() ).
+ *  The fastest one supported by the running CPU is picked at start-up. */
+typedef enum
+{
+    /* Plain C++. Always available. */
+    SYSTEM_MATRIX4X4_KERNEL_SET_SCALAR,
+
+    /* SSE2. Available if Emerald has been built for a CPU which supports it. */
+    SYSTEM_MATRIX4X4_KERNEL_SET_SSE2,
+
+    /* AVX2 & FMA3. Available on x86 builds if the CPU supports both extensions. */
+    SYSTEM_MATRIX4X4_KERNEL_SET_AVX2,
+
+    /* Always last */
+    SYSTEM_MATRIX4X4_KERNEL_SET_COUNT
+} system_matrix4x4_kernel_set;
+
 /** Creates a new instance of 4x4 matrix object without initializing the data.
  *
  *  @return New 4x4 matrix instance.
@@ -109,6 +127,12 @@ PUBLIC EMERALD_API const float* system_matrix4x4_get_row_major_data(system_matri
 PUBLIC EMERALD_API system_matrix4x4 system_matrix4x4_create_by_mul(system_matrix4x4 a,
                                                                    system_matrix4x4 b);
 
+/** Returns the implementation currently used by the batch functions.
+ *
+ *  @return As per description.
+ */
+PUBLIC EMERALD_API system_matrix4x4_kernel_set system_matrix4x4_get_kernel_set();
+
 /** Inverts a 4x4 matrix object.
  *
  *  @param system_matrix4x4 4x4 matrix object to invert.
@@ -160,6 +184,25 @@ PUBLIC EMERALD_API void system_matrix4x4_multiply_by_vector3(system_matrix4x4 ma
                                                              const float*     vector,
                                                              float*           out_result_ptr);
 
+/** Multiplies @param n_matrices pairs of matrices, so that:
+ *
+ *  out[i] = a[i] * b[i]
+ *
+ *  Matrices are passed as tightly packed arrays of 16 floats stored in row-major order, as
+ *  returned by system_matrix4x4_get_row_major_data(). Use this function instead of
+ *  system_matrix4x4_create_by_mul() when a large number of matrices needs to be multiplied.
+ *
+ *  @param a_row_major_data_ptr   Left-hand matrices.
+ *  @param b_row_major_data_ptr   Right-hand matrices.
+ *  @param n_matrices             Number of matrix pairs to multiply.
+ *  @param out_row_major_data_ptr Deref will be filled with @param n_matrices results. May be equal to
+ *                                @param a_row_major_data_ptr or @param b_row_major_data_ptr.
+ */
+PUBLIC EMERALD_API void system_matrix4x4_multiply_many(const float* a_row_major_data_ptr,
+                                                       const float* b_row_major_data_ptr,
+                                                       unsigned int n_matrices,
+                                                       float*       out_row_major_data_ptr);
+
 /** Rotates 4x4 matrix object using user provided angle and 3-diemnsional rotation vector.
  *  Result is stored in the object.
  *
@@ -225,6 +268,15 @@ PUBLIC EMERALD_API void system_matrix4x4_set_from_row_major_raw(system_matrix4x4
 PUBLIC EMERALD_API void system_matrix4x4_set_from_matrix4x4(system_matrix4x4 dst_matrix,
                                                             system_matrix4x4 src_matrix);
 
+/** Sets the implementation to be used by the batch functions. Meant for testing & benchmarking.
+ *  Must not be called while other threads may be calling any of the batch functions.
+ *
+ *  @param kernel_set Implementation to use.
+ *
+ *  @return true if the implementation is supported and has been activated, false otherwise.
+ */
+PUBLIC EMERALD_API bool system_matrix4x4_set_kernel_set(system_matrix4x4_kernel_set kernel_set);
+
 /** Multiples 4x4 matrix object with translatino matrix. Result is stored in the object.
  *
  *  @param system_matrix4x4 4x4 matrix to translate.
@@ -233,6 +285,49 @@ PUBLIC EMERALD_API void system_matrix4x4_set_from_matrix4x4(system_matrix4x4 dst
 PUBLIC EMERALD_API void system_matrix4x4_translate(system_matrix4x4 matrix,
                                                    const float*     xyz_ptr);
 
+/** Transforms @param n_aabbs axis-aligned boxes by a matrix. For each box, the function returns
+ *  the smallest axis-aligned box enclosing the transformed one. The matrix must be affine.
+ *
+ *  Boxes are defined by arrays of XYZ triples, storing minimum and maximum coordinates.
+ *
+ *  @param matrix           4x4 matrix to use.
+ *  @param n_aabbs          Number of boxes to transform.
+ *  @param aabb_min_ptr     @param n_aabbs XYZ triples defining minimum coordinates of the boxes.
+ *  @param aabb_max_ptr     @param n_aabbs XYZ triples defining maximum coordinates of the boxes.
+ *  @param out_aabb_min_ptr Deref will be filled with minimum coordinates of the transformed boxes.
+ *                          May be equal to @param aabb_min_ptr.
+ *  @param out_aabb_max_ptr Deref will be filled with maximum coordinates of the transformed boxes.
+ *                          May be equal to @param aabb_max_ptr.
+ */
+PUBLIC EMERALD_API void system_matrix4x4_transform_aabbs(system_matrix4x4 matrix,
+                                                         unsigned int     n_aabbs,
+                                                         const float*     aabb_min_ptr,
+                                                         const float*     aabb_max_ptr,
+                                                         float*           out_aabb_min_ptr,
+                                                         float*           out_aabb_max_ptr);
+
+/** Transforms @param n_points 3D points by a matrix. The points are stored in structure-of-arrays
+ *  layout, that is: X, Y and Z components are stored in separate arrays. W is assumed to be 1,
+ *  and the bottom row of the matrix is ignored, so the matrix should be affine.
+ *
+ *  @param matrix    4x4 matrix to use.
+ *  @param n_points  Number of points to transform.
+ *  @param x_ptr     X components of the points.
+ *  @param y_ptr     Y components of the points.
+ *  @param z_ptr     Z components of the points.
+ *  @param out_x_ptr Deref will be filled with X components of the transformed points. May be equal to @param x_ptr.
+ *  @param out_y_ptr Deref will be filled with Y components of the transformed points. May be equal to @param y_ptr.
+ *  @param out_z_ptr Deref will be filled with Z components of the transformed points. May be equal to @param z_ptr.
+ */
+PUBLIC EMERALD_API void system_matrix4x4_transform_points_soa(system_matrix4x4 matrix,
+                                                              unsigned int     n_points,
+                                                              const float*     x_ptr,
+                                                              const float*     y_ptr,
+                                                              const float*     z_ptr,
+                                                              float*           out_x_ptr,
+                                                              float*           out_y_ptr,
+                                                              float*           out_z_ptr);
+
 /** Transposes a 4x4 matrix object. Result is stored in the object.
  *
  *  @param system_matrix4x4 4x4 matrix to transpose.
@@ -2,7 +2,13 @@
  *
  * Emerald (kbi/elude @2015)
  *
- * Implements a "first fit, decreasing size" memory allocation policy.
+ * Implements two memory allocation policies:
+ *
+ * - "first fit, decreasing size", which tracks the available regions in a list. Both alloc
+ *   and free operations are linear in the number of blocks. Released blocks are not coalesced.
+ * - TLSF (two-level segregated fit), which performs alloc and free operations in constant time
+ *   and coalesces released blocks with their free neighbours immediately. This policy should be
+ *   preferred for regions, whose contents are frequently streamed in and out.
  *
  * The module transfers the task of physically allocating and releasing
  * the memory blocks to parents. This allows for cascaded memory allocator
@@ -29,6 +35,23 @@ typedef void (*PFNSYSTEMMEMORYMANAGERFREEBLOCKPROC) (system_memory_manager manag
                                                      unsigned int          size,
                                                      void*                 user_arg);
 
+typedef enum
+{
+    SYSTEM_MEMORY_MANAGER_POLICY_FIRST_FIT,
+    SYSTEM_MEMORY_MANAGER_POLICY_TLSF
+} system_memory_manager_policy;
+
+/* Describes how fragmented the free space of a memory manager is. */
+typedef struct
+{
+    unsigned int largest_free_block_size;
+    unsigned int n_free_blocks;
+    unsigned int total_free_size;
+
+    /* n-th item holds the number of free blocks, whose size falls within [2^n, 2^(n+1)) */
+    unsigned int n_free_blocks_per_size_log2[32];
+} system_memory_manager_fragmentation_report;
+
 
 /** TODO
  *
@@ -52,18 +75,32 @@ PUBLIC EMERALD_API bool system_memory_manager_alloc_block(system_memory_manager
                                                           unsigned int          required_alignment,
                                                           unsigned int*         out_allocation_offset);
 
-/** TODO */
+/** TODO
+ *
+ *  @param policy Allocation policy to use. Please see the description at the top of the file.
+ **/
 PUBLIC EMERALD_API system_memory_manager system_memory_manager_create(unsigned int                         memory_region_size,
                                                                       unsigned int                         page_size,
                                                                       PFNSYSTEMMEMORYMANAGERALLOCBLOCKPROC pfn_on_memory_block_alloced,
                                                                       PFNSYSTEMMEMORYMANAGERFREEBLOCKPROC  pfn_on_memory_block_freed,
                                                                       void*                                user_arg,
-                                                                      bool                                 should_be_thread_safe);
+                                                                      bool                                 should_be_thread_safe,
+                                                                      system_memory_manager_policy         policy = SYSTEM_MEMORY_MANAGER_POLICY_FIRST_FIT);
 
 /** TODO */
 PUBLIC EMERALD_API void system_memory_manager_free_block(system_memory_manager manager,
                                                          unsigned int          alloc_offset);
 
+/** Describes the free space of the specified memory manager.
+ *
+ *  Walks all free blocks, so should not be called on hot paths.
+ *
+ *  @param manager        Memory manager to use.
+ *  @param out_report_ptr Deref will be filled with the report. Must not be NULL.
+ **/
+PUBLIC EMERALD_API void system_memory_manager_get_fragmentation_report(system_memory_manager                       manager,
+                                                                       system_memory_manager_fragmentation_report* out_report_ptr);
+
 /** TODO */
 PUBLIC EMERALD_API void system_memory_manager_release(system_memory_manager manager);
 
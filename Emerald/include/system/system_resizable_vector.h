@@ -158,7 +158,16 @@ PUBLIC EMERALD_API void system_resizable_vector_set_element_at(system_resizable_
                                                                size_t                  index,
                                                                void*                   element);
 
-/** TODO */
+/** Sorts the vector using a pattern-defeating introsort, which runs in O(n log n) time, also for sorted,
+ *  reverse-sorted and other adversarial input. The sort is not stable.
+ *
+ *  Vectors holding at least RESIZABLE_VECTOR_PARALLEL_SORT_THRESHOLD elements are sorted using all thread
+ *  pool workers, so the comparator must be safe to call from multiple threads at the same time.
+ *
+ *  @param resizable_vector    Resizable vector to sort.
+ *  @param comparator_func_ptr Function which should return true if the first element should be placed
+ *                             before the second one.
+ */
 PUBLIC EMERALD_API void system_resizable_vector_sort(system_resizable_vector resizable_vector,
                                                      bool                  (*comparator_func_ptr)(const void*, const void*) );
 
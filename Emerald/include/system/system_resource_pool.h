@@ -3,15 +3,33 @@
  *  Emerald (kbi/elude @2012-2015)
  *
  *  @brief Resource pool is a structure that pre-allocates user-defined amount of elements in blobs.
- *         First get() call retrieves the element from the array. If the element is returned to the
- *         pool, it is moved to a resizable vector, and then reported to the caller() with the first
- *         get_from_pool() call.
+ *         Each thread caches blocks in its own magazine, so that most get() and return() calls
+ *         do not need any synchronization. Magazines exchange batches of blocks with a lock-free
+ *         list shared by all threads. New blocks are only carved out of the blobs when both
+ *         the magazine and the shared list are empty.
  */
 #ifndef SYSTEM_RESOURCE_POOL_H
 #define SYSTEM_RESOURCE_POOL_H
 
 #include "system/system_types.h"
 
+typedef enum
+{
+    /* unsigned int. Number of blocks carved out of the pool's blobs so far. Since blocks are
+     *               never released before the pool is, this is the peak number of blocks the pool
+     *               has needed at a time (rounded up to a multiple of RESOURCE_POOL_BATCH_SIZE
+     *               per thread).
+     */
+    SYSTEM_RESOURCE_POOL_PROPERTY_HIGH_WATER_MARK,
+
+    /* __uint64. Number of get_from_pool() calls served directly from a thread's magazine. */
+    SYSTEM_RESOURCE_POOL_PROPERTY_N_CACHE_HITS,
+
+    /* __uint64. Number of get_from_pool() calls which had to refill a thread's magazine, either
+     *           from the shared list, or with new blocks. */
+    SYSTEM_RESOURCE_POOL_PROPERTY_N_REFILLS,
+} system_resource_pool_property;
+
 
 /*  Creates a new resource pool.
  *
@@ -38,7 +56,23 @@ PUBLIC EMERALD_API system_resource_pool system_resource_pool_create(size_t
  */
 PUBLIC EMERALD_API system_resource_pool_block system_resource_pool_get_from_pool(system_resource_pool pool);
 
-/** TODO */
+/** Retrieves a resource pool property value. Statistics are gathered without stopping other
+ *  threads, so they may be slightly out of date if the pool is in use.
+ *
+ *  @param pool           Resource pool to query.
+ *  @param property       Property to query.
+ *  @param out_result_ptr Deref will be set to the property value. Please see
+ *                        system_resource_pool_property for the expected type.
+ */
+PUBLIC EMERALD_API void system_resource_pool_get_property(system_resource_pool          pool,
+                                                          system_resource_pool_property property,
+                                                          void*                         out_result_ptr);
+
+/** Returns all blocks to the pool at once, invalidating all of them. Blocks cached by the pool are
+ *  discarded as well, so no other thread may use the pool during the call.
+ *
+ *  Only supported for pools created without a deinit call-back.
+ */
 PUBLIC EMERALD_API void system_resource_pool_return_all_allocations(system_resource_pool pool);
 
 /*  Returns a block back to the pool.
@@ -52,6 +86,12 @@ PUBLIC EMERALD_API void system_resource_pool_return_all_allocations(system_resou
 PUBLIC EMERALD_API void system_resource_pool_return_to_pool(system_resource_pool       pool,
                                                             system_resource_pool_block block);
 
+/** Gives up the magazine slot assigned to the calling thread, so that another thread can take it over.
+ *  Called by system_threads for each thread which is about to quit. The thread must not use any resource
+ *  pool after this call.
+ */
+PUBLIC void _system_resource_pool_release_thread_slot();
+
 /*  Releases a resource pool object. This renders all managed blocks invalid!
  *
  *  @param system_resource_pool Handle to the resource pool.
@@ -13,6 +13,36 @@
  */
 #define THREAD_POOL_TASK_HANDLER volatile
 
+typedef enum
+{
+    /* bool */
+    SYSTEM_THREAD_POOL_PROPERTY_ARE_WORKERS_PINNED,
+
+    /* unsigned int */
+    SYSTEM_THREAD_POOL_PROPERTY_N_WORKERS,
+
+    /* bool */
+    SYSTEM_THREAD_POOL_PROPERTY_USES_WORK_STEALING
+} system_thread_pool_property;
+
+/* Worker utilization counters. The values are updated by the worker threads without any synchronization,
+ * so they should be treated as approximate while the thread pool is busy.
+ */
+typedef enum
+{
+    /* __uint64. Total time spent on executing orders, in microseconds. */
+    SYSTEM_THREAD_POOL_WORKER_PROPERTY_BUSY_TIME_USEC,
+
+    /* unsigned int. Number of orders (tasks, task groups or job tasks) executed by the worker. */
+    SYSTEM_THREAD_POOL_WORKER_PROPERTY_N_ORDERS_EXECUTED,
+
+    /* unsigned int. Number of orders the worker has stolen from other workers. */
+    SYSTEM_THREAD_POOL_WORKER_PROPERTY_N_ORDERS_STOLEN,
+
+    /* system_thread_id */
+    SYSTEM_THREAD_POOL_WORKER_PROPERTY_THREAD_ID
+} system_thread_pool_worker_property;
+
 
 /** Submits a single task for execution by the thread pool. This skips job creation and injects the task
  *  directly into the task queue. Mind that the task may not be instantly executed - this depends on whether
@@ -57,6 +87,69 @@ PUBLIC EMERALD_API system_thread_pool_task system_thread_pool_create_task_handle
                                                                                                     system_thread_pool_callback_argument execution_handler_argument,
                                                                                                     system_event                         event);
 
+/** Creates a fork/join job descriptor. Tasks can be forked off the job with system_thread_pool_fork_job_task(),
+ *  including from within other tasks that belong to the same job. Use system_thread_pool_wait_for_job() to
+ *  wait until all of them finish executing.
+ *
+ *  @return New job descriptor.
+ */
+PUBLIC EMERALD_API system_thread_pool_job system_thread_pool_create_job();
+
+/** Forks a new task off the specified job and submits it for execution.
+ *
+ *  This function can be called from any thread, including tasks which are a part of the same job. The job will
+ *  not be considered finished until the forked task (and any tasks it forks) finish executing.
+ *
+ *  @param job                        Job to fork the task off.
+ *  @param task_priority              Priority to use for the task.
+ *  @param execution_handler          Function to call back for executing the task.
+ *  @param execution_handler_argument Argument to pass with execution_handler.
+ */
+PUBLIC EMERALD_API void system_thread_pool_fork_job_task(system_thread_pool_job               job,
+                                                         system_thread_pool_task_priority     task_priority,
+                                                         PFNSYSTEMTHREADPOOLCALLBACKPROC      execution_handler,
+                                                         system_thread_pool_callback_argument execution_handler_argument);
+
+/** Executes @param pfn_callback_proc for all indices in <range_start, range_end), using all thread pool
+ *  workers, as well as the calling thread. Returns after all indices have been processed.
+ *
+ *  The range is split into sub-ranges of @param grain_size indices. The n-th sub-range starts at
+ *  (range_start + n * grain_size), so the call-back may use the sub-range start to identify the sub-range,
+ *  for instance to store partial results of a reduction. Sub-ranges are processed in no particular order.
+ *
+ *  If the range is not larger than the grain size, the call-back is executed directly from the calling thread.
+ *  The function can be called from within thread pool tasks.
+ *
+ *  @param range_start       First index to process.
+ *  @param range_end         Index following the last index to process.
+ *  @param grain_size        Number of indices to process in a single call-back invocation. Must not be 0.
+ *  @param pfn_callback_proc Call-back to use.
+ *  @param user_arg          Argument to pass with the call-back.
+ */
+PUBLIC EMERALD_API void system_thread_pool_parallel_for(uint32_t                           range_start,
+                                                        uint32_t                           range_end,
+                                                        uint32_t                           grain_size,
+                                                        PFNSYSTEMTHREADPOOLPARALLELFORPROC pfn_callback_proc,
+                                                        void*                              user_arg);
+
+/** Retrieves a thread pool property value.
+ *
+ *  @param property       Property to query.
+ *  @param out_result_ptr Deref will be set to the requested value. Must not be NULL.
+ */
+PUBLIC EMERALD_API void system_thread_pool_get_property(system_thread_pool_property property,
+                                                        void*                       out_result_ptr);
+
+/** Retrieves a property value of a single thread pool worker.
+ *
+ *  @param n_worker       Index of the worker. Must be smaller than SYSTEM_THREAD_POOL_PROPERTY_N_WORKERS.
+ *  @param property       Property to query.
+ *  @param out_result_ptr Deref will be set to the requested value. Must not be NULL.
+ */
+PUBLIC EMERALD_API void system_thread_pool_get_worker_property(unsigned int                       n_worker,
+                                                               system_thread_pool_worker_property property,
+                                                               void*                              out_result_ptr);
+
 /** Creates a task group decriptor.
  *
  *  @param bool True to make the group of tasks distributable, false to have all the tasks
@@ -65,6 +158,13 @@ PUBLIC EMERALD_API system_thread_pool_task system_thread_pool_create_task_handle
  */
 PUBLIC EMERALD_API system_thread_pool_task_group system_thread_pool_create_task_group(bool is_distributable);
 
+/** Releases a job descriptor. The job must not have any tasks in flight. Do not use the descriptor after
+ *  calling this function.
+ *
+ *  @param job Job to release.
+ */
+PUBLIC EMERALD_API void system_thread_pool_release_job(system_thread_pool_job job);
+
 /** Releases a task group descriptor. Do not use the descriptor after calling this function.
  *
  *  @param system_thread_pool_task_group Task group to use.
@@ -81,6 +181,20 @@ PUBLIC EMERALD_API void system_thread_pool_release_task_group(system_thread_pool
 PUBLIC EMERALD_API void system_thread_pool_insert_task_to_task_group(system_thread_pool_task_group group,
                                                                      system_thread_pool_task       task);
 
+/** Blocks until all tasks forked off the job (including tasks forked by these tasks) finish executing.
+ *
+ *  Rather than blocking, the calling thread helps out for as long as the job is not finished. Thread pool
+ *  workers execute any tasks submitted to the thread pool. It is therefore safe to wait for a job from within
+ *  a thread pool task. Other threads only execute tasks forked off the job, so that latency-sensitive
+ *  threads are never held up by unrelated work.
+ *
+ *  Any number of threads can wait for the same job at the same time. The job can be released as soon as
+ *  the call returns, even if other threads have not returned from their calls yet.
+ *
+ *  @param job Job to wait for.
+ */
+PUBLIC EMERALD_API void system_thread_pool_wait_for_job(system_thread_pool_job job);
+
 /** Initializes thread pool. Should be called once from DLL entry point. */
 PUBLIC void _system_thread_pool_init();
 
@@ -19,6 +19,15 @@ PUBLIC EMERALD_API void system_threads_join_thread(system_thread thread,
                                                    system_time   timeout,
                                                    bool*         out_has_timed_out_ptr);
 
+/** Restricts execution of the calling thread to a single CPU core.
+ *
+ *  @param n_cpu_core Index of the CPU core to pin the thread to. Must be smaller than the
+ *                    number of CPU cores reported by system_capabilities.
+ *
+ *  @return true if successful, false otherwise.
+ */
+PUBLIC EMERALD_API bool system_threads_pin_current_thread_to_cpu_core(unsigned int n_cpu_core);
+
 /** Spawns a new thread. Waits until the thread 
  *
  *  @param callback_func          Entry point function pointer.
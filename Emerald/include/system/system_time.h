@@ -100,6 +100,14 @@ PUBLIC EMERALD_API void system_time_get_hms_for_time(system_time time,
  *  @return Time at the moment of call */
 PUBLIC EMERALD_API system_time system_time_now();
 
+/** Returns the number of microseconds elapsed since the time module was initialized.
+ *
+ *  Meant for profiling purposes, where the resolution of system_time is too coarse.
+ *
+ *  @return As per description.
+ */
+PUBLIC EMERALD_API __uint64 system_time_now_usec();
+
 /** Initializes time module. */
 PUBLIC void _system_time_init();
 
@@ -588,6 +588,19 @@ typedef bool (*system_bst_value_lower_func)(size_t key_size, void*, void*);
 /** TODO . true if ==, false otherwise */
 typedef bool (*system_bst_value_equals_func)(size_t key_size, void*, void*);
 
+/** Defines how keys stored in a BST are compared. */
+typedef enum
+{
+    /* Keys are compared with user-provided system_bst_value_lower_func & system_bst_value_equals_func functions */
+    SYSTEM_BST_KEY_TYPE_CUSTOM,
+
+    /* Keys are arrays of floats. Keys are ordered lexicographically and must match exactly to be considered equal. */
+    SYSTEM_BST_KEY_TYPE_FLOAT_ARRAY,
+
+    /* Keys are arrays of uint32_ts. Keys are ordered lexicographically. */
+    SYSTEM_BST_KEY_TYPE_UINT32_ARRAY
+} system_bst_key_type;
+
 /** TODO */
 DECLARE_HANDLE(system_bst);
 /** TODO */
@@ -625,5 +638,16 @@ typedef volatile void (*PFNSYSTEMTHREADPOOLCALLBACKPROC)(system_thread_pool_call
 DECLARE_HANDLE(system_thread_pool_task);
 /** Thread pool task group descriptor */
 DECLARE_HANDLE(system_thread_pool_task_group);
+/** Thread pool fork/join job descriptor */
+DECLARE_HANDLE(system_thread_pool_job);
+/** Thread pool parallel-for call-back function pointer type.
+ *
+ *  @param range_start First index of the sub-range to process.
+ *  @param range_end   Index following the last index of the sub-range to process.
+ *  @param user_arg    User-specified argument.
+ */
+typedef void (*PFNSYSTEMTHREADPOOLPARALLELFORPROC)(uint32_t range_start,
+                                                   uint32_t range_end,
+                                                   void*    user_arg);
 
 #endif /* SYSTEM_TYPES_H */
@@ -1870,8 +1870,11 @@ PUBLIC EMERALD_API mesh collada_data_get_emerald_mesh(collada_data data,
 
                 if (!has_loaded_blob)
                 {
-                    /* Need to generate indexed data */
+                    /* Need to generate indexed data. Optimize it while at it, so that the blob cache
+                     * stores the reordered data. */
                     mesh_create_single_indexed_representation(result);
+                    mesh_optimize                            (result,
+                                                              MESH_OPTIMIZATION_FLAGS_ALL);
                 }
 
                 /* If 'blob cache' mode was activated for the COLLADA data container, cache the
@@ -16,6 +16,7 @@
 #include "system/system_dpc.h"
 #include "system/system_event_monitor.h"
 #include "system/system_file_monitor.h"
+#include "system/system_frame_arena.h"
 #include "system/system_global.h"
 #include "system/system_hashed_ansi_string.h"
 #include "system/system_log.h"
@@ -101,6 +102,7 @@ void main_init()
 
     _system_time_init();
     _system_assertions_init();
+    _system_frame_arena_init();
     _system_threads_init();
 
     #ifdef USE_EMULATED_EVENTS
@@ -192,6 +194,7 @@ int main_deinit()
         #endif
 
         _system_threads_deinit();
+        _system_frame_arena_deinit();
         system_hashed_ansi_string_deinit();
 
         _system_log_deinit();
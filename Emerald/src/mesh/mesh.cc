@@ -7,14 +7,16 @@
 #include "shared.h"
 #include "demo/demo_app.h"
 #include "mesh/mesh.h"
+#include "mesh/mesh_codec.h"
 #include "mesh/mesh_material.h"
+#include "mesh/mesh_optimizer.h"
+#include "mesh/mesh_simplifier.h"
 #include "ral/ral_buffer.h"
 #include "ral/ral_context.h"
 #include "ral/ral_sampler.h"
 #include "ral/ral_scheduler.h"
 #include "ral/ral_texture.h"
 #include "sh/sh_types.h"
-#include "system/system_bst.h"
 #include "system/system_callback_manager.h"
 #include "system/system_file_serializer.h"
 #include "system/system_hash64.h"
@@ -22,13 +24,45 @@
 #include "system/system_log.h"
 #include "system/system_math_vector.h"
 #include "system/system_resizable_vector.h"
-#include "system/system_resource_pool.h"
+#include "system/system_thread_pool.h"
 
-#define START_LAYERS (4)
+#if defined(__SSE__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 1)
+    #include <xmmintrin.h>
 
+    #define MESH_USE_SSE
+#endif
 
-/* Magic combination, prefixing mesh data */
-const char* header_magic = "eld";
+/* Number of items processed by a single thread pool task when mesh data is crunched in parallel */
+#define AABB_CALCULATION_GRAIN_SIZE     (16384)
+#define INDEX_KEY_HASHING_GRAIN_SIZE    (16384)
+#define NORMAL_GENERATION_GRAIN_SIZE    (1024)
+#define START_LAYERS                    (4)
+
+/* Index keys are distributed over (1 << INDEX_KEY_N_PARTITION_BITS) partitions, depending on their hashes,
+ * so that each partition's unique keys can be looked for by a separate thread. */
+#define INDEX_KEY_N_PARTITION_BITS      (6)
+#define INDEX_KEY_N_PARTITIONS          (1 << INDEX_KEY_N_PARTITION_BITS)
+
+/* Vertices which are no further than this away from each other on every axis are considered shared
+ * during normal data generation. The welding grid's cells must not be smaller than the epsilon. */
+#define NORMAL_GENERATION_WELD_CELL_SIZE (2.0 * NORMAL_GENERATION_WELD_EPSILON)
+#define NORMAL_GENERATION_WELD_EPSILON   (1e-5)
+
+/* Maximum ratio by which ACMR of each triangle cluster may grow during overdraw optimization */
+#define OPTIMIZATION_OVERDRAW_THRESHOLD  (1.05f)
+
+
+/* Magic combinations, prefixing mesh data. Meshes with encoded processed data use a separate one, so that
+ * older files can still be loaded. Meshes which use features not covered by the other combinations use
+ * the extended one, which is followed by a bitfield of MESH_FILE_FEATURE_* flags. */
+const char* header_magic          = "eld";
+const char* header_magic_encoded  = "elc";
+const char* header_magic_extended = "elx";
+
+/* Features of the extended mesh file format */
+#define MESH_FILE_FEATURE_ENCODED_DATA (0x1)
+#define MESH_FILE_FEATURE_LODS         (0x2)
+#define MESH_FILE_FEATURE_ALL          (MESH_FILE_FEATURE_ENCODED_DATA | MESH_FILE_FEATURE_LODS)
 
 
 /* Private declarations */
@@ -56,27 +90,35 @@ typedef struct
      *                   separated with a mesh-specific stride.
      *                   SH MUST be aligned to 32 (as it's used by means of a RGBA32F texture buffer.
      */
-    ral_buffer       bo;
-    float*           bo_processed_data;
-    uint32_t         bo_processed_data_size; /* tells size of gl_processed_data */
-    uint32_t         bo_processed_data_stream_start_offset[MESH_LAYER_DATA_STREAM_TYPE_COUNT];
-    uint32_t         bo_processed_data_stride;
-    uint32_t         bo_processed_data_total_elements;
-    _mesh_index_type bo_index_type;
-    bool             bo_storage_initialized;
+    ral_buffer             bo;
+    float*                 bo_processed_data;
+    system_file_serializer bo_processed_data_serializer; /* if not nullptr, bo_processed_data points into the serializer's file mapping */
+    uint32_t               bo_processed_data_size;       /* tells size of gl_processed_data */
+    uint32_t               bo_processed_data_stream_start_offset[MESH_LAYER_DATA_STREAM_TYPE_COUNT];
+    uint32_t               bo_processed_data_stride;
+    uint32_t               bo_processed_data_total_elements;
+    _mesh_index_type       bo_index_type;
+    bool                   bo_storage_initialized;
+
+    /* Encodings used when the mesh is saved */
+    mesh_index_encoding             bo_index_encoding;
+    mesh_layer_data_stream_encoding bo_processed_data_stream_encoding[MESH_LAYER_DATA_STREAM_TYPE_COUNT];
 
     ral_context      ral_context;
 
     mesh             instantiation_parent; /* If not nullptr, instantiation parent's GL data should be used instead */
 
     /* Properties */
-    float                aabb_max   [4]; /* model-space */
-    float                aabb_min   [4]; /* model-space */
-    mesh_creation_flags  creation_flags;
-    uint32_t             n_sh_bands;      /* can be 0 ! */
-    sh_components        n_sh_components; /* can be 0 ! */
-    system_time          timestamp_last_modified;
-    mesh_vertex_ordering vertex_ordering;
+    float                 aabb_max   [4];    /* model-space */
+    float                 aabb_min   [4];    /* model-space */
+    mesh_creation_flags   creation_flags;
+    float                 lod_errors [MESH_MAX_LODS]; /* model-space. Only the first n_lods entries are used */
+    uint32_t              n_lods;            /* includes the original mesh */
+    mesh_normal_weighting normals_weighting; /* as was used for generating the normals data */
+    uint32_t              n_sh_bands;        /* can be 0 ! */
+    sh_components         n_sh_components;   /* can be 0 ! */
+    system_time           timestamp_last_modified;
+    mesh_vertex_ordering  vertex_ordering;
 
     /* Other */
     system_resizable_vector layers;    /* contains _mesh_layer instances */
@@ -165,6 +207,15 @@ typedef struct _mesh_layer_pass_index_data
     }
 } _mesh_layer_pass_index_data;
 
+/** Index range of a single level of detail of a layer pass. The range refers to gl_processed_data. */
+typedef struct
+{
+    uint32_t bo_elements_offset;
+    uint32_t bo_elements_max_index;
+    uint32_t bo_elements_min_index;
+    uint32_t n_elements;
+} _mesh_layer_pass_lod;
+
 typedef struct
 {
     mesh_material material;
@@ -199,20 +250,104 @@ typedef struct
     uint32_t* bo_elements;
     uint32_t  bo_elements_max_index;
     uint32_t  bo_elements_min_index;
+
+    /* Levels of detail, starting from LOD 1. Only the first (n_lods - 1) entries are used. */
+    _mesh_layer_pass_lod lods[MESH_MAX_LODS - 1];
 } _mesh_layer_pass;
 
-/** TODO: Used for normal data generation */
-typedef struct _mesh_polygon
+/** Argument passed to _mesh_calculate_aabb_for_range(). Each chunk stores its partial AABB
+ *  at offset (3 * chunk index) of the chunk_aabb_max & chunk_aabb_min arrays. */
+typedef struct
+{
+    float*       chunk_aabb_max;
+    float*       chunk_aabb_min;
+    unsigned int n_components;
+    const float* vertex_data_ptr;
+} _mesh_aabb_calculation_arg;
+
+/** Describes index keys of a single layer pass. An index key consists of (unique set ID, index) pairs, one
+ *  for each index data set defined for the pass, followed by the pass material. Keys of all passes are
+ *  zero-padded to the same length. */
+typedef struct
 {
-    unsigned int n_mesh_layer;
-    unsigned int n_mesh_layer_pass;
-    unsigned int triangle_index;
+    uint32_t      first_element;   /* index of the first element of the pass, counted across all passes of the mesh */
+    uint32_t      first_key_set;   /* index of the first key set of the pass in _mesh_index_key_arg's key_set_* arrays */
+    uint32_t      key_set_offsets[MESH_LAYER_DATA_STREAM_TYPE_COUNT]; /* relative to first_key_set */
+    mesh_material material;
+    uint32_t      n_elements;
+    uint32_t      n_key_sets;
+} _mesh_index_key_pass;
 
-    _mesh_layer*      layer_ptr;
-    _mesh_layer_pass* layer_pass_ptr;
-    float             polygon_normal[3];
-    float*            vertex_data   [3];
-} _mesh_polygon;
+/** Argument passed to _mesh_calculate_index_key_hashes() and _mesh_merge_index_keys(). All element
+ *  indices are counted across all passes of the mesh. */
+typedef struct
+{
+    uint32_t*                   element_hashes;
+    uint32_t*                   element_vertices;   /* index of the first element which uses the same index key */
+    const uint32_t**            key_set_index_data; /* nullptr if the key set's index data could not be retrieved */
+    uint32_t*                   key_set_unique_ids;
+    uint32_t                    n_key_words;
+    uint32_t                    n_passes;
+    const uint32_t*             partition_elements; /* elements of each partition, in ascending order */
+    uint32_t                    partition_offsets[INDEX_KEY_N_PARTITIONS + 1];
+    const _mesh_index_key_pass* passes;
+} _mesh_index_key_arg;
+
+/** Uniform grid used to weld vertices during normal data generation. Only the non-empty cells are stored,
+ *  in a hash table. */
+typedef struct
+{
+    uint32_t*    next_cell_vertices; /* links vertices stored in the same cell. UINT32_MAX terminates the list */
+    uint32_t*    slot_tags;          /* upper half of the hash of the cell described by each slot */
+    uint32_t*    slot_vertices;      /* last vertex stored in the cell described by each slot. UINT32_MAX if the slot is empty */
+    uint32_t     slot_mask;          /* number of slots minus one. The number of slots is a power of two */
+    const float* vertex_data_ptr;
+} _mesh_weld_grid;
+
+/** Argument passed to _mesh_calculate_polygon_normals() and _mesh_calculate_vertex_normals(). */
+typedef struct
+{
+    uint32_t*             adjacency_corners;  /* corners using each welded vertex, see mesh_generate_normal_data() */
+    const uint32_t*       adjacency_offsets;  /* n_welded_vertices + 1 offsets into adjacency_corners               */
+    float*                corner_weights;     /* 3 floats per triangle */
+    const uint32_t*       index_data_ptr;     /* nullptr if the vertices are defined in order */
+    float*                normal_data_ptr;    /* 3 floats per corner */
+    float*                polygon_normals;    /* 3 floats per triangle */
+    float                 smoothing_angle;
+    float                 smoothing_angle_cos; /* -1 if the smoothing angle is not smaller than pi */
+    const float*          vertex_data_ptr;
+    mesh_normal_weighting weighting;
+    const uint32_t*       welded_vertex_ids;  /* maps vertex data items to welded vertex ids */
+} _mesh_normal_generation_arg;
+
+/** Argument passed to _mesh_generate_layer_pass_lods(). Base index data of each pass is relative to the pass'
+ *  minimum index. LOD index data of each pass occupies n_levels consecutive ranges, each of which is as large
+ *  as the pass' base index data and starts at (n_levels * pass_index_offsets[n_pass] + n_level * n_pass_indices). */
+typedef struct
+{
+    const uint32_t*          index_data;         /* indices of all layer passes */
+    float*                   lod_errors;         /* n_levels entries per pass */
+    uint32_t*                lod_index_data;
+    uint32_t*                lod_n_indices;      /* n_levels entries per pass */
+    uint32_t                 n_levels;
+    const uint32_t*          pass_index_offsets; /* n_passes + 1 offsets into index_data */
+    const _mesh_layer_pass** pass_ptrs;
+    const float*             target_ratios;
+    const float*             vertex_data_ptr;
+    uint32_t                 vertex_stride;
+} _mesh_lod_generation_arg;
+
+/** Argument passed to _mesh_optimize_layer_passes(). Layer passes never share vertices, so each pass
+ *  is optimized by looking at its own range of vertices. */
+typedef struct
+{
+    mesh_optimization_flags  flags;
+    uint32_t*                index_data;          /* indices of all layer passes */
+    const uint32_t*          pass_index_offsets;  /* n_passes + 1 offsets into index_data */
+    const _mesh_layer_pass** pass_ptrs;
+    const float*             vertex_data_ptr;     /* nullptr if the mesh defines no vertex data */
+    uint32_t                 vertex_stride;
+} _mesh_optimization_arg;
 
 
 /** Reference counter impl */
@@ -228,24 +363,54 @@ PRIVATE mesh_layer_pass_id _mesh_add_layer_pass(mesh
                                                 mesh_draw_call_type             draw_call_type,
                                                 const mesh_draw_call_arguments* draw_call_argument_values_ptr);
 
+PRIVATE void     _mesh_calculate_aabb_for_range                (uint32_t                          range_start,
+                                                                uint32_t                          range_end,
+                                                                void*                             user_arg);
+PRIVATE void     _mesh_calculate_index_key_hashes              (uint32_t                          range_start,
+                                                                uint32_t                          range_end,
+                                                                void*                             user_arg);
+PRIVATE void     _mesh_calculate_polygon_normals               (uint32_t                          range_start,
+                                                                uint32_t                          range_end,
+                                                                void*                             user_arg);
+PRIVATE void     _mesh_calculate_vertex_normals                (uint32_t                          range_start,
+                                                                uint32_t                          range_end,
+                                                                void*                             user_arg);
+PRIVATE bool     _mesh_decode_processed_data                   (_mesh*                            mesh_ptr,
+                                                                const unsigned char*              encoded_data,
+                                                                uint32_t                          encoded_data_size);
 PRIVATE void     _mesh_deinit_mesh_layer                       (const _mesh*                      mesh_ptr,
                                                                 _mesh_layer*                      layer_ptr,
                                                                 bool                              do_full_deinit);
 PRIVATE void     _mesh_deinit_mesh_layer_pass                  (const _mesh*                      mesh_ptr,
                                                                 _mesh_layer_pass*                 pass_ptr,
                                                                 bool                              do_full_deinit);
+PRIVATE unsigned char* _mesh_encode_processed_data             (const _mesh*                      mesh_ptr,
+                                                                uint32_t*                         out_encoded_data_size_ptr);
+PRIVATE uint32_t _mesh_find_index_key_pass                     (const _mesh_index_key_arg*        arg_ptr,
+                                                                uint32_t                          n_element);
+PRIVATE uint32_t _mesh_find_weld_cell_slot                     (const _mesh_weld_grid*            grid_ptr,
+                                                                const int64_t*                    cell,
+                                                                uint64_t                          hash);
+PRIVATE void     _mesh_generate_layer_pass_lods                (uint32_t                          range_start,
+                                                                uint32_t                          range_end,
+                                                                void*                             user_arg);
 PRIVATE void     _mesh_get_amount_of_stream_data_sets          (_mesh*                            mesh_ptr,
                                                                 mesh_layer_data_stream_type       stream_type,
                                                                 mesh_layer_id                     layer_id,
                                                                 mesh_layer_pass_id                layer_pass_id,
                                                                 uint32_t*                         out_n_stream_sets_ptr);
 PRIVATE void     _mesh_get_index_key                           (uint32_t*                         out_result_ptr,
-                                                                const _mesh_layer_pass*           layer_pass_ptr,
-                                                                unsigned int                      n_element);
-PRIVATE uint32_t _mesh_get_source_index_from_index_key         (const uint32_t*                   key_ptr,
-                                                                const _mesh_layer_pass*           layer_pass_ptr,
-                                                                mesh_layer_data_stream_type       data_stream_type,
-                                                                unsigned int                      set_id);
+                                                                const _mesh_index_key_arg*        arg_ptr,
+                                                                const _mesh_index_key_pass*       key_pass_ptr,
+                                                                uint32_t                          n_element);
+PRIVATE uint32_t _mesh_get_index_key_hash                      (const uint32_t*                   key_ptr,
+                                                                uint32_t                          n_key_words);
+PRIVATE uint32_t _mesh_get_index_key_sets                      (const _mesh_layer_pass*           layer_pass_ptr,
+                                                                const uint32_t**                  out_index_data_ptrs,
+                                                                uint32_t*                         out_unique_set_ids,
+                                                                uint32_t*                         out_key_set_offsets);
+PRIVATE uint32_t _mesh_get_index_size                          (_mesh_index_type                  index_type);
+PRIVATE uint32_t _mesh_get_processed_data_stream_n_components  (mesh_layer_data_stream_type       stream_type);
 PRIVATE void     _mesh_get_stream_data_properties              (_mesh*                            mesh_ptr,
                                                                 mesh_layer_data_stream_type       stream_type,
                                                                 mesh_layer_data_stream_data_type* out_data_type_ptr,
@@ -254,6 +419,13 @@ PRIVATE uint32_t _mesh_get_total_number_of_sets                (_mesh_layer*
 PRIVATE void     _mesh_get_total_number_of_stream_sets_for_mesh(_mesh*                            mesh_ptr,
                                                                 mesh_layer_data_stream_type       stream_type,
                                                                 uint32_t*                         out_n_stream_sets_ptr);
+PRIVATE void     _mesh_get_vertex_cache_statistics             (const uint32_t*                   index_data,
+                                                                uint32_t                          n_indices,
+                                                                uint32_t                          n_vertices,
+                                                                float*                            out_acmr_ptr,
+                                                                float*                            out_atvr_ptr);
+PRIVATE int64_t  _mesh_get_weld_cell                           (double                            coordinate);
+PRIVATE uint64_t _mesh_get_weld_cell_hash                      (const int64_t*                    cell);
 PRIVATE void     _mesh_init_mesh                               (_mesh*                            new_mesh_ptr,
                                                                 system_hashed_ansi_string         name,
                                                                 mesh_creation_flags               flags);
@@ -262,17 +434,26 @@ PRIVATE void     _mesh_init_mesh_layer_data_stream             (_mesh_layer_data
                                                                 mesh_layer_data_stream_source     source);
 PRIVATE void     _mesh_init_mesh_layer_pass                    (_mesh_layer_pass*                 new_mesh_layer_pass_ptr,
                                                                 mesh_type                         mesh_type);
-PRIVATE bool     _mesh_is_key_float_lower                      (size_t                            key_size,
-                                                                void*                             arg1,
-                                                                void*                             arg2);
-PRIVATE bool     _mesh_is_key_float_equal                      (size_t                            key_size,
-                                                                void*                             arg1,
-                                                                void*                             arg2);
+PRIVATE bool     _mesh_is_processed_data_encodable             (const _mesh*                      mesh_ptr);
 PRIVATE void     _mesh_material_setting_changed                (const void*                       callback_data,
                                                                 void*                             user_arg);
+PRIVATE void     _mesh_merge_index_keys                        (uint32_t                          range_start,
+                                                                uint32_t                          range_end,
+                                                                void*                             user_arg);
+PRIVATE void     _mesh_optimize_layer_passes                   (uint32_t                          range_start,
+                                                                uint32_t                          range_end,
+                                                                void*                             user_arg);
+PRIVATE void     _mesh_read_processed_data_properties          (_mesh*                            mesh_ptr,
+                                                                system_file_serializer            serializer);
 PRIVATE void     _mesh_release                                 (void*                             arg);
+PRIVATE void     _mesh_release_bo_processed_data               (_mesh*                            mesh_ptr);
 PRIVATE void     _mesh_release_normals_data                    (_mesh*                            mesh_ptr);
 PRIVATE void     _mesh_update_aabb                             (_mesh*                            mesh_ptr);
+PRIVATE uint32_t _mesh_weld_vertices                           (const float*                      vertex_data_ptr,
+                                                                uint32_t                          n_vertices,
+                                                                uint32_t*                         out_welded_vertex_ids);
+PRIVATE void     _mesh_write_processed_data_properties         (const _mesh*                      mesh_ptr,
+                                                                system_file_serializer            serializer);
 
 
 /** TODO */
@@ -396,6 +577,415 @@ PRIVATE mesh_layer_pass_id _mesh_add_layer_pass(mesh
     return result_id;
 }
 
+#ifdef MESH_USE_SSE
+    /** Loads an XYZ triple into the first three components of a register, without reading past it. */
+    inline __m128 _mesh_load_vec3_sse(const float* data_ptr)
+    {
+        return _mm_movelh_ps(_mm_loadl_pi(_mm_setzero_ps(),
+                                          reinterpret_cast<const __m64*>(data_ptr) ),
+                             _mm_load_ss (data_ptr + 2) );
+    }
+
+    /** Stores the first three components of a register, without writing past them. */
+    inline void _mesh_store_vec3_sse(float* data_ptr,
+                                     __m128 data)
+    {
+        _mm_storel_pi(reinterpret_cast<__m64*>(data_ptr),
+                      data);
+        _mm_store_ss (data_ptr + 2,
+                      _mm_movehl_ps(data, data) );
+    }
+#endif
+
+/** Thread pool call-back which calculates an AABB for vertices <range_start, range_end) of a vertex
+ *  data stream. The result is stored in the chunk-specific slot of the arrays provided by the argument.
+ *
+ *  @param range_start Index of the first vertex to process.
+ *  @param range_end   Index following the last vertex to process.
+ *  @param user_arg    _mesh_aabb_calculation_arg instance.
+ */
+PRIVATE void _mesh_calculate_aabb_for_range(uint32_t range_start,
+                                            uint32_t range_end,
+                                            void*    user_arg)
+{
+    const _mesh_aabb_calculation_arg* arg_ptr      = reinterpret_cast<const _mesh_aabb_calculation_arg*>(user_arg);
+    float*                            aabb_max     = arg_ptr->chunk_aabb_max + 3 * (range_start / AABB_CALCULATION_GRAIN_SIZE);
+    float*                            aabb_min     = arg_ptr->chunk_aabb_min + 3 * (range_start / AABB_CALCULATION_GRAIN_SIZE);
+    const unsigned int                n_components = arg_ptr->n_components;
+    const float*                      vertex_data  = arg_ptr->vertex_data_ptr + n_components * range_start;
+
+    #ifdef MESH_USE_SSE
+    {
+        /* The vertex is passed as the first argument, so that a NaN component is ignored the same way
+         * as it would be by a scalar comparison. */
+        __m128 result_max = _mesh_load_vec3_sse(vertex_data);
+        __m128 result_min = result_max;
+
+        for (uint32_t n_item = range_start + 1;
+                      n_item < range_end;
+                    ++n_item)
+        {
+            vertex_data += n_components;
+
+            const __m128 vertex = _mesh_load_vec3_sse(vertex_data);
+
+            result_max = _mm_max_ps(vertex, result_max);
+            result_min = _mm_min_ps(vertex, result_min);
+        }
+
+        _mesh_store_vec3_sse(aabb_max,
+                             result_max);
+        _mesh_store_vec3_sse(aabb_min,
+                             result_min);
+    }
+    #else
+    {
+        for (int n_dimension = 0;
+                 n_dimension < 3; /* x, y, z */
+               ++n_dimension)
+        {
+            aabb_max[n_dimension] = vertex_data[n_dimension];
+            aabb_min[n_dimension] = vertex_data[n_dimension];
+        }
+
+        for (uint32_t n_item = range_start + 1;
+                      n_item < range_end;
+                    ++n_item)
+        {
+            vertex_data += n_components;
+
+            for (int n_dimension = 0;
+                     n_dimension < 3; /* x, y, z */
+                   ++n_dimension)
+            {
+                aabb_max[n_dimension] = (aabb_max[n_dimension] < vertex_data[n_dimension]) ? vertex_data[n_dimension] : aabb_max[n_dimension];
+                aabb_min[n_dimension] = (aabb_min[n_dimension] > vertex_data[n_dimension]) ? vertex_data[n_dimension] : aabb_min[n_dimension];
+            }
+        }
+    }
+    #endif
+}
+
+/** Thread pool call-back which calculates index key hashes for elements <range_start, range_end).
+ *
+ *  @param range_start Index of the first element to process, counted across all passes of the mesh.
+ *  @param range_end   Index following the last element to process.
+ *  @param user_arg    _mesh_index_key_arg instance.
+ */
+PRIVATE void _mesh_calculate_index_key_hashes(uint32_t range_start,
+                                              uint32_t range_end,
+                                              void*    user_arg)
+{
+    const _mesh_index_key_arg*  arg_ptr      = reinterpret_cast<const _mesh_index_key_arg*>(user_arg);
+    const _mesh_index_key_pass* key_pass_ptr = arg_ptr->passes + _mesh_find_index_key_pass(arg_ptr,
+                                                                                            range_start);
+    uint32_t*                   key_ptr      = new (std::nothrow) uint32_t[arg_ptr->n_key_words];
+
+    ASSERT_ALWAYS_SYNC(key_ptr != nullptr,
+                       "Out of memory");
+
+    for (uint32_t n_element = range_start;
+                  n_element < range_end;
+                ++n_element)
+    {
+        while (n_element >= key_pass_ptr->first_element + key_pass_ptr->n_elements)
+        {
+            ++key_pass_ptr;
+        }
+
+        _mesh_get_index_key(key_ptr,
+                            arg_ptr,
+                            key_pass_ptr,
+                            n_element);
+
+        arg_ptr->element_hashes[n_element] = _mesh_get_index_key_hash(key_ptr,
+                                                                      arg_ptr->n_key_words);
+    }
+
+    delete [] key_ptr;
+}
+
+/** Thread pool call-back which calculates polygon normals and per-corner weights for triangles
+ *  <range_start, range_end) of a single layer pass.
+ *
+ *  @param range_start Index of the first triangle to process.
+ *  @param range_end   Index following the last triangle to process.
+ *  @param user_arg    _mesh_normal_generation_arg instance.
+ */
+PRIVATE void _mesh_calculate_polygon_normals(uint32_t range_start,
+                                             uint32_t range_end,
+                                             void*    user_arg)
+{
+    const _mesh_normal_generation_arg* arg_ptr = reinterpret_cast<const _mesh_normal_generation_arg*>(user_arg);
+
+    for (uint32_t n_triangle = range_start;
+                  n_triangle < range_end;
+                ++n_triangle)
+    {
+        const float* vertex_data[3];
+        float*       corner_weights = arg_ptr->corner_weights + 3 /* corners    */ * n_triangle;
+        float*       polygon_normal = arg_ptr->polygon_normals + 3 /* components */ * n_triangle;
+        float        b_minus_a[3];
+        float        c_minus_a[3];
+        float        normal_length;
+
+        for (uint32_t n_corner = 0;
+                      n_corner < 3;
+                    ++n_corner)
+        {
+            const uint32_t vertex_index = (arg_ptr->index_data_ptr != nullptr) ? arg_ptr->index_data_ptr[n_triangle * 3 + n_corner]
+                                                                               :                         n_triangle * 3 + n_corner;
+
+            vertex_data[n_corner] = arg_ptr->vertex_data_ptr + 3 /* components */ * vertex_index;
+        }
+
+        system_math_vector_minus3(vertex_data[1],
+                                  vertex_data[0],
+                                  b_minus_a);
+        system_math_vector_minus3(vertex_data[2],
+                                  vertex_data[0],
+                                  c_minus_a);
+        system_math_vector_cross3(b_minus_a,
+                                  c_minus_a,
+                                  polygon_normal);
+
+        normal_length = system_math_vector_length3(polygon_normal);
+
+        /* Degenerate triangles get a zero normal, so that they do not affect their neighbours */
+        if (normal_length > 0.0f)
+        {
+            polygon_normal[0] /= normal_length;
+            polygon_normal[1] /= normal_length;
+            polygon_normal[2] /= normal_length;
+        }
+
+        switch (arg_ptr->weighting)
+        {
+            case MESH_NORMAL_WEIGHTING_AREA:
+            {
+                corner_weights[0] = 0.5f * normal_length;
+                corner_weights[1] = corner_weights[0];
+                corner_weights[2] = corner_weights[0];
+
+                break;
+            }
+
+            case MESH_NORMAL_WEIGHTING_ANGLE:
+            {
+                for (uint32_t n_corner = 0;
+                              n_corner < 3;
+                            ++n_corner)
+                {
+                    float edge_a[3];
+                    float edge_b[3];
+                    float edge_lengths_product;
+
+                    system_math_vector_minus3(vertex_data[(n_corner + 1) % 3],
+                                              vertex_data[n_corner],
+                                              edge_a);
+                    system_math_vector_minus3(vertex_data[(n_corner + 2) % 3],
+                                              vertex_data[n_corner],
+                                              edge_b);
+
+                    edge_lengths_product = system_math_vector_length3(edge_a) * system_math_vector_length3(edge_b);
+
+                    if (edge_lengths_product > 0.0f)
+                    {
+                        float cos_angle = system_math_vector_dot3(edge_a,
+                                                                  edge_b) / edge_lengths_product;
+
+                        cos_angle                = (cos_angle < -1.0f) ? -1.0f
+                                                 : (cos_angle >  1.0f) ?  1.0f
+                                                 :                        cos_angle;
+                        corner_weights[n_corner] = acos(cos_angle);
+                    }
+                    else
+                    {
+                        corner_weights[n_corner] = 0.0f;
+                    }
+                }
+
+                break;
+            }
+
+            default:
+            {
+                ASSERT_DEBUG_SYNC(arg_ptr->weighting == MESH_NORMAL_WEIGHTING_UNIFORM,
+                                  "Unrecognized normal weighting mode");
+
+                corner_weights[0] = 1.0f;
+                corner_weights[1] = 1.0f;
+                corner_weights[2] = 1.0f;
+            }
+        }
+    }
+}
+
+/** Thread pool call-back which calculates per-vertex normals for triangles <range_start, range_end)
+ *  of a single layer pass. Each triangle only writes to its own slots of the normal data array,
+ *  and the adjacency data is only read from, so sub-ranges can run concurrently.
+ *
+ *  @param range_start Index of the first triangle to process.
+ *  @param range_end   Index following the last triangle to process.
+ *  @param user_arg    _mesh_normal_generation_arg instance.
+ */
+PRIVATE void _mesh_calculate_vertex_normals(uint32_t range_start,
+                                            uint32_t range_end,
+                                            void*    user_arg)
+{
+    const _mesh_normal_generation_arg* arg_ptr = reinterpret_cast<const _mesh_normal_generation_arg*>(user_arg);
+
+    for (uint32_t n_triangle = range_start;
+                  n_triangle < range_end;
+                ++n_triangle)
+    {
+        const float* triangle_polygon_normal = arg_ptr->polygon_normals + 3 /* components */ * n_triangle;
+
+        for (uint32_t n_corner = 0;
+                      n_corner < 3;
+                    ++n_corner)
+        {
+            const uint32_t corner_index  = n_triangle * 3 + n_corner;
+            const uint32_t vertex_index  = (arg_ptr->index_data_ptr != nullptr) ? arg_ptr->index_data_ptr[corner_index]
+                                                                                :                         corner_index;
+            float*         vertex_normal = arg_ptr->normal_data_ptr + 3 /* components */ * corner_index;
+
+            float          vertex_normal_length;
+
+            system_math_vector_mul3_float(triangle_polygon_normal,
+                                          arg_ptr->corner_weights[corner_index],
+                                          vertex_normal);
+
+            if (arg_ptr->smoothing_angle > 0.0f)
+            {
+                /* Consider all other polygons which share the vertex */
+                const uint32_t welded_vertex_id = arg_ptr->welded_vertex_ids[vertex_index];
+
+                for (uint32_t n_adjacency = arg_ptr->adjacency_offsets[welded_vertex_id];
+                              n_adjacency < arg_ptr->adjacency_offsets[welded_vertex_id + 1];
+                            ++n_adjacency)
+                {
+                    const uint32_t adjacent_corner_index   = arg_ptr->adjacency_corners[n_adjacency];
+                    const uint32_t adjacent_triangle_index = adjacent_corner_index / 3;
+                    const float*   adjacent_polygon_normal = arg_ptr->polygon_normals + 3 /* components */ * adjacent_triangle_index;
+                    float          cos_angle;
+
+                    if (adjacent_triangle_index == n_triangle)
+                    {
+                        continue;
+                    }
+
+                    cos_angle = system_math_vector_dot3(adjacent_polygon_normal,
+                                                        triangle_polygon_normal);
+
+                    /* Equivalent to acos(cos_angle) <= smoothing angle, but much cheaper. */
+                    if (cos_angle >= arg_ptr->smoothing_angle_cos)
+                    {
+                        const float weight = arg_ptr->corner_weights[adjacent_corner_index];
+
+                        vertex_normal[0] += adjacent_polygon_normal[0] * weight;
+                        vertex_normal[1] += adjacent_polygon_normal[1] * weight;
+                        vertex_normal[2] += adjacent_polygon_normal[2] * weight;
+                    }
+                }
+            }
+
+            vertex_normal_length = system_math_vector_length3(vertex_normal);
+
+            if (vertex_normal_length > 0.0f)
+            {
+                vertex_normal[0] /= vertex_normal_length;
+                vertex_normal[1] /= vertex_normal_length;
+                vertex_normal[2] /= vertex_normal_length;
+            }
+        }
+    }
+}
+
+/** Decodes processed data stored in the compact form (as produced by _mesh_encode_processed_data() )
+ *  straight into a newly allocated processed data buffer.
+ *
+ *  Processed data properties and encodings must have been set up prior to the call.
+ *
+ *  @return true if successful, false if the encoded data was found to be corrupt.
+ */
+PRIVATE bool _mesh_decode_processed_data(_mesh*               mesh_ptr,
+                                         const unsigned char* encoded_data,
+                                         uint32_t             encoded_data_size)
+{
+    const uint32_t       index_size       = _mesh_get_index_size(mesh_ptr->bo_index_type);
+    const uint64_t       decoded_size     = static_cast<uint64_t>(mesh_ptr->bo_processed_data_stride) * mesh_ptr->n_bo_unique_vertices +
+                                            static_cast<uint64_t>(index_size)                         * mesh_ptr->bo_processed_data_total_elements;
+    const unsigned char* encoded_data_end = encoded_data + encoded_data_size;
+    uint32_t             n_bytes_consumed = 0;
+    bool                 result           = false;
+    const unsigned char* traveller_ptr    = encoded_data;
+
+    if (index_size   == 0                                ||
+        decoded_size != mesh_ptr->bo_processed_data_size)
+    {
+        goto end;
+    }
+
+    mesh_ptr->bo_processed_data = new (std::nothrow) float[(mesh_ptr->bo_processed_data_size + sizeof(float) - 1) / sizeof(float)];
+
+    ASSERT_ALWAYS_SYNC(mesh_ptr->bo_processed_data != nullptr,
+                       "Out of memory");
+
+    for (mesh_layer_data_stream_type stream_type = (mesh_layer_data_stream_type) 0;
+                                     stream_type < MESH_LAYER_DATA_STREAM_TYPE_COUNT;
+                             ++(int&)stream_type)
+    {
+        const uint32_t stream_n_components = _mesh_get_processed_data_stream_n_components(stream_type);
+        const uint32_t stream_offset       = mesh_ptr->bo_processed_data_stream_start_offset[stream_type];
+
+        if (stream_offset == -1)
+        {
+            continue;
+        }
+
+        if (stream_offset + sizeof(float) * stream_n_components > mesh_ptr->bo_processed_data_stride)
+        {
+            goto end;
+        }
+
+        n_bytes_consumed = mesh_codec_decode_stream(mesh_ptr->bo_processed_data_stream_encoding[stream_type],
+                                                    traveller_ptr,
+                                                    static_cast<uint32_t>(encoded_data_end - traveller_ptr),
+                                                    stream_n_components,
+                                                    mesh_ptr->n_bo_unique_vertices,
+                                                    mesh_ptr->bo_processed_data_stride,
+                                                    reinterpret_cast<float*>(reinterpret_cast<unsigned char*>(mesh_ptr->bo_processed_data) + stream_offset) );
+
+        if (n_bytes_consumed               == 0 &&
+            mesh_ptr->n_bo_unique_vertices != 0)
+        {
+            goto end;
+        }
+
+        traveller_ptr += n_bytes_consumed;
+    }
+
+    /* Index data follows vertex data */
+    n_bytes_consumed = mesh_codec_decode_indices(mesh_ptr->bo_index_encoding,
+                                                 traveller_ptr,
+                                                 static_cast<uint32_t>(encoded_data_end - traveller_ptr),
+                                                 mesh_ptr->bo_processed_data_total_elements,
+                                                 index_size,
+                                                 reinterpret_cast<unsigned char*>(mesh_ptr->bo_processed_data) + mesh_ptr->bo_processed_data_stride * mesh_ptr->n_bo_unique_vertices);
+
+    if (n_bytes_consumed                           == 0 &&
+        mesh_ptr->bo_processed_data_total_elements != 0)
+    {
+        goto end;
+    }
+
+    /* All done */
+    result = true;
+end:
+    return result;
+}
+
 /** TODO */
 PRIVATE void _mesh_deinit_mesh_layer(const _mesh* mesh_ptr,
                                      _mesh_layer* layer_ptr,
@@ -530,143 +1120,371 @@ PRIVATE void _mesh_deinit_mesh_layer_pass(const _mesh*            mesh_ptr,
     }
 }
 
-/** TODO */
-PRIVATE void _mesh_get_amount_of_stream_data_sets(_mesh*                      mesh_ptr,
-                                                  mesh_layer_data_stream_type stream_type,
-                                                  mesh_layer_id               layer_id,
-                                                  mesh_layer_pass_id          layer_pass_id,
-                                                  uint32_t*                   out_n_stream_sets_ptr)
+/** Encodes processed data of the mesh, using the encodings configured for each of the streams and for
+ *  the index data. Used streams are stored one after another, in stream type order, and are followed by
+ *  the index data.
+ *
+ *  The processed data must be laid out as described by _mesh_is_processed_data_encodable().
+ *
+ *  @param mesh_ptr                  Mesh to use.
+ *  @param out_encoded_data_size_ptr Deref will be set to the size of the returned buffer.
+ *
+ *  @return Encoded data. Caller must release the buffer with delete [].
+ */
+PRIVATE unsigned char* _mesh_encode_processed_data(const _mesh* mesh_ptr,
+                                                   uint32_t*    out_encoded_data_size_ptr)
 {
-    if (out_n_stream_sets_ptr != nullptr)
+    const uint32_t       index_size     = _mesh_get_index_size(mesh_ptr->bo_index_type);
+    const unsigned char* index_data_ptr = reinterpret_cast<const unsigned char*>(mesh_ptr->bo_processed_data) + mesh_ptr->bo_processed_data_stride * mesh_ptr->n_bo_unique_vertices;
+    unsigned char*       result         = nullptr;
+    uint32_t             result_size    = 0;
+    unsigned char*       traveller_ptr  = nullptr;
+
+    /* Determine how much space we are going to need.. */
+    for (mesh_layer_data_stream_type stream_type = (mesh_layer_data_stream_type) 0;
+                                     stream_type < MESH_LAYER_DATA_STREAM_TYPE_COUNT;
+                             ++(int&)stream_type)
     {
-        _mesh_layer* layer_ptr = nullptr;
+        if (mesh_ptr->bo_processed_data_stream_start_offset[stream_type] != -1)
+        {
+            result_size += mesh_codec_encode_stream(mesh_ptr->bo_processed_data_stream_encoding[stream_type],
+                                                    nullptr, /* data */
+                                                    _mesh_get_processed_data_stream_n_components(stream_type),
+                                                    mesh_ptr->n_bo_unique_vertices,
+                                                    mesh_ptr->bo_processed_data_stride,
+                                                    nullptr); /* out_data */
+        }
+    }
 
-        *out_n_stream_sets_ptr = 0;
+    result_size += mesh_codec_encode_indices(mesh_ptr->bo_index_encoding,
+                                             index_data_ptr,
+                                             index_size,
+                                             mesh_ptr->bo_processed_data_total_elements,
+                                             nullptr); /* out_data */
 
-        if (system_resizable_vector_get_element_at(mesh_ptr->layers,
-                                                   layer_id,
-                                                  &layer_ptr) )
-        {
-            _mesh_layer_pass* pass_ptr = nullptr;
+    /* ..and fill the buffer */
+    result = new (std::nothrow) unsigned char[result_size];
 
-            if (system_resizable_vector_get_element_at(layer_ptr->passes,
-                                                       layer_pass_id,
-                                                      &pass_ptr) )
-            {
-                if (pass_ptr->index_data_maps[stream_type] != nullptr)
-                {
-                    uint32_t n_sets = 0;
+    ASSERT_ALWAYS_SYNC(result != nullptr,
+                       "Out of memory");
 
-                    system_hash64map_get_property(pass_ptr->index_data_maps[stream_type],
-                                                  SYSTEM_HASH64MAP_PROPERTY_N_ELEMENTS,
-                                                 &n_sets);
+    traveller_ptr = result;
 
-                    if (n_sets > 0)
-                    {
-                        *out_n_stream_sets_ptr += n_sets;
-                    }
-                }
-            }
-            else
-            {
-                ASSERT_DEBUG_SYNC(false,
-                                  "Cannot retrieve pass descriptor at index [%d]",
-                                  layer_pass_id);
-            }
-        }
-        else
+    for (mesh_layer_data_stream_type stream_type = (mesh_layer_data_stream_type) 0;
+                                     stream_type < MESH_LAYER_DATA_STREAM_TYPE_COUNT;
+                             ++(int&)stream_type)
+    {
+        const uint32_t stream_offset = mesh_ptr->bo_processed_data_stream_start_offset[stream_type];
+
+        if (stream_offset != -1)
         {
-            ASSERT_DEBUG_SYNC(false,
-                              "Cannot retrieve layer descriptor at index [%d]",
-                              layer_id);
+            traveller_ptr += mesh_codec_encode_stream(mesh_ptr->bo_processed_data_stream_encoding[stream_type],
+                                                      reinterpret_cast<const float*>(reinterpret_cast<const unsigned char*>(mesh_ptr->bo_processed_data) + stream_offset),
+                                                      _mesh_get_processed_data_stream_n_components(stream_type),
+                                                      mesh_ptr->n_bo_unique_vertices,
+                                                      mesh_ptr->bo_processed_data_stride,
+                                                      traveller_ptr);
         }
     }
 
-    /* Update modification timestamp */
-    mesh_ptr->timestamp_last_modified = system_time_now();
+    traveller_ptr += mesh_codec_encode_indices(mesh_ptr->bo_index_encoding,
+                                               index_data_ptr,
+                                               index_size,
+                                               mesh_ptr->bo_processed_data_total_elements,
+                                               traveller_ptr);
+
+    ASSERT_DEBUG_SYNC(traveller_ptr == result + result_size,
+                      "Encoded data size mismatch");
+
+    *out_encoded_data_size_ptr = result_size;
+
+    return result;
 }
 
-/** TODO */
-PRIVATE void _mesh_get_index_key(uint32_t*               out_result_ptr,
-                                 const _mesh_layer_pass* layer_pass_ptr,
-                                 unsigned int            n_element)
+/** Looks up the pass which holds the specified element.
+ *
+ *  @param arg_ptr   Index key description.
+ *  @param n_element Index of the element, counted across all passes of the mesh.
+ *
+ *  @return Index of the pass in @param arg_ptr's passes array.
+ */
+PRIVATE uint32_t _mesh_find_index_key_pass(const _mesh_index_key_arg* arg_ptr,
+                                           uint32_t                   n_element)
 {
-    unsigned int n_current_word = 0;
+    uint32_t n_pass_max = arg_ptr->n_passes - 1;
+    uint32_t n_pass_min = 0;
 
-    for (unsigned int n_data_stream_type = MESH_LAYER_DATA_STREAM_TYPE_FIRST;
-                      n_data_stream_type < MESH_LAYER_DATA_STREAM_TYPE_COUNT;
-                    ++n_data_stream_type)
+    /* Look for the last pass which starts at or before the element. Empty passes never qualify, since the
+     * pass which follows them starts at the same element. */
+    while (n_pass_min < n_pass_max)
     {
-        if (layer_pass_ptr->index_data_maps[n_data_stream_type] != nullptr)
+        const uint32_t n_pass = n_pass_min + (n_pass_max - n_pass_min + 1) / 2;
+
+        if (arg_ptr->passes[n_pass].first_element <= n_element)
         {
-            _mesh_layer_pass_index_data* index_data_ptr = nullptr;
-            uint32_t                     n_sets         = 0;
+            n_pass_min = n_pass;
+        }
+        else
+        {
+            n_pass_max = n_pass - 1;
+        }
+    }
 
-            system_hash64map_get_property(layer_pass_ptr->index_data_maps[n_data_stream_type],
-                                          SYSTEM_HASH64MAP_PROPERTY_N_ELEMENTS,
-                                         &n_sets);
+    ASSERT_DEBUG_SYNC(n_element >= arg_ptr->passes[n_pass_min].first_element &&
+                      n_element <  arg_ptr->passes[n_pass_min].first_element + arg_ptr->passes[n_pass_min].n_elements,
+                      "Invalid element index");
 
-            for (uint32_t n_set = 0;
-                          n_set < n_sets;
-                        ++n_set)
+    return n_pass_min;
+}
+
+/** Looks up the slot of the vertex welding grid's hash table which describes the specified cell.
+ *  Slots are filled with linear probing. A cell is identified by the location of any vertex
+ *  it holds, so the table only needs to store a single vertex index per slot.
+ *
+ *  @param grid_ptr Vertex welding grid.
+ *  @param cell     Indices of the cell to look for.
+ *  @param hash     Hash of the cell, as returned by _mesh_get_weld_cell_hash().
+ *
+ *  @return Index of the slot describing the cell, or of an empty slot the cell should be stored in,
+ *          if no vertices have been assigned to the cell yet.
+ */
+PRIVATE uint32_t _mesh_find_weld_cell_slot(const _mesh_weld_grid* grid_ptr,
+                                           const int64_t*         cell,
+                                           uint64_t               hash)
+{
+    const uint32_t tag    = static_cast<uint32_t>(hash >> 32);
+    uint32_t       n_slot = static_cast<uint32_t>(hash) & grid_ptr->slot_mask;
+
+    while (grid_ptr->slot_vertices[n_slot] != UINT32_MAX)
+    {
+        if (grid_ptr->slot_tags[n_slot] == tag)
+        {
+            const float* slot_vertex_data = grid_ptr->vertex_data_ptr + 3 /* components */ * grid_ptr->slot_vertices[n_slot];
+
+            if (_mesh_get_weld_cell(slot_vertex_data[0]) == cell[0] &&
+                _mesh_get_weld_cell(slot_vertex_data[1]) == cell[1] &&
+                _mesh_get_weld_cell(slot_vertex_data[2]) == cell[2])
             {
-                uint32_t unique_set_id = 0;
+                break;
+            }
+        }
 
-                ASSERT_DEBUG_SYNC(n_element < layer_pass_ptr->n_elements,
-                                  "Invalid element index requested");
+        n_slot = (n_slot + 1) & grid_ptr->slot_mask;
+    }
 
-                if (system_hash64map_get(layer_pass_ptr->index_data_maps[n_data_stream_type],
-                                         n_set,
-                                        &index_data_ptr)                                              &&
-                    system_hash64map_get(layer_pass_ptr->set_id_to_unique_set_id[n_data_stream_type],
-                                         n_set,
-                                        &unique_set_id) )
-                {
-                    out_result_ptr[n_current_word] = unique_set_id;
-                    n_current_word ++;
+    return n_slot;
+}
 
-                    ASSERT_DEBUG_SYNC(index_data_ptr->data[n_element] != 0xcdcdcdcd,
-                                      "Invalid index data");
+/** Simplifies layer passes from the specified range, as requested by mesh_generate_lods(). Each level of
+ *  detail is simplified from the original index data, so that its error is measured against the original
+ *  surface. */
+PRIVATE void _mesh_generate_layer_pass_lods(uint32_t range_start,
+                                            uint32_t range_end,
+                                            void*    user_arg)
+{
+    const _mesh_lod_generation_arg* arg_ptr = reinterpret_cast<const _mesh_lod_generation_arg*>(user_arg);
 
-                    out_result_ptr[n_current_word] = index_data_ptr->data[n_element];
-                    n_current_word ++;
-                }
-                else
+    for (uint32_t n_pass = range_start;
+                  n_pass < range_end;
+                ++n_pass)
+    {
+        const uint32_t*         index_data      = arg_ptr->index_data + arg_ptr->pass_index_offsets[n_pass];
+        const uint32_t          n_indices       = arg_ptr->pass_index_offsets[n_pass + 1] - arg_ptr->pass_index_offsets[n_pass];
+        const _mesh_layer_pass* pass_ptr        = arg_ptr->pass_ptrs[n_pass];
+        uint32_t                n_vertices      = 0;
+        const float*            vertex_data_ptr = nullptr;
+
+        if (n_indices == 0)
+        {
+            memset(arg_ptr->lod_errors + arg_ptr->n_levels * n_pass,
+                   0,
+                   sizeof(float) * arg_ptr->n_levels);
+            memset(arg_ptr->lod_n_indices + arg_ptr->n_levels * n_pass,
+                   0,
+                   sizeof(uint32_t) * arg_ptr->n_levels);
+
+            continue;
+        }
+
+        n_vertices      = pass_ptr->bo_elements_max_index - pass_ptr->bo_elements_min_index + 1;
+        vertex_data_ptr = reinterpret_cast<const float*>(reinterpret_cast<const char*>(arg_ptr->vertex_data_ptr) + arg_ptr->vertex_stride * pass_ptr->bo_elements_min_index);
+
+        for (uint32_t n_level = 0;
+                      n_level < arg_ptr->n_levels;
+                    ++n_level)
+        {
+            float*         lod_error_ptr     = arg_ptr->lod_errors     + arg_ptr->n_levels * n_pass + n_level;
+            uint32_t*      lod_index_data    = arg_ptr->lod_index_data + arg_ptr->n_levels * arg_ptr->pass_index_offsets[n_pass] + n_level * n_indices;
+            uint32_t*      lod_n_indices_ptr = arg_ptr->lod_n_indices  + arg_ptr->n_levels * n_pass + n_level;
+            const uint32_t target_n_indices  = static_cast<uint32_t>(n_indices * arg_ptr->target_ratios[n_level]) / 3 * 3;
+
+            *lod_n_indices_ptr = mesh_simplifier_simplify(index_data,
+                                                          n_indices,
+                                                          n_vertices,
+                                                          vertex_data_ptr,
+                                                          arg_ptr->vertex_stride,
+                                                          target_n_indices,
+                                                          lod_index_data,
+                                                          lod_error_ptr);
+
+            mesh_optimizer_optimize_vertex_cache(lod_index_data,
+                                                 *lod_n_indices_ptr,
+                                                 n_vertices);
+        }
+    }
+}
+
+/** TODO */
+PRIVATE void _mesh_get_amount_of_stream_data_sets(_mesh*                      mesh_ptr,
+                                                  mesh_layer_data_stream_type stream_type,
+                                                  mesh_layer_id               layer_id,
+                                                  mesh_layer_pass_id          layer_pass_id,
+                                                  uint32_t*                   out_n_stream_sets_ptr)
+{
+    if (out_n_stream_sets_ptr != nullptr)
+    {
+        _mesh_layer* layer_ptr = nullptr;
+
+        *out_n_stream_sets_ptr = 0;
+
+        if (system_resizable_vector_get_element_at(mesh_ptr->layers,
+                                                   layer_id,
+                                                  &layer_ptr) )
+        {
+            _mesh_layer_pass* pass_ptr = nullptr;
+
+            if (system_resizable_vector_get_element_at(layer_ptr->passes,
+                                                       layer_pass_id,
+                                                      &pass_ptr) )
+            {
+                if (pass_ptr->index_data_maps[stream_type] != nullptr)
                 {
-                    ASSERT_DEBUG_SYNC(false,
-                                      "Could not retrieve index data.");
+                    uint32_t n_sets = 0;
 
-                    out_result_ptr[n_current_word] = 0;
-                    n_current_word++;
+                    system_hash64map_get_property(pass_ptr->index_data_maps[stream_type],
+                                                  SYSTEM_HASH64MAP_PROPERTY_N_ELEMENTS,
+                                                 &n_sets);
 
-                    out_result_ptr[n_current_word] = 0;
-                    n_current_word++;
+                    if (n_sets > 0)
+                    {
+                        *out_n_stream_sets_ptr += n_sets;
+                    }
                 }
             }
+            else
+            {
+                ASSERT_DEBUG_SYNC(false,
+                                  "Cannot retrieve pass descriptor at index [%d]",
+                                  layer_pass_id);
+            }
+        }
+        else
+        {
+            ASSERT_DEBUG_SYNC(false,
+                              "Cannot retrieve layer descriptor at index [%d]",
+                              layer_id);
+        }
+    }
+
+    /* Update modification timestamp */
+    mesh_ptr->timestamp_last_modified = system_time_now();
+}
+
+/** Forms the index key of the specified element.
+ *
+ *  @param out_result_ptr Deref will be filled with the key. Must be able to hold
+ *                        @param arg_ptr->n_key_words words.
+ *  @param arg_ptr        Index key description.
+ *  @param key_pass_ptr   Description of the pass which holds the element.
+ *  @param n_element      Index of the element, counted across all passes of the mesh.
+ */
+PRIVATE void _mesh_get_index_key(uint32_t*                   out_result_ptr,
+                                 const _mesh_index_key_arg*  arg_ptr,
+                                 const _mesh_index_key_pass* key_pass_ptr,
+                                 uint32_t                    n_element)
+{
+    const uint32_t n_pass_element = n_element - key_pass_ptr->first_element;
+
+    static_assert(sizeof(mesh_material) <= 2 * sizeof(uint32_t),
+                  "Material handles must fit in a single key word pair");
+
+    ASSERT_DEBUG_SYNC(n_pass_element < key_pass_ptr->n_elements,
+                      "Invalid element index requested");
+
+    memset(out_result_ptr,
+           0,
+           sizeof(uint32_t) * arg_ptr->n_key_words);
+
+    for (uint32_t n_key_set = 0;
+                  n_key_set < key_pass_ptr->n_key_sets;
+                ++n_key_set)
+    {
+        const uint32_t* index_data_ptr = arg_ptr->key_set_index_data[key_pass_ptr->first_key_set + n_key_set];
+
+        if (index_data_ptr != nullptr)
+        {
+            out_result_ptr[2 * n_key_set + 0] = arg_ptr->key_set_unique_ids[key_pass_ptr->first_key_set + n_key_set];
+            out_result_ptr[2 * n_key_set + 1] = index_data_ptr[n_pass_element];
         }
     }
 
-    static_assert(sizeof(void*) == sizeof(uint32_t),
-                  "32-bit only logic");
+    memcpy(out_result_ptr + 2 * key_pass_ptr->n_key_sets,
+          &key_pass_ptr->material,
+           sizeof(key_pass_ptr->material) );
+}
+
+/** Returns a hash of the specified index key. */
+PRIVATE uint32_t _mesh_get_index_key_hash(const uint32_t* key_ptr,
+                                          uint32_t        n_key_words)
+{
+    uint64_t result = 0;
+
+    for (uint32_t n_key_word = 0;
+                  n_key_word < n_key_words;
+                ++n_key_word)
+    {
+        result  = (result ^ key_ptr[n_key_word]) * 0x9E3779B97F4A7C15ull;
+        result ^= result >> 32;
+    }
+
+    /* Mix the bits, so that both the top bits (used to select a partition) and the bottom bits
+     * (used to select a hash table slot) of the result can be used */
+    result ^= result >> 29;
+    result *= 0xBF58476D1CE4E5B9ull;
+    result ^= result >> 32;
 
-    memcpy(out_result_ptr + n_current_word,
-           layer_pass_ptr->material,
-           sizeof(layer_pass_ptr->material) );
+    return static_cast<uint32_t>(result);
 }
 
-/** TODO */
-PRIVATE uint32_t _mesh_get_source_index_from_index_key(const uint32_t*             key_ptr,
-                                                       const _mesh_layer_pass*     layer_pass_ptr,
-                                                       mesh_layer_data_stream_type data_stream_type,
-                                                       unsigned int                set_id)
+/** Retrieves index data sets a layer pass' index keys are built from. Sets are enumerated in the
+ *  order of stream types, and then set IDs.
+ *
+ *  @param layer_pass_ptr      Layer pass to use.
+ *  @param out_index_data_ptrs If not NULL, deref will be filled with index data of each set. nullptr
+ *                             is stored for sets whose index data or unique set ID cannot be retrieved.
+ *  @param out_unique_set_ids  If not NULL, deref will be filled with unique IDs of each set.
+ *  @param out_key_set_offsets If not NULL, deref will be filled with the index of the first set of
+ *                             each stream type. Must be able to hold MESH_LAYER_DATA_STREAM_TYPE_COUNT
+ *                             entries.
+ *
+ *  @return Number of sets.
+ */
+PRIVATE uint32_t _mesh_get_index_key_sets(const _mesh_layer_pass* layer_pass_ptr,
+                                          const uint32_t**        out_index_data_ptrs,
+                                          uint32_t*               out_unique_set_ids,
+                                          uint32_t*               out_key_set_offsets)
 {
-    unsigned int n_current_word = 0;
-    uint32_t     result         = -1;
+    uint32_t n_key_sets = 0;
 
     for (unsigned int n_data_stream_type = MESH_LAYER_DATA_STREAM_TYPE_FIRST;
                       n_data_stream_type < MESH_LAYER_DATA_STREAM_TYPE_COUNT;
                     ++n_data_stream_type)
     {
+        if (out_key_set_offsets != nullptr)
+        {
+            out_key_set_offsets[n_data_stream_type] = n_key_sets;
+        }
+
         if (layer_pass_ptr->index_data_maps[n_data_stream_type] != nullptr)
         {
             uint32_t n_sets = 0;
@@ -677,33 +1495,90 @@ PRIVATE uint32_t _mesh_get_source_index_from_index_key(const uint32_t*
 
             for (uint32_t n_set = 0;
                           n_set < n_sets;
-                        ++n_set)
+                        ++n_set, ++n_key_sets)
             {
-                if (n_set              == set_id &&
-                    n_data_stream_type == data_stream_type)
-                {
-                    result = key_ptr[2 * n_current_word + 1];
+                _mesh_layer_pass_index_data* index_data_ptr = nullptr;
+                uint32_t                     unique_set_id  = 0;
 
-                    #ifdef _WIN32
+                if (system_hash64map_get(layer_pass_ptr->index_data_maps[n_data_stream_type],
+                                         n_set,
+                                        &index_data_ptr)                                              &&
+                    system_hash64map_get(layer_pass_ptr->set_id_to_unique_set_id[n_data_stream_type],
+                                         n_set,
+                                        &unique_set_id) )
+                {
+                    if (out_index_data_ptrs != nullptr)
                     {
-                        ASSERT_DEBUG_SYNC(result != 0xcdcdcdcd,
-                                          "Whoops?");
+                        out_index_data_ptrs[n_key_sets] = index_data_ptr->data;
                     }
-                    #endif
 
-                    goto end;
+                    if (out_unique_set_ids != nullptr)
+                    {
+                        out_unique_set_ids[n_key_sets] = unique_set_id;
+                    }
                 }
+                else
+                {
+                    ASSERT_DEBUG_SYNC(false,
+                                      "Could not retrieve index data.");
 
-                n_current_word++;
+                    if (out_index_data_ptrs != nullptr)
+                    {
+                        out_index_data_ptrs[n_key_sets] = nullptr;
+                    }
+
+                    if (out_unique_set_ids != nullptr)
+                    {
+                        out_unique_set_ids[n_key_sets] = 0;
+                    }
+                }
             }
         }
     }
 
-end:
-    ASSERT_DEBUG_SYNC(result != -1,
-                      "Invalid request");
+    return n_key_sets;
+}
 
-    return result;
+/** Returns the size of a single index of the specified type, or 0 if the type is not recognized. */
+PRIVATE uint32_t _mesh_get_index_size(_mesh_index_type index_type)
+{
+    switch (index_type)
+    {
+        case MESH_INDEX_TYPE_UNSIGNED_CHAR:  return sizeof(unsigned char);
+        case MESH_INDEX_TYPE_UNSIGNED_SHORT: return sizeof(unsigned short);
+        case MESH_INDEX_TYPE_UNSIGNED_INT:   return sizeof(unsigned int);
+
+        default:
+        {
+            return 0;
+        }
+    }
+}
+
+/** Returns the number of float components each vertex stores for the specified stream in the
+ *  processed data buffer.
+ */
+PRIVATE uint32_t _mesh_get_processed_data_stream_n_components(mesh_layer_data_stream_type stream_type)
+{
+    switch (stream_type)
+    {
+        case MESH_LAYER_DATA_STREAM_TYPE_TEXCOORDS:
+        {
+            return 2;
+        }
+
+        case MESH_LAYER_DATA_STREAM_TYPE_NORMALS:
+        case MESH_LAYER_DATA_STREAM_TYPE_SPHERICAL_HARMONIC_3BANDS:
+        case MESH_LAYER_DATA_STREAM_TYPE_VERTICES:
+        {
+            return 3;
+        }
+
+        default:
+        {
+            return 4;
+        }
+    }
 }
 
 /** TODO */
@@ -874,6 +1749,47 @@ PRIVATE void _mesh_get_total_number_of_stream_sets_for_mesh(_mesh*
     }
 }
 
+/** Calculates ACMR & ATVR of a triangle list. Both are set to 0 if the list is empty. */
+PRIVATE void _mesh_get_vertex_cache_statistics(const uint32_t* index_data,
+                                               uint32_t        n_indices,
+                                               uint32_t        n_vertices,
+                                               float*          out_acmr_ptr,
+                                               float*          out_atvr_ptr)
+{
+    uint32_t n_transformed_vertices = 0;
+    uint32_t n_used_vertices        = 0;
+
+    mesh_optimizer_get_vertex_cache_statistics(index_data,
+                                               n_indices,
+                                               n_vertices,
+                                              &n_transformed_vertices,
+                                              &n_used_vertices);
+
+    *out_acmr_ptr = (n_indices       != 0) ? float(n_transformed_vertices) / float(n_indices / 3)   : 0.0f;
+    *out_atvr_ptr = (n_used_vertices != 0) ? float(n_transformed_vertices) / float(n_used_vertices) : 0.0f;
+}
+
+/** Returns the index of the vertex welding grid cell which holds the specified coordinate. */
+PRIVATE int64_t _mesh_get_weld_cell(double coordinate)
+{
+    return static_cast<int64_t>(floor(coordinate * (1.0 / NORMAL_GENERATION_WELD_CELL_SIZE) ));
+}
+
+/** Returns a hash of the specified vertex welding grid cell indices. */
+PRIVATE uint64_t _mesh_get_weld_cell_hash(const int64_t* cell)
+{
+    uint64_t result = (static_cast<uint64_t>(cell[0]) * 73856093ull) ^
+                      (static_cast<uint64_t>(cell[1]) * 19349663ull) ^
+                      (static_cast<uint64_t>(cell[2]) * 83492791ull);
+
+    /* Mix the bits, so that both halves of the result can be used */
+    result ^= result >> 31;
+    result *= 0xBF58476D1CE4E5B9ull;
+    result ^= result >> 29;
+
+    return result;
+}
+
 /** TODO */
 PRIVATE void _mesh_init_mesh(_mesh*                    new_mesh_ptr,
                              system_hashed_ansi_string name,
@@ -885,6 +1801,9 @@ PRIVATE void _mesh_init_mesh(_mesh*                    new_mesh_ptr,
     memset(new_mesh_ptr->aabb_min,
            0,
            sizeof(new_mesh_ptr->aabb_min) );
+    memset(new_mesh_ptr->lod_errors,
+           0,
+           sizeof(new_mesh_ptr->lod_errors) );
 
     new_mesh_ptr->aabb_max[3]                               = 1;
     new_mesh_ptr->aabb_min[3]                               = 1;
@@ -892,8 +1811,10 @@ PRIVATE void _mesh_init_mesh(_mesh*                    new_mesh_ptr,
     new_mesh_ptr->get_custom_mesh_aabb_proc_user_arg        = nullptr;
     new_mesh_ptr->get_gpu_stream_mesh_aabb_proc_user_arg    = nullptr;
     new_mesh_ptr->bo                                        = nullptr;
+    new_mesh_ptr->bo_index_encoding                         = MESH_INDEX_ENCODING_RAW;
     new_mesh_ptr->bo_index_type                             = MESH_INDEX_TYPE_UNKNOWN;
     new_mesh_ptr->bo_processed_data                         = nullptr;
+    new_mesh_ptr->bo_processed_data_serializer              = nullptr;
     new_mesh_ptr->bo_processed_data_size                    = 0;
     new_mesh_ptr->bo_processed_data_stride                  = -1;
     new_mesh_ptr->bo_storage_initialized                    = false;
@@ -902,6 +1823,7 @@ PRIVATE void _mesh_init_mesh(_mesh*                    new_mesh_ptr,
     new_mesh_ptr->layers                                    = nullptr;
     new_mesh_ptr->materials                                 = nullptr;
     new_mesh_ptr->n_bo_unique_vertices                      = 0;
+    new_mesh_ptr->n_lods                                    = 1;
     new_mesh_ptr->n_sh_bands                                = 0;
     new_mesh_ptr->n_sh_components                           = SH_COMPONENTS_UNDEFINED;
     new_mesh_ptr->name                                      = name;
@@ -909,6 +1831,7 @@ PRIVATE void _mesh_init_mesh(_mesh*                    new_mesh_ptr,
     new_mesh_ptr->pfn_get_gpu_stream_mesh_aabb_proc         = nullptr;
     new_mesh_ptr->pfn_get_present_task_for_custom_mesh_proc = nullptr;
     new_mesh_ptr->ral_context                               = nullptr;
+    new_mesh_ptr->normals_weighting                         = MESH_NORMAL_WEIGHTING_UNIFORM;
     new_mesh_ptr->set_id_counter                            = 0;
     new_mesh_ptr->timestamp_last_modified                   = system_time_now();
     new_mesh_ptr->vertex_ordering                           = MESH_VERTEX_ORDERING_CCW;
@@ -917,6 +1840,7 @@ PRIVATE void _mesh_init_mesh(_mesh*                    new_mesh_ptr,
                       n_stream_type < MESH_LAYER_DATA_STREAM_TYPE_COUNT;
                       n_stream_type ++)
     {
+        new_mesh_ptr->bo_processed_data_stream_encoding    [n_stream_type] = MESH_LAYER_DATA_STREAM_ENCODING_FLOAT;
         new_mesh_ptr->bo_processed_data_stream_start_offset[n_stream_type] = -1;
     }
 }
@@ -924,7 +1848,7 @@ PRIVATE void _mesh_init_mesh(_mesh*                    new_mesh_ptr,
 /** TODO */
 PRIVATE void _mesh_init_mesh_layer(_mesh_layer* new_mesh_layer_ptr)
 {
-    new_mesh_layer_ptr->data_streams         = system_hash64map_create(4 /* capacity */);
+    new_mesh_layer_ptr->data_streams         = system_hash64map_create(sizeof(_mesh_layer_data_stream*) );
     new_mesh_layer_ptr->n_gl_unique_elements = 0;
     new_mesh_layer_ptr->passes_counter       = 1;
 
@@ -997,124 +1921,36 @@ PRIVATE void _mesh_init_mesh_layer_pass(_mesh_layer_pass* new_mesh_layer_pass_pt
     }
 }
 
-/** TODO */
-PRIVATE bool _mesh_is_key_float_lower(size_t key_size,
-                                      void*  arg1,
-                                      void*  arg2)
-{
-    float*        arg1_float_ptr = reinterpret_cast<float*>(arg1);
-    system_hash64 arg1_hash      = system_hash64_calculate(reinterpret_cast<const char*>(arg1_float_ptr),
-                                                           key_size);
-    float*        arg2_float_ptr = reinterpret_cast<float*>(arg2);
-    system_hash64 arg2_hash      = system_hash64_calculate(reinterpret_cast<const char*>(arg2_float_ptr),
-                                                           key_size);
-    bool          result         = true;
-
-    if (arg1_hash != arg2_hash)
-    {
-        result = (arg1_hash < arg2_hash);
-    }
-    else
-    {
-        /* Take the slow route */
-        for (unsigned int n_key_item = 0;
-                          n_key_item < key_size / sizeof(float);
-                        ++n_key_item)
-        {
-            if (arg2_float_ptr[n_key_item] >= arg2_float_ptr[n_key_item])
-            {
-                result = false;
-
-                break;
-            }
-        }
-    }
-
-    return result;
-}
-
-/** TODO */
-PRIVATE bool _mesh_is_key_float_equal(size_t key_size,
-                                      void*  arg1,
-                                      void*  arg2)
+/** Tells whether processed data of the mesh can be stored in the compact form. This requires each
+ *  used stream to fit within the vertex stride (which is not the case for streams that had to be
+ *  padded), and the index data to directly follow the vertex data.
+ */
+PRIVATE bool _mesh_is_processed_data_encodable(const _mesh* mesh_ptr)
 {
-    float* arg1_float_ptr = reinterpret_cast<float*>(arg1);
-    float* arg2_float_ptr = reinterpret_cast<float*>(arg2);
-    bool   result         = true;
+    const uint32_t index_size   = _mesh_get_index_size(mesh_ptr->bo_index_type);
+    const uint64_t decoded_size = static_cast<uint64_t>(mesh_ptr->bo_processed_data_stride) * mesh_ptr->n_bo_unique_vertices +
+                                  static_cast<uint64_t>(index_size)                         * mesh_ptr->bo_processed_data_total_elements;
 
-    for (unsigned int n_key_item = 0;
-                      n_key_item < key_size / sizeof(float);
-                    ++n_key_item)
+    if (index_size   == 0                                ||
+        decoded_size != mesh_ptr->bo_processed_data_size)
     {
-        if (fabs(arg1_float_ptr[n_key_item] - arg2_float_ptr[n_key_item]) > 1e-5f)
-        {
-            result = false;
-
-            break;
-        }
+        return false;
     }
 
-    return result;
-}
-
-/** TODO */
-PRIVATE bool _mesh_is_key_uint32_lower(size_t key_size,
-                                       void*  arg1,
-                                       void*  arg2)
-{
-    uint32_t*     arg1_uint_ptr = reinterpret_cast<uint32_t*>(arg1);
-    system_hash64 arg1_hash     = system_hash64_calculate(reinterpret_cast<const char*>(arg1),
-                                                          key_size);
-    uint32_t*     arg2_uint_ptr = reinterpret_cast<uint32_t*>(arg2);
-    system_hash64 arg2_hash     = system_hash64_calculate(reinterpret_cast<const char*>(arg2),
-                                                          key_size);
-    bool          result        = true;
-
-    if (arg1_hash != arg2_hash)
-    {
-        result = (arg1_hash < arg2_hash);
-    }
-    else
+    for (mesh_layer_data_stream_type stream_type = (mesh_layer_data_stream_type) 0;
+                                     stream_type < MESH_LAYER_DATA_STREAM_TYPE_COUNT;
+                             ++(int&)stream_type)
     {
-        /* Take the slow route */
-        for (unsigned int n_key_item = 0;
-                          n_key_item < key_size / sizeof(uint32_t);
-                        ++n_key_item)
-        {
-            if (!(arg1_uint_ptr[n_key_item] < arg2_uint_ptr[n_key_item]))
-            {
-                result = false;
-
-                break;
-            }
-        }
-    }
+        const uint32_t stream_offset = mesh_ptr->bo_processed_data_stream_start_offset[stream_type];
 
-    return result;
-}
-
-/** TODO */
-PRIVATE bool _mesh_is_key_uint32_equal(size_t key_size,
-                                       void*  arg1,
-                                       void*  arg2)
-{
-    uint32_t* arg1_uint_ptr = reinterpret_cast<uint32_t*>(arg1);
-    uint32_t* arg2_uint_ptr = reinterpret_cast<uint32_t*>(arg2);
-    bool      result        = true;
-
-    for (unsigned int n_key_item = 0;
-                      n_key_item < key_size / sizeof(uint32_t);
-                    ++n_key_item)
-    {
-        if (!(arg1_uint_ptr[n_key_item] == arg2_uint_ptr[n_key_item]))
+        if (stream_offset                                                                            != -1 &&
+            stream_offset + sizeof(float) * _mesh_get_processed_data_stream_n_components(stream_type) >  mesh_ptr->bo_processed_data_stride)
         {
-            result = false;
-
-            break;
+            return false;
         }
     }
 
-    return result;
+    return true;
 }
 
 /** TODO */
@@ -1201,7 +2037,8 @@ PRIVATE void _mesh_material_setting_changed(const void* callback_data,
         _mesh_release_normals_data             (mesh_ptr);
 
         /* Generate normal data */
-        mesh_generate_normal_data( (mesh) mesh_ptr);
+        mesh_generate_normal_data( (mesh) mesh_ptr,
+                                  mesh_ptr->normals_weighting);
 
         /* Update GL blob */
         mesh_fill_ral_buffers( (mesh) mesh_ptr,
@@ -1218,15 +2055,216 @@ PRIVATE void _mesh_on_fill_ral_op_finished(void* callback_data)
     /* Safe to release GL processed data buffer now! */
     if (!(mesh_ptr->creation_flags & MESH_CREATION_FLAGS_SAVE_SUPPORT) )
     {
-        delete [] mesh_ptr->bo_processed_data;
-
-        mesh_ptr->bo_processed_data = nullptr;
+        _mesh_release_bo_processed_data(mesh_ptr);
     }
 }
 
-/** TODO */
-PRIVATE void _mesh_release(void* arg)
-{
+/** Thread pool call-back which looks for elements using the same index keys within partitions
+ *  <range_start, range_end). Each element is assigned the index of the first element, which uses
+ *  the same key. Since each key only ever ends up in a single partition, partitions can be
+ *  processed independently of each other.
+ *
+ *  @param range_start Index of the first partition to process.
+ *  @param range_end   Index following the last partition to process.
+ *  @param user_arg    _mesh_index_key_arg instance.
+ */
+PRIVATE void _mesh_merge_index_keys(uint32_t range_start,
+                                    uint32_t range_end,
+                                    void*    user_arg)
+{
+    const _mesh_index_key_arg* arg_ptr      = reinterpret_cast<const _mesh_index_key_arg*>(user_arg);
+    const size_t               key_size     = sizeof(uint32_t) * arg_ptr->n_key_words;
+    uint32_t*                  key_ptr      = new (std::nothrow) uint32_t[arg_ptr->n_key_words];
+    uint32_t*                  slot_key_ptr = new (std::nothrow) uint32_t[arg_ptr->n_key_words];
+
+    ASSERT_ALWAYS_SYNC(key_ptr      != nullptr &&
+                       slot_key_ptr != nullptr,
+                       "Out of memory");
+
+    for (uint32_t n_partition = range_start;
+                  n_partition < range_end;
+                ++n_partition)
+    {
+        const uint32_t*             elements     = arg_ptr->partition_elements + arg_ptr->partition_offsets[n_partition];
+        const _mesh_index_key_pass* key_pass_ptr = arg_ptr->passes;
+        const uint32_t              n_elements   = arg_ptr->partition_offsets[n_partition + 1] - arg_ptr->partition_offsets[n_partition];
+        uint32_t                    n_slots      = 1;
+        uint32_t*                   slots        = nullptr;
+
+        if (n_elements == 0)
+        {
+            continue;
+        }
+
+        while (n_slots < n_elements * 2)
+        {
+            n_slots <<= 1;
+        }
+
+        slots = new (std::nothrow) uint32_t[n_slots];
+
+        ASSERT_ALWAYS_SYNC(slots != nullptr,
+                           "Out of memory");
+
+        memset(slots,
+               0xFF,
+               sizeof(uint32_t) * n_slots);
+
+        /* Elements are stored in ascending order, so the first element which uses a key always ends up
+         * in the hash table. */
+        for (uint32_t n_partition_element = 0;
+                      n_partition_element < n_elements;
+                    ++n_partition_element)
+        {
+            const uint32_t n_element     = elements[n_partition_element];
+            const uint32_t hash          = arg_ptr->element_hashes[n_element];
+            bool           is_key_formed = false;
+            uint32_t       n_slot        = hash & (n_slots - 1);
+            uint32_t       vertex        = UINT32_MAX;
+
+            while (n_element >= key_pass_ptr->first_element + key_pass_ptr->n_elements)
+            {
+                ++key_pass_ptr;
+            }
+
+            while (slots[n_slot] != UINT32_MAX)
+            {
+                const uint32_t slot_element = slots[n_slot];
+
+                if (arg_ptr->element_hashes[slot_element] == hash)
+                {
+                    if (!is_key_formed)
+                    {
+                        _mesh_get_index_key(key_ptr,
+                                            arg_ptr,
+                                            key_pass_ptr,
+                                            n_element);
+
+                        is_key_formed = true;
+                    }
+
+                    _mesh_get_index_key(slot_key_ptr,
+                                        arg_ptr,
+                                        arg_ptr->passes + _mesh_find_index_key_pass(arg_ptr,
+                                                                                    slot_element),
+                                        slot_element);
+
+                    if (memcmp(key_ptr,
+                               slot_key_ptr,
+                               key_size) == 0)
+                    {
+                        vertex = slot_element;
+
+                        break;
+                    }
+                }
+
+                n_slot = (n_slot + 1) & (n_slots - 1);
+            }
+
+            if (vertex == UINT32_MAX)
+            {
+                slots[n_slot] = n_element;
+                vertex        = n_element;
+            }
+
+            arg_ptr->element_vertices[n_element] = vertex;
+        }
+
+        delete [] slots;
+    }
+
+    delete [] key_ptr;
+    delete [] slot_key_ptr;
+}
+
+/** Runs vertex cache & overdraw optimization for a range of layer passes, described by _mesh_optimization_arg. */
+PRIVATE void _mesh_optimize_layer_passes(uint32_t range_start,
+                                         uint32_t range_end,
+                                         void*    user_arg)
+{
+    const _mesh_optimization_arg* arg_ptr = reinterpret_cast<const _mesh_optimization_arg*>(user_arg);
+
+    for (uint32_t n_pass = range_start;
+                  n_pass < range_end;
+                ++n_pass)
+    {
+        uint32_t*               index_data = arg_ptr->index_data + arg_ptr->pass_index_offsets[n_pass];
+        const uint32_t          n_indices  = arg_ptr->pass_index_offsets[n_pass + 1] - arg_ptr->pass_index_offsets[n_pass];
+        const _mesh_layer_pass* pass_ptr   = arg_ptr->pass_ptrs[n_pass];
+        const uint32_t          n_vertices = pass_ptr->bo_elements_max_index - pass_ptr->bo_elements_min_index + 1;
+
+        if (n_indices == 0)
+        {
+            continue;
+        }
+
+        /* Work on the pass' own vertex range, so that the optimizers' working sets do not depend on the
+         * size of the whole mesh. */
+        for (uint32_t n_index = 0;
+                      n_index < n_indices;
+                    ++n_index)
+        {
+            index_data[n_index] -= pass_ptr->bo_elements_min_index;
+        }
+
+        if (arg_ptr->flags & MESH_OPTIMIZATION_FLAGS_VERTEX_CACHE)
+        {
+            mesh_optimizer_optimize_vertex_cache(index_data,
+                                                 n_indices,
+                                                 n_vertices);
+        }
+
+        if ((arg_ptr->flags & MESH_OPTIMIZATION_FLAGS_OVERDRAW) &&
+             arg_ptr->vertex_data_ptr != nullptr)
+        {
+            mesh_optimizer_optimize_overdraw(index_data,
+                                             n_indices,
+                                             n_vertices,
+                                             reinterpret_cast<const float*>(reinterpret_cast<const char*>(arg_ptr->vertex_data_ptr) + arg_ptr->vertex_stride * pass_ptr->bo_elements_min_index),
+                                             arg_ptr->vertex_stride,
+                                             OPTIMIZATION_OVERDRAW_THRESHOLD);
+        }
+
+        for (uint32_t n_index = 0;
+                      n_index < n_indices;
+                    ++n_index)
+        {
+            index_data[n_index] += pass_ptr->bo_elements_min_index;
+        }
+    }
+}
+
+/** Reads properties of the processed data buffer, as stored by _mesh_write_processed_data_properties(). */
+PRIVATE void _mesh_read_processed_data_properties(_mesh*                 mesh_ptr,
+                                                  system_file_serializer serializer)
+{
+    for (mesh_layer_data_stream_type stream_type = (mesh_layer_data_stream_type) 0;
+                                     stream_type < MESH_LAYER_DATA_STREAM_TYPE_COUNT;
+                             ++(int&)stream_type)
+    {
+        system_file_serializer_read(serializer,
+                                    sizeof(mesh_ptr->bo_processed_data_stream_start_offset[0]),
+                                   &mesh_ptr->bo_processed_data_stream_start_offset[stream_type]);
+    }
+
+    system_file_serializer_read(serializer,
+                                sizeof(mesh_ptr->bo_processed_data_stride),
+                               &mesh_ptr->bo_processed_data_stride);
+    system_file_serializer_read(serializer,
+                                sizeof(mesh_ptr->bo_processed_data_total_elements),
+                               &mesh_ptr->bo_processed_data_total_elements);
+    system_file_serializer_read(serializer,
+                                sizeof(mesh_ptr->n_bo_unique_vertices),
+                               &mesh_ptr->n_bo_unique_vertices);
+    system_file_serializer_read(serializer,
+                                sizeof(mesh_ptr->bo_index_type),
+                               &mesh_ptr->bo_index_type);
+}
+
+/** TODO */
+PRIVATE void _mesh_release(void* arg)
+{
     _mesh* mesh_ptr = reinterpret_cast<_mesh*>(arg);
 
     /* Sign out of material call-backs */
@@ -1309,9 +2347,7 @@ PRIVATE void _mesh_release(void* arg)
 
     if (mesh_ptr->bo_processed_data != nullptr)
     {
-        delete [] mesh_ptr->bo_processed_data;
-
-        mesh_ptr->bo_processed_data = nullptr;
+        _mesh_release_bo_processed_data(mesh_ptr);
     }
 
     /* Release other helper structures */
@@ -1330,6 +2366,27 @@ PRIVATE void _mesh_release(void* arg)
     }
 }
 
+/** Releases the processed data buffer. If the buffer is backed by a file mapping, the mesh's reference
+ *  to the mapped file serializer is dropped instead.
+ *
+ *  @param mesh_ptr Mesh instance to use.
+ */
+PRIVATE void _mesh_release_bo_processed_data(_mesh* mesh_ptr)
+{
+    if (mesh_ptr->bo_processed_data_serializer != nullptr)
+    {
+        system_file_serializer_release(mesh_ptr->bo_processed_data_serializer);
+
+        mesh_ptr->bo_processed_data_serializer = nullptr;
+    }
+    else
+    {
+        delete [] mesh_ptr->bo_processed_data;
+    }
+
+    mesh_ptr->bo_processed_data = nullptr;
+}
+
 /** TODO */
 PRIVATE void _mesh_release_normals_data(_mesh* mesh_ptr)
 {
@@ -1491,6 +2548,158 @@ PRIVATE void _mesh_update_aabb(_mesh* mesh_ptr)
     }
 }
 
+/** Assigns welded vertex IDs to vertices, so that vertices which are no further than
+ *  NORMAL_GENERATION_WELD_EPSILON away from each other on every axis share the same ID.
+ *
+ *  Vertices are distributed over a uniform grid, whose cells are larger than the epsilon. A vertex is
+ *  matched against vertices stored in all the cells its epsilon box overlaps, so vertices lying close
+ *  to, or on different sides of, a cell boundary are welded too. Vertices are processed in order and
+ *  each vertex is welded to the first matching vertex it finds, so the result is deterministic.
+ *
+ *  @param vertex_data_ptr       Vertex data. 3 floats per vertex.
+ *  @param n_vertices            Number of vertices to process.
+ *  @param out_welded_vertex_ids Deref will be filled with welded vertex IDs. Must be able to hold
+ *                               @param n_vertices entries.
+ *
+ *  @return Number of unique welded vertex IDs. IDs are assigned in ascending order, starting from 0.
+ */
+PRIVATE uint32_t _mesh_weld_vertices(const float* vertex_data_ptr,
+                                     uint32_t     n_vertices,
+                                     uint32_t*    out_welded_vertex_ids)
+{
+    _mesh_weld_grid grid;
+    uint32_t        n_slots           = 1;
+    uint32_t        n_welded_vertices = 0;
+
+    while (n_slots < n_vertices * 2)
+    {
+        n_slots <<= 1;
+    }
+
+    grid.next_cell_vertices = new (std::nothrow) uint32_t[n_vertices];
+    grid.slot_tags          = new (std::nothrow) uint32_t[n_slots];
+    grid.slot_vertices      = new (std::nothrow) uint32_t[n_slots];
+    grid.slot_mask          = n_slots - 1;
+    grid.vertex_data_ptr    = vertex_data_ptr;
+
+    ASSERT_ALWAYS_SYNC(grid.next_cell_vertices != nullptr &&
+                       grid.slot_tags          != nullptr &&
+                       grid.slot_vertices      != nullptr,
+                       "Out of memory");
+
+    memset(grid.slot_vertices,
+           0xFF,
+           sizeof(uint32_t) * n_slots);
+
+    for (uint32_t n_vertex = 0;
+                  n_vertex < n_vertices;
+                ++n_vertex)
+    {
+        int64_t      cell    [3];
+        int64_t      cell_max[3];
+        int64_t      cell_min[3];
+        const float* vertex_data      = vertex_data_ptr + 3 /* components */ * n_vertex;
+        uint32_t     welded_vertex_id = UINT32_MAX;
+
+        for (uint32_t n_dimension = 0;
+                      n_dimension < 3;
+                    ++n_dimension)
+        {
+            cell_max[n_dimension] = _mesh_get_weld_cell(static_cast<double>(vertex_data[n_dimension]) + NORMAL_GENERATION_WELD_EPSILON);
+            cell_min[n_dimension] = _mesh_get_weld_cell(static_cast<double>(vertex_data[n_dimension]) - NORMAL_GENERATION_WELD_EPSILON);
+        }
+
+        for (cell[0]  = cell_min[0];
+             cell[0] <= cell_max[0] && welded_vertex_id == UINT32_MAX;
+           ++cell[0])
+        {
+            for (cell[1]  = cell_min[1];
+                 cell[1] <= cell_max[1] && welded_vertex_id == UINT32_MAX;
+               ++cell[1])
+            {
+                for (cell[2]  = cell_min[2];
+                     cell[2] <= cell_max[2] && welded_vertex_id == UINT32_MAX;
+                   ++cell[2])
+                {
+                    const uint32_t n_slot = _mesh_find_weld_cell_slot(&grid,
+                                                                      cell,
+                                                                      _mesh_get_weld_cell_hash(cell) );
+
+                    for (uint32_t cell_vertex  = grid.slot_vertices[n_slot];
+                                  cell_vertex != UINT32_MAX;
+                                  cell_vertex  = grid.next_cell_vertices[cell_vertex])
+                    {
+                        const float* cell_vertex_data = vertex_data_ptr + 3 /* components */ * cell_vertex;
+
+                        if (fabs(static_cast<double>(cell_vertex_data[0]) - vertex_data[0]) <= NORMAL_GENERATION_WELD_EPSILON &&
+                            fabs(static_cast<double>(cell_vertex_data[1]) - vertex_data[1]) <= NORMAL_GENERATION_WELD_EPSILON &&
+                            fabs(static_cast<double>(cell_vertex_data[2]) - vertex_data[2]) <= NORMAL_GENERATION_WELD_EPSILON)
+                        {
+                            welded_vertex_id = out_welded_vertex_ids[cell_vertex];
+
+                            break;
+                        }
+                    }
+                }
+            }
+        }
+
+        if (welded_vertex_id == UINT32_MAX)
+        {
+            /* No match. Store the vertex in its cell, so that subsequent vertices can be welded to it. */
+            uint64_t hash;
+            uint32_t n_slot;
+
+            cell[0] = _mesh_get_weld_cell(vertex_data[0]);
+            cell[1] = _mesh_get_weld_cell(vertex_data[1]);
+            cell[2] = _mesh_get_weld_cell(vertex_data[2]);
+            hash    = _mesh_get_weld_cell_hash(cell);
+            n_slot  = _mesh_find_weld_cell_slot(&grid,
+                                                cell,
+                                                hash);
+
+            grid.next_cell_vertices[n_vertex] = grid.slot_vertices[n_slot];
+            grid.slot_tags         [n_slot]   = static_cast<uint32_t>(hash >> 32);
+            grid.slot_vertices     [n_slot]   = n_vertex;
+            welded_vertex_id                  = n_welded_vertices++;
+        }
+
+        out_welded_vertex_ids[n_vertex] = welded_vertex_id;
+    }
+
+    delete [] grid.next_cell_vertices;
+    delete [] grid.slot_tags;
+    delete [] grid.slot_vertices;
+
+    return n_welded_vertices;
+}
+
+/** Writes properties of the processed data buffer. */
+PRIVATE void _mesh_write_processed_data_properties(const _mesh*           mesh_ptr,
+                                                   system_file_serializer serializer)
+{
+    for (mesh_layer_data_stream_type stream_type = (mesh_layer_data_stream_type) 0;
+                                     stream_type < MESH_LAYER_DATA_STREAM_TYPE_COUNT;
+                                   ++(int&)stream_type)
+    {
+        system_file_serializer_write(serializer,
+                                     sizeof(mesh_ptr->bo_processed_data_stream_start_offset[0]),
+                                    &mesh_ptr->bo_processed_data_stream_start_offset[stream_type]);
+    }
+
+    system_file_serializer_write(serializer,
+                                 sizeof(mesh_ptr->bo_processed_data_stride),
+                                &mesh_ptr->bo_processed_data_stride);
+    system_file_serializer_write(serializer,
+                                 sizeof(mesh_ptr->bo_processed_data_total_elements),
+                                &mesh_ptr->bo_processed_data_total_elements);
+    system_file_serializer_write(serializer,
+                                 sizeof(mesh_ptr->n_bo_unique_vertices),
+                                &mesh_ptr->n_bo_unique_vertices);
+    system_file_serializer_write(serializer,
+                                 sizeof(mesh_ptr->bo_index_type),
+                                &mesh_ptr->bo_index_type);
+}
 
 /* Please see header for specification */
 PUBLIC EMERALD_API mesh_layer_id mesh_add_layer(mesh instance)
@@ -1697,8 +2906,8 @@ PUBLIC EMERALD_API void mesh_add_layer_data_stream_from_client_memory(mesh
                 unsigned int component_size = (data_stream_ptr->data_type == MESH_LAYER_DATA_STREAM_DATA_TYPE_FLOAT) ? sizeof(float)
                                                                                                                      : 1;
 
-                data_stream_ptr->data           = new (std::nothrow) unsigned char[data_stream_ptr->n_components * component_size * n_items];
                 data_stream_ptr->n_components   = n_components;
+                data_stream_ptr->data           = new (std::nothrow) unsigned char[data_stream_ptr->n_components * component_size * n_items];
                 data_stream_ptr->n_items_ptr    = new unsigned int(n_items);
                 data_stream_ptr->n_items_source = MESH_LAYER_DATA_STREAM_SOURCE_CLIENT_MEMORY;
 
@@ -2018,14 +3227,17 @@ PUBLIC EMERALD_API void mesh_create_single_indexed_representation(mesh instance)
     ASSERT_DEBUG_SYNC(mesh_ptr->n_bo_unique_vertices == 0,
                       "Number of unique vertices must be 0");
 
-    /* Reset total number of elements */
+    /* Reset total number of elements. Levels of detail refer to the previous representation, so they are dropped. */
     mesh_ptr->bo_processed_data_total_elements = 0;
+    mesh_ptr->n_lods                           = 1;
 
     /* Iterate through layers */
-    system_bst datastreams_surfaceid_bst                      = nullptr;
-    uint32_t   n_datastreams_surfaceid_key_words              = 0;
-    uint32_t   n_different_layer_elements                     = 0;
-    bool       stream_usage[MESH_LAYER_DATA_STREAM_TYPE_COUNT];
+    _mesh_index_key_arg index_key_arg;
+    uint32_t*           layer_element_ends                = nullptr;
+    uint32_t            n_datastreams_surfaceid_key_words = 0;
+    uint32_t            n_different_layer_elements        = 0;
+    uint32_t            n_key_sets                        = 0;
+    bool                stream_usage[MESH_LAYER_DATA_STREAM_TYPE_COUNT];
 
     memset(stream_usage,
            0,
@@ -2058,31 +3270,58 @@ PUBLIC EMERALD_API void mesh_create_single_indexed_representation(mesh instance)
                                   "Invalid source used for storage of number of vertex data stream items.");
 
                 const uint32_t n_items = *stream_data_ptr->n_items_ptr;
+                const uint32_t n_chunks = (n_items + AABB_CALCULATION_GRAIN_SIZE - 1) / AABB_CALCULATION_GRAIN_SIZE;
 
-                for (unsigned int n_item = 0;
-                                  n_item < n_items;
-                                ++n_item)
+                if (n_chunks == 0)
                 {
-                    const float* vertex_data = reinterpret_cast<const float*>(stream_data_ptr->data) +
-                                               stream_data_ptr->n_components * n_item;
+                    continue;
+                }
+
+                /* Calculate partial AABBs for vertex chunks in parallel, then merge them. */
+                _mesh_aabb_calculation_arg aabb_calculation_arg;
+
+                aabb_calculation_arg.chunk_aabb_max  = new (std::nothrow) float[n_chunks * 3 /* x, y, z */];
+                aabb_calculation_arg.chunk_aabb_min  = new (std::nothrow) float[n_chunks * 3 /* x, y, z */];
+                aabb_calculation_arg.n_components    = stream_data_ptr->n_components;
+                aabb_calculation_arg.vertex_data_ptr = reinterpret_cast<const float*>(stream_data_ptr->data);
+
+                ASSERT_ALWAYS_SYNC(aabb_calculation_arg.chunk_aabb_max != nullptr &&
+                                   aabb_calculation_arg.chunk_aabb_min != nullptr,
+                                   "Out of memory");
+
+                system_thread_pool_parallel_for(0, /* range_start */
+                                                n_items,
+                                                AABB_CALCULATION_GRAIN_SIZE,
+                                                _mesh_calculate_aabb_for_range,
+                                               &aabb_calculation_arg);
 
+                for (uint32_t n_chunk = 0;
+                              n_chunk < n_chunks;
+                            ++n_chunk)
+                {
                     for (int n_dimension = 0;
                              n_dimension < 3; /* x, y, z */
                            ++n_dimension)
                     {
-                        if (n_item == 0 ||
-                            n_item != 0 && (layer_ptr->aabb_max[n_dimension] < vertex_data[n_dimension]))
+                        const float chunk_max = aabb_calculation_arg.chunk_aabb_max[n_chunk * 3 + n_dimension];
+                        const float chunk_min = aabb_calculation_arg.chunk_aabb_min[n_chunk * 3 + n_dimension];
+
+                        if (n_chunk == 0 ||
+                            layer_ptr->aabb_max[n_dimension] < chunk_max)
                         {
-                            layer_ptr->aabb_max[n_dimension] = vertex_data[n_dimension];
+                            layer_ptr->aabb_max[n_dimension] = chunk_max;
                         }
 
-                        if (n_item == 0 ||
-                            n_item != 0 && (layer_ptr->aabb_min[n_dimension] > vertex_data[n_dimension]))
+                        if (n_chunk == 0 ||
+                            layer_ptr->aabb_min[n_dimension] > chunk_min)
                         {
-                            layer_ptr->aabb_min[n_dimension] = vertex_data[n_dimension];
+                            layer_ptr->aabb_min[n_dimension] = chunk_min;
                         }
                     }
                 }
+
+                delete [] aabb_calculation_arg.chunk_aabb_max;
+                delete [] aabb_calculation_arg.chunk_aabb_min;
             }
             else
             {
@@ -2100,6 +3339,8 @@ PUBLIC EMERALD_API void mesh_create_single_indexed_representation(mesh instance)
      *
      * Vertices may also use different surface ids. This must also be taken into consideration.
      **/
+    index_key_arg.n_passes = 0;
+
     for (uint32_t n_layer = 0;
                   n_layer < n_layers;
                 ++n_layer)
@@ -2115,25 +3356,47 @@ PUBLIC EMERALD_API void mesh_create_single_indexed_representation(mesh instance)
 
         if (layer_ptr != nullptr)
         {
-            /* 1. Determine how many words BST key needs to consist of */
+            /* 1. Determine how many words index keys need to consist of */
+            uint32_t n_layer_passes   = 0;
             uint32_t n_pass_key_words = _mesh_get_total_number_of_sets(layer_ptr) + 1; /* Count in material representation */
 
             if (n_pass_key_words > n_datastreams_surfaceid_key_words)
             {
                 n_datastreams_surfaceid_key_words = n_pass_key_words;
             }
+
+            system_resizable_vector_get_property(layer_ptr->passes,
+                                                 SYSTEM_RESIZABLE_VECTOR_PROPERTY_N_ELEMENTS,
+                                                &n_layer_passes);
+
+            index_key_arg.n_passes += n_layer_passes;
+            n_key_sets             += n_pass_key_words - 1;
         }
     }
 
-    /* 2. Allocate space for a BST key */
-    uint32_t* key_ptr  = new (std::nothrow) uint32_t[2 /* unique set id + index */ * n_datastreams_surfaceid_key_words];
-    uint32_t  key_size = 2 /* unique set id + index */ * n_datastreams_surfaceid_key_words * sizeof(uint32_t);
-
-    ASSERT_ALWAYS_SYNC(key_ptr != nullptr,
+    /* 2. Allocate space for index key descriptors */
+    _mesh_index_key_pass* key_passes = new (std::nothrow) _mesh_index_key_pass[index_key_arg.n_passes + 1];
+
+    index_key_arg.element_hashes     = nullptr;
+    index_key_arg.element_vertices   = nullptr;
+    index_key_arg.key_set_index_data = new (std::nothrow) const uint32_t*[n_key_sets + 1];
+    index_key_arg.key_set_unique_ids = new (std::nothrow) uint32_t       [n_key_sets + 1];
+    index_key_arg.n_key_words        = 2 /* unique set id + index */ * n_datastreams_surfaceid_key_words;
+    index_key_arg.partition_elements = nullptr;
+    index_key_arg.passes             = key_passes;
+    layer_element_ends               = new (std::nothrow) uint32_t[n_layers + 1];
+
+    ASSERT_ALWAYS_SYNC(key_passes                       != nullptr &&
+                       index_key_arg.key_set_index_data != nullptr &&
+                       index_key_arg.key_set_unique_ids != nullptr &&
+                       layer_element_ends               != nullptr,
                        "Out of memory");
 
-    /* 3. Build BST. Also count total number of indices the mesh uses */
-    for (uint32_t n_layer = 0;
+    /* 3. Describe index keys of all passes. Also count total number of indices the mesh uses */
+    n_key_sets = 0;
+
+    for (uint32_t n_layer = 0,
+                  n_key_pass = 0;
                   n_layer < n_layers;
                 ++n_layer)
     {
@@ -2154,85 +3417,58 @@ PUBLIC EMERALD_API void mesh_create_single_indexed_representation(mesh instance)
                                                  SYSTEM_RESIZABLE_VECTOR_PROPERTY_N_ELEMENTS,
                                                 &n_passes);
 
+            /* TODO: There is a potential flaw in here, that separate layers will be indexed with
+             *       keys of different layouts. Say, one layer may feature 3 texcoord stream sets,
+             *       but another one will only use 1 texcoord stream set. This will cause the
+             *       keys to be zero-padded and will potentially create duplicate entries; no memory
+             *       overflow risk since we're already using a key of maximum size.
+             *       If necessary, please fix - putting a debug-only assertion check to guard against
+             *       the glitch.
+             *
+             * NOTE: This does not seem to cause any visual glitches, however mind that the final GL
+             *       blob will waste some space for attribute data that is present for one layer, but
+             *       not for the other one. This can probably be improved to a great extent, but requires
+             *       some refactoring.
+             */
+            if (n_passes                                   > 0 &&
+                (_mesh_get_total_number_of_sets(layer_ptr) + 1) != n_datastreams_surfaceid_key_words)
+            {
+                static bool has_warned = false;
+
+                if (!has_warned)
+                {
+                    LOG_ERROR("Key size mismatch while generating merged GL blob - generated blob will not be size-effective.");
+
+                    has_warned = true;
+                }
+            }
+
             for (uint32_t n_pass = 0;
                           n_pass < n_passes;
-                        ++n_pass)
+                        ++n_pass, ++n_key_pass)
             {
-                const _mesh_layer_pass* pass_ptr = nullptr;
+                _mesh_index_key_pass*   key_pass_ptr = key_passes + n_key_pass;
+                const _mesh_layer_pass* pass_ptr     = nullptr;
+
+                key_pass_ptr->first_element = mesh_ptr->bo_processed_data_total_elements;
+                key_pass_ptr->first_key_set = n_key_sets;
+                key_pass_ptr->material      = nullptr;
+                key_pass_ptr->n_elements    = 0;
+                key_pass_ptr->n_key_sets    = 0;
 
                 if (system_resizable_vector_get_element_at(layer_ptr->passes,
                                                            n_pass,
                                                           &pass_ptr) )
                 {
-                    for (uint32_t n_element = 0;
-                                  n_element < pass_ptr->n_elements;
-                                ++n_element)
-                    {
-                        /* Form the key.
-                         *
-                         * TODO: There is a potential flaw in here, that separate layers will be indexed with
-                         *       keys of different layouts. Say, one layer may feature 3 texcoord stream sets,
-                         *       but another one will only use 1 texcoord stream set. This will cause the
-                         *       BST to malfunction and will potentially create duplicate entries; no memory
-                         *       overflow risk since we're already using a key of maximum size.
-                         *       If necessary, please fix - putting a debug-only assertion check to guard against
-                         *       the glitch.
-                         *
-                         * NOTE: This does not seem to cause any visual glitches, however mind that the final GL
-                         *       blob will waste some space for attribute data that is present for one layer, but
-                         *       not for the other one. This can probably be improved to a great extent, but requires
-                         *       some refactoring.
-                         */
-                        if ((_mesh_get_total_number_of_sets(layer_ptr) + 1) != n_datastreams_surfaceid_key_words)
-                        {
-                            static bool has_warned = false;
-
-                            if (!has_warned)
-                            {
-                                LOG_ERROR("Key size mismatch while generating merged GL blob - generated blob will not be size-effective.");
-
-                                has_warned = true;
-                            }
-                        }
-
-                        memset(key_ptr,
-                               0,
-                               key_size);
-
-                        _mesh_get_index_key(key_ptr,
-                                            pass_ptr,
-                                            n_element);
-
-                        /* Insert the entry into the binary search tree */
-                        if (datastreams_surfaceid_bst == nullptr)
-                        {
-                            datastreams_surfaceid_bst = system_bst_create(key_size,
-                                                                          sizeof(uint32_t),
-                                                                          _mesh_is_key_uint32_lower,
-                                                                          _mesh_is_key_uint32_equal,
-                                                                          reinterpret_cast<system_bst_key>  (key_ptr),
-                                                                          reinterpret_cast<system_bst_value>(&n_different_layer_elements));
-
-                            n_different_layer_elements ++;
-                        }
-                        else
-                        {
-                            uint32_t temp = 0;
-
-                            if (!system_bst_get(datastreams_surfaceid_bst,
-                                                reinterpret_cast<system_bst_key>   (key_ptr),
-                                                reinterpret_cast<system_bst_value*>(&temp) ))
-                            {
-                                system_bst_insert(datastreams_surfaceid_bst,
-                                                  reinterpret_cast<system_bst_key>  (key_ptr),
-                                                  reinterpret_cast<system_bst_value>(&n_different_layer_elements));
-
-                                n_different_layer_elements ++;
-                            }
-                        }
-                    }
+                    key_pass_ptr->material   = pass_ptr->material;
+                    key_pass_ptr->n_elements = pass_ptr->n_elements;
+                    key_pass_ptr->n_key_sets = _mesh_get_index_key_sets(pass_ptr,
+                                                                        index_key_arg.key_set_index_data + n_key_sets,
+                                                                        index_key_arg.key_set_unique_ids + n_key_sets,
+                                                                        key_pass_ptr->key_set_offsets);
 
                     mesh_ptr->bo_processed_data_total_elements += pass_ptr->n_elements;
+                    n_key_sets                                 += key_pass_ptr->n_key_sets;
                 }
                 else
                 {
@@ -2242,8 +3478,6 @@ PUBLIC EMERALD_API void mesh_create_single_indexed_representation(mesh instance)
                 }
             }
 
-            layer_ptr->n_gl_unique_elements = n_different_layer_elements;
-
             /* Determine which data streams are used */
             for (unsigned int n_stream_data_type = MESH_LAYER_DATA_STREAM_TYPE_FIRST;
                               n_stream_data_type < MESH_LAYER_DATA_STREAM_TYPE_COUNT;
@@ -2256,12 +3490,115 @@ PUBLIC EMERALD_API void mesh_create_single_indexed_representation(mesh instance)
                 }
             }
         }
+
+        layer_element_ends[n_layer] = mesh_ptr->bo_processed_data_total_elements;
     }
 
-    ASSERT_DEBUG_SYNC(datastreams_surfaceid_bst != nullptr,
-                      "Data Stream + SurfaceID BST is not allowed to be nullptr at this point.");
+    /* 4. Look for unique index keys. The keys are hashed in parallel. Then, they are distributed over partitions
+     *    depending on their hashes. Each partition is then searched for duplicate keys by a separate thread. */
+    const uint32_t n_total_elements = mesh_ptr->bo_processed_data_total_elements;
+
+    ASSERT_DEBUG_SYNC(n_total_elements > 0,
+                      "No elements defined for the mesh.");
+
+    if (n_total_elements > 0)
+    {
+        uint32_t* partition_elements = new (std::nothrow) uint32_t[n_total_elements];
+
+        index_key_arg.element_hashes     = new (std::nothrow) uint32_t[n_total_elements];
+        index_key_arg.element_vertices   = new (std::nothrow) uint32_t[n_total_elements];
+        index_key_arg.partition_elements = partition_elements;
+
+        ASSERT_ALWAYS_SYNC(index_key_arg.element_hashes   != nullptr &&
+                           index_key_arg.element_vertices != nullptr &&
+                           partition_elements             != nullptr,
+                           "Out of memory");
+
+        /* Hash all the keys */
+        system_thread_pool_parallel_for(0, /* range_start */
+                                        n_total_elements,
+                                        INDEX_KEY_HASHING_GRAIN_SIZE,
+                                        _mesh_calculate_index_key_hashes,
+                                       &index_key_arg);
+
+        /* Distribute the elements over partitions, retaining their order */
+        memset(index_key_arg.partition_offsets,
+               0,
+               sizeof(index_key_arg.partition_offsets) );
+
+        for (uint32_t n_element = 0;
+                      n_element < n_total_elements;
+                    ++n_element)
+        {
+            ++index_key_arg.partition_offsets[(index_key_arg.element_hashes[n_element] >> (32 - INDEX_KEY_N_PARTITION_BITS)) + 1];
+        }
+
+        for (uint32_t n_partition = 0;
+                      n_partition < INDEX_KEY_N_PARTITIONS;
+                    ++n_partition)
+        {
+            index_key_arg.partition_offsets[n_partition + 1] += index_key_arg.partition_offsets[n_partition];
+        }
+
+        for (uint32_t n_element = 0;
+                      n_element < n_total_elements;
+                    ++n_element)
+        {
+            partition_elements[index_key_arg.partition_offsets[index_key_arg.element_hashes[n_element] >> (32 - INDEX_KEY_N_PARTITION_BITS)]++] = n_element;
+        }
+
+        for (uint32_t n_partition = INDEX_KEY_N_PARTITIONS;
+                      n_partition > 0;
+                    --n_partition)
+        {
+            index_key_arg.partition_offsets[n_partition] = index_key_arg.partition_offsets[n_partition - 1];
+        }
+
+        index_key_arg.partition_offsets[0] = 0;
+
+        /* Find elements which use the same keys */
+        system_thread_pool_parallel_for(0, /* range_start */
+                                        INDEX_KEY_N_PARTITIONS,
+                                        1, /* grain_size */
+                                        _mesh_merge_index_keys,
+                                       &index_key_arg);
+
+        delete [] index_key_arg.element_hashes;
+        delete [] partition_elements;
+
+        index_key_arg.element_hashes     = nullptr;
+        index_key_arg.partition_elements = nullptr;
+
+        /* Number the unique keys in the order of their first use. A key's first element always precedes the
+         * other elements using the key, so element_vertices can be converted to final indices in place. */
+        for (uint32_t n_layer = 0,
+                      n_element = 0;
+                      n_layer < n_layers;
+                    ++n_layer)
+        {
+            _mesh_layer* layer_ptr = nullptr;
+
+            for (;
+                 n_element < layer_element_ends[n_layer];
+               ++n_element)
+            {
+                const uint32_t first_element = index_key_arg.element_vertices[n_element];
+
+                index_key_arg.element_vertices[n_element] = (first_element == n_element) ? n_different_layer_elements++
+                                                                                         : index_key_arg.element_vertices[first_element];
+            }
+
+            if (system_resizable_vector_get_element_at(mesh_ptr->layers,
+                                                       n_layer,
+                                                      &layer_ptr) &&
+                layer_ptr != nullptr)
+            {
+                layer_ptr->n_gl_unique_elements = n_different_layer_elements;
+            }
+        }
+    }
 
-    if (datastreams_surfaceid_bst != nullptr)
+    if (n_total_elements > 0)
     {
         /* We now know how many entries we need in our index table. Let's allocate & fill it, as well as the data buffer. */
         uint32_t current_offset = 0;
@@ -2286,11 +3623,7 @@ PUBLIC EMERALD_API void mesh_create_single_indexed_representation(mesh instance)
             {
                 uint32_t                         n_sets                        = 0;
                 mesh_layer_data_stream_data_type stream_data_type              = MESH_LAYER_DATA_STREAM_DATA_TYPE_UNKNOWN;
-                unsigned int                     stream_n_components           = (n_data_stream_type == MESH_LAYER_DATA_STREAM_TYPE_TEXCOORDS)                ? 2
-                                                                               : (n_data_stream_type == MESH_LAYER_DATA_STREAM_TYPE_NORMALS                   ||
-                                                                                  n_data_stream_type == MESH_LAYER_DATA_STREAM_TYPE_SPHERICAL_HARMONIC_3BANDS ||
-                                                                                  n_data_stream_type == MESH_LAYER_DATA_STREAM_TYPE_VERTICES)                 ? 3
-                                                                               :                                                                                4;
+                unsigned int                     stream_n_components           = _mesh_get_processed_data_stream_n_components( (mesh_layer_data_stream_type) n_data_stream_type);
                 unsigned int                     stream_required_bit_alignment = 0;
 
                 _mesh_get_stream_data_properties(mesh_ptr,
@@ -2361,9 +3694,7 @@ PUBLIC EMERALD_API void mesh_create_single_indexed_representation(mesh instance)
         /* Allocate space for GL data */
         if (mesh_ptr->bo_processed_data != nullptr)
         {
-            delete [] mesh_ptr->bo_processed_data;
-
-            mesh_ptr->bo_processed_data = nullptr;
+            _mesh_release_bo_processed_data(mesh_ptr);
         }
 
         mesh_ptr->bo_processed_data = new (std::nothrow) float[mesh_ptr->bo_processed_data_size / sizeof(float)];
@@ -2377,7 +3708,8 @@ PUBLIC EMERALD_API void mesh_create_single_indexed_representation(mesh instance)
             void* elements_traveller_ptr = reinterpret_cast<uint32_t*>(reinterpret_cast<char*>(mesh_ptr->bo_processed_data) +
                                                                        (mesh_ptr->bo_processed_data_size - mesh_ptr->bo_processed_data_total_elements * index_size) );
 
-            for (uint32_t n_layer = 0;
+            for (uint32_t n_layer = 0,
+                          n_key_pass = 0;
                           n_layer < n_layers;
                         ++n_layer)
             {
@@ -2400,185 +3732,217 @@ PUBLIC EMERALD_API void mesh_create_single_indexed_representation(mesh instance)
 
                     for (uint32_t n_pass = 0;
                                   n_pass < n_passes;
-                                ++n_pass)
+                                ++n_pass, ++n_key_pass)
                     {
-                        uint32_t          max_index = -1;
-                        uint32_t          min_index = -1;
-                        _mesh_layer_pass* pass_ptr  = nullptr;
+                        const _mesh_index_key_pass* key_pass_ptr = key_passes + n_key_pass;
+                        uint32_t                    max_index    = -1;
+                        uint32_t                    min_index    = -1;
+                        _mesh_layer_pass*           pass_ptr     = nullptr;
 
                         if (system_resizable_vector_get_element_at(layer_ptr->passes,
                                                                    n_pass,
                                                                   &pass_ptr) &&
                             pass_ptr != nullptr)
                         {
-                            pass_ptr->bo_elements_offset = reinterpret_cast<char*>(elements_traveller_ptr)      -
-                                                           reinterpret_cast<char*>(mesh_ptr->bo_processed_data);
-
-                            for (uint32_t n_element = 0;
-                                          n_element < pass_ptr->n_elements;
-                                        ++n_element)
+                            /* Determine where the source data of each stream set comes from, so that no look-ups
+                             * need to be done for each element. */
+                            mesh_layer_data_stream_type actual_stream_types[MESH_LAYER_DATA_STREAM_TYPE_COUNT];
+                            _mesh_layer_data_stream*    data_stream_ptrs   [MESH_LAYER_DATA_STREAM_TYPE_COUNT];
+                            uint32_t                    n_pass_stream_sets            = 0;
+                            uint32_t                    stream_first_set_ids[MESH_LAYER_DATA_STREAM_TYPE_COUNT];
+                            uint32_t                    stream_n_sets       [MESH_LAYER_DATA_STREAM_TYPE_COUNT];
+                            const uint32_t**            stream_set_index_data         = nullptr;
+                            bool*                       stream_set_uses_element_index = nullptr;
+
+                            for (unsigned int n_data_stream_type = MESH_LAYER_DATA_STREAM_TYPE_FIRST;
+                                              n_data_stream_type < MESH_LAYER_DATA_STREAM_TYPE_COUNT;
+                                            ++n_data_stream_type)
                             {
-                                uint32_t final_index = 0;
-
-                                /* Form the key */
-                                memset(key_ptr,
-                                       0,
-                                       key_size);
+                                actual_stream_types [n_data_stream_type] = (mesh_layer_data_stream_type) n_data_stream_type;
+                                data_stream_ptrs    [n_data_stream_type] = nullptr;
+                                stream_first_set_ids[n_data_stream_type] = n_pass_stream_sets;
+                                stream_n_sets       [n_data_stream_type] = 0;
 
-                                _mesh_get_index_key(key_ptr,
-                                                    pass_ptr,
-                                                    n_element);
+                                system_hash64map_get(layer_ptr->data_streams,
+                                                     n_data_stream_type,
+                                                    &data_stream_ptrs[n_data_stream_type]);
 
-                                /* Find the final index */
-                                if (system_bst_get(datastreams_surfaceid_bst,
-                                                   reinterpret_cast<system_bst_key>   (key_ptr),
-                                                   reinterpret_cast<system_bst_value*>(&final_index)) )
+                                if (data_stream_ptrs[n_data_stream_type] != nullptr)
                                 {
-                                    /* Update max/min index values for the pass */
-                                    if (max_index == -1                            ||
-                                        max_index != -1 && max_index < final_index)
-                                    {
-                                        max_index = final_index;
-                                    }
+                                    ASSERT_DEBUG_SYNC(data_stream_ptrs[n_data_stream_type]->data_type == MESH_LAYER_DATA_STREAM_DATA_TYPE_FLOAT,
+                                                      "TODO");
 
-                                    if (min_index == -1                            ||
-                                        min_index != -1 && min_index > final_index)
+                                    _mesh_get_amount_of_stream_data_sets(mesh_ptr,
+                                                                         (mesh_layer_data_stream_type) n_data_stream_type,
+                                                                         n_layer,
+                                                                         n_pass,
+                                                                        &stream_n_sets[n_data_stream_type]);
+
+                                    if (stream_n_sets[n_data_stream_type] == 0)
                                     {
-                                        min_index = final_index;
+                                        actual_stream_types[n_data_stream_type] = MESH_LAYER_DATA_STREAM_TYPE_VERTICES;
+                                        stream_n_sets      [n_data_stream_type] = 1;
                                     }
 
-                                    /* Store the index */
-                                    switch (index_size)
-                                    {
-                                        case sizeof(unsigned char):
-                                        {
-                                            *reinterpret_cast<uint8_t*>(elements_traveller_ptr) = (unsigned char) final_index;
+                                    n_pass_stream_sets += stream_n_sets[n_data_stream_type];
+                                }
+                            }
 
-                                            (unsigned char*&) elements_traveller_ptr += sizeof(unsigned char);
+                            stream_set_index_data         = new (std::nothrow) const uint32_t*[n_pass_stream_sets + 1];
+                            stream_set_uses_element_index = new (std::nothrow) bool           [n_pass_stream_sets + 1];
 
-                                            break;
-                                        }
+                            ASSERT_ALWAYS_SYNC(stream_set_index_data         != nullptr &&
+                                               stream_set_uses_element_index != nullptr,
+                                               "Out of memory");
 
-                                        case sizeof(unsigned short):
-                                        {
-                                            *reinterpret_cast<uint16_t*>(elements_traveller_ptr) = (unsigned short) final_index;
+                            for (unsigned int n_data_stream_type = MESH_LAYER_DATA_STREAM_TYPE_FIRST;
+                                              n_data_stream_type < MESH_LAYER_DATA_STREAM_TYPE_COUNT;
+                                            ++n_data_stream_type)
+                            {
+                                const mesh_layer_data_stream_type actual_stream_type = actual_stream_types[n_data_stream_type];
 
-                                            (unsigned char*&) elements_traveller_ptr += sizeof(unsigned short);
+                                for (unsigned int n_set = 0;
+                                                  n_set < stream_n_sets[n_data_stream_type];
+                                                ++n_set)
+                                {
+                                    const uint32_t n_stream_set = stream_first_set_ids[n_data_stream_type] + n_set;
 
-                                            break;
-                                        }
+                                    stream_set_index_data        [n_stream_set] = nullptr;
+                                    stream_set_uses_element_index[n_stream_set] = false;
 
-                                        case sizeof(unsigned int):
-                                        {
-                                            *reinterpret_cast<uint32_t*>(elements_traveller_ptr) = final_index;
+                                    ASSERT_DEBUG_SYNC(pass_ptr->index_data_maps[actual_stream_type] != nullptr,
+                                                      "");
 
-                                            (unsigned char*&) elements_traveller_ptr += sizeof(unsigned int);
+                                    if (pass_ptr->index_data_maps[actual_stream_type] != nullptr)
+                                    {
+                                        _mesh_layer_pass_index_data* set_index_data_ptr = nullptr;
 
-                                            break;
+                                        if (!system_hash64map_get(pass_ptr->index_data_maps[actual_stream_type],
+                                                                  n_set,
+                                                                 &set_index_data_ptr) )
+                                        {
+                                            stream_set_uses_element_index[n_stream_set] = true;
                                         }
-
-                                        default:
+                                        else
                                         {
-                                            ASSERT_DEBUG_SYNC(false, "Unrecognized index size");
+                                            /* Use the same indices the key was formed from */
+                                            const uint32_t n_key_set = key_pass_ptr->key_set_offsets[actual_stream_type] + n_set;
+
+                                            ASSERT_DEBUG_SYNC(n_key_set < key_pass_ptr->n_key_sets,
+                                                              "Invalid request");
+
+                                            stream_set_index_data[n_stream_set] = index_key_arg.key_set_index_data[key_pass_ptr->first_key_set + n_key_set];
                                         }
                                     }
+                                }
+                            }
+
+                            pass_ptr->bo_elements_offset = reinterpret_cast<char*>(elements_traveller_ptr)      -
+                                                           reinterpret_cast<char*>(mesh_ptr->bo_processed_data);
+
+                            for (uint32_t n_element = 0;
+                                          n_element < pass_ptr->n_elements;
+                                        ++n_element)
+                            {
+                                const uint32_t final_index = index_key_arg.element_vertices[key_pass_ptr->first_element + n_element];
+
+                                /* Update max/min index values for the pass */
+                                if (max_index == -1                            ||
+                                    max_index != -1 && max_index < final_index)
+                                {
+                                    max_index = final_index;
+                                }
+
+                                if (min_index == -1                            ||
+                                    min_index != -1 && min_index > final_index)
+                                {
+                                    min_index = final_index;
+                                }
+
+                                /* Store the index */
+                                switch (index_size)
+                                {
+                                    case sizeof(unsigned char):
+                                    {
+                                        *reinterpret_cast<uint8_t*>(elements_traveller_ptr) = (unsigned char) final_index;
+
+                                        (unsigned char*&) elements_traveller_ptr += sizeof(unsigned char);
+
+                                        break;
+                                    }
 
-                                    /* Fill the attribute data buffer */
-                                    for (unsigned int n_data_stream_type = MESH_LAYER_DATA_STREAM_TYPE_FIRST;
-                                                      n_data_stream_type < MESH_LAYER_DATA_STREAM_TYPE_COUNT;
-                                                    ++n_data_stream_type)
+                                    case sizeof(unsigned short):
                                     {
-                                        _mesh_layer_data_stream* data_stream_ptr = nullptr;
+                                        *reinterpret_cast<uint16_t*>(elements_traveller_ptr) = (unsigned short) final_index;
 
-                                        system_hash64map_get(layer_ptr->data_streams,
-                                                             n_data_stream_type,
-                                                            &data_stream_ptr);
+                                        (unsigned char*&) elements_traveller_ptr += sizeof(unsigned short);
 
-                                        if (data_stream_ptr != nullptr)
-                                        {
-                                            ASSERT_DEBUG_SYNC(data_stream_ptr->data_type == MESH_LAYER_DATA_STREAM_DATA_TYPE_FLOAT,
-                                                              "TODO");
-
-                                            mesh_layer_data_stream_type actual_stream_type  = (mesh_layer_data_stream_type) n_data_stream_type;
-                                            unsigned int                stream_n_components = (n_data_stream_type == MESH_LAYER_DATA_STREAM_TYPE_TEXCOORDS)                ? 2
-                                                                                            : (n_data_stream_type == MESH_LAYER_DATA_STREAM_TYPE_NORMALS                   ||
-                                                                                               n_data_stream_type == MESH_LAYER_DATA_STREAM_TYPE_SPHERICAL_HARMONIC_3BANDS ||
-                                                                                               n_data_stream_type == MESH_LAYER_DATA_STREAM_TYPE_VERTICES)                 ? 3
-                                                                                            :                                                                                4;
-                                            uint32_t                    stream_n_sets       = 0;
-
-                                            _mesh_get_amount_of_stream_data_sets(mesh_ptr,
-                                                                                 (mesh_layer_data_stream_type) n_data_stream_type,
-                                                                                 n_layer,
-                                                                                 n_pass,
-                                                                                &stream_n_sets);
-
-                                            if (stream_n_sets == 0)
-                                            {
-                                                actual_stream_type = MESH_LAYER_DATA_STREAM_TYPE_VERTICES;
-                                                stream_n_sets      = 1;
-                                            }
-
-                                            for (unsigned int n_set = 0;
-                                                              n_set < stream_n_sets;
-                                                            ++n_set)
-                                            {
-                                                unsigned int pass_index_data = 0;
-
-                                                ASSERT_DEBUG_SYNC(pass_ptr->index_data_maps[actual_stream_type] != nullptr,
-                                                                  "");
-
-                                                if (pass_ptr->index_data_maps[actual_stream_type] != nullptr)
-                                                {
-                                                    _mesh_layer_pass_index_data* set_index_data_ptr = nullptr;
-
-                                                    if (!system_hash64map_get(pass_ptr->index_data_maps[actual_stream_type],
-                                                                              n_set,
-                                                                             &set_index_data_ptr) )
-                                                    {
-                                                        pass_index_data = n_element;
-                                                    }
-                                                    else
-                                                    {
-                                                        pass_index_data = _mesh_get_source_index_from_index_key(key_ptr,
-                                                                                                                pass_ptr,
-                                                                                                                (mesh_layer_data_stream_type) actual_stream_type,
-                                                                                                                n_set);
-                                                    }
-                                                }
-
-                                                /* We can finally do a memcpy()! */
-                                                const uint32_t n_bytes_for_element_data = n_different_layer_elements *
-                                                                                          stream_n_components;
-                                                const uint32_t n_bytes_to_copy          = sizeof(float) * data_stream_ptr->n_components;
-                                                const uint32_t dst_offset               = mesh_ptr->bo_processed_data_stream_start_offset[n_data_stream_type] + /* move to location where the unique data starts for given stream type */
-                                                                                          mesh_ptr->bo_processed_data_stride * n_set * pass_ptr->n_elements   + /* move to current set */
-                                                                                          mesh_ptr->bo_processed_data_stride * final_index;                     /* identify processed index */
-                                                const uint32_t src_offset_div_4         = data_stream_ptr->n_components                                       *
-                                                                                          pass_index_data;
-
-                                                ASSERT_DEBUG_SYNC(data_stream_ptr->n_items_ptr != nullptr,
-                                                                  "Number of data stream items could not be determined.");
-                                                ASSERT_DEBUG_SYNC(pass_index_data < *data_stream_ptr->n_items_ptr,
-                                                                  "Invalid index about to be used");
-
-                                                memcpy(reinterpret_cast<char*> (mesh_ptr->bo_processed_data) + dst_offset,
-                                                       reinterpret_cast<float*>(data_stream_ptr->data)       + src_offset_div_4,
-                                                       n_bytes_to_copy);
-
-                                                ASSERT_DEBUG_SYNC(dst_offset + n_bytes_to_copy < mesh_ptr->bo_processed_data_size,
-                                                                  "Data buffer overflow!");
-                                            }
-                                        }
+                                        break;
+                                    }
+
+                                    case sizeof(unsigned int):
+                                    {
+                                        *reinterpret_cast<uint32_t*>(elements_traveller_ptr) = final_index;
+
+                                        (unsigned char*&) elements_traveller_ptr += sizeof(unsigned int);
+
+                                        break;
+                                    }
+
+                                    default:
+                                    {
+                                        ASSERT_DEBUG_SYNC(false, "Unrecognized index size");
                                     }
                                 }
-                                else
+
+                                /* Fill the attribute data buffer */
+                                for (unsigned int n_data_stream_type = MESH_LAYER_DATA_STREAM_TYPE_FIRST;
+                                                  n_data_stream_type < MESH_LAYER_DATA_STREAM_TYPE_COUNT;
+                                                ++n_data_stream_type)
                                 {
-                                    ASSERT_ALWAYS_SYNC(false,
-                                                       "Could not retrieve final GL buffer index key");
+                                    const _mesh_layer_data_stream* data_stream_ptr = data_stream_ptrs[n_data_stream_type];
+
+                                    if (data_stream_ptr == nullptr)
+                                    {
+                                        continue;
+                                    }
+
+                                    for (unsigned int n_set = 0;
+                                                      n_set < stream_n_sets[n_data_stream_type];
+                                                    ++n_set)
+                                    {
+                                        const uint32_t  n_stream_set       = stream_first_set_ids[n_data_stream_type] + n_set;
+                                        const uint32_t* set_index_data_ptr = stream_set_index_data[n_stream_set];
+                                        const uint32_t  pass_index_data    = (stream_set_uses_element_index[n_stream_set]) ? n_element
+                                                                           : (set_index_data_ptr != nullptr)               ? set_index_data_ptr[n_element]
+                                                                           :                                                 0;
+
+                                        /* We can finally do a memcpy()! */
+                                        const uint32_t  n_bytes_to_copy    = sizeof(float) * data_stream_ptr->n_components;
+                                        const uint32_t  dst_offset         = mesh_ptr->bo_processed_data_stream_start_offset[n_data_stream_type] + /* move to location where the unique data starts for given stream type */
+                                                                             mesh_ptr->bo_processed_data_stride * n_set * pass_ptr->n_elements   + /* move to current set */
+                                                                             mesh_ptr->bo_processed_data_stride * final_index;                     /* identify processed index */
+                                        const uint32_t  src_offset_div_4   = data_stream_ptr->n_components                                       *
+                                                                             pass_index_data;
+
+                                        ASSERT_DEBUG_SYNC(data_stream_ptr->n_items_ptr != nullptr,
+                                                          "Number of data stream items could not be determined.");
+                                        ASSERT_DEBUG_SYNC(pass_index_data < *data_stream_ptr->n_items_ptr,
+                                                          "Invalid index about to be used");
+
+                                        memcpy(reinterpret_cast<char*> (mesh_ptr->bo_processed_data) + dst_offset,
+                                               reinterpret_cast<float*>(data_stream_ptr->data)       + src_offset_div_4,
+                                               n_bytes_to_copy);
+
+                                        ASSERT_DEBUG_SYNC(dst_offset + n_bytes_to_copy < mesh_ptr->bo_processed_data_size,
+                                                          "Data buffer overflow!");
+                                    }
                                 }
                             }
 
+                            delete [] stream_set_index_data;
+                            delete [] stream_set_uses_element_index;
+
                             /* Store max/min values for the pass */
                             pass_ptr->bo_elements_max_index = max_index;
                             pass_ptr->bo_elements_min_index = min_index;
@@ -2618,15 +3982,12 @@ PUBLIC EMERALD_API void mesh_create_single_indexed_representation(mesh instance)
         mesh_ptr->n_bo_unique_vertices = n_different_layer_elements;
     }
 
-    /* We're done ! Release the helper BST instance */
-    system_bst_release(datastreams_surfaceid_bst);
-
-    /* Release key storage */
-    if (key_ptr != nullptr)
-    {
-        delete [] key_ptr;
-        key_ptr = nullptr;
-    }
+    /* We're done ! Release the index key storage */
+    delete [] index_key_arg.element_vertices;
+    delete [] index_key_arg.key_set_index_data;
+    delete [] index_key_arg.key_set_unique_ids;
+    delete [] key_passes;
+    delete [] layer_element_ends;
 
     /* If saving support is not required, we can deallocate all the data buffers at this point! */
     if (!((mesh_ptr->creation_flags & MESH_CREATION_FLAGS_SAVE_SUPPORT) ))
@@ -2764,9 +4125,7 @@ PUBLIC EMERALD_API void mesh_free_single_indexed_representation(mesh instance)
 
     if (mesh_ptr->bo_processed_data != nullptr)
     {
-        delete [] mesh_ptr->bo_processed_data;
-
-        mesh_ptr->bo_processed_data = nullptr;
+        _mesh_release_bo_processed_data(mesh_ptr);
     }
 
     for (uint32_t n_layer = 0;
@@ -2827,327 +4186,369 @@ PUBLIC EMERALD_API void mesh_free_single_indexed_representation(mesh instance)
 }
 
 /* Please see header for specification */
-PUBLIC EMERALD_API void mesh_generate_normal_data(mesh mesh)
+PUBLIC EMERALD_API bool mesh_generate_lods(mesh         instance,
+                                           uint32_t     n_levels,
+                                           const float* target_ratios)
 {
-    /* TODO: Should we move this to mesh_normal_data_generation.cc or sth? */
-    system_resizable_vector allocated_polygon_vectors  = system_resizable_vector_create(4);
-    system_resource_pool    mesh_polygon_resource_pool = system_resource_pool_create   (sizeof(_mesh_polygon),
-                                                                                        4,        /* n_elements_to_preallocate */
-                                                                                        nullptr,  /* init_fn                   */
-                                                                                        nullptr); /* deinit_fn                 */
-    _mesh*                  mesh_ptr                   = reinterpret_cast<_mesh*>(mesh);
-    unsigned int            n_layers                   = 0;
-    system_resource_pool    vec3_resource_pool         = system_resource_pool_create   (sizeof(float) * 3,
-                                                                                        4,        /* n_elements_to_preallocate */
-                                                                                        nullptr,  /* init_fn                   */
-                                                                                        nullptr); /* deinit_fn                 */
+    uint32_t                 index_size         = 0;
+    _mesh_lod_generation_arg lod_generation_arg;
+    _mesh*                   mesh_ptr           = reinterpret_cast<_mesh*>(instance);
+    uint32_t                 n_layers           = 0;
+    uint32_t                 n_lod_indices      = 0;
+    uint32_t                 n_passes           = 0;
+    uint32_t                 n_total_indices    = 0;
+    float*                   new_processed_data = nullptr;
+    uint32_t                 new_processed_data_size;
+    uint32_t*                pass_index_offsets = nullptr;
+    const _mesh_layer_pass** pass_ptrs          = nullptr;
+    bool                     result             = false;
+
+    memset(&lod_generation_arg,
+           0,
+           sizeof(lod_generation_arg) );
 
-    ASSERT_DEBUG_SYNC(mesh_ptr->type == MESH_TYPE_REGULAR,
-                      "Entry-point is only compatible with regular meshes only.");
+    if (mesh_ptr->type != MESH_TYPE_REGULAR)
+    {
+        ASSERT_DEBUG_SYNC(false,
+                          "mesh_generate_lods() can only be called against regular meshes.");
 
-    system_resizable_vector_get_property(mesh_ptr->layers,
-                                         SYSTEM_RESIZABLE_VECTOR_PROPERTY_N_ELEMENTS,
-                                        &n_layers);
+        goto end;
+    }
 
-    /* Determine which vertices are used by which polygons and store that
-     * information in a BST,
-     *
-     * Key is a float[3], which corresponds to X, Y, Z location of the vertex.
-     * Epsilon of 1e-5 is assumed.
-     *
-     * Value is a system_resizable_vector, storing _mesh_polygon* entries.
-     **/
-    system_bst vertex_to_polygon_vector_bst = nullptr;
+    if (mesh_ptr->instantiation_parent != nullptr)
+    {
+        ASSERT_DEBUG_SYNC(false,
+                          "mesh_generate_lods() cannot be called against instantiated meshes.");
 
-    for (unsigned int n_iteration = 0;
-                      n_iteration < 2; /* 1. vertex-to-polygon BST construction.
-                                          2. per-polygon normal calculation */
-                    ++n_iteration)
+        goto end;
+    }
+
+    if (mesh_ptr->bo_processed_data            == nullptr ||
+        mesh_ptr->bo_processed_data_serializer != nullptr ||
+        mesh_ptr->bo                           != nullptr)
     {
-        LOG_INFO("Generating normal data for mesh [%s] (iteration %u/3) ...",
-                 system_hashed_ansi_string_get_buffer(mesh_ptr->name),
-                 n_iteration + 1);
+        ASSERT_DEBUG_SYNC(false,
+                          "mesh_generate_lods() must be called after mesh_create_single_indexed_representation() and before mesh_fill_ral_buffers().");
 
-        for (unsigned int n_layer = 0;
-                          n_layer < n_layers;
-                        ++n_layer)
-        {
-            /* Retrieve raw vertex data */
-            _mesh_layer*             layer_ptr              = nullptr;
-            unsigned int             n_layer_passes         = 0;
-            _mesh_layer_data_stream* vertex_data_stream_ptr = nullptr;
-            const float*             vertex_data_ptr        = nullptr;
+        goto end;
+    }
 
-            if (!system_resizable_vector_get_element_at(mesh_ptr->layers,
-                                                        n_layer,
-                                                       &layer_ptr) )
-            {
-                ASSERT_DEBUG_SYNC(false,
-                                  "Layer descriptor unavailable");
+    if (mesh_ptr->n_lods > 1)
+    {
+        ASSERT_DEBUG_SYNC(false,
+                          "Levels of detail have already been generated for the mesh.");
 
-                continue;
-            }
+        goto end;
+    }
 
-            system_resizable_vector_get_property(layer_ptr->passes,
-                                                 SYSTEM_RESIZABLE_VECTOR_PROPERTY_N_ELEMENTS,
-                                                &n_layer_passes);
+    if (n_levels == 0              ||
+        n_levels >= MESH_MAX_LODS)
+    {
+        ASSERT_DEBUG_SYNC(false,
+                          "Invalid number of levels of detail requested.");
 
-            if (system_hash64map_contains(layer_ptr->data_streams,
-                                          MESH_LAYER_DATA_STREAM_TYPE_NORMALS) )
-            {
-                /* Normal data defined for this layer, move on */
-                continue;
-            }
+        goto end;
+    }
 
-            if (!system_hash64map_get(layer_ptr->data_streams,
-                                      MESH_LAYER_DATA_STREAM_TYPE_VERTICES,
-                                     &vertex_data_stream_ptr) )
-            {
-                ASSERT_DEBUG_SYNC(false,
-                                  "Could not retrieve vertex data stream for mesh layer [%d]",
-                                  n_layer);
+    for (uint32_t n_level = 0;
+                  n_level < n_levels;
+                ++n_level)
+    {
+        if ( target_ratios[n_level] <= 0.0f                                          ||
+             target_ratios[n_level] >= 1.0f                                          ||
+            (n_level > 0 && target_ratios[n_level] >= target_ratios[n_level - 1]) )
+        {
+            ASSERT_DEBUG_SYNC(false,
+                              "Target ratios must lie in (0, 1) and decrease with each level.");
 
-                continue;
-            }
+            goto end;
+        }
+    }
 
-            vertex_data_ptr = reinterpret_cast<const float*>(vertex_data_stream_ptr->data);
+    if (mesh_ptr->bo_processed_data_stream_start_offset[MESH_LAYER_DATA_STREAM_TYPE_VERTICES] == -1)
+    {
+        LOG_ERROR("Mesh [%s] defines no vertex data. Levels of detail will not be generated.",
+                  system_hashed_ansi_string_get_buffer(mesh_ptr->name) );
 
-            /* Iterate over all layer passes */
-            for (unsigned int n_layer_pass = 0;
-                              n_layer_pass < n_layer_passes;
-                            ++n_layer_pass)
-            {
-                _mesh_layer_pass* layer_pass_ptr = nullptr;
-                unsigned int      n_indices      = 0;
+        goto end;
+    }
 
-                if (!system_resizable_vector_get_element_at(layer_ptr->passes,
-                                                            n_layer_pass,
-                                                           &layer_pass_ptr) )
-                {
-                    ASSERT_DEBUG_SYNC(false,
-                                      "Could not retrieve layer pass descriptor for mesh layer [%d]",
-                                      n_layer);
+    index_size = _mesh_get_index_size(mesh_ptr->bo_index_type);
 
-                    continue;
-                }
+    if (index_size == 0)
+    {
+        ASSERT_DEBUG_SYNC(false,
+                          "Unrecognized index type");
 
-                n_indices = layer_pass_ptr->n_elements;
+        goto end;
+    }
 
-                /* Run iteration-specific code */
-                switch (n_iteration)
-                {
-                    case 0:
-                    {
-                        /* Vertex-to-polygon BST construction.
-                         *
-                         * NOTE: If there is no index data available, assume the vertices are defined in order.
-                         **/
-                        bool                         index_data_available = (layer_pass_ptr->index_data_maps[MESH_LAYER_DATA_STREAM_TYPE_VERTICES] != nullptr);
-                        _mesh_layer_pass_index_data* index_data_ptr       = nullptr;
-
-                        if (index_data_available)
-                        {
-                            /* n_vertex_data_sets == 0: no index data available.
-                             *                    == 1:    index data available.
-                             */
-                            uint32_t n_vertex_data_sets = 0;
+    /* Gather all layer passes */
+    system_resizable_vector_get_property(mesh_ptr->layers,
+                                         SYSTEM_RESIZABLE_VECTOR_PROPERTY_N_ELEMENTS,
+                                        &n_layers);
 
-                            system_hash64map_get_property(layer_pass_ptr->index_data_maps[MESH_LAYER_DATA_STREAM_TYPE_VERTICES],
-                                                          SYSTEM_HASH64MAP_PROPERTY_N_ELEMENTS,
-                                                         &n_vertex_data_sets);
+    for (uint32_t n_layer = 0;
+                  n_layer < n_layers;
+                ++n_layer)
+    {
+        _mesh_layer* layer_ptr      = nullptr;
+        uint32_t     n_layer_passes = 0;
 
-                            if (n_vertex_data_sets > 1)
-                            {
-                                ASSERT_DEBUG_SYNC(n_vertex_data_sets <= 1,
-                                                  "Unsupported number of vertex data sets");
+        if (system_resizable_vector_get_element_at(mesh_ptr->layers,
+                                                   n_layer,
+                                                  &layer_ptr) )
+        {
+            system_resizable_vector_get_property(layer_ptr->passes,
+                                                 SYSTEM_RESIZABLE_VECTOR_PROPERTY_N_ELEMENTS,
+                                                &n_layer_passes);
 
-                                continue;
-                            }
+            n_passes += n_layer_passes;
+        }
+    }
 
-                            if (n_vertex_data_sets == 1)
-                            {
-                                system_hash64map_get_element_at(layer_pass_ptr->index_data_maps[MESH_LAYER_DATA_STREAM_TYPE_VERTICES],
-                                                                0,     /* set id */
-                                                                &index_data_ptr,
-                                                                nullptr); /* pOutHash */
-                            }
-                            else
-                            {
-                                index_data_available = false;
-                            }
-                        }
+    pass_index_offsets = new (std::nothrow) uint32_t               [n_passes + 1];
+    pass_ptrs          = new (std::nothrow) const _mesh_layer_pass*[n_passes];
 
-                        for (unsigned int n_index = 0;
-                                          n_index < n_indices;
-                                          n_index += 3)
-                        {
-                            /* For each triangle polygon, create a _mesh_polygon instance */
-                            const uint32_t vertex_indices[] =
-                            {
-                                index_data_ptr != nullptr ? (index_data_ptr->data[n_index + 0]) : (n_index),
-                                index_data_ptr != nullptr ? (index_data_ptr->data[n_index + 1]) : (n_index + 1),
-                                index_data_ptr != nullptr ? (index_data_ptr->data[n_index + 2]) : (n_index + 2)
-                            };
-                            const float* vertex_data[] =
-                            {
-                                vertex_data_ptr + 3 /* components */ * vertex_indices[0],
-                                vertex_data_ptr + 3 /* components */ * vertex_indices[1],
-                                vertex_data_ptr + 3 /* components */ * vertex_indices[2]
-                            };
+    ASSERT_ALWAYS_SYNC(pass_index_offsets != nullptr &&
+                       pass_ptrs          != nullptr,
+                       "Out of memory");
 
-                            _mesh_polygon* new_polygon_ptr = reinterpret_cast<_mesh_polygon*>(system_resource_pool_get_from_pool(mesh_polygon_resource_pool));
+    for (uint32_t n_layer = 0,
+                  n_pass  = 0;
+                  n_layer < n_layers;
+                ++n_layer)
+    {
+        _mesh_layer* layer_ptr      = nullptr;
+        uint32_t     n_layer_passes = 0;
 
-                            new_polygon_ptr->layer_ptr         = layer_ptr;
-                            new_polygon_ptr->layer_pass_ptr    = layer_pass_ptr;
-                            new_polygon_ptr->n_mesh_layer      = n_layer;
-                            new_polygon_ptr->n_mesh_layer_pass = n_layer_pass;
-                            new_polygon_ptr->triangle_index    = n_index / 3;
+        system_resizable_vector_get_element_at(mesh_ptr->layers,
+                                               n_layer,
+                                              &layer_ptr);
+        system_resizable_vector_get_property  (layer_ptr->passes,
+                                               SYSTEM_RESIZABLE_VECTOR_PROPERTY_N_ELEMENTS,
+                                              &n_layer_passes);
 
-                            memcpy(new_polygon_ptr->vertex_data,
-                                   vertex_data,
-                                   sizeof(vertex_data) );
+        for (uint32_t n_layer_pass = 0;
+                      n_layer_pass < n_layer_passes;
+                    ++n_layer_pass, ++n_pass)
+        {
+            _mesh_layer_pass* pass_ptr = nullptr;
 
-                            /* Assign the descriptor to each vertex */
-                            unsigned int start_vertex_index = 0;
+            system_resizable_vector_get_element_at(layer_ptr->passes,
+                                                   n_layer_pass,
+                                                  &pass_ptr);
 
-                            if (vertex_to_polygon_vector_bst == nullptr)
-                            {
-                                system_resizable_vector new_vector = system_resizable_vector_create(4 /* capacity */);
+            if ((pass_ptr->n_elements % 3) != 0)
+            {
+                LOG_ERROR("Mesh [%s] defines a layer pass which is not a triangle list. Levels of detail will not be generated.",
+                          system_hashed_ansi_string_get_buffer(mesh_ptr->name) );
 
-                                system_resizable_vector_push(allocated_polygon_vectors,
-                                                             new_vector);
-                                system_resizable_vector_push(new_vector,
-                                                             new_polygon_ptr);
+                goto end;
+            }
 
-                                vertex_to_polygon_vector_bst = system_bst_create(sizeof(float)    * 3,            /* key size */
-                                                                                 sizeof(system_resizable_vector), /* value size */
-                                                                                 _mesh_is_key_float_lower,
-                                                                                 _mesh_is_key_float_equal,
-                                                                                 (const system_bst_key)            (vertex_data[0]),
-                                                                                 reinterpret_cast<system_bst_value>(&new_vector));
+            pass_index_offsets[n_pass] = n_total_indices;
+            pass_ptrs         [n_pass] = pass_ptr;
+            n_total_indices           += pass_ptr->n_elements;
+        }
+    }
 
-                                start_vertex_index = 1;
-                            }
+    pass_index_offsets[n_passes] = n_total_indices;
+
+    /* Convert the index data to a common format, relative to the first vertex used by each pass */
+    lod_generation_arg.index_data         = new (std::nothrow) uint32_t[n_total_indices];
+    lod_generation_arg.lod_errors         = new (std::nothrow) float   [n_passes * n_levels];
+    lod_generation_arg.lod_index_data     = new (std::nothrow) uint32_t[n_total_indices * n_levels];
+    lod_generation_arg.lod_n_indices      = new (std::nothrow) uint32_t[n_passes * n_levels];
+    lod_generation_arg.n_levels           = n_levels;
+    lod_generation_arg.pass_index_offsets = pass_index_offsets;
+    lod_generation_arg.pass_ptrs          = pass_ptrs;
+    lod_generation_arg.target_ratios      = target_ratios;
+    lod_generation_arg.vertex_data_ptr    = reinterpret_cast<const float*>(reinterpret_cast<const char*>(mesh_ptr->bo_processed_data) + mesh_ptr->bo_processed_data_stream_start_offset[MESH_LAYER_DATA_STREAM_TYPE_VERTICES]);
+    lod_generation_arg.vertex_stride      = mesh_ptr->bo_processed_data_stride;
+
+    ASSERT_ALWAYS_SYNC(lod_generation_arg.index_data     != nullptr &&
+                       lod_generation_arg.lod_errors     != nullptr &&
+                       lod_generation_arg.lod_index_data != nullptr &&
+                       lod_generation_arg.lod_n_indices  != nullptr,
+                       "Out of memory");
 
-                            for (unsigned int n_vertex_index = start_vertex_index;
-                                              n_vertex_index < 3;
-                                            ++n_vertex_index)
-                            {
-                                system_resizable_vector polygon_vector = nullptr;
+    for (uint32_t n_pass = 0;
+                  n_pass < n_passes;
+                ++n_pass)
+    {
+        const _mesh_layer_pass* pass_ptr       = pass_ptrs[n_pass];
+        const char*             pass_index_ptr = reinterpret_cast<const char*>(mesh_ptr->bo_processed_data) + pass_ptr->bo_elements_offset;
+        uint32_t*               result_ptr     = const_cast<uint32_t*>(lod_generation_arg.index_data) + pass_index_offsets[n_pass];
 
-                                if (!system_bst_get(vertex_to_polygon_vector_bst,
-                                                    (const system_bst_key)             (vertex_data[n_vertex_index]),
-                                                    reinterpret_cast<system_bst_value*>(&polygon_vector)))
-                                {
-                                    polygon_vector = system_resizable_vector_create(4 /* capacity */);
+        for (uint32_t n_element = 0;
+                      n_element < pass_ptr->n_elements;
+                    ++n_element)
+        {
+            result_ptr[n_element] = ((index_size == sizeof(unsigned char))  ? reinterpret_cast<const uint8_t*> (pass_index_ptr)[n_element]
+                                   : (index_size == sizeof(unsigned short)) ? reinterpret_cast<const uint16_t*>(pass_index_ptr)[n_element]
+                                   :                                          reinterpret_cast<const uint32_t*>(pass_index_ptr)[n_element]) - pass_ptr->bo_elements_min_index;
+        }
+    }
+
+    /* Simplify all passes */
+    system_thread_pool_parallel_for(0, /* range_start */
+                                    n_passes,
+                                    1, /* grain_size */
+                                    _mesh_generate_layer_pass_lods,
+                                   &lod_generation_arg);
+
+    /* Append LOD index data to the processed data buffer. Index values never exceed the number of unique
+     * vertices, so the index type in use can hold them. */
+    for (uint32_t n_lod_range = 0;
+                  n_lod_range < n_passes * n_levels;
+                ++n_lod_range)
+    {
+        n_lod_indices += lod_generation_arg.lod_n_indices[n_lod_range];
+    }
 
-                                    system_resizable_vector_push(allocated_polygon_vectors,
-                                                                 polygon_vector);
+    new_processed_data_size = mesh_ptr->bo_processed_data_size + n_lod_indices * index_size;
+    new_processed_data      = new (std::nothrow) float[(new_processed_data_size + sizeof(float) - 1) / sizeof(float)];
 
-                                    system_bst_insert(vertex_to_polygon_vector_bst,
-                                                      (system_bst_key)   vertex_data[n_vertex_index],
-                                                      (system_bst_value) &polygon_vector);
-                                }
+    ASSERT_ALWAYS_SYNC(new_processed_data != nullptr,
+                       "Out of memory");
 
-                                system_resizable_vector_push(polygon_vector,
-                                                             new_polygon_ptr);
-                            }
-                        }
+    memcpy(new_processed_data,
+           mesh_ptr->bo_processed_data,
+           mesh_ptr->bo_processed_data_size);
 
-                        break;
-                    }
+    for (uint32_t n_pass            = 0,
+                  n_lod_data_offset = mesh_ptr->bo_processed_data_size;
+                  n_pass            < n_passes;
+                ++n_pass)
+    {
+        _mesh_layer_pass* pass_ptr  = const_cast<_mesh_layer_pass*>(pass_ptrs[n_pass]);
+        const uint32_t    n_indices = pass_index_offsets[n_pass + 1] - pass_index_offsets[n_pass];
 
-                    case 1:
-                    {
-                        /* Per-polygon normal calculation */
-                        uint32_t n_polygon_vectors = 0;
+        for (uint32_t n_level = 0;
+                      n_level < n_levels;
+                    ++n_level)
+        {
+            _mesh_layer_pass_lod* lod_ptr       = pass_ptr->lods + n_level;
+            char*                 lod_index_ptr = reinterpret_cast<char*>(new_processed_data) + n_lod_data_offset;
+            const uint32_t*       src_ptr       = lod_generation_arg.lod_index_data + n_levels * pass_index_offsets[n_pass] + n_level * n_indices;
+
+            lod_ptr->bo_elements_offset    = n_lod_data_offset;
+            lod_ptr->bo_elements_max_index = -1;
+            lod_ptr->bo_elements_min_index = -1;
+            lod_ptr->n_elements            = lod_generation_arg.lod_n_indices[n_levels * n_pass + n_level];
+
+            for (uint32_t n_element = 0;
+                          n_element < lod_ptr->n_elements;
+                        ++n_element)
+            {
+                const uint32_t index = src_ptr[n_element] + pass_ptr->bo_elements_min_index;
 
-                        system_resizable_vector_get_property(allocated_polygon_vectors,
-                                                             SYSTEM_RESIZABLE_VECTOR_PROPERTY_N_ELEMENTS,
-                                                            &n_polygon_vectors);
+                switch (index_size)
+                {
+                    case sizeof(unsigned char):  reinterpret_cast<uint8_t*> (lod_index_ptr)[n_element] = static_cast<uint8_t> (index); break;
+                    case sizeof(unsigned short): reinterpret_cast<uint16_t*>(lod_index_ptr)[n_element] = static_cast<uint16_t>(index); break;
+                    case sizeof(unsigned int):   reinterpret_cast<uint32_t*>(lod_index_ptr)[n_element] = index;                         break;
+                }
 
-                        ASSERT_DEBUG_SYNC(n_polygon_vectors != 0,
-                                          "No polygon vectors found for mesh");
+                if (lod_ptr->bo_elements_max_index == -1    ||
+                    lod_ptr->bo_elements_max_index <  index)
+                {
+                    lod_ptr->bo_elements_max_index = index;
+                }
 
-                        for (uint32_t n_polygon_vector = 0;
-                                      n_polygon_vector < n_polygon_vectors;
-                                    ++n_polygon_vector)
-                        {
-                            uint32_t                n_polygon_vector_items = 0;
-                            system_resizable_vector polygon_vector         = nullptr;
+                if (lod_ptr->bo_elements_min_index == -1    ||
+                    lod_ptr->bo_elements_min_index >  index)
+                {
+                    lod_ptr->bo_elements_min_index = index;
+                }
+            }
 
-                            if (!system_resizable_vector_get_element_at(allocated_polygon_vectors,
-                                                                        n_polygon_vector,
-                                                                       &polygon_vector) )
-                            {
-                                ASSERT_DEBUG_SYNC(false,
-                                                  "Could not retrieve polygon vector descriptor");
+            n_lod_data_offset += lod_ptr->n_elements * index_size;
 
-                                continue;
-                            }
+            /* A level of detail is only as accurate as its least accurate pass */
+            if (mesh_ptr->lod_errors[n_level + 1] < lod_generation_arg.lod_errors[n_levels * n_pass + n_level])
+            {
+                mesh_ptr->lod_errors[n_level + 1] = lod_generation_arg.lod_errors[n_levels * n_pass + n_level];
+            }
+        }
+    }
 
-                            system_resizable_vector_get_property(polygon_vector,
-                                                                 SYSTEM_RESIZABLE_VECTOR_PROPERTY_N_ELEMENTS,
-                                                                &n_polygon_vector_items);
+    /* Coarser levels must never be selected over finer ones which are less accurate */
+    for (uint32_t n_level = 1;
+                  n_level <= n_levels;
+                ++n_level)
+    {
+        if (mesh_ptr->lod_errors[n_level] < mesh_ptr->lod_errors[n_level - 1])
+        {
+            mesh_ptr->lod_errors[n_level] = mesh_ptr->lod_errors[n_level - 1];
+        }
+    }
 
-                            for (uint32_t n_polygon_vector_item = 0;
-                                          n_polygon_vector_item < n_polygon_vector_items;
-                                        ++n_polygon_vector_item)
-                            {
-                                _mesh_polygon* polygon_ptr = nullptr;
+    _mesh_release_bo_processed_data(mesh_ptr);
 
-                                if (!system_resizable_vector_get_element_at(polygon_vector,
-                                                                            n_polygon_vector_item,
-                                                                           &polygon_ptr) )
-                                {
-                                    ASSERT_DEBUG_SYNC(false,
-                                                      "Could not retrieve polygon vector descriptor");
+    mesh_ptr->bo_processed_data                 = new_processed_data;
+    mesh_ptr->bo_processed_data_size            = new_processed_data_size;
+    mesh_ptr->bo_processed_data_total_elements += n_lod_indices;
+    mesh_ptr->n_lods                            = n_levels + 1;
 
-                                    continue;
-                                }
+    LOG_INFO("Mesh [%s]: %u levels of detail generated, %u indices -> %u indices",
+             system_hashed_ansi_string_get_buffer(mesh_ptr->name),
+             n_levels,
+             n_total_indices,
+             n_total_indices + n_lod_indices);
 
-                                /* Calculate the normal vector */
-                                float b_minus_a[3];
-                                float c_minus_a[3];
-
-                                system_math_vector_minus3    (polygon_ptr->vertex_data[1],
-                                                              polygon_ptr->vertex_data[0],
-                                                              b_minus_a);
-                                system_math_vector_minus3    (polygon_ptr->vertex_data[2],
-                                                              polygon_ptr->vertex_data[0],
-                                                              c_minus_a);
-                                system_math_vector_cross3    (b_minus_a,
-                                                              c_minus_a,
-                                                              polygon_ptr->polygon_normal);
-                                system_math_vector_normalize3(polygon_ptr->polygon_normal,
-                                                              polygon_ptr->polygon_normal);
-                            }
-                        }
+    /* Update modification timestamp */
+    mesh_ptr->timestamp_last_modified = system_time_now();
 
-                        break;
-                    }
+    /* All done */
+    result = true;
+end:
+    delete [] lod_generation_arg.index_data;
+    delete [] lod_generation_arg.lod_errors;
+    delete [] lod_generation_arg.lod_index_data;
+    delete [] lod_generation_arg.lod_n_indices;
+    delete [] pass_index_offsets;
+    delete [] pass_ptrs;
 
-                    default: ASSERT_DEBUG_SYNC(false,
-                                               "Unrecognized iteration index");
-                }
-            }
-        }
-    }
+    return result;
+}
+
+/* Please see header for specification */
+PUBLIC EMERALD_API void mesh_generate_normal_data(mesh                  mesh,
+                                                  mesh_normal_weighting weighting)
+{
+    _mesh*       mesh_ptr = reinterpret_cast<_mesh*>(mesh);
+    unsigned int n_layers = 0;
+
+    ASSERT_DEBUG_SYNC(mesh_ptr->type == MESH_TYPE_REGULAR,
+                      "Entry-point is only compatible with regular meshes only.");
+
+    system_resizable_vector_get_property(mesh_ptr->layers,
+                                         SYSTEM_RESIZABLE_VECTOR_PROPERTY_N_ELEMENTS,
+                                        &n_layers);
 
-    /* Compute per-vertex normals. */
     ASSERT_ALWAYS_SYNC(n_layers != 0,
                        "Zero layers defined for the mesh");
 
-    LOG_INFO("Generating normal data for mesh [%s] (iteration 3/3) ...",
-             system_hashed_ansi_string_get_buffer(mesh_ptr->name) );
+    mesh_ptr->normals_weighting = weighting;
 
     for (unsigned int n_layer = 0;
                       n_layer < n_layers;
                     ++n_layer)
     {
-        /* Retrieve layer vertex data */
+        /* Retrieve raw vertex data */
+        uint32_t*                adjacency_offsets      = nullptr;
         _mesh_layer*             layer_ptr              = nullptr;
+        uint32_t*                layer_index_data       = nullptr;
+        float*                   layer_normal_data      = nullptr;
+        uint32_t                 n_layer_elements       = 0;
+        unsigned int             n_layer_passes         = 0;
+        uint32_t                 n_processed_elements   = 0;
+        uint32_t                 n_vertices             = 0;
+        uint32_t                 n_welded_vertices      = 0;
         _mesh_layer_data_stream* vertex_data_stream_ptr = nullptr;
+        uint32_t*                welded_vertex_ids      = nullptr;
 
         if (!system_resizable_vector_get_element_at(mesh_ptr->layers,
                                                     n_layer,
@@ -3159,9 +4560,17 @@ PUBLIC EMERALD_API void mesh_generate_normal_data(mesh mesh)
             continue;
         }
 
+        if (system_hash64map_contains(layer_ptr->data_streams,
+                                      MESH_LAYER_DATA_STREAM_TYPE_NORMALS) )
+        {
+            /* Normal data defined for this layer, move on */
+            continue;
+        }
+
         if (!system_hash64map_get(layer_ptr->data_streams,
                                   MESH_LAYER_DATA_STREAM_TYPE_VERTICES,
-                                 &vertex_data_stream_ptr) )
+                                 &vertex_data_stream_ptr) ||
+            vertex_data_stream_ptr->n_items_ptr == nullptr)
         {
             ASSERT_DEBUG_SYNC(false,
                               "Could not retrieve vertex data stream for mesh layer [%d]",
@@ -3170,9 +4579,13 @@ PUBLIC EMERALD_API void mesh_generate_normal_data(mesh mesh)
             continue;
         }
 
-        /* We will need to iterate over all polygons. */
-        uint32_t n_layer_passes = 0;
-
+        /* Normals of all layer passes are stored in a single data stream, one normal per each element,
+         * in the order given by the indices. This is to ensure that vertices, which are used many times
+         * in a single layer pass, are assigned unique normals. The normal vectors may be different,
+         * given that they will be calculated for a different set of owning polygons.
+         * This may appear to be space-ineffective, but bear in mind that all the layer data will
+         * eventually be combined when forming the GL blob.
+         */
         system_resizable_vector_get_property(layer_ptr->passes,
                                              SYSTEM_RESIZABLE_VECTOR_PROPERTY_N_ELEMENTS,
                                             &n_layer_passes);
@@ -3181,17 +4594,68 @@ PUBLIC EMERALD_API void mesh_generate_normal_data(mesh mesh)
                       n_layer_pass < n_layer_passes;
                     ++n_layer_pass)
         {
-            unsigned int*                layer_pass_index_data            = nullptr;
-            float*                       layer_pass_normal_data           = nullptr;
-            _mesh_layer_pass*            layer_pass_ptr                   = nullptr;
-            _mesh_layer_pass_index_data* layer_pass_vertex_index_data_ptr = nullptr;
+            _mesh_layer_pass* layer_pass_ptr = nullptr;
+
+            if (system_resizable_vector_get_element_at(layer_ptr->passes,
+                                                       n_layer_pass,
+                                                      &layer_pass_ptr) )
+            {
+                n_layer_elements += layer_pass_ptr->n_elements;
+            }
+        }
+
+        if (n_layer_elements == 0)
+        {
+            continue;
+        }
+
+        LOG_INFO("Generating normal data for mesh [%s], layer [%d] ...",
+                 system_hashed_ansi_string_get_buffer(mesh_ptr->name),
+                 n_layer);
+
+        /* 1. Weld vertices which share a location. Normals of polygons which use any of the welded
+         *    vertices are going to be considered when calculating the vertex normals. */
+        n_vertices        = *vertex_data_stream_ptr->n_items_ptr;
+        welded_vertex_ids = new (std::nothrow) uint32_t[n_vertices];
+
+        ASSERT_ALWAYS_SYNC(welded_vertex_ids != nullptr,
+                           "Out of memory");
+
+        n_welded_vertices = _mesh_weld_vertices(reinterpret_cast<const float*>(vertex_data_stream_ptr->data),
+                                                n_vertices,
+                                                welded_vertex_ids);
+
+        /* The adjacency data is stored in CSR form. Corners which use welded vertex i are stored
+         * in adjacency_corners, starting at adjacency_offsets[i] and ending before adjacency_offsets[i + 1].
+         * One extra entry is needed for the construction, see below. */
+        adjacency_offsets = new (std::nothrow) uint32_t[n_welded_vertices + 2];
+
+        ASSERT_ALWAYS_SYNC(adjacency_offsets != nullptr,
+                           "Out of memory");
+
+        layer_index_data  = new (std::nothrow) uint32_t[n_layer_elements];
+        layer_normal_data = new (std::nothrow) float   [n_layer_elements * 3 /* components */];
+
+        ASSERT_ALWAYS_SYNC(layer_index_data  != nullptr &&
+                           layer_normal_data != nullptr,
+                           "Out of memory");
+
+        for (uint32_t n_layer_pass = 0;
+                      n_layer_pass < n_layer_passes;
+                    ++n_layer_pass)
+        {
+            _mesh_layer_pass*            layer_pass_ptr = nullptr;
+            _mesh_layer_pass_index_data* index_data_ptr = nullptr;
+            uint32_t                     n_triangles    = 0;
+            uint32_t                     n_vertex_sets  = 0;
 
             if (!system_resizable_vector_get_element_at(layer_ptr->passes,
                                                         n_layer_pass,
                                                        &layer_pass_ptr) )
             {
                 ASSERT_DEBUG_SYNC(false,
-                                  "Could not retrieve layer pass descriptor");
+                                  "Could not retrieve layer pass descriptor for mesh layer [%d]",
+                                  n_layer);
 
                 continue;
             }
@@ -3201,271 +4665,157 @@ PUBLIC EMERALD_API void mesh_generate_normal_data(mesh mesh)
                                        MESH_MATERIAL_PROPERTY_VERTEX_SMOOTHING_ANGLE,
                                       &layer_pass_ptr->smoothing_angle);
 
-            /* Allocate buffer to hold the normal data.
-             *
-             * NOTE: Per-vertex normals will be held individually for each defined vertex,
-             *       in the order given by the indices. This is to ensure that the vertices,
-             *       which are used many times in a single layer pass, are assigned unique
-             *       normals. The normal vectors may be different, given that they will be
-             *       calculated for a different set of owning polygons.
-             *       This may appear to be space-ineffective, but bear in mind that all the
-             *       layer data will eventually be combined when forming the GL blob.
-             */
-            uint32_t n_vertex_items = 0;
+            /* NOTE: If there is no index data available, assume the vertices are defined in order. */
+            if (layer_pass_ptr->index_data_maps[MESH_LAYER_DATA_STREAM_TYPE_VERTICES] != nullptr)
+            {
+                system_hash64map_get_property(layer_pass_ptr->index_data_maps[MESH_LAYER_DATA_STREAM_TYPE_VERTICES],
+                                              SYSTEM_HASH64MAP_PROPERTY_N_ELEMENTS,
+                                             &n_vertex_sets);
+
+                ASSERT_DEBUG_SYNC(n_vertex_sets <= 1,
+                                  "Layer pass uses >= 1 sets which is not supported.");
 
-            layer_pass_index_data  = new (std::nothrow) unsigned int[layer_pass_ptr->n_elements];
-            layer_pass_normal_data = new (std::nothrow) float       [layer_pass_ptr->n_elements * 3 /* components */];
+                if (n_vertex_sets > 0)
+                {
+                    system_hash64map_get_element_at(layer_pass_ptr->index_data_maps[MESH_LAYER_DATA_STREAM_TYPE_VERTICES],
+                                                    0,        /* set id   */
+                                                   &index_data_ptr,
+                                                    nullptr); /* pOutHash */
+                }
+            }
 
-            ASSERT_ALWAYS_SYNC(layer_pass_normal_data != nullptr &&
-                               layer_pass_index_data  != nullptr,
+            n_triangles = layer_pass_ptr->n_elements / 3;
+
+            /* 2. Calculate polygon normals and the weights each polygon corner contributes with. */
+            _mesh_normal_generation_arg normal_generation_arg;
+
+            normal_generation_arg.adjacency_corners   = new (std::nothrow) uint32_t[n_triangles * 3 /* corners */];
+            normal_generation_arg.adjacency_offsets   = adjacency_offsets;
+            normal_generation_arg.corner_weights      = new (std::nothrow) float   [n_triangles * 3 /* corners */];
+            normal_generation_arg.index_data_ptr      = (index_data_ptr != nullptr) ? index_data_ptr->data : nullptr;
+            normal_generation_arg.normal_data_ptr     = layer_normal_data + 3 /* components */ * n_processed_elements;
+            normal_generation_arg.polygon_normals     = new (std::nothrow) float   [n_triangles * 3 /* components */];
+            normal_generation_arg.smoothing_angle     = layer_pass_ptr->smoothing_angle;
+            normal_generation_arg.smoothing_angle_cos = (layer_pass_ptr->smoothing_angle < DEG_TO_RAD(180.0f) ) ? cos(layer_pass_ptr->smoothing_angle)
+                                                                                                              : -1.0f;
+            normal_generation_arg.vertex_data_ptr     = reinterpret_cast<const float*>(vertex_data_stream_ptr->data);
+            normal_generation_arg.weighting           = weighting;
+            normal_generation_arg.welded_vertex_ids   = welded_vertex_ids;
+
+            ASSERT_ALWAYS_SYNC(normal_generation_arg.adjacency_corners != nullptr &&
+                               normal_generation_arg.corner_weights    != nullptr &&
+                               normal_generation_arg.polygon_normals   != nullptr,
                                "Out of memory");
 
-            memset(layer_pass_normal_data,
+            system_thread_pool_parallel_for(0, /* range_start */
+                                            n_triangles,
+                                            NORMAL_GENERATION_GRAIN_SIZE,
+                                            _mesh_calculate_polygon_normals,
+                                           &normal_generation_arg);
+
+            /* 3. Build the vertex->corner adjacency data for the layer pass. Each welded vertex' corner
+             *    count is accumulated two entries ahead, so that after the prefix sum, adjacency_offsets[i + 1]
+             *    points at the start of vertex i's range. The fill pass then moves it to the range's end,
+             *    which is the start of vertex (i + 1)'s range. Corners are stored in ascending order. */
+            memset(adjacency_offsets,
                    0,
-                   sizeof(float) * layer_pass_ptr->n_elements * 3 /* components */);
-
-            system_hash64map_get_property(layer_pass_ptr->index_data_maps[MESH_LAYER_DATA_STREAM_TYPE_VERTICES],
-                                          SYSTEM_HASH64MAP_PROPERTY_N_ELEMENTS,
-                                         &n_vertex_items);
+                   sizeof(uint32_t) * (n_welded_vertices + 2) );
 
-            if (n_vertex_items > 0)
+            for (uint32_t n_corner = 0;
+                          n_corner < n_triangles * 3;
+                        ++n_corner)
             {
-                system_hash64map_get_element_at(layer_pass_ptr->index_data_maps[MESH_LAYER_DATA_STREAM_TYPE_VERTICES],
-                                                0,     /* set id */
-                                               &layer_pass_vertex_index_data_ptr,
-                                                nullptr); /* pOutHash */
+                const uint32_t vertex_index = (index_data_ptr != nullptr) ? index_data_ptr->data[n_corner] : n_corner;
+
+                ++adjacency_offsets[welded_vertex_ids[vertex_index] + 2];
             }
 
-            for (unsigned int n_current_triangle = 0;
-                              n_current_triangle < layer_pass_ptr->n_elements / 3;
-                            ++n_current_triangle)
+            for (uint32_t n_welded_vertex = 2;
+                          n_welded_vertex < n_welded_vertices + 2;
+                        ++n_welded_vertex)
             {
-                const uint32_t vertices_indices[] =
-                {
-                    (layer_pass_vertex_index_data_ptr != nullptr) ? (layer_pass_vertex_index_data_ptr->data[n_current_triangle * 3 + 0]) : (n_current_triangle * 3 + 0),
-                    (layer_pass_vertex_index_data_ptr != nullptr) ? (layer_pass_vertex_index_data_ptr->data[n_current_triangle * 3 + 1]) : (n_current_triangle * 3 + 1),
-                    (layer_pass_vertex_index_data_ptr != nullptr) ? (layer_pass_vertex_index_data_ptr->data[n_current_triangle * 3 + 2]) : (n_current_triangle * 3 + 2)
-                };
-                const float* vertices_data[] =
-                {
-                    reinterpret_cast<const float*>(vertex_data_stream_ptr->data) + 3 /* components */ * vertices_indices[0],
-                    reinterpret_cast<const float*>(vertex_data_stream_ptr->data) + 3 /* components */ * vertices_indices[1],
-                    reinterpret_cast<const float*>(vertex_data_stream_ptr->data) + 3 /* components */ * vertices_indices[2]
-                };
-                const unsigned int n_vertices = sizeof(vertices_data) / sizeof(vertices_data[0]);
-
-                /* Fill the index array */
-                layer_pass_index_data[n_current_triangle * 3 + 0] = n_current_triangle * 3;
-                layer_pass_index_data[n_current_triangle * 3 + 1] = n_current_triangle * 3 + 1;
-                layer_pass_index_data[n_current_triangle * 3 + 2] = n_current_triangle * 3 + 2;
-
-                /* Find the polygon-specific normal vector data. It's the same for all polygon vertices,
-                 * so we need not run it in the triangle vertex loop. */
-                float*                  current_triangle_polygon_normal      = nullptr;
-                system_resizable_vector current_triangle_polygon_vector      = nullptr;
-                uint32_t                current_triangle_polygon_vector_size = 0;
-
-                if (!system_bst_get(vertex_to_polygon_vector_bst,
-                                    (system_bst_key)                   (vertices_data[0]),
-                                    reinterpret_cast<system_bst_value*>(&current_triangle_polygon_vector)) )
-                {
-                    ASSERT_DEBUG_SYNC(false,
-                                      "Polygon vertex was not recognized");
-
-                    continue;
-                }
-
-                system_resizable_vector_get_property(current_triangle_polygon_vector,
-                                                     SYSTEM_RESIZABLE_VECTOR_PROPERTY_N_ELEMENTS,
-                                                    &current_triangle_polygon_vector_size);
-
-                for (unsigned int n_triangle_polygon_vector_item = 0;
-                                  n_triangle_polygon_vector_item < current_triangle_polygon_vector_size;
-                                ++n_triangle_polygon_vector_item)
-                {
-                    _mesh_polygon* current_triangle_polygon_ptr = nullptr;
-
-                    if (!system_resizable_vector_get_element_at(current_triangle_polygon_vector,
-                                                                n_triangle_polygon_vector_item,
-                                                               &current_triangle_polygon_ptr) )
-                    {
-                        ASSERT_DEBUG_SYNC(false,
-                                          "Could not find triangle polygon descriptor");
-
-                        continue;
-                    }
-
-                    if (current_triangle_polygon_ptr->layer_pass_ptr == layer_pass_ptr     &&
-                        current_triangle_polygon_ptr->layer_ptr      == layer_ptr          &&
-                        current_triangle_polygon_ptr->triangle_index == n_current_triangle)
-                    {
-                        current_triangle_polygon_normal = current_triangle_polygon_ptr->polygon_normal;
-
-                        break;
-                    }
-                }
-
-                ASSERT_DEBUG_SYNC(current_triangle_polygon_normal != nullptr,
-                                  "Current triangle polygon normal is nullptr");
-
-                /* Iterate over all triangle vertices */
-                for (unsigned int n_vertex = 0;
-                                  n_vertex < n_vertices;
-                                ++n_vertex)
-                {
-                    const unsigned int      current_vertex_index      = vertices_indices[n_vertex];
-                    const float*            triangle_vertex_data      = vertices_data   [n_vertex];
-                    float                   triangle_vertex_normal[3] =
-                    {
-                        current_triangle_polygon_normal[0],
-                        current_triangle_polygon_normal[1],
-                        current_triangle_polygon_normal[2]
-                    };
-                    system_resizable_vector triangle_vertex_polygon_vector = nullptr;
+                adjacency_offsets[n_welded_vertex] += adjacency_offsets[n_welded_vertex - 1];
+            }
 
-                    if (layer_pass_ptr->smoothing_angle > 0.0f)
-                    {
-                        /* Find all polygons that share the vertex */
-                        unsigned int n_triangle_vertex_polygon_vector_items = 0;
+            for (uint32_t n_corner = 0;
+                          n_corner < n_triangles * 3;
+                        ++n_corner)
+            {
+                const uint32_t vertex_index = (index_data_ptr != nullptr) ? index_data_ptr->data[n_corner] : n_corner;
 
-                        if (!system_bst_get(vertex_to_polygon_vector_bst,
-                                            (system_bst_key)                   (vertices_data[n_vertex]),
-                                            reinterpret_cast<system_bst_value*>(&triangle_vertex_polygon_vector)))
-                        {
-                            ASSERT_DEBUG_SYNC(false,
-                                              "Could not find a polygon vector for input vertex");
+                normal_generation_arg.adjacency_corners[adjacency_offsets[welded_vertex_ids[vertex_index] + 1]++] = n_corner;
+            }
 
-                            continue;
-                        }
+            /* 4. Compute per-vertex normals. */
+            system_thread_pool_parallel_for(0, /* range_start */
+                                            n_triangles,
+                                            NORMAL_GENERATION_GRAIN_SIZE,
+                                            _mesh_calculate_vertex_normals,
+                                           &normal_generation_arg);
 
-                        system_resizable_vector_get_property(triangle_vertex_polygon_vector,
-                                                             SYSTEM_RESIZABLE_VECTOR_PROPERTY_N_ELEMENTS,
-                                                            &n_triangle_vertex_polygon_vector_items);
+            for (uint32_t n_element = 0;
+                          n_element < layer_pass_ptr->n_elements;
+                        ++n_element)
+            {
+                layer_index_data[n_processed_elements + n_element] = n_processed_elements + n_element;
+            }
 
-                        for (unsigned int n_triangle_vertex_polygon_vector_item = 0;
-                                          n_triangle_vertex_polygon_vector_item < n_triangle_vertex_polygon_vector_items;
-                                        ++n_triangle_vertex_polygon_vector_item)
-                        {
-                            _mesh_polygon* triangle_vertex_polygon_ptr = nullptr;
+            n_processed_elements += layer_pass_ptr->n_elements;
 
-                            if (!system_resizable_vector_get_element_at(triangle_vertex_polygon_vector,
-                                                                        n_triangle_vertex_polygon_vector_item,
-                                                                       &triangle_vertex_polygon_ptr) )
-                            {
-                                ASSERT_DEBUG_SYNC(false,
-                                                  "Could not retrieve triangle vertex polygon item");
+            delete [] normal_generation_arg.adjacency_corners;
+            delete [] normal_generation_arg.corner_weights;
+            delete [] normal_generation_arg.polygon_normals;
+        }
 
-                                continue;
-                            }
+        /* Add the data stream as well as the index data
+         *
+         * TODO: The mesh_add_layer_pass_index_data() call assumes only one set is ever defined.
+         *       FIX IF NEEDED.
+         */
+        mesh_add_layer_data_stream_from_client_memory(mesh,
+                                                      n_layer,
+                                                      MESH_LAYER_DATA_STREAM_TYPE_NORMALS,
+                                                      3, /* n_components */
+                                                      n_layer_elements,
+                                                      layer_normal_data);
 
-                            /* For the purpose of per-vertex normal calculation, only consider normals
-                             * coming from polygons other than the currently processed one */
-                            if (triangle_vertex_polygon_ptr->layer_pass_ptr == layer_pass_ptr     &&
-                                triangle_vertex_polygon_ptr->layer_ptr      == layer_ptr          &&
-                                triangle_vertex_polygon_ptr->triangle_index != n_current_triangle)
-                            {
-                                float angle = acos(triangle_vertex_polygon_ptr->polygon_normal[0] * current_triangle_polygon_normal[0] +
-                                                   triangle_vertex_polygon_ptr->polygon_normal[1] * current_triangle_polygon_normal[1] +
-                                                   triangle_vertex_polygon_ptr->polygon_normal[2] * current_triangle_polygon_normal[2]);
+        n_processed_elements = 0;
 
-                                if (angle <= layer_pass_ptr->smoothing_angle)
-                                {
-                                    system_math_vector_add3(triangle_vertex_normal,                      /* a */
-                                                            triangle_vertex_polygon_ptr->polygon_normal, /* b */
-                                                            triangle_vertex_normal);                     /* result */
-                                }
-                            }
-                        }
-                    }
-
-                    system_math_vector_normalize3(triangle_vertex_normal,
-                                                  triangle_vertex_normal);
+        for (uint32_t n_layer_pass = 0;
+                      n_layer_pass < n_layer_passes;
+                    ++n_layer_pass)
+        {
+            _mesh_layer_pass* layer_pass_ptr = nullptr;
 
-                    /* Store the result per-vertex normal */
-                    memcpy(layer_pass_normal_data + 3 /* components */ * layer_pass_index_data[n_current_triangle * 3 + n_vertex],
-                           triangle_vertex_normal,
-                           sizeof(float) * 3 /* components */);
-                }
+            if (!system_resizable_vector_get_element_at(layer_ptr->passes,
+                                                        n_layer_pass,
+                                                       &layer_pass_ptr) ||
+                layer_pass_ptr->n_elements == 0)
+            {
+                continue;
             }
 
-            /* Add the data stream as well as the index data
-             *
-             * We need not worry about adding duplicate normal streams, since mesh_add_layer_*() will throw
-             * an assertion failure if the data is already defined.
-             *
-             * TODO: The mesh_add_layer_pass_index_data() call assumes only one set is ever defined.
-             *       FIX IF NEEDED.
-             */
-            uint32_t n_vertex_sets = 0;
-
-            system_hash64map_get_property(layer_pass_ptr->set_id_to_unique_set_id[MESH_LAYER_DATA_STREAM_TYPE_VERTICES],
-                                          SYSTEM_HASH64MAP_PROPERTY_N_ELEMENTS,
-                                         &n_vertex_sets);
-
-            ASSERT_DEBUG_SYNC(n_vertex_sets <= 1,
-                              "Layer pass uses >= 1 sets which is not supported.");
-
-            mesh_add_layer_data_stream_from_client_memory(mesh,
-                                                          n_layer,
-                                                          MESH_LAYER_DATA_STREAM_TYPE_NORMALS,
-                                                          3, /* n_components */
-                                                          layer_pass_ptr->n_elements,
-                                                          layer_pass_normal_data);
-
             mesh_add_layer_pass_index_data_for_regular_mesh(mesh,
                                                             n_layer,
                                                             n_layer_pass,
                                                             MESH_LAYER_DATA_STREAM_TYPE_NORMALS,
                                                             0, /* set id */
-                                                            layer_pass_index_data,
-                                                            0, /* min_index */
-                                                            layer_pass_ptr->n_elements - 1);
-
-            /* OK, we can release the buffers */
-            if (layer_pass_index_data != nullptr)
-            {
-                delete [] layer_pass_index_data;
-
-                layer_pass_index_data = nullptr;
-            }
+                                                            layer_index_data + n_processed_elements,
+                                                            n_processed_elements,
+                                                            n_processed_elements + layer_pass_ptr->n_elements - 1);
 
-            if (layer_pass_normal_data != nullptr)
-            {
-                delete [] layer_pass_normal_data;
-
-                layer_pass_normal_data = nullptr;
-            }
+            n_processed_elements += layer_pass_ptr->n_elements;
         }
+
+        /* OK, we can release the buffers */
+        delete [] adjacency_offsets;
+        delete [] layer_index_data;
+        delete [] layer_normal_data;
+        delete [] welded_vertex_ids;
     }
 
     /* Update modification timestamp */
     mesh_ptr->timestamp_last_modified = system_time_now();
-
-    if (allocated_polygon_vectors != nullptr)
-    {
-        system_resizable_vector vector_item = nullptr;
-
-        while (system_resizable_vector_pop(allocated_polygon_vectors,
-                                          &vector_item) )
-        {
-            system_resizable_vector_release(vector_item);
-
-            vector_item = nullptr;
-        }
-
-        system_resizable_vector_release(allocated_polygon_vectors);
-        allocated_polygon_vectors = nullptr;
-    }
-
-    if (mesh_polygon_resource_pool != nullptr)
-    {
-        system_resource_pool_release(mesh_polygon_resource_pool);
-    }
-
-    if (vec3_resource_pool != nullptr)
-    {
-        system_resource_pool_release(vec3_resource_pool);
-    }
 }
 
 /* Please see header for specification */
@@ -3550,6 +4900,13 @@ PUBLIC EMERALD_API bool mesh_get_layer_data_stream_property(mesh
             result                                       = true;
         }
         else
+        if  (mesh_ptr->type == MESH_TYPE_REGULAR                        &&
+             property       == MESH_LAYER_DATA_STREAM_PROPERTY_ENCODING)
+        {
+            *reinterpret_cast<mesh_layer_data_stream_encoding*>(out_result_ptr) = mesh_ptr->bo_processed_data_stream_encoding[type];
+            result                                                              = true;
+        }
+        else
         {
             _mesh_layer* layer_ptr = nullptr;
 
@@ -3766,6 +5123,13 @@ PUBLIC EMERALD_API bool mesh_get_property(mesh          instance,
             break;
         }
 
+        case MESH_PROPERTY_BO_INDEX_ENCODING:
+        {
+            *reinterpret_cast<mesh_index_encoding*>(out_result_ptr) = mesh_ptr->bo_index_encoding;
+
+            break;
+        }
+
         case MESH_PROPERTY_BO_INDEX_TYPE:
         {
             if (mesh_ptr->instantiation_parent == nullptr)
@@ -3901,6 +5265,22 @@ PUBLIC EMERALD_API bool mesh_get_property(mesh          instance,
             break;
         }
 
+        case MESH_PROPERTY_LOD_ERRORS:
+        {
+            if (mesh_ptr->instantiation_parent == nullptr)
+            {
+                *reinterpret_cast<const float**>(out_result_ptr) = mesh_ptr->lod_errors;
+            }
+            else
+            {
+                mesh_get_property(mesh_ptr->instantiation_parent,
+                                  MESH_PROPERTY_LOD_ERRORS,
+                                  out_result_ptr);
+            }
+
+            break;
+        }
+
         case MESH_PROPERTY_MATERIALS:
         {
             *reinterpret_cast<system_resizable_vector*>(out_result_ptr) = mesh_ptr->materials;
@@ -3933,6 +5313,22 @@ PUBLIC EMERALD_API bool mesh_get_property(mesh          instance,
             break;
         }
 
+        case MESH_PROPERTY_N_LODS:
+        {
+            if (mesh_ptr->instantiation_parent == nullptr)
+            {
+                *reinterpret_cast<uint32_t*>(out_result_ptr) = mesh_ptr->n_lods;
+            }
+            else
+            {
+                mesh_get_property(mesh_ptr->instantiation_parent,
+                                  MESH_PROPERTY_N_LODS,
+                                  out_result_ptr);
+            }
+
+            break;
+        }
+
         case MESH_PROPERTY_N_BO_UNIQUE_VERTICES:
         {
             if (mesh_ptr->instantiation_parent == nullptr)
@@ -3991,6 +5387,109 @@ PUBLIC EMERALD_API bool mesh_get_property(mesh          instance,
     return b_result;
 }
 
+/* Please see header for specification */
+PUBLIC EMERALD_API bool mesh_get_layer_pass_lod_property(mesh                instance,
+                                                         uint32_t            n_layer,
+                                                         uint32_t            n_pass,
+                                                         uint32_t            n_lod,
+                                                         mesh_layer_property property,
+                                                         void*               out_result_ptr)
+{
+    const _mesh_layer_pass_lod* lod_ptr             = nullptr;
+    _mesh_layer*                mesh_layer_ptr      = nullptr;
+    _mesh_layer_pass*           mesh_layer_pass_ptr = nullptr;
+    _mesh*                      mesh_ptr            = reinterpret_cast<_mesh*>(instance);
+    bool                        result              = false;
+
+    ASSERT_DEBUG_SYNC(mesh_ptr->type == MESH_TYPE_REGULAR,
+                      "mesh_get_layer_pass_lod_property() is only valid for regular meshes.");
+
+    if (n_lod == 0)
+    {
+        result = mesh_get_layer_pass_property(instance,
+                                              n_layer,
+                                              n_pass,
+                                              property,
+                                              out_result_ptr);
+
+        goto end;
+    }
+
+    if (n_lod >= mesh_ptr->n_lods)
+    {
+        ASSERT_DEBUG_SYNC(false,
+                          "Invalid level of detail index requested.");
+
+        goto end;
+    }
+
+    if (!system_resizable_vector_get_element_at(mesh_ptr->layers,
+                                                n_layer,
+                                               &mesh_layer_ptr)         ||
+        !system_resizable_vector_get_element_at(mesh_layer_ptr->passes,
+                                                n_pass,
+                                               &mesh_layer_pass_ptr) )
+    {
+        ASSERT_ALWAYS_SYNC(false,
+                           "Cannot retrieve mesh layer pass descriptor");
+
+        goto end;
+    }
+
+    lod_ptr = mesh_layer_pass_ptr->lods + (n_lod - 1);
+    result  = true;
+
+    switch (property)
+    {
+        case MESH_LAYER_PROPERTY_BO_ELEMENTS_OFFSET:
+        {
+            *reinterpret_cast<uint32_t*>(out_result_ptr) = lod_ptr->bo_elements_offset;
+
+            break;
+        }
+
+        case MESH_LAYER_PROPERTY_BO_ELEMENTS_DATA_MAX_INDEX:
+        {
+            *reinterpret_cast<uint32_t*>(out_result_ptr) = lod_ptr->bo_elements_max_index;
+
+            break;
+        }
+
+        case MESH_LAYER_PROPERTY_BO_ELEMENTS_DATA_MIN_INDEX:
+        {
+            *reinterpret_cast<uint32_t*>(out_result_ptr) = lod_ptr->bo_elements_min_index;
+
+            break;
+        }
+
+        case MESH_LAYER_PROPERTY_N_ELEMENTS:
+        {
+            *reinterpret_cast<uint32_t*>(out_result_ptr) = lod_ptr->n_elements;
+
+            break;
+        }
+
+        case MESH_LAYER_PROPERTY_N_TRIANGLES:
+        {
+            *reinterpret_cast<uint32_t*>(out_result_ptr) = lod_ptr->n_elements / 3;
+
+            break;
+        }
+
+        default:
+        {
+            result = mesh_get_layer_pass_property(instance,
+                                                  n_layer,
+                                                  n_pass,
+                                                  property,
+                                                  out_result_ptr);
+        }
+    }
+
+end:
+    return result;
+}
+
 /* Please see header for specification */
 PUBLIC EMERALD_API bool mesh_get_layer_pass_property(mesh                instance,
                                                      uint32_t            n_layer,
@@ -4163,7 +5662,7 @@ PUBLIC EMERALD_API mesh mesh_load(ral_context               context,
 {
     /* Create file serializer instance */
     mesh                   result     = nullptr;
-    system_file_serializer serializer = system_file_serializer_create_for_reading(full_file_path);
+    system_file_serializer serializer = system_file_serializer_create_for_reading_mapped_file(full_file_path);
 
     ASSERT_DEBUG_SYNC(serializer != nullptr,
                       "Out of memory");
@@ -4191,7 +5690,9 @@ PUBLIC EMERALD_API mesh mesh_load_with_serializer(ral_context            context
                                                   system_hash64map       mesh_name_to_mesh_map)
 {
     /* Read header */
+    uint32_t                  features             = 0;
     char                      header[16]           = {0};
+    bool                      is_encoded           = false;
     bool                      is_instantiated      = false;
     system_hashed_ansi_string mesh_name            = nullptr;
     _mesh*                    mesh_ptr             = nullptr;
@@ -4205,15 +5706,40 @@ PUBLIC EMERALD_API mesh mesh_load_with_serializer(ral_context            context
                                         strlen(header_magic),
                                         header);
 
-    ASSERT_ALWAYS_SYNC(strcmp(header, header_magic) == 0,
-                       "Mesh [%s] is corrupt.",
-                       system_hashed_ansi_string_get_buffer(serializer_file_name) );
+    if (strcmp(header, header_magic_extended) == 0)
+    {
+        system_file_serializer_read(serializer,
+                                    sizeof(features),
+                                   &features);
+
+        ASSERT_ALWAYS_SYNC((features & ~MESH_FILE_FEATURE_ALL) == 0,
+                           "Mesh [%s] uses unsupported features.",
+                           system_hashed_ansi_string_get_buffer(serializer_file_name) );
 
-    if (strcmp(header,
-               header_magic) != 0)
+        if ((features & ~MESH_FILE_FEATURE_ALL) != 0)
+        {
+            goto end;
+        }
+    }
+    else
+    if (strcmp(header, header_magic_encoded) == 0)
     {
-        goto end;
+        features = MESH_FILE_FEATURE_ENCODED_DATA;
     }
+    else
+    {
+        ASSERT_ALWAYS_SYNC(strcmp(header, header_magic) == 0,
+                           "Mesh [%s] is corrupt.",
+                           system_hashed_ansi_string_get_buffer(serializer_file_name) );
+
+        if (strcmp(header,
+                   header_magic) != 0)
+        {
+            goto end;
+        }
+    }
+
+    is_encoded = (features & MESH_FILE_FEATURE_ENCODED_DATA) != 0;
 
     /* Is this an instantiated mesh? */
     system_file_serializer_read_hashed_ansi_string(serializer,
@@ -4243,8 +5769,10 @@ PUBLIC EMERALD_API mesh mesh_load_with_serializer(ral_context            context
     if (!is_instantiated)
     {
         /* Read mesh name */
-        float aabb_max[4];
-        float aabb_min[4];
+        float    aabb_max[4];
+        float    aabb_min[4];
+        bool     is_serializer_mapped = false;
+        uint32_t serializer_offset    = 0;
 
         system_file_serializer_read(serializer,
                                     sizeof(aabb_max),
@@ -4269,36 +5797,139 @@ PUBLIC EMERALD_API mesh mesh_load_with_serializer(ral_context            context
         ASSERT_DEBUG_SYNC(mesh_ptr->bo_processed_data_size != 0,
                           "Invalid processed BO data size");
 
-        mesh_ptr->bo_processed_data = reinterpret_cast<float*>(new (std::nothrow) unsigned char[mesh_ptr->bo_processed_data_size]);
+        /* If the serializer maps the file, reference the processed data directly instead of copying it.
+         * The mapping is kept alive until the data is uploaded to the buffer memory. */
+        system_file_serializer_get_property(serializer,
+                                            SYSTEM_FILE_SERIALIZER_PROPERTY_IS_MAPPED,
+                                           &is_serializer_mapped);
+        system_file_serializer_get_property(serializer,
+                                            SYSTEM_FILE_SERIALIZER_PROPERTY_CURRENT_OFFSET,
+                                           &serializer_offset);
 
-        ASSERT_ALWAYS_SYNC(mesh_ptr->bo_processed_data != nullptr,
-                           "Out of memory");
+        if (is_encoded)
+        {
+            /* Decode the data straight into the processed data buffer. If the file is mapped, the decoder
+             * reads the encoded data directly from the mapping. */
+            const unsigned char* encoded_data      = nullptr;
+            unsigned char*       encoded_data_copy = nullptr;
+            uint32_t             encoded_data_size = 0;
+            bool                 is_decoded        = false;
 
-        system_file_serializer_read(serializer,
-                                    mesh_ptr->bo_processed_data_size,
-                                    mesh_ptr->bo_processed_data);
+            _mesh_read_processed_data_properties(mesh_ptr,
+                                                 serializer);
 
-        for (mesh_layer_data_stream_type stream_type = (mesh_layer_data_stream_type) 0;
-                                         stream_type < MESH_LAYER_DATA_STREAM_TYPE_COUNT;
-                                 ++(int&)stream_type)
-        {
             system_file_serializer_read(serializer,
-                                        sizeof(mesh_ptr->bo_processed_data_stream_start_offset[0]),
-                                       &mesh_ptr->bo_processed_data_stream_start_offset[stream_type]);
+                                        sizeof(mesh_ptr->bo_processed_data_stream_encoding),
+                                        mesh_ptr->bo_processed_data_stream_encoding);
+            system_file_serializer_read(serializer,
+                                        sizeof(mesh_ptr->bo_index_encoding),
+                                       &mesh_ptr->bo_index_encoding);
+            system_file_serializer_read(serializer,
+                                        sizeof(encoded_data_size),
+                                       &encoded_data_size);
+
+            if (is_serializer_mapped)
+            {
+                const void* encoded_data_ptr = nullptr;
+
+                if (system_file_serializer_read_no_copy(serializer,
+                                                        encoded_data_size,
+                                                       &encoded_data_ptr) )
+                {
+                    encoded_data = reinterpret_cast<const unsigned char*>(encoded_data_ptr);
+                }
+            }
+            else
+            {
+                encoded_data_copy = new (std::nothrow) unsigned char[encoded_data_size];
+
+                ASSERT_ALWAYS_SYNC(encoded_data_copy != nullptr,
+                                   "Out of memory");
+
+                if (system_file_serializer_read(serializer,
+                                                encoded_data_size,
+                                                encoded_data_copy) )
+                {
+                    encoded_data = encoded_data_copy;
+                }
+            }
+
+            is_decoded = (encoded_data                != nullptr                  &&
+                          mesh_ptr->bo_index_encoding <  MESH_INDEX_ENCODING_COUNT);
+
+            for (mesh_layer_data_stream_type stream_type = (mesh_layer_data_stream_type) 0;
+                                             stream_type < MESH_LAYER_DATA_STREAM_TYPE_COUNT && is_decoded;
+                                     ++(int&)stream_type)
+            {
+                is_decoded = mesh_codec_is_stream_encoding_supported(mesh_ptr->bo_processed_data_stream_encoding[stream_type],
+                                                                     _mesh_get_processed_data_stream_n_components(stream_type) );
+            }
+
+            if (is_decoded)
+            {
+                is_decoded = _mesh_decode_processed_data(mesh_ptr,
+                                                         encoded_data,
+                                                         encoded_data_size);
+            }
+
+            delete [] encoded_data_copy;
+
+            ASSERT_ALWAYS_SYNC(is_decoded,
+                               "Processed data of mesh [%s] is corrupt.",
+                               system_hashed_ansi_string_get_buffer(serializer_file_name) );
+
+            if (!is_decoded)
+            {
+                mesh_release(result);
+
+                result = nullptr;
+                goto end;
+            }
         }
+        else
+        {
+            if (is_serializer_mapped                           &&
+                (serializer_offset % sizeof(float)) == 0)
+            {
+                const void* bo_processed_data_ptr = nullptr;
+                bool        is_read               = false;
 
-        system_file_serializer_read(serializer,
-                                    sizeof(mesh_ptr->bo_processed_data_stride),
-                                   &mesh_ptr->bo_processed_data_stride);
-        system_file_serializer_read(serializer,
-                                    sizeof(mesh_ptr->bo_processed_data_total_elements),
-                                   &mesh_ptr->bo_processed_data_total_elements);
-        system_file_serializer_read(serializer,
-                                    sizeof(mesh_ptr->n_bo_unique_vertices),
-                                   &mesh_ptr->n_bo_unique_vertices);
-        system_file_serializer_read(serializer,
-                                    sizeof(mesh_ptr->bo_index_type),
-                                   &mesh_ptr->bo_index_type);
+                is_read = system_file_serializer_read_no_copy(serializer,
+                                                              mesh_ptr->bo_processed_data_size,
+                                                             &bo_processed_data_ptr);
+
+                ASSERT_ALWAYS_SYNC(is_read,
+                                   "Processed data of mesh [%s] is truncated.",
+                                   system_hashed_ansi_string_get_buffer(serializer_file_name) );
+
+                if (!is_read)
+                {
+                    mesh_release(result);
+
+                    result = nullptr;
+                    goto end;
+                }
+
+                mesh_ptr->bo_processed_data            = reinterpret_cast<float*>(const_cast<void*>(bo_processed_data_ptr) );
+                mesh_ptr->bo_processed_data_serializer = serializer;
+
+                system_file_serializer_retain(serializer);
+            }
+            else
+            {
+                mesh_ptr->bo_processed_data = reinterpret_cast<float*>(new (std::nothrow) unsigned char[mesh_ptr->bo_processed_data_size]);
+
+                ASSERT_ALWAYS_SYNC(mesh_ptr->bo_processed_data != nullptr,
+                                   "Out of memory");
+
+                system_file_serializer_read(serializer,
+                                            mesh_ptr->bo_processed_data_size,
+                                            mesh_ptr->bo_processed_data);
+            }
+
+            _mesh_read_processed_data_properties(mesh_ptr,
+                                                 serializer);
+        }
 
         /* Read SH properties */
         system_file_serializer_read(serializer,
@@ -4308,6 +5939,32 @@ PUBLIC EMERALD_API mesh mesh_load_with_serializer(ral_context            context
                                     sizeof(mesh_ptr->n_sh_components),
                                    &mesh_ptr->n_sh_components);
 
+        /* Read LOD properties */
+        if (features & MESH_FILE_FEATURE_LODS)
+        {
+            system_file_serializer_read(serializer,
+                                        sizeof(mesh_ptr->n_lods),
+                                       &mesh_ptr->n_lods);
+
+            ASSERT_ALWAYS_SYNC(mesh_ptr->n_lods >  1 &&
+                               mesh_ptr->n_lods <= MESH_MAX_LODS,
+                               "Mesh [%s] is corrupt.",
+                               system_hashed_ansi_string_get_buffer(serializer_file_name) );
+
+            if (mesh_ptr->n_lods <= 1 ||
+                mesh_ptr->n_lods >  MESH_MAX_LODS)
+            {
+                mesh_release(result);
+
+                result = nullptr;
+                goto end;
+            }
+
+            system_file_serializer_read(serializer,
+                                        sizeof(mesh_ptr->lod_errors[0]) * mesh_ptr->n_lods,
+                                        mesh_ptr->lod_errors);
+        }
+
         /* Read layers */
         uint32_t n_layers = 0;
 
@@ -4357,119 +6014,462 @@ PUBLIC EMERALD_API mesh mesh_load_with_serializer(ral_context            context
                                     MESH_LAYER_PROPERTY_BO_N_UNIQUE_ELEMENTS,
                                     &n_layer_unique_elements);
 
-            for (uint32_t n_layer_pass = 0;
-                          n_layer_pass < n_layer_passes;
-                        ++n_layer_pass)
+            for (uint32_t n_layer_pass = 0;
+                          n_layer_pass < n_layer_passes;
+                        ++n_layer_pass)
+            {
+                uint32_t layer_pass_bo_elements_offset    = 0;
+                uint32_t layer_pass_bo_elements_max_index = 0;
+                uint32_t layer_pass_bo_elements_min_index = 0;
+                uint32_t layer_pass_material_id           = 0;
+                uint32_t layer_pass_n_elements            = 0;
+                float    layer_pass_smoothing_angle       = 0.0f;
+
+                /* Read the layer pass properties */
+                system_file_serializer_read(serializer,
+                                            sizeof(layer_pass_bo_elements_offset),
+                                           &layer_pass_bo_elements_offset);
+                system_file_serializer_read(serializer,
+                                            sizeof(layer_pass_bo_elements_max_index),
+                                           &layer_pass_bo_elements_max_index);
+                system_file_serializer_read(serializer,
+                                            sizeof(layer_pass_bo_elements_min_index),
+                                           &layer_pass_bo_elements_min_index);
+                system_file_serializer_read(serializer,
+                                            sizeof(layer_pass_n_elements),
+                                           &layer_pass_n_elements);
+                system_file_serializer_read(serializer,
+                                            sizeof(layer_pass_smoothing_angle),
+                                           &layer_pass_smoothing_angle);
+
+                /* Map the material ID to actual material instance. */
+                mesh_material layer_pass_material = nullptr;
+
+                system_file_serializer_read(serializer,
+                                            sizeof(layer_pass_material_id),
+                                           &layer_pass_material_id);
+
+                if (!system_hash64map_get(material_id_to_mesh_material_map,
+                                          (system_hash64) layer_pass_material_id,
+                                         &layer_pass_material) )
+                {
+                    ASSERT_ALWAYS_SYNC(false,
+                                       "Unrecognized material ID [%d]",
+                                       layer_pass_material_id);
+                }
+
+                /* Create the pass */
+                mesh_layer_pass_id current_pass_id = mesh_add_layer_pass_for_regular_mesh(result,
+                                                                                          current_layer,
+                                                                                          layer_pass_material,
+                                                                                          layer_pass_n_elements);
+
+                /* Update pass properties */
+                mesh_set_layer_property(result,
+                                        current_layer,
+                                        current_pass_id,
+                                        MESH_LAYER_PROPERTY_BO_ELEMENTS_OFFSET,
+                                       &layer_pass_bo_elements_offset);
+                mesh_set_layer_property(result,
+                                        current_layer,
+                                        current_pass_id,
+                                        MESH_LAYER_PROPERTY_BO_ELEMENTS_DATA_MAX_INDEX,
+                                       &layer_pass_bo_elements_max_index);
+                mesh_set_layer_property(result,
+                                        current_layer,
+                                        current_pass_id,
+                                        MESH_LAYER_PROPERTY_BO_ELEMENTS_DATA_MIN_INDEX,
+                                       &layer_pass_bo_elements_min_index);
+                mesh_set_layer_property(result,
+                                        current_layer,
+                                        current_pass_id,
+                                        MESH_LAYER_PROPERTY_VERTEX_SMOOTHING_ANGLE,
+                                       &layer_pass_smoothing_angle);
+
+                /* Read index ranges of levels of detail */
+                if (features & MESH_FILE_FEATURE_LODS)
+                {
+                    _mesh_layer*      layer_ptr = nullptr;
+                    _mesh_layer_pass* pass_ptr  = nullptr;
+
+                    system_resizable_vector_get_element_at(mesh_ptr->layers,
+                                                           current_layer,
+                                                          &layer_ptr);
+                    system_resizable_vector_get_element_at(layer_ptr->passes,
+                                                           current_pass_id,
+                                                          &pass_ptr);
+
+                    system_file_serializer_read(serializer,
+                                                sizeof(pass_ptr->lods[0]) * (mesh_ptr->n_lods - 1),
+                                                pass_ptr->lods);
+                }
+            }
+        }
+
+        /* Update modification timestamp */
+        mesh_ptr->timestamp_last_modified = system_time_now();
+
+        /* Generate GL buffers off the data we loaded */
+        mesh_fill_ral_buffers(result,
+                              mesh_ptr->ral_context,
+                              (flags & MESH_CREATION_FLAGS_LOAD_ASYNC) != 0);
+    }
+    else
+    {
+        system_hashed_ansi_string instantiation_parent_name = nullptr;
+
+        /* Read the name of the instantiation parent */
+        system_file_serializer_read_hashed_ansi_string(serializer,
+                                                      &instantiation_parent_name);
+
+        /* Retrieve the parent mesh */
+        mesh instantiation_parent_mesh_gpu = nullptr;
+
+        if (!system_hash64map_get(mesh_name_to_mesh_map,
+                                  system_hashed_ansi_string_get_hash(instantiation_parent_name),
+                                 &instantiation_parent_mesh_gpu) )
+        {
+            ASSERT_DEBUG_SYNC(false,
+                              "Instantiation parent [%s] was not recognized",
+                              system_hashed_ansi_string_get_buffer(instantiation_parent_name) );
+        }
+        else
+        {
+            /* Mark the result mesh as an instanced object */
+            mesh_set_as_instantiated(result,
+                                     instantiation_parent_mesh_gpu);
+        }
+
+    }
+
+end:
+    return result;
+}
+
+/* Please see header for specification */
+PUBLIC EMERALD_API void mesh_optimize(mesh                          instance,
+                                      mesh_optimization_flags       flags,
+                                      mesh_optimization_statistics* out_statistics_ptr)
+{
+    uint32_t                     index_size         = 0;
+    _mesh*                       mesh_ptr           = reinterpret_cast<_mesh*>(instance);
+    uint32_t                     n_layers           = 0;
+    uint32_t                     n_passes           = 0;
+    uint32_t                     n_total_indices    = 0;
+    _mesh_optimization_arg       optimization_arg;
+    uint32_t*                    pass_index_offsets = nullptr;
+    const _mesh_layer_pass**     pass_ptrs          = nullptr;
+    mesh_optimization_statistics statistics;
+
+    if (mesh_ptr->type != MESH_TYPE_REGULAR)
+    {
+        ASSERT_DEBUG_SYNC(false,
+                          "mesh_optimize() can only be called against regular meshes.");
+
+        goto end;
+    }
+
+    if (mesh_ptr->instantiation_parent != nullptr)
+    {
+        ASSERT_DEBUG_SYNC(false,
+                          "mesh_optimize() cannot be called against instantiated meshes.");
+
+        goto end;
+    }
+
+    if (mesh_ptr->bo_processed_data            == nullptr ||
+        mesh_ptr->bo_processed_data_serializer != nullptr ||
+        mesh_ptr->bo                           != nullptr)
+    {
+        ASSERT_DEBUG_SYNC(false,
+                          "mesh_optimize() must be called after mesh_create_single_indexed_representation() and before mesh_fill_ral_buffers().");
+
+        goto end;
+    }
+
+    if (mesh_ptr->n_lods > 1)
+    {
+        ASSERT_DEBUG_SYNC(false,
+                          "mesh_optimize() must be called before mesh_generate_lods().");
+
+        goto end;
+    }
+
+    switch (mesh_ptr->bo_index_type)
+    {
+        case MESH_INDEX_TYPE_UNSIGNED_CHAR:  index_size = sizeof(unsigned char);  break;
+        case MESH_INDEX_TYPE_UNSIGNED_SHORT: index_size = sizeof(unsigned short); break;
+        case MESH_INDEX_TYPE_UNSIGNED_INT:   index_size = sizeof(unsigned int);   break;
+
+        default:
+        {
+            ASSERT_DEBUG_SYNC(false,
+                              "Unrecognized index type");
+
+            goto end;
+        }
+    }
+
+    /* Gather all layer passes */
+    system_resizable_vector_get_property(mesh_ptr->layers,
+                                         SYSTEM_RESIZABLE_VECTOR_PROPERTY_N_ELEMENTS,
+                                        &n_layers);
+
+    for (uint32_t n_layer = 0;
+                  n_layer < n_layers;
+                ++n_layer)
+    {
+        _mesh_layer* layer_ptr      = nullptr;
+        uint32_t     n_layer_passes = 0;
+
+        if (system_resizable_vector_get_element_at(mesh_ptr->layers,
+                                                   n_layer,
+                                                  &layer_ptr) )
+        {
+            system_resizable_vector_get_property(layer_ptr->passes,
+                                                 SYSTEM_RESIZABLE_VECTOR_PROPERTY_N_ELEMENTS,
+                                                &n_layer_passes);
+
+            n_passes += n_layer_passes;
+        }
+    }
+
+    pass_index_offsets = new (std::nothrow) uint32_t               [n_passes + 1];
+    pass_ptrs          = new (std::nothrow) const _mesh_layer_pass*[n_passes];
+
+    ASSERT_ALWAYS_SYNC(pass_index_offsets != nullptr &&
+                       pass_ptrs          != nullptr,
+                       "Out of memory");
+
+    for (uint32_t n_layer = 0,
+                  n_pass  = 0;
+                  n_layer < n_layers;
+                ++n_layer)
+    {
+        _mesh_layer* layer_ptr      = nullptr;
+        uint32_t     n_layer_passes = 0;
+
+        system_resizable_vector_get_element_at(mesh_ptr->layers,
+                                               n_layer,
+                                              &layer_ptr);
+        system_resizable_vector_get_property  (layer_ptr->passes,
+                                               SYSTEM_RESIZABLE_VECTOR_PROPERTY_N_ELEMENTS,
+                                              &n_layer_passes);
+
+        for (uint32_t n_layer_pass = 0;
+                      n_layer_pass < n_layer_passes;
+                    ++n_layer_pass, ++n_pass)
+        {
+            _mesh_layer_pass* pass_ptr = nullptr;
+
+            system_resizable_vector_get_element_at(layer_ptr->passes,
+                                                   n_layer_pass,
+                                                  &pass_ptr);
+
+            if ((pass_ptr->n_elements % 3) != 0)
             {
-                uint32_t layer_pass_bo_elements_offset    = 0;
-                uint32_t layer_pass_bo_elements_max_index = 0;
-                uint32_t layer_pass_bo_elements_min_index = 0;
-                uint32_t layer_pass_material_id           = 0;
-                uint32_t layer_pass_n_elements            = 0;
-                float    layer_pass_smoothing_angle       = 0.0f;
+                LOG_ERROR("Mesh [%s] defines a layer pass which is not a triangle list. Mesh will not be optimized.",
+                          system_hashed_ansi_string_get_buffer(mesh_ptr->name) );
 
-                /* Read the layer pass properties */
-                system_file_serializer_read(serializer,
-                                            sizeof(layer_pass_bo_elements_offset),
-                                           &layer_pass_bo_elements_offset);
-                system_file_serializer_read(serializer,
-                                            sizeof(layer_pass_bo_elements_max_index),
-                                           &layer_pass_bo_elements_max_index);
-                system_file_serializer_read(serializer,
-                                            sizeof(layer_pass_bo_elements_min_index),
-                                           &layer_pass_bo_elements_min_index);
-                system_file_serializer_read(serializer,
-                                            sizeof(layer_pass_n_elements),
-                                           &layer_pass_n_elements);
-                system_file_serializer_read(serializer,
-                                            sizeof(layer_pass_smoothing_angle),
-                                           &layer_pass_smoothing_angle);
+                goto end;
+            }
 
-                /* Map the material ID to actual material instance. */
-                mesh_material layer_pass_material = nullptr;
+            pass_index_offsets[n_pass] = n_total_indices;
+            pass_ptrs         [n_pass] = pass_ptr;
+            n_total_indices           += pass_ptr->n_elements;
+        }
+    }
 
-                system_file_serializer_read(serializer,
-                                            sizeof(layer_pass_material_id),
-                                           &layer_pass_material_id);
+    pass_index_offsets[n_passes] = n_total_indices;
 
-                if (!system_hash64map_get(material_id_to_mesh_material_map,
-                                          (system_hash64) layer_pass_material_id,
-                                         &layer_pass_material) )
-                {
-                    ASSERT_ALWAYS_SYNC(false,
-                                       "Unrecognized material ID [%d]",
-                                       layer_pass_material_id);
-                }
+    /* Convert the index data to a common format */
+    optimization_arg.flags              = flags;
+    optimization_arg.index_data         = new (std::nothrow) uint32_t[n_total_indices];
+    optimization_arg.pass_index_offsets = pass_index_offsets;
+    optimization_arg.pass_ptrs          = pass_ptrs;
+    optimization_arg.vertex_data_ptr    = nullptr;
+    optimization_arg.vertex_stride      = mesh_ptr->bo_processed_data_stride;
 
-                /* Create the pass */
-                mesh_layer_pass_id current_pass_id = mesh_add_layer_pass_for_regular_mesh(result,
-                                                                                          current_layer,
-                                                                                          layer_pass_material,
-                                                                                          layer_pass_n_elements);
+    ASSERT_ALWAYS_SYNC(optimization_arg.index_data != nullptr,
+                       "Out of memory");
 
-                /* Update pass properties */
-                mesh_set_layer_property(result,
-                                        current_layer,
-                                        current_pass_id,
-                                        MESH_LAYER_PROPERTY_BO_ELEMENTS_OFFSET,
-                                       &layer_pass_bo_elements_offset);
-                mesh_set_layer_property(result,
-                                        current_layer,
-                                        current_pass_id,
-                                        MESH_LAYER_PROPERTY_BO_ELEMENTS_DATA_MAX_INDEX,
-                                       &layer_pass_bo_elements_max_index);
-                mesh_set_layer_property(result,
-                                        current_layer,
-                                        current_pass_id,
-                                        MESH_LAYER_PROPERTY_BO_ELEMENTS_DATA_MIN_INDEX,
-                                       &layer_pass_bo_elements_min_index);
-                mesh_set_layer_property(result,
-                                        current_layer,
-                                        current_pass_id,
-                                        MESH_LAYER_PROPERTY_VERTEX_SMOOTHING_ANGLE,
-                                       &layer_pass_smoothing_angle);
+    if (mesh_ptr->bo_processed_data_stream_start_offset[MESH_LAYER_DATA_STREAM_TYPE_VERTICES] != -1)
+    {
+        optimization_arg.vertex_data_ptr = reinterpret_cast<const float*>(reinterpret_cast<const char*>(mesh_ptr->bo_processed_data) + mesh_ptr->bo_processed_data_stream_start_offset[MESH_LAYER_DATA_STREAM_TYPE_VERTICES]);
+    }
 
-            }
+    for (uint32_t n_pass = 0;
+                  n_pass < n_passes;
+                ++n_pass)
+    {
+        const _mesh_layer_pass* pass_ptr       = pass_ptrs[n_pass];
+        const char*             pass_index_ptr = reinterpret_cast<const char*>(mesh_ptr->bo_processed_data) + pass_ptr->bo_elements_offset;
+        uint32_t*               result_ptr     = optimization_arg.index_data + pass_index_offsets[n_pass];
+
+        for (uint32_t n_element = 0;
+                      n_element < pass_ptr->n_elements;
+                    ++n_element)
+        {
+            result_ptr[n_element] = (index_size == sizeof(unsigned char))  ? reinterpret_cast<const uint8_t*> (pass_index_ptr)[n_element]
+                                  : (index_size == sizeof(unsigned short)) ? reinterpret_cast<const uint16_t*>(pass_index_ptr)[n_element]
+                                  :                                          reinterpret_cast<const uint32_t*>(pass_index_ptr)[n_element];
         }
+    }
 
-        /* Update modification timestamp */
-        mesh_ptr->timestamp_last_modified = system_time_now();
+    /* Layer passes do not share vertices, so running the cache simulation over all indices at once
+     * yields the same results as doing it for each pass separately. */
+    _mesh_get_vertex_cache_statistics(optimization_arg.index_data,
+                                      n_total_indices,
+                                      mesh_ptr->n_bo_unique_vertices,
+                                     &statistics.acmr_before,
+                                     &statistics.atvr_before);
 
-        /* Generate GL buffers off the data we loaded */
-        mesh_fill_ral_buffers(result,
-                              mesh_ptr->ral_context,
-                              (flags & MESH_CREATION_FLAGS_LOAD_ASYNC) != 0);
+    /* Reorder triangles of each pass */
+    if (flags & (MESH_OPTIMIZATION_FLAGS_VERTEX_CACHE | MESH_OPTIMIZATION_FLAGS_OVERDRAW) )
+    {
+        system_thread_pool_parallel_for(0, /* range_start */
+                                        n_passes,
+                                        1, /* grain_size */
+                                        _mesh_optimize_layer_passes,
+                                       &optimization_arg);
     }
-    else
+
+    /* Reorder vertex data */
+    if (flags & MESH_OPTIMIZATION_FLAGS_VERTEX_FETCH)
     {
-        system_hashed_ansi_string instantiation_parent_name = nullptr;
+        bool can_reorder_vertex_data = true;
 
-        /* Read the name of the instantiation parent */
-        system_file_serializer_read_hashed_ansi_string(serializer,
-                                                      &instantiation_parent_name);
+        for (unsigned int n_data_stream_type = MESH_LAYER_DATA_STREAM_TYPE_FIRST;
+                          n_data_stream_type < MESH_LAYER_DATA_STREAM_TYPE_COUNT;
+                        ++n_data_stream_type)
+        {
+            const uint32_t stream_n_components = _mesh_get_processed_data_stream_n_components( (mesh_layer_data_stream_type) n_data_stream_type);
+            const uint32_t stream_offset       = mesh_ptr->bo_processed_data_stream_start_offset[n_data_stream_type];
 
-        /* Retrieve the parent mesh */
-        mesh instantiation_parent_mesh_gpu = nullptr;
+            /* Streams which had to be padded do not fit in the vertex stride, so vertices cannot be moved around. */
+            if (stream_offset                                       != -1 &&
+                stream_offset + sizeof(float) * stream_n_components >  mesh_ptr->bo_processed_data_stride)
+            {
+                can_reorder_vertex_data = false;
+            }
+        }
 
-        if (!system_hash64map_get(mesh_name_to_mesh_map,
-                                  system_hashed_ansi_string_get_hash(instantiation_parent_name),
-                                 &instantiation_parent_mesh_gpu) )
+        if (!can_reorder_vertex_data)
         {
-            ASSERT_DEBUG_SYNC(false,
-                              "Instantiation parent [%s] was not recognized",
-                              system_hashed_ansi_string_get_buffer(instantiation_parent_name) );
+            LOG_ERROR("Vertex data of mesh [%s] uses padded streams. Vertex fetch optimization will be skipped.",
+                      system_hashed_ansi_string_get_buffer(mesh_ptr->name) );
         }
         else
         {
-            /* Mark the result mesh as an instanced object */
-            mesh_set_as_instantiated(result,
-                                     instantiation_parent_mesh_gpu);
+            const uint32_t n_vertices       = mesh_ptr->n_bo_unique_vertices;
+            uint32_t*      remap            = new (std::nothrow) uint32_t[n_vertices];
+            const uint32_t stride           = mesh_ptr->bo_processed_data_stride;
+            char*          vertex_data_copy = new (std::nothrow) char    [stride * n_vertices];
+
+            ASSERT_ALWAYS_SYNC(remap            != nullptr &&
+                               vertex_data_copy != nullptr,
+                               "Out of memory");
+
+            mesh_optimizer_get_vertex_fetch_remap(optimization_arg.index_data,
+                                                  n_total_indices,
+                                                  n_vertices,
+                                                  remap);
+
+            memcpy(vertex_data_copy,
+                   mesh_ptr->bo_processed_data,
+                   stride * n_vertices);
+
+            for (uint32_t n_vertex = 0;
+                          n_vertex < n_vertices;
+                        ++n_vertex)
+            {
+                memcpy(reinterpret_cast<char*>(mesh_ptr->bo_processed_data) + stride * remap[n_vertex],
+                       vertex_data_copy                                     + stride * n_vertex,
+                       stride);
+            }
+
+            for (uint32_t n_index = 0;
+                          n_index < n_total_indices;
+                        ++n_index)
+            {
+                optimization_arg.index_data[n_index] = remap[optimization_arg.index_data[n_index] ];
+            }
+
+            delete [] remap;
+            delete [] vertex_data_copy;
+        }
+    }
+
+    _mesh_get_vertex_cache_statistics(optimization_arg.index_data,
+                                      n_total_indices,
+                                      mesh_ptr->n_bo_unique_vertices,
+                                     &statistics.acmr_after,
+                                     &statistics.atvr_after);
+
+    /* Store the reordered index data */
+    for (uint32_t n_pass = 0;
+                  n_pass < n_passes;
+                ++n_pass)
+    {
+        _mesh_layer_pass* pass_ptr       = const_cast<_mesh_layer_pass*>(pass_ptrs[n_pass]);
+        char*             pass_index_ptr = reinterpret_cast<char*>(mesh_ptr->bo_processed_data) + pass_ptr->bo_elements_offset;
+        const uint32_t*   src_ptr        = optimization_arg.index_data + pass_index_offsets[n_pass];
+
+        pass_ptr->bo_elements_max_index = -1;
+        pass_ptr->bo_elements_min_index = -1;
+
+        for (uint32_t n_element = 0;
+                      n_element < pass_ptr->n_elements;
+                    ++n_element)
+        {
+            switch (index_size)
+            {
+                case sizeof(unsigned char):  reinterpret_cast<uint8_t*> (pass_index_ptr)[n_element] = static_cast<uint8_t> (src_ptr[n_element]); break;
+                case sizeof(unsigned short): reinterpret_cast<uint16_t*>(pass_index_ptr)[n_element] = static_cast<uint16_t>(src_ptr[n_element]); break;
+                case sizeof(unsigned int):   reinterpret_cast<uint32_t*>(pass_index_ptr)[n_element] = src_ptr[n_element];                         break;
+            }
+
+            if (pass_ptr->bo_elements_max_index == -1                  ||
+                pass_ptr->bo_elements_max_index <  src_ptr[n_element])
+            {
+                pass_ptr->bo_elements_max_index = src_ptr[n_element];
+            }
+
+            if (pass_ptr->bo_elements_min_index == -1                  ||
+                pass_ptr->bo_elements_min_index >  src_ptr[n_element])
+            {
+                pass_ptr->bo_elements_min_index = src_ptr[n_element];
+            }
+        }
+
+        if (pass_ptr->bo_elements != nullptr)
+        {
+            memcpy(pass_ptr->bo_elements,
+                   pass_index_ptr,
+                   index_size * pass_ptr->n_elements);
         }
+    }
+
+    delete [] optimization_arg.index_data;
 
+    LOG_INFO("Mesh [%s] optimized: ACMR %.3f -> %.3f, ATVR %.3f -> %.3f",
+             system_hashed_ansi_string_get_buffer(mesh_ptr->name),
+             statistics.acmr_before,
+             statistics.acmr_after,
+             statistics.atvr_before,
+             statistics.atvr_after);
+
+    if (out_statistics_ptr != nullptr)
+    {
+        *out_statistics_ptr = statistics;
     }
 
+    /* Update modification timestamp */
+    mesh_ptr->timestamp_last_modified = system_time_now();
+
 end:
-    return result;
+    delete [] pass_index_offsets;
+    delete [] pass_ptrs;
 }
 
 /* Please see header for specification */
@@ -4654,19 +6654,64 @@ PUBLIC EMERALD_API bool mesh_save_with_serializer(mesh                   instanc
                                                   system_file_serializer serializer,
                                                   system_hash64map       mesh_material_to_id_map)
 {
-    _mesh* mesh_ptr = reinterpret_cast<_mesh*>(instance);
-    bool   result   = false;
+    _mesh* mesh_ptr        = reinterpret_cast<_mesh*>(instance);
+    bool   is_encoded      = false;
+    bool   is_instantiated = (mesh_ptr->instantiation_parent != nullptr);
+    bool   result          = false;
 
     ASSERT_DEBUG_SYNC(mesh_ptr->type == MESH_TYPE_REGULAR,
                       "Entry-point is only compatible with regular meshes only.");
 
-    /* Write header */
-    system_file_serializer_write(serializer,
-                                 strlen(header_magic),
-                                 header_magic);
+    /* Stick to the original format, unless the processed data is to be stored in the compact form */
+    if (!is_instantiated)
+    {
+        is_encoded = (mesh_ptr->bo_index_encoding != MESH_INDEX_ENCODING_RAW);
+
+        for (mesh_layer_data_stream_type stream_type = (mesh_layer_data_stream_type) 0;
+                                         stream_type < MESH_LAYER_DATA_STREAM_TYPE_COUNT;
+                                       ++(int&)stream_type)
+        {
+            if (mesh_ptr->bo_processed_data_stream_start_offset[stream_type] != -1                                   &&
+                mesh_ptr->bo_processed_data_stream_encoding    [stream_type] != MESH_LAYER_DATA_STREAM_ENCODING_FLOAT)
+            {
+                is_encoded = true;
+            }
+        }
+
+        if (is_encoded                                  &&
+            !_mesh_is_processed_data_encodable(mesh_ptr) )
+        {
+            LOG_ERROR("Processed data of mesh [%s] uses padded streams. Mesh will be stored without encoding.",
+                      system_hashed_ansi_string_get_buffer(mesh_ptr->name) );
+
+            is_encoded = false;
+        }
+    }
+
+    /* Write header. Files which store levels of detail cannot be read by older loaders anyway, so they
+     * always use the extended header. */
+    if (!is_instantiated     &&
+        mesh_ptr->n_lods > 1)
+    {
+        const uint32_t features = MESH_FILE_FEATURE_LODS | ((is_encoded) ? MESH_FILE_FEATURE_ENCODED_DATA
+                                                                         : 0);
+
+        system_file_serializer_write(serializer,
+                                     strlen(header_magic_extended),
+                                     header_magic_extended);
+        system_file_serializer_write(serializer,
+                                     sizeof(features),
+                                    &features);
+    }
+    else
+    {
+        system_file_serializer_write(serializer,
+                                     strlen(header_magic),
+                                     (is_encoded) ? header_magic_encoded
+                                                  : header_magic);
+    }
 
     /* Write general stuff */
-    bool is_instantiated = (mesh_ptr->instantiation_parent != nullptr);
 
     system_file_serializer_write_hashed_ansi_string(serializer,
                                                     mesh_ptr->name);
@@ -4691,31 +6736,44 @@ PUBLIC EMERALD_API bool mesh_save_with_serializer(mesh                   instanc
         system_file_serializer_write(serializer,
                                      sizeof(mesh_ptr->bo_processed_data_size),
                                     &mesh_ptr->bo_processed_data_size);
-        system_file_serializer_write(serializer,
-                                     mesh_ptr->bo_processed_data_size,
-                                     mesh_ptr->bo_processed_data);
 
-        for (mesh_layer_data_stream_type stream_type = (mesh_layer_data_stream_type) 0;
-                                         stream_type < MESH_LAYER_DATA_STREAM_TYPE_COUNT;
-                                       ++(int&)stream_type)
+        if (is_encoded)
         {
+            /* Properties go first, so that the loader can decode the data on the fly. */
+            unsigned char* encoded_data      = nullptr;
+            uint32_t       encoded_data_size = 0;
+
+            _mesh_write_processed_data_properties(mesh_ptr,
+                                                  serializer);
+
+            system_file_serializer_write(serializer,
+                                         sizeof(mesh_ptr->bo_processed_data_stream_encoding),
+                                         mesh_ptr->bo_processed_data_stream_encoding);
+            system_file_serializer_write(serializer,
+                                         sizeof(mesh_ptr->bo_index_encoding),
+                                        &mesh_ptr->bo_index_encoding);
+
+            encoded_data = _mesh_encode_processed_data(mesh_ptr,
+                                                      &encoded_data_size);
+
             system_file_serializer_write(serializer,
-                                         sizeof(mesh_ptr->bo_processed_data_stream_start_offset[0]),
-                                        &mesh_ptr->bo_processed_data_stream_start_offset[stream_type]);
+                                         sizeof(encoded_data_size),
+                                        &encoded_data_size);
+            system_file_serializer_write(serializer,
+                                         encoded_data_size,
+                                         encoded_data);
+
+            delete [] encoded_data;
         }
+        else
+        {
+            system_file_serializer_write(serializer,
+                                         mesh_ptr->bo_processed_data_size,
+                                         mesh_ptr->bo_processed_data);
 
-        system_file_serializer_write(serializer,
-                                     sizeof(mesh_ptr->bo_processed_data_stride),
-                                    &mesh_ptr->bo_processed_data_stride);
-        system_file_serializer_write(serializer,
-                                     sizeof(mesh_ptr->bo_processed_data_total_elements),
-                                    &mesh_ptr->bo_processed_data_total_elements);
-        system_file_serializer_write(serializer,
-                                     sizeof(mesh_ptr->n_bo_unique_vertices),
-                                    &mesh_ptr->n_bo_unique_vertices);
-        system_file_serializer_write(serializer,
-                                     sizeof(mesh_ptr->bo_index_type),
-                                    &mesh_ptr->bo_index_type);
+            _mesh_write_processed_data_properties(mesh_ptr,
+                                                  serializer);
+        }
 
         /* Store SH properties */
         system_file_serializer_write(serializer,
@@ -4725,6 +6783,17 @@ PUBLIC EMERALD_API bool mesh_save_with_serializer(mesh                   instanc
                                      sizeof(mesh_ptr->n_sh_components),
                                     &mesh_ptr->n_sh_components);
 
+        /* Store LOD properties */
+        if (mesh_ptr->n_lods > 1)
+        {
+            system_file_serializer_write(serializer,
+                                         sizeof(mesh_ptr->n_lods),
+                                        &mesh_ptr->n_lods);
+            system_file_serializer_write(serializer,
+                                         sizeof(mesh_ptr->lod_errors[0]) * mesh_ptr->n_lods,
+                                         mesh_ptr->lod_errors);
+        }
+
         /* Store layers */
         uint32_t n_layers = 0;
 
@@ -4818,6 +6887,14 @@ PUBLIC EMERALD_API bool mesh_save_with_serializer(mesh                   instanc
                                                          sizeof(material_id),
                                                         &material_id);
                         }
+
+                        /* Index ranges of levels of detail */
+                        if (mesh_ptr->n_lods > 1)
+                        {
+                            system_file_serializer_write(serializer,
+                                                         sizeof(pass_ptr->lods[0]) * (mesh_ptr->n_lods - 1),
+                                                         pass_ptr->lods);
+                        }
                     }
                     else
                     {
@@ -4840,6 +6917,36 @@ PUBLIC EMERALD_API bool mesh_save_with_serializer(mesh                   instanc
     return result;
 }
 
+/* Please see header for specification */
+PUBLIC EMERALD_API uint32_t mesh_select_lod(mesh  instance,
+                                            float model_to_screen_scale,
+                                            float max_screen_space_error)
+{
+    _mesh*   mesh_ptr = reinterpret_cast<_mesh*>(instance);
+    uint32_t result   = 0;
+
+    if (mesh_ptr->instantiation_parent != nullptr)
+    {
+        mesh_ptr = reinterpret_cast<_mesh*>(mesh_ptr->instantiation_parent);
+    }
+
+    /* LOD errors never decrease, so the first level which fits, when looking from the coarsest one,
+     * is the one to use. */
+    for (uint32_t n_lod = mesh_ptr->n_lods - 1;
+                  n_lod > 0;
+                --n_lod)
+    {
+        if (mesh_ptr->lod_errors[n_lod] * model_to_screen_scale <= max_screen_space_error)
+        {
+            result = n_lod;
+
+            break;
+        }
+    }
+
+    return result;
+}
+
 /* Please see header for specification */
 PUBLIC EMERALD_API void mesh_set_as_instantiated(mesh mesh_to_modify,
                                                  mesh source_mesh)
@@ -4880,9 +6987,7 @@ PUBLIC EMERALD_API void mesh_set_as_instantiated(mesh mesh_to_modify,
     /* Release GPU data that may have already been generated */
     if (mesh_to_modify_ptr->bo_processed_data != nullptr)
     {
-        delete [] mesh_to_modify_ptr->bo_processed_data;
-
-        mesh_to_modify_ptr->bo_processed_data = nullptr;
+        _mesh_release_bo_processed_data(mesh_to_modify_ptr);
     }
 
     if (mesh_to_modify_ptr->bo != nullptr)
@@ -5163,6 +7268,33 @@ PUBLIC EMERALD_API void mesh_set_layer_property(mesh                instance,
     }
 }
 
+/** Please see header for specification */
+PUBLIC EMERALD_API void mesh_set_processed_data_stream_encoding(mesh                            mesh,
+                                                                mesh_layer_data_stream_type     stream_type,
+                                                                mesh_layer_data_stream_encoding encoding)
+{
+    _mesh* mesh_ptr = reinterpret_cast<_mesh*>(mesh);
+
+    ASSERT_DEBUG_SYNC(mesh_ptr->type == MESH_TYPE_REGULAR,
+                      "Entry-point is only compatible with regular meshes only.");
+
+    if (!mesh_codec_is_stream_encoding_supported(encoding,
+                                                 _mesh_get_processed_data_stream_n_components(stream_type) ))
+    {
+        ASSERT_DEBUG_SYNC(false,
+                          "Stream encoding [%d] cannot be used for stream type [%d]",
+                          encoding,
+                          stream_type);
+
+        return;
+    }
+
+    mesh_ptr->bo_processed_data_stream_encoding[stream_type] = encoding;
+
+    /* Update modification timestamp */
+    mesh_ptr->timestamp_last_modified = system_time_now();
+}
+
 /** Please see header for specification */
 PUBLIC EMERALD_API void mesh_set_processed_data_stream_start_offset(mesh                        mesh,
                                                                     mesh_layer_data_stream_type stream_type,
@@ -5197,6 +7329,16 @@ PUBLIC EMERALD_API void mesh_set_property(mesh          instance,
 
         switch(property)
         {
+            case MESH_PROPERTY_BO_INDEX_ENCODING:
+            {
+                ASSERT_DEBUG_SYNC(*reinterpret_cast<const mesh_index_encoding*>(value) < MESH_INDEX_ENCODING_COUNT,
+                                  "Invalid index encoding");
+
+                mesh_ptr->bo_index_encoding = *reinterpret_cast<const mesh_index_encoding*>(value);
+
+                break;
+            }
+
             case MESH_PROPERTY_BO_STRIDE:
             {
                 mesh_ptr->bo_processed_data_stride = *reinterpret_cast<const uint32_t*>(value);
@@ -5296,5 +7438,3 @@ PUBLIC EMERALD_API void mesh_set_single_indexed_representation(mesh
     /* Update modification timestamp */
     mesh_ptr->timestamp_last_modified = system_time_now();
 }
-
-
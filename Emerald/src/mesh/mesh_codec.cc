@@ -0,0 +1,729 @@
+/**
+ *
+ * Emerald (kbi/elude @2016)
+ *
+ */
+#include "shared.h"
+#include "mesh/mesh_codec.h"
+#include "system/system_log.h"
+#include <math.h>
+#include <string.h>
+
+/* Largest magnitude of a value stored as a 16-bit signed normalized integer */
+#define SNORM16_MAX (32767)
+
+
+/** Forward declarations */
+PRIVATE float    _mesh_codec_decode_half_float (uint16_t     value);
+PRIVATE uint16_t _mesh_codec_encode_half_float (float        value);
+PRIVATE float    _mesh_codec_decode_snorm16    (int16_t      value);
+PRIVATE int16_t  _mesh_codec_encode_snorm16    (float        value);
+PRIVATE uint32_t _mesh_codec_get_index         (const void*  index_data,
+                                                uint32_t     index_size,
+                                                uint32_t     n_index);
+PRIVATE void     _mesh_codec_set_index         (void*        index_data,
+                                                uint32_t     index_size,
+                                                uint32_t     n_index,
+                                                uint32_t     value);
+
+
+/** Converts a 16-bit float to a 32-bit float. */
+PRIVATE float _mesh_codec_decode_half_float(uint16_t value)
+{
+    const uint32_t exponent = (value >> 10) & 0x1F;
+    const uint32_t mantissa =  value        & 0x3FF;
+    uint32_t       result_bits;
+    float          result;
+
+    if (exponent == 0)
+    {
+        /* Zero or a denormal */
+        result = float(mantissa) * (1.0f / 16777216.0f);
+
+        return (value & 0x8000) ? -result : result;
+    }
+
+    if (exponent == 0x1F)
+    {
+        /* Infinity or NaN */
+        result_bits = 0x7F800000 | (mantissa << 13);
+    }
+    else
+    {
+        result_bits = ((exponent + 112) << 23) | (mantissa << 13);
+    }
+
+    result_bits |= uint32_t(value & 0x8000) << 16;
+
+    memcpy(&result,
+           &result_bits,
+           sizeof(result) );
+
+    return result;
+}
+
+/** Converts a 32-bit float to a 16-bit float, rounding to the nearest even value. */
+PRIVATE uint16_t _mesh_codec_encode_half_float(float value)
+{
+    uint32_t abs_bits;
+    uint32_t bits;
+    uint32_t sign;
+
+    memcpy(&bits,
+           &value,
+           sizeof(bits) );
+
+    abs_bits = bits & 0x7FFFFFFF;
+    sign     = (bits >> 16) & 0x8000;
+
+    if (abs_bits >= 0x7F800000)
+    {
+        /* Infinity or NaN. Make sure NaNs stay NaNs */
+        return static_cast<uint16_t>(sign | 0x7C00 | ((abs_bits > 0x7F800000) ? 0x200 : 0) );
+    }
+
+    if (abs_bits >= 0x477FF000)
+    {
+        /* Rounds to a value which is too large to be represented */
+        return static_cast<uint16_t>(sign | 0x7C00);
+    }
+
+    if (abs_bits < 0x38800000)
+    {
+        /* Rounds to a denormal or zero */
+        float abs_value;
+
+        memcpy(&abs_value,
+               &abs_bits,
+               sizeof(abs_value) );
+
+        return static_cast<uint16_t>(sign | uint32_t(lrintf(abs_value * 16777216.0f) ) );
+    }
+
+    /* Re-bias the exponent and round the mantissa to the nearest even value */
+    abs_bits += 0xC8000FFF + ((abs_bits >> 13) & 1);
+
+    return static_cast<uint16_t>(sign | (abs_bits >> 13) );
+}
+
+/** Converts a 16-bit signed normalized integer to a float. */
+PRIVATE float _mesh_codec_decode_snorm16(int16_t value)
+{
+    const float result = float(value) / float(SNORM16_MAX);
+
+    return (result < -1.0f) ? -1.0f : result;
+}
+
+/** Converts a float from the <-1, 1> range to a 16-bit signed normalized integer. */
+PRIVATE int16_t _mesh_codec_encode_snorm16(float value)
+{
+    value = (value < -1.0f) ? -1.0f
+          : (value >  1.0f) ?  1.0f
+          :                    value;
+
+    return static_cast<int16_t>(lrintf(value * float(SNORM16_MAX) ) );
+}
+
+/** Reads an index of the specified size. */
+PRIVATE uint32_t _mesh_codec_get_index(const void* index_data,
+                                       uint32_t    index_size,
+                                       uint32_t    n_index)
+{
+    switch (index_size)
+    {
+        case sizeof(uint8_t):  return reinterpret_cast<const uint8_t*> (index_data)[n_index];
+        case sizeof(uint16_t): return reinterpret_cast<const uint16_t*>(index_data)[n_index];
+        case sizeof(uint32_t): return reinterpret_cast<const uint32_t*>(index_data)[n_index];
+
+        default:
+        {
+            ASSERT_DEBUG_SYNC(false,
+                              "Unsupported index size");
+        }
+    }
+
+    return 0;
+}
+
+/** Stores an index of the specified size. */
+PRIVATE void _mesh_codec_set_index(void*    index_data,
+                                   uint32_t index_size,
+                                   uint32_t n_index,
+                                   uint32_t value)
+{
+    switch (index_size)
+    {
+        case sizeof(uint8_t):  reinterpret_cast<uint8_t*> (index_data)[n_index] = static_cast<uint8_t> (value); break;
+        case sizeof(uint16_t): reinterpret_cast<uint16_t*>(index_data)[n_index] = static_cast<uint16_t>(value); break;
+        case sizeof(uint32_t): reinterpret_cast<uint32_t*>(index_data)[n_index] = value;                         break;
+
+        default:
+        {
+            ASSERT_DEBUG_SYNC(false,
+                              "Unsupported index size");
+        }
+    }
+}
+
+
+/** Please see header for specification */
+PUBLIC EMERALD_API uint32_t mesh_codec_decode_indices(mesh_index_encoding  encoding,
+                                                      const unsigned char* encoded_data,
+                                                      uint32_t             encoded_data_size,
+                                                      uint32_t             n_indices,
+                                                      uint32_t             index_size,
+                                                      void*                out_index_data)
+{
+    const unsigned char* encoded_data_end = encoded_data + encoded_data_size;
+    const unsigned char* traveller_ptr    = encoded_data;
+
+    switch (encoding)
+    {
+        case MESH_INDEX_ENCODING_RAW:
+        {
+            if (encoded_data_size < n_indices * index_size)
+            {
+                return 0;
+            }
+
+            memcpy(out_index_data,
+                   encoded_data,
+                   n_indices * index_size);
+
+            traveller_ptr += n_indices * index_size;
+
+            break;
+        }
+
+        case MESH_INDEX_ENCODING_DELTA_VARINT:
+        {
+            uint32_t previous_index = 0;
+
+            for (uint32_t n_index = 0;
+                          n_index < n_indices;
+                        ++n_index)
+            {
+                uint32_t shift = 0;
+                uint32_t value = 0;
+
+                /* Read the LEB128-encoded value */
+                while (true)
+                {
+                    if (traveller_ptr == encoded_data_end ||
+                        shift         >  28)
+                    {
+                        return 0;
+                    }
+
+                    value |= uint32_t(*traveller_ptr & 0x7F) << shift;
+                    shift += 7;
+
+                    if ((*traveller_ptr++ & 0x80) == 0)
+                    {
+                        break;
+                    }
+                }
+
+                /* Undo the zigzag encoding */
+                previous_index += (value >> 1) ^ (0 - (value & 1) );
+
+                _mesh_codec_set_index(out_index_data,
+                                      index_size,
+                                      n_index,
+                                      previous_index);
+            }
+
+            break;
+        }
+
+        default:
+        {
+            ASSERT_DEBUG_SYNC(false,
+                              "Unrecognized index encoding");
+
+            return 0;
+        }
+    }
+
+    return static_cast<uint32_t>(traveller_ptr - encoded_data);
+}
+
+/** Please see header for specification */
+PUBLIC EMERALD_API uint32_t mesh_codec_decode_stream(mesh_layer_data_stream_encoding encoding,
+                                                     const unsigned char*            encoded_data,
+                                                     uint32_t                        encoded_data_size,
+                                                     uint32_t                        n_components,
+                                                     uint32_t                        n_items,
+                                                     uint32_t                        out_stride,
+                                                     float*                          out_data)
+{
+    const uint32_t       expected_data_size = mesh_codec_encode_stream(encoding,
+                                                                       nullptr, /* data */
+                                                                       n_components,
+                                                                       n_items,
+                                                                       0,       /* stride */
+                                                                       nullptr);/* out_data */
+    const unsigned char* traveller_ptr      = encoded_data;
+
+    if ((expected_data_size == 0 && n_items != 0)   ||
+         expected_data_size >  encoded_data_size)
+    {
+        return 0;
+    }
+
+    switch (encoding)
+    {
+        case MESH_LAYER_DATA_STREAM_ENCODING_FLOAT:
+        {
+            for (uint32_t n_item = 0;
+                          n_item < n_items;
+                        ++n_item)
+            {
+                memcpy(reinterpret_cast<char*>(out_data) + out_stride * n_item,
+                       traveller_ptr,
+                       sizeof(float) * n_components);
+
+                traveller_ptr += sizeof(float) * n_components;
+            }
+
+            break;
+        }
+
+        case MESH_LAYER_DATA_STREAM_ENCODING_HALF_FLOAT:
+        {
+            for (uint32_t n_item = 0;
+                          n_item < n_items;
+                        ++n_item)
+            {
+                float* item_ptr = reinterpret_cast<float*>(reinterpret_cast<char*>(out_data) + out_stride * n_item);
+
+                for (uint32_t n_component = 0;
+                              n_component < n_components;
+                            ++n_component)
+                {
+                    uint16_t value;
+
+                    memcpy(&value,
+                           traveller_ptr,
+                           sizeof(value) );
+
+                    item_ptr[n_component] = _mesh_codec_decode_half_float(value);
+                    traveller_ptr        += sizeof(value);
+                }
+            }
+
+            break;
+        }
+
+        case MESH_LAYER_DATA_STREAM_ENCODING_OCTAHEDRAL_SNORM16:
+        {
+            for (uint32_t n_item = 0;
+                          n_item < n_items;
+                        ++n_item)
+            {
+                float*  item_ptr = reinterpret_cast<float*>(reinterpret_cast<char*>(out_data) + out_stride * n_item);
+                float   length;
+                float   overlap;
+                int16_t values[2];
+                float   x;
+                float   y;
+                float   z;
+
+                memcpy(values,
+                       traveller_ptr,
+                       sizeof(values) );
+
+                traveller_ptr += sizeof(values);
+
+                /* Unfold the lower hemisphere */
+                x       = _mesh_codec_decode_snorm16(values[0]);
+                y       = _mesh_codec_decode_snorm16(values[1]);
+                z       = 1.0f - fabsf(x) - fabsf(y);
+                overlap = (z < 0.0f) ? -z : 0.0f;
+                x      += (x >= 0.0f) ? -overlap : overlap;
+                y      += (y >= 0.0f) ? -overlap : overlap;
+                length  = sqrtf(x * x + y * y + z * z);
+
+                item_ptr[0] = x / length;
+                item_ptr[1] = y / length;
+                item_ptr[2] = z / length;
+            }
+
+            break;
+        }
+
+        case MESH_LAYER_DATA_STREAM_ENCODING_SNORM16_BOUNDS:
+        {
+            float bounds_max[4];
+            float bounds_min[4];
+            float centers   [4];
+            float scales    [4];
+
+            memcpy(bounds_min,
+                   traveller_ptr,
+                   sizeof(float) * n_components);
+            memcpy(bounds_max,
+                   traveller_ptr + sizeof(float) * n_components,
+                   sizeof(float) * n_components);
+
+            traveller_ptr += 2 * sizeof(float) * n_components;
+
+            for (uint32_t n_component = 0;
+                          n_component < n_components;
+                        ++n_component)
+            {
+                centers[n_component] = 0.5f * (bounds_max[n_component] + bounds_min[n_component]);
+                scales [n_component] = 0.5f * (bounds_max[n_component] - bounds_min[n_component]);
+            }
+
+            for (uint32_t n_item = 0;
+                          n_item < n_items;
+                        ++n_item)
+            {
+                float* item_ptr = reinterpret_cast<float*>(reinterpret_cast<char*>(out_data) + out_stride * n_item);
+
+                for (uint32_t n_component = 0;
+                              n_component < n_components;
+                            ++n_component)
+                {
+                    int16_t value;
+
+                    memcpy(&value,
+                           traveller_ptr,
+                           sizeof(value) );
+
+                    item_ptr[n_component] = centers[n_component] + scales[n_component] * _mesh_codec_decode_snorm16(value);
+                    traveller_ptr        += sizeof(value);
+                }
+            }
+
+            break;
+        }
+
+        default:
+        {
+            ASSERT_DEBUG_SYNC(false,
+                              "Unrecognized stream encoding");
+
+            return 0;
+        }
+    }
+
+    return static_cast<uint32_t>(traveller_ptr - encoded_data);
+}
+
+/** Please see header for specification */
+PUBLIC EMERALD_API uint32_t mesh_codec_encode_indices(mesh_index_encoding encoding,
+                                                      const void*         index_data,
+                                                      uint32_t            index_size,
+                                                      uint32_t            n_indices,
+                                                      unsigned char*      out_data)
+{
+    uint32_t result = 0;
+
+    switch (encoding)
+    {
+        case MESH_INDEX_ENCODING_RAW:
+        {
+            result = n_indices * index_size;
+
+            if (out_data != nullptr)
+            {
+                memcpy(out_data,
+                       index_data,
+                       result);
+            }
+
+            break;
+        }
+
+        case MESH_INDEX_ENCODING_DELTA_VARINT:
+        {
+            uint32_t previous_index = 0;
+
+            for (uint32_t n_index = 0;
+                          n_index < n_indices;
+                        ++n_index)
+            {
+                const uint32_t index = _mesh_codec_get_index(index_data,
+                                                             index_size,
+                                                             n_index);
+                const int32_t  delta = static_cast<int32_t>(index - previous_index);
+                uint32_t       value = (static_cast<uint32_t>(delta) << 1) ^ static_cast<uint32_t>(delta >> 31);
+
+                previous_index = index;
+
+                /* Store as LEB128 */
+                do
+                {
+                    if (out_data != nullptr)
+                    {
+                        out_data[result] = static_cast<unsigned char>( (value & 0x7F) | ((value > 0x7F) ? 0x80 : 0) );
+                    }
+
+                    value >>= 7;
+                    result ++;
+                }
+                while (value != 0);
+            }
+
+            break;
+        }
+
+        default:
+        {
+            ASSERT_DEBUG_SYNC(false,
+                              "Unrecognized index encoding");
+        }
+    }
+
+    return result;
+}
+
+/** Please see header for specification */
+PUBLIC EMERALD_API uint32_t mesh_codec_encode_stream(mesh_layer_data_stream_encoding encoding,
+                                                     const float*                    data,
+                                                     uint32_t                        n_components,
+                                                     uint32_t                        n_items,
+                                                     uint32_t                        stride,
+                                                     unsigned char*                  out_data)
+{
+    uint32_t       result        = 0;
+    unsigned char* traveller_ptr = out_data;
+
+    if (!mesh_codec_is_stream_encoding_supported(encoding,
+                                                 n_components) )
+    {
+        ASSERT_DEBUG_SYNC(false,
+                          "Stream encoding [%d] is not supported for [%d] components.",
+                          encoding,
+                          n_components);
+
+        return 0;
+    }
+
+    switch (encoding)
+    {
+        case MESH_LAYER_DATA_STREAM_ENCODING_FLOAT:              result = sizeof(float)    * n_components * n_items;                                   break;
+        case MESH_LAYER_DATA_STREAM_ENCODING_HALF_FLOAT:         result = sizeof(uint16_t) * n_components * n_items;                                   break;
+        case MESH_LAYER_DATA_STREAM_ENCODING_OCTAHEDRAL_SNORM16: result = sizeof(int16_t)  * 2            * n_items;                                   break;
+        case MESH_LAYER_DATA_STREAM_ENCODING_SNORM16_BOUNDS:     result = sizeof(int16_t)  * n_components * n_items + 2 * sizeof(float) * n_components; break;
+
+        default:
+        {
+            ASSERT_DEBUG_SYNC(false,
+                              "Unrecognized stream encoding");
+
+            return 0;
+        }
+    }
+
+    if (out_data == nullptr)
+    {
+        return result;
+    }
+
+    switch (encoding)
+    {
+        case MESH_LAYER_DATA_STREAM_ENCODING_FLOAT:
+        {
+            for (uint32_t n_item = 0;
+                          n_item < n_items;
+                        ++n_item)
+            {
+                memcpy(traveller_ptr,
+                       reinterpret_cast<const char*>(data) + stride * n_item,
+                       sizeof(float) * n_components);
+
+                traveller_ptr += sizeof(float) * n_components;
+            }
+
+            break;
+        }
+
+        case MESH_LAYER_DATA_STREAM_ENCODING_HALF_FLOAT:
+        {
+            for (uint32_t n_item = 0;
+                          n_item < n_items;
+                        ++n_item)
+            {
+                const float* item_ptr = reinterpret_cast<const float*>(reinterpret_cast<const char*>(data) + stride * n_item);
+
+                for (uint32_t n_component = 0;
+                              n_component < n_components;
+                            ++n_component)
+                {
+                    const uint16_t value = _mesh_codec_encode_half_float(item_ptr[n_component]);
+
+                    memcpy(traveller_ptr,
+                          &value,
+                           sizeof(value) );
+
+                    traveller_ptr += sizeof(value);
+                }
+            }
+
+            break;
+        }
+
+        case MESH_LAYER_DATA_STREAM_ENCODING_OCTAHEDRAL_SNORM16:
+        {
+            for (uint32_t n_item = 0;
+                          n_item < n_items;
+                        ++n_item)
+            {
+                const float* item_ptr = reinterpret_cast<const float*>(reinterpret_cast<const char*>(data) + stride * n_item);
+                const float  l1_norm  = fabsf(item_ptr[0]) + fabsf(item_ptr[1]) + fabsf(item_ptr[2]);
+                int16_t      values[2];
+                float        x        = 0.0f;
+                float        y        = 0.0f;
+
+                /* Project the vector onto the octahedron and fold the lower hemisphere over the upper one */
+                if (l1_norm > 0.0f)
+                {
+                    x = item_ptr[0] / l1_norm;
+                    y = item_ptr[1] / l1_norm;
+
+                    if (item_ptr[2] < 0.0f)
+                    {
+                        const float folded_x = (1.0f - fabsf(y) ) * ((x >= 0.0f) ? 1.0f : -1.0f);
+                        const float folded_y = (1.0f - fabsf(x) ) * ((y >= 0.0f) ? 1.0f : -1.0f);
+
+                        x = folded_x;
+                        y = folded_y;
+                    }
+                }
+
+                values[0] = _mesh_codec_encode_snorm16(x);
+                values[1] = _mesh_codec_encode_snorm16(y);
+
+                memcpy(traveller_ptr,
+                       values,
+                       sizeof(values) );
+
+                traveller_ptr += sizeof(values);
+            }
+
+            break;
+        }
+
+        case MESH_LAYER_DATA_STREAM_ENCODING_SNORM16_BOUNDS:
+        {
+            float bounds_max[4];
+            float bounds_min[4];
+            float centers   [4];
+            float scales    [4];
+
+            for (uint32_t n_component = 0;
+                          n_component < n_components;
+                        ++n_component)
+            {
+                bounds_max[n_component] = (n_items > 0) ? data[n_component] : 0.0f;
+                bounds_min[n_component] = bounds_max[n_component];
+            }
+
+            for (uint32_t n_item = 1;
+                          n_item < n_items;
+                        ++n_item)
+            {
+                const float* item_ptr = reinterpret_cast<const float*>(reinterpret_cast<const char*>(data) + stride * n_item);
+
+                for (uint32_t n_component = 0;
+                              n_component < n_components;
+                            ++n_component)
+                {
+                    bounds_max[n_component] = (bounds_max[n_component] > item_ptr[n_component]) ? bounds_max[n_component] : item_ptr[n_component];
+                    bounds_min[n_component] = (bounds_min[n_component] < item_ptr[n_component]) ? bounds_min[n_component] : item_ptr[n_component];
+                }
+            }
+
+            memcpy(traveller_ptr,
+                   bounds_min,
+                   sizeof(float) * n_components);
+            memcpy(traveller_ptr + sizeof(float) * n_components,
+                   bounds_max,
+                   sizeof(float) * n_components);
+
+            traveller_ptr += 2 * sizeof(float) * n_components;
+
+            /* Use the same center & scale as the decoder does */
+            for (uint32_t n_component = 0;
+                          n_component < n_components;
+                        ++n_component)
+            {
+                centers[n_component] = 0.5f * (bounds_max[n_component] + bounds_min[n_component]);
+                scales [n_component] = 0.5f * (bounds_max[n_component] - bounds_min[n_component]);
+                scales [n_component] = (scales[n_component] > 0.0f) ? 1.0f / scales[n_component]
+                                                                    : 0.0f;
+            }
+
+            for (uint32_t n_item = 0;
+                          n_item < n_items;
+                        ++n_item)
+            {
+                const float* item_ptr = reinterpret_cast<const float*>(reinterpret_cast<const char*>(data) + stride * n_item);
+
+                for (uint32_t n_component = 0;
+                              n_component < n_components;
+                            ++n_component)
+                {
+                    const int16_t value = _mesh_codec_encode_snorm16( (item_ptr[n_component] - centers[n_component]) * scales[n_component]);
+
+                    memcpy(traveller_ptr,
+                          &value,
+                           sizeof(value) );
+
+                    traveller_ptr += sizeof(value);
+                }
+            }
+
+            break;
+        }
+
+        default:
+        {
+            ASSERT_DEBUG_SYNC(false,
+                              "Unrecognized stream encoding");
+
+            return 0;
+        }
+    }
+
+    ASSERT_DEBUG_SYNC(traveller_ptr == out_data + result,
+                      "Encoded data size mismatch");
+
+    return result;
+}
+
+/** Please see header for specification */
+PUBLIC EMERALD_API bool mesh_codec_is_stream_encoding_supported(mesh_layer_data_stream_encoding encoding,
+                                                                uint32_t                        n_components)
+{
+    bool result = false;
+
+    switch (encoding)
+    {
+        case MESH_LAYER_DATA_STREAM_ENCODING_FLOAT:
+        case MESH_LAYER_DATA_STREAM_ENCODING_HALF_FLOAT:
+        case MESH_LAYER_DATA_STREAM_ENCODING_SNORM16_BOUNDS:
+        {
+            result = (n_components >= 1 && n_components <= 4);
+
+            break;
+        }
+
+        case MESH_LAYER_DATA_STREAM_ENCODING_OCTAHEDRAL_SNORM16:
+        {
+            result = (n_components == 3);
+
+            break;
+        }
+
+        default:
+        {
+            result = false;
+        }
+    }
+
+    return result;
+}
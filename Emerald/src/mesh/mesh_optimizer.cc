@@ -0,0 +1,736 @@
+/**
+ *
+ * Emerald (kbi/elude @2016)
+ *
+ */
+#include "shared.h"
+#include "mesh/mesh_optimizer.h"
+#include "system/system_log.h"
+#include "system/system_math_vector.h"
+#include "system/system_resizable_vector.h"
+#include <math.h>
+#include <string.h>
+
+/* Vertex scoring constants, as suggested by Tom Forsyth */
+#define FORSYTH_CACHE_DECAY_POWER   (1.5f)
+#define FORSYTH_CACHE_SIZE          (32)
+#define FORSYTH_LAST_TRIANGLE_SCORE (0.75f)
+#define FORSYTH_N_VALENCE_SCORES    (32)
+#define FORSYTH_VALENCE_BOOST_POWER (0.5f)
+#define FORSYTH_VALENCE_BOOST_SCALE (2.0f)
+
+
+/** Describes a single cluster of triangles formed by mesh_optimizer_optimize_overdraw(). */
+typedef struct
+{
+    uint32_t first_triangle;
+    uint32_t n_triangles;
+    float    sort_key;
+} _mesh_optimizer_cluster;
+
+/** Vertex scoring tables used by mesh_optimizer_optimize_vertex_cache() */
+typedef struct
+{
+    float cache_position_scores[FORSYTH_CACHE_SIZE];
+    float valence_scores       [FORSYTH_N_VALENCE_SCORES];
+} _mesh_optimizer_vertex_scores;
+
+
+/** Forward declarations */
+PRIVATE uint32_t _mesh_optimizer_add_triangle_to_fifo_cache(const uint32_t*                      triangle_indices,
+                                                            uint32_t*                            cache_timestamps,
+                                                            uint32_t*                            timestamp_ptr);
+PRIVATE bool     _mesh_optimizer_compare_clusters          (const void*                          cluster_1,
+                                                            const void*                          cluster_2);
+PRIVATE float    _mesh_optimizer_get_vertex_score          (const _mesh_optimizer_vertex_scores* scores_ptr,
+                                                            int                                  cache_position,
+                                                            uint32_t                             valence);
+PRIVATE void     _mesh_optimizer_init_vertex_scores        (_mesh_optimizer_vertex_scores*       scores_ptr);
+
+
+/** Adds vertices of a triangle to a simulated FIFO cache of MESH_OPTIMIZER_FIFO_CACHE_SIZE entries. A vertex
+ *  is considered present in the cache, if it was inserted no earlier than MESH_OPTIMIZER_FIFO_CACHE_SIZE
+ *  insertions ago. The cache can be flushed by increasing the timestamp by MESH_OPTIMIZER_FIFO_CACHE_SIZE + 1.
+ *
+ *  @param triangle_indices Indices of the triangle's vertices.
+ *  @param cache_timestamps Insertion timestamp of each vertex.
+ *  @param timestamp_ptr    Current timestamp. Will be increased for each inserted vertex.
+ *
+ *  @return Number of cache misses.
+ */
+PRIVATE uint32_t _mesh_optimizer_add_triangle_to_fifo_cache(const uint32_t* triangle_indices,
+                                                            uint32_t*       cache_timestamps,
+                                                            uint32_t*       timestamp_ptr)
+{
+    uint32_t n_misses = 0;
+
+    for (uint32_t n_vertex = 0;
+                  n_vertex < 3;
+                ++n_vertex)
+    {
+        const uint32_t vertex = triangle_indices[n_vertex];
+
+        if (*timestamp_ptr - cache_timestamps[vertex] > MESH_OPTIMIZER_FIFO_CACHE_SIZE)
+        {
+            cache_timestamps[vertex] = (*timestamp_ptr)++;
+
+            ++n_misses;
+        }
+    }
+
+    return n_misses;
+}
+
+/** Comparator used to sort overdraw clusters. Clusters with larger sort keys go first. Ties are broken
+ *  by the cluster's location, so that the result does not depend on the sort implementation. */
+PRIVATE bool _mesh_optimizer_compare_clusters(const void* cluster_1,
+                                              const void* cluster_2)
+{
+    const _mesh_optimizer_cluster* cluster_1_ptr = reinterpret_cast<const _mesh_optimizer_cluster*>(cluster_1);
+    const _mesh_optimizer_cluster* cluster_2_ptr = reinterpret_cast<const _mesh_optimizer_cluster*>(cluster_2);
+
+    if (cluster_1_ptr->sort_key != cluster_2_ptr->sort_key)
+    {
+        return cluster_1_ptr->sort_key > cluster_2_ptr->sort_key;
+    }
+
+    return cluster_1_ptr->first_triangle < cluster_2_ptr->first_triangle;
+}
+
+/** Returns the score of a vertex, depending on its position in the simulated LRU cache and the number
+ *  of triangles which still use it. */
+PRIVATE float _mesh_optimizer_get_vertex_score(const _mesh_optimizer_vertex_scores* scores_ptr,
+                                               int                                  cache_position,
+                                               uint32_t                             valence)
+{
+    float result = 0.0f;
+
+    if (valence == 0)
+    {
+        /* No triangle needs this vertex anymore */
+        return -1.0f;
+    }
+
+    if (cache_position >= 0)
+    {
+        result = scores_ptr->cache_position_scores[cache_position];
+    }
+
+    result += scores_ptr->valence_scores[(valence < FORSYTH_N_VALENCE_SCORES) ? valence
+                                                                                : FORSYTH_N_VALENCE_SCORES - 1];
+
+    return result;
+}
+
+/** Fills vertex scoring tables. */
+PRIVATE void _mesh_optimizer_init_vertex_scores(_mesh_optimizer_vertex_scores* scores_ptr)
+{
+    for (uint32_t n_cache_position = 0;
+                  n_cache_position < FORSYTH_CACHE_SIZE;
+                ++n_cache_position)
+    {
+        /* Vertices used by the most recently added triangle get a fixed score, so that the algorithm does not
+         * favor any of that triangle's edges. */
+        if (n_cache_position < 3)
+        {
+            scores_ptr->cache_position_scores[n_cache_position] = FORSYTH_LAST_TRIANGLE_SCORE;
+        }
+        else
+        {
+            scores_ptr->cache_position_scores[n_cache_position] = powf(1.0f - float(n_cache_position - 3) / float(FORSYTH_CACHE_SIZE - 3),
+                                                                       FORSYTH_CACHE_DECAY_POWER);
+        }
+    }
+
+    /* Vertices with few triangles left are boosted, so that lone triangles do not get left behind */
+    scores_ptr->valence_scores[0] = 0.0f;
+
+    for (uint32_t n_valence = 1;
+                  n_valence < FORSYTH_N_VALENCE_SCORES;
+                ++n_valence)
+    {
+        scores_ptr->valence_scores[n_valence] = FORSYTH_VALENCE_BOOST_SCALE * powf(float(n_valence),
+                                                                                   -FORSYTH_VALENCE_BOOST_POWER);
+    }
+}
+
+
+/** Please see header for specification */
+PUBLIC EMERALD_API void mesh_optimizer_get_vertex_cache_statistics(const uint32_t* index_data,
+                                                                   uint32_t        n_indices,
+                                                                   uint32_t        n_vertices,
+                                                                   uint32_t*       out_n_transformed_vertices_ptr,
+                                                                   uint32_t*       out_n_used_vertices_ptr)
+{
+    uint32_t* cache_timestamps = new (std::nothrow) uint32_t[n_vertices];
+    uint32_t  timestamp        = MESH_OPTIMIZER_FIFO_CACHE_SIZE + 1;
+
+    ASSERT_ALWAYS_SYNC(cache_timestamps != nullptr,
+                       "Out of memory");
+    ASSERT_DEBUG_SYNC(n_indices % 3 == 0,
+                      "Index data does not describe a triangle list");
+
+    memset(cache_timestamps,
+           0,
+           sizeof(uint32_t) * n_vertices);
+
+    *out_n_transformed_vertices_ptr = 0;
+    *out_n_used_vertices_ptr        = 0;
+
+    for (uint32_t n_index = 0;
+                  n_index + 2 < n_indices;
+                  n_index += 3)
+    {
+        *out_n_transformed_vertices_ptr += _mesh_optimizer_add_triangle_to_fifo_cache(index_data + n_index,
+                                                                                      cache_timestamps,
+                                                                                     &timestamp);
+    }
+
+    for (uint32_t n_vertex = 0;
+                  n_vertex < n_vertices;
+                ++n_vertex)
+    {
+        if (cache_timestamps[n_vertex] != 0)
+        {
+            ++(*out_n_used_vertices_ptr);
+        }
+    }
+
+    delete [] cache_timestamps;
+}
+
+/** Please see header for specification */
+PUBLIC EMERALD_API uint32_t mesh_optimizer_get_vertex_fetch_remap(const uint32_t* index_data,
+                                                                  uint32_t        n_indices,
+                                                                  uint32_t        n_vertices,
+                                                                  uint32_t*       out_remap)
+{
+    uint32_t n_remapped_vertices = 0;
+    uint32_t result              = 0;
+
+    memset(out_remap,
+           0xFF,
+           sizeof(uint32_t) * n_vertices);
+
+    for (uint32_t n_index = 0;
+                  n_index < n_indices;
+                ++n_index)
+    {
+        ASSERT_DEBUG_SYNC(index_data[n_index] < n_vertices,
+                          "Invalid index");
+
+        if (out_remap[index_data[n_index] ] == UINT32_MAX)
+        {
+            out_remap[index_data[n_index] ] = n_remapped_vertices++;
+        }
+    }
+
+    result = n_remapped_vertices;
+
+    for (uint32_t n_vertex = 0;
+                  n_vertex < n_vertices;
+                ++n_vertex)
+    {
+        if (out_remap[n_vertex] == UINT32_MAX)
+        {
+            out_remap[n_vertex] = n_remapped_vertices++;
+        }
+    }
+
+    return result;
+}
+
+/** Please see header for specification */
+PUBLIC EMERALD_API void mesh_optimizer_optimize_overdraw(uint32_t*    index_data,
+                                                         uint32_t     n_indices,
+                                                         uint32_t     n_vertices,
+                                                         const float* vertex_data,
+                                                         uint32_t     vertex_stride,
+                                                         float        threshold)
+{
+    uint32_t*                cache_timestamps  = nullptr;
+    _mesh_optimizer_cluster* clusters          = nullptr;
+    system_resizable_vector  clusters_sorted   = nullptr;
+    uint32_t*                hard_boundaries   = nullptr;
+    float                    mesh_centroid[3]  = {0.0f, 0.0f, 0.0f};
+    uint32_t                 n_clusters        = 0;
+    uint32_t                 n_hard_boundaries = 0;
+    const uint32_t           n_triangles       = n_indices / 3;
+    uint32_t*                result_index_data = nullptr;
+    uint32_t                 timestamp         = MESH_OPTIMIZER_FIFO_CACHE_SIZE + 1;
+
+    ASSERT_DEBUG_SYNC(n_indices % 3 == 0,
+                      "Index data does not describe a triangle list");
+
+    if (n_triangles < 2)
+    {
+        goto end;
+    }
+
+    cache_timestamps  = new (std::nothrow) uint32_t               [n_vertices];
+    clusters          = new (std::nothrow) _mesh_optimizer_cluster[n_triangles];
+    hard_boundaries   = new (std::nothrow) uint32_t               [n_triangles + 1];
+    result_index_data = new (std::nothrow) uint32_t               [n_indices];
+
+    ASSERT_ALWAYS_SYNC(cache_timestamps  != nullptr &&
+                       clusters          != nullptr &&
+                       hard_boundaries   != nullptr &&
+                       result_index_data != nullptr,
+                       "Out of memory");
+
+    memset(cache_timestamps,
+           0,
+           sizeof(uint32_t) * n_vertices);
+
+    /* 1. Split the triangle list at the triangles which miss the cache for all their vertices. Such triangles
+     *    start a new strip of vertex reuse, so moving the clusters around does not hurt cache efficiency. */
+    for (uint32_t n_triangle = 0;
+                  n_triangle < n_triangles;
+                ++n_triangle)
+    {
+        if (_mesh_optimizer_add_triangle_to_fifo_cache(index_data + 3 * n_triangle,
+                                                       cache_timestamps,
+                                                      &timestamp) == 3 ||
+            n_triangle                                             == 0)
+        {
+            hard_boundaries[n_hard_boundaries++] = n_triangle;
+        }
+    }
+
+    hard_boundaries[n_hard_boundaries] = n_triangles;
+
+    /* 2. Split the clusters further, for as long as the ACMR of the sub-clusters stays below the threshold
+     *    relative to the ACMR of the whole cluster. */
+    for (uint32_t n_hard_boundary = 0;
+                  n_hard_boundary < n_hard_boundaries;
+                ++n_hard_boundary)
+    {
+        const uint32_t cluster_end        = hard_boundaries[n_hard_boundary + 1];
+        const uint32_t cluster_start      = hard_boundaries[n_hard_boundary];
+        uint32_t       n_cluster_misses   = 0;
+        uint32_t       n_running_misses   = 0;
+        uint32_t       n_running_triangle = 0;
+        float          cluster_threshold  = 0.0f;
+
+        timestamp += MESH_OPTIMIZER_FIFO_CACHE_SIZE + 1;
+
+        for (uint32_t n_triangle = cluster_start;
+                      n_triangle < cluster_end;
+                    ++n_triangle)
+        {
+            n_cluster_misses += _mesh_optimizer_add_triangle_to_fifo_cache(index_data + 3 * n_triangle,
+                                                                           cache_timestamps,
+                                                                          &timestamp);
+        }
+
+        cluster_threshold = threshold * float(n_cluster_misses) / float(cluster_end - cluster_start);
+
+        clusters[n_clusters].first_triangle = cluster_start;
+        timestamp                          += MESH_OPTIMIZER_FIFO_CACHE_SIZE + 1;
+
+        for (uint32_t n_triangle = cluster_start;
+                      n_triangle < cluster_end;
+                    ++n_triangle)
+        {
+            n_running_misses   += _mesh_optimizer_add_triangle_to_fifo_cache(index_data + 3 * n_triangle,
+                                                                             cache_timestamps,
+                                                                            &timestamp);
+            n_running_triangle += 1;
+
+            if (float(n_running_misses) / float(n_running_triangle) <= cluster_threshold &&
+                n_triangle + 1                                      <  cluster_end)
+            {
+                /* The sub-cluster is good enough. Start a new one with the next triangle */
+                clusters[n_clusters].n_triangles = n_triangle + 1 - clusters[n_clusters].first_triangle;
+
+                ++n_clusters;
+
+                clusters[n_clusters].first_triangle = n_triangle + 1;
+                n_running_misses                    = 0;
+                n_running_triangle                  = 0;
+                timestamp                          += MESH_OPTIMIZER_FIFO_CACHE_SIZE + 1;
+            }
+        }
+
+        clusters[n_clusters].n_triangles = cluster_end - clusters[n_clusters].first_triangle;
+
+        ++n_clusters;
+    }
+
+    /* 3. Clusters which face away from the center of the mesh are likely to occlude other clusters,
+     *    so they should be drawn first. */
+    for (uint32_t n_index = 0;
+                  n_index < n_indices;
+                ++n_index)
+    {
+        const float* vertex = reinterpret_cast<const float*>(reinterpret_cast<const char*>(vertex_data) + vertex_stride * index_data[n_index]);
+
+        system_math_vector_add3(mesh_centroid,
+                                vertex,
+                                mesh_centroid);
+    }
+
+    system_math_vector_mul3_float(mesh_centroid,
+                                  1.0f / float(n_indices),
+                                  mesh_centroid);
+
+    clusters_sorted = system_resizable_vector_create(n_clusters);
+
+    for (uint32_t n_cluster = 0;
+                  n_cluster < n_clusters;
+                ++n_cluster)
+    {
+        float                    cluster_centroid[3] = {0.0f, 0.0f, 0.0f};
+        float                    cluster_normal  [3] = {0.0f, 0.0f, 0.0f};
+        _mesh_optimizer_cluster* cluster_ptr         = clusters + n_cluster;
+        float                    normal_length       = 0.0f;
+
+        for (uint32_t n_triangle = cluster_ptr->first_triangle;
+                      n_triangle < cluster_ptr->first_triangle + cluster_ptr->n_triangles;
+                    ++n_triangle)
+        {
+            float        edge_1  [3];
+            float        edge_2  [3];
+            float        normal  [3];
+            const float* vertices[3];
+
+            for (uint32_t n_vertex = 0;
+                          n_vertex < 3;
+                        ++n_vertex)
+            {
+                vertices[n_vertex] = reinterpret_cast<const float*>(reinterpret_cast<const char*>(vertex_data) + vertex_stride * index_data[3 * n_triangle + n_vertex]);
+
+                system_math_vector_add3(cluster_centroid,
+                                        vertices[n_vertex],
+                                        cluster_centroid);
+            }
+
+            /* The cross product's length is proportional to the triangle's area, so larger triangles
+             * affect the cluster's normal more. */
+            system_math_vector_minus3(vertices[1],
+                                      vertices[0],
+                                      edge_1);
+            system_math_vector_minus3(vertices[2],
+                                      vertices[0],
+                                      edge_2);
+            system_math_vector_cross3(edge_1,
+                                      edge_2,
+                                      normal);
+            system_math_vector_add3  (cluster_normal,
+                                      normal,
+                                      cluster_normal);
+        }
+
+        system_math_vector_mul3_float(cluster_centroid,
+                                      1.0f / float(3 * cluster_ptr->n_triangles),
+                                      cluster_centroid);
+        system_math_vector_minus3    (cluster_centroid,
+                                      mesh_centroid,
+                                      cluster_centroid);
+
+        normal_length          = system_math_vector_length3(cluster_normal);
+        cluster_ptr->sort_key = (normal_length > 0.0f) ? system_math_vector_dot3(cluster_centroid,
+                                                                                 cluster_normal) / normal_length
+                                                        : 0.0f;
+
+        system_resizable_vector_push(clusters_sorted,
+                                     cluster_ptr);
+    }
+
+    system_resizable_vector_sort(clusters_sorted,
+                                 _mesh_optimizer_compare_clusters);
+
+    /* 4. Store the triangles in the new order */
+    for (uint32_t n_cluster = 0,
+                  n_result_index = 0;
+                  n_cluster < n_clusters;
+                ++n_cluster)
+    {
+        const _mesh_optimizer_cluster* cluster_ptr = nullptr;
+
+        system_resizable_vector_get_element_at(clusters_sorted,
+                                               n_cluster,
+                                              &cluster_ptr);
+
+        memcpy(result_index_data + n_result_index,
+               index_data        + 3 * cluster_ptr->first_triangle,
+               sizeof(uint32_t) * 3 * cluster_ptr->n_triangles);
+
+        n_result_index += 3 * cluster_ptr->n_triangles;
+    }
+
+    memcpy(index_data,
+           result_index_data,
+           sizeof(uint32_t) * n_indices);
+
+    system_resizable_vector_release(clusters_sorted);
+
+end:
+    delete [] cache_timestamps;
+    delete [] clusters;
+    delete [] hard_boundaries;
+    delete [] result_index_data;
+}
+
+/** Please see header for specification */
+PUBLIC EMERALD_API void mesh_optimizer_optimize_vertex_cache(uint32_t* index_data,
+                                                             uint32_t  n_indices,
+                                                             uint32_t  n_vertices)
+{
+    uint32_t                      best_triangle           = UINT32_MAX;
+    float                         best_triangle_score     = -1.0f;
+    uint32_t                      cache[FORSYTH_CACHE_SIZE + 3];
+    uint32_t                      n_cache_vertices        = 0;
+    uint32_t                      n_next_input_triangle   = 0;
+    const uint32_t                n_triangles             = n_indices / 3;
+    _mesh_optimizer_vertex_scores scores;
+    uint32_t*                     result_index_data       = nullptr;
+    uint8_t*                      triangle_emitted        = nullptr;
+    float*                        triangle_scores         = nullptr;
+    uint32_t*                     vertex_adjacency        = nullptr; /* triangles which use each vertex. Triangles which have been emitted are moved to the end of each vertex' list */
+    uint32_t*                     vertex_adjacency_starts = nullptr;
+    int*                          vertex_cache_positions  = nullptr;
+    float*                        vertex_scores           = nullptr;
+    uint32_t*                     vertex_valences         = nullptr; /* number of triangles which still use each vertex */
+
+    ASSERT_DEBUG_SYNC(n_indices % 3 == 0,
+                      "Index data does not describe a triangle list");
+
+    if (n_triangles < 2)
+    {
+        return;
+    }
+
+    _mesh_optimizer_init_vertex_scores(&scores);
+
+    result_index_data       = new (std::nothrow) uint32_t[n_indices];
+    triangle_emitted        = new (std::nothrow) uint8_t [n_triangles];
+    triangle_scores         = new (std::nothrow) float   [n_triangles];
+    vertex_adjacency        = new (std::nothrow) uint32_t[n_indices];
+    vertex_adjacency_starts = new (std::nothrow) uint32_t[n_vertices + 1];
+    vertex_cache_positions  = new (std::nothrow) int     [n_vertices];
+    vertex_scores           = new (std::nothrow) float   [n_vertices];
+    vertex_valences         = new (std::nothrow) uint32_t[n_vertices];
+
+    ASSERT_ALWAYS_SYNC(result_index_data       != nullptr &&
+                       triangle_emitted        != nullptr &&
+                       triangle_scores         != nullptr &&
+                       vertex_adjacency        != nullptr &&
+                       vertex_adjacency_starts != nullptr &&
+                       vertex_cache_positions  != nullptr &&
+                       vertex_scores           != nullptr &&
+                       vertex_valences         != nullptr,
+                       "Out of memory");
+
+    /* Build vertex->triangle adjacency */
+    memset(triangle_emitted,
+           0,
+           sizeof(uint8_t) * n_triangles);
+    memset(vertex_valences,
+           0,
+           sizeof(uint32_t) * n_vertices);
+
+    for (uint32_t n_index = 0;
+                  n_index < n_indices;
+                ++n_index)
+    {
+        ASSERT_DEBUG_SYNC(index_data[n_index] < n_vertices,
+                          "Invalid index");
+
+        ++vertex_valences[index_data[n_index] ];
+    }
+
+    vertex_adjacency_starts[0] = 0;
+
+    for (uint32_t n_vertex = 0;
+                  n_vertex < n_vertices;
+                ++n_vertex)
+    {
+        vertex_adjacency_starts[n_vertex + 1] = vertex_adjacency_starts[n_vertex] + vertex_valences[n_vertex];
+        vertex_cache_positions [n_vertex]     = -1;
+        vertex_valences        [n_vertex]     = 0;
+    }
+
+    for (uint32_t n_index = 0;
+                  n_index < n_indices;
+                ++n_index)
+    {
+        const uint32_t vertex = index_data[n_index];
+
+        vertex_adjacency[vertex_adjacency_starts[vertex] + vertex_valences[vertex]++] = n_index / 3;
+    }
+
+    /* Calculate initial scores. Start with the best triangle */
+    for (uint32_t n_vertex = 0;
+                  n_vertex < n_vertices;
+                ++n_vertex)
+    {
+        vertex_scores[n_vertex] = _mesh_optimizer_get_vertex_score(&scores,
+                                                                   -1, /* cache_position */
+                                                                   vertex_valences[n_vertex]);
+    }
+
+    for (uint32_t n_triangle = 0;
+                  n_triangle < n_triangles;
+                ++n_triangle)
+    {
+        triangle_scores[n_triangle] = vertex_scores[index_data[3 * n_triangle + 0] ] +
+                                      vertex_scores[index_data[3 * n_triangle + 1] ] +
+                                      vertex_scores[index_data[3 * n_triangle + 2] ];
+
+        if (triangle_scores[n_triangle] > best_triangle_score)
+        {
+            best_triangle       = n_triangle;
+            best_triangle_score = triangle_scores[n_triangle];
+        }
+    }
+
+    /* Emit triangles one by one */
+    for (uint32_t n_emitted_triangle = 0;
+                  n_emitted_triangle < n_triangles;
+                ++n_emitted_triangle)
+    {
+        uint32_t        new_cache[FORSYTH_CACHE_SIZE + 3];
+        uint32_t        n_new_cache_vertices = 0;
+        const uint32_t* triangle_vertices    = nullptr;
+
+        if (best_triangle == UINT32_MAX)
+        {
+            /* None of the triangles using cached vertices is left. Carry on with the first triangle
+             * which has not been emitted yet. */
+            while (triangle_emitted[n_next_input_triangle])
+            {
+                ++n_next_input_triangle;
+            }
+
+            best_triangle = n_next_input_triangle;
+        }
+
+        triangle_vertices = index_data + 3 * best_triangle;
+
+        memcpy(result_index_data + 3 * n_emitted_triangle,
+               triangle_vertices,
+               sizeof(uint32_t) * 3);
+
+        triangle_emitted[best_triangle] = 1;
+
+        /* Detach the triangle from its vertices */
+        for (uint32_t n_vertex = 0;
+                      n_vertex < 3;
+                    ++n_vertex)
+        {
+            const uint32_t vertex           = triangle_vertices[n_vertex];
+            uint32_t*      adjacency_ptr    = vertex_adjacency + vertex_adjacency_starts[vertex];
+            const uint32_t n_last_adjacency = vertex_valences[vertex] - 1;
+
+            for (uint32_t n_adjacency = 0;
+                          n_adjacency <= n_last_adjacency;
+                        ++n_adjacency)
+            {
+                if (adjacency_ptr[n_adjacency] == best_triangle)
+                {
+                    adjacency_ptr[n_adjacency]      = adjacency_ptr[n_last_adjacency];
+                    adjacency_ptr[n_last_adjacency] = best_triangle;
+
+                    break;
+                }
+            }
+
+            --vertex_valences[vertex];
+        }
+
+        /* Move the triangle's vertices to the front of the cache */
+        for (uint32_t n_vertex = 0;
+                      n_vertex < 3;
+                    ++n_vertex)
+        {
+            const uint32_t vertex = triangle_vertices[n_vertex];
+
+            /* Degenerate triangles may use the same vertex more than once */
+            if ( n_new_cache_vertices == 0                                                     ||
+                (new_cache[0]         != vertex && (n_new_cache_vertices == 1 || new_cache[1] != vertex)) )
+            {
+                new_cache[n_new_cache_vertices++] = vertex;
+            }
+        }
+
+        for (uint32_t n_cache_vertex = 0;
+                      n_cache_vertex < n_cache_vertices;
+                    ++n_cache_vertex)
+        {
+            const uint32_t vertex = cache[n_cache_vertex];
+
+            if (vertex != triangle_vertices[0] &&
+                vertex != triangle_vertices[1] &&
+                vertex != triangle_vertices[2])
+            {
+                new_cache[n_new_cache_vertices++] = vertex;
+            }
+        }
+
+        /* Update scores of all vertices which were or still are cached. The vertices which no longer fit
+         * in the cache are evicted. */
+        for (uint32_t n_cache_vertex = 0;
+                      n_cache_vertex < n_new_cache_vertices;
+                    ++n_cache_vertex)
+        {
+            const uint32_t vertex = new_cache[n_cache_vertex];
+
+            vertex_cache_positions[vertex] = (n_cache_vertex < FORSYTH_CACHE_SIZE) ? static_cast<int>(n_cache_vertex)
+                                                                                   : -1;
+            vertex_scores         [vertex] = _mesh_optimizer_get_vertex_score(&scores,
+                                                                              vertex_cache_positions[vertex],
+                                                                              vertex_valences       [vertex]);
+        }
+
+        /* Look for the best triangle to emit next among the triangles which use the updated vertices */
+        best_triangle       = UINT32_MAX;
+        best_triangle_score = -1.0f;
+
+        for (uint32_t n_cache_vertex = 0;
+                      n_cache_vertex < n_new_cache_vertices;
+                    ++n_cache_vertex)
+        {
+            const uint32_t  vertex        = new_cache[n_cache_vertex];
+            const uint32_t* adjacency_ptr = vertex_adjacency + vertex_adjacency_starts[vertex];
+
+            for (uint32_t n_adjacency = 0;
+                          n_adjacency < vertex_valences[vertex];
+                        ++n_adjacency)
+            {
+                const uint32_t n_triangle = adjacency_ptr[n_adjacency];
+
+                triangle_scores[n_triangle] = vertex_scores[index_data[3 * n_triangle + 0] ] +
+                                              vertex_scores[index_data[3 * n_triangle + 1] ] +
+                                              vertex_scores[index_data[3 * n_triangle + 2] ];
+
+                if ( triangle_scores[n_triangle] >  best_triangle_score                              ||
+                    (triangle_scores[n_triangle] == best_triangle_score && n_triangle < best_triangle))
+                {
+                    best_triangle       = n_triangle;
+                    best_triangle_score = triangle_scores[n_triangle];
+                }
+            }
+        }
+
+        n_cache_vertices = (n_new_cache_vertices < FORSYTH_CACHE_SIZE) ? n_new_cache_vertices
+                                                                       : FORSYTH_CACHE_SIZE;
+
+        memcpy(cache,
+               new_cache,
+               sizeof(uint32_t) * n_cache_vertices);
+    }
+
+    memcpy(index_data,
+           result_index_data,
+           sizeof(uint32_t) * n_indices);
+
+    delete [] result_index_data;
+    delete [] triangle_emitted;
+    delete [] triangle_scores;
+    delete [] vertex_adjacency;
+    delete [] vertex_adjacency_starts;
+    delete [] vertex_cache_positions;
+    delete [] vertex_scores;
+    delete [] vertex_valences;
+}
@@ -0,0 +1,913 @@
+/**
+ *
+ * Emerald (kbi/elude @2016)
+ *
+ */
+#include "shared.h"
+#include "mesh/mesh_simplifier.h"
+#include "system/system_log.h"
+#include "system/system_math_vector.h"
+#include "system/system_resizable_vector.h"
+#include <math.h>
+#include <string.h>
+
+/* Edges are collapsed in passes. Within a pass, each location may only be affected by a single collapse.
+ * A pass skips all collapses whose error exceeds the error of the collapse which would have been picked
+ * last, if all collapses needed to reach the target could be done in that pass, by more than this factor.
+ * This keeps expensive collapses from being picked just because cheaper ones are blocked by their
+ * neighbours in the current pass. */
+#define SIMPLIFIER_PASS_ERROR_LIMIT_SCALE (1.5f)
+
+
+/** Describes a collapse of a location onto one of its neighbours. */
+typedef struct
+{
+    float    cost;            /* squared error */
+    uint32_t source_location;
+    uint32_t target_vertex;
+} _mesh_simplifier_collapse;
+
+/** Symmetric 4x4 matrix, which evaluates the sum of squared distances to a set of planes. */
+typedef struct
+{
+    double a00;
+    double a01;
+    double a02;
+    double a11;
+    double a12;
+    double a22;
+    double b0;
+    double b1;
+    double b2;
+    double c;
+} _mesh_simplifier_quadric;
+
+/** Working state of mesh_simplifier_simplify(). All vertices which share a location are represented by
+ *  the first of them used by the triangle list, referred to as the location below. Adjacency, locks
+ *  and quadrics are only maintained for locations. */
+typedef struct
+{
+    uint32_t*                 adjacency_offsets;   /* n_vertices + 1 offsets into adjacency_triangles */
+    uint32_t*                 adjacency_triangles; /* triangles which use each location */
+    uint32_t*                 index_data;
+    uint8_t*                  is_location_locked;  /* seam & border locations, which must not be removed */
+    uint32_t*                 locations;           /* maps each vertex to its location */
+    uint32_t                  n_indices;
+    uint32_t                  n_vertices;
+    uint32_t                  neighbour_stamp;
+    uint32_t*                 neighbour_stamps;
+    _mesh_simplifier_quadric* quadrics;
+    const float*              vertex_data;
+    uint32_t                  vertex_stride;
+} _mesh_simplifier_state;
+
+
+/** Forward declarations */
+PRIVATE void         _mesh_simplifier_add_plane_quadric  (_mesh_simplifier_quadric*       quadric_ptr,
+                                                          const float*                    triangle_locations[3]);
+PRIVATE void         _mesh_simplifier_add_quadric        (_mesh_simplifier_quadric*       dst_quadric_ptr,
+                                                          const _mesh_simplifier_quadric* src_quadric_ptr);
+PRIVATE void         _mesh_simplifier_build_adjacency    (_mesh_simplifier_state*         state_ptr);
+PRIVATE void         _mesh_simplifier_build_locations    (_mesh_simplifier_state*         state_ptr);
+PRIVATE bool         _mesh_simplifier_compare_collapses  (const void*                     collapse_1,
+                                                          const void*                     collapse_2);
+PRIVATE float        _mesh_simplifier_evaluate_quadric   (const _mesh_simplifier_quadric* quadric_ptr,
+                                                          const float*                    location);
+PRIVATE const float* _mesh_simplifier_get_location       (const _mesh_simplifier_state*   state_ptr,
+                                                          uint32_t                        n_vertex);
+PRIVATE bool         _mesh_simplifier_is_collapse_valid  (_mesh_simplifier_state*         state_ptr,
+                                                          uint32_t                        source_location,
+                                                          uint32_t                        target_vertex);
+PRIVATE bool         _mesh_simplifier_is_triangle_flipped(const float*                    triangle_locations[3],
+                                                          uint32_t                        n_moved_vertex,
+                                                          const float*                    new_location);
+
+
+/** Adds the quadric of a triangle's plane to @param quadric_ptr. All planes contribute equally, so the
+ *  quadric tells the sum of squared distances to the planes. Degenerate triangles are ignored. */
+PRIVATE void _mesh_simplifier_add_plane_quadric(_mesh_simplifier_quadric* quadric_ptr,
+                                                const float*              triangle_locations[3])
+{
+    float edge_1[3];
+    float edge_2[3];
+    float normal[3];
+    float normal_length = 0.0f;
+    float plane_distance;
+
+    system_math_vector_minus3(triangle_locations[1],
+                              triangle_locations[0],
+                              edge_1);
+    system_math_vector_minus3(triangle_locations[2],
+                              triangle_locations[0],
+                              edge_2);
+    system_math_vector_cross3(edge_1,
+                              edge_2,
+                              normal);
+
+    normal_length = system_math_vector_length3(normal);
+
+    if (normal_length <= 0.0f)
+    {
+        return;
+    }
+
+    system_math_vector_mul3_float(normal,
+                                  1.0f / normal_length,
+                                  normal);
+
+    plane_distance = -system_math_vector_dot3(normal,
+                                              triangle_locations[0]);
+
+    quadric_ptr->a00 += double(normal[0]) * normal[0];
+    quadric_ptr->a01 += double(normal[0]) * normal[1];
+    quadric_ptr->a02 += double(normal[0]) * normal[2];
+    quadric_ptr->a11 += double(normal[1]) * normal[1];
+    quadric_ptr->a12 += double(normal[1]) * normal[2];
+    quadric_ptr->a22 += double(normal[2]) * normal[2];
+    quadric_ptr->b0  += double(normal[0]) * plane_distance;
+    quadric_ptr->b1  += double(normal[1]) * plane_distance;
+    quadric_ptr->b2  += double(normal[2]) * plane_distance;
+    quadric_ptr->c   += double(plane_distance) * plane_distance;
+}
+
+/** Adds @param src_quadric_ptr to @param dst_quadric_ptr. */
+PRIVATE void _mesh_simplifier_add_quadric(_mesh_simplifier_quadric*       dst_quadric_ptr,
+                                          const _mesh_simplifier_quadric* src_quadric_ptr)
+{
+    dst_quadric_ptr->a00 += src_quadric_ptr->a00;
+    dst_quadric_ptr->a01 += src_quadric_ptr->a01;
+    dst_quadric_ptr->a02 += src_quadric_ptr->a02;
+    dst_quadric_ptr->a11 += src_quadric_ptr->a11;
+    dst_quadric_ptr->a12 += src_quadric_ptr->a12;
+    dst_quadric_ptr->a22 += src_quadric_ptr->a22;
+    dst_quadric_ptr->b0  += src_quadric_ptr->b0;
+    dst_quadric_ptr->b1  += src_quadric_ptr->b1;
+    dst_quadric_ptr->b2  += src_quadric_ptr->b2;
+    dst_quadric_ptr->c   += src_quadric_ptr->c;
+}
+
+/** Builds location->triangle adjacency for the current index data. */
+PRIVATE void _mesh_simplifier_build_adjacency(_mesh_simplifier_state* state_ptr)
+{
+    memset(state_ptr->adjacency_offsets,
+           0,
+           sizeof(uint32_t) * (state_ptr->n_vertices + 1) );
+
+    for (uint32_t n_index = 0;
+                  n_index < state_ptr->n_indices;
+                ++n_index)
+    {
+        ++state_ptr->adjacency_offsets[state_ptr->locations[state_ptr->index_data[n_index] ] + 1];
+    }
+
+    for (uint32_t n_vertex = 1;
+                  n_vertex <= state_ptr->n_vertices;
+                ++n_vertex)
+    {
+        state_ptr->adjacency_offsets[n_vertex] += state_ptr->adjacency_offsets[n_vertex - 1];
+    }
+
+    /* Each location's offset is moved to the end of its range while the triangles are stored, so that it
+     * becomes the start offset of the next location. Shift the offsets back afterward. */
+    for (uint32_t n_index = 0;
+                  n_index < state_ptr->n_indices;
+                ++n_index)
+    {
+        const uint32_t location = state_ptr->locations[state_ptr->index_data[n_index] ];
+
+        state_ptr->adjacency_triangles[state_ptr->adjacency_offsets[location]++] = n_index / 3;
+    }
+
+    for (uint32_t n_vertex = state_ptr->n_vertices;
+                  n_vertex > 0;
+                --n_vertex)
+    {
+        state_ptr->adjacency_offsets[n_vertex] = state_ptr->adjacency_offsets[n_vertex - 1];
+    }
+
+    state_ptr->adjacency_offsets[0] = 0;
+}
+
+/** Groups the vertices used by the triangle list by their location, using a hash table. Locations which
+ *  are shared by more than one vertex describe attribute seams, so they are locked. Vertices which are not
+ *  used by the triangle list are assigned their own locations. */
+PRIVATE void _mesh_simplifier_build_locations(_mesh_simplifier_state* state_ptr)
+{
+    uint32_t  n_slots = 1;
+    uint32_t* slots   = nullptr;
+
+    while (n_slots < 2 * state_ptr->n_vertices)
+    {
+        n_slots <<= 1;
+    }
+
+    slots = new (std::nothrow) uint32_t[n_slots];
+
+    ASSERT_ALWAYS_SYNC(slots != nullptr,
+                       "Out of memory");
+
+    memset(slots,
+           0xFF,
+           sizeof(uint32_t) * n_slots);
+    memset(state_ptr->locations,
+           0xFF,
+           sizeof(uint32_t) * state_ptr->n_vertices);
+
+    for (uint32_t n_index = 0;
+                  n_index < state_ptr->n_indices;
+                ++n_index)
+    {
+        const uint32_t vertex          = state_ptr->index_data[n_index];
+        uint32_t       location_hash   = 0;
+        const float*   vertex_location = _mesh_simplifier_get_location(state_ptr,
+                                                                       vertex);
+        uint32_t       n_slot          = 0;
+
+        if (state_ptr->locations[vertex] != UINT32_MAX)
+        {
+            continue;
+        }
+
+        for (uint32_t n_component = 0;
+                      n_component < 3;
+                    ++n_component)
+        {
+            /* -0.0 and 0.0 describe the same location, so they must hash the same way */
+            const float component = (vertex_location[n_component] == 0.0f) ? 0.0f
+                                                                            : vertex_location[n_component];
+            uint32_t    component_bits;
+
+            memcpy(&component_bits,
+                   &component,
+                   sizeof(component_bits) );
+
+            location_hash = (location_hash ^ component_bits) * 0x9E3779B1;
+        }
+
+        location_hash ^= location_hash >> 16;
+        n_slot         = location_hash & (n_slots - 1);
+
+        while (slots[n_slot] != UINT32_MAX)
+        {
+            const float* slot_location = _mesh_simplifier_get_location(state_ptr,
+                                                                       slots[n_slot]);
+
+            if (slot_location[0] == vertex_location[0] &&
+                slot_location[1] == vertex_location[1] &&
+                slot_location[2] == vertex_location[2])
+            {
+                break;
+            }
+
+            n_slot = (n_slot + 1) & (n_slots - 1);
+        }
+
+        if (slots[n_slot] == UINT32_MAX)
+        {
+            slots[n_slot]                = vertex;
+            state_ptr->locations[vertex] = vertex;
+        }
+        else
+        {
+            state_ptr->is_location_locked[slots[n_slot] ] = 1;
+            state_ptr->locations         [vertex]         = slots[n_slot];
+        }
+    }
+
+    for (uint32_t n_vertex = 0;
+                  n_vertex < state_ptr->n_vertices;
+                ++n_vertex)
+    {
+        if (state_ptr->locations[n_vertex] == UINT32_MAX)
+        {
+            state_ptr->locations[n_vertex] = n_vertex;
+        }
+    }
+
+    delete [] slots;
+}
+
+/** Comparator used to sort collapses. Cheaper collapses go first. Ties are broken by the source location,
+ *  so that the result does not depend on the sort implementation. */
+PRIVATE bool _mesh_simplifier_compare_collapses(const void* collapse_1,
+                                                const void* collapse_2)
+{
+    const _mesh_simplifier_collapse* collapse_1_ptr = reinterpret_cast<const _mesh_simplifier_collapse*>(collapse_1);
+    const _mesh_simplifier_collapse* collapse_2_ptr = reinterpret_cast<const _mesh_simplifier_collapse*>(collapse_2);
+
+    if (collapse_1_ptr->cost != collapse_2_ptr->cost)
+    {
+        return collapse_1_ptr->cost < collapse_2_ptr->cost;
+    }
+
+    return collapse_1_ptr->source_location < collapse_2_ptr->source_location;
+}
+
+/** Returns the sum of squared distances between @param location and the planes described by a quadric. */
+PRIVATE float _mesh_simplifier_evaluate_quadric(const _mesh_simplifier_quadric* quadric_ptr,
+                                                const float*                    location)
+{
+    const double x      = location[0];
+    const double y      = location[1];
+    const double z      = location[2];
+    const double result = quadric_ptr->a00 * x * x + quadric_ptr->a11 * y * y + quadric_ptr->a22 * z * z +
+                          2.0 * (quadric_ptr->a01 * x * y + quadric_ptr->a02 * x * z + quadric_ptr->a12 * y * z) +
+                          2.0 * (quadric_ptr->b0  * x     + quadric_ptr->b1  * y     + quadric_ptr->b2  * z)     +
+                          quadric_ptr->c;
+
+    /* Rounding errors may make the result slightly negative */
+    return (result > 0.0) ? float(result)
+                          : 0.0f;
+}
+
+/** Returns the location of the specified vertex. */
+PRIVATE const float* _mesh_simplifier_get_location(const _mesh_simplifier_state* state_ptr,
+                                                   uint32_t                      n_vertex)
+{
+    return reinterpret_cast<const float*>(reinterpret_cast<const char*>(state_ptr->vertex_data) + state_ptr->vertex_stride * n_vertex);
+}
+
+/** Tells whether a location can be collapsed onto the specified vertex. */
+PRIVATE bool _mesh_simplifier_is_collapse_valid(_mesh_simplifier_state* state_ptr,
+                                                uint32_t                source_location,
+                                                uint32_t                target_vertex)
+{
+    const float*    new_location    = _mesh_simplifier_get_location(state_ptr,
+                                                                    target_vertex);
+    uint32_t        n_shared        = 0;
+    const uint32_t* source_end_ptr  = state_ptr->adjacency_triangles + state_ptr->adjacency_offsets[source_location + 1];
+    const uint32_t* source_ptr      = state_ptr->adjacency_triangles + state_ptr->adjacency_offsets[source_location];
+    const uint32_t  target_location = state_ptr->locations[target_vertex];
+    const uint32_t* target_end_ptr  = state_ptr->adjacency_triangles + state_ptr->adjacency_offsets[target_location + 1];
+    const uint32_t* target_ptr      = state_ptr->adjacency_triangles + state_ptr->adjacency_offsets[target_location];
+
+    /* Each check uses two stamp values: one for neighbours of the source location, and one for the neighbours
+     * which have already been found to be shared with the target location. */
+    if (state_ptr->neighbour_stamp >= UINT32_MAX - 2)
+    {
+        memset(state_ptr->neighbour_stamps,
+               0,
+               sizeof(uint32_t) * state_ptr->n_vertices);
+
+        state_ptr->neighbour_stamp = 0;
+    }
+
+    state_ptr->neighbour_stamp += 2;
+
+    /* 1. The only locations adjacent to both ends of the edge must be the ones opposite to the edge.
+     *    Otherwise the collapse would fold the surface onto itself. */
+    for (const uint32_t* triangle_ptr  = source_ptr;
+                         triangle_ptr != source_end_ptr;
+                       ++triangle_ptr)
+    {
+        for (uint32_t n_corner = 0;
+                      n_corner < 3;
+                    ++n_corner)
+        {
+            const uint32_t location = state_ptr->locations[state_ptr->index_data[3 * (*triangle_ptr) + n_corner] ];
+
+            if (location != source_location)
+            {
+                state_ptr->neighbour_stamps[location] = state_ptr->neighbour_stamp;
+            }
+        }
+    }
+
+    for (const uint32_t* triangle_ptr  = target_ptr;
+                         triangle_ptr != target_end_ptr;
+                       ++triangle_ptr)
+    {
+        for (uint32_t n_corner = 0;
+                      n_corner < 3;
+                    ++n_corner)
+        {
+            const uint32_t location = state_ptr->locations[state_ptr->index_data[3 * (*triangle_ptr) + n_corner] ];
+
+            if (location                              != target_location            &&
+                state_ptr->neighbour_stamps[location] == state_ptr->neighbour_stamp)
+            {
+                state_ptr->neighbour_stamps[location] = state_ptr->neighbour_stamp + 1;
+
+                ++n_shared;
+            }
+        }
+    }
+
+    if (n_shared > 2)
+    {
+        return false;
+    }
+
+    /* 2. Triangles which are not removed by the collapse must not flip */
+    for (const uint32_t* triangle_ptr  = source_ptr;
+                         triangle_ptr != source_end_ptr;
+                       ++triangle_ptr)
+    {
+        const uint32_t* triangle_index_ptr    = state_ptr->index_data + 3 * (*triangle_ptr);
+        const float*    triangle_locations[3];
+        uint32_t        n_moved_vertex        = 0;
+        bool            is_removed            = false;
+
+        for (uint32_t n_corner = 0;
+                      n_corner < 3;
+                    ++n_corner)
+        {
+            const uint32_t location = state_ptr->locations[triangle_index_ptr[n_corner] ];
+
+            if (location == target_location)
+            {
+                is_removed = true;
+            }
+            else
+            if (location == source_location)
+            {
+                n_moved_vertex = n_corner;
+            }
+
+            triangle_locations[n_corner] = _mesh_simplifier_get_location(state_ptr,
+                                                                         triangle_index_ptr[n_corner]);
+        }
+
+        if (is_removed)
+        {
+            continue;
+        }
+
+        if (_mesh_simplifier_is_triangle_flipped(triangle_locations,
+                                                 n_moved_vertex,
+                                                 new_location) )
+        {
+            return false;
+        }
+    }
+
+    return true;
+}
+
+/** Tells whether moving a vertex of a triangle would flip the triangle, or make it degenerate. */
+PRIVATE bool _mesh_simplifier_is_triangle_flipped(const float* triangle_locations[3],
+                                                  uint32_t     n_moved_vertex,
+                                                  const float* new_location)
+{
+    float        edge_1    [3];
+    float        edge_2    [3];
+    const float* new_triangle_locations[3] = {triangle_locations[0], triangle_locations[1], triangle_locations[2]};
+    float        new_normal[3];
+    float        normal    [3];
+
+    new_triangle_locations[n_moved_vertex] = new_location;
+
+    system_math_vector_minus3(triangle_locations[1],
+                              triangle_locations[0],
+                              edge_1);
+    system_math_vector_minus3(triangle_locations[2],
+                              triangle_locations[0],
+                              edge_2);
+    system_math_vector_cross3(edge_1,
+                              edge_2,
+                              normal);
+
+    system_math_vector_minus3(new_triangle_locations[1],
+                              new_triangle_locations[0],
+                              edge_1);
+    system_math_vector_minus3(new_triangle_locations[2],
+                              new_triangle_locations[0],
+                              edge_2);
+    system_math_vector_cross3(edge_1,
+                              edge_2,
+                              new_normal);
+
+    return system_math_vector_dot3(normal,
+                                   new_normal) <= 0.0f;
+}
+
+
+/** Please see header for specification */
+PUBLIC EMERALD_API uint32_t mesh_simplifier_simplify(const uint32_t* index_data,
+                                                     uint32_t        n_indices,
+                                                     uint32_t        n_vertices,
+                                                     const float*    vertex_data,
+                                                     uint32_t        vertex_stride,
+                                                     uint32_t        target_n_indices,
+                                                     uint32_t*       out_index_data,
+                                                     float*          out_error_ptr)
+{
+    _mesh_simplifier_collapse* collapses          = nullptr;
+    system_resizable_vector    collapses_sorted   = nullptr;
+    uint32_t*                  location_passes    = nullptr; /* last pass, in which each location was affected by a collapse */
+    float                      max_cost           = 0.0f;
+    uint32_t                   n_pass             = 0;
+    _mesh_simplifier_state     state;
+    uint32_t*                  vertex_remap       = nullptr;
+
+    ASSERT_DEBUG_SYNC(n_indices % 3 == 0,
+                      "Index data does not describe a triangle list");
+
+    if (target_n_indices >= n_indices)
+    {
+        if (out_index_data != index_data)
+        {
+            memcpy(out_index_data,
+                   index_data,
+                   sizeof(uint32_t) * n_indices);
+        }
+
+        if (out_error_ptr != nullptr)
+        {
+            *out_error_ptr = 0.0f;
+        }
+
+        return n_indices;
+    }
+
+    collapses                  = new (std::nothrow) _mesh_simplifier_collapse[n_vertices];
+    location_passes            = new (std::nothrow) uint32_t                 [n_vertices];
+    state.adjacency_offsets    = new (std::nothrow) uint32_t                 [n_vertices + 1];
+    state.adjacency_triangles  = new (std::nothrow) uint32_t                 [n_indices];
+    state.index_data           = new (std::nothrow) uint32_t                 [n_indices];
+    state.is_location_locked   = new (std::nothrow) uint8_t                  [n_vertices];
+    state.locations            = new (std::nothrow) uint32_t                 [n_vertices];
+    state.n_indices            = 0;
+    state.n_vertices           = n_vertices;
+    state.neighbour_stamp      = 0;
+    state.neighbour_stamps     = new (std::nothrow) uint32_t                 [n_vertices];
+    state.quadrics             = new (std::nothrow) _mesh_simplifier_quadric [n_vertices];
+    state.vertex_data          = vertex_data;
+    state.vertex_stride        = vertex_stride;
+    vertex_remap               = new (std::nothrow) uint32_t                 [n_vertices];
+
+    ASSERT_ALWAYS_SYNC(collapses                 != nullptr &&
+                       location_passes           != nullptr &&
+                       state.adjacency_offsets   != nullptr &&
+                       state.adjacency_triangles != nullptr &&
+                       state.index_data          != nullptr &&
+                       state.is_location_locked  != nullptr &&
+                       state.locations           != nullptr &&
+                       state.neighbour_stamps    != nullptr &&
+                       state.quadrics            != nullptr &&
+                       vertex_remap              != nullptr,
+                       "Out of memory");
+
+    memcpy(state.index_data,
+           index_data,
+           sizeof(uint32_t) * n_indices);
+    memset(location_passes,
+           0,
+           sizeof(uint32_t) * n_vertices);
+    memset(state.is_location_locked,
+           0,
+           sizeof(uint8_t) * n_vertices);
+    memset(state.neighbour_stamps,
+           0,
+           sizeof(uint32_t) * n_vertices);
+    memset(state.quadrics,
+           0,
+           sizeof(_mesh_simplifier_quadric) * n_vertices);
+
+    for (uint32_t n_vertex = 0;
+                  n_vertex < n_vertices;
+                ++n_vertex)
+    {
+        vertex_remap[n_vertex] = n_vertex;
+    }
+
+    /* 1. Group vertices by location. Triangles which use the same location more than once have no area,
+     *    so they are dropped straight away. */
+    state.n_indices = n_indices;
+
+    _mesh_simplifier_build_locations(&state);
+
+    state.n_indices = 0;
+
+    for (uint32_t n_index = 0;
+                  n_index < n_indices;
+                  n_index += 3)
+    {
+        const uint32_t location_0 = state.locations[index_data[n_index + 0] ];
+        const uint32_t location_1 = state.locations[index_data[n_index + 1] ];
+        const uint32_t location_2 = state.locations[index_data[n_index + 2] ];
+
+        if (location_0 != location_1 &&
+            location_0 != location_2 &&
+            location_1 != location_2)
+        {
+            memcpy(state.index_data + state.n_indices,
+                   index_data       + n_index,
+                   sizeof(uint32_t) * 3);
+
+            state.n_indices += 3;
+        }
+    }
+
+    _mesh_simplifier_build_adjacency(&state);
+
+    /* 2. Lock locations on open borders. An edge is shared by exactly two triangles, unless it lies on
+     *    a border, or the surface is not manifold there. */
+    for (uint32_t n_location = 0;
+                  n_location < n_vertices;
+                ++n_location)
+    {
+        const uint32_t* triangles_end_ptr = state.adjacency_triangles + state.adjacency_offsets[n_location + 1];
+        const uint32_t* triangles_ptr     = state.adjacency_triangles + state.adjacency_offsets[n_location];
+
+        for (const uint32_t* triangle_ptr  = triangles_ptr;
+                             triangle_ptr != triangles_end_ptr && !state.is_location_locked[n_location];
+                           ++triangle_ptr)
+        {
+            for (uint32_t n_corner = 0;
+                          n_corner < 3;
+                        ++n_corner)
+            {
+                const uint32_t neighbour   = state.locations[state.index_data[3 * (*triangle_ptr) + n_corner] ];
+                uint32_t       n_triangles = 0;
+
+                if (neighbour == n_location)
+                {
+                    continue;
+                }
+
+                for (const uint32_t* edge_triangle_ptr  = triangles_ptr;
+                                     edge_triangle_ptr != triangles_end_ptr;
+                                   ++edge_triangle_ptr)
+                {
+                    const uint32_t* edge_triangle_index_ptr = state.index_data + 3 * (*edge_triangle_ptr);
+
+                    if (state.locations[edge_triangle_index_ptr[0] ] == neighbour ||
+                        state.locations[edge_triangle_index_ptr[1] ] == neighbour ||
+                        state.locations[edge_triangle_index_ptr[2] ] == neighbour)
+                    {
+                        ++n_triangles;
+                    }
+                }
+
+                if (n_triangles != 2)
+                {
+                    state.is_location_locked[n_location] = 1;
+                }
+            }
+        }
+    }
+
+    /* 3. Each location starts with the quadric of the planes of all triangles using it */
+    for (uint32_t n_index = 0;
+                  n_index < state.n_indices;
+                  n_index += 3)
+    {
+        const float* triangle_locations[3];
+
+        for (uint32_t n_corner = 0;
+                      n_corner < 3;
+                    ++n_corner)
+        {
+            triangle_locations[n_corner] = _mesh_simplifier_get_location(&state,
+                                                                         state.index_data[n_index + n_corner]);
+        }
+
+        for (uint32_t n_corner = 0;
+                      n_corner < 3;
+                    ++n_corner)
+        {
+            _mesh_simplifier_add_plane_quadric(state.quadrics + state.locations[state.index_data[n_index + n_corner] ],
+                                               triangle_locations);
+        }
+    }
+
+    /* 4. Collapse edges until the target is reached, or no more edges can be collapsed */
+    collapses_sorted = system_resizable_vector_create(n_vertices);
+
+    while (state.n_indices > target_n_indices)
+    {
+        float          cost_limit            = 0.0f;
+        uint32_t       n_collapse_goal       = 0;
+        uint32_t       n_collapses           = 0;
+        uint32_t       n_pass_collapses      = 0;
+        uint32_t       n_removed_triangles   = 0;
+        const uint32_t n_triangles_to_remove = (state.n_indices - target_n_indices + 2) / 3;
+        uint32_t       n_result_indices      = 0;
+
+        ++n_pass;
+
+        system_resizable_vector_clear(collapses_sorted);
+
+        /* Find the cheapest valid collapse for each location which can be removed. Invalid collapses are
+         * skipped here, rather than when the collapses are applied, so that a location whose cheapest edge
+         * cannot be collapsed can still be removed along another one. */
+        for (uint32_t n_location = 0;
+                      n_location < n_vertices;
+                    ++n_location)
+        {
+            _mesh_simplifier_collapse* collapse_ptr      = collapses + n_collapses;
+            const uint32_t*            triangles_end_ptr = state.adjacency_triangles + state.adjacency_offsets[n_location + 1];
+
+            if (state.locations[n_location]        != n_location ||
+                state.is_location_locked[n_location])
+            {
+                continue;
+            }
+
+            collapse_ptr->cost            = 0.0f;
+            collapse_ptr->source_location = n_location;
+            collapse_ptr->target_vertex   = UINT32_MAX;
+
+            for (const uint32_t* triangle_ptr  = state.adjacency_triangles + state.adjacency_offsets[n_location];
+                                 triangle_ptr != triangles_end_ptr;
+                               ++triangle_ptr)
+            {
+                for (uint32_t n_corner = 0;
+                              n_corner < 3;
+                            ++n_corner)
+                {
+                    const uint32_t target_vertex   = state.index_data[3 * (*triangle_ptr) + n_corner];
+                    const uint32_t target_location = state.locations[target_vertex];
+                    const float*   new_location    = _mesh_simplifier_get_location(&state,
+                                                                                   target_vertex);
+                    float          cost            = 0.0f;
+
+                    if (target_location == n_location)
+                    {
+                        continue;
+                    }
+
+                    cost = _mesh_simplifier_evaluate_quadric(state.quadrics + n_location,
+                                                             new_location) +
+                           _mesh_simplifier_evaluate_quadric(state.quadrics + target_location,
+                                                             new_location);
+
+                    if (( collapse_ptr->target_vertex == UINT32_MAX                                          ||
+                          collapse_ptr->cost          >  cost                                                ||
+                         (collapse_ptr->cost          == cost && collapse_ptr->target_vertex > target_vertex)) &&
+                        _mesh_simplifier_is_collapse_valid(&state,
+                                                           n_location,
+                                                           target_vertex) )
+                    {
+                        collapse_ptr->cost          = cost;
+                        collapse_ptr->target_vertex = target_vertex;
+                    }
+                }
+            }
+
+            if (collapse_ptr->target_vertex != UINT32_MAX)
+            {
+                system_resizable_vector_push(collapses_sorted,
+                                             collapse_ptr);
+
+                ++n_collapses;
+            }
+        }
+
+        if (n_collapses == 0)
+        {
+            break;
+        }
+
+        system_resizable_vector_sort(collapses_sorted,
+                                     _mesh_simplifier_compare_collapses);
+
+        /* Most collapses remove two triangles */
+        n_collapse_goal = (n_triangles_to_remove / 2 < n_collapses) ? n_triangles_to_remove / 2
+                                                                    : n_collapses - 1;
+
+        {
+            const _mesh_simplifier_collapse* goal_collapse_ptr = nullptr;
+
+            system_resizable_vector_get_element_at(collapses_sorted,
+                                                   n_collapse_goal,
+                                                  &goal_collapse_ptr);
+
+            cost_limit = goal_collapse_ptr->cost * SIMPLIFIER_PASS_ERROR_LIMIT_SCALE * SIMPLIFIER_PASS_ERROR_LIMIT_SCALE;
+        }
+
+        for (uint32_t n_collapse = 0;
+                      n_collapse < n_collapses && n_removed_triangles < n_triangles_to_remove;
+                    ++n_collapse)
+        {
+            const _mesh_simplifier_collapse* collapse_ptr      = nullptr;
+            uint32_t                         source_location;
+            uint32_t                         target_location;
+            const uint32_t*                  triangles_end_ptr = nullptr;
+
+            system_resizable_vector_get_element_at(collapses_sorted,
+                                                   n_collapse,
+                                                  &collapse_ptr);
+
+            if (collapse_ptr->cost > cost_limit &&
+                n_pass_collapses   > 0)
+            {
+                break;
+            }
+
+            source_location   = collapse_ptr->source_location;
+            target_location   = state.locations[collapse_ptr->target_vertex];
+            triangles_end_ptr = state.adjacency_triangles + state.adjacency_offsets[source_location + 1];
+
+            if (location_passes[source_location] == n_pass ||
+                location_passes[target_location] == n_pass)
+            {
+                continue;
+            }
+
+            if (!_mesh_simplifier_is_collapse_valid(&state,
+                                                    source_location,
+                                                    collapse_ptr->target_vertex) )
+            {
+                continue;
+            }
+
+            /* Neither the collapsed location's neighbours nor the target can be touched again in this pass,
+             * since the adjacency data is only updated once the pass is over. */
+            for (const uint32_t* triangle_ptr  = state.adjacency_triangles + state.adjacency_offsets[source_location];
+                                 triangle_ptr != triangles_end_ptr;
+                               ++triangle_ptr)
+            {
+                bool is_removed = false;
+
+                for (uint32_t n_corner = 0;
+                              n_corner < 3;
+                            ++n_corner)
+                {
+                    const uint32_t location = state.locations[state.index_data[3 * (*triangle_ptr) + n_corner] ];
+
+                    location_passes[location] = n_pass;
+
+                    if (location == target_location)
+                    {
+                        is_removed = true;
+                    }
+                }
+
+                if (is_removed)
+                {
+                    ++n_removed_triangles;
+                }
+            }
+
+            location_passes[target_location] = n_pass;
+            vertex_remap   [source_location] = collapse_ptr->target_vertex;
+
+            _mesh_simplifier_add_quadric(state.quadrics + target_location,
+                                         state.quadrics + source_location);
+
+            if (max_cost < collapse_ptr->cost)
+            {
+                max_cost = collapse_ptr->cost;
+            }
+
+            ++n_pass_collapses;
+        }
+
+        if (n_pass_collapses == 0)
+        {
+            break;
+        }
+
+        /* Apply the collapses. Targets are never collapsed in the same pass, so a single remapping step
+         * is enough. Triangles which lost a location are dropped. */
+        for (uint32_t n_index = 0;
+                      n_index < state.n_indices;
+                      n_index += 3)
+        {
+            const uint32_t vertex_0 = vertex_remap[state.index_data[n_index + 0] ];
+            const uint32_t vertex_1 = vertex_remap[state.index_data[n_index + 1] ];
+            const uint32_t vertex_2 = vertex_remap[state.index_data[n_index + 2] ];
+
+            if (state.locations[vertex_0] != state.locations[vertex_1] &&
+                state.locations[vertex_0] != state.locations[vertex_2] &&
+                state.locations[vertex_1] != state.locations[vertex_2])
+            {
+                state.index_data[n_result_indices + 0] = vertex_0;
+                state.index_data[n_result_indices + 1] = vertex_1;
+                state.index_data[n_result_indices + 2] = vertex_2;
+
+                n_result_indices += 3;
+            }
+        }
+
+        state.n_indices = n_result_indices;
+
+        _mesh_simplifier_build_adjacency(&state);
+    }
+
+    memcpy(out_index_data,
+           state.index_data,
+           sizeof(uint32_t) * state.n_indices);
+
+    if (out_error_ptr != nullptr)
+    {
+        *out_error_ptr = sqrtf(max_cost);
+    }
+
+    system_resizable_vector_release(collapses_sorted);
+
+    delete [] collapses;
+    delete [] location_passes;
+    delete [] state.adjacency_offsets;
+    delete [] state.adjacency_triangles;
+    delete [] state.index_data;
+    delete [] state.is_location_locked;
+    delete [] state.locations;
+    delete [] state.neighbour_stamps;
+    delete [] state.quadrics;
+    delete [] vertex_remap;
+
+    return state.n_indices;
+}
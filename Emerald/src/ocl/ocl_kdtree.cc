@@ -121,8 +121,6 @@ PRIVATE void                        _ocl_kdtree_init_temporary_node            (
 PRIVATE void                        _ocl_kdtree_parse_a_node                   (__in                         __notnull char*                       traveller_ptr, __out __notnull uint32_t* out_node_type, __out __notnull uint32_t* out_node_axis, __out __notnull float* out_split_value, __out __notnull uint32_t* out_left_node_offset, __out __notnull uint32_t* out_right_node_offset);
 PRIVATE void                        _ocl_kdtree_release                        (__in __notnull void*    arg);
 PRIVATE void                        _ocl_kdtree_split_triangle                 (__in           uint32_t axis_split, __in __notnull _ocl_kdtree_triangle* triangle, __in  __notnull _ocl_kdtree_bounding_box* left_bb, __in  __notnull _ocl_kdtree_bounding_box* right_bb, __out __notnull bool* out_goes_left, __out __notnull bool* out_goes_right);
-PRIVATE bool                        _ocl_kdtree_triple_uint32_lower            (__in __notnull void*    arg1,       __in __notnull void*                 arg2);
-PRIVATE bool                        _ocl_kdtree_triple_uint32_equal            (__in __notnull void*    arg1,       __in __notnull void*                 arg2);
 
 /** TODO. aabb_ray_intersection taken from http://gamedev.stackexchange.com/questions/18436/most-efficient-aabb-vs-ray-collision-algorithms (push-down traversal) */
 const char* cl_kdtree_cast_kernel_body = "#define MAX_STACK_SIZE (1)\n"
@@ -592,12 +590,11 @@ PRIVATE void _ocl_kdtree_convert_to_cl_gl_representation(__in __notnull _ocl_kdt
                     /* Vertices */
                     if (vertex_index_triple_to_triangle_bst == NULL)
                     {                
-                        vertex_index_triple_to_triangle_bst = system_bst_create(sizeof(uint32_t) * 3,  /* key size */
-                                                                                sizeof(uint32_t),      /* value size */
-                                                                                _ocl_kdtree_triple_uint32_lower,
-                                                                                _ocl_kdtree_triple_uint32_equal,
-                                                                                (system_bst_key)   node_triangle->unique_vertex_indices,
-                                                                                (system_bst_value) &triangle_id_counter);
+                        vertex_index_triple_to_triangle_bst = system_bst_create_for_key_type(SYSTEM_BST_KEY_TYPE_UINT32_ARRAY,
+                                                                                             sizeof(uint32_t) * 3,  /* key size */
+                                                                                             sizeof(uint32_t),      /* value size */
+                                                                                             (system_bst_key)   node_triangle->unique_vertex_indices,
+                                                                                             (system_bst_value) &triangle_id_counter);
                         triangle_id_counter++;
                     } /* if (vertex_index_triple_to_triangle_bst == NULL)*/
                     else
@@ -2042,24 +2039,6 @@ PRIVATE void _ocl_kdtree_split_triangle(__in            uint32_t
      ASSERT_DEBUG_SYNC(*out_goes_left || *out_goes_right, "Triangle is about to get lost!");
  }
 
-/** TODO */
-PRIVATE bool _ocl_kdtree_triple_uint32_lower(__in __notnull void* arg1, __in __notnull void* arg2)
-{
-    uint32_t* arg1_uint32 = (uint32_t*) arg1;
-    uint32_t* arg2_uint32 = (uint32_t*) arg2;
-
-    return arg1_uint32[0] < arg2_uint32[0] && arg1_uint32[1] < arg2_uint32[1] && arg1_uint32[2] < arg2_uint32[2];
-}
-
-/** TODO */
-PRIVATE bool _ocl_kdtree_triple_uint32_equal(__in __notnull void* arg1, __in __notnull void* arg2)
-{
-    uint32_t* arg1_uint32 = (uint32_t*) arg1;
-    uint32_t* arg2_uint32 = (uint32_t*) arg2;
-
-    return arg1_uint32[0] == arg2_uint32[0] && arg1_uint32[1] == arg2_uint32[1] && arg1_uint32[2] == arg2_uint32[2];
-}
-
 /** TODO */
 PUBLIC EMERALD_API bool ocl_kdtree_add_executor(__in  __notnull ocl_kdtree                         instance,
                                                 __in            _ocl_kdtree_executor_configuration configuration,
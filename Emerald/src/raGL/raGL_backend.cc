@@ -1077,7 +1077,7 @@ PRIVATE void _raGL_backend_on_buffer_client_memory_sourced_update_request(const
     if (buffer_raGL != nullptr)
     {
         raGL_buffer_update_regions_with_client_memory(buffer_raGL,
-                                                      callback_arg_ptr->updates,
+                                                     *callback_arg_ptr->updates,
                                                       callback_arg_ptr->async,
                                                       callback_arg_ptr->sync_other_contexts);
     }
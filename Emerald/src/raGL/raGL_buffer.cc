@@ -141,7 +141,7 @@ PRIVATE ral_present_job _raGL_buffer_on_client_memory_sourced_update_request_ren
     raGL_backend_sync();
 
     /* Bind the buffer object to ensure the latest BO contents is accessible to this context */
-    for (auto current_update_ptr : callback_arg_ptr->updates)
+    for (const auto& current_update_ptr : callback_arg_ptr->updates)
     {
         entrypoints_dsa_ptr->pGLNamedBufferSubDataEXT(buffer_ptr->id,
                                                       buffer_ptr->start_offset + current_update_ptr->start_offset,
@@ -502,10 +502,10 @@ PUBLIC void raGL_buffer_release(raGL_buffer buffer)
 }
 
 /** Please see header for specification */
-PUBLIC void raGL_buffer_update_regions_with_client_memory(raGL_buffer                                                          buffer,
-                                                          std::vector<std::shared_ptr<ral_buffer_client_sourced_update_info> > updates,
-                                                          bool                                                                 async,
-                                                          bool                                                                 sync_other_contexts)
+PUBLIC void raGL_buffer_update_regions_with_client_memory(raGL_buffer                                                                 buffer,
+                                                          const std::vector<std::shared_ptr<ral_buffer_client_sourced_update_info> >& updates,
+                                                          bool                                                                        async,
+                                                          bool                                                                        sync_other_contexts)
 {
     _raGL_buffer* buffer_ptr      = reinterpret_cast<_raGL_buffer*>(buffer);
     ogl_context   current_context = ogl_context_get_current_context();
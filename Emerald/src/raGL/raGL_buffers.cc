@@ -407,7 +407,8 @@ PRIVATE _raGL_buffers_buffer* _raGL_buffers_alloc_new_immutable_buffer(_raGL_buf
                                                                    nullptr,          /* pfn_on_memory_block_alloced */
                                                                    nullptr,          /* pfn_on_memory_block_freed */
                                                                    new_buffer_ptr,
-                                                                   true);         /* should_be_thread_safe */
+                                                                   true,          /* should_be_thread_safe */
+                                                                   SYSTEM_MEMORY_MANAGER_POLICY_TLSF);
 
         system_resizable_vector_push(new_buffer_ptr->buffers_ptr->nonsparse_heaps[heap_type],
                                      new_buffer_ptr);
@@ -489,7 +490,8 @@ PRIVATE _raGL_buffers_buffer* _raGL_buffers_alloc_new_sparse_buffer(_raGL_buffer
                                                                    _raGL_buffers_on_sparse_memory_block_alloced,
                                                                    _raGL_buffers_on_sparse_memory_block_freed,
                                                                    new_buffer_ptr,
-                                                                   true); /* should_be_thread_safe */
+                                                                   true, /* should_be_thread_safe */
+                                                                   SYSTEM_MEMORY_MANAGER_POLICY_TLSF);
 
         system_resizable_vector_push(new_buffer_ptr->buffers_ptr->sparse_buffers,
                                      new_buffer_ptr);
@@ -8,10 +8,37 @@
 #include "ral/ral_present_task.h"
 #include "ral/ral_texture_view.h"
 #include "ral/ral_utils.h"
+#include "system/system_frame_arena.h"
 #include "system/system_hash64map.h"
 #include "system/system_log.h"
 #include "system/system_resizable_vector.h"
 
+/** Allocates memory for a present job, task or connection descriptor.
+ *
+ *  Jobs created while a frame is in progress are released before the frame is presented, so
+ *  such jobs, as well as their task & connection descriptors, are carved out of the frame arena.
+ */
+PRIVATE void* _ral_present_job_alloc(bool   is_frame_arena_backed,
+                                     size_t size)
+{
+    return (is_frame_arena_backed) ? system_frame_arena_alloc(size)
+                                   : ::operator new          (size);
+}
+
+/** Destroys a descriptor allocated with _ral_present_job_alloc(). */
+template<typename T>
+PRIVATE void _ral_present_job_delete(bool is_frame_arena_backed,
+                                     T*   object_ptr)
+{
+    object_ptr->~T();
+
+    if (!is_frame_arena_backed)
+    {
+        ::operator delete(object_ptr);
+    }
+}
+
+
 typedef struct _ral_present_job_connection
 {
     ral_present_task_id dst_task_id;
@@ -67,14 +94,18 @@ typedef struct _ral_present_job
     uint32_t         n_total_tasks_added;
     system_hash64map tasks;       /* holds & owns _ral_present_job_task instances */
 
+    /* true if the job descriptor, as well as all task & connection descriptors, live in the frame arena. */
+    bool is_frame_arena_backed;
+
     bool                     presentable_output_defined;
     uint32_t                 presentable_output_io_index;
     ral_present_task_io_type presentable_output_io_type;
     ral_present_task_id      presentable_output_task_id;
 
-    _ral_present_job()
+    explicit _ral_present_job(bool in_is_frame_arena_backed)
     {
         connections                 = system_hash64map_create(sizeof(_ral_present_job_connection*) );
+        is_frame_arena_backed       = in_is_frame_arena_backed;
         n_total_connections_added   = 0;
         n_total_tasks_added         = 0;
         tasks                       = system_hash64map_create(sizeof(_ral_present_job_task*) );
@@ -107,7 +138,8 @@ typedef struct _ral_present_job
 
                 if (connection_ptr != nullptr)
                 {
-                    delete connection_ptr;
+                    _ral_present_job_delete(is_frame_arena_backed,
+                                            connection_ptr);
                 }
             }
 
@@ -136,7 +168,8 @@ typedef struct _ral_present_job
 
                 if (task_ptr != nullptr)
                 {
-                    delete task_ptr;
+                    _ral_present_job_delete(is_frame_arena_backed,
+                                            task_ptr);
 
                     task_ptr = nullptr;
                 }
@@ -204,9 +237,11 @@ PUBLIC EMERALD_API bool ral_present_job_add_task(ral_present_job      job,
     /* Store the new task, simultaneously assigning it a new ID */
     new_task_id = job_ptr->n_total_tasks_added++;
 
-    new_task_ptr = new _ral_present_job_task(new_task_dag_node,
-                                             task,
-                                             new_task_id);
+    new_task_ptr = new (_ral_present_job_alloc(job_ptr->is_frame_arena_backed,
+                                               sizeof(_ral_present_job_task) ))
+        _ral_present_job_task(new_task_dag_node,
+                              task,
+                              new_task_id);
 
     ASSERT_ALWAYS_SYNC(new_task_ptr != nullptr,
                        "Out of memory");
@@ -337,10 +372,12 @@ PUBLIC EMERALD_API bool ral_present_job_connect_tasks(ral_present_job
     /* Create & store the new connection */
     new_connection_id = job_ptr->n_total_connections_added++;
 
-    new_connection_ptr = new _ral_present_job_connection(dst_task_id,
-                                                         n_dst_task_input,
-                                                         n_src_task_output,
-                                                         src_task_id);
+    new_connection_ptr = new (_ral_present_job_alloc(job_ptr->is_frame_arena_backed,
+                                                     sizeof(_ral_present_job_connection) ))
+        _ral_present_job_connection(dst_task_id,
+                                    n_dst_task_input,
+                                    n_src_task_output,
+                                    src_task_id);
 
     ASSERT_ALWAYS_SYNC(new_connection_ptr != nullptr,
                        "Out of memory");
@@ -370,12 +407,15 @@ end:
 /** Please see header for spec */
 PUBLIC EMERALD_API ral_present_job ral_present_job_create()
 {
-    _ral_present_job* new_job_ptr = nullptr;
+    const bool        is_frame_arena_backed = system_frame_arena_is_frame_in_progress();
+    _ral_present_job* new_job_ptr           = nullptr;
 
     /* Sanity checks */
 
     /* Spawn the new descriptor */
-    new_job_ptr = new _ral_present_job;
+    new_job_ptr = new (_ral_present_job_alloc(is_frame_arena_backed,
+                                              sizeof(_ral_present_job) ))
+        _ral_present_job(is_frame_arena_backed);
 
     ASSERT_ALWAYS_SYNC(new_job_ptr != nullptr,
                        "Out of memory");
@@ -869,7 +909,8 @@ PUBLIC bool ral_present_job_flatten(ral_present_job job)
                 }
 
                 /* Safe to drop the processed connection at this point */
-                delete connection_ptr;
+                _ral_present_job_delete(job_ptr->is_frame_arena_backed,
+                                        connection_ptr);
 
                 system_hash64map_remove(job_ptr->connections,
                                         connection_id);
@@ -971,7 +1012,8 @@ PUBLIC bool ral_present_job_flatten(ral_present_job job)
 
         if (task_type == RAL_PRESENT_TASK_TYPE_GROUP)
         {
-            delete task_ptr;
+            _ral_present_job_delete(job_ptr->is_frame_arena_backed,
+                                    task_ptr);
 
             system_hash64map_remove(job_ptr->tasks,
                                     task_id);
@@ -1277,7 +1319,10 @@ PUBLIC EMERALD_API bool ral_present_job_is_connection_defined(ral_present_job
 /** Please see header for spec */
 PUBLIC EMERALD_API void ral_present_job_release(ral_present_job job)
 {
-    delete reinterpret_cast<_ral_present_job*>(job);
+    _ral_present_job* job_ptr = reinterpret_cast<_ral_present_job*>(job);
+
+    _ral_present_job_delete(job_ptr->is_frame_arena_backed,
+                            job_ptr);
 }
 
 /** Please see header for spec */
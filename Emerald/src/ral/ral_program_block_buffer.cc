@@ -10,6 +10,7 @@
 #include "ral/ral_program.h"
 #include "ral/ral_program_block_buffer.h"
 #include "system/system_critical_section.h"
+#include "system/system_frame_arena.h"
 #include "system/system_log.h"
 
 #define DIRTY_OFFSET_UNUSED (-1)
@@ -908,8 +909,11 @@ PUBLIC EMERALD_API void ral_program_block_buffer_sync_immediately(ral_program_bl
         bo_update_info.data_size    = block_buffer_ptr->dirty_offset_end - block_buffer_ptr->dirty_offset_start;
         bo_update_info.start_offset = block_buffer_ptr->dirty_offset_start;
 
+        /* This is called for each dirty block buffer at least once per frame. Make sure the shared pointer's
+         * control block comes from the frame arena, rather than the heap, if possible. */
         bo_update_ptrs.push_back(std::shared_ptr<ral_buffer_client_sourced_update_info>(&bo_update_info,
-                                                                                        NullDeleter<ral_buffer_client_sourced_update_info>() ));
+                                                                                        NullDeleter<ral_buffer_client_sourced_update_info>(),
+                                                                                        system_frame_arena_allocator<ral_buffer_client_sourced_update_info>() ));
 
         ral_buffer_set_data_from_client_memory(block_buffer_ptr->buffer_ral,
                                                bo_update_ptrs,
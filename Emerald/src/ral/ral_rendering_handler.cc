@@ -18,6 +18,7 @@
 #include "system/system_assertions.h"
 #include "system/system_critical_section.h"
 #include "system/system_event.h"
+#include "system/system_frame_arena.h"
 #include "system/system_hashed_ansi_string.h"
 #include "system/system_log.h"
 #include "system/system_pixel_format.h"
@@ -537,6 +538,10 @@ PRIVATE void _ral_rendering_handler_playback_in_progress_callback_handler(uint32
                 rendering_handler_ptr->n_frames_rendered++;
             }
 
+            /* Temporary data allocated from the frame arenas from now on only needs to live until
+             * the frame is presented. */
+            system_frame_arena_begin_frame();
+
             rendering_handler_ptr->pfn_pre_draw_frame_raBackend_proc(rendering_handler_ptr->rendering_handler_backend);
 
             /* Update the frame indicator, if the runtime time adjustment mode is on */
@@ -822,6 +827,8 @@ PRIVATE void _ral_rendering_handler_playback_in_progress_callback_handler(uint32
                 }
             }
 
+            system_frame_arena_end_frame();
+
             system_critical_section_leave(rendering_handler_ptr->rendering_cs);
         }
     }
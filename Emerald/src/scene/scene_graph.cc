@@ -16,6 +16,7 @@
 #include "system/system_file_serializer.h"
 #include "system/system_hash64map.h"
 #include "system/system_log.h"
+#include "system/system_math_matrix4x4.h"
 #include "system/system_matrix4x4.h"
 #include "system/system_read_write_mutex.h"
 #include "system/system_resizable_vector.h"
@@ -24,50 +25,57 @@
 #include "system/system_variant.h"
 
 /* Private declarations */
-typedef system_matrix4x4 (*PFNUPDATEMATRIXPROC)(void*            data,
-                                                system_matrix4x4 current_matrix,
-                                                system_time      prev_keyframe_time,
-                                                system_time      next_keyframe_time,
-                                                float            lerp_factor);
+typedef void (*PFNUPDATEMATRIXPROC)(void*                        data,
+                                    const system_math_matrix4x4* current_matrix_ptr,
+                                    system_time                  prev_keyframe_time,
+                                    system_time                  next_keyframe_time,
+                                    float                        lerp_factor,
+                                    system_math_matrix4x4*       out_result_ptr);
 
 /* Forward declarations */
 PRIVATE void             _scene_graph_align_time_to_fps                        (scene_graph                                   graph,
                                                                                 system_time                                   time,
                                                                                 system_time*                                  out_prev_keyframe_time_ptr,
                                                                                 system_time*                                  out_next_keyframe_time_ptr);
-PRIVATE system_matrix4x4 _scene_graph_compute_root_node                        (void*                                         data,
-                                                                                system_matrix4x4                              current_matrix,
+PRIVATE void             _scene_graph_compute_root_node                        (void*                                         data,
+                                                                                const system_math_matrix4x4*                  current_matrix_ptr,
                                                                                 system_time                                   prev_keyframe_time,
                                                                                 system_time                                   next_keyframe_time,
-                                                                                float                                         lerp_factor);
+                                                                                float                                         lerp_factor,
+                                                                                system_math_matrix4x4*                        out_result_ptr);
 PRIVATE void             _scene_graph_compute_node_transformation_matrix       (scene_graph                                   graph,
                                                                                 struct _scene_graph_node*                     node_ptr,
                                                                                 system_time                                   time);
-PRIVATE system_matrix4x4 _scene_graph_compute_general                          (void*                                         data,
-                                                                                system_matrix4x4                              current_matrix,
+PRIVATE void             _scene_graph_compute_general                          (void*                                         data,
+                                                                                const system_math_matrix4x4*                  current_matrix_ptr,
                                                                                 system_time                                   prev_keyframe_time,
                                                                                 system_time                                   next_keyframe_time,
-                                                                                float                                         lerp_factor);
-PRIVATE system_matrix4x4 _scene_graph_compute_rotation_dynamic                 (void*                                         data,
-                                                                                system_matrix4x4                              current_matrix,
+                                                                                float                                         lerp_factor,
+                                                                                system_math_matrix4x4*                        out_result_ptr);
+PRIVATE void             _scene_graph_compute_rotation_dynamic                 (void*                                         data,
+                                                                                const system_math_matrix4x4*                  current_matrix_ptr,
                                                                                 system_time                                   prev_keyframe_time,
                                                                                 system_time                                   next_keyframe_time,
-                                                                                float                                         lerp_factor);
-PRIVATE system_matrix4x4 _scene_graph_compute_scale_dynamic                    (void*                                         data,
-                                                                                system_matrix4x4                              current_matrix,
+                                                                                float                                         lerp_factor,
+                                                                                system_math_matrix4x4*                        out_result_ptr);
+PRIVATE void             _scene_graph_compute_scale_dynamic                    (void*                                         data,
+                                                                                const system_math_matrix4x4*                  current_matrix_ptr,
                                                                                 system_time                                   prev_keyframe_time,
                                                                                 system_time                                   next_keyframe_time,
-                                                                                float                                         lerp_factor);
-PRIVATE system_matrix4x4 _scene_graph_compute_static_matrix4x4                 (void*                                         data,
-                                                                                system_matrix4x4                              current_matrix,
+                                                                                float                                         lerp_factor,
+                                                                                system_math_matrix4x4*                        out_result_ptr);
+PRIVATE void             _scene_graph_compute_static_matrix4x4                 (void*                                         data,
+                                                                                const system_math_matrix4x4*                  current_matrix_ptr,
                                                                                 system_time                                   prev_keyframe_time,
                                                                                 system_time                                   next_keyframe_time,
-                                                                                float                                         lerp_factor);
-PRIVATE system_matrix4x4 _scene_graph_compute_translation_dynamic              (void*                                         data,
-                                                                                system_matrix4x4                              current_matrix,
+                                                                                float                                         lerp_factor,
+                                                                                system_math_matrix4x4*                        out_result_ptr);
+PRIVATE void             _scene_graph_compute_translation_dynamic              (void*                                         data,
+                                                                                const system_math_matrix4x4*                  current_matrix_ptr,
                                                                                 system_time                                   prev_keyframe_time,
                                                                                 system_time                                   next_keyframe_time,
-                                                                                float                                         lerp_factor);
+                                                                                float                                         lerp_factor,
+                                                                                system_math_matrix4x4*                        out_result_ptr);
 PRIVATE float            _scene_graph_get_float_time_from_timeline_time        (system_time                                   time);
 PRIVATE system_hash64map _scene_graph_get_node_hashmap                         (struct _scene_graph*                          graph_ptr);
 PRIVATE bool             _scene_graph_load_node                                (system_file_serializer                        serializer,
@@ -315,13 +323,28 @@ typedef struct _scene_graph_node_translation_static
 
 typedef struct _scene_graph_node_transformation_matrix
 {
-    system_matrix4x4 data;
-    bool             has_fired_event;
+    /* Handle exposed to the outside world. Created once and updated with the contents of
+     * value whenever the node is recomputed. */
+    system_matrix4x4      data;
+    bool                  has_fired_event;
+    system_math_matrix4x4 value;
 
     _scene_graph_node_transformation_matrix()
     {
         data            = nullptr;
         has_fired_event = false;
+
+        system_math_matrix4x4_set_identity(&value);
+    }
+
+    ~_scene_graph_node_transformation_matrix()
+    {
+        if (data != nullptr)
+        {
+            system_matrix4x4_release(data);
+
+            data = nullptr;
+        }
     }
 } _scene_graph_node_transformation_matrix;
 
@@ -486,17 +509,15 @@ PRIVATE void _scene_graph_align_time_to_fps(scene_graph  graph,
 }
 
 /** TODO */
-PRIVATE system_matrix4x4 _scene_graph_compute_root_node(void*            data,
-                                                        system_matrix4x4 current_matrix,
-                                                        system_time      prev_keyframe_time,
-                                                        system_time      next_keyframe_time,
-                                                        float            lerp_factor)
+PRIVATE void _scene_graph_compute_root_node(void*                        data,
+                                            const system_math_matrix4x4* current_matrix_ptr,
+                                            system_time                  prev_keyframe_time,
+                                            system_time                  next_keyframe_time,
+                                            float                        lerp_factor,
+                                            system_math_matrix4x4*       out_result_ptr)
 {
     /* Ignore current matrix, just return an identity matrix */
-    system_matrix4x4 result = system_matrix4x4_create();
-
-    system_matrix4x4_set_to_identity(result);
-    return result;
+    system_math_matrix4x4_set_identity(out_result_ptr);
 }
 
 /** TODO */
@@ -504,17 +525,19 @@ PRIVATE void _scene_graph_compute_node_transformation_matrix(scene_graph
                                                              _scene_graph_node* node_ptr,
                                                              system_time        time)
 {
-    if (node_ptr->type == SCENE_GRAPH_NODE_TYPE_MATRIX4X4_STATIC)
+    if (node_ptr->transformation_matrix.data == nullptr)
     {
-        /* Do NOT recompute static 4x4 matrix data. */
-        goto end;
+        node_ptr->transformation_matrix.data = system_matrix4x4_create();
     }
 
-    if (node_ptr->transformation_matrix.data != nullptr)
+    if (node_ptr->type == SCENE_GRAPH_NODE_TYPE_MATRIX4X4_STATIC)
     {
-        system_matrix4x4_release(node_ptr->transformation_matrix.data);
+        /* Do NOT recompute static 4x4 matrix data. The matrix may have been modified via
+         * the exposed handle though, so make sure the children see the latest contents. */
+        system_math_matrix4x4_set_from_row_major(system_matrix4x4_get_row_major_data(node_ptr->transformation_matrix.data),
+                                                &node_ptr->transformation_matrix.value);
 
-        node_ptr->transformation_matrix.data = nullptr;
+        goto end;
     }
 
     /* Retrieve keyframe data */
@@ -543,51 +566,51 @@ PRIVATE void _scene_graph_compute_node_transformation_matrix(scene_graph
         ASSERT_DEBUG_SYNC(node_ptr->parent_node->last_update_time == time,
                           "Parent node's update time does not match the computation time!");
 
-        node_ptr->transformation_matrix.data = node_ptr->pUpdateMatrix(node_ptr->data,
-                                                                       node_ptr->parent_node->transformation_matrix.data,
-                                                                       prev_keyframe_time,
-                                                                       next_keyframe_time,
-                                                                       lerp_factor);
+        node_ptr->pUpdateMatrix(node_ptr->data,
+                               &node_ptr->parent_node->transformation_matrix.value,
+                                prev_keyframe_time,
+                                next_keyframe_time,
+                                lerp_factor,
+                               &node_ptr->transformation_matrix.value);
     }
     else
     {
-        node_ptr->transformation_matrix.data = node_ptr->pUpdateMatrix(node_ptr->data,
-                                                                       nullptr,
-                                                                       prev_keyframe_time,
-                                                                       next_keyframe_time,
-                                                                       lerp_factor);
+        node_ptr->pUpdateMatrix(node_ptr->data,
+                                nullptr,
+                                prev_keyframe_time,
+                                next_keyframe_time,
+                                lerp_factor,
+                               &node_ptr->transformation_matrix.value);
     }
 
+    system_matrix4x4_set_from_row_major_raw(node_ptr->transformation_matrix.data,
+                                            node_ptr->transformation_matrix.value.data);
+
 end:
     node_ptr->last_update_time = time;
 }
 
 /** TODO */
-PRIVATE system_matrix4x4 _scene_graph_compute_general(void*            data,
-                                                      system_matrix4x4 current_matrix,
-                                                      system_time      prev_keyframe_time,
-                                                      system_time      next_keyframe_time,
-                                                      float            lerp_factor)
+PRIVATE void _scene_graph_compute_general(void*                        data,
+                                          const system_math_matrix4x4* current_matrix_ptr,
+                                          system_time                  prev_keyframe_time,
+                                          system_time                  next_keyframe_time,
+                                          float                        lerp_factor,
+                                          system_math_matrix4x4*       out_result_ptr)
 {
-    _scene_graph_node_matrix4x4_static* node_data_ptr = reinterpret_cast<_scene_graph_node_matrix4x4_static*>(data);
-    system_matrix4x4                    new_matrix    = system_matrix4x4_create();
-
-    system_matrix4x4_set_from_matrix4x4(new_matrix,
-                                        current_matrix);
-
-    return new_matrix;
+    *out_result_ptr = *current_matrix_ptr;
 }
 
 /** TODO */
-PRIVATE system_matrix4x4 _scene_graph_compute_rotation_dynamic(void*            data,
-                                                               system_matrix4x4 current_matrix,
-                                                               system_time      prev_keyframe_time,
-                                                               system_time      next_keyframe_time,
-                                                               float            lerp_factor)
+PRIVATE void _scene_graph_compute_rotation_dynamic(void*                        data,
+                                                   const system_math_matrix4x4* current_matrix_ptr,
+                                                   system_time                  prev_keyframe_time,
+                                                   system_time                  next_keyframe_time,
+                                                   float                        lerp_factor,
+                                                   system_math_matrix4x4*       out_result_ptr)
 {
     _scene_graph_node_rotation_dynamic* node_data_ptr = reinterpret_cast<_scene_graph_node_rotation_dynamic*>(data);
-    system_matrix4x4                    new_matrix    = system_matrix4x4_create();
-    system_matrix4x4                    result        = nullptr;
+    system_math_matrix4x4               new_matrix;
     float                               rotation_final        [4];
     float                               rotation_prev_keyframe[4];
     float                               rotation_next_keyframe[4];
@@ -632,29 +655,24 @@ PRIVATE system_matrix4x4 _scene_graph_compute_rotation_dynamic(void*
                                       (rotation_next_keyframe[n_component] - rotation_prev_keyframe[n_component]);
     }
 
-    system_matrix4x4_set_to_identity(new_matrix);
-    system_matrix4x4_rotate         (new_matrix,
-                                     node_data_ptr->uses_radians ? rotation_final[0] : DEG_TO_RAD(rotation_final[0]),
-                                     rotation_final + 1);
-
-    result = system_matrix4x4_create_by_mul(current_matrix,
-                                            new_matrix);
-
-    system_matrix4x4_release(new_matrix);
-
-    return result;
+    system_math_matrix4x4_set_rotation(node_data_ptr->uses_radians ? rotation_final[0] : DEG_TO_RAD(rotation_final[0]),
+                                       rotation_final + 1,
+                                      &new_matrix);
+    system_math_matrix4x4_mul         (current_matrix_ptr,
+                                      &new_matrix,
+                                       out_result_ptr);
 }
 
 /** TODO */
-PRIVATE system_matrix4x4 _scene_graph_compute_scale_dynamic(void*            data,
-                                                            system_matrix4x4 current_matrix,
-                                                            system_time      prev_keyframe_time,
-                                                            system_time      next_keyframe_time,
-                                                            float            lerp_factor)
+PRIVATE void _scene_graph_compute_scale_dynamic(void*                        data,
+                                                const system_math_matrix4x4* current_matrix_ptr,
+                                                system_time                  prev_keyframe_time,
+                                                system_time                  next_keyframe_time,
+                                                float                        lerp_factor,
+                                                system_math_matrix4x4*       out_result_ptr)
 {
     _scene_graph_node_scale_dynamic* node_data_ptr = reinterpret_cast<_scene_graph_node_scale_dynamic*>(data);
-    system_matrix4x4                 new_matrix    = system_matrix4x4_create();
-    system_matrix4x4                 result        = nullptr;
+    system_math_matrix4x4            new_matrix;
     float                            scale_final        [3];
     float                            scale_prev_keyframe[3];
     float                            scale_next_keyframe[3];
@@ -699,41 +717,41 @@ PRIVATE system_matrix4x4 _scene_graph_compute_scale_dynamic(void*            dat
                                    (scale_next_keyframe[n_component] - scale_prev_keyframe[n_component]);
     }
 
-    system_matrix4x4_set_to_identity(new_matrix);
-    system_matrix4x4_scale          (new_matrix,
-                                     scale_final);
-
-    result = system_matrix4x4_create_by_mul(current_matrix,
-                                            new_matrix);
-
-    system_matrix4x4_release(new_matrix);
-
-    return result;
+    system_math_matrix4x4_set_scale(scale_final,
+                                   &new_matrix);
+    system_math_matrix4x4_mul      (current_matrix_ptr,
+                                   &new_matrix,
+                                    out_result_ptr);
 }
 
 /** TODO */
-PRIVATE system_matrix4x4 _scene_graph_compute_static_matrix4x4(void*            data,
-                                                               system_matrix4x4 current_matrix,
-                                                               system_time      prev_keyframe_time,
-                                                               system_time      next_keyframe_time,
-                                                               float            lerp_factor)
+PRIVATE void _scene_graph_compute_static_matrix4x4(void*                        data,
+                                                   const system_math_matrix4x4* current_matrix_ptr,
+                                                   system_time                  prev_keyframe_time,
+                                                   system_time                  next_keyframe_time,
+                                                   float                        lerp_factor,
+                                                   system_math_matrix4x4*       out_result_ptr)
 {
     _scene_graph_node_matrix4x4_static* node_data_ptr = reinterpret_cast<_scene_graph_node_matrix4x4_static*>(data);
+    system_math_matrix4x4               node_matrix;
 
-    return system_matrix4x4_create_by_mul(current_matrix,
-                                          node_data_ptr->matrix);
+    system_math_matrix4x4_set_from_row_major(system_matrix4x4_get_row_major_data(node_data_ptr->matrix),
+                                            &node_matrix);
+    system_math_matrix4x4_mul               (current_matrix_ptr,
+                                            &node_matrix,
+                                             out_result_ptr);
 }
 
 /** TODO */
-PRIVATE system_matrix4x4 _scene_graph_compute_translation_dynamic(void*            data,
-                                                                  system_matrix4x4 current_matrix,
-                                                                  system_time      prev_keyframe_time,
-                                                                  system_time      next_keyframe_time,
-                                                                  float            lerp_factor)
+PRIVATE void _scene_graph_compute_translation_dynamic(void*                        data,
+                                                      const system_math_matrix4x4* current_matrix_ptr,
+                                                      system_time                  prev_keyframe_time,
+                                                      system_time                  next_keyframe_time,
+                                                      float                        lerp_factor,
+                                                      system_math_matrix4x4*       out_result_ptr)
 {
     _scene_graph_node_translation_dynamic* node_data_ptr = reinterpret_cast<_scene_graph_node_translation_dynamic*>(data);
-    system_matrix4x4                       new_matrix    = system_matrix4x4_create();
-    system_matrix4x4                       result        = nullptr;
+    system_math_matrix4x4                  new_matrix;
     float                                  translation_final        [3];
     float                                  translation_prev_keyframe[3];
     float                                  translation_next_keyframe[3];
@@ -783,35 +801,30 @@ PRIVATE system_matrix4x4 _scene_graph_compute_translation_dynamic(void*
                                          (translation_next_keyframe[n_component] - translation_prev_keyframe[n_component]);
     }
 
-    system_matrix4x4_set_to_identity(new_matrix);
-    system_matrix4x4_translate      (new_matrix,
-                                     translation_final);
-
-    result = system_matrix4x4_create_by_mul(current_matrix,
-                                            new_matrix);
-
-    system_matrix4x4_release(new_matrix);
-
-    return result;
+    system_math_matrix4x4_set_translation(translation_final,
+                                         &new_matrix);
+    system_math_matrix4x4_mul            (current_matrix_ptr,
+                                         &new_matrix,
+                                          out_result_ptr);
 }
 
 /** TODO */
-PRIVATE system_matrix4x4 _scene_graph_compute_translation_static(void*            data,
-                                                                 system_matrix4x4 current_matrix,
-                                                                 system_time      prev_keyframe_time,
-                                                                 system_time      next_keyframe_time,
-                                                                 float            lerp_factor)
+PRIVATE void _scene_graph_compute_translation_static(void*                        data,
+                                                     const system_math_matrix4x4* current_matrix_ptr,
+                                                     system_time                  prev_keyframe_time,
+                                                     system_time                  next_keyframe_time,
+                                                     float                        lerp_factor,
+                                                     system_math_matrix4x4*       out_result_ptr)
 {
     _scene_graph_node_translation_static* node_data_ptr = reinterpret_cast<_scene_graph_node_translation_static*>(data);
-    system_matrix4x4                      result        = system_matrix4x4_create();
+    system_math_matrix4x4                 translation_matrix;
 
     /* No need to do any LERPing - static translation is static by definition */
-    system_matrix4x4_set_from_matrix4x4(result,
-                                        current_matrix);
-    system_matrix4x4_translate         (result,
-                                        node_data_ptr->translation);
-
-    return result;
+    system_math_matrix4x4_set_translation(node_data_ptr->translation,
+                                         &translation_matrix);
+    system_math_matrix4x4_mul            (current_matrix_ptr,
+                                         &translation_matrix,
+                                          out_result_ptr);
 }
 
 /** TODO */
@@ -2528,7 +2541,8 @@ PUBLIC EMERALD_API scene_graph_node scene_graph_create_static_matrix4x4_transfor
     /* NOTE: There's one use case (ogl_flyby wrapped in a scene_graph_node) where we need
      *       transformation_matrix.data to be != nullptr.
      *
-     *       This matrix will be released back to the pool upon the first graph traversal.
+     *       Since static matrices are never recomputed, whatever is stored in this matrix
+     *       is what the children are going to be transformed by.
      */
     new_node_ptr->transformation_matrix.data = system_matrix4x4_create();
 
@@ -1561,7 +1561,9 @@ PUBLIC EMERALD_API scene_multiloader scene_multiloader_create_from_filenames(ral
                       n_scene < n_scenes;
                     ++n_scene)
     {
-        serializers[n_scene] = system_file_serializer_create_for_reading(scene_filenames[n_scene]);
+        /* Scene blobs can be large & are parsed once. Map them instead of caching them in the heap, so
+         * that mesh data can be passed over to the buffer memory without being copied. */
+        serializers[n_scene] = system_file_serializer_create_for_reading_mapped_file(scene_filenames[n_scene]);
 
         ASSERT_DEBUG_SYNC(serializers[n_scene] != nullptr,
                           "Could not spawn a serializer for filename [%s]",
@@ -30,6 +30,7 @@
 #include "system/system_callback_manager.h"
 #include "system/system_log.h"
 #include "system/system_hash64map.h"
+#include "system/system_math_matrix4x4.h"
 #include "system/system_math_vector.h"
 #include "system/system_matrix4x4.h"
 #include "system/system_resizable_vector.h"
@@ -68,6 +69,7 @@ typedef struct _scene_renderer_mesh_uber_item
     uint32_t         mesh_id;
     mesh             mesh_instance;
     system_matrix4x4 model_matrix;
+    uint32_t         n_lod;         /* level of detail to use for regular meshes */
     system_matrix4x4 normal_matrix;
     mesh_type        type;
 
@@ -77,6 +79,7 @@ typedef struct _scene_renderer_mesh_uber_item
         mesh_id       = -1;
         mesh_instance = nullptr;
         model_matrix  = nullptr;
+        n_lod         = 0;
         normal_matrix = nullptr;
         type          = MESH_TYPE_UNKNOWN;
     }
@@ -154,8 +157,11 @@ typedef struct _scene_renderer
     system_matrix4x4                    current_model_matrix;
     system_matrix4x4                    current_projection;
     system_matrix4x4                    current_view;
+    uint32_t                            current_viewport_height;
     system_matrix4x4                    current_vp;
 
+    float lod_max_screen_space_error; /* in pixels */
+
     system_resource_pool mesh_pool;           /* holds _scene_renderer_mesh instances */
     system_resource_pool mesh_uber_items_pool;
     system_resource_pool vector_pool;
@@ -227,6 +233,8 @@ PRIVATE void _scene_renderer_update_uber_light_properties             (scene_ren
                                                                        system_matrix4x4           current_camera_view_matrix,
                                                                        system_time                frame_time,
                                                                        system_variant             temp_variant_float);
+PRIVATE uint32_t _scene_renderer_get_mesh_lod(_scene_renderer* renderer_ptr,
+                                              mesh             mesh_instance);
 
 
 /** TODO */
@@ -242,7 +250,9 @@ _scene_renderer::_scene_renderer(ral_context in_context,
     current_mesh_id_to_mesh_map     = system_hash64map_create       (sizeof(_scene_renderer_mesh*) );
     current_model_matrix            = system_matrix4x4_create       ();
     frustum_preview                 = nullptr;    /* can be instantiated at draw time */
+    current_viewport_height         = 0;
     lights_preview                  = nullptr;    /* can be instantiated at draw time */
+    lod_max_screen_space_error      = 1.0f;
     material_manager                = nullptr;
     mesh_pool                       = system_resource_pool_create(sizeof(_scene_renderer_mesh),
                                                                   4,     /* n_elements_to_preallocate */
@@ -520,6 +530,122 @@ PRIVATE void _scene_renderer_get_light_color(scene_light    light,
     }
 }
 
+/** Picks the level of detail a regular mesh should be drawn with. The mesh is assumed to be transformed
+ *  by the current model matrix.
+ *
+ *  The error of each level is projected onto the screen at the point of the mesh's bounding sphere which
+ *  lies closest to the camera, so that the estimate is conservative for the whole mesh.
+ *
+ *  @param renderer_ptr  Scene renderer instance.
+ *  @param mesh_instance Mesh which provides the layer data (ie. the instantiation parent, if any).
+ *
+ *  @return Index of the level of detail to use.
+ */
+PRIVATE uint32_t _scene_renderer_get_mesh_lod(_scene_renderer* renderer_ptr,
+                                              mesh             mesh_instance)
+{
+    const float* aabb_max_ptr    = nullptr;
+    const float* aabb_min_ptr    = nullptr;
+    float        center_model[4];
+    float        center_view [4];
+    float        center_world[4];
+    float        distance        = 0.0f;
+    const float* model_data_ptr  = nullptr;
+    float        model_scale     = 0.0f;
+    uint32_t     n_lods          = 0;
+    float        pixels_per_unit = 0.0f;
+    const float* projection_ptr  = nullptr;
+    float        radius          = 0.0f;
+    uint32_t     result          = 0;
+
+    mesh_get_property(mesh_instance,
+                      MESH_PROPERTY_N_LODS,
+                     &n_lods);
+
+    if (n_lods                                <= 1 ||
+        renderer_ptr->current_viewport_height == 0)
+    {
+        goto end;
+    }
+
+    mesh_get_property(mesh_instance,
+                      MESH_PROPERTY_MODEL_AABB_MAX,
+                     &aabb_max_ptr);
+    mesh_get_property(mesh_instance,
+                      MESH_PROPERTY_MODEL_AABB_MIN,
+                     &aabb_min_ptr);
+
+    for (uint32_t n_component = 0;
+                  n_component < 3;
+                ++n_component)
+    {
+        const float extent = aabb_max_ptr[n_component] - aabb_min_ptr[n_component];
+
+        center_model[n_component] = 0.5f * (aabb_max_ptr[n_component] + aabb_min_ptr[n_component]);
+        radius                   += 0.25f * extent * extent;
+    }
+
+    center_model[3] = 1.0f;
+    radius          = sqrtf(radius);
+
+    /* Errors are measured in model space. Use the largest scale of the model matrix to convert them
+     * to world space. */
+    model_data_ptr = system_matrix4x4_get_row_major_data(renderer_ptr->current_model_matrix);
+
+    for (uint32_t n_column = 0;
+                  n_column < 3;
+                ++n_column)
+    {
+        const float column[3] =
+        {
+            model_data_ptr[0 * 4 + n_column],
+            model_data_ptr[1 * 4 + n_column],
+            model_data_ptr[2 * 4 + n_column]
+        };
+        const float column_length = system_math_vector_length3(column);
+
+        if (model_scale < column_length)
+        {
+            model_scale = column_length;
+        }
+    }
+
+    /* Determine how many pixels a world-space unit covers at the mesh's location */
+    projection_ptr = system_matrix4x4_get_row_major_data(renderer_ptr->current_projection);
+
+    if (projection_ptr[15] != 0.0f)
+    {
+        /* Orthographic projection */
+        pixels_per_unit = projection_ptr[5] * 0.5f * float(renderer_ptr->current_viewport_height);
+    }
+    else
+    {
+        system_matrix4x4_multiply_by_vector4(renderer_ptr->current_model_matrix,
+                                             center_model,
+                                             center_world);
+        system_matrix4x4_multiply_by_vector4(renderer_ptr->current_view,
+                                             center_world,
+                                             center_view);
+
+        distance = system_math_vector_length3(center_view) - radius * model_scale;
+
+        if (distance <= 0.0f)
+        {
+            /* The camera is inside the bounding sphere */
+            goto end;
+        }
+
+        pixels_per_unit = projection_ptr[5] * 0.5f * float(renderer_ptr->current_viewport_height) / distance;
+    }
+
+    result = mesh_select_lod(mesh_instance,
+                             model_scale * pixels_per_unit,
+                             renderer_ptr->lod_max_screen_space_error);
+
+end:
+    return result;
+}
+
 /** TODO */
 PRIVATE void _scene_renderer_get_uber_for_render_mode(_scene_renderer*           renderer_ptr,
                                                       scene_renderer_render_mode render_mode,
@@ -624,6 +750,7 @@ PRIVATE void _scene_renderer_process_mesh_for_forward_rendering(scene_mesh scene
     uint32_t                mesh_id                       = -1;
     system_resizable_vector mesh_materials                = nullptr;
     scene_renderer_uber     mesh_uber                     = nullptr;
+    uint32_t                n_mesh_lod                    = 0;
     unsigned int            n_mesh_materials              = 0;
     _scene_renderer*        renderer_ptr                  = reinterpret_cast<_scene_renderer*>(renderer);
 
@@ -707,6 +834,13 @@ PRIVATE void _scene_renderer_process_mesh_for_forward_rendering(scene_mesh scene
                                 new_entry_ptr);                        /* on_remove_callback_user_arg */
     }
 
+    /* Pick the level of detail, while the model matrix still describes the mesh */
+    if (mesh_instance_type == MESH_TYPE_REGULAR)
+    {
+        n_mesh_lod = _scene_renderer_get_mesh_lod(renderer_ptr,
+                                                  mesh_instantiation_parent_gpu);
+    }
+
     /* Cache the mesh for rendering */
     if (mesh_instance_type == MESH_TYPE_GPU_STREAM ||
         mesh_instance_type == MESH_TYPE_REGULAR)
@@ -768,6 +902,7 @@ PRIVATE void _scene_renderer_process_mesh_for_forward_rendering(scene_mesh scene
             new_mesh_item_ptr->material      = material;
             new_mesh_item_ptr->mesh_id       = mesh_id;
             new_mesh_item_ptr->mesh_instance = mesh_gpu;
+            new_mesh_item_ptr->n_lod         = n_mesh_lod;
             new_mesh_item_ptr->type          = mesh_instance_type;
 
             _scene_renderer_create_model_normal_matrices(renderer_ptr,
@@ -1498,6 +1633,7 @@ PRIVATE ral_present_task _scene_renderer_render_traversed_scene_graph(_scene_ren
                                                             material_uber,
                                                             mesh_ptr->material,
                                                             frame_time,
+                                                            mesh_ptr->n_lod,
                                                            &ref_gfx_state_create_info);
                         }
                     }
@@ -1520,6 +1656,7 @@ PRIVATE ral_present_task _scene_renderer_render_traversed_scene_graph(_scene_ren
                                                         material_uber,
                                                         item_ptr->material,
                                                         frame_time,
+                                                        item_ptr->n_lod,
                                                        &ref_gfx_state_create_info);
                     }
                 }
@@ -2566,45 +2703,18 @@ PUBLIC bool scene_renderer_cull_against_frustum(scene_renderer
                       aabb_max_ptr[2] != aabb_min_ptr[2],
                       "Sanity checks failed");
 
-    /* Prepare an array holding OBB of the model's AABB transformed into clip space. */
     /* Transform the model-space AABB to world-space */
-    float world_aabb_max     [3];
-    float world_aabb_min     [3];
-    float world_aabb_vertices[8][4];
-
-    for (uint32_t n_vertex = 0;
-                  n_vertex < 8;
-                ++n_vertex)
-    {
-        float vertex[4] =
-        {
-            (n_vertex & 1) ? aabb_max_ptr[0] : aabb_min_ptr[0],
-            (n_vertex & 2) ? aabb_max_ptr[1] : aabb_min_ptr[1],
-            (n_vertex & 4) ? aabb_max_ptr[2] : aabb_min_ptr[2],
-            1.0f
-        };
-
-        system_matrix4x4_multiply_by_vector4(renderer_ptr->current_model_matrix,
-                                             vertex,
-                                             world_aabb_vertices[n_vertex]);
-
-        for (uint32_t n = 0;
-                      n < 3;
-                    ++n)
-        {
-            if (n_vertex == 0 ||
-                n_vertex != 0 && world_aabb_min[n] > world_aabb_vertices[n_vertex][n])
-            {
-                world_aabb_min[n] = world_aabb_vertices[n_vertex][n];
-            }
-
-            if (n_vertex == 0 ||
-                n_vertex != 0 && world_aabb_max[n] < world_aabb_vertices[n_vertex][n])
-            {
-                world_aabb_max[n] = world_aabb_vertices[n_vertex][n];
-            }
-        }
-    }
+    system_math_matrix4x4 model_matrix;
+    float                 world_aabb_max[3];
+    float                 world_aabb_min[3];
+
+    system_math_matrix4x4_set_from_row_major(system_matrix4x4_get_row_major_data(renderer_ptr->current_model_matrix),
+                                            &model_matrix);
+    system_math_matrix4x4_transform_aabb    (&model_matrix,
+                                             aabb_min_ptr,
+                                             aabb_max_ptr,
+                                             world_aabb_min,
+                                             world_aabb_max);
 
     /* Execute requested culling behavior */
     switch (behavior)
@@ -2672,106 +2782,26 @@ PUBLIC bool scene_renderer_cull_against_frustum(scene_renderer
 
         case SCENE_RENDERER_FRUSTUM_CULLING_BEHAVIOR_USE_CAMERA_CLIPPING_PLANES:
         {
-            /* Retrieve clipping planes from the VP. This gives us world clipping planes in world space. */
-            float world_clipping_plane_bottom[4];
-            float world_clipping_plane_front [4];
-            float world_clipping_plane_left  [4];
-            float world_clipping_plane_near  [4];
-            float world_clipping_plane_right [4];
-            float world_clipping_plane_top   [4];
-
-            system_matrix4x4_get_clipping_plane(renderer_ptr->current_vp,
-                                                SYSTEM_MATRIX4X4_CLIPPING_PLANE_BOTTOM,
-                                                world_clipping_plane_bottom);
-            system_matrix4x4_get_clipping_plane(renderer_ptr->current_vp,
-                                                SYSTEM_MATRIX4X4_CLIPPING_PLANE_FAR,
-                                                world_clipping_plane_front);
-            system_matrix4x4_get_clipping_plane(renderer_ptr->current_vp,
-                                                SYSTEM_MATRIX4X4_CLIPPING_PLANE_LEFT,
-                                                world_clipping_plane_left);
-            system_matrix4x4_get_clipping_plane(renderer_ptr->current_vp,
-                                                SYSTEM_MATRIX4X4_CLIPPING_PLANE_NEAR,
-                                                world_clipping_plane_near);
-            system_matrix4x4_get_clipping_plane(renderer_ptr->current_vp,
-                                                SYSTEM_MATRIX4X4_CLIPPING_PLANE_RIGHT,
-                                                world_clipping_plane_right);
-            system_matrix4x4_get_clipping_plane(renderer_ptr->current_vp,
-                                                SYSTEM_MATRIX4X4_CLIPPING_PLANE_TOP,
-                                                world_clipping_plane_top);
-
-            system_math_vector_normalize4_use_vec3_length(world_clipping_plane_bottom,
-                                                          world_clipping_plane_bottom);
-            system_math_vector_normalize4_use_vec3_length(world_clipping_plane_front,
-                                                          world_clipping_plane_front);
-            system_math_vector_normalize4_use_vec3_length(world_clipping_plane_left,
-                                                          world_clipping_plane_left);
-            system_math_vector_normalize4_use_vec3_length(world_clipping_plane_near,
-                                                          world_clipping_plane_near);
-            system_math_vector_normalize4_use_vec3_length(world_clipping_plane_right,
-                                                          world_clipping_plane_right);
-            system_math_vector_normalize4_use_vec3_length(world_clipping_plane_top,
-                                                          world_clipping_plane_top);
-
-            /* Iterate over all clipping planes.. */
-            const float* clipping_planes[] =
-            {
-                world_clipping_plane_bottom,
-                world_clipping_plane_front,
-                world_clipping_plane_left,
-                world_clipping_plane_near,
-                world_clipping_plane_right,
-                world_clipping_plane_top
-            };
-            const uint32_t n_clipping_planes = sizeof(clipping_planes) / sizeof(clipping_planes[0]);
-
-            for (uint32_t n_clipping_plane = 0;
-                          n_clipping_plane < n_clipping_planes;
-                        ++n_clipping_plane)
+            /* Clipping planes extracted from the MVP are expressed in model space, so the model-space
+             * AABB can be tested against them directly. This is equivalent to testing the world-space
+             * OBB of the mesh against the world-space clipping planes of the VP. */
+            system_math_matrix4x4 mvp;
+            system_math_matrix4x4 vp;
+
+            system_math_matrix4x4_set_from_row_major(system_matrix4x4_get_row_major_data(renderer_ptr->current_vp),
+                                                    &vp);
+            system_math_matrix4x4_mul               (&vp,
+                                                     &model_matrix,
+                                                     &mvp);
+
+            if (system_math_matrix4x4_is_aabb_outside_frustum(&mvp,
+                                                              aabb_min_ptr,
+                                                              aabb_max_ptr) )
             {
-                const float* clipping_plane  = clipping_planes[n_clipping_plane];
-                unsigned int counter_inside  = 0;
-                unsigned int counter_outside = 0;
-
-                /* Compute plane normal */
-                float clipping_plane_normal[4] =
-                {
-                    clipping_plane[0],
-                    clipping_plane[1],
-                    clipping_plane[2],
-                    clipping_plane[3]
-                };
-
-                for (uint32_t n_vertex = 0;
-                              n_vertex < 8 && (counter_inside == 0 || counter_outside == 0);
-                            ++n_vertex)
-                {
-                    /* Is the vertex inside? */
-                    float distance = clipping_plane_normal[3] + ((world_aabb_vertices[n_vertex][0] * clipping_plane_normal[0]) +
-                                                                 (world_aabb_vertices[n_vertex][1] * clipping_plane_normal[1]) +
-                                                                 (world_aabb_vertices[n_vertex][2] * clipping_plane_normal[2]) );
-
-                    if (distance < 0)
-                    {
-                        counter_outside++;
-                    }
-                    else
-                    {
-                        counter_inside++;
-                    }
-                }
-
-                if (counter_inside == 0)
-                {
-                    /* BBox is outside, no need to render */
-                    result = false;
+                /* BBox is outside, no need to render */
+                result = false;
 
-                    goto end;
-                }
-                else
-                if (counter_outside > 0)
-                {
-                    /* Intersection, need to keep iterating */
-                }
+                goto end;
             }
 
             break;
@@ -2983,6 +3013,19 @@ PUBLIC EMERALD_API ral_present_task scene_renderer_get_present_task_for_scene_gr
                                   viewport_size);
 
     }
+    /* Levels of detail are picked against the height of the render target */
+    renderer_ptr->current_viewport_height = 0;
+
+    if (color_rt != nullptr ||
+        depth_rt != nullptr)
+    {
+        ral_texture_view_get_mipmap_property((color_rt != nullptr) ? color_rt : depth_rt,
+                                             0, /* n_layer */
+                                             0, /* n_mipmap */
+                                             RAL_TEXTURE_MIPMAP_PROPERTY_HEIGHT,
+                                            &renderer_ptr->current_viewport_height);
+    }
+
     /* 1. Traverse the scene graph and:
      *
      *    - update light direction vectors.
@@ -3130,6 +3173,13 @@ PUBLIC EMERALD_API void scene_renderer_get_property(const scene_renderer    rend
             break;
         }
 
+        case SCENE_RENDERER_PROPERTY_LOD_MAX_SCREEN_SPACE_ERROR:
+        {
+            *reinterpret_cast<float*>(out_result_ptr) = renderer_ptr->lod_max_screen_space_error;
+
+            break;
+        }
+
         case SCENE_RENDERER_PROPERTY_MESH_MODEL_MATRIX:
         {
             *reinterpret_cast<system_matrix4x4*>(out_result_ptr) = renderer_ptr->current_model_matrix;
@@ -3197,6 +3247,13 @@ PUBLIC EMERALD_API void scene_renderer_set_property(scene_renderer          rend
 
     switch (property)
     {
+        case SCENE_RENDERER_PROPERTY_LOD_MAX_SCREEN_SPACE_ERROR:
+        {
+            renderer_ptr->lod_max_screen_space_error = *reinterpret_cast<const float*>(data);
+
+            break;
+        }
+
         case SCENE_RENDERER_PROPERTY_VISIBLE_WORLD_AABB_MAX:
         {
             memcpy(renderer_ptr->current_camera_visible_world_aabb_max,
@@ -3745,6 +3745,7 @@ PUBLIC ral_present_task scene_renderer_sm_render_shadow_map_meshes(scene_rendere
                                             sm_material_uber,
                                             nullptr, /* material */
                                             frame_time,
+                                            0,       /* n_lod */
                                            &shadow_mapping_ptr->current_gfx_state_create_info);
         }
     }
@@ -2105,6 +2105,7 @@ PUBLIC void scene_renderer_uber_render_mesh(mesh                             mes
                                             scene_renderer_uber              uber,
                                             mesh_material                    material,
                                             system_time                      time,
+                                            uint32_t                         n_lod,
                                             const ral_gfx_state_create_info* ref_gfx_state_create_info_ptr)
 {
     _scene_renderer_uber* uber_ptr = reinterpret_cast<_scene_renderer_uber*>(uber);
@@ -2601,33 +2602,38 @@ PUBLIC void scene_renderer_uber_render_mesh(mesh                             mes
                                       MESH_PROPERTY_BO_INDEX_TYPE,
                                      &index_type);
 
-                    /* Proceed with the actual draw call */
+                    /* Proceed with the actual draw call. All levels of detail share the vertex data, so only
+                     * the index range depends on the level. */
                     ral_command_buffer_draw_call_indexed_command_info draw_call_info;
                     uint32_t                                          layer_pass_index_data_offset = 0;
                     uint32_t                                          layer_pass_index_max_value   = 0;
                     uint32_t                                          layer_pass_index_min_value   = 0;
                     uint32_t                                          layer_pass_n_indices         = 0;
 
-                    mesh_get_layer_pass_property(mesh_instantiation_parent_gpu,
-                                                 n_layer,
-                                                 n_layer_pass,
-                                                 MESH_LAYER_PROPERTY_BO_ELEMENTS_OFFSET,
-                                                &layer_pass_index_data_offset);
-                    mesh_get_layer_pass_property(mesh_instantiation_parent_gpu,
-                                                 n_layer,
-                                                 n_layer_pass,
-                                                 MESH_LAYER_PROPERTY_BO_ELEMENTS_DATA_MAX_INDEX,
-                                                &layer_pass_index_max_value);
-                    mesh_get_layer_pass_property(mesh_instantiation_parent_gpu,
-                                                 n_layer,
-                                                 n_layer_pass,
-                                                 MESH_LAYER_PROPERTY_BO_ELEMENTS_DATA_MIN_INDEX,
-                                                &layer_pass_index_min_value);
-                    mesh_get_layer_pass_property(mesh_instantiation_parent_gpu,
-                                                 n_layer,
-                                                 n_layer_pass,
-                                                 MESH_LAYER_PROPERTY_N_ELEMENTS,
-                                                &layer_pass_n_indices);
+                    mesh_get_layer_pass_lod_property(mesh_instantiation_parent_gpu,
+                                                     n_layer,
+                                                     n_layer_pass,
+                                                     n_lod,
+                                                     MESH_LAYER_PROPERTY_BO_ELEMENTS_OFFSET,
+                                                    &layer_pass_index_data_offset);
+                    mesh_get_layer_pass_lod_property(mesh_instantiation_parent_gpu,
+                                                     n_layer,
+                                                     n_layer_pass,
+                                                     n_lod,
+                                                     MESH_LAYER_PROPERTY_BO_ELEMENTS_DATA_MAX_INDEX,
+                                                    &layer_pass_index_max_value);
+                    mesh_get_layer_pass_lod_property(mesh_instantiation_parent_gpu,
+                                                     n_layer,
+                                                     n_layer_pass,
+                                                     n_lod,
+                                                     MESH_LAYER_PROPERTY_BO_ELEMENTS_DATA_MIN_INDEX,
+                                                    &layer_pass_index_min_value);
+                    mesh_get_layer_pass_lod_property(mesh_instantiation_parent_gpu,
+                                                     n_layer,
+                                                     n_layer_pass,
+                                                     n_lod,
+                                                     MESH_LAYER_PROPERTY_N_ELEMENTS,
+                                                    &layer_pass_n_indices);
 
                     switch (index_type)
                     {
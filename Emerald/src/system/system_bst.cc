@@ -5,203 +5,637 @@
  */
 #include "shared.h"
 #include "system/system_bst.h"
+#include "system/system_constants.h"
 #include "system/system_linear_alloc_pin.h"
 #include <string.h>
 
+/* Minimum degree of the B-tree. Each node other than the root holds between (t - 1) and (2t - 1) keys. */
+#define BST_MIN_DEGREE ((BST_MAX_KEYS_PER_NODE + 1) / 2)
+
+static_assert(BST_MAX_KEYS_PER_NODE % 2 == 1,
+              "BST_MAX_KEYS_PER_NODE must be odd");
+
 /** Internal type definitions */
-/** TODO */
+
+/** Header of a single B-tree node. The header is followed by BST_MAX_KEYS_PER_NODE keys, which are in turn
+ *  followed by BST_MAX_KEYS_PER_NODE values. Both are stored inline, so that a binary search within a node
+ *  does not need to chase pointers.
+ */
 typedef struct _system_bst_node _system_bst_node;
 
 struct _system_bst_node
 {
-    system_bst_key    key;
-    system_bst_value  value;
-
-    _system_bst_node* left;
-    _system_bst_node* right;
+    _system_bst_node* children[BST_MAX_KEYS_PER_NODE + 1];
+    bool              is_leaf;
+    unsigned int      n_keys;
 };
 
 /** TODO */
 typedef struct
 {
-    system_linear_alloc_pin      key_allocator;
     system_bst_value_equals_func key_equals_func;
     system_bst_value_lower_func  key_lower_func;
+    unsigned int                 key_n_components;
     size_t                       key_size;
+    system_bst_key_type          key_type;
     system_linear_alloc_pin      node_allocator;
-    _system_bst_node             root;
-    system_linear_alloc_pin      value_allocator;
+    size_t                       node_keys_offset;
+    size_t                       node_values_offset;
+    _system_bst_node*            root_ptr;
     size_t                       value_size;
 } _system_bst;
 
+/** Compares keys by calling user-provided functions. */
+struct _system_bst_custom_comparator
+{
+    system_bst_value_equals_func key_equals_func;
+    system_bst_value_lower_func  key_lower_func;
+    size_t                       key_size;
+
+    explicit _system_bst_custom_comparator(const _system_bst* bst_ptr)
+    {
+        key_equals_func = bst_ptr->key_equals_func;
+        key_lower_func  = bst_ptr->key_lower_func;
+        key_size        = bst_ptr->key_size;
+    }
+
+    inline bool is_equal(const void* key1,
+                         const void* key2) const
+    {
+        return key_equals_func(key_size,
+                               const_cast<void*>(key1),
+                               const_cast<void*>(key2) );
+    }
+
+    inline bool is_lower(const void* key1,
+                         const void* key2) const
+    {
+        return key_lower_func(key_size,
+                              const_cast<void*>(key1),
+                              const_cast<void*>(key2) );
+    }
+};
+
+/** Compares arrays of type_t values lexicographically. */
+template <typename type_t>
+struct _system_bst_array_comparator
+{
+    unsigned int n_components;
+
+    explicit _system_bst_array_comparator(const _system_bst* bst_ptr)
+    {
+        n_components = bst_ptr->key_n_components;
+    }
+
+    inline bool is_equal(const void* key1,
+                         const void* key2) const
+    {
+        const type_t* key1_ptr = reinterpret_cast<const type_t*>(key1);
+        const type_t* key2_ptr = reinterpret_cast<const type_t*>(key2);
+
+        for (unsigned int n_component = 0;
+                          n_component < n_components;
+                        ++n_component)
+        {
+            if (!(key1_ptr[n_component] == key2_ptr[n_component]) )
+            {
+                return false;
+            }
+        }
+
+        return true;
+    }
+
+    inline bool is_lower(const void* key1,
+                         const void* key2) const
+    {
+        const type_t* key1_ptr = reinterpret_cast<const type_t*>(key1);
+        const type_t* key2_ptr = reinterpret_cast<const type_t*>(key2);
+
+        for (unsigned int n_component = 0;
+                          n_component < n_components;
+                        ++n_component)
+        {
+            if (key1_ptr[n_component] < key2_ptr[n_component])
+            {
+                return true;
+            }
+
+            if (key2_ptr[n_component] < key1_ptr[n_component])
+            {
+                return false;
+            }
+        }
+
+        return false;
+    }
+};
+
+
 /** TODO */
-PRIVATE void _init_system_bst_node(_system_bst_node* node_ptr,
-                                   system_bst_key    key,
-                                   system_bst_value  value)
-{
-    node_ptr->key   = key;
-    node_ptr->value = value;
-    node_ptr->left  = NULL;
-    node_ptr->right = NULL;
+PRIVATE inline unsigned char* _system_bst_get_node_key(const _system_bst* bst_ptr,
+                                                       _system_bst_node*  node_ptr,
+                                                       unsigned int       n_key)
+{
+    return reinterpret_cast<unsigned char*>(node_ptr) + bst_ptr->node_keys_offset + n_key * bst_ptr->key_size;
 }
 
+/** TODO */
+PRIVATE inline unsigned char* _system_bst_get_node_value(const _system_bst* bst_ptr,
+                                                         _system_bst_node*  node_ptr,
+                                                         unsigned int       n_value)
+{
+    return reinterpret_cast<unsigned char*>(node_ptr) + bst_ptr->node_values_offset + n_value * bst_ptr->value_size;
+}
 
-/* Please see header for specification */
-PUBLIC EMERALD_API system_bst system_bst_create(size_t                       key_size,
-                                                size_t                       value_size,
-                                                system_bst_value_lower_func  key_lower_func,
-                                                system_bst_value_equals_func key_equals_func,
-                                                system_bst_key               initial_key,
-                                                system_bst_value             initial_value)
+/** Returns index of the first key stored in the node, which is not lower than @param key. */
+template <typename comparator_t>
+PRIVATE inline unsigned int _system_bst_find_lower_bound(const _system_bst*  bst_ptr,
+                                                         const comparator_t& comparator,
+                                                         _system_bst_node*   node_ptr,
+                                                         const void*         key)
 {
-    _system_bst* new_instance = new (std::nothrow) _system_bst;
+    unsigned int n_first = 0;
+    unsigned int n_last  = node_ptr->n_keys;
 
-    ASSERT_ALWAYS_SYNC(new_instance != NULL, "Out of memory");
-    if (new_instance != NULL)
+    while (n_first < n_last)
     {
-        new_instance->key_allocator   = system_linear_alloc_pin_create(key_size,
-                                                                       512, /* n_entries_to_prealloc */
-                                                                       1);  /* n_pins_to_prealloc    */
-        new_instance->key_equals_func = key_equals_func;
-        new_instance->key_lower_func  = key_lower_func;
-        new_instance->key_size        = key_size;
-        new_instance->node_allocator  = system_linear_alloc_pin_create(sizeof(_system_bst_node),
-                                                                       512, /* n_entries_to_prealloc */
-                                                                       1);  /* n_pins_to_prealloc    */
-        new_instance->value_allocator = system_linear_alloc_pin_create(value_size,
-                                                                       512, /* n_entries_to_prealloc */
-                                                                       1);  /* n_pins_to_prealloc    */
-        new_instance->value_size      = value_size;
-
-        /* Create key & value copies */
-        void* key_copy   = system_linear_alloc_pin_get_from_pool(new_instance->key_allocator);
-        void* value_copy = system_linear_alloc_pin_get_from_pool(new_instance->value_allocator);
-
-        memcpy(key_copy,
-               initial_key,
-               key_size);
-        memcpy(value_copy,
-               initial_value,
-               value_size);
-
-        _init_system_bst_node(&new_instance->root,
-                              (system_bst_key) key_copy,
-                              (system_bst_value) value_copy);
+        const unsigned int n_middle = n_first + (n_last - n_first) / 2;
+
+        if (comparator.is_lower(_system_bst_get_node_key(bst_ptr,
+                                                         node_ptr,
+                                                         n_middle),
+                                key) )
+        {
+            n_first = n_middle + 1;
+        }
+        else
+        {
+            n_last = n_middle;
+        }
     }
 
-    return (system_bst) new_instance;
+    return n_first;
 }
 
-/* Please see header for specification */
-PUBLIC EMERALD_API bool system_bst_get(system_bst        bst,
-                                       system_bst_key    key,
-                                       system_bst_value* result)
+/** TODO */
+PRIVATE _system_bst_node* _system_bst_create_node(_system_bst* bst_ptr,
+                                                  bool         is_leaf)
+{
+    _system_bst_node* new_node_ptr = reinterpret_cast<_system_bst_node*>(system_linear_alloc_pin_get_from_pool(bst_ptr->node_allocator) );
+
+    new_node_ptr->is_leaf = is_leaf;
+    new_node_ptr->n_keys  = 0;
+
+    return new_node_ptr;
+}
+
+/** Splits a full child node of @param parent_node_ptr into two halves. The median key is moved to the parent node.
+ *
+ *  @param bst_ptr         BST instance.
+ *  @param parent_node_ptr Non-full parent node.
+ *  @param n_child         Index of the full child node to split.
+ */
+PRIVATE void _system_bst_split_child_node(_system_bst*      bst_ptr,
+                                          _system_bst_node* parent_node_ptr,
+                                          unsigned int      n_child)
+{
+    _system_bst_node* left_node_ptr  = parent_node_ptr->children[n_child];
+    _system_bst_node* right_node_ptr = _system_bst_create_node(bst_ptr,
+                                                               left_node_ptr->is_leaf);
+
+    ASSERT_DEBUG_SYNC(left_node_ptr->n_keys   == BST_MAX_KEYS_PER_NODE &&
+                      parent_node_ptr->n_keys <  BST_MAX_KEYS_PER_NODE,
+                      "Invalid node split request");
+
+    /* Move the upper half of the child's keys & values to the new node */
+    right_node_ptr->n_keys = BST_MIN_DEGREE - 1;
+
+    memcpy(_system_bst_get_node_key(bst_ptr,
+                                    right_node_ptr,
+                                    0),
+           _system_bst_get_node_key(bst_ptr,
+                                    left_node_ptr,
+                                    BST_MIN_DEGREE),
+           (BST_MIN_DEGREE - 1) * bst_ptr->key_size);
+    memcpy(_system_bst_get_node_value(bst_ptr,
+                                      right_node_ptr,
+                                      0),
+           _system_bst_get_node_value(bst_ptr,
+                                      left_node_ptr,
+                                      BST_MIN_DEGREE),
+           (BST_MIN_DEGREE - 1) * bst_ptr->value_size);
+
+    if (!left_node_ptr->is_leaf)
+    {
+        memcpy(right_node_ptr->children,
+               left_node_ptr->children + BST_MIN_DEGREE,
+               BST_MIN_DEGREE * sizeof(_system_bst_node*) );
+    }
+
+    left_node_ptr->n_keys = BST_MIN_DEGREE - 1;
+
+    /* Make room for the median key & the new child in the parent node */
+    const unsigned int n_keys_to_move = parent_node_ptr->n_keys - n_child;
+
+    memmove(parent_node_ptr->children + n_child + 2,
+            parent_node_ptr->children + n_child + 1,
+            n_keys_to_move * sizeof(_system_bst_node*) );
+    memmove(_system_bst_get_node_key(bst_ptr,
+                                     parent_node_ptr,
+                                     n_child + 1),
+            _system_bst_get_node_key(bst_ptr,
+                                     parent_node_ptr,
+                                     n_child),
+            n_keys_to_move * bst_ptr->key_size);
+    memmove(_system_bst_get_node_value(bst_ptr,
+                                       parent_node_ptr,
+                                       n_child + 1),
+            _system_bst_get_node_value(bst_ptr,
+                                       parent_node_ptr,
+                                       n_child),
+            n_keys_to_move * bst_ptr->value_size);
+
+    parent_node_ptr->children[n_child + 1] = right_node_ptr;
+
+    memcpy(_system_bst_get_node_key(bst_ptr,
+                                    parent_node_ptr,
+                                    n_child),
+           _system_bst_get_node_key(bst_ptr,
+                                    left_node_ptr,
+                                    BST_MIN_DEGREE - 1),
+           bst_ptr->key_size);
+    memcpy(_system_bst_get_node_value(bst_ptr,
+                                      parent_node_ptr,
+                                      n_child),
+           _system_bst_get_node_value(bst_ptr,
+                                      left_node_ptr,
+                                      BST_MIN_DEGREE - 1),
+           bst_ptr->value_size);
+
+    parent_node_ptr->n_keys++;
+}
+
+/** TODO */
+template <typename comparator_t>
+PRIVATE bool _system_bst_get(const _system_bst*  bst_ptr,
+                             const comparator_t& comparator,
+                             const void*         key,
+                             void*               out_value)
 {
-    _system_bst*      bst_ptr        = (_system_bst*) bst;
-    _system_bst_node* current_node   = &bst_ptr->root;
-    bool              logical_result = false;
+    _system_bst_node* current_node_ptr = bst_ptr->root_ptr;
 
-    while (current_node != NULL)
+    while (true)
     {
-        if (bst_ptr->key_equals_func(bst_ptr->key_size,
-                                     current_node->key,
-                                     key) )
+        const unsigned int n_key = _system_bst_find_lower_bound(bst_ptr,
+                                                                comparator,
+                                                                current_node_ptr,
+                                                                key);
+
+        if (n_key < current_node_ptr->n_keys              &&
+            comparator.is_equal(_system_bst_get_node_key(bst_ptr,
+                                                         current_node_ptr,
+                                                         n_key),
+                                key) )
         {
-            if (result != NULL)
+            if (out_value != NULL)
             {
-                memcpy(result,
-                       current_node->value,
+                memcpy(out_value,
+                       _system_bst_get_node_value(bst_ptr,
+                                                  current_node_ptr,
+                                                  n_key),
                        bst_ptr->value_size);
             }
 
-            logical_result = true;
+            return true;
+        }
+
+        if (current_node_ptr->is_leaf)
+        {
             break;
         }
 
-        if (bst_ptr->key_lower_func(bst_ptr->key_size,
-                                    current_node->key,
-                                    key) )
+        current_node_ptr = current_node_ptr->children[n_key];
+    }
+
+    return false;
+}
+
+/** Inserts a key->value pair into the tree. Full nodes met on the way down are split up-front, so that
+ *  the tree is only ever traversed once.
+ */
+template <typename comparator_t>
+PRIVATE void _system_bst_insert(_system_bst*        bst_ptr,
+                                const comparator_t& comparator,
+                                const void*         key,
+                                const void*         value)
+{
+    if (bst_ptr->root_ptr->n_keys == BST_MAX_KEYS_PER_NODE)
+    {
+        _system_bst_node* new_root_ptr = _system_bst_create_node(bst_ptr,
+                                                                 false); /* is_leaf */
+
+        new_root_ptr->children[0] = bst_ptr->root_ptr;
+        bst_ptr->root_ptr         = new_root_ptr;
+
+        _system_bst_split_child_node(bst_ptr,
+                                     new_root_ptr,
+                                     0); /* n_child */
+    }
+
+    _system_bst_node* current_node_ptr = bst_ptr->root_ptr;
+
+    while (true)
+    {
+        unsigned int n_key = _system_bst_find_lower_bound(bst_ptr,
+                                                          comparator,
+                                                          current_node_ptr,
+                                                          key);
+
+        if (n_key < current_node_ptr->n_keys              &&
+            comparator.is_equal(_system_bst_get_node_key(bst_ptr,
+                                                         current_node_ptr,
+                                                         n_key),
+                                key) )
         {
-            if (current_node->left != NULL)
+            /* Key already stored */
+            break;
+        }
+
+        if (current_node_ptr->is_leaf)
+        {
+            const unsigned int n_keys_to_move = current_node_ptr->n_keys - n_key;
+
+            memmove(_system_bst_get_node_key(bst_ptr,
+                                             current_node_ptr,
+                                             n_key + 1),
+                    _system_bst_get_node_key(bst_ptr,
+                                             current_node_ptr,
+                                             n_key),
+                    n_keys_to_move * bst_ptr->key_size);
+            memmove(_system_bst_get_node_value(bst_ptr,
+                                               current_node_ptr,
+                                               n_key + 1),
+                    _system_bst_get_node_value(bst_ptr,
+                                               current_node_ptr,
+                                               n_key),
+                    n_keys_to_move * bst_ptr->value_size);
+
+            memcpy(_system_bst_get_node_key(bst_ptr,
+                                            current_node_ptr,
+                                            n_key),
+                   key,
+                   bst_ptr->key_size);
+            memcpy(_system_bst_get_node_value(bst_ptr,
+                                              current_node_ptr,
+                                              n_key),
+                   value,
+                   bst_ptr->value_size);
+
+            current_node_ptr->n_keys++;
+            break;
+        }
+
+        if (current_node_ptr->children[n_key]->n_keys == BST_MAX_KEYS_PER_NODE)
+        {
+            _system_bst_split_child_node(bst_ptr,
+                                         current_node_ptr,
+                                         n_key);
+
+            /* The median key of the child has just landed at n_key */
+            const void* median_key = _system_bst_get_node_key(bst_ptr,
+                                                              current_node_ptr,
+                                                              n_key);
+
+            if (comparator.is_lower(median_key,
+                                    key) )
             {
-                current_node = current_node->left;
+                n_key++;
             }
             else
+            if (comparator.is_equal(median_key,
+                                    key) )
             {
                 break;
             }
         }
-        else
+
+        current_node_ptr = current_node_ptr->children[n_key];
+    }
+}
+
+/** TODO */
+PRIVATE system_bst _system_bst_create(system_bst_key_type          key_type,
+                                      size_t                       key_size,
+                                      size_t                       value_size,
+                                      system_bst_value_lower_func  key_lower_func,
+                                      system_bst_value_equals_func key_equals_func,
+                                      system_bst_key               initial_key,
+                                      system_bst_value             initial_value)
+{
+    _system_bst* new_instance = new (std::nothrow) _system_bst;
+
+    ASSERT_ALWAYS_SYNC(new_instance != NULL, "Out of memory");
+    if (new_instance != NULL)
+    {
+        /* Align the inline key & value arrays to pointer size */
+        const size_t keys_size   = BST_MAX_KEYS_PER_NODE * key_size;
+        const size_t alignment   = sizeof(void*);
+        const size_t values_size = BST_MAX_KEYS_PER_NODE * value_size;
+
+        new_instance->key_equals_func    = key_equals_func;
+        new_instance->key_lower_func     = key_lower_func;
+        new_instance->key_n_components   = 0;
+        new_instance->key_size           = key_size;
+        new_instance->key_type           = key_type;
+        new_instance->node_keys_offset   = (sizeof(_system_bst_node)  + alignment - 1) / alignment * alignment;
+        new_instance->node_values_offset = (new_instance->node_keys_offset + keys_size + alignment - 1) / alignment * alignment;
+        new_instance->value_size         = value_size;
+
+        switch (key_type)
         {
-            if (current_node->right != NULL)
+            case SYSTEM_BST_KEY_TYPE_CUSTOM:
             {
-                current_node = current_node->right;
+                ASSERT_DEBUG_SYNC(key_equals_func != NULL &&
+                                  key_lower_func  != NULL,
+                                  "Key comparison functions must not be NULL.");
+
+                break;
             }
-            else
+
+            case SYSTEM_BST_KEY_TYPE_FLOAT_ARRAY:
             {
+                ASSERT_DEBUG_SYNC(key_size % sizeof(float) == 0,
+                                  "Key size is not a multiple of sizeof(float)");
+
+                new_instance->key_n_components = (unsigned int) (key_size / sizeof(float) );
+
                 break;
             }
-        }
+
+            case SYSTEM_BST_KEY_TYPE_UINT32_ARRAY:
+            {
+                ASSERT_DEBUG_SYNC(key_size % sizeof(uint32_t) == 0,
+                                  "Key size is not a multiple of sizeof(uint32_t)");
+
+                new_instance->key_n_components = (unsigned int) (key_size / sizeof(uint32_t) );
+
+                break;
+            }
+
+            default:
+            {
+                ASSERT_DEBUG_SYNC(false,
+                                  "Unrecognized key type");
+            }
+        } /* switch (key_type) */
+
+        new_instance->node_allocator = system_linear_alloc_pin_create(new_instance->node_values_offset + values_size,
+                                                                      BST_N_NODES_TO_PREALLOC, /* n_entries_to_prealloc */
+                                                                      1);                      /* n_pins_to_prealloc    */
+        new_instance->root_ptr       = _system_bst_create_node(new_instance,
+                                                               true); /* is_leaf */
+
+        system_bst_insert( (system_bst) new_instance,
+                          initial_key,
+                          initial_value);
     }
 
-    return logical_result;
+    return (system_bst) new_instance;
 }
 
+
 /* Please see header for specification */
-PUBLIC EMERALD_API void system_bst_insert(system_bst       bst,
-                                          system_bst_key   key,
-                                          system_bst_value value)
+PUBLIC EMERALD_API system_bst system_bst_create(size_t                       key_size,
+                                                size_t                       value_size,
+                                                system_bst_value_lower_func  key_lower_func,
+                                                system_bst_value_equals_func key_equals_func,
+                                                system_bst_key               initial_key,
+                                                system_bst_value             initial_value)
+{
+    return _system_bst_create(SYSTEM_BST_KEY_TYPE_CUSTOM,
+                              key_size,
+                              value_size,
+                              key_lower_func,
+                              key_equals_func,
+                              initial_key,
+                              initial_value);
+}
+
+/* Please see header for specification */
+PUBLIC EMERALD_API system_bst system_bst_create_for_key_type(system_bst_key_type key_type,
+                                                             size_t              key_size,
+                                                             size_t              value_size,
+                                                             system_bst_key      initial_key,
+                                                             system_bst_value    initial_value)
 {
-    _system_bst*      bst_ptr       = (_system_bst*) bst;
-    _system_bst_node* current_node  = &bst_ptr->root;
-    bool              is_lower_eq   = false;
-    _system_bst_node* previous_node = current_node;
-    
-    while (current_node != NULL)
+    ASSERT_DEBUG_SYNC(key_type != SYSTEM_BST_KEY_TYPE_CUSTOM,
+                      "Use system_bst_create() to create BSTs with custom key comparison functions.");
+
+    return _system_bst_create(key_type,
+                              key_size,
+                              value_size,
+                              NULL, /* key_lower_func  */
+                              NULL, /* key_equals_func */
+                              initial_key,
+                              initial_value);
+}
+
+/* Please see header for specification */
+PUBLIC EMERALD_API bool system_bst_get(system_bst        bst,
+                                       system_bst_key    key,
+                                       system_bst_value* result)
+{
+    const _system_bst* bst_ptr        = (const _system_bst*) bst;
+    bool               logical_result = false;
+
+    switch (bst_ptr->key_type)
     {
-        previous_node = current_node;
+        case SYSTEM_BST_KEY_TYPE_CUSTOM:
+        {
+            logical_result = _system_bst_get(bst_ptr,
+                                             _system_bst_custom_comparator(bst_ptr),
+                                             key,
+                                             result);
 
-        if (bst_ptr->key_lower_func(bst_ptr->key_size,
-                                    current_node->key,
-                                    key) )
+            break;
+        }
+
+        case SYSTEM_BST_KEY_TYPE_FLOAT_ARRAY:
         {
-            current_node = current_node->left;
-            is_lower_eq  = true;
+            logical_result = _system_bst_get(bst_ptr,
+                                             _system_bst_array_comparator<float>(bst_ptr),
+                                             key,
+                                             result);
+
+            break;
         }
-        else
+
+        case SYSTEM_BST_KEY_TYPE_UINT32_ARRAY:
         {
-            current_node = current_node->right;
-            is_lower_eq  = false;
+            logical_result = _system_bst_get(bst_ptr,
+                                             _system_bst_array_comparator<uint32_t>(bst_ptr),
+                                             key,
+                                             result);
+
+            break;
         }
-    }
 
-    /* Create key/value copies */
-    system_bst_key   key_copy   = (system_bst_key)   system_linear_alloc_pin_get_from_pool(bst_ptr->key_allocator);
-    system_bst_value value_copy = (system_bst_value) system_linear_alloc_pin_get_from_pool(bst_ptr->value_allocator);
+        default:
+        {
+            ASSERT_DEBUG_SYNC(false,
+                              "Unrecognized key type");
+        }
+    } /* switch (bst_ptr->key_type) */
 
-    memcpy(key_copy,
-           key,
-           bst_ptr->key_size);
-    memcpy(value_copy,
-           value,
-           bst_ptr->value_size);
+    return logical_result;
+}
 
-    if (is_lower_eq)
-    {
-        previous_node->left = (_system_bst_node*) system_linear_alloc_pin_get_from_pool(bst_ptr->node_allocator);
+/* Please see header for specification */
+PUBLIC EMERALD_API void system_bst_insert(system_bst       bst,
+                                          system_bst_key   key,
+                                          system_bst_value value)
+{
+    _system_bst* bst_ptr = (_system_bst*) bst;
 
-        _init_system_bst_node(previous_node->left,
-                              key_copy,
-                              value_copy);
-    }
-    else
+    switch (bst_ptr->key_type)
     {
-        previous_node->right = (_system_bst_node*) system_linear_alloc_pin_get_from_pool(bst_ptr->node_allocator);
+        case SYSTEM_BST_KEY_TYPE_CUSTOM:
+        {
+            _system_bst_insert(bst_ptr,
+                               _system_bst_custom_comparator(bst_ptr),
+                               key,
+                               value);
 
-        _init_system_bst_node(previous_node->right,
-                              key_copy,
-                              value_copy);
-    }
+            break;
+        }
+
+        case SYSTEM_BST_KEY_TYPE_FLOAT_ARRAY:
+        {
+            _system_bst_insert(bst_ptr,
+                               _system_bst_array_comparator<float>(bst_ptr),
+                               key,
+                               value);
+
+            break;
+        }
+
+        case SYSTEM_BST_KEY_TYPE_UINT32_ARRAY:
+        {
+            _system_bst_insert(bst_ptr,
+                               _system_bst_array_comparator<uint32_t>(bst_ptr),
+                               key,
+                               value);
+
+            break;
+        }
+
+        default:
+        {
+            ASSERT_DEBUG_SYNC(false,
+                              "Unrecognized key type");
+        }
+    } /* switch (bst_ptr->key_type) */
 }
 
 /* Please see header for specification */
@@ -209,20 +643,11 @@ PUBLIC EMERALD_API void system_bst_release(system_bst bst)
 {
     _system_bst* bst_ptr = (_system_bst*) bst;
 
-    if (bst_ptr->key_allocator != NULL)
-    {
-        system_linear_alloc_pin_release(bst_ptr->key_allocator);
-    }
-
+    /* Keys & values are stored inline in the nodes, so there is nothing to release other than the node pool */
     if (bst_ptr->node_allocator != NULL)
     {
         system_linear_alloc_pin_release(bst_ptr->node_allocator);
     }
 
-    if (bst_ptr->value_allocator != NULL)
-    {
-        system_linear_alloc_pin_release(bst_ptr->value_allocator);
-    }
-
     delete bst_ptr;
-}
\ No newline at end of file
+}
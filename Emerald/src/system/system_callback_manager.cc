@@ -5,17 +5,29 @@
  */
 #include "shared.h"
 #include "system/system_assertions.h"
+#include "system/system_atomics.h"
 #include "system/system_callback_manager.h"
 #include "system/system_critical_section.h"
 #include "system/system_dpc.h"
-#include "system/system_read_write_mutex.h"
+#include "system/system_event.h"
 #include "system/system_resizable_vector.h"
 #include "system/system_resource_pool.h"
 #include "system/system_thread_pool.h"
 #include "system/system_threads.h"
+#include "system/system_time.h"
+#include <stdlib.h>
 #include <string.h>
 
+/* Defines how many asynchronous dispatches per callback ID can be tracked for coalescing at the same time.
+ * Dispatches which do not fit are never coalesced. */
+#define MAX_COALESCABLE_DISPATCHES (16)
+
+/* Defines how deeply call-backs can be nested on a single thread */
+#define MAX_NESTED_CALL_BACKS (32)
+
+
 /* Private type definitions */
+struct _system_callback_manager;
 struct _system_callback_manager_callback;
 
 typedef struct _system_callback_manager_callback_subscription
@@ -42,50 +54,100 @@ typedef struct _system_callback_manager_callback_subscription
     }
 } _system_callback_manager_callback_subscription;
 
+/** Immutable copy of a callback ID's subscriptions. Call-backs are issued from snapshots, so that
+ *  (un)subscribing never has to wait for a call-back to finish, and vice versa.
+ *
+ *  Synchronous subscriptions are stored first, followed by asynchronous ones.
+ */
+typedef struct _system_callback_manager_subscription_snapshot
+{
+    volatile unsigned int n_active_sync_callers; /* Number of threads calling back sync subscriptions from this snapshot */
+    unsigned int          n_async_subscriptions;
+    unsigned int          n_sync_subscriptions;
+
+    /* Created by the thread retiring the snapshot, if it needs to wait for other threads calling back sync
+     * subscriptions. Each sync caller which leaves the snapshot afterward sets the event. Released together
+     * with the snapshot, since callers may still be setting it when the retiring thread stops waiting. */
+    system_event volatile sync_callers_left_event;
+
+    /* One reference is held by the callback descriptor, as long as the snapshot is current. Other references
+     * are held by call_back() calls in progress and pending asynchronous dispatches. */
+    volatile unsigned int ref_counter;
+
+    struct
+    {
+        PFNSYSTEMCALLBACKPROC callback_proc;
+        void*                 user_arg;
+    } subscriptions[1]; /* n_sync_subscriptions + n_async_subscriptions items */
+} _system_callback_manager_subscription_snapshot;
+
+/** Describes an asynchronous dispatch. Followed by a copy of callback_proc_data. */
+typedef struct _system_callback_manager_async_dispatch
+{
+    _system_callback_manager_callback*              callback_ptr;
+    _system_callback_manager*                       manager_ptr;
+    int                                             n_coalescing_slot; /* -1 if the dispatch cannot be coalesced */
+    _system_callback_manager_subscription_snapshot* snapshot_ptr;
+    __uint64                                        submission_time_usec;
+} _system_callback_manager_async_dispatch;
+
 typedef struct _system_callback_manager_callback
 {
     uint32_t                callback_proc_data_size;
-    system_resource_pool    resource_pool; /* each block is sizeof(_system_callback_manager_callback_subscription) + sizeof(callback_proc_data_size) */
+    system_resource_pool    resource_pool; /* each block is sizeof(_system_callback_manager_async_dispatch) + callback_proc_data_size */
     system_resizable_vector subscriptions; /* stores _system_callback_manager_callback_subscription */
-    system_read_write_mutex subscriptions_mutex;
+    system_critical_section subscriptions_cs;
+
+    /* Current snapshot of the subscriptions. NULL if there are no subscriptions */
+    _system_callback_manager_subscription_snapshot* volatile subscriptions_snapshot_ptr;
+
+    /* Readers register in the current epoch for the short time they need to take a snapshot reference.
+     * Once a writer replaces the snapshot, it flips the epoch and waits for the readers registered in
+     * the previous one to leave. The replaced snapshot is guaranteed not to be picked by anyone afterward. */
+    volatile unsigned int snapshot_epoch;
+    volatile unsigned int snapshot_epoch_n_readers[2];
+
+    /* Coalescing support */
+    volatile bool                            coalesce_async_calls;
+    _system_callback_manager_async_dispatch* coalescable_dispatches[MAX_COALESCABLE_DISPATCHES];
+    system_critical_section                  coalescable_dispatches_cs;
+
+    /* Statistics */
+    volatile __uint64 max_async_latency_usec;
+    volatile __uint64 n_async_dispatches;
+    volatile __uint64 n_async_invocations;
+    volatile __uint64 n_calls;
+    volatile __uint64 n_coalesced_calls;
+    volatile __uint64 n_sync_invocations;
+    volatile __uint64 total_async_latency_usec;
 
     _system_callback_manager_callback()
     {
-        callback_proc_data_size = 0;
-        resource_pool           = nullptr;
-        subscriptions           = nullptr;
-        subscriptions_mutex     = nullptr;
+        callback_proc_data_size    = 0;
+        coalesce_async_calls       = false;
+        coalescable_dispatches_cs  = nullptr;
+        max_async_latency_usec     = 0;
+        n_async_dispatches         = 0;
+        n_async_invocations        = 0;
+        n_calls                    = 0;
+        n_coalesced_calls          = 0;
+        n_sync_invocations         = 0;
+        resource_pool              = nullptr;
+        snapshot_epoch             = 0;
+        subscriptions              = nullptr;
+        subscriptions_cs           = nullptr;
+        subscriptions_snapshot_ptr = nullptr;
+        total_async_latency_usec   = 0;
+
+        snapshot_epoch_n_readers[0] = 0;
+        snapshot_epoch_n_readers[1] = 0;
+
+        memset(coalescable_dispatches,
+               0,
+               sizeof(coalescable_dispatches) );
     }
 
-    ~_system_callback_manager_callback()
-    {
-        if (resource_pool != nullptr)
-        {
-            system_resource_pool_release(resource_pool);
-
-            resource_pool = nullptr;
-        }
-
-        if (subscriptions != nullptr)
-        {
-            _system_callback_manager_callback_subscription* subscription_ptr = nullptr;
-
-            while (system_resizable_vector_pop(subscriptions,
-                                              &subscription_ptr) )
-            {
-                delete subscription_ptr;
-
-                subscription_ptr = nullptr;
-            }
-        }
-
-        if (subscriptions_mutex != nullptr)
-        {
-            system_read_write_mutex_release(subscriptions_mutex);
-
-            subscriptions_mutex = nullptr;
-        }
-    }
+    ~_system_callback_manager_callback();
 } _system_callback_manager_callback;
 
 typedef struct _system_callback_manager_dpc_callback_arg
@@ -99,11 +161,13 @@ typedef struct _system_callback_manager
 {
     _system_callback_manager_callback* callbacks;
     _callback_id                       max_callback_id;
+    volatile unsigned int              n_pending_async_dispatches;
 
     _system_callback_manager()
     {
-        callbacks       = nullptr;
-        max_callback_id = (_callback_id) 0;
+        callbacks                  = nullptr;
+        max_callback_id            = (_callback_id) 0;
+        n_pending_async_dispatches = 0;
     }
 } _system_callback_manager;
 
@@ -111,6 +175,16 @@ typedef struct _system_callback_manager
 /** TODO */
 system_callback_manager global_callback_manager = nullptr;
 
+/* Snapshots the calling thread is calling back synchronous subscriptions from. Used to avoid
+ * waiting for the thread itself, if a subscription is cancelled from within a call-back handler. */
+#ifdef _WIN32
+    PRIVATE __declspec(thread) _system_callback_manager_subscription_snapshot* _thread_sync_snapshots[MAX_NESTED_CALL_BACKS];
+    PRIVATE __declspec(thread) unsigned int                                    _thread_n_sync_snapshots = 0;
+#else
+    PRIVATE __thread _system_callback_manager_subscription_snapshot* _thread_sync_snapshots[MAX_NESTED_CALL_BACKS];
+    PRIVATE __thread unsigned int                                    _thread_n_sync_snapshots = 0;
+#endif
+
 /* Forward declarations */
 PRIVATE          void _add_callback_support                     (system_callback_manager            callback_manager,
                                                                  _callback_id                       callback_id,
@@ -119,6 +193,11 @@ PRIVATE          void _deinit_system_callback_manager_callback  (_system_callbac
 PRIVATE volatile void _system_callback_manager_call_back_handler(void*                              descriptor);
 
 
+_system_callback_manager_callback::~_system_callback_manager_callback()
+{
+    _deinit_system_callback_manager_callback(*this);
+}
+
 /** TODO */
 PRIVATE void _add_callback_support(system_callback_manager callback_manager,
                                    _callback_id            callback_id,
@@ -143,13 +222,14 @@ PRIVATE void _add_callback_support(system_callback_manager callback_manager,
                       "Subscription handler already configured");
 
     descriptor_ptr->callback_proc_data_size = callback_proc_data_size;
-    descriptor_ptr->resource_pool           = system_resource_pool_create   (sizeof(_system_callback_manager_callback_subscription) + callback_proc_data_size,
+    descriptor_ptr->resource_pool           = system_resource_pool_create   (sizeof(_system_callback_manager_async_dispatch) + callback_proc_data_size,
                                                                              4,     /* n_elements */
                                                                              nullptr,  /* init_fn */
                                                                              nullptr); /* deinit_fn */
     descriptor_ptr->subscriptions           = system_resizable_vector_create(4 /* capacity */);
 
-    descriptor_ptr->subscriptions_mutex = system_read_write_mutex_create();
+    descriptor_ptr->coalescable_dispatches_cs = system_critical_section_create();
+    descriptor_ptr->subscriptions_cs          = system_critical_section_create();
 
     ASSERT_ALWAYS_SYNC(descriptor_ptr->resource_pool != nullptr &&
                        descriptor_ptr->subscriptions != nullptr,
@@ -166,14 +246,251 @@ end:
     ;
 }
 
+/** Atomically adds @param value to the counter under @param counter_ptr. */
+PRIVATE void _system_callback_manager_add_to_counter(volatile __uint64* counter_ptr,
+                                                     __uint64           value)
+{
+    __uint64 current_value;
+
+    do
+    {
+        current_value = system_atomics_load_acquire_uint64(counter_ptr);
+    }
+    while (!system_atomics_compare_exchange_uint64(counter_ptr,
+                                                   current_value,
+                                                   current_value + value) );
+}
+
+/** Atomically bumps the counter under @param counter_ptr up to @param value, if it is smaller. */
+PRIVATE void _system_callback_manager_max_counter(volatile __uint64* counter_ptr,
+                                                  __uint64           value)
+{
+    __uint64 current_value;
+
+    do
+    {
+        current_value = system_atomics_load_acquire_uint64(counter_ptr);
+
+        if (current_value >= value)
+        {
+            break;
+        }
+    }
+    while (!system_atomics_compare_exchange_uint64(counter_ptr,
+                                                   current_value,
+                                                   value) );
+}
+
+/** Takes a reference to the current subscription snapshot of @param callback.
+ *
+ *  @return The snapshot, or NULL if there are no subscriptions.
+ */
+PRIVATE _system_callback_manager_subscription_snapshot* _system_callback_manager_acquire_snapshot(_system_callback_manager_callback& callback)
+{
+    unsigned int                                    epoch;
+    _system_callback_manager_subscription_snapshot* snapshot_ptr = nullptr;
+
+    /* Register in the current epoch. If a writer flips the epoch in the meantime, it may not have seen us. */
+    while (true)
+    {
+        epoch = system_atomics_load_acquire(&callback.snapshot_epoch);
+
+        system_atomics_increment(&callback.snapshot_epoch_n_readers[epoch & 1]);
+
+        if (system_atomics_load_acquire(&callback.snapshot_epoch) == epoch)
+        {
+            break;
+        }
+
+        system_atomics_decrement(&callback.snapshot_epoch_n_readers[epoch & 1]);
+    }
+
+    {
+        snapshot_ptr = (_system_callback_manager_subscription_snapshot*) system_atomics_load_acquire_pointer( (void* volatile*) &callback.subscriptions_snapshot_ptr);
+
+        if (snapshot_ptr != nullptr)
+        {
+            system_atomics_increment(&snapshot_ptr->ref_counter);
+        }
+    }
+    system_atomics_decrement(&callback.snapshot_epoch_n_readers[epoch & 1]);
+
+    return snapshot_ptr;
+}
+
+/** Drops a snapshot reference. The snapshot is released, once the last reference is dropped. */
+PRIVATE void _system_callback_manager_release_snapshot(_system_callback_manager_subscription_snapshot* snapshot_ptr)
+{
+    if (snapshot_ptr != nullptr                                  &&
+        system_atomics_decrement(&snapshot_ptr->ref_counter) == 0)
+    {
+        if (snapshot_ptr->sync_callers_left_event != nullptr)
+        {
+            system_event_release(snapshot_ptr->sync_callers_left_event);
+        }
+
+        free(snapshot_ptr);
+    }
+}
+
+/** Drops the reference the callback descriptor held to a replaced snapshot.
+ *
+ *  @param snapshot_ptr          Snapshot returned by _system_callback_manager_update_snapshot(). May be NULL.
+ *  @param wait_for_sync_callers True to only return once other threads have finished calling back
+ *                               synchronous subscriptions stored in the snapshot.
+ */
+PRIVATE void _system_callback_manager_retire_snapshot(_system_callback_manager_subscription_snapshot* snapshot_ptr,
+                                                      bool                                            wait_for_sync_callers)
+{
+    if (snapshot_ptr == nullptr)
+    {
+        return;
+    }
+
+    if (wait_for_sync_callers)
+    {
+        /* Do not wait for nested call-backs issued by this thread. */
+        unsigned int n_own_sync_callers = 0;
+
+        for (unsigned int n_thread_snapshot = 0;
+                          n_thread_snapshot < _thread_n_sync_snapshots;
+                        ++n_thread_snapshot)
+        {
+            if (_thread_sync_snapshots[n_thread_snapshot] == snapshot_ptr)
+            {
+                ++n_own_sync_callers;
+            }
+        }
+
+        /* Sync call-back handlers can take arbitrarily long, so block instead of spinning. The event is
+         * published before the counter is checked, and callers decrement the counter before checking
+         * for the event, so every caller leaving from now on is guaranteed to see the event. */
+        if (system_atomics_load_acquire(&snapshot_ptr->n_active_sync_callers) > n_own_sync_callers)
+        {
+            system_atomics_store_release_pointer( (void* volatile*) &snapshot_ptr->sync_callers_left_event,
+                                                  system_event_create(false) ); /* auto-reset */
+            system_atomics_memory_barrier       ();
+
+            while (system_atomics_load_acquire(&snapshot_ptr->n_active_sync_callers) > n_own_sync_callers)
+            {
+                system_event_wait_single(snapshot_ptr->sync_callers_left_event);
+            }
+        }
+    }
+
+    _system_callback_manager_release_snapshot(snapshot_ptr);
+}
+
+/** Replaces the subscription snapshot of @param callback with a new one, built from the subscriptions vector.
+ *  The caller must hold the subscriptions_cs lock.
+ *
+ *  @return The replaced snapshot, which must be passed to _system_callback_manager_retire_snapshot() once
+ *          the lock is released. May be NULL.
+ */
+PRIVATE _system_callback_manager_subscription_snapshot* _system_callback_manager_update_snapshot(_system_callback_manager_callback& callback)
+{
+    unsigned int                                    n_async_subscriptions = 0;
+    unsigned int                                    n_subscriptions       = 0;
+    unsigned int                                    n_sync_subscriptions  = 0;
+    _system_callback_manager_subscription_snapshot* new_snapshot_ptr      = nullptr;
+    _system_callback_manager_subscription_snapshot* old_snapshot_ptr      = callback.subscriptions_snapshot_ptr;
+    unsigned int                                    old_epoch;
+
+    system_resizable_vector_get_property(callback.subscriptions,
+                                         SYSTEM_RESIZABLE_VECTOR_PROPERTY_N_ELEMENTS,
+                                        &n_subscriptions);
+
+    if (n_subscriptions > 0)
+    {
+        new_snapshot_ptr = (_system_callback_manager_subscription_snapshot*) malloc(sizeof(_system_callback_manager_subscription_snapshot) +
+                                                                                    sizeof(new_snapshot_ptr->subscriptions[0]) * (n_subscriptions - 1) );
+
+        ASSERT_ALWAYS_SYNC(new_snapshot_ptr != nullptr,
+                           "Out of memory");
+
+        /* Store sync subscriptions first, and async ones afterward */
+        for (unsigned int n_iteration = 0;
+                          n_iteration < 2;
+                        ++n_iteration)
+        {
+            const _callback_synchronicity iteration_synchronicity = (n_iteration == 0) ? CALLBACK_SYNCHRONICITY_SYNCHRONOUS
+                                                                                       : CALLBACK_SYNCHRONICITY_ASYNCHRONOUS;
+
+            for (unsigned int n_subscription = 0;
+                              n_subscription < n_subscriptions;
+                            ++n_subscription)
+            {
+                _system_callback_manager_callback_subscription* subscription_ptr = nullptr;
+                const unsigned int                              n_result         = n_sync_subscriptions + n_async_subscriptions;
+
+                system_resizable_vector_get_element_at(callback.subscriptions,
+                                                       n_subscription,
+                                                      &subscription_ptr);
+
+                if (subscription_ptr->synchronicity != iteration_synchronicity)
+                {
+                    continue;
+                }
+
+                new_snapshot_ptr->subscriptions[n_result].callback_proc = subscription_ptr->callback_proc;
+                new_snapshot_ptr->subscriptions[n_result].user_arg      = subscription_ptr->user_arg;
+
+                if (n_iteration == 0)
+                {
+                    ++n_sync_subscriptions;
+                }
+                else
+                {
+                    ++n_async_subscriptions;
+                }
+            }
+        }
+
+        ASSERT_DEBUG_SYNC(n_sync_subscriptions + n_async_subscriptions == n_subscriptions,
+                          "Unrecognized call-back synchronicity");
+
+        new_snapshot_ptr->n_active_sync_callers   = 0;
+        new_snapshot_ptr->n_async_subscriptions   = n_async_subscriptions;
+        new_snapshot_ptr->n_sync_subscriptions    = n_sync_subscriptions;
+        new_snapshot_ptr->ref_counter             = 1;
+        new_snapshot_ptr->sync_callers_left_event = nullptr;
+    }
+
+    /* Publish the new snapshot & flip the epoch. Then wait until all readers which might still be
+     * picking up the old snapshot have taken their references. */
+    system_atomics_store_release_pointer( (void* volatile*) &callback.subscriptions_snapshot_ptr,
+                                          new_snapshot_ptr);
+    system_atomics_memory_barrier       ();
+
+    old_epoch = callback.snapshot_epoch & 1;
+
+    system_atomics_increment(&callback.snapshot_epoch);
+
+    while (system_atomics_load_acquire(&callback.snapshot_epoch_n_readers[old_epoch]) != 0)
+    {
+        /* Readers only stay registered for as long as it takes to take a snapshot reference, so there
+         * is no point in blocking. */
+        system_threads_yield();
+    }
+
+    return old_snapshot_ptr;
+}
+
 /** TODO */
 PRIVATE void _deinit_system_callback_manager_callback(_system_callback_manager_callback& descriptor)
 {
-    if (descriptor.subscriptions_mutex != nullptr)
+    if (descriptor.coalescable_dispatches_cs != nullptr)
+    {
+        system_critical_section_release(descriptor.coalescable_dispatches_cs);
+
+        descriptor.coalescable_dispatches_cs = nullptr;
+    }
+
+    if (descriptor.subscriptions_cs != nullptr)
     {
-        system_read_write_mutex_release(descriptor.subscriptions_mutex);
+        system_critical_section_release(descriptor.subscriptions_cs);
 
-        descriptor.subscriptions_mutex = nullptr;
+        descriptor.subscriptions_cs = nullptr;
     }
 
     if (descriptor.resource_pool != nullptr)
@@ -182,6 +499,13 @@ PRIVATE void _deinit_system_callback_manager_callback(_system_callback_manager_c
         descriptor.resource_pool = nullptr;
     }
 
+    if (descriptor.subscriptions_snapshot_ptr != nullptr)
+    {
+        _system_callback_manager_release_snapshot(descriptor.subscriptions_snapshot_ptr);
+
+        descriptor.subscriptions_snapshot_ptr = nullptr;
+    }
+
     if (descriptor.subscriptions != nullptr)
     {
         _system_callback_manager_callback_subscription* subscription_ptr = nullptr;
@@ -189,6 +513,8 @@ PRIVATE void _deinit_system_callback_manager_callback(_system_callback_manager_c
         while (system_resizable_vector_pop(descriptor.subscriptions,
                                           &subscription_ptr) )
         {
+            subscription_ptr->ref_counter = 0;
+
             delete subscription_ptr;
 
             subscription_ptr = nullptr;
@@ -200,17 +526,48 @@ PRIVATE void _deinit_system_callback_manager_callback(_system_callback_manager_c
     }
 }
 
-/** TODO */
+/** Calls back all asynchronous subscriptions stored in the dispatch's snapshot. */
 PRIVATE volatile void _system_callback_manager_call_back_handler(void* descriptor)
 {
-    _system_callback_manager_callback_subscription* subscription_ptr = (_system_callback_manager_callback_subscription*) descriptor;
-    const unsigned char*                            callback_data    = (unsigned char*) descriptor + sizeof(_system_callback_manager_callback_subscription);
+    _system_callback_manager_async_dispatch*        dispatch_ptr  = (_system_callback_manager_async_dispatch*) descriptor;
+    const unsigned char*                            callback_data = (unsigned char*) descriptor + sizeof(_system_callback_manager_async_dispatch);
+    _system_callback_manager_callback&              callback      = *dispatch_ptr->callback_ptr;
+    const __uint64                                  latency_usec  = system_time_now_usec() - dispatch_ptr->submission_time_usec;
+    _system_callback_manager*                       manager_ptr   = dispatch_ptr->manager_ptr;
+    _system_callback_manager_subscription_snapshot* snapshot_ptr  = dispatch_ptr->snapshot_ptr;
+
+    /* Identical notifications reported from now on need to be delivered separately */
+    if (dispatch_ptr->n_coalescing_slot != -1)
+    {
+        system_critical_section_enter(callback.coalescable_dispatches_cs);
+        {
+            callback.coalescable_dispatches[dispatch_ptr->n_coalescing_slot] = nullptr;
+        }
+        system_critical_section_leave(callback.coalescable_dispatches_cs);
+    }
 
-    subscription_ptr->callback_proc(callback_data,
-                                    subscription_ptr->user_arg);
+    _system_callback_manager_add_to_counter(&callback.total_async_latency_usec,
+                                            latency_usec);
+    _system_callback_manager_max_counter   (&callback.max_async_latency_usec,
+                                            latency_usec);
 
-    system_resource_pool_return_to_pool(subscription_ptr->owner_ptr->resource_pool,
+    for (unsigned int n_subscription  = snapshot_ptr->n_sync_subscriptions;
+                      n_subscription  < snapshot_ptr->n_sync_subscriptions + snapshot_ptr->n_async_subscriptions;
+                    ++n_subscription)
+    {
+        snapshot_ptr->subscriptions[n_subscription].callback_proc(callback_data,
+                                                                  snapshot_ptr->subscriptions[n_subscription].user_arg);
+    }
+
+    _system_callback_manager_add_to_counter(&callback.n_async_invocations,
+                                            snapshot_ptr->n_async_subscriptions);
+
+    _system_callback_manager_release_snapshot(snapshot_ptr);
+
+    system_resource_pool_return_to_pool(callback.resource_pool,
                                         (system_resource_pool_block) descriptor);
+
+    system_atomics_decrement(&manager_ptr->n_pending_async_dispatches);
 }
 
 /** TODO */
@@ -229,110 +586,174 @@ PRIVATE void _system_callback_manager_handle_dpc_callback(void* object,
     delete arg_ptr;
 }
 
-/** Please see header for spec */
-PUBLIC void system_callback_manager_call_back(system_callback_manager callback_manager,
-                                              int                     callback_id,
-                                              const void*             callback_proc_data)
+/** Submits a thread pool task, which is going to call back all asynchronous subscriptions in @param snapshot_ptr.
+ *
+ *  Takes over the caller's reference to @param snapshot_ptr.
+ */
+PRIVATE void _system_callback_manager_submit_async_dispatch(_system_callback_manager*                       callback_manager_ptr,
+                                                            _system_callback_manager_callback&              callback,
+                                                            _system_callback_manager_subscription_snapshot* snapshot_ptr,
+                                                            const void*                                     callback_proc_data)
 {
-    _system_callback_manager* callback_manager_ptr = (_system_callback_manager*) callback_manager;
+    _system_callback_manager_async_dispatch* dispatch_ptr = (_system_callback_manager_async_dispatch*) system_resource_pool_get_from_pool(callback.resource_pool);
+    system_thread_pool_task                  task;
 
-    /* Sanity checks */
-    ASSERT_DEBUG_SYNC(callback_manager_ptr->max_callback_id >= callback_id,
-                      "Requested callback ID is invalid");
-
-    /* Issue the call-backs */
-    _system_callback_manager_callback& callback = callback_manager_ptr->callbacks[callback_id];
+    dispatch_ptr->callback_ptr         = &callback;
+    dispatch_ptr->manager_ptr          = callback_manager_ptr;
+    dispatch_ptr->n_coalescing_slot    = -1;
+    dispatch_ptr->snapshot_ptr         = snapshot_ptr;
+    dispatch_ptr->submission_time_usec = system_time_now_usec();
 
-    system_read_write_mutex_lock(callback.subscriptions_mutex,
-                                 ACCESS_READ);
+    if (callback_proc_data != nullptr)
     {
-        if (callback.subscriptions != nullptr)
-        {
-            _system_callback_manager_callback_subscription* subscription_ptr = nullptr;
-            unsigned int                                    n_subscriptions  = 0;
+        memcpy(dispatch_ptr + 1,
+               callback_proc_data,
+               callback.callback_proc_data_size);
+    }
 
-            system_resizable_vector_get_property(callback.subscriptions,
-                                                 SYSTEM_RESIZABLE_VECTOR_PROPERTY_N_ELEMENTS,
-                                                &n_subscriptions);
+    if (callback.coalesce_async_calls)
+    {
+        bool is_coalesced = false;
 
-            for (unsigned int n_subscription = 0;
-                              n_subscription < n_subscriptions;
-                            ++n_subscription)
+        system_critical_section_enter(callback.coalescable_dispatches_cs);
+        {
+            for (unsigned int n_slot = 0;
+                              n_slot < MAX_COALESCABLE_DISPATCHES;
+                            ++n_slot)
             {
-                system_resizable_vector_get_element_at(callback.subscriptions,
-                                                       n_subscription,
-                                                      &subscription_ptr);
+                const _system_callback_manager_async_dispatch* pending_dispatch_ptr = callback.coalescable_dispatches[n_slot];
 
-                switch (subscription_ptr->synchronicity)
+                if (pending_dispatch_ptr == nullptr)
                 {
-                    case CALLBACK_SYNCHRONICITY_ASYNCHRONOUS:
+                    if (dispatch_ptr->n_coalescing_slot == -1)
                     {
-                        /* Copy caller's data to a memory block from callback-specific resource pool */
-                        unsigned char* callback_data = (unsigned char*) system_resource_pool_get_from_pool(callback.resource_pool);
+                        dispatch_ptr->n_coalescing_slot = (int) n_slot;
+                    }
 
-                        memcpy(callback_data,
-                               subscription_ptr,
-                               sizeof(*subscription_ptr) );
+                    continue;
+                }
+
+                /* An identical notification must also reach the same set of subscribers */
+                if (pending_dispatch_ptr->snapshot_ptr == snapshot_ptr &&
+                    memcmp(pending_dispatch_ptr + 1,
+                           dispatch_ptr         + 1,
+                           callback.callback_proc_data_size) == 0)
+                {
+                    is_coalesced = true;
 
-                        if (callback_proc_data != nullptr)
-                        {
-                            memcpy(callback_data + sizeof(*subscription_ptr),
-                                   callback_proc_data,
-                                   callback.callback_proc_data_size);
-                        }
+                    break;
+                }
+            }
 
-                        /* Push the task to the thread pool */
-                        system_thread_pool_task task = system_thread_pool_create_task_handler_only(THREAD_POOL_TASK_PRIORITY_NORMAL,
-                                                                                                   _system_callback_manager_call_back_handler,
-                                                                                                   callback_data);
+            if (!is_coalesced                       &&
+                dispatch_ptr->n_coalescing_slot != -1)
+            {
+                callback.coalescable_dispatches[dispatch_ptr->n_coalescing_slot] = dispatch_ptr;
+            }
+        }
+        system_critical_section_leave(callback.coalescable_dispatches_cs);
 
-                        system_thread_pool_submit_single_task(task);
+        if (is_coalesced)
+        {
+            system_resource_pool_return_to_pool      (callback.resource_pool,
+                                                      (system_resource_pool_block) dispatch_ptr);
+            _system_callback_manager_add_to_counter  (&callback.n_coalesced_calls,
+                                                      1);
+            _system_callback_manager_release_snapshot(snapshot_ptr);
 
-                        break;
-                    }
+            return;
+        }
+    }
 
-                    case CALLBACK_SYNCHRONICITY_SYNCHRONOUS:
-                    {
-                        subscription_ptr->callback_proc(callback_proc_data,
-                                                        subscription_ptr->user_arg);
+    system_atomics_increment               (&callback_manager_ptr->n_pending_async_dispatches);
+    _system_callback_manager_add_to_counter(&callback.n_async_dispatches,
+                                            1);
 
-                        break;
-                    }
+    task = system_thread_pool_create_task_handler_only(THREAD_POOL_TASK_PRIORITY_NORMAL,
+                                                       _system_callback_manager_call_back_handler,
+                                                       dispatch_ptr);
 
-                    default:
-                    {
-                        ASSERT_DEBUG_SYNC(false, "Unrecognized call-back synchronicity");
-                    }
-                }
+    system_thread_pool_submit_single_task(task);
+}
 
-                /* Check if the number of subscriptions have changed. This may happen if a subscription
-                 * has been removed by one of the handlers. Handling such use cases remains a TODO */
-                uint32_t n_subscriptions_after = 0;
+/** Please see header for spec */
+PUBLIC EMERALD_API void system_callback_manager_call_back(system_callback_manager callback_manager,
+                                                          int                     callback_id,
+                                                          const void*             callback_proc_data)
+{
+    _system_callback_manager*                       callback_manager_ptr = (_system_callback_manager*) callback_manager;
+    _system_callback_manager_subscription_snapshot* snapshot_ptr         = nullptr;
 
-                system_resizable_vector_get_property(callback.subscriptions,
-                                                 SYSTEM_RESIZABLE_VECTOR_PROPERTY_N_ELEMENTS,
-                                                &n_subscriptions_after);
+    /* Sanity checks */
+    ASSERT_DEBUG_SYNC(callback_manager_ptr->max_callback_id >= callback_id,
+                      "Requested callback ID is invalid");
 
-                if (n_subscriptions_after != 0 &&
-                    n_subscriptions_after != n_subscriptions)
-                {
-                    /* TODO: Need to loop over all subscriptions again and make sure we do not call
-                     *       the same callback handlers twice in a row.
-                     */
-                    ASSERT_DEBUG_SYNC(false,
-                                      "TODO");
-                }
+    /* Issue the call-backs */
+    _system_callback_manager_callback& callback = callback_manager_ptr->callbacks[callback_id];
+
+    _system_callback_manager_add_to_counter(&callback.n_calls,
+                                            1);
+
+    snapshot_ptr = _system_callback_manager_acquire_snapshot(callback);
+
+    if (snapshot_ptr == nullptr)
+    {
+        /* No subscribers */
+        return;
+    }
 
-                subscription_ptr = nullptr;
+    if (snapshot_ptr->n_sync_subscriptions > 0)
+    {
+        ASSERT_ALWAYS_SYNC(_thread_n_sync_snapshots < MAX_NESTED_CALL_BACKS,
+                           "Too many nested call-backs");
+
+        _thread_sync_snapshots[_thread_n_sync_snapshots++] = snapshot_ptr;
+
+        system_atomics_increment(&snapshot_ptr->n_active_sync_callers);
+        {
+            for (unsigned int n_subscription = 0;
+                              n_subscription < snapshot_ptr->n_sync_subscriptions;
+                            ++n_subscription)
+            {
+                snapshot_ptr->subscriptions[n_subscription].callback_proc(callback_proc_data,
+                                                                          snapshot_ptr->subscriptions[n_subscription].user_arg);
+            }
+        }
+        system_atomics_decrement(&snapshot_ptr->n_active_sync_callers);
+
+        /* Wake up the thread retiring the snapshot, if there is one. We still hold a snapshot reference,
+         * so the event cannot be released in the meantime. */
+        {
+            const system_event sync_callers_left_event = (system_event) system_atomics_load_acquire_pointer( (void* volatile*) &snapshot_ptr->sync_callers_left_event);
+
+            if (sync_callers_left_event != nullptr)
+            {
+                system_event_set(sync_callers_left_event);
             }
         }
+
+        --_thread_n_sync_snapshots;
+
+        _system_callback_manager_add_to_counter(&callback.n_sync_invocations,
+                                                snapshot_ptr->n_sync_subscriptions);
+    }
+
+    if (snapshot_ptr->n_async_subscriptions > 0)
+    {
+        /* All async subscribers are handled by a single task, which takes over the snapshot reference */
+        _system_callback_manager_submit_async_dispatch(callback_manager_ptr,
+                                                       callback,
+                                                       snapshot_ptr,
+                                                       callback_proc_data);
+    }
+    else
+    {
+        _system_callback_manager_release_snapshot(snapshot_ptr);
     }
-    system_read_write_mutex_unlock(callback.subscriptions_mutex,
-                                   ACCESS_READ);
 }
 
 /** Please see header for spec */
-PUBLIC system_callback_manager system_callback_manager_create(_callback_id max_callback_id)
+PUBLIC EMERALD_API system_callback_manager system_callback_manager_create(_callback_id max_callback_id)
 {
     /* Carry on */
     _system_callback_manager* manager_ptr = new (std::nothrow) _system_callback_manager;
@@ -389,6 +810,85 @@ PUBLIC EMERALD_API system_callback_manager system_callback_manager_get()
     return global_callback_manager;
 }
 
+/** Please see header for spec */
+PUBLIC EMERALD_API void system_callback_manager_get_callback_property(system_callback_manager                   callback_manager,
+                                                                      int                                       callback_id,
+                                                                      system_callback_manager_callback_property property,
+                                                                      void*                                     out_result_ptr)
+{
+    _system_callback_manager* callback_manager_ptr = (_system_callback_manager*) callback_manager;
+
+    ASSERT_DEBUG_SYNC(callback_manager_ptr->max_callback_id >= callback_id,
+                      "Requested callback ID is invalid");
+
+    const _system_callback_manager_callback& callback = callback_manager_ptr->callbacks[callback_id];
+
+    switch (property)
+    {
+        case SYSTEM_CALLBACK_MANAGER_CALLBACK_PROPERTY_COALESCE_ASYNC_CALLS:
+        {
+            *(bool*) out_result_ptr = callback.coalesce_async_calls;
+
+            break;
+        }
+
+        case SYSTEM_CALLBACK_MANAGER_CALLBACK_PROPERTY_MAX_ASYNC_LATENCY_USEC:
+        {
+            *(__uint64*) out_result_ptr = callback.max_async_latency_usec;
+
+            break;
+        }
+
+        case SYSTEM_CALLBACK_MANAGER_CALLBACK_PROPERTY_N_ASYNC_DISPATCHES:
+        {
+            *(__uint64*) out_result_ptr = callback.n_async_dispatches;
+
+            break;
+        }
+
+        case SYSTEM_CALLBACK_MANAGER_CALLBACK_PROPERTY_N_ASYNC_INVOCATIONS:
+        {
+            *(__uint64*) out_result_ptr = callback.n_async_invocations;
+
+            break;
+        }
+
+        case SYSTEM_CALLBACK_MANAGER_CALLBACK_PROPERTY_N_CALLS:
+        {
+            *(__uint64*) out_result_ptr = callback.n_calls;
+
+            break;
+        }
+
+        case SYSTEM_CALLBACK_MANAGER_CALLBACK_PROPERTY_N_COALESCED_CALLS:
+        {
+            *(__uint64*) out_result_ptr = callback.n_coalesced_calls;
+
+            break;
+        }
+
+        case SYSTEM_CALLBACK_MANAGER_CALLBACK_PROPERTY_N_SYNC_INVOCATIONS:
+        {
+            *(__uint64*) out_result_ptr = callback.n_sync_invocations;
+
+            break;
+        }
+
+        case SYSTEM_CALLBACK_MANAGER_CALLBACK_PROPERTY_TOTAL_ASYNC_LATENCY_USEC:
+        {
+            *(__uint64*) out_result_ptr = callback.total_async_latency_usec;
+
+            break;
+        }
+
+        default:
+        {
+            ASSERT_DEBUG_SYNC(false,
+                              "Unrecognized system_callback_manager_callback_property value");
+        }
+    } /* switch (property) */
+}
+
 /** Please see header for spec */
 PUBLIC void system_callback_manager_init()
 {
@@ -399,12 +899,13 @@ PUBLIC void system_callback_manager_init()
 }
 
 /** Please see header for spec */
-PUBLIC void system_callback_manager_release(system_callback_manager callback_manager)
+PUBLIC EMERALD_API void system_callback_manager_release(system_callback_manager callback_manager)
 {
     _system_callback_manager* callback_manager_ptr = (_system_callback_manager*) callback_manager;
 
-    /* Make sure there are no outstanding DPCs against this callback manager.. */
-    while (system_dpc_is_object_pending_callback(callback_manager) )
+    /* Make sure there are no outstanding DPCs or async dispatches against this callback manager.. */
+    while (system_dpc_is_object_pending_callback(callback_manager)                           ||
+           system_atomics_load_acquire(&callback_manager_ptr->n_pending_async_dispatches) != 0)
     {
         system_threads_yield();
     }
@@ -429,6 +930,36 @@ PUBLIC void system_callback_manager_release(system_callback_manager callback_man
     callback_manager_ptr = nullptr;
 }
 
+/** Please see header for spec */
+PUBLIC EMERALD_API void system_callback_manager_set_callback_property(system_callback_manager                   callback_manager,
+                                                                      int                                       callback_id,
+                                                                      system_callback_manager_callback_property property,
+                                                                      const void*                               data)
+{
+    _system_callback_manager* callback_manager_ptr = (_system_callback_manager*) callback_manager;
+
+    ASSERT_DEBUG_SYNC(callback_manager_ptr->max_callback_id >= callback_id,
+                      "Requested callback ID is invalid");
+
+    _system_callback_manager_callback& callback = callback_manager_ptr->callbacks[callback_id];
+
+    switch (property)
+    {
+        case SYSTEM_CALLBACK_MANAGER_CALLBACK_PROPERTY_COALESCE_ASYNC_CALLS:
+        {
+            callback.coalesce_async_calls = *(const bool*) data;
+
+            break;
+        }
+
+        default:
+        {
+            ASSERT_DEBUG_SYNC(false,
+                              "Unrecognized or non-settable system_callback_manager_callback_property value");
+        }
+    } /* switch (property) */
+}
+
 /** Please see header for spec */
 PUBLIC EMERALD_API void system_callback_manager_subscribe_for_callbacks(system_callback_manager callback_manager,
                                                                         int                     callback_id,
@@ -436,7 +967,8 @@ PUBLIC EMERALD_API void system_callback_manager_subscribe_for_callbacks(system_c
                                                                         PFNSYSTEMCALLBACKPROC   pfn_callback_proc,
                                                                         void*                   callback_proc_user_arg)
 {
-    _system_callback_manager* callback_manager_ptr = (_system_callback_manager*) callback_manager;
+    _system_callback_manager*                       callback_manager_ptr  = (_system_callback_manager*) callback_manager;
+    _system_callback_manager_subscription_snapshot* replaced_snapshot_ptr = nullptr;
 
     /* Sanity checks */
     ASSERT_DEBUG_SYNC(callback_manager_ptr->max_callback_id >= callback_id,
@@ -444,8 +976,7 @@ PUBLIC EMERALD_API void system_callback_manager_subscribe_for_callbacks(system_c
 
     /* Check if the requested subscription is already stored. If so, bump up its ref counter and leave.
      * Otherwise, we'll spawn a new descriptor and insert it into the map. */
-    system_read_write_mutex_lock(callback_manager_ptr->callbacks[callback_id].subscriptions_mutex,
-                                 ACCESS_WRITE);
+    system_critical_section_enter(callback_manager_ptr->callbacks[callback_id].subscriptions_cs);
     {
         uint32_t n_subscriptions = 0;
 
@@ -497,12 +1028,17 @@ PUBLIC EMERALD_API void system_callback_manager_subscribe_for_callbacks(system_c
 
             system_resizable_vector_push(callback_manager_ptr->callbacks[callback_id].subscriptions,
                                          subscription_ptr);
+
+            replaced_snapshot_ptr = _system_callback_manager_update_snapshot(callback_manager_ptr->callbacks[callback_id]);
         }
 end:
         ;
     }
-    system_read_write_mutex_unlock(callback_manager_ptr->callbacks[callback_id].subscriptions_mutex,
-                                   ACCESS_WRITE);
+    system_critical_section_leave(callback_manager_ptr->callbacks[callback_id].subscriptions_cs);
+
+    /* Nobody could have called back the new subscription from the replaced snapshot, so there is no need to wait */
+    _system_callback_manager_retire_snapshot(replaced_snapshot_ptr,
+                                             false); /* wait_for_sync_callers */
 }
 
 /** Please see header for spec */
@@ -512,73 +1048,104 @@ PUBLIC EMERALD_API void system_callback_manager_unsubscribe_from_callbacks(syste
                                                                            void*                   callback_proc_user_arg,
                                                                            bool                    allow_deferred_execution)
 {
-    _system_callback_manager* callback_manager_ptr    = (_system_callback_manager*) callback_manager;
-    bool                      subscription_removal_ok = true;
+    _system_callback_manager*                       callback_manager_ptr  = (_system_callback_manager*) callback_manager;
+    _system_callback_manager_callback&              callback              = callback_manager_ptr->callbacks[callback_id];
+    _system_callback_manager_subscription_snapshot* replaced_snapshot_ptr = nullptr;
 
-    if (allow_deferred_execution                                                                            &&
-        system_read_write_mutex_is_locked(callback_manager_ptr->callbacks[callback_id].subscriptions_mutex))
+    if (allow_deferred_execution)
     {
-        _system_callback_manager_dpc_callback_arg* arg_ptr = new (std::nothrow) _system_callback_manager_dpc_callback_arg;
+        /* Delegate the request to a worker thread, if the subscription is being called back by other threads */
+        bool                                            is_busy      = false;
+        _system_callback_manager_subscription_snapshot* snapshot_ptr = _system_callback_manager_acquire_snapshot(callback);
+
+        if (snapshot_ptr != nullptr)
+        {
+            unsigned int n_own_sync_callers = 0;
+
+            for (unsigned int n_thread_snapshot = 0;
+                              n_thread_snapshot < _thread_n_sync_snapshots;
+                            ++n_thread_snapshot)
+            {
+                if (_thread_sync_snapshots[n_thread_snapshot] == snapshot_ptr)
+                {
+                    ++n_own_sync_callers;
+                }
+            }
+
+            is_busy = (system_atomics_load_acquire(&snapshot_ptr->n_active_sync_callers) > n_own_sync_callers);
+
+            _system_callback_manager_release_snapshot(snapshot_ptr);
+        }
+
+        if (is_busy)
+        {
+            _system_callback_manager_dpc_callback_arg* arg_ptr = new (std::nothrow) _system_callback_manager_dpc_callback_arg;
 
-        ASSERT_DEBUG_SYNC(arg_ptr != nullptr,
-                          "Out of memory");
+            ASSERT_DEBUG_SYNC(arg_ptr != nullptr,
+                              "Out of memory");
 
-        arg_ptr->callback_id            = callback_id;
-        arg_ptr->callback_proc_user_arg = callback_proc_user_arg;
-        arg_ptr->pfn_callback_proc      = pfn_callback_proc;
+            arg_ptr->callback_id            = callback_id;
+            arg_ptr->callback_proc_user_arg = callback_proc_user_arg;
+            arg_ptr->pfn_callback_proc      = pfn_callback_proc;
 
-        system_dpc_schedule(callback_manager,
-                            _system_callback_manager_handle_dpc_callback,
-                            arg_ptr);
+            system_dpc_schedule(callback_manager,
+                                _system_callback_manager_handle_dpc_callback,
+                                arg_ptr);
+
+            return;
+        }
     }
-    else
+
+    system_critical_section_enter(callback.subscriptions_cs);
     {
-        system_read_write_mutex_lock(callback_manager_ptr->callbacks[callback_id].subscriptions_mutex,
-                                     ACCESS_WRITE);
-        {
-            /* Find the callback descriptor */
-            uint32_t n_callbacks = 0;
+        /* Find the callback descriptor */
+        uint32_t n_callbacks = 0;
 
-            system_resizable_vector_get_property(callback_manager_ptr->callbacks[callback_id].subscriptions,
-                                                 SYSTEM_RESIZABLE_VECTOR_PROPERTY_N_ELEMENTS,
-                                                &n_callbacks);
+        system_resizable_vector_get_property(callback.subscriptions,
+                                             SYSTEM_RESIZABLE_VECTOR_PROPERTY_N_ELEMENTS,
+                                            &n_callbacks);
 
-            for (uint32_t n_callback = 0;
-                          n_callback < n_callbacks;
-                        ++n_callback)
-            {
-                _system_callback_manager_callback_subscription* subscription_ptr = nullptr;
+        for (uint32_t n_callback = 0;
+                      n_callback < n_callbacks;
+                    ++n_callback)
+        {
+            _system_callback_manager_callback_subscription* subscription_ptr = nullptr;
 
-                if (system_resizable_vector_get_element_at(callback_manager_ptr->callbacks[callback_id].subscriptions,
-                                                           n_callback,
-                                                          &subscription_ptr) )
+            if (system_resizable_vector_get_element_at(callback.subscriptions,
+                                                       n_callback,
+                                                      &subscription_ptr) )
+            {
+                if (subscription_ptr->callback_proc == pfn_callback_proc      &&
+                    subscription_ptr->user_arg      == callback_proc_user_arg)
                 {
-                    if (subscription_ptr->callback_proc == pfn_callback_proc      &&
-                        subscription_ptr->user_arg      == callback_proc_user_arg)
-                    {
-                        --subscription_ptr->ref_counter;
+                    --subscription_ptr->ref_counter;
 
-                        if (subscription_ptr->ref_counter == 0)
-                        {
-                            system_resizable_vector_delete_element_at(callback_manager_ptr->callbacks[callback_id].subscriptions,
-                                                                      n_callback);
+                    if (subscription_ptr->ref_counter == 0)
+                    {
+                        system_resizable_vector_delete_element_at(callback.subscriptions,
+                                                                  n_callback);
 
-                            delete subscription_ptr;
-                            subscription_ptr = nullptr;
-                        }
+                        delete subscription_ptr;
+                        subscription_ptr = nullptr;
 
-                        break;
+                        replaced_snapshot_ptr = _system_callback_manager_update_snapshot(callback);
                     }
-                }
-                else
-                {
-                    ASSERT_DEBUG_SYNC(false,
-                                      "Could not retrieve callback descriptor at index [%d]",
-                                      n_callback);
+
+                    break;
                 }
             }
+            else
+            {
+                ASSERT_DEBUG_SYNC(false,
+                                  "Could not retrieve callback descriptor at index [%d]",
+                                  n_callback);
+            }
         }
-        system_read_write_mutex_unlock(callback_manager_ptr->callbacks[callback_id].subscriptions_mutex,
-                                       ACCESS_WRITE);
     }
+    system_critical_section_leave(callback.subscriptions_cs);
+
+    /* Wait for other threads which may still be calling back the cancelled subscription. This is done
+     * without holding the lock, so that their call-back handlers can (un)subscribe in the meantime. */
+    _system_callback_manager_retire_snapshot(replaced_snapshot_ptr,
+                                             true); /* wait_for_sync_callers */
 }
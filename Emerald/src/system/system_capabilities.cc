@@ -10,8 +10,104 @@
     #include <unistd.h>
 #endif
 
+#if defined(_M_IX86) || defined(_M_X64) || defined(__i386__) || defined(__x86_64__)
+    #define SYSTEM_CAPABILITIES_X86
 
-PRIVATE unsigned int n_cpu_cores  = 0;
+    #ifdef _MSC_VER
+        #include <intrin.h>
+    #else
+        #include <cpuid.h>
+    #endif
+#endif
+
+
+PRIVATE bool         cpu_supports_avx2 = false;
+PRIVATE unsigned int n_cpu_cores       = 0;
+
+
+#ifdef SYSTEM_CAPABILITIES_X86
+    /** Executes CPUID for the specified leaf & sub-leaf.
+     *
+     *  @param leaf           CPUID leaf to query.
+     *  @param subleaf        CPUID sub-leaf to query.
+     *  @param out_result_ptr Deref will be set to EAX, EBX, ECX and EDX values. Must not be NULL.
+     */
+    PRIVATE void _system_capabilities_cpuid(unsigned int  leaf,
+                                            unsigned int  subleaf,
+                                            unsigned int* out_result_ptr)
+    {
+    #ifdef _MSC_VER
+        int result[4];
+
+        __cpuidex(result,
+                  leaf,
+                  subleaf);
+
+        for (unsigned int n_register = 0;
+                          n_register < 4;
+                        ++n_register)
+        {
+            out_result_ptr[n_register] = (unsigned int) result[n_register];
+        }
+    #else
+        __cpuid_count(leaf,
+                      subleaf,
+                      out_result_ptr[0],
+                      out_result_ptr[1],
+                      out_result_ptr[2],
+                      out_result_ptr[3]);
+    #endif
+    }
+
+    /** Tells whether the CPU and the OS allow AVX2 & FMA3 instructions to be used. */
+    PRIVATE bool _system_capabilities_is_avx2_supported()
+    {
+        unsigned int leaf0_result[4];
+        unsigned int leaf1_result[4];
+        unsigned int leaf7_result[4];
+        __uint64     xcr0;
+
+        _system_capabilities_cpuid(0, /* leaf    */
+                                   0, /* subleaf */
+                                   leaf0_result);
+
+        if (leaf0_result[0] < 7)
+        {
+            return false;
+        }
+
+        _system_capabilities_cpuid(1, /* leaf    */
+                                   0, /* subleaf */
+                                   leaf1_result);
+        _system_capabilities_cpuid(7, /* leaf    */
+                                   0, /* subleaf */
+                                   leaf7_result);
+
+        if ((leaf1_result[2] & (1 << 12)) == 0 || /* FMA3    */
+            (leaf1_result[2] & (1 << 27)) == 0 || /* OSXSAVE */
+            (leaf1_result[2] & (1 << 28)) == 0 || /* AVX     */
+            (leaf7_result[1] & (1 << 5))  == 0)   /* AVX2    */
+        {
+            return false;
+        }
+
+        /* Make sure the OS saves both XMM and YMM registers */
+    #ifdef _MSC_VER
+        xcr0 = _xgetbv(0);
+    #else
+        {
+            unsigned int xcr0_high;
+            unsigned int xcr0_low;
+
+            __asm__ __volatile__("xgetbv" : "=a" (xcr0_low), "=d" (xcr0_high) : "c" (0) );
+
+            xcr0 = ((__uint64) xcr0_high << 32) | xcr0_low;
+        }
+    #endif
+
+        return (xcr0 & 0x6) == 0x6;
+    }
+#endif
 
 
 /** Please see header for spec */
@@ -26,6 +122,13 @@ PUBLIC EMERALD_API void system_capabilities_get(system_capabilities_property pro
 {
     switch (property)
     {
+        case SYSTEM_CAPABILITIES_PROPERTY_CPU_SUPPORTS_AVX2:
+        {
+            *(bool*) out_result = cpu_supports_avx2;
+
+            break;
+        }
+
         case SYSTEM_CAPABILITIES_PROPERTY_NUMBER_OF_CPU_CORES:
         {
             ASSERT_DEBUG_SYNC(n_cpu_cores != 0,
@@ -55,6 +158,24 @@ PUBLIC void system_capabilities_init()
 
     n_cpu_cores = system_info.dwNumberOfProcessors;
 #else
-    n_cpu_cores = sysconf(_SC_NPROCESSORS_ONLN);
+    const long n_online_cpu_cores = sysconf(_SC_NPROCESSORS_ONLN);
+
+    n_cpu_cores = (n_online_cpu_cores > 0) ? (unsigned int) n_online_cpu_cores
+                                           : 0;
+#endif
+
+    /* Callers use the number to distribute work across the cores, so make sure we never report
+     * zero cores, even if the query has failed. */
+    ASSERT_DEBUG_SYNC(n_cpu_cores != 0,
+                      "Could not determine the number of CPU cores.");
+
+    if (n_cpu_cores == 0)
+    {
+        n_cpu_cores = 1;
+    }
+
+    /* Instruction set extensions */
+#ifdef SYSTEM_CAPABILITIES_X86
+    cpu_supports_avx2 = _system_capabilities_is_avx2_supported();
 #endif
 }
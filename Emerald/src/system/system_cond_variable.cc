@@ -200,8 +200,18 @@ PUBLIC EMERALD_API void system_cond_variable_wait_begin(system_cond_variable con
             {
                 struct timespec timeout_api;
 
-                timeout_api.tv_sec  =  timeout_msec / 1000;
-                timeout_api.tv_nsec = (timeout_msec % 1000) * NSEC_PER_SEC;
+                /* pthread_cond_timedwait() takes an absolute time-out */
+                clock_gettime(CLOCK_REALTIME,
+                             &timeout_api);
+
+                timeout_api.tv_sec  += timeout_msec / 1000;
+                timeout_api.tv_nsec += long(timeout_msec % 1000) * (NSEC_PER_SEC / 1000);
+
+                if (timeout_api.tv_nsec >= NSEC_PER_SEC)
+                {
+                    timeout_api.tv_sec  ++;
+                    timeout_api.tv_nsec -= NSEC_PER_SEC;
+                }
 
                 wait_result = pthread_cond_timedwait(&cond_variable_ptr->condition_variable,
                                                       cs_ptr,
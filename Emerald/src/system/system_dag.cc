@@ -2,138 +2,528 @@
  *
  * Emerald (kbi/elude @2014-2016)
  *
- * TODO: Optimize me!
+ * Topological order of the nodes is computed from scratch (using Kahn's algorithm) the first time the DAG
+ * is solved. After that, it is maintained incrementally with the Pearce-Kelly algorithm: adding a connection
+ * which violates the current order only reorders nodes located between the connection's endpoints, and
+ * deleting connections never invalidates the order.
  */
 #include "shared.h"
 #include "system/system_dag.h"
 #include "system/system_log.h"
 #include "system/system_resizable_vector.h"
+#include "system/system_thread_pool.h"
 
 /** Private type definitions */
+typedef struct _system_dag_node _system_dag_node;
+
 typedef struct
 {
     system_dag_node dst;
     system_dag_node src;
 } _system_dag_connection;
 
-typedef enum
-{
-    STATUS_UNVISITED,
-    STATUS_VISITED,
-    STATUS_PROCESSED
-} _system_dag_node_status;
-
-typedef struct _system_dag_node
+struct _system_dag_node
 {
     system_dag_node_value value;
 
-    /* Following properties are used only by solve() and are unavailable
+    system_resizable_vector incoming_connections; /* holds _system_dag_connection* items */
+    system_resizable_vector outgoing_connections; /* holds _system_dag_connection* items */
+
+    /* Following properties are used only internally and are unavailable
      * to users of the module: */
-    system_resizable_vector adjacent_nodes;
-    _system_dag_node_status status;
-    unsigned int            time_processed;
+    uint32_t level;
+    uint32_t n_unprocessed_incoming_connections;
+    uint32_t order; /* index of the node in _system_dag::sorted_nodes */
+    bool     visited;
 
     ~_system_dag_node()
     {
-        if (adjacent_nodes != nullptr)
+        if (incoming_connections != nullptr)
+        {
+            system_resizable_vector_release(incoming_connections);
+
+            incoming_connections = nullptr;
+        }
+
+        if (outgoing_connections != nullptr)
         {
-            system_resizable_vector_release(adjacent_nodes);
+            system_resizable_vector_release(outgoing_connections);
 
-            adjacent_nodes = nullptr;
+            outgoing_connections = nullptr;
         }
     }
-} _system_dag_node;
+};
 
 typedef struct
 {
-    system_resizable_vector connections;
     system_resizable_vector nodes;
 
+    /* true if sorted_nodes needs to be recomputed from scratch */
     bool dirty;
 
+    /* true if level_nodes & level_offsets need to be recomputed */
+    bool levels_dirty;
+
+    /* Holds nodes sorted by their level. Nodes of n-th level start at level_offsets[n] */
+    _system_dag_node** level_nodes;
+    uint32_t           level_nodes_capacity;
+    uint32_t*          level_offsets;
+    uint32_t           level_offsets_capacity;
+    uint32_t           n_levels;
+
     system_resizable_vector sorted_nodes;
 
-    /* Following properties are used only by solve() and are unavailable
+    /* Following properties are used only internally and are unavailable
      * to users of the module */
+    system_resizable_vector backward_nodes;
+    system_resizable_vector forward_nodes;
     system_resizable_vector nodes_to_process;
+    uint32_t*               orders;
+    uint32_t                orders_capacity;
 } _system_dag;
 
+/** Argument passed to system_dag_process_node_values_by_level() worker call-backs */
+typedef struct
+{
+    _system_dag_node**        nodes;
+    PFNSYSTEMDAGNODEVALUEPROC pfn_proc;
+    void*                     user_arg;
+} _system_dag_process_level_arg;
+
+
+/** Comparator used to sort nodes by their position in the topological order. */
+PRIVATE bool _system_dag_is_node_order_lower(const void* node1,
+                                             const void* node2)
+{
+    return ((const _system_dag_node*) node1)->order < ((const _system_dag_node*) node2)->order;
+}
+
+/** Removes @param connection_ptr from @param connections vector.
+ *
+ *  @return true if the connection was found, false otherwise.
+ */
+PRIVATE bool _system_dag_remove_connection_from_vector(system_resizable_vector connections,
+                                                       _system_dag_connection* connection_ptr)
+{
+    const size_t connection_index = system_resizable_vector_find(connections,
+                                                                 connection_ptr);
+
+    if (connection_index == ITEM_NOT_FOUND)
+    {
+        return false;
+    }
+
+    system_resizable_vector_delete_element_at(connections,
+                                              connection_index);
+
+    return true;
+}
+
+/** Unlinks the connection from both nodes it connects and releases it. */
+PRIVATE void _system_dag_delete_connection(_system_dag*            dag_ptr,
+                                           _system_dag_connection* connection_ptr)
+{
+    _system_dag_node* dst_node_ptr = reinterpret_cast<_system_dag_node*>(connection_ptr->dst);
+    _system_dag_node* src_node_ptr = reinterpret_cast<_system_dag_node*>(connection_ptr->src);
+
+    _system_dag_remove_connection_from_vector(dst_node_ptr->incoming_connections,
+                                              connection_ptr);
+    _system_dag_remove_connection_from_vector(src_node_ptr->outgoing_connections,
+                                              connection_ptr);
+
+    delete connection_ptr;
+
+    /* Removing a connection never invalidates the topological order, but it may affect the levels */
+    dag_ptr->levels_dirty = true;
+}
 
-/** TODO */
-PRIVATE bool _system_dag_process_node(_system_dag_node*       node_ptr,
-                                      unsigned int*           time_ptr,
-                                      system_resizable_vector processed_nodes_vector)
+/** Ensures @param dag_ptr->orders can hold at least @param n_orders items. */
+PRIVATE void _system_dag_reserve_orders(_system_dag* dag_ptr,
+                                        uint32_t     n_orders)
+{
+    if (dag_ptr->orders_capacity < n_orders)
     {
-        _system_dag_node* adjacent_node_ptr = nullptr;
-        unsigned int      n_adjacent_nodes  = 0;
-        bool              result            = true;
+        delete [] dag_ptr->orders;
 
-        system_resizable_vector_get_property(node_ptr->adjacent_nodes,
+        dag_ptr->orders_capacity = n_orders * 2;
+        dag_ptr->orders          = new uint32_t[dag_ptr->orders_capacity];
+    }
+}
+
+/** Updates the topological order after a src->dst connection has been added, using the Pearce-Kelly algorithm.
+ *
+ *  Only nodes whose order lies between dst and src are visited: the ones reachable from dst are moved
+ *  right after the ones which src is reachable from, reusing the order indices previously occupied by
+ *  both sets.
+ *
+ *  @return true if successful, false if the new connection introduced a cycle.
+ */
+PRIVATE bool _system_dag_update_order_for_new_connection(_system_dag*      dag_ptr,
+                                                         _system_dag_node* src_node_ptr,
+                                                         _system_dag_node* dst_node_ptr)
+{
+    const uint32_t    lower_bound           = dst_node_ptr->order;
+    uint32_t          n_backward_nodes      = 0;
+    uint32_t          n_forward_nodes       = 0;
+    bool              result                = true;
+    const uint32_t    upper_bound           = src_node_ptr->order;
+    _system_dag_node* current_node_ptr      = nullptr;
+
+    if (src_node_ptr == dst_node_ptr)
+    {
+        return false;
+    }
+
+    if (upper_bound < lower_bound)
+    {
+        /* The order is still valid */
+        return true;
+    }
+
+    system_resizable_vector_empty(dag_ptr->backward_nodes);
+    system_resizable_vector_empty(dag_ptr->forward_nodes);
+    system_resizable_vector_empty(dag_ptr->nodes_to_process);
+
+    /* 1. Find nodes reachable from dst, which are currently placed before src. If src is one of them,
+     *    the new connection closes a cycle. */
+    dst_node_ptr->visited = true;
+
+    system_resizable_vector_push(dag_ptr->forward_nodes,
+                                 dst_node_ptr);
+    system_resizable_vector_push(dag_ptr->nodes_to_process,
+                                 dst_node_ptr);
+
+    while (result                                             &&
+           system_resizable_vector_pop(dag_ptr->nodes_to_process,
+                                      &current_node_ptr) )
+    {
+        uint32_t n_connections = 0;
+
+        system_resizable_vector_get_property(current_node_ptr->outgoing_connections,
                                              SYSTEM_RESIZABLE_VECTOR_PROPERTY_N_ELEMENTS,
-                                            &n_adjacent_nodes);
+                                            &n_connections);
 
-        node_ptr->status = STATUS_VISITED;
-        (*time_ptr)      ++;
+        for (uint32_t n_connection = 0;
+                      n_connection < n_connections;
+                    ++n_connection)
+        {
+            _system_dag_connection* connection_ptr = nullptr;
+            _system_dag_node*       next_node_ptr  = nullptr;
 
-        for (unsigned int n_adjacent_node = 0;
-                          n_adjacent_node < n_adjacent_nodes;
-                        ++n_adjacent_node)
+            system_resizable_vector_get_element_at(current_node_ptr->outgoing_connections,
+                                                   n_connection,
+                                                  &connection_ptr);
+
+            next_node_ptr = reinterpret_cast<_system_dag_node*>(connection_ptr->dst);
+
+            if (next_node_ptr == src_node_ptr)
+            {
+                result = false;
+
+                break;
+            }
+
+            if (!next_node_ptr->visited             &&
+                 next_node_ptr->order < upper_bound)
+            {
+                next_node_ptr->visited = true;
+
+                system_resizable_vector_push(dag_ptr->forward_nodes,
+                                             next_node_ptr);
+                system_resizable_vector_push(dag_ptr->nodes_to_process,
+                                             next_node_ptr);
+            }
+        }
+    }
+
+    /* 2. Find nodes which src is reachable from, which are currently placed after dst. */
+    if (result)
+    {
+        src_node_ptr->visited = true;
+
+        system_resizable_vector_push(dag_ptr->backward_nodes,
+                                     src_node_ptr);
+        system_resizable_vector_push(dag_ptr->nodes_to_process,
+                                     src_node_ptr);
+
+        while (system_resizable_vector_pop(dag_ptr->nodes_to_process,
+                                          &current_node_ptr) )
         {
-            if (system_resizable_vector_get_element_at(node_ptr->adjacent_nodes,
-                                                       n_adjacent_node,
-                                                      &adjacent_node_ptr) )
+            uint32_t n_connections = 0;
+
+            system_resizable_vector_get_property(current_node_ptr->incoming_connections,
+                                                 SYSTEM_RESIZABLE_VECTOR_PROPERTY_N_ELEMENTS,
+                                                &n_connections);
+
+            for (uint32_t n_connection = 0;
+                          n_connection < n_connections;
+                        ++n_connection)
             {
-                if (adjacent_node_ptr->status == STATUS_UNVISITED)
-                {
-                    result = _system_dag_process_node(adjacent_node_ptr,
-                                                      time_ptr,
-                                                      processed_nodes_vector);
-
-                    if (!result)
-                    {
-                        goto end;
-                    }
-                }
-                else
-                if (adjacent_node_ptr->status == STATUS_VISITED)
+                _system_dag_connection* connection_ptr = nullptr;
+                _system_dag_node*       prev_node_ptr  = nullptr;
+
+                system_resizable_vector_get_element_at(current_node_ptr->incoming_connections,
+                                                       n_connection,
+                                                      &connection_ptr);
+
+                prev_node_ptr = reinterpret_cast<_system_dag_node*>(connection_ptr->src);
+
+                if (!prev_node_ptr->visited             &&
+                     prev_node_ptr->order > lower_bound)
                 {
-                    /* This is a returning edge indicating that the graph we're operating on
-                     * ain't a DAG!
-                     */
-                    ASSERT_DEBUG_SYNC(false,
-                                      "system_dag operating on a graph that's not a DAG");
-
-                    result = false;
-                    goto end;
+                    prev_node_ptr->visited = true;
+
+                    system_resizable_vector_push(dag_ptr->backward_nodes,
+                                                 prev_node_ptr);
+                    system_resizable_vector_push(dag_ptr->nodes_to_process,
+                                                 prev_node_ptr);
                 }
             }
+        }
+    }
+
+    system_resizable_vector_get_property(dag_ptr->backward_nodes,
+                                         SYSTEM_RESIZABLE_VECTOR_PROPERTY_N_ELEMENTS,
+                                        &n_backward_nodes);
+    system_resizable_vector_get_property(dag_ptr->forward_nodes,
+                                         SYSTEM_RESIZABLE_VECTOR_PROPERTY_N_ELEMENTS,
+                                        &n_forward_nodes);
+
+    /* 3. Reassign the order indices. Both sets keep their relative order, but all nodes of the backward set
+     *    are placed before all nodes of the forward set. */
+    if (result)
+    {
+        _system_dag_node** backward_nodes = nullptr;
+        _system_dag_node** forward_nodes  = nullptr;
+        uint32_t           n_backward     = 0;
+        uint32_t           n_forward      = 0;
+
+        system_resizable_vector_sort(dag_ptr->backward_nodes,
+                                     _system_dag_is_node_order_lower);
+        system_resizable_vector_sort(dag_ptr->forward_nodes,
+                                     _system_dag_is_node_order_lower);
+
+        system_resizable_vector_get_property(dag_ptr->backward_nodes,
+                                             SYSTEM_RESIZABLE_VECTOR_PROPERTY_ARRAY,
+                                            &backward_nodes);
+        system_resizable_vector_get_property(dag_ptr->forward_nodes,
+                                             SYSTEM_RESIZABLE_VECTOR_PROPERTY_ARRAY,
+                                            &forward_nodes);
+
+        _system_dag_reserve_orders(dag_ptr,
+                                   n_backward_nodes + n_forward_nodes);
+
+        for (uint32_t n_order = 0;
+                      n_order < n_backward_nodes + n_forward_nodes;
+                    ++n_order)
+        {
+            if ( n_forward >= n_forward_nodes                                                                   ||
+                (n_backward < n_backward_nodes && backward_nodes[n_backward]->order < forward_nodes[n_forward]->order) )
+            {
+                dag_ptr->orders[n_order] = backward_nodes[n_backward++]->order;
+            }
             else
             {
-                ASSERT_DEBUG_SYNC(false,
-                                  "Could not retrieve adjacent node at index [%d]",
-                                  n_adjacent_node);
+                dag_ptr->orders[n_order] = forward_nodes[n_forward++]->order;
             }
         }
 
-        (*time_ptr)++;
+        for (uint32_t n_node = 0;
+                      n_node < n_backward_nodes + n_forward_nodes;
+                    ++n_node)
+        {
+            _system_dag_node* node_ptr = (n_node < n_backward_nodes) ? backward_nodes[n_node]
+                                                                     : forward_nodes [n_node - n_backward_nodes];
+
+            node_ptr->order = dag_ptr->orders[n_node];
+
+            system_resizable_vector_set_element_at(dag_ptr->sorted_nodes,
+                                                   node_ptr->order,
+                                                   node_ptr);
+        }
+    }
 
-        node_ptr->status         = STATUS_PROCESSED;
-        node_ptr->time_processed = *time_ptr;
+    /* 4. Clean up */
+    for (uint32_t n_node = 0;
+                  n_node < n_backward_nodes;
+                ++n_node)
+    {
+        system_resizable_vector_get_element_at(dag_ptr->backward_nodes,
+                                               n_node,
+                                              &current_node_ptr);
 
-        system_resizable_vector_insert_element_at(processed_nodes_vector,
-                                                  0,
-                                                  node_ptr);
+        current_node_ptr->visited = false;
+    }
 
-end:
-        return result;
+    for (uint32_t n_node = 0;
+                  n_node < n_forward_nodes;
+                ++n_node)
+    {
+        system_resizable_vector_get_element_at(dag_ptr->forward_nodes,
+                                               n_node,
+                                              &current_node_ptr);
+
+        current_node_ptr->visited = false;
+    }
+
+    return result;
+}
+
+/** Recomputes the level of each node, and groups the nodes by their levels. The topological order must be valid. */
+PRIVATE void _system_dag_update_levels(_system_dag* dag_ptr)
+{
+    uint32_t           n_nodes      = 0;
+    _system_dag_node** sorted_nodes = nullptr;
+
+    system_resizable_vector_get_property(dag_ptr->sorted_nodes,
+                                         SYSTEM_RESIZABLE_VECTOR_PROPERTY_N_ELEMENTS,
+                                        &n_nodes);
+    system_resizable_vector_get_property(dag_ptr->sorted_nodes,
+                                         SYSTEM_RESIZABLE_VECTOR_PROPERTY_ARRAY,
+                                        &sorted_nodes);
+
+    /* 1. Each node is placed one level below the deepest node it depends on. Nodes are visited in topological
+     *    order, so levels of all nodes a node depends on are known by the time it is reached. */
+    dag_ptr->n_levels = 0;
+
+    for (uint32_t n_node = 0;
+                  n_node < n_nodes;
+                ++n_node)
+    {
+        _system_dag_node* node_ptr      = sorted_nodes[n_node];
+        uint32_t          n_connections = 0;
+
+        system_resizable_vector_get_property(node_ptr->incoming_connections,
+                                             SYSTEM_RESIZABLE_VECTOR_PROPERTY_N_ELEMENTS,
+                                            &n_connections);
+
+        node_ptr->level = 0;
+
+        for (uint32_t n_connection = 0;
+                      n_connection < n_connections;
+                    ++n_connection)
+        {
+            _system_dag_connection* connection_ptr = nullptr;
+            _system_dag_node*       src_node_ptr   = nullptr;
+
+            system_resizable_vector_get_element_at(node_ptr->incoming_connections,
+                                                   n_connection,
+                                                  &connection_ptr);
+
+            src_node_ptr = reinterpret_cast<_system_dag_node*>(connection_ptr->src);
+
+            if (node_ptr->level < src_node_ptr->level + 1)
+            {
+                node_ptr->level = src_node_ptr->level + 1;
+            }
+        }
+
+        if (dag_ptr->n_levels < node_ptr->level + 1)
+        {
+            dag_ptr->n_levels = node_ptr->level + 1;
+        }
+    }
+
+    /* 2. Group the nodes by level with a counting sort */
+    if (dag_ptr->level_nodes_capacity < n_nodes)
+    {
+        delete [] dag_ptr->level_nodes;
+
+        dag_ptr->level_nodes_capacity = n_nodes * 2;
+        dag_ptr->level_nodes          = new _system_dag_node*[dag_ptr->level_nodes_capacity];
+    }
+
+    if (dag_ptr->level_offsets_capacity < dag_ptr->n_levels + 1)
+    {
+        delete [] dag_ptr->level_offsets;
+
+        dag_ptr->level_offsets_capacity = (dag_ptr->n_levels + 1) * 2;
+        dag_ptr->level_offsets          = new uint32_t[dag_ptr->level_offsets_capacity];
+    }
+
+    memset(dag_ptr->level_offsets,
+           0,
+           sizeof(uint32_t) * (dag_ptr->n_levels + 1) );
+
+    for (uint32_t n_node = 0;
+                  n_node < n_nodes;
+                ++n_node)
+    {
+        dag_ptr->level_offsets[sorted_nodes[n_node]->level + 1]++;
     }
 
+    for (uint32_t n_level = 0;
+                  n_level < dag_ptr->n_levels;
+                ++n_level)
+    {
+        dag_ptr->level_offsets[n_level + 1] += dag_ptr->level_offsets[n_level];
+    }
+
+    /* Use the order indices as insertion cursors, so that the offsets stay intact */
+    _system_dag_reserve_orders(dag_ptr,
+                               dag_ptr->n_levels);
+
+    memcpy(dag_ptr->orders,
+           dag_ptr->level_offsets,
+           sizeof(uint32_t) * dag_ptr->n_levels);
+
+    for (uint32_t n_node = 0;
+                  n_node < n_nodes;
+                ++n_node)
+    {
+        dag_ptr->level_nodes[dag_ptr->orders[sorted_nodes[n_node]->level]++] = sorted_nodes[n_node];
+    }
+
+    dag_ptr->levels_dirty = false;
+}
+
+/** Brings the topological order and the levels up to date, if needed.
+ *
+ *  @return true if successful, false if the graph is not a DAG.
+ */
+PRIVATE bool _system_dag_validate_levels(_system_dag* dag_ptr)
+{
+    if (dag_ptr->dirty)
+    {
+        if (!system_dag_solve( (system_dag) dag_ptr) )
+        {
+            return false;
+        }
+    }
+
+    if (dag_ptr->levels_dirty)
+    {
+        _system_dag_update_levels(dag_ptr);
+    }
+
+    return true;
+}
+
+/** Thread pool call-back used by system_dag_process_node_values_by_level(). */
+PRIVATE void _system_dag_process_level_nodes(uint32_t range_start,
+                                             uint32_t range_end,
+                                             void*    user_arg)
+{
+    _system_dag_process_level_arg* arg_ptr = reinterpret_cast<_system_dag_process_level_arg*>(user_arg);
+
+    for (uint32_t n_node = range_start;
+                  n_node < range_end;
+                ++n_node)
+    {
+        arg_ptr->pfn_proc(arg_ptr->nodes[n_node]->value,
+                          arg_ptr->user_arg);
+    }
+}
+
+
 /** Please see header for specification */
 PUBLIC EMERALD_API system_dag_connection system_dag_add_connection(system_dag      dag,
                                                                    system_dag_node src,
                                                                    system_dag_node dst)
 {
-    _system_dag* dag_ptr = reinterpret_cast<_system_dag*>(dag);
+    _system_dag*      dag_ptr      = reinterpret_cast<_system_dag*>     (dag);
+    _system_dag_node* dst_node_ptr = reinterpret_cast<_system_dag_node*>(dst);
+    _system_dag_node* src_node_ptr = reinterpret_cast<_system_dag_node*>(src);
 
     /* Create new descriptor */
     _system_dag_connection* new_connection = new (std::nothrow) _system_dag_connection;
@@ -149,49 +539,75 @@ PUBLIC EMERALD_API system_dag_connection system_dag_add_connection(system_dag
     new_connection->dst = dst;
     new_connection->src = src;
 
-    /* Associate the connection with DAG */
-    system_resizable_vector_push(dag_ptr->connections,
+    /* Associate the connection with the nodes */
+    system_resizable_vector_push(dst_node_ptr->incoming_connections,
                                  new_connection);
+    system_resizable_vector_push(src_node_ptr->outgoing_connections,
+                                 new_connection);
+
+    dag_ptr->levels_dirty = true;
+
+    /* Update the topological order. If the DAG has not been solved yet, defer the work until it is, so that
+     * freshly built graphs are sorted in one go. */
+    if (!dag_ptr->dirty)
+    {
+        if (!_system_dag_update_order_for_new_connection(dag_ptr,
+                                                         src_node_ptr,
+                                                         dst_node_ptr) )
+        {
+            dag_ptr->dirty = true;
+        }
+    }
 
-    dag_ptr->dirty = true;
 end:
     return new_connection;
 }
 
-/** TODO */
+/** Please see header for specification */
 PUBLIC EMERALD_API system_dag_node system_dag_add_node(system_dag            dag,
                                                        system_dag_node_value value)
 {
     _system_dag* dag_ptr = reinterpret_cast<_system_dag*>(dag);
+    uint32_t     n_nodes = 0;
 
     /* Create new descriptor */
     _system_dag_node* new_node = new (std::nothrow) _system_dag_node;
 
     if (new_node == nullptr)
     {
-        ASSERT_ALWAYS_SYNC(0, 
+        ASSERT_ALWAYS_SYNC(0,
                            "Out of memory");
 
         goto end;
     }
 
-    new_node->adjacent_nodes   = system_resizable_vector_create(4 /* capacity */);
-    new_node->status           = STATUS_UNVISITED;
-    new_node->time_processed   = 0;
-    new_node->value            = value;
+    system_resizable_vector_get_property(dag_ptr->sorted_nodes,
+                                         SYSTEM_RESIZABLE_VECTOR_PROPERTY_N_ELEMENTS,
+                                        &n_nodes);
+
+    new_node->incoming_connections               = system_resizable_vector_create(4 /* capacity */);
+    new_node->level                              = 0;
+    new_node->n_unprocessed_incoming_connections = 0;
+    new_node->order                              = n_nodes;
+    new_node->outgoing_connections               = system_resizable_vector_create(4 /* capacity */);
+    new_node->value                              = value;
+    new_node->visited                            = false;
 
-    /* Associate the node with DAG */
+    /* Associate the node with DAG. A node without connections can be placed anywhere in the topological order,
+     * so append it to the end. */
     system_resizable_vector_push(dag_ptr->nodes,
                                  new_node);
+    system_resizable_vector_push(dag_ptr->sorted_nodes,
+                                 new_node);
 
-    dag_ptr->dirty = true;
+    dag_ptr->levels_dirty = true;
 
     /* Done */
 end:
     return new_node;
 }
 
-/** TODO */
+/** Please see header for specification */
 PUBLIC EMERALD_API system_dag system_dag_create()
 {
     _system_dag* result = new (std::nothrow) _system_dag;
@@ -204,22 +620,31 @@ PUBLIC EMERALD_API system_dag system_dag_create()
         goto end;
     }
 
-    result->connections      = system_resizable_vector_create(4 /* capacity */);
-    result->dirty            = false;
-    result->nodes            = system_resizable_vector_create(4 /* capacity */);
-    result->nodes_to_process = system_resizable_vector_create(4 /* capacity */);
-    result->sorted_nodes     = system_resizable_vector_create(4 /* capacity */);
+    result->backward_nodes         = system_resizable_vector_create(4 /* capacity */);
+    result->dirty                  = true;
+    result->forward_nodes          = system_resizable_vector_create(4 /* capacity */);
+    result->level_nodes            = nullptr;
+    result->level_nodes_capacity   = 0;
+    result->level_offsets          = nullptr;
+    result->level_offsets_capacity = 0;
+    result->levels_dirty           = true;
+    result->n_levels               = 0;
+    result->nodes                  = system_resizable_vector_create(4 /* capacity */);
+    result->nodes_to_process       = system_resizable_vector_create(4 /* capacity */);
+    result->orders                 = nullptr;
+    result->orders_capacity        = 0;
+    result->sorted_nodes           = system_resizable_vector_create(4 /* capacity */);
 
 end:
     return (system_dag) result;
 }
 
-/** TODO */
+/** Please see header for specification */
 PUBLIC EMERALD_API void system_dag_delete_connection(system_dag            dag,
                                                      system_dag_connection connection)
 {
-    size_t       connection_index = -1;
-    _system_dag* dag_ptr          = reinterpret_cast<_system_dag*>(dag);
+    _system_dag_connection* connection_ptr = reinterpret_cast<_system_dag_connection*>(connection);
+    _system_dag*            dag_ptr        = reinterpret_cast<_system_dag*>           (dag);
 
     /* Sanity checks */
     if (connection == nullptr)
@@ -238,9 +663,9 @@ PUBLIC EMERALD_API void system_dag_delete_connection(system_dag            dag,
         goto end;
     }
 
-    /* Find the requested connection */
-    if ( (connection_index = system_resizable_vector_find(dag_ptr->connections,
-                                                          connection) ) == ITEM_NOT_FOUND)
+    /* Make sure the connection is known */
+    if (system_resizable_vector_find(reinterpret_cast<_system_dag_node*>(connection_ptr->src)->outgoing_connections,
+                                     connection) == ITEM_NOT_FOUND)
     {
         ASSERT_DEBUG_SYNC(false,
                           "Could not find the specified DAG connection instance");
@@ -248,28 +673,22 @@ PUBLIC EMERALD_API void system_dag_delete_connection(system_dag            dag,
         goto end;
     }
 
-    /* Delete the connection and mark the DAG as dirty */
-    system_resizable_vector_delete_element_at(dag_ptr->connections,
-                                              connection_index);
-
-    delete reinterpret_cast<_system_dag_connection*>(connection);
-    connection = nullptr;
-
-    dag_ptr->dirty = true;
+    _system_dag_delete_connection(dag_ptr,
+                                  connection_ptr);
 
 end:
     ;
 }
 
-/** TODO */
+/** Please see header for specification */
 PUBLIC EMERALD_API bool system_dag_delete_connections(system_dag      dag,
                                                       system_dag_node src,
                                                       system_dag_node dst)
 {
-    _system_dag_connection* connection_ptr        = nullptr;
-    _system_dag*            dag_ptr               = reinterpret_cast<_system_dag*>(dag);
-    uint32_t                n_connections_defined = 0;
-    bool                    result                = false;
+    _system_dag_connection* connection_ptr = nullptr;
+    system_resizable_vector connections    = nullptr;
+    _system_dag*            dag_ptr        = reinterpret_cast<_system_dag*>(dag);
+    bool                    result         = false;
 
     /* Sanity checks */
     if (dag == nullptr)
@@ -289,44 +708,18 @@ PUBLIC EMERALD_API bool system_dag_delete_connections(system_dag      dag,
         goto end;
     }
 
-    /* Walk through all connections and try to find any matches. */
-    system_resizable_vector_get_property(dag_ptr->connections,
-                                         SYSTEM_RESIZABLE_VECTOR_PROPERTY_N_ELEMENTS,
-                                        &n_connections_defined);
+    /* Delete all outgoing connections of src, or all incoming connections of dst. */
+    connections = (src != nullptr) ? reinterpret_cast<_system_dag_node*>(src)->outgoing_connections
+                                   : reinterpret_cast<_system_dag_node*>(dst)->incoming_connections;
 
-    for (uint32_t n_connection = 0;
-                  n_connection < n_connections_defined;
-                  )
+    while (system_resizable_vector_get_element_at(connections,
+                                                  0, /* index */
+                                                 &connection_ptr) )
     {
-        if (!system_resizable_vector_get_element_at(dag_ptr->connections,
-                                                    n_connection,
-                                                   &connection_ptr) )
-        {
-            ASSERT_DEBUG_SYNC(false,
-                              "Could not retrieve connection descriptor at index [%d]",
-                              n_connection);
-
-            ++n_connection;
-            continue;
-        }
-
-        if ((dst == nullptr                                ||
-             dst != nullptr && connection_ptr->dst == dst) &&
-            (src == nullptr                                ||
-             src != nullptr && connection_ptr->src == src) )
-        {
-            /* This is a match */
-            system_resizable_vector_delete_element_at(dag_ptr->connections,
-                                                      n_connection);
-
-            --n_connections_defined;
+        _system_dag_delete_connection(dag_ptr,
+                                      connection_ptr);
 
-            result = true;
-        }
-        else
-        {
-            ++n_connection;
-        }
+        result = true;
     }
 
     /* All done */
@@ -334,17 +727,17 @@ end:
     return result;
 }
 
-/** TODO */
+/** Please see header for specification */
 PUBLIC EMERALD_API bool system_dag_get_connections(system_dag             dag,
                                                    system_dag_node        src,
                                                    system_dag_node        dst,
                                                    uint32_t*              out_opt_n_connections_ptr,
                                                    system_dag_connection* out_opt_connections_ptr)
 {
-    _system_dag* dag_ptr             = reinterpret_cast<_system_dag*>(dag);
-    uint32_t     n_connections       = 0;
-    uint32_t     n_found_connections = 0;
-    bool         result              = false;
+    system_resizable_vector connections         = nullptr;
+    uint32_t                n_connections       = 0;
+    uint32_t                n_found_connections = 0;
+    bool                    result              = false;
 
     /* Sanity checks */
     if (dag == nullptr)
@@ -363,7 +756,11 @@ PUBLIC EMERALD_API bool system_dag_get_connections(system_dag             dag,
         goto end;
     }
 
-    system_resizable_vector_get_property(dag_ptr->connections,
+    /* Only the connections of one of the nodes need to be inspected */
+    connections = (src != nullptr) ? reinterpret_cast<_system_dag_node*>(src)->outgoing_connections
+                                   : reinterpret_cast<_system_dag_node*>(dst)->incoming_connections;
+
+    system_resizable_vector_get_property(connections,
                                          SYSTEM_RESIZABLE_VECTOR_PROPERTY_N_ELEMENTS,
                                         &n_connections);
 
@@ -373,7 +770,7 @@ PUBLIC EMERALD_API bool system_dag_get_connections(system_dag             dag,
     {
         _system_dag_connection* connection_ptr = nullptr;
 
-        if (!system_resizable_vector_get_element_at(dag_ptr->connections,
+        if (!system_resizable_vector_get_element_at(connections,
                                                     n_connection,
                                                    &connection_ptr) )
         {
@@ -406,7 +803,57 @@ end:
     return result;
 }
 
-/** TODO */
+/** Please see header for specification */
+PUBLIC EMERALD_API bool system_dag_get_level_node_values(system_dag              dag,
+                                                         uint32_t                n_level,
+                                                         system_resizable_vector result)
+{
+    _system_dag* dag_ptr = reinterpret_cast<_system_dag*>(dag);
+
+    system_resizable_vector_empty(result);
+
+    if (!_system_dag_validate_levels(dag_ptr) )
+    {
+        return false;
+    }
+
+    if (n_level >= dag_ptr->n_levels)
+    {
+        ASSERT_DEBUG_SYNC(false,
+                          "Invalid level index [%d] requested",
+                          n_level);
+
+        return false;
+    }
+
+    for (uint32_t n_node  = dag_ptr->level_offsets[n_level];
+                  n_node  < dag_ptr->level_offsets[n_level + 1];
+                ++n_node)
+    {
+        system_resizable_vector_push(result,
+                                     dag_ptr->level_nodes[n_node]->value);
+    }
+
+    return true;
+}
+
+/** Please see header for specification */
+PUBLIC EMERALD_API bool system_dag_get_n_levels(system_dag dag,
+                                                uint32_t*  out_n_levels_ptr)
+{
+    _system_dag* dag_ptr = reinterpret_cast<_system_dag*>(dag);
+
+    if (!_system_dag_validate_levels(dag_ptr) )
+    {
+        return false;
+    }
+
+    *out_n_levels_ptr = dag_ptr->n_levels;
+
+    return true;
+}
+
+/** Please see header for specification */
 PUBLIC EMERALD_API bool system_dag_get_topologically_sorted_node_values(system_dag              dag,
                                                                         system_resizable_vector result)
 {
@@ -463,7 +910,7 @@ end:
     return result_bool;
 }
 
-/** TODO */
+/** Please see header for specification */
 PUBLIC EMERALD_API bool system_dag_is_connection_defined(system_dag      dag,
                                                          system_dag_node src,
                                                          system_dag_node dst)
@@ -497,35 +944,52 @@ end:
     return result;
 }
 
-/** TODO */
+/** Please see header for specification */
 PUBLIC EMERALD_API bool system_dag_is_dirty(system_dag dag)
 {
     return (reinterpret_cast<_system_dag*>(dag) )->dirty;
 }
 
-/** TODO */
-PUBLIC EMERALD_API void system_dag_release(system_dag dag)
+/** Please see header for specification */
+PUBLIC EMERALD_API bool system_dag_process_node_values_by_level(system_dag                dag,
+                                                                PFNSYSTEMDAGNODEVALUEPROC pfn_proc,
+                                                                void*                     user_arg)
 {
-    _system_dag* dag_ptr = reinterpret_cast<_system_dag*>(dag);
+    _system_dag_process_level_arg arg;
+    _system_dag*                  dag_ptr = reinterpret_cast<_system_dag*>(dag);
 
-    if (dag_ptr->connections != nullptr)
+    if (!_system_dag_validate_levels(dag_ptr) )
     {
-        _system_dag_connection* connection_ptr = nullptr;
-
-        while (system_resizable_vector_pop(dag_ptr->connections,
-                                          &connection_ptr) )
-        {
-            delete connection_ptr;
+        return false;
+    }
 
-            connection_ptr = nullptr;
-        }
+    arg.nodes    = dag_ptr->level_nodes;
+    arg.pfn_proc = pfn_proc;
+    arg.user_arg = user_arg;
 
-        system_resizable_vector_release(dag_ptr->connections);
-        dag_ptr->connections = nullptr;
+    for (uint32_t n_level = 0;
+                  n_level < dag_ptr->n_levels;
+                ++n_level)
+    {
+        system_thread_pool_parallel_for(dag_ptr->level_offsets[n_level],
+                                        dag_ptr->level_offsets[n_level + 1],
+                                        1, /* grain_size */
+                                        _system_dag_process_level_nodes,
+                                       &arg);
     }
 
+    return true;
+}
+
+/** Please see header for specification */
+PUBLIC EMERALD_API void system_dag_release(system_dag dag)
+{
+    _system_dag* dag_ptr = reinterpret_cast<_system_dag*>(dag);
+
     if (dag_ptr->nodes != nullptr)
     {
+        system_dag_reset_connections(dag);
+
         _system_dag_node* node_ptr = nullptr;
 
         while (system_resizable_vector_pop(dag_ptr->nodes,
@@ -540,74 +1004,107 @@ PUBLIC EMERALD_API void system_dag_release(system_dag dag)
         dag_ptr->nodes = nullptr;
     }
 
-    if (dag_ptr->nodes_to_process != nullptr)
+    system_resizable_vector* vectors_to_release[] =
     {
-        system_resizable_vector_release(dag_ptr->nodes_to_process);
-
-        dag_ptr->nodes_to_process = nullptr;
-    }
-
-    if (dag_ptr->sorted_nodes != nullptr)
+        &dag_ptr->backward_nodes,
+        &dag_ptr->forward_nodes,
+        &dag_ptr->nodes_to_process,
+        &dag_ptr->sorted_nodes
+    };
+    const uint32_t n_vectors_to_release = sizeof(vectors_to_release) / sizeof(vectors_to_release[0]);
+
+    for (uint32_t n_vector = 0;
+                  n_vector < n_vectors_to_release;
+                ++n_vector)
     {
-        system_resizable_vector_release(dag_ptr->sorted_nodes);
+        if (*vectors_to_release[n_vector] != nullptr)
+        {
+            system_resizable_vector_release(*vectors_to_release[n_vector]);
 
-        dag_ptr->sorted_nodes = nullptr;
+            *vectors_to_release[n_vector] = nullptr;
+        }
     }
 
+    delete [] dag_ptr->level_nodes;
+    delete [] dag_ptr->level_offsets;
+    delete [] dag_ptr->orders;
+
     delete dag_ptr;
 }
 
-/** TODO */
+/** Please see header for specification */
 PUBLIC EMERALD_API void system_dag_reset_connections(system_dag dag)
 {
     _system_dag*            dag_ptr        = reinterpret_cast<_system_dag*>(dag);
     _system_dag_connection* connection_ptr = nullptr;
+    uint32_t                n_nodes        = 0;
 
-    while (system_resizable_vector_pop(dag_ptr->connections,
-                                      &connection_ptr) )
+    system_resizable_vector_get_property(dag_ptr->nodes,
+                                         SYSTEM_RESIZABLE_VECTOR_PROPERTY_N_ELEMENTS,
+                                        &n_nodes);
+
+    for (uint32_t n_node = 0;
+                  n_node < n_nodes;
+                ++n_node)
     {
-        delete connection_ptr;
+        _system_dag_node* node_ptr = nullptr;
+
+        system_resizable_vector_get_element_at(dag_ptr->nodes,
+                                               n_node,
+                                              &node_ptr);
 
-        connection_ptr = nullptr;
+        /* Each connection is owned by the source node's outgoing connection vector */
+        while (system_resizable_vector_pop(node_ptr->outgoing_connections,
+                                          &connection_ptr) )
+        {
+            delete connection_ptr;
+
+            connection_ptr = nullptr;
+        }
+
+        system_resizable_vector_empty(node_ptr->incoming_connections);
     }
+
+    dag_ptr->levels_dirty = true;
 }
 
-/** TODO */
+/** Please see header for specification */
 PUBLIC EMERALD_API bool system_dag_solve(system_dag dag)
 {
     _system_dag_node* current_node_ptr = nullptr;
     _system_dag*      dag_ptr          = reinterpret_cast<_system_dag*>(dag);
-    unsigned int      n_connections    = 0;
-    unsigned int      n_nodes          = 0;
+    uint32_t          n_nodes          = 0;
+    uint32_t          n_sorted_nodes   = 0;
     bool              result           = false;
-    unsigned int      time             = 0;
 
-    system_resizable_vector_get_property(dag_ptr->connections,
-                                         SYSTEM_RESIZABLE_VECTOR_PROPERTY_N_ELEMENTS,
-                                        &n_connections);
+    if (!dag_ptr->dirty)
+    {
+        /* The topological order has been kept up-to-date by the functions which modified the DAG. */
+        result = true;
+
+        goto end;
+    }
+
     system_resizable_vector_get_property(dag_ptr->nodes,
                                          SYSTEM_RESIZABLE_VECTOR_PROPERTY_N_ELEMENTS,
                                         &n_nodes);
 
-    /* This is the man-on-the-street implementation of topological sorting of DAG nodes.
+    /* This is Kahn's algorithm:
      *
-     * 1. Reset adjacent node storage for all nodes. Also, mark all nodes as not-visited.
+     * 1. Count incoming connections of all nodes. Nodes without any can go first.
      */
-    for (unsigned int n_node = 0;
-                      n_node < n_nodes;
-                    ++n_node)
+    system_resizable_vector_empty(dag_ptr->nodes_to_process);
+    system_resizable_vector_empty(dag_ptr->sorted_nodes);
+
+    for (uint32_t n_node = 0;
+                  n_node < n_nodes;
+                ++n_node)
     {
         _system_dag_node* node_ptr = nullptr;
 
-        if (system_resizable_vector_get_element_at(dag_ptr->nodes,
-                                                   n_node,
-                                                  &node_ptr) )
-        {
-            system_resizable_vector_empty(node_ptr->adjacent_nodes);
-
-            node_ptr->status = STATUS_UNVISITED;
-        }
-        else
+        if (!system_resizable_vector_get_element_at(dag_ptr->nodes,
+                                                    n_node,
+                                                   &node_ptr) )
         {
             ASSERT_DEBUG_SYNC(false,
                               "Could not retrieve node at index [%d]",
@@ -615,84 +1112,68 @@ PUBLIC EMERALD_API bool system_dag_solve(system_dag dag)
 
             goto end;
         }
-    }
-
-    /* 2. Fill adjacent node storage */
-    for (unsigned int n_connection = 0;
-                      n_connection < n_connections;
-                    ++n_connection)
-    {
-        _system_dag_connection* connection_ptr = nullptr;
 
-        if (system_resizable_vector_get_element_at(dag_ptr->connections,
-                                                   n_connection,
-                                                  &connection_ptr) )
-        {
-            _system_dag_node* dst_node_ptr = reinterpret_cast<_system_dag_node*>(connection_ptr->dst);
-            _system_dag_node* src_node_ptr = reinterpret_cast<_system_dag_node*>(connection_ptr->src);
+        system_resizable_vector_get_property(node_ptr->incoming_connections,
+                                             SYSTEM_RESIZABLE_VECTOR_PROPERTY_N_ELEMENTS,
+                                            &node_ptr->n_unprocessed_incoming_connections);
 
-            system_resizable_vector_push(src_node_ptr->adjacent_nodes,
-                                         dst_node_ptr);
-        }
-        else
+        if (node_ptr->n_unprocessed_incoming_connections == 0)
         {
-            ASSERT_DEBUG_SYNC(false,
-                              "Could not retrieve connection at index [%d]",
-                              n_connection);
-
-            goto end;
+            system_resizable_vector_push(dag_ptr->nodes_to_process,
+                                         node_ptr);
         }
     }
 
-    /* 3. Store all nodes in a vector that we'll be modifying as we go */
-    system_resizable_vector_empty(dag_ptr->nodes_to_process);
-    system_resizable_vector_empty(dag_ptr->sorted_nodes);
-
-    for (unsigned int n_node = 0;
-                      n_node < n_nodes;
-                    ++n_node)
+    /* 2. Emit nodes whose all dependencies have been emitted. nodes_to_process is used as a FIFO queue. */
+    while (system_resizable_vector_get_element_at(dag_ptr->nodes_to_process,
+                                                  n_sorted_nodes,
+                                                 &current_node_ptr) )
     {
-        system_dag_node node = nullptr;
+        uint32_t n_connections = 0;
 
-        if (system_resizable_vector_get_element_at(dag_ptr->nodes,
-                                                   n_node,
-                                                  &node) )
-        {
-            system_resizable_vector_push(dag_ptr->nodes_to_process,
-                                         node);
-        }
-        else
+        current_node_ptr->order = n_sorted_nodes++;
+
+        system_resizable_vector_push(dag_ptr->sorted_nodes,
+                                     current_node_ptr);
+
+        system_resizable_vector_get_property(current_node_ptr->outgoing_connections,
+                                             SYSTEM_RESIZABLE_VECTOR_PROPERTY_N_ELEMENTS,
+                                            &n_connections);
+
+        for (uint32_t n_connection = 0;
+                      n_connection < n_connections;
+                    ++n_connection)
         {
-            ASSERT_DEBUG_SYNC(false,
-                              "Could not retrieve node at index [%d]",
-                              n_node);
+            _system_dag_connection* connection_ptr = nullptr;
+            _system_dag_node*       dst_node_ptr   = nullptr;
 
-            goto end;
+            system_resizable_vector_get_element_at(current_node_ptr->outgoing_connections,
+                                                   n_connection,
+                                                  &connection_ptr);
+
+            dst_node_ptr = reinterpret_cast<_system_dag_node*>(connection_ptr->dst);
+
+            if (--dst_node_ptr->n_unprocessed_incoming_connections == 0)
+            {
+                system_resizable_vector_push(dag_ptr->nodes_to_process,
+                                             dst_node_ptr);
+            }
         }
     }
 
-    /* 4. Execute the actual algorithm */
-    result = true;
-
-    while (system_resizable_vector_pop(dag_ptr->nodes_to_process,
-                                      &current_node_ptr) )
+    /* 3. Nodes which have not been emitted are part of a cycle. */
+    if (n_sorted_nodes != n_nodes)
     {
-        if (current_node_ptr->status == STATUS_UNVISITED)
-        {
-            result = _system_dag_process_node(current_node_ptr,
-                                             &time,
-                                              dag_ptr->sorted_nodes);
-        }
+        ASSERT_DEBUG_SYNC(false,
+                          "system_dag operating on a graph that's not a DAG");
 
-        if (!result)
-        {
-            goto end;
-        }
+        goto end;
     }
 
     /* Done - mark the DAG as clean */
-    dag_ptr->dirty = false;
-    result         = true;
+    dag_ptr->dirty        = false;
+    dag_ptr->levels_dirty = true;
+    result                = true;
 
 end:
     return result;
@@ -12,7 +12,17 @@
     #define USE_RAW_HANDLES
 #endif
 
-#ifndef USE_RAW_HANDLES
+#if defined(USE_FUTEX_EVENTS)
+    #include "system/system_atomics.h"
+    #include "system/system_critical_section.h"
+    #include <errno.h>
+    #include <limits.h>
+    #include <linux/futex.h>
+    #include <pthread.h>
+    #include <sys/syscall.h>
+    #include <time.h>
+    #include <unistd.h>
+#elif !defined(USE_RAW_HANDLES)
     #include "system/system_event_monitor.h"
 #endif
 
@@ -20,6 +30,32 @@
     #include <string.h>
 #endif
 
+#if defined(USE_FUTEX_EVENTS)
+    /* Max number of events system_event_wait_multiple() can wait on without allocating waiter links
+     * from the heap. */
+    #define N_PREALLOCATED_WAITER_LINKS (MAXIMUM_WAIT_OBJECTS)
+
+    /* Thread events which are not signalled by the thread itself can only be polled. This is the
+     * interval at which waiting threads check if such threads have quit. */
+    #define THREAD_EVENT_POLL_INTERVAL_NSEC (1000000)
+
+    #define TIMEOUT_INFINITE_NSEC ((__uint64) -1)
+
+    /** Describes a thread blocked in system_event_wait_multiple(). The thread sleeps on wake_counter,
+     *  which is bumped by every set() call made against any of the events the waiter is waiting on. */
+    typedef struct
+    {
+        volatile unsigned int wake_counter;
+    } _system_event_waiter;
+
+    typedef struct _system_event_waiter_link
+    {
+        struct _system_event_waiter_link* next_ptr;
+        struct _system_event_waiter_link* prev_ptr;
+        _system_event_waiter*             waiter_ptr;
+    } _system_event_waiter_link;
+#endif
+
 
 typedef struct _system_event
 {
@@ -28,6 +64,23 @@ typedef struct _system_event
         HANDLE event;
     #endif
 
+    #if defined(USE_FUTEX_EVENTS)
+        /* Futex word. 1 if the event is signalled, 0 otherwise. */
+        volatile unsigned int state;
+
+        volatile unsigned int has_been_joined;         /* thread events only */
+        bool                  is_signalled_by_thread;  /* thread events only: true if the thread sets the event on its own when quitting */
+        volatile unsigned int ref_counter;
+
+        /* Threads blocked in system_event_wait_single() sleep directly on the state futex word.
+         * Threads blocked in system_event_wait_multiple() register a link in multi_waiters_ptr instead,
+         * since they need to be woken up by any of the events they are waiting on. */
+        system_critical_section    multi_waiters_cs;
+        _system_event_waiter_link* multi_waiters_ptr;  /* guarded by multi_waiters_cs */
+        volatile unsigned int      n_multi_waiters;
+        volatile unsigned int      n_single_waiters;
+    #endif
+
     bool              manual_reset;
     system_thread     owned_thread; /* only relevant for thread events */
     system_event_type type;
@@ -38,6 +91,17 @@ typedef struct _system_event
             event = NULL;
         #endif
 
+        #if defined(USE_FUTEX_EVENTS)
+            has_been_joined        = 0;
+            is_signalled_by_thread = false;
+            multi_waiters_cs       = system_critical_section_create();
+            multi_waiters_ptr      = NULL;
+            n_multi_waiters        = 0;
+            n_single_waiters       = 0;
+            ref_counter            = 1;
+            state                  = 0;
+        #endif
+
         manual_reset = false;
         type         = in_type;
 
@@ -47,9 +111,479 @@ typedef struct _system_event
         owned_thread = 0;
 #endif
     }
+
+    ~_system_event()
+    {
+        #if defined(USE_FUTEX_EVENTS)
+        {
+            ASSERT_DEBUG_SYNC(multi_waiters_ptr == NULL,
+                              "An event is being released while other threads are still waiting on it.");
+
+            system_critical_section_release(multi_waiters_cs);
+        }
+        #endif
+    }
 } _system_event;
 
 
+#if defined(USE_FUTEX_EVENTS)
+    /** Wrapper for the futex syscall, which glibc does not expose. */
+    PRIVATE int _system_event_futex(volatile unsigned int* address,
+                                    int                    op,
+                                    unsigned int           value,
+                                    const struct timespec* timeout_ptr)
+    {
+        return syscall(SYS_futex,
+                       (unsigned int*) address,
+                       op,
+                       value,
+                       timeout_ptr,
+                       NULL,  /* uaddr2 */
+                       0);    /* val3   */
+    }
+
+    /** Returns current CLOCK_MONOTONIC time in nanoseconds. */
+    PRIVATE __uint64 _system_event_get_monotonic_time_nsec()
+    {
+        struct timespec now;
+
+        clock_gettime(CLOCK_MONOTONIC,
+                     &now);
+
+        return __uint64(now.tv_sec) * 1000000000ull + __uint64(now.tv_nsec);
+    }
+
+    /** Converts a system_time timeout to an absolute CLOCK_MONOTONIC deadline.
+     *
+     *  @return The deadline in nanoseconds, or TIMEOUT_INFINITE_NSEC for SYSTEM_TIME_INFINITE timeouts.
+     */
+    PRIVATE __uint64 _system_event_get_deadline_nsec(system_time timeout)
+    {
+        uint32_t timeout_msec = 0;
+
+        if (timeout == SYSTEM_TIME_INFINITE)
+        {
+            return TIMEOUT_INFINITE_NSEC;
+        }
+
+        system_time_get_msec_for_time(timeout,
+                                     &timeout_msec);
+
+        return _system_event_get_monotonic_time_nsec() + __uint64(timeout_msec) * 1000000ull;
+    }
+
+    /** Tells whether the event is signalled, without consuming the signal. If the event is a thread event
+     *  whose thread does not signal the event on its own, the function checks if the thread has quit and,
+     *  if so, reaps the thread and signals the event.
+     */
+    PRIVATE bool _system_event_is_signalled(_system_event* event_ptr)
+    {
+        if (system_atomics_load_acquire(&event_ptr->state) != 0)
+        {
+            return true;
+        }
+
+        if (event_ptr->type                   == SYSTEM_EVENT_TYPE_THREAD &&
+           !event_ptr->is_signalled_by_thread                             &&
+            system_atomics_compare_exchange(&event_ptr->has_been_joined,
+                                             0,  /* expected_value */
+                                             1)) /* new_value      */
+        {
+            if (pthread_tryjoin_np(event_ptr->owned_thread,
+                                   NULL) == 0) /* __thread_return */
+            {
+                system_atomics_store_release(&event_ptr->state,
+                                              1);
+
+                return true;
+            }
+
+            system_atomics_store_release(&event_ptr->has_been_joined,
+                                          0);
+        }
+
+        return false;
+    }
+
+    /** Checks if the event is signalled. For auto-reset events, the signal is consumed.
+     *
+     *  @return true if the caller can consider the event acquired.
+     */
+    PRIVATE bool _system_event_try_acquire(_system_event* event_ptr)
+    {
+        if (event_ptr->manual_reset)
+        {
+            return _system_event_is_signalled(event_ptr);
+        }
+
+        return system_atomics_compare_exchange(&event_ptr->state,
+                                                1,  /* expected_value */
+                                                0); /* new_value      */
+    }
+
+    /** Drops a reference to the event. Releases the event if no references remain. */
+    PRIVATE void _system_event_release_reference(_system_event* event_ptr)
+    {
+        if (system_atomics_decrement(&event_ptr->ref_counter) == 0)
+        {
+            delete event_ptr;
+        }
+    }
+
+    /** Signals the event and wakes up all threads waiting on it.
+     *
+     *  Waking up all waiters, rather than just one, for auto-reset events is deliberate: a woken waiter
+     *  may time out before it gets to consume the signal, in which case it would never be passed on.
+     *  Waiters which lose the race for the signal go back to sleep.
+     */
+    PRIVATE void _system_event_signal(_system_event* event_ptr)
+    {
+        /* A woken waiter may release the event while we are still walking the waiter lists. Hold a
+         * reference until we are done. This must happen before the state is changed, since waiters
+         * cannot return before they see the signal. */
+        system_atomics_increment(&event_ptr->ref_counter);
+
+        if (!system_atomics_compare_exchange(&event_ptr->state,
+                                              0,  /* expected_value */
+                                              1)) /* new_value      */
+        {
+            /* Already signalled */
+            _system_event_release_reference(event_ptr);
+
+            return;
+        }
+
+        /* The exchange above acts as a full barrier. Waiters register themselves before they check the
+         * state, so a waiter which is not visible at this point is guaranteed to see the signal. */
+        if (system_atomics_load_acquire(&event_ptr->n_single_waiters) != 0)
+        {
+            _system_event_futex(&event_ptr->state,
+                                FUTEX_WAKE_PRIVATE,
+                                INT_MAX,
+                                NULL); /* timeout_ptr */
+        }
+
+        if (system_atomics_load_acquire(&event_ptr->n_multi_waiters) != 0)
+        {
+            system_critical_section_enter(event_ptr->multi_waiters_cs);
+            {
+                for (_system_event_waiter_link* link_ptr  = event_ptr->multi_waiters_ptr;
+                                                link_ptr != NULL;
+                                                link_ptr  = link_ptr->next_ptr)
+                {
+                    system_atomics_increment(&link_ptr->waiter_ptr->wake_counter);
+
+                    _system_event_futex(&link_ptr->waiter_ptr->wake_counter,
+                                        FUTEX_WAKE_PRIVATE,
+                                        1,     /* value       */
+                                        NULL); /* timeout_ptr */
+                }
+            }
+            system_critical_section_leave(event_ptr->multi_waiters_cs);
+        }
+
+        _system_event_release_reference(event_ptr);
+    }
+
+    /** Puts the caller to sleep, as long as *address equals expected_value and the deadline has not passed.
+     *  May return spuriously.
+     *
+     *  @param address         Futex word to sleep on.
+     *  @param expected_value  Value *address must hold for the thread to go to sleep.
+     *  @param deadline_nsec   Absolute CLOCK_MONOTONIC deadline, or TIMEOUT_INFINITE_NSEC.
+     *  @param should_poll     true to return after THREAD_EVENT_POLL_INTERVAL_NSEC at the latest.
+     *
+     *  @return false if the deadline has passed, true otherwise.
+     */
+    PRIVATE bool _system_event_sleep(volatile unsigned int* address,
+                                     unsigned int           expected_value,
+                                     __uint64               deadline_nsec,
+                                     bool                   should_poll)
+    {
+        struct timespec timeout;
+        struct timespec* timeout_ptr = NULL;
+
+        if (deadline_nsec != TIMEOUT_INFINITE_NSEC ||
+            should_poll)
+        {
+            const __uint64 now_nsec     = _system_event_get_monotonic_time_nsec();
+            __uint64       timeout_nsec;
+
+            if (deadline_nsec != TIMEOUT_INFINITE_NSEC &&
+                deadline_nsec <= now_nsec)
+            {
+                return false;
+            }
+
+            timeout_nsec = (deadline_nsec != TIMEOUT_INFINITE_NSEC) ? (deadline_nsec - now_nsec)
+                                                                    : THREAD_EVENT_POLL_INTERVAL_NSEC;
+
+            if (should_poll                                     &&
+                timeout_nsec > THREAD_EVENT_POLL_INTERVAL_NSEC)
+            {
+                timeout_nsec = THREAD_EVENT_POLL_INTERVAL_NSEC;
+            }
+
+            timeout.tv_sec  = time_t(timeout_nsec / 1000000000ull);
+            timeout.tv_nsec = long  (timeout_nsec % 1000000000ull);
+            timeout_ptr     = &timeout;
+        }
+
+        /* EAGAIN, EINTR and ETIMEDOUT are all handled by the caller re-checking the state */
+        _system_event_futex(address,
+                            FUTEX_WAIT_PRIVATE,
+                            expected_value,
+                            timeout_ptr);
+
+        return true;
+    }
+
+    /** Tells whether the event can only be polled. */
+    PRIVATE inline bool _system_event_requires_polling(const _system_event* event_ptr)
+    {
+        return (event_ptr->type == SYSTEM_EVENT_TYPE_THREAD &&
+               !event_ptr->is_signalled_by_thread);
+    }
+
+    /** Blocks until the event is acquired or the deadline passes.
+     *
+     *  @return true if the event has been acquired, false if the wait has timed out.
+     */
+    PRIVATE bool _system_event_wait_single(_system_event* event_ptr,
+                                           __uint64       deadline_nsec)
+    {
+        const bool should_poll = _system_event_requires_polling(event_ptr);
+        bool       result      = false;
+
+        /* Fast path: no need to register as a waiter if the event is already signalled */
+        if (_system_event_try_acquire(event_ptr) )
+        {
+            return true;
+        }
+
+        if (deadline_nsec == 0)
+        {
+            return false;
+        }
+
+        system_atomics_increment(&event_ptr->n_single_waiters);
+        {
+            while (true)
+            {
+                if (_system_event_try_acquire(event_ptr) )
+                {
+                    result = true;
+
+                    break;
+                }
+
+                if (!_system_event_sleep(&event_ptr->state,
+                                          0, /* expected_value */
+                                          deadline_nsec,
+                                          should_poll) )
+                {
+                    /* Timed out */
+                    break;
+                }
+            }
+        }
+        system_atomics_decrement(&event_ptr->n_single_waiters);
+
+        return result;
+    }
+
+    /** Tries to acquire all the events at once. For wait-all requests, either all or none of the auto-reset
+     *  events are consumed.
+     *
+     *  @return Index of the acquired event for wait-any requests, 0 for satisfied wait-all requests,
+     *          (size_t) -1 if the request could not be satisfied.
+     */
+    PRIVATE size_t _system_event_try_acquire_multiple(_system_event* const* events_ptr,
+                                                      int                   n_events,
+                                                      bool                  wait_on_all_objects)
+    {
+        if (!wait_on_all_objects)
+        {
+            for (int n_event = 0;
+                     n_event < n_events;
+                   ++n_event)
+            {
+                if (_system_event_try_acquire(events_ptr[n_event]) )
+                {
+                    return n_event;
+                }
+            }
+
+            return (size_t) -1;
+        }
+
+        for (int n_event = 0;
+                 n_event < n_events;
+               ++n_event)
+        {
+            if (!_system_event_is_signalled(events_ptr[n_event]) )
+            {
+                return (size_t) -1;
+            }
+        }
+
+        for (int n_event = 0;
+                 n_event < n_events;
+               ++n_event)
+        {
+            if (events_ptr[n_event]->manual_reset)
+            {
+                continue;
+            }
+
+            if (!system_atomics_compare_exchange(&events_ptr[n_event]->state,
+                                                  1,  /* expected_value */
+                                                  0)) /* new_value      */
+            {
+                /* Another thread has consumed the signal in the meantime. Hand back the signals we have
+                 * consumed so far, so that other waiters can make progress. */
+                for (int n_consumed_event = 0;
+                         n_consumed_event < n_event;
+                       ++n_consumed_event)
+                {
+                    if (!events_ptr[n_consumed_event]->manual_reset)
+                    {
+                        _system_event_signal(events_ptr[n_consumed_event]);
+                    }
+                }
+
+                return (size_t) -1;
+            }
+        }
+
+        return 0;
+    }
+
+    /** Blocks until the events are acquired, as described by wait_on_all_objects, or the deadline passes.
+     *
+     *  @return As per _system_event_try_acquire_multiple().
+     */
+    PRIVATE size_t _system_event_wait_multiple(_system_event* const* events_ptr,
+                                               int                   n_events,
+                                               bool                  wait_on_all_objects,
+                                               __uint64              deadline_nsec)
+    {
+        _system_event_waiter_link  preallocated_links[N_PREALLOCATED_WAITER_LINKS];
+        _system_event_waiter_link* links_ptr   = preallocated_links;
+        size_t                     result      = _system_event_try_acquire_multiple(events_ptr,
+                                                                                    n_events,
+                                                                                    wait_on_all_objects);
+        bool                       should_poll = false;
+        _system_event_waiter       waiter;
+
+        if (result        != (size_t) -1 ||
+            deadline_nsec == 0)
+        {
+            return result;
+        }
+
+        if (n_events > N_PREALLOCATED_WAITER_LINKS)
+        {
+            links_ptr = new (std::nothrow) _system_event_waiter_link[n_events];
+
+            ASSERT_ALWAYS_SYNC(links_ptr != NULL,
+                               "Out of memory");
+        }
+
+        /* Register the waiter with all the events */
+        waiter.wake_counter = 0;
+
+        for (int n_event = 0;
+                 n_event < n_events;
+               ++n_event)
+        {
+            _system_event*             event_ptr = events_ptr[n_event];
+            _system_event_waiter_link* link_ptr  = links_ptr + n_event;
+
+            link_ptr->prev_ptr   = NULL;
+            link_ptr->waiter_ptr = &waiter;
+
+            system_critical_section_enter(event_ptr->multi_waiters_cs);
+            {
+                link_ptr->next_ptr = event_ptr->multi_waiters_ptr;
+
+                if (event_ptr->multi_waiters_ptr != NULL)
+                {
+                    event_ptr->multi_waiters_ptr->prev_ptr = link_ptr;
+                }
+
+                event_ptr->multi_waiters_ptr = link_ptr;
+            }
+            system_critical_section_leave(event_ptr->multi_waiters_cs);
+
+            system_atomics_increment(&event_ptr->n_multi_waiters);
+
+            should_poll |= _system_event_requires_polling(event_ptr);
+        }
+
+        /* Sleep until the request can be satisfied */
+        while (true)
+        {
+            const unsigned int wake_counter = system_atomics_load_acquire(&waiter.wake_counter);
+
+            result = _system_event_try_acquire_multiple(events_ptr,
+                                                        n_events,
+                                                        wait_on_all_objects);
+
+            if (result != (size_t) -1)
+            {
+                break;
+            }
+
+            if (!_system_event_sleep(&waiter.wake_counter,
+                                      wake_counter,
+                                      deadline_nsec,
+                                      should_poll) )
+            {
+                /* Timed out */
+                break;
+            }
+        }
+
+        /* Unregister the waiter */
+        for (int n_event = 0;
+                 n_event < n_events;
+               ++n_event)
+        {
+            _system_event*             event_ptr = events_ptr[n_event];
+            _system_event_waiter_link* link_ptr  = links_ptr + n_event;
+
+            system_critical_section_enter(event_ptr->multi_waiters_cs);
+            {
+                if (link_ptr->prev_ptr != NULL)
+                {
+                    link_ptr->prev_ptr->next_ptr = link_ptr->next_ptr;
+                }
+                else
+                {
+                    event_ptr->multi_waiters_ptr = link_ptr->next_ptr;
+                }
+
+                if (link_ptr->next_ptr != NULL)
+                {
+                    link_ptr->next_ptr->prev_ptr = link_ptr->prev_ptr;
+                }
+            }
+            system_critical_section_leave(event_ptr->multi_waiters_cs);
+
+            system_atomics_decrement(&event_ptr->n_multi_waiters);
+        }
+
+        if (links_ptr != preallocated_links)
+        {
+            delete [] links_ptr;
+        }
+
+        return result;
+    }
+#endif
+
+
 /** Please see header for specification */
 PUBLIC EMERALD_API system_event system_event_create(bool manual_reset)
 {
@@ -70,6 +604,10 @@ PUBLIC EMERALD_API system_event system_event_create(bool manual_reset)
         ASSERT_ALWAYS_SYNC(event_ptr->event != NULL,
             "Could not create an event object.");
     }
+    #elif defined(USE_FUTEX_EVENTS)
+    {
+        /* Stub - futex-based events do not require any OS resources. */
+    }
     #else
     {
         system_event_monitor_add_event( (system_event) event_ptr);
@@ -119,6 +657,11 @@ PUBLIC EMERALD_API system_event system_event_create_from_thread(system_thread th
     {
         event_ptr->event = thread;
     }
+    #elif defined(USE_FUTEX_EVENTS)
+    {
+        /* Thread will be polled by the waiters */
+        event_ptr->owned_thread = thread;
+    }
     #else
     {
         event_ptr->owned_thread = thread;
@@ -130,6 +673,43 @@ PUBLIC EMERALD_API system_event system_event_create_from_thread(system_thread th
     return (system_event) event_ptr;
 }
 
+#ifdef USE_FUTEX_EVENTS
+    /** Please see header for specification */
+    PUBLIC system_event _system_event_create_for_spawned_thread()
+    {
+        _system_event* event_ptr = new (std::nothrow) _system_event(SYSTEM_EVENT_TYPE_THREAD);
+
+        ASSERT_ALWAYS_SYNC(event_ptr != NULL,
+                           "Out of memory");
+
+        /* One reference for the caller, one for the thread */
+        event_ptr->is_signalled_by_thread = true;
+        event_ptr->manual_reset           = true;
+        event_ptr->ref_counter            = 2;
+
+        return (system_event) event_ptr;
+    }
+
+    /** Please see header for specification */
+    PUBLIC void _system_event_set_spawned_thread(system_event  event,
+                                                 system_thread thread)
+    {
+        ((_system_event*) event)->owned_thread = thread;
+    }
+
+    /** Please see header for specification */
+    PUBLIC void _system_event_signal_thread_exit(system_event event)
+    {
+        _system_event* event_ptr = (_system_event*) event;
+
+        ASSERT_DEBUG_SYNC(event_ptr->is_signalled_by_thread,
+                          "_system_event_signal_thread_exit() called for an event which was not created for a spawned thread.");
+
+        _system_event_signal            (event_ptr);
+        _system_event_release_reference(event_ptr);
+    }
+#endif
+
 /** Please see header for specification */
 PUBLIC void system_event_get_property(system_event          event,
                                       system_event_property property,
@@ -220,6 +800,32 @@ PUBLIC EMERALD_API void system_event_release(system_event event)
             }
         } /* if (event != NULL) */
     }
+    #elif defined(USE_FUTEX_EVENTS)
+    {
+        _system_event* event_ptr = (_system_event*) event;
+
+        if (event_ptr == NULL)
+        {
+            return;
+        }
+
+        /* Reap the thread, if it has already quit. The thread signals its event as the very last thing
+         * it does, so the join is going to return almost immediately. */
+        if (event_ptr->type == SYSTEM_EVENT_TYPE_THREAD                    &&
+            event_ptr->is_signalled_by_thread                              &&
+            system_atomics_load_acquire(&event_ptr->state) != 0            &&
+            system_atomics_compare_exchange(&event_ptr->has_been_joined,
+                                             0,  /* expected_value */
+                                             1)) /* new_value      */
+        {
+            pthread_join(event_ptr->owned_thread,
+                         NULL); /* __thread_return */
+        }
+
+        _system_event_release_reference(event_ptr);
+
+        return;
+    }
     #else
     {
         system_event_monitor_delete_event(event);
@@ -236,7 +842,12 @@ PUBLIC EMERALD_API void system_event_reset(system_event event)
 
     if (event_ptr->type == SYSTEM_EVENT_TYPE_REGULAR)
     {
-        #if !defined(USE_RAW_HANDLES)
+        #if defined(USE_FUTEX_EVENTS)
+        {
+            system_atomics_store_release(&event_ptr->state,
+                                          0);
+        }
+        #elif !defined(USE_RAW_HANDLES)
         {
             system_event_monitor_reset_event(event);
         }
@@ -267,6 +878,10 @@ PUBLIC EMERALD_API void system_event_set(system_event event)
         {
             ::SetEvent( ((_system_event*) event)->event);
         }
+        #elif defined(USE_FUTEX_EVENTS)
+        {
+            _system_event_signal(event_ptr);
+        }
         #else
         {
             system_event_monitor_set_event(event);
@@ -283,7 +898,12 @@ PUBLIC EMERALD_API void system_event_set(system_event event)
 /** Please see header for specification */
 PUBLIC EMERALD_API bool system_event_wait_single_peek(system_event event)
 {
-    #if !defined(USE_RAW_HANDLES)
+    #if defined(USE_FUTEX_EVENTS)
+    {
+        return _system_event_wait_single( (_system_event*) event,
+                                          0); /* deadline_nsec */
+    }
+    #elif !defined(USE_RAW_HANDLES)
     {
         bool has_timed_out = false;
 
@@ -329,6 +949,11 @@ PUBLIC EMERALD_API void system_event_wait_single(system_event event,
         ASSERT_DEBUG_SYNC(result != WAIT_FAILED,
                           "WaitForSingleObject() failed.");
     }
+    #elif defined(USE_FUTEX_EVENTS)
+    {
+        _system_event_wait_single( (_system_event*) event,
+                                   _system_event_get_deadline_nsec(timeout) );
+    }
     #else
     {
         system_event_monitor_wait(&event,
@@ -469,6 +1094,35 @@ PUBLIC EMERALD_API size_t system_event_wait_multiple(const system_event* events,
 
         return result - WAIT_OBJECT_0;
     }
+    #elif defined(USE_FUTEX_EVENTS)
+    {
+        /* Unlike WaitForMultipleObjects(), futex-based waits are not limited in the number of events,
+         * so wait-all requests are always satisfied atomically. */
+        size_t wait_result;
+
+        if (n_elements == 0)
+        {
+            if (out_has_timed_out_ptr != NULL)
+            {
+                *out_has_timed_out_ptr = false;
+            }
+
+            return 0;
+        }
+
+        wait_result = _system_event_wait_multiple( (_system_event* const*) events,
+                                                   n_elements,
+                                                   wait_on_all_objects,
+                                                   (timeout == 0) ? 0 : _system_event_get_deadline_nsec(timeout) );
+
+        if (out_has_timed_out_ptr != NULL)
+        {
+            *out_has_timed_out_ptr = (wait_result == (size_t) -1);
+        }
+
+        return (wait_result == (size_t) -1) ? (unsigned int) -1
+                                            : wait_result;
+    }
     #else
     {
         bool has_timed_out = false;
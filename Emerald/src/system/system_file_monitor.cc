@@ -18,80 +18,129 @@
  * This is different from what we do under Linux, which is why some parts of this
  * module are heavily platform-specific.
  *
- * Under Linux, we leverage inotify. This kernel feature lets us add watches on
- * the file level, which is significantly easier to use.
+ * Under Linux, we leverage inotify. Watches are also added on the directory level,
+ * so that monitoring thousands of files located in a handful of directories does
+ * not exhaust the per-user watch limit. inotify tells us the name of the modified
+ * file, so no timestamps are needed. The monitor thread blocks on an epoll set, to
+ * which both the inotify descriptor and an eventfd used to wake the thread up are
+ * added.
+ *
+ * Editors and asset exporters tend to issue many writes in a row when saving a file.
+ * Under Linux, change notifications are therefore coalesced on a per-file basis: a
+ * call-back is only issued after no further notifications have been received for
+ * the file for the duration of its coalescing window. Call-backs which become due at
+ * the same time are dispatched in batches to the thread pool.
  */
 #include "shared.h"
+#include "system/system_constants.h"
 #include "system/system_critical_section.h"
 #include "system/system_event.h"
 #include "system/system_file_monitor.h"
+#include "system/system_hash64.h"
 #include "system/system_hash64map.h"
 #include "system/system_log.h"
 #include "system/system_resizable_vector.h"
+#include "system/system_thread_pool.h"
 #include "system/system_threads.h"
+#include "system/system_time.h"
 
 #ifdef __linux
+    #include <sys/epoll.h>
+    #include <sys/eventfd.h>
     #include <sys/inotify.h>
     #include <sys/types.h>
     #include <errno.h>
+    #include <limits.h>
     #include <stdio.h>
     #include <stdlib.h>
     #include <unistd.h>
 #endif
 
 
-#ifdef _WIN32
-    typedef struct _system_file_monitor_directory_callback
-    {
-        system_hashed_ansi_string directory;
-        system_hash64map          filename_to_callback_map;
-        system_event              wait_event;
+typedef struct _system_file_monitor_directory_callback
+{
+    system_hashed_ansi_string directory;
+    system_hash64map          filename_to_callback_map; /* maps file name hashes to _system_file_monitor_file_callback instances */
+
+    #ifdef __linux
+        int watch_index;
+
+        explicit _system_file_monitor_directory_callback(system_hashed_ansi_string in_directory,
+                                                         int                       in_watch_index);
+    #else
+        system_event wait_event;
 
         explicit _system_file_monitor_directory_callback(system_hashed_ansi_string in_directory,
                                                          system_event              in_wait_event);
-                ~_system_file_monitor_directory_callback();
-    } _system_file_monitor_directory_callback;
-#endif
+    #endif
+
+    ~_system_file_monitor_directory_callback();
+} _system_file_monitor_directory_callback;
 
 typedef struct _system_file_monitor_file_callback
 {
     PFNFILECHANGEDETECTEDPROC callback;
     void*                     callback_user_arg;
+    system_hashed_ansi_string directory;
+    system_hashed_ansi_string filename;
 
     #ifdef __linux
+        uint32_t                  coalescing_window_msec;
         system_hashed_ansi_string filename_with_path;
-        int                       watch_index;
+
+        /* Following fields are only accessed with file monitor's cs locked */
+        __uint64 dispatch_time_usec;         /* call-back is due at this time, if is_pending is true */
+        __uint64 first_notification_time_usec;
+        bool     is_pending;
 
         explicit _system_file_monitor_file_callback(PFNFILECHANGEDETECTEDPROC in_callback,
                                                     void*                     in_callback_user_arg,
-                                                    system_hashed_ansi_string in_filename_with_path);
+                                                    system_hashed_ansi_string in_directory,
+                                                    system_hashed_ansi_string in_filename,
+                                                    system_hashed_ansi_string in_filename_with_path,
+                                                    uint32_t                  in_coalescing_window_msec);
     #else /* __linux */
-        system_hashed_ansi_string directory;
-        system_hashed_ansi_string filename;
-        FILETIME                  last_write_time;
+        FILETIME last_write_time;
 
         explicit _system_file_monitor_file_callback(PFNFILECHANGEDETECTEDPROC in_callback,
                                                     void*                     in_callback_user_arg,
                                                     system_hashed_ansi_string in_directory,
                                                     system_hashed_ansi_string in_filename);
     #endif
-
-     ~_system_file_monitor_file_callback();
 } _system_file_monitor_file_callback;
 
+#ifdef __linux
+    /* Copy of a file call-back descriptor's fields, which are needed to execute the call-back */
+    typedef struct _system_file_monitor_dispatched_callback
+    {
+        PFNFILECHANGEDETECTEDPROC callback;
+        void*                     callback_user_arg;
+        system_hashed_ansi_string filename_with_path;
+    } _system_file_monitor_dispatched_callback;
+#endif
+
 typedef struct _system_file_monitor
 {
     system_critical_section cs;
+    system_hash64map        monitored_directory_name_hash_to_callback_map; /* maps directory name hashes to _system_file_monitor_directory_callback instances */
     system_thread           monitor_thread;
     system_event            monitor_thread_wait_event;
 
     #ifdef __linux
-        int              file_inotify;
-        fd_set           file_inotify_fdset;
-        system_hash64map monitored_file_name_hash_to_callback_map;      /* maps file name hashes to _system_file_monitor_file_callback instances */
-        system_hash64map monitored_watch_index_to_callback_map;         /* maps watch index values to _system_file_monitor_file_callback instances */
+        /* Reset under cs when the monitor thread takes a batch of due call-backs, set after they have been executed */
+        system_event                              dispatch_finished_event;
+
+        _system_file_monitor_dispatched_callback* dispatched_callbacks;          /* only accessed by the monitor thread */
+        uint32_t                                  dispatched_callbacks_capacity; /* only accessed by the monitor thread */
+        uint32_t                                  n_dispatched_callbacks;        /* only accessed by the monitor thread */
+        int                                       epoll_fd;
+        int                                       file_inotify;
+        volatile bool                             monitor_thread_should_die;
+        system_hash64map                          monitored_watch_index_to_callback_map; /* maps watch index values to _system_file_monitor_directory_callback instances */
+        system_resizable_vector                   pending_file_callbacks;                /* holds _system_file_monitor_file_callback instances with is_pending set */
+        system_resizable_vector                   pending_file_callbacks_temp;           /* only accessed by the monitor thread */
+        int                                       wakeup_event_fd;
     #else
-        system_hash64map monitored_directory_name_hash_to_callback_map; /* maps directory name hashes to _system_file_monitor_directory_callback instances */
         system_event     monitor_thread_please_die_event;
         system_event*    wait_table;
         unsigned int     wait_table_n_entries;
@@ -111,74 +160,109 @@ PRIVATE _system_file_monitor* file_monitor_ptr = NULL;
 
 
 /** Forward declarations */
-PRIVATE void _system_file_monitor_monitor_thread_entrypoint(void*                     unused);
-PRIVATE bool _system_file_monitor_register_file_callback   (system_hashed_ansi_string file_name_with_path,
-                                                            PFNFILECHANGEDETECTEDPROC pfn_file_changed_proc,
-                                                            void*                     file_changed_proc_user_arg);
+PRIVATE void _system_file_monitor_get_directory_and_file_for_file_name_with_path(system_hashed_ansi_string                file_name_with_path,
+                                                                                 system_hashed_ansi_string*               out_file_path_ptr,
+                                                                                 system_hashed_ansi_string*               out_file_name_ptr);
+PRIVATE void _system_file_monitor_monitor_thread_entrypoint                     (void*                                    unused);
+PRIVATE bool _system_file_monitor_register_file_callback                        (system_hashed_ansi_string                file_name_with_path,
+                                                                                 PFNFILECHANGEDETECTEDPROC                pfn_file_changed_proc,
+                                                                                 void*                                    file_changed_proc_user_arg,
+                                                                                 uint32_t                                 coalescing_window_msec);
+PRIVATE void _system_file_monitor_unregister_file_callback                      (_system_file_monitor_directory_callback* directory_callback_ptr,
+                                                                                 _system_file_monitor_file_callback*      file_callback_ptr);
 
 #ifdef _WIN32
-    PRIVATE void _system_file_monitor_get_directory_and_file_for_file_name_with_path(system_hashed_ansi_string                file_name_with_path,
-                                                                                     system_hashed_ansi_string*               out_file_path_ptr,
-                                                                                     system_hashed_ansi_string*               out_file_name_ptr);
-    PRIVATE bool _system_file_monitor_get_last_write_time                           (system_hashed_ansi_string                file_name_with_path,
-                                                                                     FILETIME*                                out_result_ptr);
-    PRIVATE void _system_file_monitor_unregister_file_callback                      (_system_file_monitor_directory_callback* directory_callback_ptr,
-                                                                                     _system_file_monitor_file_callback*      file_callback_ptr);
-
-#else /* _WIN32 */
-    PRIVATE void _system_file_monitor_unregister_file_callback(_system_file_monitor_file_callback* file_callback_ptr);
+    PRIVATE bool _system_file_monitor_get_last_write_time(system_hashed_ansi_string file_name_with_path,
+                                                          FILETIME*                 out_result_ptr);
+#else
+    PRIVATE void _system_file_monitor_dispatch_callbacks        (uint32_t                            range_start,
+                                                                 uint32_t                            range_end,
+                                                                 void*                               unused);
+    PRIVATE int  _system_file_monitor_dispatch_due_callbacks    ();
+    PRIVATE void _system_file_monitor_mark_file_callback_pending(_system_file_monitor_file_callback* file_callback_ptr,
+                                                                 __uint64                            time_now_usec);
+    PRIVATE void _system_file_monitor_process_inotify_events    ();
 #endif
 
 
-#ifdef _WIN32
+#ifdef __linux
+    /** TODO */
+    _system_file_monitor_directory_callback::_system_file_monitor_directory_callback(system_hashed_ansi_string in_directory,
+                                                                                     int                       in_watch_index)
+#else
     /** TODO */
     _system_file_monitor_directory_callback::_system_file_monitor_directory_callback(system_hashed_ansi_string in_directory,
                                                                                      system_event              in_wait_event)
-    {
-        ASSERT_DEBUG_SYNC(in_directory != NULL,
-                          "Directory is NULL");
+#endif
+{
+    ASSERT_DEBUG_SYNC(in_directory != NULL,
+                      "Directory is NULL");
+
+    directory                = in_directory;
+    filename_to_callback_map = system_hash64map_create(sizeof(_system_file_monitor_file_callback*) );
 
-        directory                = in_directory;
-        filename_to_callback_map = system_hash64map_create(sizeof(_system_file_monitor_file_callback*) );
-        wait_event               = in_wait_event;
+    #ifdef __linux
+    {
+        watch_index = in_watch_index;
+    }
+    #else
+    {
+        wait_event = in_wait_event;
     }
+    #endif
+}
 
-    /** TODO */
-    _system_file_monitor_directory_callback::~_system_file_monitor_directory_callback()
+/** TODO */
+_system_file_monitor_directory_callback::~_system_file_monitor_directory_callback()
+{
+    if (filename_to_callback_map != NULL)
     {
-        if (filename_to_callback_map != NULL)
-        {
-            unsigned int n_filenames = 0;
+        unsigned int n_filenames = 0;
+
+        system_hash64map_get_property(filename_to_callback_map,
+                                      SYSTEM_HASH64MAP_PROPERTY_N_ELEMENTS,
+                                     &n_filenames);
 
-            system_hash64map_get_property(filename_to_callback_map,
-                                          SYSTEM_HASH64MAP_PROPERTY_N_ELEMENTS,
-                                         &n_filenames);
+        for (unsigned int n_filename = 0;
+                          n_filename < n_filenames;
+                        ++n_filename)
+        {
+            _system_file_monitor_file_callback* callback_ptr = NULL;
 
-            for (unsigned int n_filename = 0;
-                              n_filename < n_filenames;
-                            ++n_filename)
+            if (!system_hash64map_get_element_at(filename_to_callback_map,
+                                                 n_filename,
+                                                &callback_ptr,
+                                                 NULL) ) /* result_hash */
             {
-                _system_file_monitor_file_callback* callback_ptr = NULL;
+                ASSERT_DEBUG_SYNC(false,
+                                  "Could not retrieve file call-back descriptor");
 
-                if (!system_hash64map_get_element_at(filename_to_callback_map,
-                                                     n_filename,
-                                                    &callback_ptr,
-                                                     NULL) ) /* result_hash */
-                {
-                    ASSERT_DEBUG_SYNC(false,
-                                      "Could not retrieve file call-back descriptor");
+                continue;
+            }
 
-                    continue;
-                }
+            delete callback_ptr;
+            callback_ptr = NULL;
+        } /* for (all stores key/value pairs) */
 
-                delete callback_ptr;
-                callback_ptr = NULL;
-            } /* for (all stores key/value pairs) */
+        system_hash64map_release(filename_to_callback_map);
+        filename_to_callback_map = NULL;
+    } /* if (filename_to_callback_map != NULL) */
 
-            system_hash64map_release(filename_to_callback_map);
-            filename_to_callback_map = NULL;
-        } /* if (filename_to_callback_map != NULL) */
+    #ifdef __linux
+    {
+        if (watch_index >= 0)
+        {
+            int result = inotify_rm_watch(file_monitor_ptr->file_inotify,
+                                          watch_index);
 
+            ASSERT_DEBUG_SYNC(result == 0,
+                              "inotify_rm_watch() call failed.");
+
+            watch_index = -1;
+        }
+    }
+    #else
+    {
         if (wait_event != NULL)
         {
             /* NOTE: The call below will close the "change notificatin handle" via the FindCloseChangeNotification() API */
@@ -187,7 +271,8 @@ PRIVATE bool _system_file_monitor_register_file_callback   (system_hashed_ansi_s
             wait_event = NULL;
         } /* if (wait_event != NULL) */
     }
-#endif /* _WIN32 */
+    #endif
+}
 
 #ifdef _WIN32
     /** TODO */
@@ -199,54 +284,34 @@ PRIVATE bool _system_file_monitor_register_file_callback   (system_hashed_ansi_s
     /** TODO */
     _system_file_monitor_file_callback::_system_file_monitor_file_callback(PFNFILECHANGEDETECTEDPROC in_callback,
                                                                            void*                     in_callback_user_arg,
-                                                                           system_hashed_ansi_string in_filename_with_path)
+                                                                           system_hashed_ansi_string in_directory,
+                                                                           system_hashed_ansi_string in_filename,
+                                                                           system_hashed_ansi_string in_filename_with_path,
+                                                                           uint32_t                  in_coalescing_window_msec)
 #endif
 {
     ASSERT_DEBUG_SYNC(in_callback != NULL,
                       "Call-back function pointer is NULL");
-
-    #ifdef _WIN32
-    {
-        ASSERT_DEBUG_SYNC(in_directory != NULL,
-                          "Directory is NULL");
-        ASSERT_DEBUG_SYNC(in_filename != NULL,
-                          "Filename is NULL");
-    }
-    #else
-    {
-        ASSERT_DEBUG_SYNC(in_filename_with_path != NULL,
-                          "Filename is NULL");
-    }
-    #endif
+    ASSERT_DEBUG_SYNC(in_directory != NULL,
+                      "Directory is NULL");
+    ASSERT_DEBUG_SYNC(in_filename != NULL,
+                      "Filename is NULL");
 
     callback          = in_callback;
     callback_user_arg = in_callback_user_arg;
+    directory         = in_directory;
+    filename          = in_filename;
 
-    #ifdef _WIN32
-    {
-        directory = in_directory;
-        filename  = in_filename;
-    }
-    #else /* _WIN32 */
-    {
-        filename_with_path = in_filename_with_path;
-        watch_index        = -1;
-    }
-    #endif
-}
-
-/** TODO */
-_system_file_monitor_file_callback::~_system_file_monitor_file_callback()
-{
     #ifdef __linux
     {
-        int result = inotify_rm_watch(file_monitor_ptr->file_inotify,
-                                      watch_index);
-
-        ASSERT_DEBUG_SYNC(result == 0,
-                          "inotify_rm_watch() call failed.");
+        ASSERT_DEBUG_SYNC(in_filename_with_path != NULL,
+                          "Filename with path is NULL");
 
-        watch_index = -1;
+        coalescing_window_msec       = in_coalescing_window_msec;
+        dispatch_time_usec           = 0;
+        filename_with_path           = in_filename_with_path;
+        first_notification_time_usec = 0;
+        is_pending                   = false;
     }
     #endif
 }
@@ -254,31 +319,65 @@ _system_file_monitor_file_callback::~_system_file_monitor_file_callback()
 /** TODO */
 _system_file_monitor::_system_file_monitor()
 {
-    cs                        = system_critical_section_create();
-    monitor_thread            = (system_thread) 0;
-    monitor_thread_wait_event = NULL;
+    cs                                            = system_critical_section_create();
+    monitored_directory_name_hash_to_callback_map = system_hash64map_create(sizeof(_system_file_monitor_directory_callback*) );
+    monitor_thread                                = (system_thread) 0;
+    monitor_thread_wait_event                     = NULL;
 
     #ifdef __linux
     {
-        file_inotify                             = inotify_init();
-        monitored_file_name_hash_to_callback_map = system_hash64map_create(sizeof(_system_file_monitor_file_callback*) );
-        monitored_watch_index_to_callback_map    = system_hash64map_create(sizeof(_system_file_monitor_file_callback*) );
+        epoll_event epoll_events[2];
+
+        dispatch_finished_event               = system_event_create           (true); /* manual_reset */
+        dispatched_callbacks                  = NULL;
+        dispatched_callbacks_capacity         = 0;
+        n_dispatched_callbacks                = 0;
+        epoll_fd                              = epoll_create1                 (EPOLL_CLOEXEC);
+        file_inotify                          = inotify_init1                 (IN_NONBLOCK | IN_CLOEXEC);
+        monitor_thread_should_die             = false;
+        monitored_watch_index_to_callback_map = system_hash64map_create       (sizeof(_system_file_monitor_directory_callback*) );
+        pending_file_callbacks                = system_resizable_vector_create(64); /* capacity */
+        pending_file_callbacks_temp           = system_resizable_vector_create(64); /* capacity */
+        wakeup_event_fd                       = eventfd                       (0, /* initval */
+                                                                               EFD_NONBLOCK | EFD_CLOEXEC);
 
         ASSERT_ALWAYS_SYNC(file_inotify >= 0,
                            "Could not initialize inotify file descriptor. Does your kernel provide inotify support?");
+        ASSERT_ALWAYS_SYNC(epoll_fd        >= 0 &&
+                           wakeup_event_fd >= 0,
+                           "Could not initialize epoll / eventfd file descriptors.");
+
+        /* No call-backs are being executed at this point */
+        system_event_set(dispatch_finished_event);
+
+        /* The monitor thread blocks on an epoll set, which wakes it up whenever inotify has new events for us,
+         * or when another thread needs the monitor thread's attention. */
+        epoll_events[0].data.fd = file_inotify;
+        epoll_events[0].events  = EPOLLIN;
+        epoll_events[1].data.fd = wakeup_event_fd;
+        epoll_events[1].events  = EPOLLIN;
+
+        for (uint32_t n_epoll_event = 0;
+                      n_epoll_event < sizeof(epoll_events) / sizeof(epoll_events[0]);
+                    ++n_epoll_event)
+        {
+            int result = epoll_ctl(epoll_fd,
+                                   EPOLL_CTL_ADD,
+                                   epoll_events[n_epoll_event].data.fd,
+                                  &epoll_events[n_epoll_event]);
 
-        FD_ZERO(&file_inotify_fdset);
-        FD_SET ( file_inotify, &file_inotify_fdset);
+            ASSERT_ALWAYS_SYNC(result == 0,
+                               "Could not add a file descriptor to the file monitor's epoll set.");
+        }
     }
     #endif /* __linux */
 
     #ifdef _WIN32
     {
-        monitored_directory_name_hash_to_callback_map = system_hash64map_create(sizeof(_system_file_monitor_directory_callback*) );
-        monitor_thread_please_die_event               = system_event_create    (true); /* manual_reset */
-        wait_table_needs_an_update_ack_event          = system_event_create    (true); /* manual_reset */
-        wait_table_needs_an_update_event              = system_event_create    (true); /* manual_reset */
-        wait_table_updated_event                      = system_event_create    (true); /* manual_reset */
+        monitor_thread_please_die_event      = system_event_create(true); /* manual_reset */
+        wait_table_needs_an_update_ack_event = system_event_create(true); /* manual_reset */
+        wait_table_needs_an_update_event     = system_event_create(true); /* manual_reset */
+        wait_table_updated_event             = system_event_create(true); /* manual_reset */
 
         /* By default, the wait table should only consist of the "please die" and "wait table needs an update" event. */
         wait_table = new (std::nothrow) system_event[2];
@@ -300,7 +399,13 @@ _system_file_monitor::~_system_file_monitor()
     /* Inform the monitor thread we no longer need it */
     #ifdef __linux
     {
-        close(file_monitor_ptr->file_inotify);
+        const uint64_t wakeup_value = 1;
+
+        monitor_thread_should_die = true;
+
+        write(wakeup_event_fd,
+             &wakeup_value,
+              sizeof(wakeup_value) );
     }
     #else /* __linux */
     {
@@ -322,40 +427,60 @@ _system_file_monitor::~_system_file_monitor()
         monitor_thread_wait_event = NULL;
     } /* if (monitor_thread_wait_event != NULL) */
 
-    #ifdef __linux
+    /* Release directory descriptors. Under Linux, this needs to happen before the inotify file descriptor is closed. */
+    if (monitored_directory_name_hash_to_callback_map != NULL)
     {
-        if (monitored_file_name_hash_to_callback_map != NULL)
-        {
-            unsigned int n_monitored_file_names = 0;
+        unsigned int n_monitored_directory_names = 0;
 
-            system_hash64map_get_property(monitored_file_name_hash_to_callback_map,
-                                          SYSTEM_HASH64MAP_PROPERTY_N_ELEMENTS,
-                                         &n_monitored_file_names);
+        system_hash64map_get_property(monitored_directory_name_hash_to_callback_map,
+                                      SYSTEM_HASH64MAP_PROPERTY_N_ELEMENTS,
+                                     &n_monitored_directory_names);
+
+        for (unsigned int n_monitored_directory_name = 0;
+                          n_monitored_directory_name < n_monitored_directory_names;
+                        ++n_monitored_directory_name)
+        {
+            _system_file_monitor_directory_callback* callback_ptr = NULL;
 
-            for (unsigned int n_monitored_file_name = 0;
-                              n_monitored_file_name < n_monitored_file_names;
-                            ++n_monitored_file_name)
+            if (!system_hash64map_get_element_at(monitored_directory_name_hash_to_callback_map,
+                                                 n_monitored_directory_name,
+                                                &callback_ptr,
+                                                 NULL) ) /* result_hash */
             {
-                _system_file_monitor_file_callback* callback_ptr = NULL;
+                ASSERT_DEBUG_SYNC(false,
+                                  "Could not retrieve hash-map item at index [%d]",
+                                  n_monitored_directory_name);
 
-                if (!system_hash64map_get_element_at(monitored_file_name_hash_to_callback_map,
-                                                     n_monitored_file_name,
-                                                    &callback_ptr,
-                                                     NULL) ) /* result_hash */
-                {
-                    ASSERT_DEBUG_SYNC(false,
-                                      "Could not retrieve hash-map item at index [%sd]",
-                                      n_monitored_file_name);
+                continue;
+            }
 
-                    continue;
-                }
+            delete callback_ptr;
+            callback_ptr = NULL;
+        } /* for (all monitored directory names) */
+
+        system_hash64map_release(monitored_directory_name_hash_to_callback_map);
+        monitored_directory_name_hash_to_callback_map = NULL;
+    } /* if (monitored_directory_name_hash_to_callback_map != NULL) */
 
-                delete callback_ptr;
-                callback_ptr = NULL;
-            } /* for (all monitored file names) */
+    #ifdef __linux
+    {
+        system_resizable_vector* vectors_to_release[] =
+        {
+            &pending_file_callbacks,
+            &pending_file_callbacks_temp
+        };
+        const uint32_t n_vectors_to_release = sizeof(vectors_to_release) / sizeof(vectors_to_release[0]);
+
+        for (uint32_t n_vector = 0;
+                      n_vector < n_vectors_to_release;
+                    ++n_vector)
+        {
+            if (*vectors_to_release[n_vector] != NULL)
+            {
+                system_resizable_vector_release(*vectors_to_release[n_vector]);
 
-            system_hash64map_release(monitored_file_name_hash_to_callback_map);
-            monitored_file_name_hash_to_callback_map = NULL;
+                *vectors_to_release[n_vector] = NULL;
+            }
         }
 
         if (monitored_watch_index_to_callback_map != NULL)
@@ -364,43 +489,27 @@ _system_file_monitor::~_system_file_monitor()
 
             monitored_watch_index_to_callback_map = NULL;
         }
-    }
-    #else /* __linux */
-    {
-        if (monitored_directory_name_hash_to_callback_map != NULL)
-        {
-            unsigned int n_monitored_directory_names = 0;
-
-            system_hash64map_get_property(monitored_directory_name_hash_to_callback_map,
-                                          SYSTEM_HASH64MAP_PROPERTY_N_ELEMENTS,
-                                         &n_monitored_directory_names);
-
-            for (unsigned int n_monitored_directory_name = 0;
-                              n_monitored_directory_name < n_monitored_directory_names;
-                            ++n_monitored_directory_name)
-            {
-                _system_file_monitor_directory_callback* callback_ptr = NULL;
 
-                if (!system_hash64map_get_element_at(monitored_directory_name_hash_to_callback_map,
-                                                     n_monitored_directory_name,
-                                                    &callback_ptr,
-                                                     NULL) ) /* result_hash */
-                {
-                    ASSERT_DEBUG_SYNC(false,
-                                      "Could not retrieve hash-map item at index [%d]",
-                                      n_monitored_directory_name);
+        if (dispatched_callbacks != NULL)
+        {
+            delete [] dispatched_callbacks;
 
-                    continue;
-                }
+            dispatched_callbacks = NULL;
+        }
 
-                delete callback_ptr;
-                callback_ptr = NULL;
-            } /* for (all monitored directory names) */
+        if (dispatch_finished_event != NULL)
+        {
+            system_event_release(dispatch_finished_event);
 
-            system_hash64map_release(monitored_directory_name_hash_to_callback_map);
-            monitored_directory_name_hash_to_callback_map = NULL;
-        } /* if (monitored_directory_name_hash_to_callback_map != NULL) */
+            dispatch_finished_event = NULL;
+        }
 
+        close(epoll_fd);
+        close(file_inotify);
+        close(wakeup_event_fd);
+    }
+    #else /* __linux */
+    {
         if (monitor_thread_please_die_event != NULL)
         {
             system_event_release(monitor_thread_please_die_event);
@@ -526,14 +635,319 @@ _system_file_monitor::~_system_file_monitor()
 
         return result;
     }
+#else
+    /** Thread pool call-back, which executes call-backs stored in the <range_start, range_end) range
+     *  of the dispatched_callbacks array.
+     */
+    PRIVATE void _system_file_monitor_dispatch_callbacks(uint32_t range_start,
+                                                         uint32_t range_end,
+                                                         void*    unused)
+    {
+        const _system_file_monitor_dispatched_callback* dispatched_callbacks = file_monitor_ptr->dispatched_callbacks;
+
+        for (uint32_t n_dispatched_callback = range_start;
+                      n_dispatched_callback < range_end;
+                    ++n_dispatched_callback)
+        {
+            dispatched_callbacks[n_dispatched_callback].callback(dispatched_callbacks[n_dispatched_callback].filename_with_path,
+                                                                 dispatched_callbacks[n_dispatched_callback].callback_user_arg);
+        }
+    }
+
+    /** Executes call-backs for all files, whose coalescing windows have expired. The call-backs are
+     *  distributed among thread pool workers. The function returns after all of them have finished executing.
+     *
+     *  @return Time left till the next pending call-back is due, in miliseconds, or -1 if there are
+     *          no pending call-backs.
+     */
+    PRIVATE int _system_file_monitor_dispatch_due_callbacks()
+    {
+        uint32_t       n_pending_file_callbacks = 0;
+        int            result                   = -1;
+        const __uint64 time_now_usec            = system_time_now_usec();
+
+        system_critical_section_enter(file_monitor_ptr->cs);
+        {
+            system_resizable_vector temp_vector = NULL;
+
+            file_monitor_ptr->n_dispatched_callbacks = 0;
+
+            system_resizable_vector_empty(file_monitor_ptr->pending_file_callbacks_temp);
+
+            system_resizable_vector_get_property(file_monitor_ptr->pending_file_callbacks,
+                                                 SYSTEM_RESIZABLE_VECTOR_PROPERTY_N_ELEMENTS,
+                                                &n_pending_file_callbacks);
+
+            /* Make sure all call-backs would fit if they were due */
+            if (file_monitor_ptr->dispatched_callbacks_capacity < n_pending_file_callbacks)
+            {
+                if (file_monitor_ptr->dispatched_callbacks != NULL)
+                {
+                    delete [] file_monitor_ptr->dispatched_callbacks;
+                }
+
+                file_monitor_ptr->dispatched_callbacks          = new (std::nothrow) _system_file_monitor_dispatched_callback[n_pending_file_callbacks];
+                file_monitor_ptr->dispatched_callbacks_capacity = n_pending_file_callbacks;
+
+                ASSERT_ALWAYS_SYNC(file_monitor_ptr->dispatched_callbacks != NULL,
+                                   "Out of memory");
+            }
+
+            for (uint32_t n_pending_file_callback = 0;
+                          n_pending_file_callback < n_pending_file_callbacks;
+                        ++n_pending_file_callback)
+            {
+                _system_file_monitor_file_callback* file_callback_ptr = NULL;
+
+                system_resizable_vector_get_element_at(file_monitor_ptr->pending_file_callbacks,
+                                                       n_pending_file_callback,
+                                                      &file_callback_ptr);
+
+                if (file_callback_ptr->dispatch_time_usec <= time_now_usec)
+                {
+                    _system_file_monitor_dispatched_callback& dispatched_callback = file_monitor_ptr->dispatched_callbacks[file_monitor_ptr->n_dispatched_callbacks++];
+
+                    dispatched_callback.callback           = file_callback_ptr->callback;
+                    dispatched_callback.callback_user_arg  = file_callback_ptr->callback_user_arg;
+                    dispatched_callback.filename_with_path = file_callback_ptr->filename_with_path;
+
+                    file_callback_ptr->is_pending = false;
+                }
+                else
+                {
+                    const int time_left_msec = (int) ((file_callback_ptr->dispatch_time_usec - time_now_usec + 999) / 1000);
+
+                    if (result == -1 || result > time_left_msec)
+                    {
+                        result = time_left_msec;
+                    }
+
+                    system_resizable_vector_push(file_monitor_ptr->pending_file_callbacks_temp,
+                                                 file_callback_ptr);
+                }
+            }
+
+            /* Descriptors which are not due yet stay pending */
+            temp_vector                                   = file_monitor_ptr->pending_file_callbacks;
+            file_monitor_ptr->pending_file_callbacks      = file_monitor_ptr->pending_file_callbacks_temp;
+            file_monitor_ptr->pending_file_callbacks_temp = temp_vector;
+
+            /* Threads which unregister a call-back from now on need to wait until the batch has been executed */
+            if (file_monitor_ptr->n_dispatched_callbacks > 0)
+            {
+                system_event_reset(file_monitor_ptr->dispatch_finished_event);
+            }
+        }
+        system_critical_section_leave(file_monitor_ptr->cs);
+
+        /* Execute the call-backs. No lock is held at this point, so new notifications can be received and
+         * call-backs can be registered in the meantime. The call-backs work on copies of the descriptors'
+         * fields, so the descriptors can be released while the batch is being executed. */
+        if (file_monitor_ptr->n_dispatched_callbacks > 0)
+        {
+            system_thread_pool_parallel_for(0, /* range_start */
+                                            file_monitor_ptr->n_dispatched_callbacks,
+                                            FILE_MONITOR_N_CALLBACKS_PER_TASK,
+                                            _system_file_monitor_dispatch_callbacks,
+                                            NULL); /* user_arg */
+
+            system_event_set(file_monitor_ptr->dispatch_finished_event);
+        }
+
+        return result;
+    }
+
+    /** Splits @param file_name_with_path into a canonical directory path and a file name.
+     *
+     *  Directories are canonicalized, since inotify only supports one watch per directory,
+     *  regardless of the path used to refer to it.
+     */
+    PRIVATE void _system_file_monitor_get_directory_and_file_for_file_name_with_path(system_hashed_ansi_string  file_name_with_path,
+                                                                                     system_hashed_ansi_string* out_file_path_ptr,
+                                                                                     system_hashed_ansi_string* out_file_name_ptr)
+    {
+        const char* file_name_with_path_raw = system_hashed_ansi_string_get_buffer(file_name_with_path);
+        const char* last_separator_ptr      = strrchr(file_name_with_path_raw,
+                                                      '/');
+        char        directory_buffer[PATH_MAX];
+        char        resolved_directory_buffer[PATH_MAX];
+        uint32_t    directory_length        = 0;
+
+        if (last_separator_ptr == NULL)
+        {
+            strcpy(directory_buffer,
+                   ".");
+
+            *out_file_name_ptr = file_name_with_path;
+        }
+        else
+        {
+            /* Make sure files located in the root directory are handled correctly */
+            directory_length = (last_separator_ptr != file_name_with_path_raw) ? (uint32_t) (last_separator_ptr - file_name_with_path_raw)
+                                                                               : 1;
+
+            ASSERT_DEBUG_SYNC(directory_length < sizeof(directory_buffer),
+                              "Directory path is too long");
+
+            memcpy(directory_buffer,
+                   file_name_with_path_raw,
+                   directory_length);
+
+            directory_buffer[directory_length] = 0;
+            *out_file_name_ptr                 = system_hashed_ansi_string_create(last_separator_ptr + 1);
+        }
+
+        if (realpath(directory_buffer,
+                     resolved_directory_buffer) != NULL)
+        {
+            *out_file_path_ptr = system_hashed_ansi_string_create(resolved_directory_buffer);
+        }
+        else
+        {
+            /* The directory does not exist. Adding an inotify watch is going to fail anyway. */
+            *out_file_path_ptr = system_hashed_ansi_string_create(directory_buffer);
+        }
+    }
+
+    /** Schedules a call-back for the specified file. If one is already pending, the file's coalescing window
+     *  is restarted, unless the call-back has already been postponed by FILE_MONITOR_MAX_COALESCING_DELAY_MSEC.
+     *
+     *  Must be called with file monitor's cs locked.
+     */
+    PRIVATE void _system_file_monitor_mark_file_callback_pending(_system_file_monitor_file_callback* file_callback_ptr,
+                                                                 __uint64                            time_now_usec)
+    {
+        __uint64       latest_dispatch_time_usec = 0;
+        const uint32_t max_delay_msec            = (file_callback_ptr->coalescing_window_msec > FILE_MONITOR_MAX_COALESCING_DELAY_MSEC) ? file_callback_ptr->coalescing_window_msec
+                                                                                                                                       : FILE_MONITOR_MAX_COALESCING_DELAY_MSEC;
+
+        if (!file_callback_ptr->is_pending)
+        {
+            file_callback_ptr->first_notification_time_usec = time_now_usec;
+            file_callback_ptr->is_pending                   = true;
+
+            system_resizable_vector_push(file_monitor_ptr->pending_file_callbacks,
+                                         file_callback_ptr);
+        }
+
+        latest_dispatch_time_usec             = file_callback_ptr->first_notification_time_usec + __uint64(max_delay_msec)                            * 1000;
+        file_callback_ptr->dispatch_time_usec = time_now_usec                                   + __uint64(file_callback_ptr->coalescing_window_msec) * 1000;
+
+        if (file_callback_ptr->dispatch_time_usec > latest_dispatch_time_usec)
+        {
+            file_callback_ptr->dispatch_time_usec = latest_dispatch_time_usec;
+        }
+    }
+
+    /** Reads all events available for reading from the inotify file descriptor, and schedules call-backs
+     *  for modified files we have been asked to monitor.
+     */
+    PRIVATE void _system_file_monitor_process_inotify_events()
+    {
+        char event_buffer[16384] __attribute__ ((aligned(__alignof__(inotify_event) )));
+
+        while (true)
+        {
+            const ssize_t  n_bytes_available = read(file_monitor_ptr->file_inotify,
+                                                    event_buffer,
+                                                    sizeof(event_buffer) );
+            const __uint64 time_now_usec     = system_time_now_usec();
+
+            if (n_bytes_available <= 0)
+            {
+                /* No more events to process (EAGAIN) */
+                break;
+            }
+
+            system_critical_section_enter(file_monitor_ptr->cs);
+            {
+                for (const char* current_event_raw_ptr  = event_buffer;
+                                 current_event_raw_ptr  < event_buffer + n_bytes_available;
+                                 current_event_raw_ptr += sizeof(inotify_event) + ((const inotify_event*) current_event_raw_ptr)->len)
+                {
+                    const inotify_event* current_event_ptr = (const inotify_event*) current_event_raw_ptr;
+
+                    if ((current_event_ptr->mask & IN_Q_OVERFLOW) != 0)
+                    {
+                        /* Some of the events have been dropped by the kernel. Since we cannot tell which files they
+                         * referred to, issue call-backs for all monitored files. */
+                        uint32_t n_directories = 0;
+
+                        LOG_ERROR("inotify event queue overflow detected. Reporting all monitored files as modified.");
+
+                        system_hash64map_get_property(file_monitor_ptr->monitored_directory_name_hash_to_callback_map,
+                                                      SYSTEM_HASH64MAP_PROPERTY_N_ELEMENTS,
+                                                     &n_directories);
+
+                        for (uint32_t n_directory = 0;
+                                      n_directory < n_directories;
+                                    ++n_directory)
+                        {
+                            _system_file_monitor_directory_callback* directory_callback_ptr = NULL;
+                            uint32_t                                 n_files                = 0;
+
+                            system_hash64map_get_element_at(file_monitor_ptr->monitored_directory_name_hash_to_callback_map,
+                                                            n_directory,
+                                                           &directory_callback_ptr,
+                                                            NULL); /* result_hash */
+                            system_hash64map_get_property  (directory_callback_ptr->filename_to_callback_map,
+                                                            SYSTEM_HASH64MAP_PROPERTY_N_ELEMENTS,
+                                                           &n_files);
+
+                            for (uint32_t n_file = 0;
+                                          n_file < n_files;
+                                        ++n_file)
+                            {
+                                _system_file_monitor_file_callback* file_callback_ptr = NULL;
+
+                                system_hash64map_get_element_at(directory_callback_ptr->filename_to_callback_map,
+                                                                n_file,
+                                                               &file_callback_ptr,
+                                                                NULL); /* result_hash */
+
+                                _system_file_monitor_mark_file_callback_pending(file_callback_ptr,
+                                                                                time_now_usec);
+                            }
+                        }
+                    }
+                    else
+                    if ((current_event_ptr->mask & (IN_MODIFY | IN_MOVED_TO)) != 0 &&
+                         current_event_ptr->len                               >  0)
+                    {
+                        /* Determine which file is the event referring to. The notification may well concern a file
+                         * we are not interested in, in which case it is ignored. */
+                        _system_file_monitor_directory_callback* directory_callback_ptr = NULL;
+                        _system_file_monitor_file_callback*      file_callback_ptr      = NULL;
+                        const system_hash64                      file_name_hash         = system_hash64_calculate(current_event_ptr->name,
+                                                                                                                  (uint32_t) strlen(current_event_ptr->name) );
+
+                        if (system_hash64map_get(file_monitor_ptr->monitored_watch_index_to_callback_map,
+                                                 (system_hash64) current_event_ptr->wd,
+                                                &directory_callback_ptr)                                                   &&
+                            system_hash64map_get(directory_callback_ptr->filename_to_callback_map,
+                                                 file_name_hash,
+                                                &file_callback_ptr)                                                        &&
+                            system_hashed_ansi_string_is_equal_to_raw_string(file_callback_ptr->filename,
+                                                                             current_event_ptr->name) )
+                        {
+                            _system_file_monitor_mark_file_callback_pending(file_callback_ptr,
+                                                                            time_now_usec);
+                        }
+                    }
+                } /* for (all read events) */
+            }
+            system_critical_section_leave(file_monitor_ptr->cs);
+        } /* while (true) */
+    }
 #endif
 
 /** TODO */
 PRIVATE void _system_file_monitor_monitor_thread_entrypoint(void* unused)
 {
     /* Under Windows, we use events to wait for "file change notifications".
-     * Under Linux, we use this thread to block on the file descriptor, through
-     * which inotify informs us about file modifications.
+     * Under Linux, we use this thread to block on an epoll set, which includes
+     * the file descriptor, through which inotify informs us about file modifications.
+     * The epoll wait times out when the coalescing window of a modified file expires.
      */
     LOG_INFO("File monitor thread started.");
 
@@ -662,63 +1076,50 @@ PRIVATE void _system_file_monitor_monitor_thread_entrypoint(void* unused)
     }
     #else /* _WIN32 */
     {
-        char           event_buffer[sizeof(inotify_event) + NAME_MAX + 1];
-        int            n_bytes_available;
-        int            select_result;
-        struct timeval timeout;
-
-        /* Set up polling time */
-        timeout.tv_sec  = 1;
-        timeout.tv_usec = 0;
-
-        /* Run the loop */
-        while (select_result = select(file_monitor_ptr->file_inotify + 1,
-                                     &file_monitor_ptr->file_inotify_fdset, /* readfds   */
-                                      NULL,                                 /* writefds  */
-                                      NULL,                                 /* exceptfds */
-                                     &timeout) )
+        int time_to_next_dispatch_msec = -1;
+
+        while (!file_monitor_ptr->monitor_thread_should_die)
         {
-            int n_current_byte = 0;
+            epoll_event events[2];
+            int         n_events;
 
-            n_bytes_available = read(file_monitor_ptr->file_inotify,
-                                          event_buffer,
-                                          sizeof(event_buffer) );
+            n_events = epoll_wait(file_monitor_ptr->epoll_fd,
+                                  events,
+                                  sizeof(events) / sizeof(events[0]),
+                                  time_to_next_dispatch_msec);
 
-            while (n_current_byte < n_bytes_available)
+            if (n_events < 0 && errno != EINTR)
             {
-                inotify_event*                      current_event_ptr = ((inotify_event*) event_buffer + n_current_byte);
-                _system_file_monitor_file_callback* file_callback_ptr = NULL;
+                ASSERT_DEBUG_SYNC(false,
+                                  "epoll_wait() call failed.");
 
-                /* We only care about the 'file modified' notifications. */
-                if ((current_event_ptr->mask & IN_MODIFY) != 0)
+                break;
+            }
+
+            for (int n_event = 0;
+                     n_event < n_events;
+                   ++n_event)
+            {
+                if (events[n_event].data.fd == file_monitor_ptr->file_inotify)
                 {
-                    /* Determine which file is the event referring to */
-                    system_critical_section_enter(file_monitor_ptr->cs);
-                    {
-                        if (!system_hash64map_get(file_monitor_ptr->monitored_watch_index_to_callback_map,
-                                                (system_hash64) current_event_ptr->wd,
-                                                &file_callback_ptr) )
-                        {
-                            ASSERT_DEBUG_SYNC(false,
-                                            "Could not map watch-dog index to a file callback descriptor");
-                        }
-                        else
-                        {
-                            file_callback_ptr->callback(file_callback_ptr->filename_with_path,
-                                                        file_callback_ptr->callback_user_arg);
-                        }
-                    }
-                    system_critical_section_leave(file_monitor_ptr->cs);
+                    _system_file_monitor_process_inotify_events();
                 }
+                else
+                if (events[n_event].data.fd == file_monitor_ptr->wakeup_event_fd)
+                {
+                    uint64_t wakeup_value = 0;
 
-                /* Move on */
-                n_current_byte += sizeof(inotify_event) + current_event_ptr->len;
-            } /* while (n_current_byte < n_bytes_available) */
-        } /* while (file descriptor is operable) */
+                    read(file_monitor_ptr->wakeup_event_fd,
+                        &wakeup_value,
+                         sizeof(wakeup_value) );
+                }
+            }
 
-        /* We will only get out of the loop when the inotify file descriptor is closed.
-         * Therefore, we need not release it at this point.
-         */
+            if (!file_monitor_ptr->monitor_thread_should_die)
+            {
+                time_to_next_dispatch_msec = _system_file_monitor_dispatch_due_callbacks();
+            }
+        } /* while (monitor thread should keep running) */
     }
     #endif
 
@@ -728,27 +1129,26 @@ PRIVATE void _system_file_monitor_monitor_thread_entrypoint(void* unused)
 /** TODO */
 PRIVATE bool _system_file_monitor_register_file_callback(system_hashed_ansi_string file_name_with_path,
                                                          PFNFILECHANGEDETECTEDPROC pfn_file_changed_proc,
-                                                         void*                     file_changed_proc_user_arg)
+                                                         void*                     file_changed_proc_user_arg,
+                                                         uint32_t                  coalescing_window_msec)
 {
-    /* NOTE: Under Windows, we can only watch for directory notifications.
-     *       Under Linux, we ask kernel to ping us about file notifications.
-     *
-     *       Differences on the API level force us to fork the implementation below in
-     *       a significant manner.
+    /* NOTE: On both platforms, we sign up for notifications on the directory level.
+     *       Under Windows, we need to use timestamps to tell which file has been modified.
+     *       Under Linux, inotify tells us the name of the modified file.
      */
-    _system_file_monitor_file_callback* file_callback_ptr        = NULL;
-    const system_hash64                 file_name_with_path_hash = system_hashed_ansi_string_get_hash  (file_name_with_path);
-    const char*                         file_name_with_path_raw  = system_hashed_ansi_string_get_buffer(file_name_with_path);
-    bool                                result                   = false;
+    _system_file_monitor_directory_callback* directory_callback_ptr          = NULL;
+    _system_file_monitor_file_callback*      file_callback_ptr               = NULL;
+    system_hashed_ansi_string                file_name_without_path_has      = NULL;
+    system_hash64                            file_name_without_path_has_hash;
+    system_hashed_ansi_string                file_path_has                   = NULL;
+    system_hash64                            file_path_has_hash;
+    const char*                              file_path_raw                   = NULL;
+    bool                                     is_directory_callback_new       = false;
+    bool                                     result                          = false;
 
     #ifdef _WIN32
-        _system_file_monitor_directory_callback* directory_callback_ptr          = NULL;
-        system_hashed_ansi_string                file_name_without_path_has      = NULL;
-        system_hash64                            file_name_without_path_has_hash;
-        system_hashed_ansi_string                file_path_has                   = NULL;
-        system_hash64                            file_path_has_hash;
-        const char*                              file_path_raw                   = NULL;
-        system_event                             result_wait_event               = NULL;
+        const char*  file_name_with_path_raw = system_hashed_ansi_string_get_buffer(file_name_with_path);
+        system_event result_wait_event       = NULL;
 
         /* Retrieve last write time for the specified file */
         FILETIME last_write_time;
@@ -762,27 +1162,29 @@ PRIVATE bool _system_file_monitor_register_file_callback(system_hashed_ansi_stri
 
             goto end;
         }
+    #endif
 
-        /* Extract path and the file name from the input argument */
-        _system_file_monitor_get_directory_and_file_for_file_name_with_path(file_name_with_path,
-                                                                           &file_path_has,
-                                                                           &file_name_without_path_has);
+    /* Extract path and the file name from the input argument */
+    _system_file_monitor_get_directory_and_file_for_file_name_with_path(file_name_with_path,
+                                                                       &file_path_has,
+                                                                       &file_name_without_path_has);
 
-        file_name_without_path_has_hash = system_hashed_ansi_string_get_hash  (file_name_without_path_has);
-        file_path_has_hash              = system_hashed_ansi_string_get_hash  (file_path_has);
-        file_path_raw                   = system_hashed_ansi_string_get_buffer(file_path_has);
+    file_name_without_path_has_hash = system_hashed_ansi_string_get_hash  (file_name_without_path_has);
+    file_path_has_hash              = system_hashed_ansi_string_get_hash  (file_path_has);
+    file_path_raw                   = system_hashed_ansi_string_get_buffer(file_path_has);
 
-        /* Ensure we are not already subscribed to receive directory change notifications for
-         * this specific folder. */
-        if (!system_hash64map_get(file_monitor_ptr->monitored_directory_name_hash_to_callback_map,
-                                  system_hashed_ansi_string_get_hash(file_path_has),
-                                 &directory_callback_ptr) )
+    /* Ensure we are not already subscribed to receive directory change notifications for
+     * this specific folder. */
+    if (!system_hash64map_get(file_monitor_ptr->monitored_directory_name_hash_to_callback_map,
+                              file_path_has_hash,
+                             &directory_callback_ptr) )
+    {
+        /* We're not. Sign up now. */
+        #ifdef _WIN32
         {
-            /* We're not. Sign up now. */
-            system_event new_wait_event  = NULL;
-            HANDLE       new_wait_handle = ::FindFirstChangeNotification(file_path_raw,
-                                                                         false, /* bWatchSubtree */
-                                                                         FILE_NOTIFY_CHANGE_LAST_WRITE);
+            HANDLE new_wait_handle = ::FindFirstChangeNotification(file_path_raw,
+                                                                   false, /* bWatchSubtree */
+                                                                   FILE_NOTIFY_CHANGE_LAST_WRITE);
 
             ASSERT_DEBUG_SYNC(new_wait_handle != INVALID_HANDLE_VALUE,
                             "Could not sign up for directory change notifications - INVALID_HANDLE_VALUE returned.");
@@ -796,28 +1198,62 @@ PRIVATE bool _system_file_monitor_register_file_callback(system_hashed_ansi_stri
             /* Instantiate a directory descriptor */
             directory_callback_ptr = new (std::nothrow) _system_file_monitor_directory_callback(file_path_has,
                                                                                                 result_wait_event);
+        }
+        #else
+        {
+            /* Files are often saved by writing a temporary file, which is then renamed. IN_MOVED_TO lets us
+             * catch these, too. */
+            const int new_watch_index = inotify_add_watch(file_monitor_ptr->file_inotify,
+                                                          file_path_raw,
+                                                          IN_MODIFY | IN_MOVED_TO);
 
-            ASSERT_DEBUG_SYNC(directory_callback_ptr != NULL,
-                            "Out of memory");
+            if (new_watch_index < 0)
+            {
+                ASSERT_DEBUG_SYNC(false,
+                                  "Could not add a new inotify watch for directory [%s]",
+                                  file_path_raw);
+
+                goto end;
+            }
+
+            /* Instantiate a directory descriptor */
+            directory_callback_ptr = new (std::nothrow) _system_file_monitor_directory_callback(file_path_has,
+                                                                                                new_watch_index);
+        }
+        #endif
+
+        ASSERT_ALWAYS_SYNC(directory_callback_ptr != NULL,
+                           "Out of memory");
+
+        is_directory_callback_new = true;
+
+        system_hash64map_insert(file_monitor_ptr->monitored_directory_name_hash_to_callback_map,
+                                file_path_has_hash,
+                                directory_callback_ptr,
+                                NULL,  /* callback */
+                                NULL); /* callback_argument */
 
-            system_hash64map_insert(file_monitor_ptr->monitored_directory_name_hash_to_callback_map,
-                                    file_path_has_hash,
+        #ifdef __linux
+        {
+            system_hash64map_insert(file_monitor_ptr->monitored_watch_index_to_callback_map,
+                                    (system_hash64) directory_callback_ptr->watch_index,
                                     directory_callback_ptr,
                                     NULL,  /* callback */
                                     NULL); /* callback_argument */
-        } /* if (directory is not already being monitored) */
+        }
+        #endif
+    } /* if (directory is not already being monitored) */
 
-        /* Ensure the requested file does not have a corresponding descriptor already. */
-        if (system_hash64map_contains(directory_callback_ptr->filename_to_callback_map,
-                                      file_name_without_path_has_hash) )
-        {
-            ASSERT_DEBUG_SYNC(false,
-                            "File [%s] is already monitored for changes.",
-                            file_name_with_path_raw);
+    /* Ensure the requested file does not have a corresponding descriptor already. */
+    if (system_hash64map_contains(directory_callback_ptr->filename_to_callback_map,
+                                  file_name_without_path_has_hash) )
+    {
+        ASSERT_DEBUG_SYNC(false,
+                        "File [%s] is already monitored for changes.",
+                        system_hashed_ansi_string_get_buffer(file_name_with_path) );
 
-            goto end;
-        }
-    #endif
+        goto end;
+    }
 
     /* Sign up for change notifications of the specified file */
     #ifdef _WIN32
@@ -831,15 +1267,10 @@ PRIVATE bool _system_file_monitor_register_file_callback(system_hashed_ansi_stri
     {
         file_callback_ptr = new (std::nothrow) _system_file_monitor_file_callback(pfn_file_changed_proc,
                                                                                   file_changed_proc_user_arg,
-                                                                                  file_name_with_path);
-
-        file_callback_ptr->watch_index = inotify_add_watch(file_monitor_ptr->file_inotify,
-                                                           file_name_with_path_raw,
-                                                           IN_MODIFY);
-
-        ASSERT_DEBUG_SYNC(file_callback_ptr->watch_index >= 0,
-                          "Could not add a new inotify watch for file [%s]",
-                          file_name_with_path_raw);
+                                                                                  file_path_has,
+                                                                                  file_name_without_path_has,
+                                                                                  file_name_with_path,
+                                                                                  coalescing_window_msec);
     }
     #endif
 
@@ -850,49 +1281,38 @@ PRIVATE bool _system_file_monitor_register_file_callback(system_hashed_ansi_stri
     {
         /* Also store the latest write time in the descriptor */
         file_callback_ptr->last_write_time = last_write_time;
-
-        system_hash64map_insert(directory_callback_ptr->filename_to_callback_map,
-                                file_name_without_path_has_hash,
-                                file_callback_ptr,
-                                NULL,  /* callback */
-                                NULL); /* callback_user_argument */
-    }
-    #else
-    {
-        system_critical_section_enter(file_monitor_ptr->cs);
-        {
-            system_hash64map_insert(file_monitor_ptr->monitored_file_name_hash_to_callback_map,
-                                    file_name_with_path_hash,
-                                    file_callback_ptr,
-                                    NULL,  /* callback */
-                                    NULL); /* callback_user_argument */
-
-            system_hash64map_insert(file_monitor_ptr->monitored_watch_index_to_callback_map,
-                                    (system_hash64) file_callback_ptr->watch_index,
-                                    file_callback_ptr,
-                                    NULL,  /* callback */
-                                    NULL); /* callback_user_argument */
-        }
-        system_critical_section_leave(file_monitor_ptr->cs);
     }
     #endif
 
+    system_hash64map_insert(directory_callback_ptr->filename_to_callback_map,
+                            file_name_without_path_has_hash,
+                            file_callback_ptr,
+                            NULL,  /* callback */
+                            NULL); /* callback_user_argument */
+
     /* All done */
     result = true;
 
 end:
     if (!result)
     {
-        #ifdef _WIN32
+        if (directory_callback_ptr    != NULL &&
+            is_directory_callback_new)
         {
-            if (directory_callback_ptr != NULL)
+            system_hash64map_remove(file_monitor_ptr->monitored_directory_name_hash_to_callback_map,
+                                    file_path_has_hash);
+
+            #ifdef __linux
             {
-                delete directory_callback_ptr;
+                system_hash64map_remove(file_monitor_ptr->monitored_watch_index_to_callback_map,
+                                        (system_hash64) directory_callback_ptr->watch_index);
+            }
+            #endif
 
-                directory_callback_ptr = NULL;
-            } /* if (directory_callback_ptr != NULL) */
-        }
-        #endif /* _WIN32 */
+            delete directory_callback_ptr;
+
+            directory_callback_ptr = NULL;
+        } /* if (directory_callback_ptr != NULL && is_directory_callback_new) */
 
         if (file_callback_ptr != NULL)
         {
@@ -905,74 +1325,73 @@ end:
     return result;
 }
 
-#ifdef _WIN32
-    /** TODO */
-    PRIVATE void _system_file_monitor_unregister_file_callback(_system_file_monitor_directory_callback* directory_callback_ptr,
-                                                               _system_file_monitor_file_callback*      file_callback_ptr)
-    {
-        const system_hash64 file_hash = system_hashed_ansi_string_get_hash(file_callback_ptr->filename);
-        uint32_t            n_files   = 0;
+/** TODO */
+PRIVATE void _system_file_monitor_unregister_file_callback(_system_file_monitor_directory_callback* directory_callback_ptr,
+                                                           _system_file_monitor_file_callback*      file_callback_ptr)
+{
+    const system_hash64 file_hash = system_hashed_ansi_string_get_hash(file_callback_ptr->filename);
+    uint32_t            n_files   = 0;
 
-        ASSERT_DEBUG_SYNC(directory_callback_ptr != NULL &&
-                          file_callback_ptr      != NULL,
-                          "Directory and/or file callback descriptors are NULL");
+    ASSERT_DEBUG_SYNC(directory_callback_ptr != NULL &&
+                      file_callback_ptr      != NULL,
+                      "Directory and/or file callback descriptors are NULL");
 
+    #ifdef _WIN32
+    {
         ASSERT_DEBUG_SYNC(directory_callback_ptr->wait_event != NULL,
                           "Directory call-back's wait event is NULL");
+    }
+    #else
+    {
+        /* Make sure no call-back is issued for the descriptor after it is released */
+        if (file_callback_ptr->is_pending)
+        {
+            system_resizable_vector_delete_element_at(file_monitor_ptr->pending_file_callbacks,
+                                                      system_resizable_vector_find(file_monitor_ptr->pending_file_callbacks,
+                                                                                   file_callback_ptr) );
+        }
+    }
+    #endif
 
-        /* Find the file call-back descriptor in the directory call-back descriptor */
-        ASSERT_DEBUG_SYNC(system_hash64map_contains(directory_callback_ptr->filename_to_callback_map,
-                                                    file_hash),
-                          "The provided directory callback descriptor does not own the specified file callback descriptor");
-
-        system_hash64map_remove(directory_callback_ptr->filename_to_callback_map,
-                                file_hash);
+    /* Find the file call-back descriptor in the directory call-back descriptor */
+    ASSERT_DEBUG_SYNC(system_hash64map_contains(directory_callback_ptr->filename_to_callback_map,
+                                                file_hash),
+                      "The provided directory callback descriptor does not own the specified file callback descriptor");
 
-        /* Release the file call-back descriptor */
-        delete file_callback_ptr;
-        file_callback_ptr = NULL;
+    system_hash64map_remove(directory_callback_ptr->filename_to_callback_map,
+                            file_hash);
 
-        /* If there are no more file callback descriptors embedded in the directory descriptor, release it */
-        system_hash64map_get_property(directory_callback_ptr->filename_to_callback_map,
-                                      SYSTEM_HASH64MAP_PROPERTY_N_ELEMENTS,
-                                     &n_files);
+    /* Release the file call-back descriptor */
+    delete file_callback_ptr;
+    file_callback_ptr = NULL;
 
-        if (n_files == 0)
-        {
-            const system_hash64 directory_name_hash = system_hashed_ansi_string_get_hash(directory_callback_ptr->directory);
+    /* If there are no more file callback descriptors embedded in the directory descriptor, release it */
+    system_hash64map_get_property(directory_callback_ptr->filename_to_callback_map,
+                                  SYSTEM_HASH64MAP_PROPERTY_N_ELEMENTS,
+                                 &n_files);
 
-            ASSERT_DEBUG_SYNC(system_hash64map_contains(file_monitor_ptr->monitored_directory_name_hash_to_callback_map,
-                                                        directory_name_hash),
-                              "Could not find the specified directory call-back descriptor");
+    if (n_files == 0)
+    {
+        const system_hash64 directory_name_hash = system_hashed_ansi_string_get_hash(directory_callback_ptr->directory);
 
-            system_hash64map_remove(file_monitor_ptr->monitored_directory_name_hash_to_callback_map,
-                                    directory_name_hash);
+        ASSERT_DEBUG_SYNC(system_hash64map_contains(file_monitor_ptr->monitored_directory_name_hash_to_callback_map,
+                                                    directory_name_hash),
+                          "Could not find the specified directory call-back descriptor");
 
-            delete directory_callback_ptr;
-            directory_callback_ptr = NULL;
-        }
-    }
-#else
-/** TODO */
-    PRIVATE void _system_file_monitor_unregister_file_callback(_system_file_monitor_file_callback* file_callback_ptr)
-    {
-        const system_hash64 filename_hash = system_hashed_ansi_string_get_hash(file_callback_ptr->filename_with_path);
+        system_hash64map_remove(file_monitor_ptr->monitored_directory_name_hash_to_callback_map,
+                                directory_name_hash);
 
-        /* Remove the descriptor from the hash-map */
-        system_critical_section_enter(file_monitor_ptr->cs);
+        #ifdef __linux
         {
-            system_hash64map_remove(file_monitor_ptr->monitored_file_name_hash_to_callback_map,
-                                    filename_hash);
             system_hash64map_remove(file_monitor_ptr->monitored_watch_index_to_callback_map,
-                                    file_callback_ptr->watch_index);
+                                    (system_hash64) directory_callback_ptr->watch_index);
         }
-        system_critical_section_leave(file_monitor_ptr->cs);
+        #endif
 
-        /* Release the file call-back descriptor */
-        delete file_callback_ptr;
-        file_callback_ptr = NULL;
+        delete directory_callback_ptr;
+        directory_callback_ptr = NULL;
     }
-#endif
+}
 
 
 /** Please see header for spec */
@@ -1000,32 +1419,29 @@ PUBLIC void system_file_monitor_init()
 PUBLIC EMERALD_API void system_file_monitor_monitor_file_changes(system_hashed_ansi_string file_name,
                                                                  bool                      should_enable,
                                                                  PFNFILECHANGEDETECTEDPROC pfn_file_changed_proc,
-                                                                 void*                     user_arg)
+                                                                 void*                     user_arg,
+                                                                 uint32_t                  coalescing_window_msec)
 {
-    const system_hash64 file_name_hash = system_hashed_ansi_string_get_hash(file_name);
-
-    #ifdef _WIN32
-        system_hashed_ansi_string file_name_without_path_has      = NULL;
-        system_hash64             file_name_without_path_has_hash;
-        system_hashed_ansi_string file_path_has                   = NULL;
-        system_hash64             file_path_has_hash;
-
-        _system_file_monitor_get_directory_and_file_for_file_name_with_path(file_name,
-                                                                           &file_path_has,
-                                                                           &file_name_without_path_has);
-
-        ASSERT_DEBUG_SYNC(file_path_has              != NULL &&
-                          file_name_without_path_has != NULL,
-                          "Could not extract file path & name from the input file name argument");
-
-        file_path_has_hash              = system_hashed_ansi_string_get_hash(file_path_has);
-        file_name_without_path_has_hash = system_hashed_ansi_string_get_hash(file_name_without_path_has);
-    #endif /* _WIN32 */
+    system_hashed_ansi_string file_name_without_path_has      = NULL;
+    system_hash64             file_name_without_path_has_hash;
+    system_hashed_ansi_string file_path_has                   = NULL;
+    system_hash64             file_path_has_hash;
 
     /* Sanity checks */
     ASSERT_DEBUG_SYNC(file_monitor_ptr != NULL,
                       "File monitor has not been initialized.");
 
+    _system_file_monitor_get_directory_and_file_for_file_name_with_path(file_name,
+                                                                       &file_path_has,
+                                                                       &file_name_without_path_has);
+
+    ASSERT_DEBUG_SYNC(file_path_has              != NULL &&
+                      file_name_without_path_has != NULL,
+                      "Could not extract file path & name from the input file name argument");
+
+    file_path_has_hash              = system_hashed_ansi_string_get_hash(file_path_has);
+    file_name_without_path_has_hash = system_hashed_ansi_string_get_hash(file_name_without_path_has);
+
     /* Chances are this is the first file we are asked to look after. If this is the case,
      * spawn the monitoring thread */
     system_critical_section_enter(file_monitor_ptr->cs);
@@ -1046,7 +1462,7 @@ PUBLIC EMERALD_API void system_file_monitor_monitor_file_changes(system_hashed_a
 
         /* Lock the monitor thread under Windows.
          *
-         * NOTE: Under Linux, the call-backs will never occur if the "cs" critical section is locked */
+         * NOTE: Under Linux, the monitor thread will not touch the descriptors if the "cs" critical section is locked */
         #ifdef _WIN32
         {
             system_event_set        (file_monitor_ptr->wait_table_needs_an_update_event);
@@ -1058,67 +1474,45 @@ PUBLIC EMERALD_API void system_file_monitor_monitor_file_changes(system_hashed_a
         /* If the caller requested a certain callback to be removed, remove & release it now */
         if (!should_enable)
         {
-            #ifdef _WIN32
-            {
-                _system_file_monitor_directory_callback* directory_callback_ptr = NULL;
-                _system_file_monitor_file_callback*      file_callback_ptr      = NULL;
-
-                if (!system_hash64map_get(file_monitor_ptr->monitored_directory_name_hash_to_callback_map,
-                                          file_path_has_hash,
-                                         &directory_callback_ptr) )
-                {
-                    ASSERT_DEBUG_SYNC(false,
-                                      "Could not retrieve directory call-back's descriptor for file [%s]",
-                                      system_hashed_ansi_string_get_buffer(file_name) );
+            _system_file_monitor_directory_callback* directory_callback_ptr = NULL;
+            _system_file_monitor_file_callback*      file_callback_ptr      = NULL;
 
-                    should_continue = false;
-                } /* if (directory call-back descriptor was found) */
-                else
-                {
-                    if (!system_hash64map_get(directory_callback_ptr->filename_to_callback_map,
-                                              file_name_without_path_has_hash,
-                                             &file_callback_ptr) )
-                    {
-                        ASSERT_DEBUG_SYNC(false,
-                                          "Could not retrieve file call-back's descriptor for file [%s]",
-                                          system_hashed_ansi_string_get_buffer(file_name) );
-
-                        should_continue = false;
-                    } /* if (file call-back descriptor was found) */
-                    else
-                    {
-                        _system_file_monitor_unregister_file_callback(directory_callback_ptr,
-                                                                      file_callback_ptr);
-                    }
-                }
-            }
-            #else /* _WIN32 */
+            if (!system_hash64map_get(file_monitor_ptr->monitored_directory_name_hash_to_callback_map,
+                                      file_path_has_hash,
+                                     &directory_callback_ptr) )
             {
-                _system_file_monitor_file_callback* file_callback_ptr = NULL;
+                ASSERT_DEBUG_SYNC(false,
+                                  "Could not retrieve directory call-back's descriptor for file [%s]",
+                                  system_hashed_ansi_string_get_buffer(file_name) );
 
-                if (!system_hash64map_get(file_monitor_ptr->monitored_file_name_hash_to_callback_map,
-                                          file_name_hash,
+                should_continue = false;
+            } /* if (directory call-back descriptor was found) */
+            else
+            {
+                if (!system_hash64map_get(directory_callback_ptr->filename_to_callback_map,
+                                          file_name_without_path_has_hash,
                                          &file_callback_ptr) )
                 {
                     ASSERT_DEBUG_SYNC(false,
                                       "Could not retrieve file call-back's descriptor for file [%s]",
-                                      system_hashed_ansi_string_get_buffer(File_name) );
+                                      system_hashed_ansi_string_get_buffer(file_name) );
 
                     should_continue = false;
                 } /* if (file call-back descriptor was found) */
                 else
                 {
-                    _system_file_monitor_unregister_file_callback(file_callback_ptr);
+                    _system_file_monitor_unregister_file_callback(directory_callback_ptr,
+                                                                  file_callback_ptr);
                 }
             }
-            #endif
         } /* if (!should_enable) */
         else
         {
             /* Register a new call-back */
             if (!_system_file_monitor_register_file_callback(file_name,
                                                              pfn_file_changed_proc,
-                                                             user_arg) )
+                                                             user_arg,
+                                                             coalescing_window_msec) )
             {
                 ASSERT_DEBUG_SYNC(false,
                                   "Could not register a system call-back for file [%s]",
@@ -1192,4 +1586,16 @@ PUBLIC EMERALD_API void system_file_monitor_monitor_file_changes(system_hashed_a
         #endif /* _WIN32 */
     }
     system_critical_section_leave(file_monitor_ptr->cs);
+
+    /* Under Linux, the call-back may have been taken by the monitor thread for execution before we
+     * unregistered it. Wait for the batch to finish, so that the caller can safely release the user argument. */
+    #ifdef __linux
+    {
+        if (!should_enable)
+        {
+            system_event_wait_single(file_monitor_ptr->dispatch_finished_event,
+                                     SYSTEM_TIME_INFINITE);
+        }
+    }
+    #endif
 }
@@ -6,12 +6,38 @@
 #include "shared.h"
 #include "system/system_assertions.h"
 #include "system/system_barrier.h"
+#include "system/system_critical_section.h"
+#include "system/system_event.h"
+#include "system/system_file_enumerator.h"
 #include "system/system_file_multiunpacker.h"
 #include "system/system_file_unpacker.h"
 #include "system/system_resizable_vector.h"
 #include "system/system_thread_pool.h"
 
 
+typedef struct _system_file_multiunpacker_subscription
+{
+    system_hashed_ansi_string               file_name;
+    unsigned int                            n_file;
+    struct _system_file_multiunpacker*      owner_ptr;
+    PFNSYSTEMFILEMULTIUNPACKERFILEREADYPROC pfn_file_ready_proc;
+    system_file_unpacker                    unpacker; /* NULL until the file has been located */
+    void*                                   user_arg;
+
+    explicit _system_file_multiunpacker_subscription(system_hashed_ansi_string               in_file_name,
+                                                     _system_file_multiunpacker*             in_owner_ptr,
+                                                     PFNSYSTEMFILEMULTIUNPACKERFILEREADYPROC in_pfn_file_ready_proc,
+                                                     void*                                   in_user_arg)
+    {
+        file_name           = in_file_name;
+        n_file              = 0;
+        owner_ptr           = in_owner_ptr;
+        pfn_file_ready_proc = in_pfn_file_ready_proc;
+        unpacker            = NULL;
+        user_arg            = in_user_arg;
+    }
+} _system_file_multiunpacker_subscription;
+
 typedef struct _system_file_multiunpacker_unpacker
 {
     struct _system_file_multiunpacker* owner_ptr;
@@ -39,14 +65,28 @@ typedef struct _system_file_multiunpacker_unpacker
 
 typedef struct _system_file_multiunpacker
 {
+    system_critical_section cs;                           /* protects the fields below */
+    unsigned int            n_opened_unpackers;
+    unsigned int            n_pending_subscriptions;
+    system_resizable_vector parked_subscriptions;         /* _system_file_multiunpacker_subscription*, waiting for their packed file to be opened */
+    system_event            subscriptions_finished_event;
+
     system_barrier          sync_barrier;
     system_resizable_vector unpackers; /* _system_file_multipacker_unpacker */
 
     explicit _system_file_multiunpacker(unsigned int n_unpackers)
     {
-        sync_barrier = system_barrier_create         (n_unpackers);
-        unpackers    = system_resizable_vector_create(n_unpackers,
-                                                      false); /* should_be_thread_safe */
+        cs                           = system_critical_section_create();
+        n_opened_unpackers           = 0;
+        n_pending_subscriptions      = 0;
+        parked_subscriptions         = system_resizable_vector_create(4,     /* capacity */
+                                                                      false); /* should_be_thread_safe */
+        subscriptions_finished_event = system_event_create(true); /* manual_reset */
+        sync_barrier                 = system_barrier_create         (n_unpackers);
+        unpackers                    = system_resizable_vector_create(n_unpackers,
+                                                                      true); /* should_be_thread_safe */
+
+        system_event_set(subscriptions_finished_event);
     }
 
     ~_system_file_multiunpacker()
@@ -59,6 +99,38 @@ typedef struct _system_file_multiunpacker
             sync_barrier = NULL;
         } /* if (sync_barrier != NULL) */
 
+        if (subscriptions_finished_event != NULL)
+        {
+            system_event_wait_single(subscriptions_finished_event);
+
+            /* The event is set by the last subscription task with the critical section entered. Make sure
+             * the task has left it before the objects are released. */
+            system_critical_section_enter(cs);
+            system_critical_section_leave(cs);
+
+            system_event_release(subscriptions_finished_event);
+
+            subscriptions_finished_event = NULL;
+        }
+
+        if (cs != NULL)
+        {
+            system_critical_section_release(cs);
+
+            cs = NULL;
+        }
+
+        if (parked_subscriptions != NULL)
+        {
+            /* All subscriptions are dispatched by the time the last packed file is opened */
+            ASSERT_DEBUG_SYNC(n_pending_subscriptions == 0,
+                              "Subscriptions are still pending at release time.");
+
+            system_resizable_vector_release(parked_subscriptions);
+
+            parked_subscriptions = NULL;
+        }
+
         if (unpackers != NULL)
         {
             unsigned int n_unpackers = 0;
@@ -92,18 +164,139 @@ typedef struct _system_file_multiunpacker
 } _system_file_multiunpacker;
 
 
+/** Unpacks the file a subscription has been made for and hands it over to the subscriber. Called back from
+ *  the thread pool.
+ *
+ *  @param argument Subscription descriptor (_system_file_multiunpacker_subscription*). Released by the function.
+ */
+PRIVATE volatile void _system_file_multiunpacker_process_subscription(system_thread_pool_callback_argument argument)
+{
+    _system_file_multiunpacker*              multiunpacker_ptr = NULL;
+    system_file_serializer                   serializer        = NULL;
+    _system_file_multiunpacker_subscription* subscription_ptr  = (_system_file_multiunpacker_subscription*) argument;
+
+    if (subscription_ptr->unpacker != NULL)
+    {
+        /* v2 packed files are only decompressed at this point */
+        system_file_unpacker_get_file_property(subscription_ptr->unpacker,
+                                               subscription_ptr->n_file,
+                                               SYSTEM_FILE_UNPACKER_FILE_PROPERTY_FILE_SERIALIZER,
+                                              &serializer);
+    }
+
+    subscription_ptr->pfn_file_ready_proc(subscription_ptr->file_name,
+                                          subscription_ptr->unpacker,
+                                          serializer,
+                                          subscription_ptr->user_arg);
+
+    /* Let waiters know if this was the last subscription in flight */
+    multiunpacker_ptr = subscription_ptr->owner_ptr;
+
+    delete subscription_ptr;
+    subscription_ptr = NULL;
+
+    system_critical_section_enter(multiunpacker_ptr->cs);
+    {
+        if (--multiunpacker_ptr->n_pending_subscriptions == 0)
+        {
+            system_event_set(multiunpacker_ptr->subscriptions_finished_event);
+        }
+    }
+    system_critical_section_leave(multiunpacker_ptr->cs);
+}
+
+/** Submits a thread pool task which is going to process the specified subscription.
+ *
+ *  @param subscription_ptr Subscription to process.
+ */
+PRIVATE void _system_file_multiunpacker_dispatch_subscription(_system_file_multiunpacker_subscription* subscription_ptr)
+{
+    system_thread_pool_task task = system_thread_pool_create_task_handler_only(THREAD_POOL_TASK_PRIORITY_NORMAL,
+                                                                               _system_file_multiunpacker_process_subscription,
+                                                                               subscription_ptr);
+
+    system_thread_pool_submit_single_task(task);
+}
+
+/** Checks if the specified unpacker holds the file a subscription has been made for. If so, the subscription
+ *  is updated with the location of the file.
+ *
+ *  @param unpacker         Unpacker to use.
+ *  @param subscription_ptr Subscription to update.
+ *
+ *  @return true if the file has been found, false otherwise.
+ */
+PRIVATE bool _system_file_multiunpacker_locate_subscribed_file(system_file_unpacker                     unpacker,
+                                                               _system_file_multiunpacker_subscription* subscription_ptr)
+{
+    bool result = false;
+
+    if (unpacker != NULL                                                                  &&
+        system_file_enumerator_is_file_present_in_system_file_unpacker(unpacker,
+                                                                       subscription_ptr->file_name,
+                                                                       true, /* use_exact_match */
+                                                                      &subscription_ptr->n_file) )
+    {
+        subscription_ptr->unpacker = unpacker;
+        result                     = true;
+    }
+
+    return result;
+}
+
 /** TODO */
 PRIVATE volatile void _system_file_multiunpacker_spawn_unpacker_thread_entrypoint(system_thread_pool_callback_argument argument)
 {
-    _system_file_multiunpacker_unpacker* unpacker_ptr = (_system_file_multiunpacker_unpacker*) argument;
-
-    unpacker_ptr->unpacker = system_file_unpacker_create(unpacker_ptr->packed_filename);
+    _system_file_multiunpacker_unpacker* unpacker_ptr      = (_system_file_multiunpacker_unpacker*) argument;
+    _system_file_multiunpacker*          multiunpacker_ptr = unpacker_ptr->owner_ptr;
+    system_file_unpacker                 unpacker          = system_file_unpacker_create(unpacker_ptr->packed_filename);
 
-    ASSERT_DEBUG_SYNC(unpacker_ptr->unpacker != NULL,
+    ASSERT_DEBUG_SYNC(unpacker != NULL,
                       "Could not spawn a system_file_unpacker instance");
 
+    /* Files held by the packed file can now be unpacked. Dispatch all subscriptions we can fulfill. Once the
+     * last packed file has been opened, the remaining subscriptions are dispatched, so that the subscribers
+     * learn the files could not be found. */
+    system_critical_section_enter(multiunpacker_ptr->cs);
+    {
+        unsigned int n_parked_subscriptions = 0;
+        unsigned int n_unpackers            = 0;
+
+        unpacker_ptr->unpacker = unpacker;
+
+        ++multiunpacker_ptr->n_opened_unpackers;
+
+        system_resizable_vector_get_property(multiunpacker_ptr->parked_subscriptions,
+                                             SYSTEM_RESIZABLE_VECTOR_PROPERTY_N_ELEMENTS,
+                                            &n_parked_subscriptions);
+        system_resizable_vector_get_property(multiunpacker_ptr->unpackers,
+                                             SYSTEM_RESIZABLE_VECTOR_PROPERTY_N_ELEMENTS,
+                                            &n_unpackers);
+
+        for (int n_subscription = (int) n_parked_subscriptions - 1;
+                 n_subscription >= 0;
+               --n_subscription)
+        {
+            _system_file_multiunpacker_subscription* subscription_ptr = NULL;
+
+            system_resizable_vector_get_element_at(multiunpacker_ptr->parked_subscriptions,
+                                                   n_subscription,
+                                                  &subscription_ptr);
+
+            if (_system_file_multiunpacker_locate_subscribed_file(unpacker,
+                                                                  subscription_ptr)      ||
+                multiunpacker_ptr->n_opened_unpackers == n_unpackers)
+            {
+                system_resizable_vector_delete_element_at       (multiunpacker_ptr->parked_subscriptions,
+                                                                 n_subscription);
+                _system_file_multiunpacker_dispatch_subscription(subscription_ptr);
+            }
+        } /* for (all parked subscriptions) */
+    }
+    system_critical_section_leave(multiunpacker_ptr->cs);
+
     /* Signal the owner barrier upon exit */
-    system_barrier_signal(unpacker_ptr->owner_ptr->sync_barrier,
+    system_barrier_signal(multiunpacker_ptr->sync_barrier,
                           false /* wait_until_signalled */);
 }
 
@@ -119,33 +312,43 @@ PUBLIC EMERALD_API system_file_multiunpacker system_file_multiunpacker_create(co
 
     if (new_multiunpacker_ptr != NULL)
     {
-        new_multiunpacker_ptr->sync_barrier = system_barrier_create         (n_packed_filenames);
-        new_multiunpacker_ptr->unpackers    = system_resizable_vector_create(n_packed_filenames,
-                                                                             true); /* should_be_thread_safe */
-
         ASSERT_DEBUG_SYNC(new_multiunpacker_ptr->sync_barrier != NULL,
                           "Could not instantiate a sync barrier.");
         ASSERT_DEBUG_SYNC(new_multiunpacker_ptr->unpackers != NULL,
                           "Could not set up a system_file_unpacker vector.");
 
-        /* Set up thread pool tasks */
+        /* Store all unpacker descriptors before any of the tasks is submitted. The tasks need to know
+         * how many packed files there are. */
         for (unsigned int n_packed_filename = 0;
                           n_packed_filename < n_packed_filenames;
                         ++n_packed_filename)
         {
             _system_file_multiunpacker_unpacker* current_unpacker_ptr = new (std::nothrow) _system_file_multiunpacker_unpacker(packed_filenames[n_packed_filename],
                                                                                                                                new_multiunpacker_ptr);
-            system_thread_pool_task              new_task;
 
             ASSERT_DEBUG_SYNC(current_unpacker_ptr != NULL,
                               "Out of memory");
 
+            system_resizable_vector_push(new_multiunpacker_ptr->unpackers,
+                                         current_unpacker_ptr);
+        } /* for (all packed filenames) */
+
+        /* Set up thread pool tasks */
+        for (unsigned int n_packed_filename = 0;
+                          n_packed_filename < n_packed_filenames;
+                        ++n_packed_filename)
+        {
+            _system_file_multiunpacker_unpacker* current_unpacker_ptr = NULL;
+            system_thread_pool_task              new_task;
+
+            system_resizable_vector_get_element_at(new_multiunpacker_ptr->unpackers,
+                                                   n_packed_filename,
+                                                  &current_unpacker_ptr);
+
             new_task = system_thread_pool_create_task_handler_only(THREAD_POOL_TASK_PRIORITY_NORMAL,
                                                                    _system_file_multiunpacker_spawn_unpacker_thread_entrypoint,
                                                                    current_unpacker_ptr);
 
-            system_resizable_vector_push         (new_multiunpacker_ptr->unpackers,
-                                                  current_unpacker_ptr);
             system_thread_pool_submit_single_task(new_task);
         } /* for (all packed filenames) */
     } /* if (new_multiunpacker_ptr != NULL) */
@@ -196,16 +399,81 @@ PUBLIC EMERALD_API void system_file_multiunpacker_release(system_file_multiunpac
 {
     _system_file_multiunpacker* multiunpacker_ptr = (_system_file_multiunpacker*) multiunpacker;
 
-    system_barrier_wait_until_signalled(multiunpacker_ptr->sync_barrier);
+    system_file_multiunpacker_wait_till_ready(multiunpacker);
 
     delete multiunpacker_ptr;
     multiunpacker_ptr = NULL;
 }
 
+/** Please see header for spec */
+PUBLIC EMERALD_API void system_file_multiunpacker_subscribe_to_file(system_file_multiunpacker               multiunpacker,
+                                                                    system_hashed_ansi_string               file_name,
+                                                                    PFNSYSTEMFILEMULTIUNPACKERFILEREADYPROC pfn_file_ready_proc,
+                                                                    void*                                   user_arg)
+{
+    _system_file_multiunpacker*              multiunpacker_ptr = (_system_file_multiunpacker*) multiunpacker;
+    _system_file_multiunpacker_subscription* subscription_ptr  = NULL;
+
+    ASSERT_DEBUG_SYNC(pfn_file_ready_proc != NULL,
+                      "Subscription call-back is NULL");
+
+    subscription_ptr = new (std::nothrow) _system_file_multiunpacker_subscription(file_name,
+                                                                                  multiunpacker_ptr,
+                                                                                  pfn_file_ready_proc,
+                                                                                  user_arg);
+
+    ASSERT_ALWAYS_SYNC(subscription_ptr != NULL,
+                       "Out of memory");
+
+    system_critical_section_enter(multiunpacker_ptr->cs);
+    {
+        bool         is_file_located = false;
+        unsigned int n_unpackers     = 0;
+
+        if (multiunpacker_ptr->n_pending_subscriptions++ == 0)
+        {
+            system_event_reset(multiunpacker_ptr->subscriptions_finished_event);
+        }
+
+        /* Check the packed files which have already been opened */
+        system_resizable_vector_get_property(multiunpacker_ptr->unpackers,
+                                             SYSTEM_RESIZABLE_VECTOR_PROPERTY_N_ELEMENTS,
+                                            &n_unpackers);
+
+        for (unsigned int n_unpacker = 0;
+                          n_unpacker < n_unpackers && !is_file_located;
+                        ++n_unpacker)
+        {
+            _system_file_multipacker_unpacker* unpacker_ptr = NULL;
+
+            system_resizable_vector_get_element_at(multiunpacker_ptr->unpackers,
+                                                   n_unpacker,
+                                                  &unpacker_ptr);
+
+            is_file_located = _system_file_multiunpacker_locate_subscribed_file(unpacker_ptr->unpacker,
+                                                                                subscription_ptr);
+        } /* for (all unpackers) */
+
+        /* If the file could not be found, wait for the remaining packed files to be opened */
+        if (is_file_located                                       ||
+            multiunpacker_ptr->n_opened_unpackers == n_unpackers)
+        {
+            _system_file_multiunpacker_dispatch_subscription(subscription_ptr);
+        }
+        else
+        {
+            system_resizable_vector_push(multiunpacker_ptr->parked_subscriptions,
+                                         subscription_ptr);
+        }
+    }
+    system_critical_section_leave(multiunpacker_ptr->cs);
+}
+
 /** Please see header for spec */
 PUBLIC EMERALD_API void system_file_multiunpacker_wait_till_ready(system_file_multiunpacker multiunpacker)
 {
     _system_file_multiunpacker* unpacker_ptr = (_system_file_multiunpacker*) multiunpacker;
 
     system_barrier_wait_until_signalled(unpacker_ptr->sync_barrier);
+    system_event_wait_single           (unpacker_ptr->subscriptions_finished_event);
 }
@@ -4,9 +4,12 @@
  *
  */
 #include "shared.h"
+#include "system/system_atomics.h"
+#include "system/system_constants.h"
 #include "system/system_file_packer.h"
 #include "system/system_file_serializer.h"
 #include "system/system_resizable_vector.h"
+#include "system/system_thread_pool.h"
 #include <stdio.h>
 #include <string.h>
 #include <zlib.h>
@@ -19,25 +22,48 @@
 #endif
 
 
-/* This #define tells the size of the internal buffer. Two of those are allocated
- * at packer instantiation time. They then are used for two things:
- *
- * a) Forming input undecoded byte stream.
- * b) Storage of encrypted byte stream before it is written out to the
- *    result file.
- *
- */
-#define INTERNAL_BUFFER_SIZE (4 * 1024768)
+typedef struct _system_file_packer_chunk
+{
+    Bytef*   packed_data;
+    uint32_t packed_size;
+    uint32_t unpacked_size;
 
+    _system_file_packer_chunk()
+    {
+        packed_data   = NULL;
+        packed_size   = 0;
+        unpacked_size = 0;
+    }
+
+    ~_system_file_packer_chunk()
+    {
+        if (packed_data != NULL)
+        {
+            delete [] packed_data;
+
+            packed_data = NULL;
+        }
+    }
+} _system_file_packer_chunk;
+
+typedef struct _system_file_packer_batch
+{
+    _system_file_packer_chunk* chunks;          /* first chunk of the batch */
+    volatile unsigned int      n_failed_chunks;
+    const unsigned char*       unpacked_data;
+    uint32_t                   unpacked_data_size;
+} _system_file_packer_batch;
 
 typedef struct _system_file_packer_file
 {
+    uint32_t                  crc32;
     system_hashed_ansi_string filename;
     uint32_t                  filesize;
 
     explicit _system_file_packer_file(system_hashed_ansi_string in_filename,
                                       uint32_t                  in_filesize)
     {
+        crc32    = 0;
         filename = in_filename;
         filesize = in_filesize;
     }
@@ -45,40 +71,18 @@ typedef struct _system_file_packer_file
 
 typedef struct _system_file_packer
 {
-    char*                   buffer_packed;
-    char*                   buffer_unpacked;
     system_resizable_vector files; /* _system_file_packer_file* */
-    uint32_t                total_filesize;
+    __uint64                total_filesize;
 
     _system_file_packer()
     {
-        buffer_packed   = new (std::nothrow) char[INTERNAL_BUFFER_SIZE];
-        buffer_unpacked = new (std::nothrow) char[INTERNAL_BUFFER_SIZE];
-        files           = system_resizable_vector_create(4,     /* capacity */
-                                                         true); /* should_be_thread_safe */
-        total_filesize  = 0;
-
-        ASSERT_ALWAYS_SYNC(buffer_packed   != NULL &&
-                           buffer_unpacked != NULL,
-                           "Out of memory");
+        files          = system_resizable_vector_create(4,     /* capacity */
+                                                        true); /* should_be_thread_safe */
+        total_filesize = 0;
     }
 
     ~_system_file_packer()
     {
-        if (buffer_packed != NULL)
-        {
-            delete [] buffer_packed;
-
-            buffer_packed = NULL;
-        }
-
-        if (buffer_unpacked != NULL)
-        {
-            delete [] buffer_unpacked;
-
-            buffer_unpacked = NULL;
-        }
-
         if (files != NULL)
         {
             _system_file_packer_file* file_ptr = NULL;
@@ -99,69 +103,258 @@ typedef struct _system_file_packer
 } _system_file_packer;
 
 
-/** TODO */
-PRIVATE uint32_t _system_file_packer_build_file_table(system_resizable_vector files,
-                                                      uint32_t                result_data_bytes,
-                                                      char*                   out_result_data)
+/** Compresses a range of chunks of a single batch. Called back from the thread pool.
+ *
+ *  @param range_start Index of the first chunk to compress, relative to the start of the batch.
+ *  @param range_end   Index of the chunk, at which the compression should stop.
+ *  @param user_arg    Batch descriptor (_system_file_packer_batch*).
+ */
+PRIVATE void _system_file_packer_compress_chunks(uint32_t range_start,
+                                                 uint32_t range_end,
+                                                 void*    user_arg)
 {
-    uint32_t n_files_to_use = 0;
-    char*    traveller_ptr  = out_result_data;
+    _system_file_packer_batch* batch_ptr = (_system_file_packer_batch*) user_arg;
 
-    system_resizable_vector_get_property(files,
-                                         SYSTEM_RESIZABLE_VECTOR_PROPERTY_N_ELEMENTS,
-                                        &n_files_to_use);
+    for (uint32_t n_chunk = range_start;
+                  n_chunk < range_end;
+                ++n_chunk)
+    {
+        _system_file_packer_chunk* chunk_ptr          = batch_ptr->chunks + n_chunk;
+        const uint32_t             chunk_start_offset = n_chunk * FILE_PACKER_CHUNK_SIZE;
+        uLongf                     packed_size        = 0;
 
-    /* Store the number of files we are describing */
-    *(uint32_t*) traveller_ptr  = n_files_to_use;
-    traveller_ptr              += sizeof(uint32_t);
+        chunk_ptr->unpacked_size = batch_ptr->unpacked_data_size - chunk_start_offset;
 
-    ASSERT_DEBUG_SYNC(traveller_ptr - out_result_data < (int32_t) result_data_bytes,
-                      "Input container is too small.");
+        if (chunk_ptr->unpacked_size > FILE_PACKER_CHUNK_SIZE)
+        {
+            chunk_ptr->unpacked_size = FILE_PACKER_CHUNK_SIZE;
+        }
 
-    /* Store an entry for each file enqueued */
-    uint32_t summed_file_size = 0;
+        packed_size            = compressBound(chunk_ptr->unpacked_size);
+        chunk_ptr->packed_data = new (std::nothrow) Bytef[packed_size];
 
-    for (uint32_t n_file = 0;
-                  n_file < n_files_to_use;
-                ++n_file)
+        if (chunk_ptr->packed_data == NULL)
+        {
+            ASSERT_ALWAYS_SYNC(false,
+                               "Out of memory");
+
+            system_atomics_increment(&batch_ptr->n_failed_chunks);
+
+            continue;
+        }
+
+        if (compress2(chunk_ptr->packed_data,
+                     &packed_size,
+                      batch_ptr->unpacked_data + chunk_start_offset,
+                      chunk_ptr->unpacked_size,
+                      Z_DEFAULT_COMPRESSION) != Z_OK)
+        {
+            ASSERT_DEBUG_SYNC(false,
+                              "Could not compress chunk data.");
+
+            system_atomics_increment(&batch_ptr->n_failed_chunks);
+
+            continue;
+        }
+
+        chunk_ptr->packed_size = (uint32_t) packed_size;
+    } /* for (all chunks in the range) */
+}
+
+/** Fills the batch buffer with data coming from the files added to the packer. The function moves on to the next
+ *  file whenever the current one has been fully read. Checksums of the files are updated on the way.
+ *
+ *  @param packer_ptr                  Packer instance.
+ *  @param n_bytes_to_read             Number of bytes to store in @param out_data.
+ *  @param n_current_file_ptr          Deref holds index of the file to read data from. Updated by the function.
+ *  @param current_file_serializer_ptr Deref holds the serializer of the file to read data from, or NULL, if the
+ *                                     file has not been opened yet. Updated by the function.
+ *  @param out_data                    Buffer to store the data in.
+ *
+ *  @return true if successful, false otherwise.
+ */
+PRIVATE bool _system_file_packer_read_batch_data(const _system_file_packer* packer_ptr,
+                                                 uint32_t                   n_bytes_to_read,
+                                                 uint32_t*                  n_current_file_ptr,
+                                                 system_file_serializer*    current_file_serializer_ptr,
+                                                 unsigned char*             out_data)
+{
+    bool result = true;
+
+    while (n_bytes_to_read > 0)
     {
-        _system_file_packer_file* file_ptr = NULL;
+        uint32_t                  current_file_offset = 0;
+        _system_file_packer_file* file_ptr            = NULL;
+        const void*               file_data_ptr       = NULL;
+        uint32_t                  n_file_bytes_to_read;
+
+        if (!system_resizable_vector_get_element_at(packer_ptr->files,
+                                                    *n_current_file_ptr,
+                                                   &file_ptr) )
+        {
+            ASSERT_DEBUG_SYNC(false,
+                              "File descriptor at index [%d] could not be retrieved.",
+                              *n_current_file_ptr);
 
-        system_resizable_vector_get_element_at(files,
-                                               n_file,
-                                              &file_ptr);
+            result = false;
+            goto end;
+        }
+
+        if (*current_file_serializer_ptr == NULL)
+        {
+            if (file_ptr->filesize == 0)
+            {
+                ++(*n_current_file_ptr);
+
+                continue;
+            }
+
+            *current_file_serializer_ptr = system_file_serializer_create_for_reading_mapped_file(file_ptr->filename);
+        }
 
-        ASSERT_DEBUG_SYNC(file_ptr != NULL,
-                          "File descriptor is NULL");
+        system_file_serializer_get_property(*current_file_serializer_ptr,
+                                            SYSTEM_FILE_SERIALIZER_PROPERTY_CURRENT_OFFSET,
+                                           &current_file_offset);
 
-        /* Write number of characters of the filename */
-        *(uint32_t*) traveller_ptr  = system_hashed_ansi_string_get_length(file_ptr->filename);
-        traveller_ptr              += sizeof(uint32_t);
+        n_file_bytes_to_read = file_ptr->filesize - current_file_offset;
 
-        ASSERT_DEBUG_SYNC(traveller_ptr - out_result_data < (int32_t) result_data_bytes,
-                          "Input container is too small.");
+        if (n_file_bytes_to_read > n_bytes_to_read)
+        {
+            n_file_bytes_to_read = n_bytes_to_read;
+        }
+
+        if (!system_file_serializer_read_no_copy(*current_file_serializer_ptr,
+                                                 n_file_bytes_to_read,
+                                                &file_data_ptr) )
+        {
+            ASSERT_ALWAYS_SYNC(false,
+                               "Could not read [%d] bytes from [%s].",
+                               n_file_bytes_to_read,
+                               system_hashed_ansi_string_get_buffer(file_ptr->filename) );
 
-        /* Write the actual string */
-        const uint32_t filename_length = system_hashed_ansi_string_get_length(file_ptr->filename);
+            result = false;
+            goto end;
+        }
 
-        memcpy(traveller_ptr,
-               system_hashed_ansi_string_get_buffer(file_ptr->filename),
-               filename_length);
+        memcpy(out_data,
+               file_data_ptr,
+               n_file_bytes_to_read);
 
-        traveller_ptr += filename_length;
+        file_ptr->crc32 = crc32(file_ptr->crc32,
+                                (const Bytef*) file_data_ptr,
+                                n_file_bytes_to_read);
 
-        /* Write the offset, at which the file data starts (counting from the first file's data start offset) */
-        *(uint32_t*) traveller_ptr  = summed_file_size;
-        traveller_ptr              += sizeof(uint32_t);
+        out_data        += n_file_bytes_to_read;
+        n_bytes_to_read -= n_file_bytes_to_read;
 
-        ASSERT_DEBUG_SYNC(traveller_ptr - out_result_data < (int32_t) result_data_bytes,
-                          "Input container is too small.");
+        /* Move to the next file, if we have reached the end of the current one */
+        if (current_file_offset + n_file_bytes_to_read == file_ptr->filesize)
+        {
+            system_file_serializer_release(*current_file_serializer_ptr);
 
-        /* Update the offset. */
-        summed_file_size += file_ptr->filesize;
-    } /* for (all enqueued files) */
+            *current_file_serializer_ptr = NULL;
+            ++(*n_current_file_ptr);
+        }
+    } /* while (n_bytes_to_read > 0) */
 
-    return (traveller_ptr - out_result_data);
+end:
+    return result;
+}
+
+/** Writes the v2 packed file header, file table & chunk table to the specified serializer.
+ *
+ *  @param packer_ptr     Packer instance.
+ *  @param chunks         Array of compressed chunks. Must hold @param n_chunks items.
+ *  @param n_chunks       Number of chunks.
+ *  @param out_serializer Serializer to write the data to.
+ */
+PRIVATE void _system_file_packer_write_index(const _system_file_packer*       packer_ptr,
+                                             const _system_file_packer_chunk* chunks,
+                                             uint32_t                         n_chunks,
+                                             system_file_serializer           out_serializer)
+{
+    const uint32_t chunk_size     = FILE_PACKER_CHUNK_SIZE;
+    const uint32_t format_magic   = SYSTEM_FILE_PACKER_FORMAT_MAGIC;
+    const uint32_t format_version = SYSTEM_FILE_PACKER_FORMAT_VERSION;
+    __uint64       data_offset    = 0;
+    uint32_t       n_files        = 0;
+
+    system_resizable_vector_get_property(packer_ptr->files,
+                                         SYSTEM_RESIZABLE_VECTOR_PROPERTY_N_ELEMENTS,
+                                        &n_files);
+
+    /* Header */
+    system_file_serializer_write(out_serializer,
+                                 sizeof(format_magic),
+                                &format_magic);
+    system_file_serializer_write(out_serializer,
+                                 sizeof(format_version),
+                                &format_version);
+    system_file_serializer_write(out_serializer,
+                                 sizeof(chunk_size),
+                                &chunk_size);
+    system_file_serializer_write(out_serializer,
+                                 sizeof(n_files),
+                                &n_files);
+    system_file_serializer_write(out_serializer,
+                                 sizeof(n_chunks),
+                                &n_chunks);
+    system_file_serializer_write(out_serializer,
+                                 sizeof(packer_ptr->total_filesize),
+                                &packer_ptr->total_filesize);
+
+    /* File table */
+    for (uint32_t n_file = 0;
+                  n_file < n_files;
+                ++n_file)
+    {
+        _system_file_packer_file* file_ptr        = NULL;
+        uint32_t                  filename_length = 0;
+
+        system_resizable_vector_get_element_at(packer_ptr->files,
+                                               n_file,
+                                              &file_ptr);
+
+        filename_length = system_hashed_ansi_string_get_length(file_ptr->filename);
+
+        system_file_serializer_write(out_serializer,
+                                     sizeof(filename_length),
+                                    &filename_length);
+        system_file_serializer_write(out_serializer,
+                                     filename_length,
+                                     system_hashed_ansi_string_get_buffer(file_ptr->filename) );
+        system_file_serializer_write(out_serializer,
+                                     sizeof(data_offset),
+                                    &data_offset);
+        system_file_serializer_write(out_serializer,
+                                     sizeof(file_ptr->filesize),
+                                    &file_ptr->filesize);
+        system_file_serializer_write(out_serializer,
+                                     sizeof(file_ptr->crc32),
+                                    &file_ptr->crc32);
+
+        data_offset += file_ptr->filesize;
+    } /* for (all files) */
+
+    /* Chunk table */
+    data_offset = 0;
+
+    for (uint32_t n_chunk = 0;
+                  n_chunk < n_chunks;
+                ++n_chunk)
+    {
+        system_file_serializer_write(out_serializer,
+                                     sizeof(data_offset),
+                                    &data_offset);
+        system_file_serializer_write(out_serializer,
+                                     sizeof(chunks[n_chunk].packed_size),
+                                    &chunks[n_chunk].packed_size);
+        system_file_serializer_write(out_serializer,
+                                     sizeof(chunks[n_chunk].unpacked_size),
+                                    &chunks[n_chunk].unpacked_size);
+
+        data_offset += chunks[n_chunk].packed_size;
+    } /* for (all chunks) */
 }
 
 /** Please see header for specification */
@@ -292,151 +485,132 @@ PUBLIC EMERALD_API void system_file_packer_release(system_file_packer packer)
 PUBLIC EMERALD_API bool system_file_packer_save(system_file_packer        packer,
                                                 system_hashed_ansi_string target_packed_filename)
 {
-    uint32_t                   file_table_size               = 0;
-    system_file_serializer     in_file_serializer            = NULL;
-    bool                       is_zlib_inited                = false;
-    uint32_t                   n_current_file                = 0;
-    uint32_t                   n_total_decoded_bytes         = 0;
-    system_file_serializer     out_file_serializer           = NULL;
-    const _system_file_packer* packer_ptr                    = (const _system_file_packer*) packer;
-    uint32_t                   n_files_to_pack               = 0;
-    bool                       result                        = true;
-    char*                      unpacked_buffer_traveller_ptr = NULL;
-    z_stream                   zlib_stream;
-
-    /* Set up output file serializer */
-    out_file_serializer = system_file_serializer_create_for_writing(target_packed_filename);
-
-    ASSERT_ALWAYS_SYNC(out_file_serializer != NULL,
-                       "Could not set up output file serializer.");
+    _system_file_packer_batch  batch;
+    unsigned char*             batch_data              = NULL;
+    _system_file_packer_chunk* chunks                  = NULL;
+    system_file_serializer     current_file_serializer = NULL;
+    uint32_t                   n_chunks                = 0;
+    uint32_t                   n_current_file          = 0;
+    system_file_serializer     out_file_serializer     = NULL;
+    _system_file_packer*       packer_ptr              = (_system_file_packer*) packer;
+    bool                       result                  = true;
 
-    /* Build a file table */
-    file_table_size = _system_file_packer_build_file_table(packer_ptr->files,
-                                                           INTERNAL_BUFFER_SIZE,
-                                                           packer_ptr->buffer_unpacked);
-
-    /* Initialize zlib */
-    zlib_stream.next_in = (Bytef*) packer_ptr->buffer_unpacked;
-    zlib_stream.opaque  = Z_NULL;
-    zlib_stream.zalloc  = Z_NULL;
-    zlib_stream.zfree   = Z_NULL;
+    ASSERT_DEBUG_SYNC(packer != NULL,
+                      "Input packer argument is NULL");
 
-    if (deflateInit(&zlib_stream,
-                    Z_DEFAULT_COMPRESSION) != Z_OK)
+    if ((packer_ptr->total_filesize + FILE_PACKER_CHUNK_SIZE - 1) / FILE_PACKER_CHUNK_SIZE > UINT32_MAX)
     {
-        ASSERT_DEBUG_SYNC(false,
-                          "zlib failed to initialize");
+        ASSERT_ALWAYS_SYNC(false,
+                           "Too much data to pack.");
 
         result = false;
         goto end;
     }
 
-    is_zlib_inited = true;
+    n_chunks   = (uint32_t) ((packer_ptr->total_filesize + FILE_PACKER_CHUNK_SIZE - 1) / FILE_PACKER_CHUNK_SIZE);
+    batch_data = new (std::nothrow) unsigned char[FILE_PACKER_N_CHUNKS_PER_BATCH * FILE_PACKER_CHUNK_SIZE];
+    chunks     = new (std::nothrow) _system_file_packer_chunk[(n_chunks > 0) ? n_chunks : 1];
 
-    /* Store total number of bytes in the decoded stream */
-    n_total_decoded_bytes = file_table_size + packer_ptr->total_filesize;
-
-    system_file_serializer_write(out_file_serializer,
-                                 sizeof(n_total_decoded_bytes),
-                                &n_total_decoded_bytes);
-
-    /* Start constructing input data for the result blob */
-    unpacked_buffer_traveller_ptr = packer_ptr->buffer_unpacked + file_table_size;
-
-    while (n_current_file < n_files_to_pack)
+    if (batch_data == NULL ||
+        chunks     == NULL)
     {
-        /* Retrieve file descriptor */
-        _system_file_packer_file* file_ptr = NULL;
-
-        system_resizable_vector_get_element_at(packer_ptr->files,
-                                               n_current_file,
-                                              &file_ptr);
-
-        ASSERT_DEBUG_SYNC(file_ptr != NULL,
-                          "File descriptor at index [%d] is NULL.",
-                          n_current_file);
-
-        /* Open the file and read as much data as:
-         *
-         * a) can fit within the block we have preallocated
-         * b) is available.
-         */
-        unsigned int n_bytes_available_for_writing = INTERNAL_BUFFER_SIZE - (unpacked_buffer_traveller_ptr - packer_ptr->buffer_unpacked);
-        unsigned int n_bytes_read                  = 0;
-        unsigned int n_bytes_to_read               = file_ptr->filesize;
-
-        in_file_serializer = system_file_serializer_create_for_reading(file_ptr->filename,
-                                                                       false); /* async_read - not needed */
+        ASSERT_ALWAYS_SYNC(false,
+                           "Out of memory");
 
-        ASSERT_ALWAYS_SYNC(in_file_serializer != NULL,
-                           "Could not spawn file serializer for file [%s]",
-                           system_hashed_ansi_string_get_buffer(file_ptr->filename) );
+        result = false;
+        goto end;
+    }
 
-        while (n_bytes_to_read != 0)
+    /* Read the files batch by batch and compress all chunks of each batch in parallel. File checksums are
+     * calculated while reading the data, so we need to compress everything before the index can be written out. */
+    for (uint32_t n_batch_chunk = 0;
+                  n_batch_chunk < n_chunks;
+                  n_batch_chunk += FILE_PACKER_N_CHUNKS_PER_BATCH)
+    {
+        const __uint64 batch_start_offset = (__uint64) n_batch_chunk * FILE_PACKER_CHUNK_SIZE;
+        const uint32_t n_batch_chunks     = (n_chunks - n_batch_chunk < FILE_PACKER_N_CHUNKS_PER_BATCH) ? (n_chunks - n_batch_chunk)
+                                                                                                        : FILE_PACKER_N_CHUNKS_PER_BATCH;
+
+        batch.chunks             = chunks + n_batch_chunk;
+        batch.n_failed_chunks    = 0;
+        batch.unpacked_data      = batch_data;
+        batch.unpacked_data_size = (packer_ptr->total_filesize - batch_start_offset < (__uint64) n_batch_chunks * FILE_PACKER_CHUNK_SIZE) ? (uint32_t) (packer_ptr->total_filesize - batch_start_offset)
+                                                                                                                                          : n_batch_chunks * FILE_PACKER_CHUNK_SIZE;
+
+        if (!_system_file_packer_read_batch_data(packer_ptr,
+                                                 batch.unpacked_data_size,
+                                                &n_current_file,
+                                                &current_file_serializer,
+                                                 batch_data) )
         {
-            const unsigned int n_remaining_bytes_to_read = file_ptr->filesize - n_bytes_read;
+            result = false;
+            goto end;
+        }
 
-            n_bytes_to_read = (n_remaining_bytes_to_read > n_bytes_available_for_writing) ? n_bytes_available_for_writing
-                                                                                          : n_remaining_bytes_to_read;
+        system_thread_pool_parallel_for(0, /* range_start */
+                                        n_batch_chunks,
+                                        1, /* grain_size */
+                                        _system_file_packer_compress_chunks,
+                                       &batch);
 
-            if (!system_file_serializer_read(in_file_serializer,
-                                             n_bytes_to_read,
-                                             unpacked_buffer_traveller_ptr) )
-            {
-                ASSERT_ALWAYS_SYNC(false,
-                                   "Could not read [%d] bytes from [%s].",
-                                   n_bytes_to_read,
-                                   system_hashed_ansi_string_get_buffer(file_ptr->filename) );
-            }
+        if (batch.n_failed_chunks != 0)
+        {
+            result = false;
+            goto end;
+        }
+    } /* for (all batches) */
 
-            unpacked_buffer_traveller_ptr += n_bytes_to_read;
+    /* Store the index, followed by the compressed data */
+    out_file_serializer = system_file_serializer_create_for_writing(target_packed_filename);
 
-            /* Pack the data buffer and stream the result data out to the serializer */
-            zlib_stream.avail_in = unpacked_buffer_traveller_ptr - packer_ptr->buffer_unpacked;
+    ASSERT_ALWAYS_SYNC(out_file_serializer != NULL,
+                       "Could not set up output file serializer.");
 
-            do
-            {
-                int deflate_result = 0;
+    _system_file_packer_write_index(packer_ptr,
+                                    chunks,
+                                    n_chunks,
+                                    out_file_serializer);
 
-                zlib_stream.avail_out = INTERNAL_BUFFER_SIZE;
-                zlib_stream.next_out  = (Bytef*) packer_ptr->buffer_packed;
+    for (uint32_t n_chunk = 0;
+                  n_chunk < n_chunks;
+                ++n_chunk)
+    {
+        if (!system_file_serializer_write(out_file_serializer,
+                                          chunks[n_chunk].packed_size,
+                                          chunks[n_chunk].packed_data) )
+        {
+            ASSERT_ALWAYS_SYNC(false,
+                               "Could not write [%d] bytes to result packed file.",
+                               chunks[n_chunk].packed_size);
 
-                deflate_result = deflate(&zlib_stream,
-                                         (((n_remaining_bytes_to_read - n_bytes_to_read) == 0) &&
-                                           (n_current_file                               == (n_files_to_pack - 1) )) ? Z_FINISH : Z_NO_FLUSH);
+            result = false;
+            goto end;
+        }
+    } /* for (all chunks) */
 
-                ASSERT_DEBUG_SYNC(deflate_result != Z_STREAM_ERROR,
-                                  "deflate() failed.");
+    /* All done */
+end:
+    if (batch_data != NULL)
+    {
+        delete [] batch_data;
 
-                if (!system_file_serializer_write(out_file_serializer,
-                                                  INTERNAL_BUFFER_SIZE - zlib_stream.avail_out,
-                                                  packer_ptr->buffer_packed) )
-                {
-                    ASSERT_ALWAYS_SYNC(false,
-                                       "Could not write [%d] bytes to result packed file.",
-                                       INTERNAL_BUFFER_SIZE - zlib_stream.avail_out);
-                }
+        batch_data = NULL;
+    }
 
-            }
-            while (zlib_stream.avail_out == 0);
+    if (chunks != NULL)
+    {
+        delete [] chunks;
 
-            /* Update the helper variables */
-            n_bytes_available_for_writing  = INTERNAL_BUFFER_SIZE;
-            n_bytes_read                  += n_bytes_to_read;
-            n_bytes_to_read                = file_ptr->filesize - n_bytes_read;
-            unpacked_buffer_traveller_ptr  = packer_ptr->buffer_unpacked;
-            zlib_stream.next_in            = (Bytef*) packer_ptr->buffer_unpacked;
-        } /* while (n_bytes_read != n_bytes_to_read) */
+        chunks = NULL;
+    }
 
-        /* Move to the next file */
-        system_file_serializer_release(in_file_serializer);
-        in_file_serializer = NULL;
+    if (current_file_serializer != NULL)
+    {
+        system_file_serializer_release(current_file_serializer);
 
-        ++n_current_file;
-    } /* while (n_current_file < n_files_to_pack) */
+        current_file_serializer = NULL;
+    }
 
-    /* All done */
-end:
     if (out_file_serializer != NULL)
     {
         system_file_serializer_release(out_file_serializer);
@@ -444,10 +618,5 @@ end:
         out_file_serializer = NULL;
     }
 
-    if (is_zlib_inited)
-    {
-        deflateEnd(&zlib_stream);
-    }
-
     return result;
 }
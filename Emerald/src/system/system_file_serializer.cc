@@ -18,6 +18,7 @@
 
 #ifdef __linux
     #include <fcntl.h>
+    #include <sys/mman.h>
     #include <sys/stat.h>
     #include <sys/types.h>
     #include <unistd.h>
@@ -27,6 +28,7 @@
 typedef enum
 {
     SYSTEM_FILE_SERIALIZER_TYPE_FILE,
+    SYSTEM_FILE_SERIALIZER_TYPE_MAPPED_FILE,
     SYSTEM_FILE_SERIALIZER_TYPE_MEMORY_REGION
 
 } _system_file_serializer_type;
@@ -41,6 +43,7 @@ typedef struct
 {
 #ifdef _WIN32
     HANDLE                       file_handle;
+    HANDLE                       file_mapping_handle;    /* mapped file reading only */
 #else
     int                          file_handle;
 #endif
@@ -59,6 +62,7 @@ typedef struct
 } _system_file_serializer;
 
 /* Forward declarations */
+PRIVATE                          void _system_file_serializer_init_file_path         (_system_file_serializer*             serializer_ptr);
 PRIVATE THREAD_POOL_TASK_HANDLER void _system_file_serializer_read_task_executor     (system_thread_pool_callback_argument argument);
 PRIVATE                          void _system_file_serializer_release                (void*                                serializer);
 PRIVATE                          void _system_file_serializer_write_down_data_to_file(_system_file_serializer*             serializer_ptr);
@@ -69,6 +73,202 @@ REFCOUNT_INSERT_IMPLEMENTATION(system_file_serializer,
                               _system_file_serializer);
 
 
+/** Determines the path to the file the serializer has been created for, and stores it in the
+ *  file_path field.
+ *
+ *  @param serializer_ptr Serializer instance to use.
+ */
+PRIVATE void _system_file_serializer_init_file_path(_system_file_serializer* serializer_ptr)
+{
+#ifdef _WIN32
+    DWORD path_length_wo_terminator = ::GetFullPathName(system_hashed_ansi_string_get_buffer(serializer_ptr->file_name),
+                                                        0,     /* nBufferLength */
+                                                        NULL,  /* lpBuffer */
+                                                        NULL); /* lpFilePart */
+    char* path                      = new (std::nothrow) char[path_length_wo_terminator + 1];
+
+    ASSERT_ALWAYS_SYNC(path != NULL,
+                       "Out of memory");
+
+    if (path != NULL)
+    {
+        char* file_inside_path = NULL;
+
+        memset(path,
+               0,
+               path_length_wo_terminator + 1);
+
+        ::GetFullPathName(system_hashed_ansi_string_get_buffer(serializer_ptr->file_name),
+                          path_length_wo_terminator + 1,
+                          path,
+                          &file_inside_path);
+
+        path[file_inside_path - path] = 0;
+
+        serializer_ptr->file_path = system_hashed_ansi_string_create(path);
+    }
+
+    delete [] path;
+    path = NULL;
+#else
+    char* file_path = realpath(system_hashed_ansi_string_get_buffer(serializer_ptr->file_name),
+                               NULL); /* resolved_path */
+
+    ASSERT_DEBUG_SYNC(file_path != NULL,
+                      "Could not determine file path for the file [%s]",
+                      system_hashed_ansi_string_get_buffer(serializer_ptr->file_name) );
+
+    if (file_path != NULL)
+    {
+        /* Find the last / character and put the terminator right after it */
+        char* file_path_last_slash = strrchr(file_path, '/');
+
+        ASSERT_DEBUG_SYNC(file_path_last_slash != NULL,
+                          "Could not find the slash character in the file path for file [%s]",
+                          system_hashed_ansi_string_get_buffer(file_path) );
+
+        *(file_path_last_slash + 1) = 0;
+
+        serializer_ptr->file_path = system_hashed_ansi_string_create(file_path);
+
+        free(file_path);
+        file_path = NULL;
+    }
+#endif
+}
+
+/** Maps the file the serializer has been created for into the process' address space. The contents field
+ *  is set to point to the beginning of the view. Pages are read from the disk on first access.
+ *
+ *  @param serializer_ptr Serializer instance to use.
+ *
+ *  @return true if successful, false otherwise.
+ */
+PRIVATE bool _system_file_serializer_map_file(_system_file_serializer* serializer_ptr)
+{
+    bool result = false;
+
+#ifdef _WIN32
+    LARGE_INTEGER file_size;
+
+    serializer_ptr->file_handle = ::CreateFile(system_hashed_ansi_string_get_buffer(serializer_ptr->file_name),
+                                               GENERIC_READ,
+                                               FILE_SHARE_READ,
+                                               NULL,                         /* no specific security attributes */
+                                               OPEN_EXISTING,                /* only open an existing file */
+                                               FILE_FLAG_SEQUENTIAL_SCAN,
+                                               NULL);                        /* no template file */
+
+    if (serializer_ptr->file_handle == file_handle_invalid)
+    {
+        goto end;
+    }
+
+    if (!::GetFileSizeEx(serializer_ptr->file_handle,
+                        &file_size) ||
+        file_size.HighPart != 0)
+    {
+        ASSERT_DEBUG_SYNC(false,
+                          "Could not retrieve file size, or the file is too large to map.");
+
+        goto end;
+    }
+
+    serializer_ptr->file_size = file_size.LowPart;
+
+    if (serializer_ptr->file_size != 0)
+    {
+        serializer_ptr->file_mapping_handle = ::CreateFileMapping(serializer_ptr->file_handle,
+                                                                  NULL,          /* no specific security attributes */
+                                                                  PAGE_READONLY,
+                                                                  0,             /* dwMaximumSizeHigh - use file size */
+                                                                  0,             /* dwMaximumSizeLow  - use file size */
+                                                                  NULL);         /* no name */
+
+        if (serializer_ptr->file_mapping_handle == NULL)
+        {
+            goto end;
+        }
+
+        serializer_ptr->contents = (char*) ::MapViewOfFile(serializer_ptr->file_mapping_handle,
+                                                           FILE_MAP_READ,
+                                                           0,  /* dwFileOffsetHigh */
+                                                           0,  /* dwFileOffsetLow  */
+                                                           0); /* map the whole file */
+
+        if (serializer_ptr->contents == NULL)
+        {
+            goto end;
+        }
+    }
+
+    result = true;
+#else
+    struct stat file_info;
+
+    serializer_ptr->file_handle = open(system_hashed_ansi_string_get_buffer(serializer_ptr->file_name),
+                                       O_RDONLY,
+                                       0); /* mode - not used */
+
+    if (serializer_ptr->file_handle == file_handle_invalid)
+    {
+        goto end;
+    }
+
+    if (fstat(serializer_ptr->file_handle,
+             &file_info) != 0                       ||
+        (__uint64) file_info.st_size > UINT32_MAX)
+    {
+        ASSERT_DEBUG_SYNC(false,
+                          "Could not retrieve file info structure, or the file is too large to map.");
+
+        goto end;
+    }
+
+    serializer_ptr->file_size = (uint32_t) file_info.st_size;
+
+    if (serializer_ptr->file_size != 0)
+    {
+        void* mapping_ptr = mmap(NULL, /* addr */
+                                 serializer_ptr->file_size,
+                                 PROT_READ,
+                                 MAP_PRIVATE,
+                                 serializer_ptr->file_handle,
+                                 0);   /* offset */
+
+        if (mapping_ptr == MAP_FAILED)
+        {
+            goto end;
+        }
+
+        /* Files are usually parsed front to back, exactly once. Let the kernel read ahead aggressively
+         * and drop pages which have already been parsed under memory pressure. */
+        madvise(mapping_ptr,
+                serializer_ptr->file_size,
+                MADV_SEQUENTIAL);
+
+        serializer_ptr->contents = (char*) mapping_ptr;
+    }
+
+    /* The mapping stays valid after the descriptor is closed */
+    close(serializer_ptr->file_handle);
+
+    serializer_ptr->file_handle = file_handle_invalid;
+    result                      = true;
+#endif
+
+end:
+    if (!result)
+    {
+        LOG_ERROR("File %s could not have been mapped for reading",
+                  system_hashed_ansi_string_get_buffer(serializer_ptr->file_name) );
+
+        serializer_ptr->file_size = 0;
+    }
+
+    return result;
+}
+
 /** Function that reads the file and sets the internal event, so that normal function can make full use of the read data.
  *
  *  @param argument Pointer to _system_file_serializer instance.
@@ -126,12 +326,15 @@ PRIVATE THREAD_POOL_TASK_HANDLER void _system_file_serializer_read_task_executor
         serializer_ptr->file_size = file_info.st_size;
 #endif
 
-        /* Allocate a buffer to hold the file contents */
+        /* Allocate a buffer to hold the file contents. The extra byte holds a terminator, so that
+         * text files can be parsed directly off the raw storage. The rest of the buffer is going to
+         * be overwritten by the read op, so there's no need to clear it. */
         serializer_ptr->contents = new (std::nothrow) char[serializer_ptr->file_size + 1];
 
-        memset(serializer_ptr->contents,
-               0,
-               serializer_ptr->file_size + 1);
+        ASSERT_ALWAYS_SYNC(serializer_ptr->contents != NULL,
+                           "Out of memory");
+
+        serializer_ptr->contents[serializer_ptr->file_size] = 0;
 
         /* Read the contents. */
 #ifdef _WIN32
@@ -181,61 +384,7 @@ PRIVATE THREAD_POOL_TASK_HANDLER void _system_file_serializer_read_task_executor
                  system_hashed_ansi_string_get_buffer(serializer_ptr->file_name) );
 
         /* Now retrieve path to the file */
-#ifdef _WIN32
-        DWORD path_length_wo_terminator = ::GetFullPathName(system_hashed_ansi_string_get_buffer(serializer_ptr->file_name),
-                                                            0,     /* nBufferLength */
-                                                            NULL,  /* lpBuffer */
-                                                            NULL); /* lpFilePart */
-        char* path                      = new (std::nothrow) char[path_length_wo_terminator + 1];
-
-        ASSERT_ALWAYS_SYNC(path != NULL,
-                           "Out of memory");
-
-        if (path != NULL)
-        {
-            char* file_inside_path = NULL;
-
-            memset(path,
-                   0,
-                   path_length_wo_terminator + 1);
-
-            ::GetFullPathName(system_hashed_ansi_string_get_buffer(serializer_ptr->file_name),
-                              path_length_wo_terminator + 1,
-                              path,
-                              &file_inside_path);
-
-            path[file_inside_path - path] = 0;
-
-            serializer_ptr->file_path = system_hashed_ansi_string_create(path);
-        }
-
-        delete [] path;
-        path = NULL;
-#else
-    char* file_path = realpath(system_hashed_ansi_string_get_buffer(serializer_ptr->file_name),
-                               NULL); /* resolved_path */
-
-    ASSERT_DEBUG_SYNC(file_path != NULL,
-                      "Could not determine file path for the file [%s]",
-                      system_hashed_ansi_string_get_buffer(serializer_ptr->file_name) );
-
-    if (file_path != NULL)
-    {
-        /* Find the last / character and put the terminator right after it */
-        char* file_path_last_slash = strrchr(file_path, '/');
-
-        ASSERT_DEBUG_SYNC(file_path_last_slash != NULL,
-                          "Could not find the slash character in the file path for file [%s]",
-                          system_hashed_ansi_string_get_buffer(file_path) );
-
-        *(file_path_last_slash + 1) = 0;
-
-        serializer_ptr->file_path = system_hashed_ansi_string_create(file_path);
-
-        free(file_path);
-        file_path = NULL;
-    }
-#endif
+        _system_file_serializer_init_file_path(serializer_ptr);
     }
 
     /* Set the event so that cache-based functions can follow. */
@@ -261,6 +410,40 @@ PRIVATE void _system_file_serializer_release(void* serializer)
 
             serializer_ptr->contents = NULL;
         }
+        else
+        if (serializer_ptr->type == SYSTEM_FILE_SERIALIZER_TYPE_MAPPED_FILE)
+        {
+#ifdef _WIN32
+            if (serializer_ptr->contents != NULL)
+            {
+                ::UnmapViewOfFile(serializer_ptr->contents);
+            }
+
+            if (serializer_ptr->file_mapping_handle != NULL)
+            {
+                ::CloseHandle(serializer_ptr->file_mapping_handle);
+            }
+
+            if (serializer_ptr->file_handle != file_handle_invalid)
+            {
+                ::CloseHandle(serializer_ptr->file_handle);
+            }
+#else
+            if (serializer_ptr->contents != NULL)
+            {
+                munmap(serializer_ptr->contents,
+                       serializer_ptr->file_size);
+            }
+
+            if (serializer_ptr->file_handle != file_handle_invalid)
+            {
+                close(serializer_ptr->file_handle);
+            }
+#endif
+
+            serializer_ptr->contents    = NULL;
+            serializer_ptr->file_handle = file_handle_invalid;
+        }
     }
     else
     {
@@ -438,6 +621,43 @@ PUBLIC EMERALD_API system_file_serializer system_file_serializer_create_for_read
     return (system_file_serializer) serializer_ptr;
 }
 
+/** Please see header file for specification */
+PUBLIC EMERALD_API system_file_serializer system_file_serializer_create_for_reading_mapped_file(system_hashed_ansi_string file_name)
+{
+    _system_file_serializer* serializer_ptr = new _system_file_serializer;
+
+    serializer_ptr->contents               = NULL;
+    serializer_ptr->current_index          = 0;
+    serializer_ptr->file_handle            = file_handle_invalid;
+    serializer_ptr->file_name              = file_name;
+    serializer_ptr->file_path              = NULL;
+    serializer_ptr->file_size              = 0;
+    serializer_ptr->for_reading            = true;
+    serializer_ptr->reading_finished_event = system_event_create(true); /* manual_reset */
+    serializer_ptr->type                   = SYSTEM_FILE_SERIALIZER_TYPE_MAPPED_FILE;
+
+#ifdef _WIN32
+    serializer_ptr->file_mapping_handle = NULL;
+#endif
+
+    REFCOUNT_INSERT_INIT_CODE_WITH_RELEASE_HANDLER(serializer_ptr,
+                                                   _system_file_serializer_release,
+                                                   OBJECT_TYPE_SYSTEM_FILE_SERIALIZER,
+                                                   system_hashed_ansi_string_create_by_merging_two_strings("\\File Serializers\\",
+                                                                                                           system_hashed_ansi_string_get_buffer(file_name) ) );
+
+    /* Mapping a file is cheap, since no data is read at this point. There is no need to defer it
+     * to a thread pool thread. */
+    if (_system_file_serializer_map_file(serializer_ptr) )
+    {
+        _system_file_serializer_init_file_path(serializer_ptr);
+    }
+
+    system_event_set(serializer_ptr->reading_finished_event);
+
+    return (system_file_serializer) serializer_ptr;
+}
+
 /** Please see header file for specification */
 PUBLIC EMERALD_API system_file_serializer system_file_serializer_create_for_writing(system_hashed_ansi_string file_name)
 {
@@ -534,6 +754,13 @@ PUBLIC EMERALD_API void system_file_serializer_get_property(system_file_serializ
             break;
         }
 
+        case SYSTEM_FILE_SERIALIZER_PROPERTY_IS_MAPPED:
+        {
+            *(bool*) out_data = (serializer_ptr->type == SYSTEM_FILE_SERIALIZER_TYPE_MAPPED_FILE);
+
+            break;
+        }
+
         case SYSTEM_FILE_SERIALIZER_PROPERTY_RAW_STORAGE:
         {
             ASSERT_DEBUG_SYNC(serializer_ptr->for_reading,
@@ -604,6 +831,35 @@ PUBLIC EMERALD_API bool system_file_serializer_read(system_file_serializer seria
     return result;
 }
 
+/** Please see header file for specification */
+PUBLIC EMERALD_API bool system_file_serializer_read_no_copy(system_file_serializer serializer,
+                                                            uint32_t               n_bytes,
+                                                            const void**           out_data_ptr)
+{
+    bool                     result         = false;
+    _system_file_serializer* serializer_ptr = (_system_file_serializer*) serializer;
+
+    if (serializer_ptr->for_reading)
+    {
+        system_event_wait_single(serializer_ptr->reading_finished_event);
+
+        if (serializer_ptr->current_index + n_bytes <= serializer_ptr->file_size)
+        {
+            *out_data_ptr = serializer_ptr->contents + serializer_ptr->current_index;
+
+            serializer_ptr->current_index += n_bytes;
+            result                         = true;
+        }
+    }
+
+    if (!result)
+    {
+        LOG_ERROR("Reading operation failed");
+    }
+
+    return result;
+}
+
 /* Please see header file for specification */
 PUBLIC EMERALD_API bool system_file_serializer_read_curve_container(system_file_serializer    serializer,
                                                                     system_hashed_ansi_string object_manager_path,
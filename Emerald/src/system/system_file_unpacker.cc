@@ -4,38 +4,80 @@
  *
  */
 #include "shared.h"
+#include "system/system_atomics.h"
+#include "system/system_constants.h"
+#include "system/system_critical_section.h"
+#include "system/system_file_packer.h"
 #include "system/system_file_serializer.h"
 #include "system/system_file_unpacker.h"
 #include "system/system_global.h"
+#include "system/system_log.h"
 #include "system/system_resizable_vector.h"
+#include "system/system_thread_pool.h"
+#include <string.h>
 #include <zlib.h>
 
 
+typedef struct _system_file_unpacker_cached_chunk
+{
+    unsigned char* data;
+    uint32_t       n_chunk;
+} _system_file_unpacker_cached_chunk;
+
+typedef struct _system_file_unpacker_chunk
+{
+    const unsigned char* packed_data;
+    uint32_t             packed_size;
+    uint32_t             unpacked_size;
+} _system_file_unpacker_chunk;
+
 typedef struct _system_file_unpacker_file
 {
-    void*                     data;              /* points at a certain offset within unpacker::unpacked_buffer_ptr */
-    uint32_t                  data_start_offset; /* used during unpacker initialization */
+    uint32_t                  crc32;             /* v2 only */
+    system_critical_section   cs;                /* v2 only: serializes unpacking of the file */
+    void*                     data;              /* v1: points at a certain offset within unpacker::unpacked_buffer_ptr.
+                                                  * v2: owned by the descriptor. NULL until the file is unpacked. */
+    __uint64                  data_start_offset; /* offset within the unpacked data stream */
     system_hashed_ansi_string filename;
     uint32_t                  filesize;
+    bool                      owns_data;
     system_file_serializer    serializer;
 
     explicit _system_file_unpacker_file(system_hashed_ansi_string in_filename)
     {
+        crc32             = 0;
+        cs                = NULL;
         data              = NULL;
         data_start_offset = 0;
         filename          = in_filename;
         filesize          = 0;
+        owns_data         = false;
         serializer        = NULL;
     }
 
     ~_system_file_unpacker_file()
     {
+        if (cs != NULL)
+        {
+            system_critical_section_release(cs);
+
+            cs = NULL;
+        }
+
         if (serializer != NULL)
         {
             system_file_serializer_release(serializer);
 
             serializer = NULL;
         }
+
+        if (owns_data     &&
+            data != NULL)
+        {
+            delete [] (unsigned char*) data;
+
+            data = NULL;
+        }
     }
 } _system_file_unpacker_file;
 
@@ -43,18 +85,65 @@ typedef struct _system_file_unpacker
 {
     system_resizable_vector   files; /* _system_file_unpacker_file* */
     system_hashed_ansi_string packed_filename;
-    unsigned char*            unpacked_buffer_ptr;
+    unsigned char*            unpacked_buffer_ptr; /* v1 only */
+
+    /* v2 only. Cached chunks are sorted by the time of last use, starting from the most recently used one. */
+    _system_file_unpacker_cached_chunk cached_chunks[FILE_UNPACKER_N_CACHED_CHUNKS];
+    system_critical_section            cached_chunks_cs;
+    uint32_t                           chunk_size;
+    _system_file_unpacker_chunk*       chunks;
+    uint32_t                           n_chunks;
+    system_file_serializer             packed_file_serializer;
 
     explicit _system_file_unpacker(system_hashed_ansi_string in_packed_filename)
     {
-        files               = system_resizable_vector_create(4,     /* capacity */
-                                                             true); /* should_be_thread_safe */
-        packed_filename     = in_packed_filename;
-        unpacked_buffer_ptr = NULL;
+        cached_chunks_cs       = system_critical_section_create();
+        chunk_size             = 0;
+        chunks                 = NULL;
+        files                  = system_resizable_vector_create(4,     /* capacity */
+                                                                true); /* should_be_thread_safe */
+        n_chunks               = 0;
+        packed_filename        = in_packed_filename;
+        packed_file_serializer = NULL;
+        unpacked_buffer_ptr    = NULL;
+
+        for (uint32_t n_cached_chunk = 0;
+                      n_cached_chunk < FILE_UNPACKER_N_CACHED_CHUNKS;
+                    ++n_cached_chunk)
+        {
+            cached_chunks[n_cached_chunk].data    = NULL;
+            cached_chunks[n_cached_chunk].n_chunk = UINT32_MAX;
+        }
     }
 
     ~_system_file_unpacker()
     {
+        for (uint32_t n_cached_chunk = 0;
+                      n_cached_chunk < FILE_UNPACKER_N_CACHED_CHUNKS;
+                    ++n_cached_chunk)
+        {
+            if (cached_chunks[n_cached_chunk].data != NULL)
+            {
+                delete [] cached_chunks[n_cached_chunk].data;
+
+                cached_chunks[n_cached_chunk].data = NULL;
+            }
+        }
+
+        if (cached_chunks_cs != NULL)
+        {
+            system_critical_section_release(cached_chunks_cs);
+
+            cached_chunks_cs = NULL;
+        }
+
+        if (chunks != NULL)
+        {
+            delete [] chunks;
+
+            chunks = NULL;
+        }
+
         if (files != NULL)
         {
             _system_file_unpacker_file* file_ptr = NULL;
@@ -72,6 +161,15 @@ typedef struct _system_file_unpacker
             files = NULL;
         } /* if (files != NULL) */
 
+        /* Chunk data pointers point at the mapped pack file, so the serializer must only be released
+         * after all files are gone. */
+        if (packed_file_serializer != NULL)
+        {
+            system_file_serializer_release(packed_file_serializer);
+
+            packed_file_serializer = NULL;
+        }
+
         if (unpacked_buffer_ptr != NULL)
         {
             delete [] unpacked_buffer_ptr;
@@ -81,9 +179,313 @@ typedef struct _system_file_unpacker
     }
 } _system_file_unpacker;
 
+typedef struct _system_file_unpacker_unpack_file_task
+{
+    _system_file_unpacker_file* file_ptr;
+    volatile unsigned int       n_failed_chunks;
+    _system_file_unpacker*      unpacker_ptr;
+} _system_file_unpacker_unpack_file_task;
 
-/** TODO */
-PRIVATE bool _system_file_unpacker_init(_system_file_unpacker* file_unpacker_ptr)
+
+/** Decompresses a single chunk of a v2 packed file.
+ *
+ *  @param unpacker_ptr Unpacker instance.
+ *  @param n_chunk      Index of the chunk to decompress.
+ *  @param out_data     Buffer to store the decompressed data in. Must be able to hold chunk's unpacked_size bytes.
+ *
+ *  @return true if successful, false otherwise.
+ */
+PRIVATE bool _system_file_unpacker_inflate_chunk(const _system_file_unpacker* unpacker_ptr,
+                                                 uint32_t                     n_chunk,
+                                                 unsigned char*               out_data)
+{
+    const _system_file_unpacker_chunk* chunk_ptr     = unpacker_ptr->chunks + n_chunk;
+    uLongf                             unpacked_size = chunk_ptr->unpacked_size;
+    bool                               result        = true;
+
+    if (uncompress(out_data,
+                  &unpacked_size,
+                   chunk_ptr->packed_data,
+                   chunk_ptr->packed_size) != Z_OK ||
+        unpacked_size                      != chunk_ptr->unpacked_size)
+    {
+        LOG_ERROR("Could not decompress chunk [%d] of packed file [%s]",
+                  n_chunk,
+                  system_hashed_ansi_string_get_buffer(unpacker_ptr->packed_filename) );
+
+        result = false;
+    }
+
+    return result;
+}
+
+/** Copies a part of a chunk's decompressed data to the specified buffer. The chunk is taken from the
+ *  unpacker's LRU cache. If the chunk is not cached, it is decompressed and then stored in the cache.
+ *
+ *  Used for chunks which hold data of more than one file.
+ *
+ *  @param unpacker_ptr Unpacker instance.
+ *  @param n_chunk      Index of the chunk to use.
+ *  @param offset       Offset within the chunk's decompressed data to start copying from.
+ *  @param n_bytes      Number of bytes to copy.
+ *  @param out_data     Buffer to copy the data to.
+ *
+ *  @return true if successful, false otherwise.
+ */
+PRIVATE bool _system_file_unpacker_copy_cached_chunk_data(_system_file_unpacker* unpacker_ptr,
+                                                          uint32_t               n_chunk,
+                                                          uint32_t               offset,
+                                                          uint32_t               n_bytes,
+                                                          unsigned char*         out_data)
+{
+    _system_file_unpacker_cached_chunk* cached_chunks = unpacker_ptr->cached_chunks;
+    unsigned char*                      chunk_data    = NULL;
+    uint32_t                            n_cached_chunk;
+    bool                                result        = true;
+
+    system_critical_section_enter(unpacker_ptr->cached_chunks_cs);
+    {
+        for (n_cached_chunk = 0;
+             n_cached_chunk < FILE_UNPACKER_N_CACHED_CHUNKS;
+           ++n_cached_chunk)
+        {
+            if (cached_chunks[n_cached_chunk].n_chunk == n_chunk)
+            {
+                break;
+            }
+        } /* for (all cached chunks) */
+
+        if (n_cached_chunk < FILE_UNPACKER_N_CACHED_CHUNKS)
+        {
+            /* Cache hit. Move the entry to the front of the list. */
+            chunk_data = cached_chunks[n_cached_chunk].data;
+
+            memcpy(out_data,
+                   chunk_data + offset,
+                   n_bytes);
+
+            memmove(cached_chunks + 1,
+                    cached_chunks,
+                    sizeof(_system_file_unpacker_cached_chunk) * n_cached_chunk);
+
+            cached_chunks[0].data    = chunk_data;
+            cached_chunks[0].n_chunk = n_chunk;
+        }
+    }
+    system_critical_section_leave(unpacker_ptr->cached_chunks_cs);
+
+    if (chunk_data != NULL)
+    {
+        goto end;
+    }
+
+    /* Cache miss. Decompress the chunk without holding the lock, so that other threads can carry on. */
+    chunk_data = new (std::nothrow) unsigned char[unpacker_ptr->chunks[n_chunk].unpacked_size];
+
+    if (chunk_data == NULL)
+    {
+        ASSERT_ALWAYS_SYNC(false,
+                           "Out of memory");
+
+        result = false;
+        goto end;
+    }
+
+    if (!_system_file_unpacker_inflate_chunk(unpacker_ptr,
+                                             n_chunk,
+                                             chunk_data) )
+    {
+        delete [] chunk_data;
+
+        result = false;
+        goto end;
+    }
+
+    memcpy(out_data,
+           chunk_data + offset,
+           n_bytes);
+
+    system_critical_section_enter(unpacker_ptr->cached_chunks_cs);
+    {
+        /* Another thread may have cached the same chunk in the meantime. */
+        for (n_cached_chunk = 0;
+             n_cached_chunk < FILE_UNPACKER_N_CACHED_CHUNKS;
+           ++n_cached_chunk)
+        {
+            if (cached_chunks[n_cached_chunk].n_chunk == n_chunk)
+            {
+                break;
+            }
+        } /* for (all cached chunks) */
+
+        if (n_cached_chunk < FILE_UNPACKER_N_CACHED_CHUNKS)
+        {
+            delete [] chunk_data;
+        }
+        else
+        {
+            /* Evict the least recently used chunk and store the new one at the front of the list */
+            unsigned char* evicted_chunk_data = cached_chunks[FILE_UNPACKER_N_CACHED_CHUNKS - 1].data;
+
+            memmove(cached_chunks + 1,
+                    cached_chunks,
+                    sizeof(_system_file_unpacker_cached_chunk) * (FILE_UNPACKER_N_CACHED_CHUNKS - 1) );
+
+            cached_chunks[0].data    = chunk_data;
+            cached_chunks[0].n_chunk = n_chunk;
+
+            if (evicted_chunk_data != NULL)
+            {
+                delete [] evicted_chunk_data;
+            }
+        }
+    }
+    system_critical_section_leave(unpacker_ptr->cached_chunks_cs);
+
+end:
+    return result;
+}
+
+/** Decompresses a range of chunks holding data of a single file. Called back from the thread pool.
+ *
+ *  Chunks which only hold data of the file are decompressed directly into the file's buffer. Chunks
+ *  shared with other files go through the unpacker's chunk cache.
+ *
+ *  @param range_start Index of the first chunk to decompress.
+ *  @param range_end   Index of the chunk, at which the decompression should stop.
+ *  @param user_arg    Task descriptor (_system_file_unpacker_unpack_file_task*).
+ */
+PRIVATE void _system_file_unpacker_unpack_file_chunks(uint32_t range_start,
+                                                      uint32_t range_end,
+                                                      void*    user_arg)
+{
+    _system_file_unpacker_unpack_file_task* task_ptr     = (_system_file_unpacker_unpack_file_task*) user_arg;
+    _system_file_unpacker_file*             file_ptr     = task_ptr->file_ptr;
+    _system_file_unpacker*                  unpacker_ptr = task_ptr->unpacker_ptr;
+
+    for (uint32_t n_chunk = range_start;
+                  n_chunk < range_end;
+                ++n_chunk)
+    {
+        const __uint64 chunk_start_offset = (__uint64) n_chunk * unpacker_ptr->chunk_size;
+        const __uint64 chunk_end_offset   = chunk_start_offset + unpacker_ptr->chunks[n_chunk].unpacked_size;
+        const __uint64 file_end_offset    = file_ptr->data_start_offset + file_ptr->filesize;
+        const __uint64 copy_start_offset  = (chunk_start_offset > file_ptr->data_start_offset) ? chunk_start_offset : file_ptr->data_start_offset;
+        const __uint64 copy_end_offset    = (chunk_end_offset   < file_end_offset)             ? chunk_end_offset   : file_end_offset;
+        unsigned char* out_data_ptr       = (unsigned char*) file_ptr->data + (copy_start_offset - file_ptr->data_start_offset);
+        bool           result;
+
+        if (copy_start_offset == chunk_start_offset &&
+            copy_end_offset   == chunk_end_offset)
+        {
+            result = _system_file_unpacker_inflate_chunk(unpacker_ptr,
+                                                         n_chunk,
+                                                         out_data_ptr);
+        }
+        else
+        {
+            result = _system_file_unpacker_copy_cached_chunk_data(unpacker_ptr,
+                                                                  n_chunk,
+                                                                  (uint32_t) (copy_start_offset - chunk_start_offset),
+                                                                  (uint32_t) (copy_end_offset   - copy_start_offset),
+                                                                  out_data_ptr);
+        }
+
+        if (!result)
+        {
+            system_atomics_increment(&task_ptr->n_failed_chunks);
+        }
+    } /* for (all chunks in the range) */
+}
+
+/** Decompresses a single file stored in a v2 packed file and verifies its checksum. Chunks of the file are
+ *  decompressed in parallel. Must be called with the file's critical section entered.
+ *
+ *  @param unpacker_ptr Unpacker instance.
+ *  @param file_ptr     File to unpack.
+ *
+ *  @return true if successful, false otherwise.
+ */
+PRIVATE bool _system_file_unpacker_unpack_file(_system_file_unpacker*      unpacker_ptr,
+                                               _system_file_unpacker_file* file_ptr)
+{
+    uint32_t                               file_crc32;
+    bool                                   result = true;
+    _system_file_unpacker_unpack_file_task task;
+
+    ASSERT_DEBUG_SYNC(file_ptr->data == NULL,
+                      "File [%s] has already been unpacked.",
+                      system_hashed_ansi_string_get_buffer(file_ptr->filename) );
+
+    file_ptr->data      = new (std::nothrow) unsigned char[(file_ptr->filesize > 0) ? file_ptr->filesize : 1];
+    file_ptr->owns_data = true;
+
+    if (file_ptr->data == NULL)
+    {
+        ASSERT_ALWAYS_SYNC(false,
+                           "Out of memory");
+
+        result = false;
+        goto end;
+    }
+
+    if (file_ptr->filesize > 0)
+    {
+        task.file_ptr        = file_ptr;
+        task.n_failed_chunks = 0;
+        task.unpacker_ptr    = unpacker_ptr;
+
+        system_thread_pool_parallel_for((uint32_t) ( file_ptr->data_start_offset                           / unpacker_ptr->chunk_size),
+                                        (uint32_t) ((file_ptr->data_start_offset + file_ptr->filesize - 1) / unpacker_ptr->chunk_size) + 1,
+                                        1, /* grain_size */
+                                        _system_file_unpacker_unpack_file_chunks,
+                                       &task);
+
+        if (task.n_failed_chunks != 0)
+        {
+            result = false;
+            goto end;
+        }
+    }
+
+    file_crc32 = crc32(0,
+                       (const Bytef*) file_ptr->data,
+                       file_ptr->filesize);
+
+    if (file_crc32 != file_ptr->crc32)
+    {
+        LOG_ERROR("Checksum mismatch for file [%s] stored in packed file [%s]",
+                  system_hashed_ansi_string_get_buffer(file_ptr->filename),
+                  system_hashed_ansi_string_get_buffer(unpacker_ptr->packed_filename) );
+
+        ASSERT_DEBUG_SYNC(false,
+                          "Packed file is corrupt.");
+
+        result = false;
+        goto end;
+    }
+
+end:
+    if (!result                 &&
+         file_ptr->data != NULL)
+    {
+        delete [] (unsigned char*) file_ptr->data;
+
+        file_ptr->data = NULL;
+    }
+
+    return result;
+}
+
+/** Unpacks a v1 packed file. All embedded files are decompressed at once.
+ *
+ *  @param file_unpacker_ptr      Unpacker instance to initialize.
+ *  @param packed_file_serializer Serializer holding the packed file's contents.
+ *
+ *  @return true if successful, false otherwise.
+ */
+PRIVATE bool _system_file_unpacker_init_v1(_system_file_unpacker* file_unpacker_ptr,
+                                           system_file_serializer packed_file_serializer)
 {
     unsigned char*              data_ptr               = NULL;
     int                         inflation_result       = 0;
@@ -92,25 +494,11 @@ PRIVATE bool _system_file_unpacker_init(_system_file_unpacker* file_unpacker_ptr
     uint32_t                    n_total_decoded_bytes  = 0;
     const unsigned char*        packed_file_data_ptr   = NULL;
     uint32_t                    packed_file_data_size  = 0;
-    system_file_serializer      packed_file_serializer = NULL;
     _system_file_unpacker_file* prev_file_ptr          = NULL;
     bool                        result                 = true;
     unsigned char*              traveller_ptr          = data_ptr;
     z_stream                    zlib_stream;
 
-    /* Open the packed file */
-    packed_file_serializer = system_file_serializer_create_for_reading(file_unpacker_ptr->packed_filename,
-                                                                       false); /* async_read */
-
-    if (packed_file_serializer == NULL)
-    {
-        ASSERT_DEBUG_SYNC(false,
-                          "Could not open packed file serializer");
-
-        result = false;
-        goto end;
-    }
-
     /* First four bytes tell us the total number of bytes in the decoded data stream */
     if (!system_file_serializer_read(packed_file_serializer,
                                      sizeof(n_total_decoded_bytes),
@@ -216,10 +604,11 @@ PRIVATE bool _system_file_unpacker_init(_system_file_unpacker* file_unpacker_ptr
                                      new_file_ptr);
     } /* for (all embedded files) */
 
-    /* Update filesize for the last processed file, too. */
+    /* Update filesize for the last processed file, too. The decoded stream also holds the file table,
+     * which needs to be accounted for. */
     if (prev_file_ptr != NULL)
     {
-        prev_file_ptr->filesize = n_total_decoded_bytes - prev_file_ptr->data_start_offset;
+        prev_file_ptr->filesize = n_total_decoded_bytes - (uint32_t) (traveller_ptr - file_unpacker_ptr->unpacked_buffer_ptr) - prev_file_ptr->data_start_offset;
     }
 
     /* At this point, actual data starts. Use this information to update all file descriptors
@@ -247,6 +636,219 @@ end:
         inflateEnd(&zlib_stream);
     }
 
+    return result;
+}
+
+/** Reads the index of a v2 packed file. No file data is decompressed at this point. Chunks are only
+ *  decompressed when the corresponding file is accessed for the first time.
+ *
+ *  @param file_unpacker_ptr      Unpacker instance to initialize.
+ *  @param packed_file_serializer Serializer holding the packed file's contents. Must be positioned right after
+ *                                the format version. The unpacker retains the serializer.
+ *
+ *  @return true if successful, false otherwise.
+ */
+PRIVATE bool _system_file_unpacker_init_v2(_system_file_unpacker* file_unpacker_ptr,
+                                           system_file_serializer packed_file_serializer)
+{
+    const unsigned char* chunk_data_ptr         = NULL;
+    uint32_t             chunk_data_offset      = 0;
+    uint32_t             n_files_embedded       = 0;
+    __uint64             n_total_unpacked_bytes = 0;
+    const unsigned char* packed_file_data_ptr   = NULL;
+    uint32_t             packed_file_data_size  = 0;
+    bool                 result                 = true;
+
+    system_file_serializer_retain(packed_file_serializer);
+
+    file_unpacker_ptr->packed_file_serializer = packed_file_serializer;
+
+    if (!system_file_serializer_read(packed_file_serializer,
+                                     sizeof(file_unpacker_ptr->chunk_size),
+                                    &file_unpacker_ptr->chunk_size)                   ||
+        !system_file_serializer_read(packed_file_serializer,
+                                     sizeof(n_files_embedded),
+                                    &n_files_embedded)                                ||
+        !system_file_serializer_read(packed_file_serializer,
+                                     sizeof(file_unpacker_ptr->n_chunks),
+                                    &file_unpacker_ptr->n_chunks)                     ||
+        !system_file_serializer_read(packed_file_serializer,
+                                     sizeof(n_total_unpacked_bytes),
+                                    &n_total_unpacked_bytes)                          ||
+        file_unpacker_ptr->chunk_size                                            == 0 ||
+        (n_total_unpacked_bytes + file_unpacker_ptr->chunk_size - 1) / file_unpacker_ptr->chunk_size != file_unpacker_ptr->n_chunks)
+    {
+        ASSERT_DEBUG_SYNC(false,
+                          "Invalid packed file header");
+
+        result = false;
+        goto end;
+    }
+
+    /* Read the file table */
+    for (uint32_t n_file = 0;
+                  n_file < n_files_embedded;
+                ++n_file)
+    {
+        const char*                 file_name_ptr         = NULL;
+        _system_file_unpacker_file* new_file_ptr          = NULL;
+        uint32_t                    n_filename_characters = 0;
+
+        if (!system_file_serializer_read        (packed_file_serializer,
+                                                 sizeof(n_filename_characters),
+                                                &n_filename_characters) ||
+            !system_file_serializer_read_no_copy(packed_file_serializer,
+                                                 n_filename_characters,
+                                                 (const void**) &file_name_ptr) )
+        {
+            ASSERT_DEBUG_SYNC(false,
+                              "Could not read name of file [%d]",
+                              n_file);
+
+            result = false;
+            goto end;
+        }
+
+        new_file_ptr = new (std::nothrow) _system_file_unpacker_file(system_hashed_ansi_string_create_substring(file_name_ptr,
+                                                                                                                0, /* start_offset */
+                                                                                                                n_filename_characters) );
+
+        ASSERT_ALWAYS_SYNC(new_file_ptr != NULL,
+                           "Out of memory");
+
+        new_file_ptr->cs = system_critical_section_create();
+
+        system_resizable_vector_push(file_unpacker_ptr->files,
+                                     new_file_ptr);
+
+        if (!system_file_serializer_read(packed_file_serializer,
+                                         sizeof(new_file_ptr->data_start_offset),
+                                        &new_file_ptr->data_start_offset)                        ||
+            !system_file_serializer_read(packed_file_serializer,
+                                         sizeof(new_file_ptr->filesize),
+                                        &new_file_ptr->filesize)                                 ||
+            !system_file_serializer_read(packed_file_serializer,
+                                         sizeof(new_file_ptr->crc32),
+                                        &new_file_ptr->crc32)                                    ||
+            new_file_ptr->data_start_offset + new_file_ptr->filesize > n_total_unpacked_bytes)
+        {
+            ASSERT_DEBUG_SYNC(false,
+                              "Invalid descriptor of file [%s]",
+                              system_hashed_ansi_string_get_buffer(new_file_ptr->filename) );
+
+            result = false;
+            goto end;
+        }
+    } /* for (all embedded files) */
+
+    /* Read the chunk table. Chunk data starts right after it. */
+    file_unpacker_ptr->chunks = new (std::nothrow) _system_file_unpacker_chunk[(file_unpacker_ptr->n_chunks > 0) ? file_unpacker_ptr->n_chunks : 1];
+
+    ASSERT_ALWAYS_SYNC(file_unpacker_ptr->chunks != NULL,
+                       "Out of memory");
+
+    system_file_serializer_get_property(packed_file_serializer,
+                                        SYSTEM_FILE_SERIALIZER_PROPERTY_RAW_STORAGE,
+                                       &packed_file_data_ptr);
+    system_file_serializer_get_property(packed_file_serializer,
+                                        SYSTEM_FILE_SERIALIZER_PROPERTY_SIZE,
+                                       &packed_file_data_size);
+    system_file_serializer_get_property(packed_file_serializer,
+                                        SYSTEM_FILE_SERIALIZER_PROPERTY_CURRENT_OFFSET,
+                                       &chunk_data_offset);
+
+    chunk_data_offset += file_unpacker_ptr->n_chunks * (sizeof(__uint64) + 2 * sizeof(uint32_t) );
+    chunk_data_ptr     = packed_file_data_ptr + chunk_data_offset;
+
+    for (uint32_t n_chunk = 0;
+                  n_chunk < file_unpacker_ptr->n_chunks;
+                ++n_chunk)
+    {
+        _system_file_unpacker_chunk* chunk_ptr          = file_unpacker_ptr->chunks + n_chunk;
+        __uint64                     packed_data_offset = 0;
+        const uint32_t               unpacked_size      = (n_chunk != file_unpacker_ptr->n_chunks - 1) ? file_unpacker_ptr->chunk_size
+                                                                                                       : (uint32_t) (n_total_unpacked_bytes - (__uint64) n_chunk * file_unpacker_ptr->chunk_size);
+
+        if (!system_file_serializer_read(packed_file_serializer,
+                                         sizeof(packed_data_offset),
+                                        &packed_data_offset)                                                 ||
+            !system_file_serializer_read(packed_file_serializer,
+                                         sizeof(chunk_ptr->packed_size),
+                                        &chunk_ptr->packed_size)                                             ||
+            !system_file_serializer_read(packed_file_serializer,
+                                         sizeof(chunk_ptr->unpacked_size),
+                                        &chunk_ptr->unpacked_size)                                           ||
+            chunk_ptr->unpacked_size                                                       != unpacked_size ||
+            chunk_data_offset + packed_data_offset + chunk_ptr->packed_size > packed_file_data_size)
+        {
+            ASSERT_DEBUG_SYNC(false,
+                              "Invalid descriptor of chunk [%d]",
+                              n_chunk);
+
+            result = false;
+            goto end;
+        }
+
+        chunk_ptr->packed_data = chunk_data_ptr + packed_data_offset;
+    } /* for (all chunks) */
+
+end:
+    return result;
+}
+
+/** Opens the packed file and initializes the unpacker, depending on the packed file's format version.
+ *
+ *  @param file_unpacker_ptr Unpacker instance to initialize.
+ *
+ *  @return true if successful, false otherwise.
+ */
+PRIVATE bool _system_file_unpacker_init(_system_file_unpacker* file_unpacker_ptr)
+{
+    const unsigned char*   packed_file_data_ptr   = NULL;
+    uint32_t               packed_file_data_size  = 0;
+    system_file_serializer packed_file_serializer = NULL;
+    bool                   result                 = true;
+
+    /* Open the packed file */
+    packed_file_serializer = system_file_serializer_create_for_reading_mapped_file(file_unpacker_ptr->packed_filename);
+
+    if (packed_file_serializer == NULL)
+    {
+        ASSERT_DEBUG_SYNC(false,
+                          "Could not open packed file serializer");
+
+        result = false;
+        goto end;
+    }
+
+    /* v1 files do not come with a header. Peek at the first bytes to tell the formats apart. */
+    system_file_serializer_get_property(packed_file_serializer,
+                                        SYSTEM_FILE_SERIALIZER_PROPERTY_RAW_STORAGE,
+                                       &packed_file_data_ptr);
+    system_file_serializer_get_property(packed_file_serializer,
+                                        SYSTEM_FILE_SERIALIZER_PROPERTY_SIZE,
+                                       &packed_file_data_size);
+
+    if (packed_file_data_size                                             >= 2 * sizeof(uint32_t)            &&
+        ((const uint32_t*) packed_file_data_ptr)[0] == SYSTEM_FILE_PACKER_FORMAT_MAGIC                  &&
+        ((const uint32_t*) packed_file_data_ptr)[1] == SYSTEM_FILE_PACKER_FORMAT_VERSION)
+    {
+        const void* header_data_ptr = NULL;
+
+        system_file_serializer_read_no_copy(packed_file_serializer,
+                                            2 * sizeof(uint32_t),
+                                           &header_data_ptr);
+
+        result = _system_file_unpacker_init_v2(file_unpacker_ptr,
+                                               packed_file_serializer);
+    }
+    else
+    {
+        result = _system_file_unpacker_init_v1(file_unpacker_ptr,
+                                               packed_file_serializer);
+    }
+
+end:
     if (packed_file_serializer != NULL)
     {
         system_file_serializer_release(packed_file_serializer);
@@ -320,8 +922,17 @@ PUBLIC EMERALD_API void system_file_unpacker_get_file_property(system_file_unpac
     {
         case SYSTEM_FILE_UNPACKER_FILE_PROPERTY_FILE_SERIALIZER:
         {
-            /* Spawn a system_file_serializer, built around a memory region this unpacker hosts */
-            if (file_ptr->serializer == NULL)
+            /* Spawn a system_file_serializer, built around a memory region this unpacker hosts. Files stored
+             * in v2 packed files are unpacked the first time they are accessed. */
+            if (file_ptr->cs != NULL)
+            {
+                system_critical_section_enter(file_ptr->cs);
+            }
+
+            if (file_ptr->serializer == NULL                                     &&
+                (file_ptr->data      != NULL                                     ||
+                 _system_file_unpacker_unpack_file(unpacker_ptr,
+                                                   file_ptr) ))
             {
                 file_ptr->serializer = system_file_serializer_create_for_reading_memory_region(file_ptr->data,
                                                                                                file_ptr->filesize);
@@ -333,6 +944,11 @@ PUBLIC EMERALD_API void system_file_unpacker_get_file_property(system_file_unpac
 
             *(system_file_serializer*) out_result = file_ptr->serializer;
 
+            if (file_ptr->cs != NULL)
+            {
+                system_critical_section_leave(file_ptr->cs);
+            }
+
             ASSERT_DEBUG_SYNC(*(system_file_serializer*) out_result != NULL,
                               "Could not create a system_file_serializer instance for a memory region.");
 
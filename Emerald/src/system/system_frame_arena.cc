@@ -0,0 +1,484 @@
+/**
+ *
+ * Emerald (kbi/elude @2016)
+ *
+ */
+#include "shared.h"
+#include "config.h"
+#include "system/system_assertions.h"
+#include "system/system_atomics.h"
+#include "system/system_constants.h"
+#include "system/system_critical_section.h"
+#include "system/system_frame_arena.h"
+#include "system/system_resizable_vector.h"
+#include <stdlib.h>
+
+
+/** Chunk of memory owned by a frame arena. Allocations are served from the space following the header. */
+typedef struct _system_frame_arena_chunk
+{
+    _system_frame_arena_chunk* next_chunk_ptr;
+    size_t                     n_bytes_used;
+    size_t                     size;
+} _system_frame_arena_chunk;
+
+/** Per-thread arena. Only the owning thread allocates from it, so it needs no synchronization. */
+typedef struct
+{
+    /* Chunk allocations are currently served from. Older chunks are linked through next_chunk_ptr. */
+    _system_frame_arena_chunk* current_chunk_ptr;
+    size_t                     n_bytes_in_chunks;
+
+    /* Index of the frame the arena's allocations belong to. If it does not match the index of
+     * the current frame, the arena is reset before the next allocation is served. */
+    unsigned int frame_index;
+
+    /* Statistics for the frame. Read by system_frame_arena_end_frame() under the registry lock. */
+    __uint64     n_bytes_allocated;
+    unsigned int n_allocations;
+    unsigned int n_chunk_allocations;
+} _system_frame_arena;
+
+
+/** Internal variables */
+
+/* Arenas of all threads, which have allocated from a frame arena at least once. */
+system_resizable_vector _system_frame_arena_arenas    = NULL;
+system_critical_section _system_frame_arena_arenas_cs = NULL;
+
+/* Index of the current (or, if none is in progress, last) frame. */
+volatile unsigned int _system_frame_arena_frame_index = 0;
+
+/* Number of begin_frame() calls, which have not been matched with an end_frame() call yet.
+ * Protected by _system_frame_arena_arenas_cs. */
+volatile unsigned int _system_frame_arena_n_frames_in_progress = 0;
+
+/* Statistics of the last completed frame. */
+__uint64     _system_frame_arena_last_frame_n_bytes_allocated      = 0;
+unsigned int _system_frame_arena_last_frame_n_allocations          = 0;
+unsigned int _system_frame_arena_last_frame_n_chunk_allocations    = 0;
+unsigned int _system_frame_arena_last_frame_n_heap_allocations     = 0;
+unsigned int _system_frame_arena_n_frames_completed                = 0;
+
+/* Arena owned by the calling thread, or NULL if the thread has not used one yet. */
+#ifdef _WIN32
+    __declspec(thread) _system_frame_arena* _system_frame_arena_thread_arena_ptr = NULL;
+#else
+    __thread _system_frame_arena* _system_frame_arena_thread_arena_ptr = NULL;
+#endif
+
+
+#ifdef INCLUDE_HEAP_ALLOCATION_COUNTER
+    /* Number of operator new calls made since the process started. */
+    volatile unsigned int _system_frame_arena_n_heap_allocations                  = 0;
+    unsigned int          _system_frame_arena_n_heap_allocations_at_frame_start = 0;
+
+    /* NOTE: On Windows, the replacements only affect allocations made by Emerald's DLL. */
+    void* operator new(size_t size)
+    {
+        void* result_ptr = NULL;
+
+        system_atomics_increment(&_system_frame_arena_n_heap_allocations);
+
+        result_ptr = malloc( (size != 0) ? size : 1);
+
+        if (result_ptr == NULL)
+        {
+            throw std::bad_alloc();
+        }
+
+        return result_ptr;
+    }
+
+    void* operator new[](size_t size)
+    {
+        return operator new(size);
+    }
+
+    void operator delete(void* ptr) throw()
+    {
+        free(ptr);
+    }
+
+    void operator delete[](void* ptr) throw()
+    {
+        free(ptr);
+    }
+#endif
+
+
+/** Allocates a new chunk, which can hold at least @param min_size bytes. Does not link it to any arena.
+ *
+ *  @return New chunk.
+ */
+PRIVATE _system_frame_arena_chunk* _system_frame_arena_alloc_chunk(size_t min_size)
+{
+    _system_frame_arena_chunk* chunk_ptr = NULL;
+    const size_t               size      = (min_size > FRAME_ARENA_CHUNK_SIZE) ? min_size
+                                                                               : FRAME_ARENA_CHUNK_SIZE;
+
+    chunk_ptr = (_system_frame_arena_chunk*) malloc(sizeof(_system_frame_arena_chunk) + size);
+
+    ASSERT_ALWAYS_SYNC(chunk_ptr != NULL,
+                       "Out of memory");
+
+    if (chunk_ptr != NULL)
+    {
+        chunk_ptr->next_chunk_ptr = NULL;
+        chunk_ptr->n_bytes_used   = 0;
+        chunk_ptr->size           = size;
+    }
+
+    return chunk_ptr;
+}
+
+/** Returns all chunks of the specified arena to the heap. */
+PRIVATE void _system_frame_arena_release_chunks(_system_frame_arena* arena_ptr)
+{
+    while (arena_ptr->current_chunk_ptr != NULL)
+    {
+        _system_frame_arena_chunk* next_chunk_ptr = arena_ptr->current_chunk_ptr->next_chunk_ptr;
+
+        free(arena_ptr->current_chunk_ptr);
+
+        arena_ptr->current_chunk_ptr = next_chunk_ptr;
+    }
+
+    arena_ptr->n_bytes_in_chunks = 0;
+}
+
+/** Prepares the arena for serving allocations in the current frame.
+ *
+ *  If the arena had to grow during the previous frame, its chunks are replaced with a single chunk
+ *  large enough to hold all of them, so that the arena does not need to grow in subsequent frames.
+ */
+PRIVATE void _system_frame_arena_reset(_system_frame_arena* arena_ptr,
+                                       unsigned int         frame_index)
+{
+    arena_ptr->frame_index         = frame_index;
+    arena_ptr->n_allocations       = 0;
+    arena_ptr->n_bytes_allocated   = 0;
+    arena_ptr->n_chunk_allocations = 0;
+
+    if (arena_ptr->current_chunk_ptr                 != NULL &&
+        arena_ptr->current_chunk_ptr->next_chunk_ptr != NULL)
+    {
+        const size_t n_bytes_in_chunks = arena_ptr->n_bytes_in_chunks;
+
+        _system_frame_arena_release_chunks(arena_ptr);
+
+        arena_ptr->current_chunk_ptr = _system_frame_arena_alloc_chunk(n_bytes_in_chunks);
+        arena_ptr->n_bytes_in_chunks = arena_ptr->current_chunk_ptr->size;
+
+        arena_ptr->n_chunk_allocations++;
+    }
+    else
+    if (arena_ptr->current_chunk_ptr != NULL)
+    {
+        arena_ptr->current_chunk_ptr->n_bytes_used = 0;
+    }
+}
+
+/** Returns the calling thread's arena. Creates one, if this is the first time the thread allocates
+ *  from a frame arena. */
+PRIVATE _system_frame_arena* _system_frame_arena_get_thread_arena()
+{
+    _system_frame_arena* arena_ptr = _system_frame_arena_thread_arena_ptr;
+
+    if (arena_ptr == NULL)
+    {
+        arena_ptr = (_system_frame_arena*) malloc(sizeof(_system_frame_arena) );
+
+        ASSERT_ALWAYS_SYNC(arena_ptr != NULL,
+                           "Out of memory");
+
+        arena_ptr->current_chunk_ptr   = NULL;
+        arena_ptr->frame_index         = _system_frame_arena_frame_index;
+        arena_ptr->n_allocations       = 0;
+        arena_ptr->n_bytes_allocated   = 0;
+        arena_ptr->n_bytes_in_chunks   = 0;
+        arena_ptr->n_chunk_allocations = 0;
+
+        system_critical_section_enter(_system_frame_arena_arenas_cs);
+        {
+            system_resizable_vector_push(_system_frame_arena_arenas,
+                                         arena_ptr);
+        }
+        system_critical_section_leave(_system_frame_arena_arenas_cs);
+
+        _system_frame_arena_thread_arena_ptr = arena_ptr;
+    }
+
+    return arena_ptr;
+}
+
+
+/** Please see header for specification */
+PUBLIC EMERALD_API void* system_frame_arena_alloc(size_t size,
+                                                  size_t alignment)
+{
+    _system_frame_arena*       arena_ptr       = NULL;
+    _system_frame_arena_chunk* chunk_ptr       = NULL;
+    const unsigned int         frame_index     = _system_frame_arena_frame_index;
+    size_t                     offset          = 0;
+    void*                      result_ptr      = NULL;
+
+    ASSERT_DEBUG_SYNC(alignment != 0 && (alignment & (alignment - 1)) == 0,
+                      "Frame arena allocation alignment must be a power of two");
+
+    if (_system_frame_arena_n_frames_in_progress == 0)
+    {
+        ASSERT_DEBUG_SYNC(false,
+                          "Frame arena allocations can only be made while a frame is in progress");
+
+        goto end;
+    }
+
+    arena_ptr = _system_frame_arena_get_thread_arena();
+
+    if (arena_ptr->frame_index != frame_index)
+    {
+        _system_frame_arena_reset(arena_ptr,
+                                  frame_index);
+    }
+
+    /* Align the address, rather than the offset, so that the chunk header size does not matter */
+    chunk_ptr = arena_ptr->current_chunk_ptr;
+
+    if (chunk_ptr != NULL)
+    {
+        const size_t data_address = (size_t) (chunk_ptr + 1);
+
+        offset = ((data_address + chunk_ptr->n_bytes_used + alignment - 1) & ~(alignment - 1)) - data_address;
+    }
+
+    if (chunk_ptr          == NULL ||
+        offset + size      >  chunk_ptr->size)
+    {
+        /* Double the arena's capacity, unless the allocation needs even more space */
+        size_t new_chunk_size = arena_ptr->n_bytes_in_chunks;
+
+        if (new_chunk_size < size + alignment)
+        {
+            new_chunk_size = size + alignment;
+        }
+
+        chunk_ptr                 = _system_frame_arena_alloc_chunk(new_chunk_size);
+        chunk_ptr->next_chunk_ptr = arena_ptr->current_chunk_ptr;
+
+        arena_ptr->current_chunk_ptr  = chunk_ptr;
+        arena_ptr->n_bytes_in_chunks += chunk_ptr->size;
+        arena_ptr->n_chunk_allocations++;
+
+        offset = ((((size_t) (chunk_ptr + 1)) + alignment - 1) & ~(alignment - 1)) - (size_t) (chunk_ptr + 1);
+    }
+
+    result_ptr              = (char*) (chunk_ptr + 1) + offset;
+    chunk_ptr->n_bytes_used = offset + size;
+
+    arena_ptr->n_allocations++;
+    arena_ptr->n_bytes_allocated += size;
+
+end:
+    return result_ptr;
+}
+
+/** Please see header for specification */
+PUBLIC EMERALD_API void system_frame_arena_begin_frame()
+{
+    system_critical_section_enter(_system_frame_arena_arenas_cs);
+    {
+        /* Frames of different rendering handlers may overlap. Only start a new frame arena frame, if
+         * none of them is in progress, so that the allocations made for the other frames stay valid. */
+        if (_system_frame_arena_n_frames_in_progress++ == 0)
+        {
+            #ifdef INCLUDE_HEAP_ALLOCATION_COUNTER
+            {
+                _system_frame_arena_n_heap_allocations_at_frame_start = _system_frame_arena_n_heap_allocations;
+            }
+            #endif
+
+            /* Arenas are reset lazily, the next time their threads allocate */
+            _system_frame_arena_frame_index++;
+        }
+    }
+    system_critical_section_leave(_system_frame_arena_arenas_cs);
+}
+
+/** Please see header for specification */
+PUBLIC EMERALD_API void system_frame_arena_end_frame()
+{
+    const unsigned int frame_index         = _system_frame_arena_frame_index;
+    __uint64           n_bytes_allocated   = 0;
+    unsigned int       n_allocations       = 0;
+    unsigned int       n_arenas            = 0;
+    unsigned int       n_chunk_allocations = 0;
+
+    system_critical_section_enter(_system_frame_arena_arenas_cs);
+    {
+        ASSERT_DEBUG_SYNC(_system_frame_arena_n_frames_in_progress > 0,
+                          "system_frame_arena_end_frame() called, but no frame is in progress");
+
+        if (--_system_frame_arena_n_frames_in_progress != 0)
+        {
+            goto end;
+        }
+
+        /* Gather the statistics. Arenas which have not been used in this frame still hold
+         * the statistics for an earlier frame, so skip them. */
+        system_resizable_vector_get_property(_system_frame_arena_arenas,
+                                             SYSTEM_RESIZABLE_VECTOR_PROPERTY_N_ELEMENTS,
+                                            &n_arenas);
+
+        for (unsigned int n_arena = 0;
+                          n_arena < n_arenas;
+                        ++n_arena)
+        {
+            _system_frame_arena* arena_ptr = NULL;
+
+            system_resizable_vector_get_element_at(_system_frame_arena_arenas,
+                                                   n_arena,
+                                                  &arena_ptr);
+
+            if (arena_ptr->frame_index != frame_index)
+            {
+                continue;
+            }
+
+            n_allocations       += arena_ptr->n_allocations;
+            n_bytes_allocated   += arena_ptr->n_bytes_allocated;
+            n_chunk_allocations += arena_ptr->n_chunk_allocations;
+        }
+
+        _system_frame_arena_last_frame_n_allocations       = n_allocations;
+        _system_frame_arena_last_frame_n_bytes_allocated   = n_bytes_allocated;
+        _system_frame_arena_last_frame_n_chunk_allocations = n_chunk_allocations;
+
+        #ifdef INCLUDE_HEAP_ALLOCATION_COUNTER
+        {
+            _system_frame_arena_last_frame_n_heap_allocations = _system_frame_arena_n_heap_allocations -
+                                                                _system_frame_arena_n_heap_allocations_at_frame_start;
+        }
+        #endif
+
+        _system_frame_arena_n_frames_completed++;
+    }
+end:
+    system_critical_section_leave(_system_frame_arena_arenas_cs);
+}
+
+/** Please see header for specification */
+PUBLIC EMERALD_API void system_frame_arena_get_property(system_frame_arena_property property,
+                                                        void*                       out_result_ptr)
+{
+    switch (property)
+    {
+        case SYSTEM_FRAME_ARENA_PROPERTY_N_ALLOCATIONS_LAST_FRAME:
+        {
+            *(unsigned int*) out_result_ptr = _system_frame_arena_last_frame_n_allocations;
+
+            break;
+        }
+
+        case SYSTEM_FRAME_ARENA_PROPERTY_N_BYTES_ALLOCATED_LAST_FRAME:
+        {
+            *(__uint64*) out_result_ptr = _system_frame_arena_last_frame_n_bytes_allocated;
+
+            break;
+        }
+
+        case SYSTEM_FRAME_ARENA_PROPERTY_N_CHUNK_ALLOCATIONS_LAST_FRAME:
+        {
+            *(unsigned int*) out_result_ptr = _system_frame_arena_last_frame_n_chunk_allocations;
+
+            break;
+        }
+
+        case SYSTEM_FRAME_ARENA_PROPERTY_N_HEAP_ALLOCATIONS_LAST_FRAME:
+        {
+            *(unsigned int*) out_result_ptr = _system_frame_arena_last_frame_n_heap_allocations;
+
+            break;
+        }
+
+        case SYSTEM_FRAME_ARENA_PROPERTY_N_FRAMES_COMPLETED:
+        {
+            *(unsigned int*) out_result_ptr = _system_frame_arena_n_frames_completed;
+
+            break;
+        }
+
+        default:
+        {
+            ASSERT_DEBUG_SYNC(false,
+                              "Unrecognized system_frame_arena_property value.");
+        }
+    }
+}
+
+/** Please see header for specification */
+PUBLIC EMERALD_API bool system_frame_arena_is_frame_in_progress()
+{
+    return (_system_frame_arena_n_frames_in_progress != 0);
+}
+
+/** Please see header for specification */
+PUBLIC void _system_frame_arena_release_thread_arena()
+{
+    _system_frame_arena* arena_ptr = _system_frame_arena_thread_arena_ptr;
+
+    if (arena_ptr == NULL)
+    {
+        return;
+    }
+
+    system_critical_section_enter(_system_frame_arena_arenas_cs);
+    {
+        size_t arena_index = system_resizable_vector_find(_system_frame_arena_arenas,
+                                                          arena_ptr);
+
+        ASSERT_DEBUG_SYNC(arena_index != ITEM_NOT_FOUND,
+                          "Thread's frame arena is not registered");
+
+        if (arena_index != ITEM_NOT_FOUND)
+        {
+            system_resizable_vector_delete_element_at(_system_frame_arena_arenas,
+                                                      arena_index);
+        }
+    }
+    system_critical_section_leave(_system_frame_arena_arenas_cs);
+
+    _system_frame_arena_release_chunks(arena_ptr);
+    free(arena_ptr);
+
+    _system_frame_arena_thread_arena_ptr = NULL;
+}
+
+/** Please see header for specification */
+PUBLIC void _system_frame_arena_init()
+{
+    _system_frame_arena_arenas    = system_resizable_vector_create(4 /* capacity */);
+    _system_frame_arena_arenas_cs = system_critical_section_create();
+}
+
+/** Please see header for specification */
+PUBLIC void _system_frame_arena_deinit()
+{
+    _system_frame_arena* arena_ptr = NULL;
+
+    /* Arenas of threads which have not been spawned by system_threads are still around */
+    while (system_resizable_vector_pop(_system_frame_arena_arenas,
+                                      &arena_ptr) )
+    {
+        _system_frame_arena_release_chunks(arena_ptr);
+        free(arena_ptr);
+    }
+
+    _system_frame_arena_thread_arena_ptr = NULL;
+
+    system_resizable_vector_release(_system_frame_arena_arenas);
+    system_critical_section_release(_system_frame_arena_arenas_cs);
+
+    _system_frame_arena_arenas    = NULL;
+    _system_frame_arena_arenas_cs = NULL;
+}
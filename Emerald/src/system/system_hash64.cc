@@ -1,23 +1,177 @@
 /**
  *
- * Emerald (kbi/elude @2012-2015)
+ * Emerald (kbi/elude @2012-2016)
  *
  */
 #include "shared.h"
 #include "system/system_hash64.h"
+#include <string.h>
+
+#if defined(_MSC_VER) && defined(_M_X64)
+    #include <intrin.h>
+
+    #pragma intrinsic(_umul128)
+#endif
+
+/* The hash function is wyhash (public domain, https://github.com/wangyi-fudan/wyhash).
+ * It is several times faster than the byte-at-a-time polynomial hash used previously and
+ * does not produce the trivial collisions the latter suffered from (eg. "Aa" vs "BB").
+ *
+ * The input is assumed to be stored in little-endian order, which is true for all platforms
+ * Emerald supports. */
+#define HASH64_SECRET0 (0xa0761d6478bd642full)
+#define HASH64_SECRET1 (0xe7037ed1a0b428dbull)
+#define HASH64_SECRET2 (0x8ebc6af09c88c6e3ull)
+#define HASH64_SECRET3 (0x589965cc75374cc3ull)
+
+
+/** Calculates a 128-bit product of two 64-bit values. The low half is stored in *a_ptr,
+ *  the high half in *b_ptr. */
+inline void _system_hash64_mum(__uint64* a_ptr,
+                               __uint64* b_ptr)
+{
+#if defined(__SIZEOF_INT128__)
+    __uint128_t product = (__uint128_t) *a_ptr * *b_ptr;
+
+    *a_ptr = (__uint64) product;
+    *b_ptr = (__uint64) (product >> 64);
+#elif defined(_MSC_VER) && defined(_M_X64)
+    *a_ptr = _umul128(*a_ptr,
+                      *b_ptr,
+                      b_ptr);
+#else
+    const __uint64 ha    = *a_ptr >> 32;
+    const __uint64 hb    = *b_ptr >> 32;
+    const __uint64 la    = (uint32_t) *a_ptr;
+    const __uint64 lb    = (uint32_t) *b_ptr;
+    const __uint64 rh    = ha * hb;
+    const __uint64 rm0   = ha * lb;
+    const __uint64 rm1   = hb * la;
+    const __uint64 rl    = la * lb;
+    const __uint64 t     = rl + (rm0 << 32);
+    __uint64       carry = (t < rl);
+    __uint64       lo    = t + (rm1 << 32);
+
+    carry += (lo < t);
+
+    *a_ptr = lo;
+    *b_ptr = rh + (rm0 >> 32) + (rm1 >> 32) + carry;
+#endif
+}
+
+/** Folds a 128-bit product of two 64-bit values into 64 bits. */
+inline __uint64 _system_hash64_mix(__uint64 a,
+                                   __uint64 b)
+{
+    _system_hash64_mum(&a,
+                       &b);
+
+    return a ^ b;
+}
+
+/** Reads 1 to 3 bytes, so that every byte affects the result. */
+inline __uint64 _system_hash64_read3(const unsigned char* data_ptr,
+                                     uint32_t             length)
+{
+    return ((__uint64) data_ptr[0]           << 16) |
+           ((__uint64) data_ptr[length >> 1] << 8)  |
+            (__uint64) data_ptr[length - 1];
+}
+
+/** Reads an unaligned 32-bit value. */
+inline __uint64 _system_hash64_read4(const unsigned char* data_ptr)
+{
+    uint32_t result;
+
+    memcpy(&result,
+           data_ptr,
+           sizeof(result) );
+
+    return result;
+}
+
+/** Reads an unaligned 64-bit value. */
+inline __uint64 _system_hash64_read8(const unsigned char* data_ptr)
+{
+    __uint64 result;
+
+    memcpy(&result,
+           data_ptr,
+           sizeof(result) );
+
+    return result;
+}
+
 
 /** Please see header for specification */
 PUBLIC system_hash64 system_hash64_calculate(const char* text,
                                              uint32_t    length)
 {
-	system_hash64 result = 0;
+    const unsigned char* data_ptr = (const unsigned char*) text;
+    __uint64             a        = 0;
+    __uint64             b        = 0;
+    __uint64             seed     = _system_hash64_mix(HASH64_SECRET0,
+                                                       HASH64_SECRET1);
+
+    if (length <= 16)
+    {
+        if (length >= 4)
+        {
+            const uint32_t offset = (length >> 3) << 2;
+
+            a = (_system_hash64_read4(data_ptr)              << 32) | _system_hash64_read4(data_ptr + offset);
+            b = (_system_hash64_read4(data_ptr + length - 4) << 32) | _system_hash64_read4(data_ptr + length - 4 - offset);
+        }
+        else
+        if (length > 0)
+        {
+            a = _system_hash64_read3(data_ptr,
+                                     length);
+        }
+    }
+    else
+    {
+        uint32_t n_bytes_left = length;
+
+        if (n_bytes_left > 48)
+        {
+            __uint64 seed1 = seed;
+            __uint64 seed2 = seed;
+
+            do
+            {
+                seed  = _system_hash64_mix(_system_hash64_read8(data_ptr)      ^ HASH64_SECRET1, _system_hash64_read8(data_ptr + 8)  ^ seed);
+                seed1 = _system_hash64_mix(_system_hash64_read8(data_ptr + 16) ^ HASH64_SECRET2, _system_hash64_read8(data_ptr + 24) ^ seed1);
+                seed2 = _system_hash64_mix(_system_hash64_read8(data_ptr + 32) ^ HASH64_SECRET3, _system_hash64_read8(data_ptr + 40) ^ seed2);
+
+                data_ptr     += 48;
+                n_bytes_left -= 48;
+            }
+            while (n_bytes_left > 48);
+
+            seed ^= seed1 ^ seed2;
+        }
+
+        while (n_bytes_left > 16)
+        {
+            seed = _system_hash64_mix(_system_hash64_read8(data_ptr)     ^ HASH64_SECRET1,
+                                      _system_hash64_read8(data_ptr + 8) ^ seed);
+
+            data_ptr     += 16;
+            n_bytes_left -= 16;
+        }
+
+        /* The last 16 bytes may overlap with data that has already been consumed */
+        a = _system_hash64_read8(data_ptr + n_bytes_left - 16);
+        b = _system_hash64_read8(data_ptr + n_bytes_left - 8);
+    }
+
+    a ^= HASH64_SECRET1;
+    b ^= seed;
 
-	for (uint32_t n_character = 0;
-                  n_character < length;
-                  n_character++)
-	{
-		result = (31 * result + text[n_character]);
-	}
+    _system_hash64_mum(&a,
+                       &b);
 
-	return result;
+    return _system_hash64_mix(a ^ HASH64_SECRET0 ^ length,
+                              b ^ HASH64_SECRET1);
 }
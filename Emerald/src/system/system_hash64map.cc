@@ -8,13 +8,33 @@
 #include "system/system_constants.h"
 #include "system/system_hash64map.h"
 #include "system/system_read_write_mutex.h"
-#include "system/system_resizable_vector.h"
-#include "system/system_resource_pool.h"
 #include <string.h>
 
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+    #include <emmintrin.h>
 
-/* Internal 64-bit hash-map bin entry descriptor */
-struct _system_hash64map_bin_entry
+    #define HASH64MAP_USE_SSE2
+#endif
+
+#ifdef _WIN32
+    #include <intrin.h>
+#endif
+
+/* Control byte values. Full slots store the 7 lowest bits of the mixed hash, so the highest bit is only set
+ * for empty & deleted slots. */
+#define CONTROL_DELETED  ((int8_t) 0xFE)
+#define CONTROL_EMPTY    ((int8_t) 0x80)
+
+/* Number of slots, whose control bytes are probed at once */
+#define GROUP_SIZE       (16)
+
+/* Tells that no entry index is available */
+#define NO_ENTRY_INDEX   (0xFFFFFFFF)
+
+
+/* Internal 64-bit hash-map entry descriptor. Entries are stored inline in a dense array, so that they
+ * can be accessed by index in constant time. */
+struct _system_hash64map_entry
 {
     void*                                  element;
     system_hash64                          hash;
@@ -22,77 +42,463 @@ struct _system_hash64map_bin_entry
     void*                                  remove_callback_argument;
 };
 
+/* Open-addressing lookup table, mapping hashes to entry indices. Slots are split into groups of
+ * GROUP_SIZE slots. Groups are probed quadratically. */
+struct _system_hash64map_table
+{
+    int8_t*   control;       /* GROUP_SIZE control bytes per group */
+    uint32_t* entry_indices; /* GROUP_SIZE entry indices per group */
+    uint32_t  n_groups;      /* power of two. 0 if the table is not allocated */
+    uint32_t  n_used_slots;  /* full and deleted slots */
+};
+
 /* Internal 64-bit hash-map descriptor */
 struct _system_hash64map
 {
-    system_resizable_vector* bins;
+    _system_hash64map_entry* entries;
+    uint32_t                 n_entries;
+    uint32_t                 n_entries_capacity;
     size_t                   element_size;
-    uint32_t                 n_bins;
+
+    /* When the lookup table runs out of space, a larger table is allocated and the old one is migrated into
+     * the new one, a few groups at a time, by subsequent insert & remove calls. Until the migration finishes,
+     * lookups need to check both tables. */
+    _system_hash64map_table  old_table;
+    uint32_t                 n_old_table_groups_migrated;
+    _system_hash64map_table  table;
 
     system_read_write_mutex  access_mutex;
-    system_resource_pool     bin_entry_pool;
 
     /** Helper for faster clear() code-path */
     bool                     any_entry_used_remove_callback;
 };
 
-/** TODO */
-PRIVATE void _system_hash64map_bin_entry_init(_system_hash64map_bin_entry*           entry_ptr,
-                                              system_hash64                          hash,
-                                              void*                                  element,
-                                              PFNSYSTEMHASH64MAPONREMOVECALLBACKPROC remove_callback,
-                                              void*                                  remove_callback_argument)
+
+/** Returns index of the lowest bit set in a non-zero bit mask. */
+PRIVATE inline uint32_t _system_hash64map_get_lowest_bit_index(uint32_t mask)
 {
-    entry_ptr->element                  = element;
-    entry_ptr->hash                     = hash;
-    entry_ptr->remove_callback          = remove_callback;
-    entry_ptr->remove_callback_argument = remove_callback_argument;
+#ifdef _WIN32
+    unsigned long result = 0;
+
+    _BitScanForward(&result,
+                    mask);
+
+    return (uint32_t) result;
+#else
+    return (uint32_t) __builtin_ctz(mask);
+#endif
 }
 
-/** TODO */
-PRIVATE void _system_hash64map_init(_system_hash64map* hash64map_ptr,
-                                    uint32_t           n_bins,
-                                    size_t             element_size,
-                                    bool               should_be_thread_safe)
+/** Returns a bit mask, whose n-th bit is set if n-th control byte of the group equals @param value.
+ *
+ *  @param group_control_ptr Control bytes of the group to check.
+ *  @param value             Value to compare the control bytes against.
+ *
+ *  @return As per description.
+ */
+PRIVATE inline uint32_t _system_hash64map_match_group(const int8_t* group_control_ptr,
+                                                      int8_t        value)
 {
-    hash64map_ptr->access_mutex                   = NULL;
-    hash64map_ptr->any_entry_used_remove_callback = false;
-    hash64map_ptr->bin_entry_pool                 = system_resource_pool_create(sizeof(_system_hash64map_bin_entry),
-                                                                                128 /* n-elements */,
-                                                                                NULL /* init_fn */,
-                                                                                NULL /* deinit_fn */);
-    hash64map_ptr->bins                           = new system_resizable_vector[n_bins];
-    hash64map_ptr->element_size                   = element_size;
-    hash64map_ptr->n_bins                         = n_bins;
+#ifdef HASH64MAP_USE_SSE2
+    const __m128i control = _mm_loadu_si128((const __m128i*) group_control_ptr);
 
-    for (uint32_t n_bin = 0;
-                  n_bin < n_bins;
-                ++n_bin)
+    return (uint32_t) _mm_movemask_epi8(_mm_cmpeq_epi8(control,
+                                                       _mm_set1_epi8(value) ));
+#else
+    uint32_t result = 0;
+
+    for (uint32_t n_slot = 0;
+                  n_slot < GROUP_SIZE;
+                ++n_slot)
     {
-        hash64map_ptr->bins[n_bin] = system_resizable_vector_create(HASH64MAP_BIN_ENTRIES_AMOUNT);
+        if (group_control_ptr[n_slot] == value)
+        {
+            result |= (1 << n_slot);
+        }
     }
 
-    if (should_be_thread_safe)
+    return result;
+#endif
+}
+
+/** Returns a bit mask, whose n-th bit is set if n-th slot of the group is empty or deleted.
+ *
+ *  @param group_control_ptr Control bytes of the group to check.
+ *
+ *  @return As per description.
+ */
+PRIVATE inline uint32_t _system_hash64map_match_group_free_slots(const int8_t* group_control_ptr)
+{
+#ifdef HASH64MAP_USE_SSE2
+    return (uint32_t) _mm_movemask_epi8(_mm_loadu_si128((const __m128i*) group_control_ptr) );
+#else
+    uint32_t result = 0;
+
+    for (uint32_t n_slot = 0;
+                  n_slot < GROUP_SIZE;
+                ++n_slot)
     {
-        hash64map_ptr->access_mutex = system_read_write_mutex_create();
+        if (group_control_ptr[n_slot] < 0)
+        {
+            result |= (1 << n_slot);
+        }
     }
+
+    return result;
+#endif
 }
 
-/** Releases a 64-bit hash-map bin descriptor. Do not access the descriptor after calling this function.
+/** Scrambles user-provided hash, so that both its lowest bits (used for control bytes) and the remaining
+ *  bits (used for group selection) are well distributed. Many hash-maps are keyed with small integers.
  *
- *  @param pool_ptr   TODO
- *  @param descriptor Descriptor to release.
- **/
-PRIVATE void _system_hash64map_bin_entry_deinit(_system_hash64map*           hash64map_ptr,
-                                                _system_hash64map_bin_entry* entry_ptr)
+ *  @param hash Hash to use.
+ *
+ *  @return Mixed hash value.
+ */
+PRIVATE inline system_hash64 _system_hash64map_mix_hash(system_hash64 hash)
+{
+    hash ^= hash >> 33;
+    hash *= 0xFF51AFD7ED558CCDULL;
+    hash ^= hash >> 33;
+    hash *= 0xC4CEB9FE1A85EC53ULL;
+    hash ^= hash >> 33;
+
+    return hash;
+}
+
+/** Searches the lookup table for a slot which refers to an entry.
+ *
+ *  @param table_ptr         Table to search.
+ *  @param entries           Entry array of the hash-map.
+ *  @param hash              Hash of the entry.
+ *  @param mixed_hash        Hash of the entry, mixed with _system_hash64map_mix_hash().
+ *  @param entry_index       If not NO_ENTRY_INDEX, the function looks for a slot referring to the entry
+ *                           at the specified index, rather than the first entry using @param hash.
+ *  @param out_slot_ptr      Deref will be set to the slot index, if found. Must not be NULL.
+ *
+ *  @return true if the slot has been found, false otherwise.
+ */
+PRIVATE bool _system_hash64map_table_find(const _system_hash64map_table* table_ptr,
+                                          const _system_hash64map_entry* entries,
+                                          system_hash64                  hash,
+                                          system_hash64                  mixed_hash,
+                                          uint32_t                       entry_index,
+                                          uint32_t*                      out_slot_ptr)
+{
+    const int8_t   control_value = (int8_t) (mixed_hash & 0x7F);
+    const uint32_t group_mask    = table_ptr->n_groups - 1;
+    uint32_t       n_group       = (uint32_t) (mixed_hash >> 7) & group_mask;
+
+    for (uint32_t n_probe = 0;
+                  n_probe < table_ptr->n_groups;
+                ++n_probe)
+    {
+        const int8_t* group_control_ptr = table_ptr->control + n_group * GROUP_SIZE;
+        uint32_t      matches           = _system_hash64map_match_group(group_control_ptr,
+                                                                        control_value);
+
+        while (matches != 0)
+        {
+            const uint32_t slot               = n_group * GROUP_SIZE + _system_hash64map_get_lowest_bit_index(matches);
+            const uint32_t slot_entry_index   = table_ptr->entry_indices[slot];
+
+            if ((entry_index == NO_ENTRY_INDEX && entries[slot_entry_index].hash == hash) ||
+                (entry_index != NO_ENTRY_INDEX && slot_entry_index           == entry_index) )
+            {
+                *out_slot_ptr = slot;
+
+                return true;
+            }
+
+            matches &= matches - 1;
+        }
+
+        /* An empty slot terminates the probe sequence */
+        if (_system_hash64map_match_group(group_control_ptr,
+                                          CONTROL_EMPTY) != 0)
+        {
+            break;
+        }
+
+        /* Triangular probing visits all groups, given the number of groups is a power of two */
+        n_group = (n_group + n_probe + 1) & group_mask;
+    }
+
+    return false;
+}
+
+/** Allocates lookup table storage and marks all slots as empty.
+ *
+ *  @param table_ptr Table to initialize.
+ *  @param n_groups  Number of groups to allocate. Must be a power of two.
+ */
+PRIVATE void _system_hash64map_table_init(_system_hash64map_table* table_ptr,
+                                          uint32_t                 n_groups)
+{
+    ASSERT_DEBUG_SYNC((n_groups & (n_groups - 1)) == 0,
+                      "Number of groups must be a power of two");
+
+    table_ptr->control       = new int8_t  [n_groups * GROUP_SIZE];
+    table_ptr->entry_indices = new uint32_t[n_groups * GROUP_SIZE];
+    table_ptr->n_groups      = n_groups;
+    table_ptr->n_used_slots  = 0;
+
+    memset(table_ptr->control,
+           CONTROL_EMPTY,
+           n_groups * GROUP_SIZE);
+}
+
+/** Releases lookup table storage. */
+PRIVATE void _system_hash64map_table_deinit(_system_hash64map_table* table_ptr)
+{
+    if (table_ptr->control != NULL)
+    {
+        delete [] table_ptr->control;
+
+        table_ptr->control = NULL;
+    }
+
+    if (table_ptr->entry_indices != NULL)
+    {
+        delete [] table_ptr->entry_indices;
+
+        table_ptr->entry_indices = NULL;
+    }
+
+    table_ptr->n_groups     = 0;
+    table_ptr->n_used_slots = 0;
+}
+
+/** Marks a full slot of a lookup table as no longer used. */
+PRIVATE void _system_hash64map_table_erase_slot(_system_hash64map_table* table_ptr,
+                                                uint32_t                 slot)
+{
+    const int8_t* group_control_ptr = table_ptr->control + (slot / GROUP_SIZE) * GROUP_SIZE;
+
+    /* If the group has never been full, no probe sequence could have continued past it, so the slot can be
+     * marked as empty. Otherwise, a tombstone must be left behind. */
+    if (_system_hash64map_match_group(group_control_ptr,
+                                      CONTROL_EMPTY) != 0)
+    {
+        table_ptr->control[slot] = CONTROL_EMPTY;
+        table_ptr->n_used_slots --;
+    }
+    else
+    {
+        table_ptr->control[slot] = CONTROL_DELETED;
+    }
+}
+
+/** Stores an entry index in the first free slot of the entry's probe sequence.
+ *
+ *  @param table_ptr   Table to use. Must have at least one free slot.
+ *  @param mixed_hash  Hash of the entry, mixed with _system_hash64map_mix_hash().
+ *  @param entry_index Index of the entry.
+ */
+PRIVATE void _system_hash64map_table_insert(_system_hash64map_table* table_ptr,
+                                            system_hash64            mixed_hash,
+                                            uint32_t                 entry_index)
+{
+    const uint32_t group_mask = table_ptr->n_groups - 1;
+    uint32_t       n_group    = (uint32_t) (mixed_hash >> 7) & group_mask;
+
+    for (uint32_t n_probe = 0;
+                  n_probe < table_ptr->n_groups;
+                ++n_probe)
+    {
+        const uint32_t free_slots = _system_hash64map_match_group_free_slots(table_ptr->control + n_group * GROUP_SIZE);
+
+        if (free_slots != 0)
+        {
+            const uint32_t slot = n_group * GROUP_SIZE + _system_hash64map_get_lowest_bit_index(free_slots);
+
+            if (table_ptr->control[slot] == CONTROL_EMPTY)
+            {
+                table_ptr->n_used_slots ++;
+            }
+
+            table_ptr->control      [slot] = (int8_t) (mixed_hash & 0x7F);
+            table_ptr->entry_indices[slot] = entry_index;
+
+            return;
+        }
+
+        n_group = (n_group + n_probe + 1) & group_mask;
+    }
+
+    ASSERT_ALWAYS_SYNC(false,
+                       "No free slot found in hash64map lookup table");
+}
+
+/** Locates the lookup table slot which refers to an entry. Checks both the current and, if the hash-map is
+ *  being grown, the old lookup table.
+ *
+ *  @param hash64map_ptr   Hash-map to use.
+ *  @param hash            Hash of the entry.
+ *  @param entry_index     If not NO_ENTRY_INDEX, look for a slot referring to the entry at the specified index,
+ *                         rather than the first entry using @param hash.
+ *  @param out_table_ptr   Deref will be set to the table holding the slot, if found. Must not be NULL.
+ *  @param out_slot_ptr    Deref will be set to the slot index, if found. Must not be NULL.
+ *
+ *  @return true if found, false otherwise.
+ */
+PRIVATE bool _system_hash64map_find_slot(_system_hash64map*        hash64map_ptr,
+                                         system_hash64             hash,
+                                         uint32_t                  entry_index,
+                                         _system_hash64map_table** out_table_ptr,
+                                         uint32_t*                 out_slot_ptr)
 {
-    if (entry_ptr->remove_callback != NULL)
+    const system_hash64 mixed_hash = _system_hash64map_mix_hash(hash);
+
+    if (_system_hash64map_table_find(&hash64map_ptr->table,
+                                      hash64map_ptr->entries,
+                                      hash,
+                                      mixed_hash,
+                                      entry_index,
+                                      out_slot_ptr) )
+    {
+        *out_table_ptr = &hash64map_ptr->table;
+
+        return true;
+    }
+
+    if (hash64map_ptr->old_table.n_groups != 0 &&
+        _system_hash64map_table_find(&hash64map_ptr->old_table,
+                                      hash64map_ptr->entries,
+                                      hash,
+                                      mixed_hash,
+                                      entry_index,
+                                      out_slot_ptr) )
     {
-        entry_ptr->remove_callback(entry_ptr->remove_callback_argument);
+        *out_table_ptr = &hash64map_ptr->old_table;
+
+        return true;
     }
 
-    system_resource_pool_return_to_pool(hash64map_ptr->bin_entry_pool,
-                                        (system_resource_pool_block) entry_ptr);
+    return false;
+}
+
+/** Retrieves index of the first entry using user-specified hash.
+ *
+ *  @return Entry index or NO_ENTRY_INDEX if the hash-map holds no such entry.
+ */
+PRIVATE inline uint32_t _system_hash64map_find_entry_index(_system_hash64map* hash64map_ptr,
+                                                           system_hash64      hash)
+{
+    uint32_t                 slot      = 0;
+    _system_hash64map_table* table_ptr = NULL;
+
+    if (_system_hash64map_find_slot(hash64map_ptr,
+                                    hash,
+                                    NO_ENTRY_INDEX,
+                                   &table_ptr,
+                                   &slot) )
+    {
+        return table_ptr->entry_indices[slot];
+    }
+
+    return NO_ENTRY_INDEX;
+}
+
+/** Moves up to @param n_groups groups of the old lookup table to the current one. Releases the old
+ *  table once all its groups have been migrated.
+ *
+ *  @param hash64map_ptr Hash-map to use.
+ *  @param n_groups      Maximum number of groups to migrate.
+ */
+PRIVATE void _system_hash64map_migrate_old_table(_system_hash64map* hash64map_ptr,
+                                                 uint32_t           n_groups)
+{
+    _system_hash64map_table* old_table_ptr = &hash64map_ptr->old_table;
+
+    while (old_table_ptr->n_groups != 0 &&
+           n_groups                 > 0)
+    {
+        const uint32_t first_slot = hash64map_ptr->n_old_table_groups_migrated * GROUP_SIZE;
+
+        for (uint32_t slot = first_slot;
+                      slot < first_slot + GROUP_SIZE;
+                    ++slot)
+        {
+            if (old_table_ptr->control[slot] >= 0)
+            {
+                const uint32_t entry_index = old_table_ptr->entry_indices[slot];
+
+                _system_hash64map_table_insert(&hash64map_ptr->table,
+                                                _system_hash64map_mix_hash(hash64map_ptr->entries[entry_index].hash),
+                                                entry_index);
+
+                /* Leave a tombstone, so that probe sequences of entries which have not been migrated yet
+                 * remain intact. */
+                old_table_ptr->control[slot] = CONTROL_DELETED;
+            }
+        }
+
+        hash64map_ptr->n_old_table_groups_migrated ++;
+        n_groups                                   --;
+
+        if (hash64map_ptr->n_old_table_groups_migrated == old_table_ptr->n_groups)
+        {
+            _system_hash64map_table_deinit(old_table_ptr);
+
+            hash64map_ptr->n_old_table_groups_migrated = 0;
+        }
+    }
+}
+
+/** Makes sure a new slot can be used in the lookup table. If the table's load factor limit would be exceeded,
+ *  a new table is allocated and migration of the existing one is started.
+ *
+ *  @param hash64map_ptr Hash-map to use.
+ */
+PRIVATE void _system_hash64map_reserve_slot(_system_hash64map* hash64map_ptr)
+{
+    _system_hash64map_table* table_ptr = &hash64map_ptr->table;
+    uint32_t                 n_groups  = table_ptr->n_groups;
+
+    if ((table_ptr->n_used_slots + 1) * 8 <= table_ptr->n_groups * GROUP_SIZE * 7)
+    {
+        return;
+    }
+
+    /* Only one migration can be in progress at a time */
+    _system_hash64map_migrate_old_table(hash64map_ptr,
+                                        hash64map_ptr->old_table.n_groups);
+
+    /* Make sure the new table is at most half full. If the current table mostly holds tombstones, the new table
+     * may be of the same size. */
+    while ((hash64map_ptr->n_entries + 1) * 2 > n_groups * GROUP_SIZE)
+    {
+        n_groups *= 2;
+    }
+
+    hash64map_ptr->old_table                   = *table_ptr;
+    hash64map_ptr->n_old_table_groups_migrated = 0;
+
+    _system_hash64map_table_init(table_ptr,
+                                 n_groups);
+}
+
+/** TODO */
+PRIVATE void _system_hash64map_init(_system_hash64map* hash64map_ptr,
+                                    size_t             element_size,
+                                    bool               should_be_thread_safe)
+{
+    memset(hash64map_ptr,
+           0,
+           sizeof(*hash64map_ptr) );
+
+    hash64map_ptr->element_size       = element_size;
+    hash64map_ptr->entries            = new _system_hash64map_entry[HASH64MAP_START_N_ENTRIES];
+    hash64map_ptr->n_entries_capacity = HASH64MAP_START_N_ENTRIES;
+
+    _system_hash64map_table_init(&hash64map_ptr->table,
+                                 HASH64MAP_START_N_SLOTS / GROUP_SIZE);
+
+    if (should_be_thread_safe)
+    {
+        hash64map_ptr->access_mutex = system_read_write_mutex_create();
+    }
 }
 
 /** Releases a 64-bit hash-map descriptor. Do not access the descriptor after calling this function.
@@ -101,12 +507,8 @@ PRIVATE void _system_hash64map_bin_entry_deinit(_system_hash64map*           has
  **/
 PRIVATE void _system_hash64map_deinit(_system_hash64map* hash64map_ptr)
 {
-    for (uint32_t n_bin = 0;
-                  n_bin < hash64map_ptr->n_bins;
-                ++n_bin)
-    {
-        system_resizable_vector_release(hash64map_ptr->bins[n_bin]);
-    }
+    _system_hash64map_table_deinit(&hash64map_ptr->old_table);
+    _system_hash64map_table_deinit(&hash64map_ptr->table);
 
     if (hash64map_ptr->access_mutex != NULL)
     {
@@ -115,18 +517,11 @@ PRIVATE void _system_hash64map_deinit(_system_hash64map* hash64map_ptr)
         hash64map_ptr->access_mutex = NULL;
     }
 
-    if (hash64map_ptr->bins != NULL)
-    {
-        delete [] hash64map_ptr->bins;
-
-        hash64map_ptr->bins = NULL;
-    }
-
-    if (hash64map_ptr->bin_entry_pool)
+    if (hash64map_ptr->entries != NULL)
     {
-        system_resource_pool_release(hash64map_ptr->bin_entry_pool);
+        delete [] hash64map_ptr->entries;
 
-        hash64map_ptr->bin_entry_pool = NULL;
+        hash64map_ptr->entries = NULL;
     }
 
     delete hash64map_ptr;
@@ -143,42 +538,32 @@ PUBLIC EMERALD_API void system_hash64map_clear(system_hash64map map)
                                      ACCESS_WRITE);
     }
 
-    for (uint32_t n_bin = 0;
-                  n_bin < map_ptr->n_bins;
-                ++n_bin)
+    if (map_ptr->any_entry_used_remove_callback)
     {
-        uint32_t n_bin_elements = 0;
-
-        if (map_ptr->any_entry_used_remove_callback)
+        for (uint32_t n_entry = 0;
+                      n_entry < map_ptr->n_entries;
+                    ++n_entry)
         {
-            system_resizable_vector_get_property(map_ptr->bins[n_bin],
-                                                 SYSTEM_RESIZABLE_VECTOR_PROPERTY_N_ELEMENTS,
-                                                &n_bin_elements);
+            const _system_hash64map_entry* entry_ptr = map_ptr->entries + n_entry;
 
-            for (uint32_t n_element = 0;
-                          n_element < n_bin_elements;
-                        ++n_element)
+            if (entry_ptr->remove_callback != NULL)
             {
-                _system_hash64map_bin_entry* entry_ptr = NULL;
-
-                system_resizable_vector_get_element_at(map_ptr->bins[n_bin],
-                                                       n_element,
-                                                      &entry_ptr);
-
-                if (entry_ptr->remove_callback != NULL)
-                {
-                    entry_ptr->remove_callback(entry_ptr->remove_callback_argument);
-                }
+                entry_ptr->remove_callback(entry_ptr->remove_callback_argument);
             }
         }
+    }
 
-        system_resizable_vector_clear(map_ptr->bins[n_bin]);
-    } /* for (all bins) */
+    /* Drop all entries, but keep the storage around */
+    _system_hash64map_table_deinit(&map_ptr->old_table);
 
-    /* Since no entry uses remove call-back, we can just tell the resource pool to reset! */
-    system_resource_pool_return_all_allocations(map_ptr->bin_entry_pool);
+    memset(map_ptr->table.control,
+           CONTROL_EMPTY,
+           map_ptr->table.n_groups * GROUP_SIZE);
 
     map_ptr->any_entry_used_remove_callback = false;
+    map_ptr->n_entries                      = 0;
+    map_ptr->n_old_table_groups_migrated    = 0;
+    map_ptr->table.n_used_slots             = 0;
 
     if (map_ptr->access_mutex != NULL)
     {
@@ -193,8 +578,10 @@ PUBLIC EMERALD_API system_hash64map system_hash64map_create(size_t element_size,
 {
     _system_hash64map* hash64map_ptr = new _system_hash64map;
 
+    ASSERT_DEBUG_SYNC(element_size <= sizeof(void*),
+                      "Hash-map elements are stored by value and must not be larger than a pointer");
+
     _system_hash64map_init(hash64map_ptr,
-                           HASH64MAP_BINS_AMOUNT,
                            element_size,
                            should_be_thread_safe);
 
@@ -207,6 +594,7 @@ PUBLIC EMERALD_API bool system_hash64map_contains(system_hash64map hash_map,
                                                   system_hash64    hash)
 {
     _system_hash64map* hash64map_ptr = (_system_hash64map*) hash_map;
+    bool               result        = false;
 
     if (hash64map_ptr->access_mutex != NULL)
     {
@@ -214,36 +602,8 @@ PUBLIC EMERALD_API bool system_hash64map_contains(system_hash64map hash_map,
                                      ACCESS_READ);
     }
 
-    bool                    result            = false;
-    uint32_t                hash_index        = hash % hash64map_ptr->n_bins;
-    system_resizable_vector bin               = hash64map_ptr->bins[hash_index];
-    uint32_t                n_vector_elements = 0;
-
-    system_resizable_vector_get_property(bin,
-                                         SYSTEM_RESIZABLE_VECTOR_PROPERTY_N_ELEMENTS,
-                                        &n_vector_elements);
-
-    for (uint32_t n_element = 0;
-                  n_element < n_vector_elements;
-                ++n_element)
-    {
-        _system_hash64map_bin_entry* element    = NULL;
-        bool                         result_get = false;
-
-        result_get = system_resizable_vector_get_element_at(bin,
-                                                            n_element,
-                                                           &element);
-
-        ASSERT_DEBUG_SYNC(result_get,
-                          "Could not retrieve hash64map descriptor.");
-
-        if (element->hash == hash)
-        {
-            result = true;
-
-            break;
-        }
-    }
+    result = (_system_hash64map_find_entry_index(hash64map_ptr,
+                                                 hash) != NO_ENTRY_INDEX);
 
     if (hash64map_ptr->access_mutex != NULL)
     {
@@ -260,6 +620,7 @@ PUBLIC EMERALD_API bool system_hash64map_get(system_hash64map map,
                                              void*            result_element_ptr)
 {
     _system_hash64map* hash64map_ptr = (_system_hash64map*) map;
+    uint32_t           entry_index   = NO_ENTRY_INDEX;
 
     if (hash64map_ptr->access_mutex != NULL)
     {
@@ -267,39 +628,15 @@ PUBLIC EMERALD_API bool system_hash64map_get(system_hash64map map,
                                      ACCESS_READ);
     }
 
-    bool                    result            = false;
-    uint32_t                hash_index        = hash % hash64map_ptr->n_bins;
-    system_resizable_vector bin               = hash64map_ptr->bins[hash_index];
-    uint32_t                n_vector_elements = 0;
+    entry_index = _system_hash64map_find_entry_index(hash64map_ptr,
+                                                     hash);
 
-    system_resizable_vector_get_property(bin,
-                                         SYSTEM_RESIZABLE_VECTOR_PROPERTY_N_ELEMENTS,
-                                        &n_vector_elements);
-
-    for (uint32_t n_element = 0;
-                  n_element < n_vector_elements;
-                ++n_element)
+    if (entry_index       != NO_ENTRY_INDEX &&
+        result_element_ptr != NULL)
     {
-        _system_hash64map_bin_entry* bin_entry_descriptor = NULL;
-        bool                         result_get           = system_resizable_vector_get_element_at(bin,
-                                                                                                   n_element,
-                                                                                                  &bin_entry_descriptor);
-
-        ASSERT_DEBUG_SYNC(result_get,
-                          "Could not retreive bin entry descriptor.");
-
-        if (bin_entry_descriptor->hash == hash)
-        {
-            if (result_element_ptr != NULL)
-            {
-                memcpy(result_element_ptr,
-                      &bin_entry_descriptor->element,
-                       hash64map_ptr->element_size);
-            }
-
-            result = true;
-            break;
-        }
+        memcpy(result_element_ptr,
+              &hash64map_ptr->entries[entry_index].element,
+               hash64map_ptr->element_size);
     }
 
     if (hash64map_ptr->access_mutex != NULL)
@@ -308,7 +645,7 @@ PUBLIC EMERALD_API bool system_hash64map_get(system_hash64map map,
                                        ACCESS_READ);
     }
 
-    return result;
+    return (entry_index != NO_ENTRY_INDEX);
 }
 
 /** Please see header for specification */
@@ -318,6 +655,7 @@ PUBLIC EMERALD_API bool system_hash64map_get_element_at(system_hash64map map,
                                                         system_hash64*   result_hash_ptr)
 {
     _system_hash64map* hash64map_ptr = (_system_hash64map*) map;
+    bool               result        = false;
 
     if (hash64map_ptr->access_mutex != NULL)
     {
@@ -325,52 +663,23 @@ PUBLIC EMERALD_API bool system_hash64map_get_element_at(system_hash64map map,
                                      ACCESS_READ);
     }
 
-    uint32_t n_elements_counted = 0;
-    bool     result             = false;
-
-    for (uint32_t n_bin = 0;
-                  n_bin < hash64map_ptr->n_bins;
-                ++n_bin)
+    if (n_element < hash64map_ptr->n_entries)
     {
-        uint32_t n_elements_in_bin = 0;
-
-        system_resizable_vector_get_property(hash64map_ptr->bins[n_bin],
-                                             SYSTEM_RESIZABLE_VECTOR_PROPERTY_N_ELEMENTS,
-                                            &n_elements_in_bin);
+        const _system_hash64map_entry* entry_ptr = hash64map_ptr->entries + n_element;
 
-        if (n_elements_counted + n_elements_in_bin > n_element)
+        if (result_element_ptr != NULL)
         {
-            // The element is located in this bin.
-            _system_hash64map_bin_entry* bin_entry_ptr = NULL;
-            bool                         result_get    = false;
-
-            result_get = system_resizable_vector_get_element_at(hash64map_ptr->bins[n_bin],
-                                                                n_element - n_elements_counted,
-                                                               &bin_entry_ptr);
-
-            ASSERT_DEBUG_SYNC(result_get,
-                              "Could not retrieve hash64map bin descriptor.");
-
-            if (result_element_ptr != NULL)
-            {
-                memcpy(result_element_ptr,
-                      &bin_entry_ptr->element,
-                       hash64map_ptr->element_size);
-            }
-
-            if (result_hash_ptr != NULL)
-            {
-                *result_hash_ptr = bin_entry_ptr->hash;
-            }
-
-            result = true;
-            break;
+            memcpy(result_element_ptr,
+                  &entry_ptr->element,
+                   hash64map_ptr->element_size);
         }
-        else
+
+        if (result_hash_ptr != NULL)
         {
-            // The element is not in the bin.
-            n_elements_counted += n_elements_in_bin;
+            *result_hash_ptr = entry_ptr->hash;
         }
+
+        result = true;
     }
 
     if (hash64map_ptr->access_mutex != NULL)
@@ -402,16 +711,22 @@ PUBLIC EMERALD_API bool system_hash64map_is_equal(system_hash64map map_1,
     }
 
     if (map_1_ptr->element_size == map_2_ptr->element_size &&
-        map_1_ptr->n_bins       == map_2_ptr->n_bins)
+        map_1_ptr->n_entries    == map_2_ptr->n_entries)
     {
         result = true;
 
-        for (uint32_t n_bin = 0;
-                      n_bin < map_1_ptr->n_bins && result;
-                    ++n_bin)
+        for (uint32_t n_entry = 0;
+                      n_entry < map_1_ptr->n_entries && result;
+                    ++n_entry)
         {
-            result = system_resizable_vector_is_equal(map_1_ptr->bins[n_bin],
-                                                      map_2_ptr->bins[n_bin]);
+            const _system_hash64map_entry* entry_1_ptr   = map_1_ptr->entries + n_entry;
+            const uint32_t                 entry_2_index = _system_hash64map_find_entry_index(map_2_ptr,
+                                                                                              entry_1_ptr->hash);
+
+            result = (entry_2_index != NO_ENTRY_INDEX                                 &&
+                      memcmp(&entry_1_ptr->element,
+                             &map_2_ptr->entries[entry_2_index].element,
+                              map_1_ptr->element_size) == 0);
         }
     }
 
@@ -446,21 +761,8 @@ PUBLIC EMERALD_API void system_hash64map_get_property(system_hash64map
     {
         case SYSTEM_HASH64MAP_PROPERTY_N_ELEMENTS:
         {
-            uint32_t result = 0;
-
-            for (uint32_t n_bin = 0;
-                          n_bin < map_ptr->n_bins;
-                        ++n_bin)
-            {
-                unsigned int temp = 0;
-
-                system_resizable_vector_get_property(map_ptr->bins[n_bin],
-                                                     SYSTEM_RESIZABLE_VECTOR_PROPERTY_N_ELEMENTS,
-                                                    &temp);
-                result += temp;
-            }
+            *(uint32_t*) out_result_ptr = map_ptr->n_entries;
 
-            *(uint32_t*) out_result_ptr = result;
             break;
         }
 
@@ -494,59 +796,45 @@ PUBLIC EMERALD_API bool system_hash64map_insert(system_hash64map
                                      ACCESS_WRITE);
     }
 
-    uint32_t                hash_index = hash % hash64map_ptr->n_bins;
-    system_resizable_vector bin        = hash64map_ptr->bins[hash_index];
+    /* NOTE: As before, the hash-map does not verify whether an entry using the same hash has
+     *       already been stored, owing to the cost at execution time. */
+    _system_hash64map_migrate_old_table(hash64map_ptr,
+                                        HASH64MAP_N_GROUPS_MIGRATED_PER_CALL);
+    _system_hash64map_reserve_slot     (hash64map_ptr);
 
-    /* Create bin entry descriptor */
-    _system_hash64map_bin_entry* new_bin_entry_ptr = NULL;
+    /* Store the entry */
+    if (hash64map_ptr->n_entries == hash64map_ptr->n_entries_capacity)
+    {
+        _system_hash64map_entry* new_entries = new _system_hash64map_entry[hash64map_ptr->n_entries_capacity * 2];
 
-    new_bin_entry_ptr = (_system_hash64map_bin_entry*) system_resource_pool_get_from_pool(hash64map_ptr->bin_entry_pool);
+        memcpy(new_entries,
+               hash64map_ptr->entries,
+               sizeof(_system_hash64map_entry) * hash64map_ptr->n_entries);
 
-    _system_hash64map_bin_entry_init(new_bin_entry_ptr,
-                                     hash,
-                                     element,
-                                     callback,
-                                     callback_argument);
+        delete [] hash64map_ptr->entries;
 
-    /* In debug mode, before storing the entry, verify such element has not already
-     * been stored.
-     *
-     * NOTE: The check below has been disabled owing to significant cost at execution
-     *       time. Only enable for debugging purposes.
-     */
-#if 0
-    #ifdef _DEBUG
-    {
-        const uint32_t n_items = system_resizable_vector_get_amount_of_elements(bin);
+        hash64map_ptr->entries             = new_entries;
+        hash64map_ptr->n_entries_capacity *= 2;
+    }
 
-        for (uint32_t n_item = 0;
-                      n_item < n_items;
-                    ++n_item)
-        {
-            _system_hash64map_bin_entry_descriptor* item_ptr = NULL;
+    _system_hash64map_entry* new_entry_ptr = hash64map_ptr->entries + hash64map_ptr->n_entries;
 
-            if (!system_resizable_vector_get_element_at(bin, n_item, &item_ptr) )
-            {
-                ASSERT_DEBUG_SYNC(false,
-                                  "Could not retrieve requested item from the hash masp bin");
-            }
+    new_entry_ptr->element                  = element;
+    new_entry_ptr->hash                     = hash;
+    new_entry_ptr->remove_callback          = callback;
+    new_entry_ptr->remove_callback_argument = callback_argument;
 
-            ASSERT_DEBUG_SYNC(item_ptr->hash != hash,
-                              "The hash-map already stores item at user-requested index.");
-        } /* for (all items) */
-    }
-    #endif
-#endif
+    _system_hash64map_table_insert(&hash64map_ptr->table,
+                                    _system_hash64map_mix_hash(hash),
+                                    hash64map_ptr->n_entries);
+
+    hash64map_ptr->n_entries ++;
 
-    /* Store the entry */
     if (callback != NULL)
     {
         hash64map_ptr->any_entry_used_remove_callback = true;
     }
 
-    system_resizable_vector_push(bin,
-                                 new_bin_entry_ptr);
-
     /* Unlock rw mutex */
     if (hash64map_ptr->access_mutex != NULL)
     {
@@ -575,6 +863,9 @@ PUBLIC EMERALD_API bool system_hash64map_remove( system_hash64map map,
                                                  system_hash64    hash)
 {
     _system_hash64map* hash64map_ptr = (_system_hash64map*) map;
+    bool               result        = false;
+    uint32_t           slot          = 0;
+    _system_hash64map_table* table_ptr = NULL;
 
     if (hash64map_ptr->access_mutex != NULL)
     {
@@ -582,39 +873,49 @@ PUBLIC EMERALD_API bool system_hash64map_remove( system_hash64map map,
                                      ACCESS_WRITE);
     }
 
-    bool                    result            = false;
-    uint32_t                hash_index        = hash % hash64map_ptr->n_bins;
-    system_resizable_vector bin               = hash64map_ptr->bins[hash_index];
-    uint32_t                n_vector_elements = 0;
-
-    system_resizable_vector_get_property(bin,
-                                          SYSTEM_RESIZABLE_VECTOR_PROPERTY_N_ELEMENTS,
-                                         &n_vector_elements);
+    _system_hash64map_migrate_old_table(hash64map_ptr,
+                                        HASH64MAP_N_GROUPS_MIGRATED_PER_CALL);
 
-    for (uint32_t n_element = 0;
-                  n_element < n_vector_elements;
-                ++n_element)
+    if (_system_hash64map_find_slot(hash64map_ptr,
+                                    hash,
+                                    NO_ENTRY_INDEX,
+                                   &table_ptr,
+                                   &slot) )
     {
-        _system_hash64map_bin_entry* element_ptr = NULL;
-        bool                         result_get  = false;
+        const uint32_t           entry_index      = table_ptr->entry_indices[slot];
+        const uint32_t           last_entry_index = hash64map_ptr->n_entries - 1;
+        _system_hash64map_entry* entry_ptr        = hash64map_ptr->entries + entry_index;
 
-        result_get = system_resizable_vector_get_element_at(bin,
-                                                            n_element,
-                                                           &element_ptr);
+        _system_hash64map_table_erase_slot(table_ptr,
+                                           slot);
 
-        ASSERT_DEBUG_SYNC(result_get,
-                          "Could not retrieve hash64map bin entry descriptor.");
+        if (entry_ptr->remove_callback != NULL)
+        {
+            entry_ptr->remove_callback(entry_ptr->remove_callback_argument);
+        }
 
-        if (element_ptr->hash == hash)
+        /* Keep the entry array dense by moving the last entry into the freed location */
+        if (entry_index != last_entry_index)
         {
-            result = system_resizable_vector_delete_element_at(bin,
-                                                               n_element);
+            const _system_hash64map_entry* last_entry_ptr = hash64map_ptr->entries + last_entry_index;
+            bool                           result_find    = false;
 
-            _system_hash64map_bin_entry_deinit(hash64map_ptr,
-                                               element_ptr);
+            result_find = _system_hash64map_find_slot(hash64map_ptr,
+                                                      last_entry_ptr->hash,
+                                                      last_entry_index,
+                                                     &table_ptr,
+                                                     &slot);
 
-            break;
+            ASSERT_DEBUG_SYNC(result_find,
+                              "Could not find lookup table slot of the last hash64map entry.");
+
+            table_ptr->entry_indices[slot] = entry_index;
+            *entry_ptr                     = *last_entry_ptr;
         }
+
+        hash64map_ptr->n_entries --;
+
+        result = true;
     }
 
     if (hash64map_ptr->access_mutex != NULL)
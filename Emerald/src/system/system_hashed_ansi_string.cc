@@ -5,14 +5,30 @@
  */
 #include "shared.h"
 #include "system/system_assertions.h"
+#include "system/system_atomics.h"
 #include "system/system_critical_section.h"
 #include "system/system_hash64.h"
-#include "system/system_hash64map.h"
 #include "system/system_hashed_ansi_string.h"
+#include "system/system_log.h"
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
 
+/* Strings are interned in a table split into shards, selected by the top bits of the string hash.
+ * Each shard is an open-addressing hash table. Lookups do not take any locks: a table is never
+ * modified in a way which could confuse a concurrent reader, since descriptors are only ever
+ * added, and a table which needs to grow is copied instead of being rehashed in place. Old
+ * tables stay alive until the module is deinitialized.
+ *
+ * Inserts are serialized per shard. On top of that, each thread caches the strings it has
+ * recently looked up, so that repeated requests for the same string do not touch shared data. */
+#define N_SHARDS                  (64)  /* must be a power of two */
+#define N_SHARD_BITS              (6)
+#define SHARD_BASE_CAPACITY       (64)  /* must be a power of two */
+#define STATISTICS_FLUSH_INTERVAL (256)
+#define THREAD_CACHE_CAPACITY     (256) /* must be a power of two */
+
+
 /* Internal type definitions */
 typedef struct 
 {
@@ -21,34 +37,167 @@ typedef struct
     size_t        length;
 } _system_hashed_ansi_string_descriptor;
 
+typedef struct _system_hashed_ansi_string_table
+{
+    unsigned int    capacity;
+    void* volatile* descriptors;
+
+    /* Table this one has replaced, or NULL. Kept alive for lock-free readers. */
+    _system_hashed_ansi_string_table* prev_table_ptr;
+} _system_hashed_ansi_string_table;
+
+typedef struct
+{
+    system_critical_section cs;
+    unsigned int            n_descriptors;
+    void* volatile          table_ptr;
+} _system_hashed_ansi_string_shard;
+
+typedef struct
+{
+    const _system_hashed_ansi_string_descriptor* descriptors[THREAD_CACHE_CAPACITY];
+
+    /* Cache contents are only valid if this matches _generation. */
+    unsigned int generation;
+
+    /* Statistics, not yet added to the global counters. */
+    unsigned int n_cache_hits;
+    unsigned int n_lookups;
+} _system_hashed_ansi_string_thread_cache;
+
 /* Internal variables */
-system_hash64map          _dictionary    = NULL;
-system_critical_section   _dictionary_cs = system_critical_section_create();
-system_hashed_ansi_string _empty_string  = NULL;
+system_hashed_ansi_string                _empty_string   = NULL;
+PRIVATE volatile unsigned int            _generation     = 0;
+PRIVATE system_critical_section          _init_cs        = system_critical_section_create();
+PRIVATE volatile bool                    _is_initialized = false;
+PRIVATE volatile __uint64                _n_cache_hits   = 0;
+PRIVATE volatile unsigned int            _n_descriptors  = 0;
+PRIVATE volatile __uint64                _n_lookups      = 0;
+PRIVATE _system_hashed_ansi_string_shard _shards[N_SHARDS];
+
+#ifdef _WIN32
+    PRIVATE __declspec(thread) _system_hashed_ansi_string_thread_cache _thread_cache;
+#else
+    PRIVATE __thread _system_hashed_ansi_string_thread_cache _thread_cache;
+#endif
+
 
 /* Internal functions */
-/** TODO */
-PRIVATE void _init_system_hashed_ansi_string_descriptor( const char*                            text,
-                                                        _system_hashed_ansi_string_descriptor* descriptor)
+/** Atomically adds @param value to a 64-bit counter. */
+PRIVATE void _system_hashed_ansi_string_add_to_counter(volatile __uint64* counter_ptr,
+                                                       __uint64           value)
 {
-    size_t length = strlen(text);
+    __uint64 current_value;
 
-    descriptor->contents         = new char[length + 1];
-    descriptor->contents[length] = 0;
+    do
+    {
+        current_value = system_atomics_load_acquire_uint64(counter_ptr);
+    }
+    while (!system_atomics_compare_exchange_uint64(counter_ptr,
+                                                   current_value,
+                                                   current_value + value) );
+}
 
-    memcpy(descriptor->contents,
+/** Creates a descriptor for @param text. Contents are stored in the same allocation. */
+PRIVATE _system_hashed_ansi_string_descriptor* _system_hashed_ansi_string_create_descriptor(const char*   text,
+                                                                                             size_t        length,
+                                                                                             system_hash64 hash)
+{
+    char*                                  block_ptr  = new char[sizeof(_system_hashed_ansi_string_descriptor) + length + 1];
+    _system_hashed_ansi_string_descriptor* result_ptr = (_system_hashed_ansi_string_descriptor*) block_ptr;
+
+    result_ptr->contents         = block_ptr + sizeof(_system_hashed_ansi_string_descriptor);
+    result_ptr->contents[length] = 0;
+    result_ptr->hash             = hash;
+    result_ptr->length           = length;
+
+    memcpy(result_ptr->contents,
            text,
            length);
 
-    descriptor->length = length;
-    descriptor->hash   = system_hash64_calculate(text, (uint32_t) length);
+    return result_ptr;
 }
 
-/** TODO */
-PRIVATE void _deinit_system_hashed_ansi_string_descriptor(_system_hashed_ansi_string_descriptor* descriptor)
+/** Creates an empty table with @param capacity slots. */
+PRIVATE _system_hashed_ansi_string_table* _system_hashed_ansi_string_create_table(unsigned int capacity)
 {
-    delete [] descriptor->contents;
-    delete descriptor;
+    _system_hashed_ansi_string_table* result_ptr = new _system_hashed_ansi_string_table;
+
+    result_ptr->capacity       = capacity;
+    result_ptr->descriptors    = new void*[capacity];
+    result_ptr->prev_table_ptr = NULL;
+
+    memset((void*) result_ptr->descriptors,
+           0,
+           sizeof(void*) * capacity);
+
+    return result_ptr;
+}
+
+/** Looks for a descriptor holding @param text in a table. Safe to call without holding
+ *  the shard's lock.
+ *
+ *  @return Descriptor, or NULL if the string is not stored in the table.
+ */
+PRIVATE _system_hashed_ansi_string_descriptor* _system_hashed_ansi_string_find_descriptor(_system_hashed_ansi_string_table* table_ptr,
+                                                                                          const char*                       text,
+                                                                                          size_t                            length,
+                                                                                          system_hash64                     hash)
+{
+    const unsigned int mask  = table_ptr->capacity - 1;
+    unsigned int       index = (unsigned int) hash & mask;
+
+    while (true)
+    {
+        _system_hashed_ansi_string_descriptor* descriptor_ptr = (_system_hashed_ansi_string_descriptor*) system_atomics_load_acquire_pointer(table_ptr->descriptors + index);
+
+        if (descriptor_ptr == NULL)
+        {
+            return NULL;
+        }
+
+        /* Equal hashes do not imply equal strings */
+        if (descriptor_ptr->hash   == hash   &&
+            descriptor_ptr->length == length &&
+            memcmp(descriptor_ptr->contents,
+                   text,
+                   length) == 0)
+        {
+            return descriptor_ptr;
+        }
+
+        index = (index + 1) & mask;
+    }
+}
+
+/** Flushes the calling thread's statistics to the global counters. */
+PRIVATE void _system_hashed_ansi_string_flush_thread_statistics()
+{
+    _system_hashed_ansi_string_add_to_counter(&_n_cache_hits,
+                                              _thread_cache.n_cache_hits);
+    _system_hashed_ansi_string_add_to_counter(&_n_lookups,
+                                              _thread_cache.n_lookups);
+
+    _thread_cache.n_cache_hits = 0;
+    _thread_cache.n_lookups    = 0;
+}
+
+/** Stores a descriptor in a table. The caller must hold the shard's lock and make sure
+ *  the table has a free slot. */
+PRIVATE void _system_hashed_ansi_string_insert_descriptor(_system_hashed_ansi_string_table*      table_ptr,
+                                                          _system_hashed_ansi_string_descriptor* descriptor_ptr)
+{
+    const unsigned int mask  = table_ptr->capacity - 1;
+    unsigned int       index = (unsigned int) descriptor_ptr->hash & mask;
+
+    while (table_ptr->descriptors[index] != NULL)
+    {
+        index = (index + 1) & mask;
+    }
+
+    /* Publish the slot only after the descriptor has been fully initialized */
+    system_atomics_store_release_pointer(table_ptr->descriptors + index,
+                                         descriptor_ptr);
 }
 
 /** Please see header for specification */
@@ -72,67 +221,133 @@ PUBLIC EMERALD_API bool system_hashed_ansi_string_contains(system_hashed_ansi_st
 /** Please see header for specification */
 PUBLIC EMERALD_API system_hashed_ansi_string system_hashed_ansi_string_create(const char* raw)
 {
-    system_hashed_ansi_string result = NULL;
+    const _system_hashed_ansi_string_descriptor** cached_descriptor_ptr_ptr = NULL;
+    system_hash64                                 hash                      = 0;
+    size_t                                        length                    = 0;
+    _system_hashed_ansi_string_descriptor*        result_ptr                = NULL;
+    _system_hashed_ansi_string_shard*             shard_ptr                 = NULL;
 
-    system_critical_section_enter(_dictionary_cs);
+    if (!_is_initialized)
     {
-        if (_dictionary == NULL)
-        {
-            system_hashed_ansi_string_init();
-        };
+        system_hashed_ansi_string_init();
+    }
 
-        if (raw == NULL)
-        {
-            result = NULL;
+    if (raw == NULL)
+    {
+        goto end;
+    }
 
-            goto end;
-        }
+    length = strlen(raw);
+    hash   = system_hash64_calculate(raw,
+                                     (uint32_t) length);
+
+    /* Try the thread-local cache first. Use hash bits which select neither the shard nor the slot. */
+    if (_thread_cache.generation != _generation)
+    {
+        memset(_thread_cache.descriptors,
+               0,
+               sizeof(_thread_cache.descriptors) );
 
-        if (_dictionary != NULL)
+        _thread_cache.generation = _generation;
+    }
+
+    _thread_cache.n_lookups++;
+
+    cached_descriptor_ptr_ptr = _thread_cache.descriptors + ((hash >> 32) & (THREAD_CACHE_CAPACITY - 1));
+
+    if (*cached_descriptor_ptr_ptr                   != NULL   &&
+        (*cached_descriptor_ptr_ptr)->hash           == hash   &&
+        (*cached_descriptor_ptr_ptr)->length         == length &&
+        memcmp((*cached_descriptor_ptr_ptr)->contents,
+               raw,
+               length) == 0)
+    {
+        _thread_cache.n_cache_hits++;
+
+        result_ptr = (_system_hashed_ansi_string_descriptor*) *cached_descriptor_ptr_ptr;
+
+        goto end;
+    }
+
+    /* Lock-free lookup */
+    shard_ptr  = _shards + (hash >> (64 - N_SHARD_BITS) );
+    result_ptr = _system_hashed_ansi_string_find_descriptor((_system_hashed_ansi_string_table*) system_atomics_load_acquire_pointer(&shard_ptr->table_ptr),
+                                                            raw,
+                                                            length,
+                                                            hash);
+
+    if (result_ptr == NULL)
+    {
+        system_critical_section_enter(shard_ptr->cs);
         {
-            /* Check if the entry has not already been created. */
-            void*                     found_entry = 0;
-            system_hash64             hash        = system_hash64_calculate(raw,
-                                                                            (uint32_t) strlen(raw) );
-
-            if (system_hash64map_get(_dictionary,
-                                     hash,
-                                    &found_entry) )
-            {
-                result = (system_hashed_ansi_string) found_entry;
-            }
-            else
-            {
-                _system_hashed_ansi_string_descriptor* new_descriptor = new _system_hashed_ansi_string_descriptor;
+            _system_hashed_ansi_string_table* table_ptr = (_system_hashed_ansi_string_table*) shard_ptr->table_ptr;
 
-                _init_system_hashed_ansi_string_descriptor(raw,
-                                                           new_descriptor);
-                system_hash64map_insert                   (_dictionary,
-                                                           hash,
-                                                           new_descriptor,
-                                                           0,  /* on_remove_callback_proc          */
-                                                           0); /* on_remove_callback_proc_user_arg */
+            /* Another thread may have added the string in the meantime */
+            result_ptr = _system_hashed_ansi_string_find_descriptor(table_ptr,
+                                                                    raw,
+                                                                    length,
+                                                                    hash);
 
-                result = (system_hashed_ansi_string) new_descriptor;
+            if (result_ptr == NULL)
+            {
+                result_ptr = _system_hashed_ansi_string_create_descriptor(raw,
+                                                                          length,
+                                                                          hash);
+
+                /* Keep the load factor under 3/4 */
+                if ((shard_ptr->n_descriptors + 1) * 4 > table_ptr->capacity * 3)
+                {
+                    _system_hashed_ansi_string_table* new_table_ptr = _system_hashed_ansi_string_create_table(table_ptr->capacity * 2);
+
+                    for (unsigned int n_descriptor = 0;
+                                      n_descriptor < table_ptr->capacity;
+                                    ++n_descriptor)
+                    {
+                        if (table_ptr->descriptors[n_descriptor] != NULL)
+                        {
+                            _system_hashed_ansi_string_insert_descriptor(new_table_ptr,
+                                                                         (_system_hashed_ansi_string_descriptor*) table_ptr->descriptors[n_descriptor]);
+                        }
+                    }
+
+                    new_table_ptr->prev_table_ptr = table_ptr;
+                    table_ptr                     = new_table_ptr;
+
+                    system_atomics_store_release_pointer(&shard_ptr->table_ptr,
+                                                         new_table_ptr);
+                }
+
+                _system_hashed_ansi_string_insert_descriptor(table_ptr,
+                                                             result_ptr);
+
+                shard_ptr->n_descriptors++;
+                system_atomics_increment(&_n_descriptors);
             }
         }
+        system_critical_section_leave(shard_ptr->cs);
     }
+
+    *cached_descriptor_ptr_ptr = result_ptr;
+
 end:
-    system_critical_section_leave(_dictionary_cs);
+    if (_thread_cache.n_lookups >= STATISTICS_FLUSH_INTERVAL)
+    {
+        _system_hashed_ansi_string_flush_thread_statistics();
+    }
 
-    return result;
+    return (system_hashed_ansi_string) result_ptr;
 }
 
 /* Please see header for specification */
 PUBLIC EMERALD_API system_hashed_ansi_string system_hashed_ansi_string_create_by_merging_strings(      uint32_t n_strings,
                                                                                                  const char**   strings)
 {
-    if (_dictionary == NULL)
+    if (!_is_initialized)
     {
         system_hashed_ansi_string_init();
     };
 
-    ASSERT_DEBUG_SYNC(_dictionary != NULL,
+    ASSERT_DEBUG_SYNC(_is_initialized,
                       "Dictionary not initialized.");
 
     /* Sum length of all strings*/
@@ -186,12 +401,12 @@ PUBLIC EMERALD_API system_hashed_ansi_string system_hashed_ansi_string_create_by
 PUBLIC EMERALD_API system_hashed_ansi_string system_hashed_ansi_string_create_by_merging_two_strings(const char* src1,
                                                                                                      const char* src2)
 {
-    if (_dictionary == NULL)
+    if (!_is_initialized)
     {
         system_hashed_ansi_string_init();
     };
 
-    ASSERT_DEBUG_SYNC(_dictionary != NULL,
+    ASSERT_DEBUG_SYNC(_is_initialized,
                       "Dictionary not initialized.");
 
     /* Go for it */
@@ -307,6 +522,64 @@ PUBLIC EMERALD_API uint32_t system_hashed_ansi_string_get_length(system_hashed_a
     }
 }
 
+/** Please see header for specification */
+PUBLIC EMERALD_API void system_hashed_ansi_string_get_property(system_hashed_ansi_string_property property,
+                                                               void*                              out_result_ptr)
+{
+    /* Make sure the calling thread's requests are accounted for */
+    _system_hashed_ansi_string_flush_thread_statistics();
+
+    switch (property)
+    {
+        case SYSTEM_HASHED_ANSI_STRING_PROPERTY_HIT_RATE:
+        {
+            const __uint64 n_lookups = _n_lookups;
+
+            if (n_lookups == 0)
+            {
+                *(float*) out_result_ptr = 0.0f;
+            }
+            else
+            {
+                /* Every string which has been created required a lookup which did not hit. Strings created
+                 * by other threads may not have been accounted for yet, hence the clamp. */
+                const __uint64 n_misses = (_n_descriptors < n_lookups) ? _n_descriptors : n_lookups;
+
+                *(float*) out_result_ptr = float(double(n_lookups - n_misses) / double(n_lookups) );
+            }
+
+            break;
+        }
+
+        case SYSTEM_HASHED_ANSI_STRING_PROPERTY_N_CACHE_HITS:
+        {
+            *(__uint64*) out_result_ptr = _n_cache_hits;
+
+            break;
+        }
+
+        case SYSTEM_HASHED_ANSI_STRING_PROPERTY_N_LOOKUPS:
+        {
+            *(__uint64*) out_result_ptr = _n_lookups;
+
+            break;
+        }
+
+        case SYSTEM_HASHED_ANSI_STRING_PROPERTY_N_STRINGS:
+        {
+            *(unsigned int*) out_result_ptr = _n_descriptors;
+
+            break;
+        }
+
+        default:
+        {
+            ASSERT_DEBUG_SYNC(false,
+                              "Unrecognized system_hashed_ansi_string_property value");
+        }
+    } /* switch (property) */
+}
+
 /** Please see header for specification */
 PUBLIC EMERALD_API const char* system_hashed_ansi_string_get_buffer(system_hashed_ansi_string string)
 {
@@ -371,54 +644,85 @@ PUBLIC EMERALD_API bool system_hashed_ansi_string_is_equal_to_hash_string(system
 /** Please see header for specification */
 PUBLIC void system_hashed_ansi_string_init()
 {
-    _dictionary   = system_hash64map_create         (sizeof(_system_hashed_ansi_string_descriptor*),
-                                                     true); /* should_be_thread_safe */
-    _empty_string = system_hashed_ansi_string_create("");
+    system_critical_section_enter(_init_cs);
+    {
+        if (!_is_initialized)
+        {
+            for (unsigned int n_shard = 0;
+                              n_shard < N_SHARDS;
+                            ++n_shard)
+            {
+                _shards[n_shard].cs            = system_critical_section_create();
+                _shards[n_shard].n_descriptors = 0;
+                _shards[n_shard].table_ptr     = _system_hashed_ansi_string_create_table(SHARD_BASE_CAPACITY);
+            }
+
+            /* Invalidate any thread caches which may have been filled before the last deinit */
+            _generation++;
+
+            system_atomics_memory_barrier();
+
+            _is_initialized = true;
+            _empty_string   = system_hashed_ansi_string_create("");
+        }
+    }
+    system_critical_section_leave(_init_cs);
 }
 
 /** Please see header for specification */
 PUBLIC void system_hashed_ansi_string_deinit()
 {
-    ASSERT_DEBUG_SYNC(_dictionary != NULL,
+    ASSERT_DEBUG_SYNC(_is_initialized,
                       "Dictionary not initialized");
     ASSERT_DEBUG_SYNC(_empty_string != NULL,
                       "Empty string not initialized.");
 
-    if (_dictionary != NULL)
+    if (_is_initialized)
     {
-        uint32_t n_dictionary_items = 0;
+        float hit_rate = 0.0f;
+
+        system_hashed_ansi_string_get_property(SYSTEM_HASHED_ANSI_STRING_PROPERTY_HIT_RATE,
+                                              &hit_rate);
 
-        system_hash64map_get_property(_dictionary,
-                                      SYSTEM_HASH64MAP_PROPERTY_N_ELEMENTS,
-                                     &n_dictionary_items);
+        LOG_INFO("Hashed ansi strings: [%u] unique strings, [%.2f%%] of requests returned an existing string.",
+                 _n_descriptors,
+                 hit_rate * 100.0f);
 
-        for (uint32_t n_dictionary_item = 0;
-                      n_dictionary_item < n_dictionary_items;
-                    ++n_dictionary_item)
+        _is_initialized = false;
+
+        for (unsigned int n_shard = 0;
+                          n_shard < N_SHARDS;
+                        ++n_shard)
         {
-            _system_hashed_ansi_string_descriptor* descriptor_ptr = NULL;
-            system_hash64                          temp           = 0;
+            _system_hashed_ansi_string_table* table_ptr = (_system_hashed_ansi_string_table*) _shards[n_shard].table_ptr;
 
-            if (!system_hash64map_get_element_at(_dictionary,
-                                                 n_dictionary_item,
-                                                &descriptor_ptr,
-                                                &temp) )
+            /* Only the most recent table owns the descriptors */
+            for (unsigned int n_descriptor = 0;
+                              n_descriptor < table_ptr->capacity;
+                            ++n_descriptor)
             {
-                continue;
+                delete [] (char*) table_ptr->descriptors[n_descriptor];
             }
 
-            _deinit_system_hashed_ansi_string_descriptor(descriptor_ptr);
-        }
+            while (table_ptr != NULL)
+            {
+                _system_hashed_ansi_string_table* prev_table_ptr = table_ptr->prev_table_ptr;
 
-        system_hash64map_release(_dictionary);
+                delete [] table_ptr->descriptors;
+                delete table_ptr;
 
-        _dictionary = NULL;
-    }
+                table_ptr = prev_table_ptr;
+            }
 
-    if (_dictionary_cs != NULL)
-    {
-        system_critical_section_release(_dictionary_cs);
-    }
+            system_critical_section_release(_shards[n_shard].cs);
+
+            _shards[n_shard].cs        = NULL;
+            _shards[n_shard].table_ptr = NULL;
+        }
 
-    /* TODO: Leaking dictionary contents here. Oh well */
+        _empty_string  = NULL;
+        _n_cache_hits  = 0;
+        _n_descriptors = 0;
+        _n_lookups     = 0;
+    }
 }
@@ -1,87 +1,1162 @@
 /**
  *
- * Emerald (kbi/elude @2012-2015)
+ * Emerald (kbi/elude @2012-2016)
  *
  */
 #include "shared.h"
+#include "system/system_atomics.h"
 #include "system/system_critical_section.h"
 #include "system/system_log.h"
+#include "system/system_resizable_vector.h"
 #include "system/system_threads.h"
+#include <stdarg.h>
+#include <stdlib.h>
+#include <vector>
 
-system_critical_section log_file_handle_cs = NULL;
-FILE*                   log_file_handle    = NULL;
+#ifndef _WIN32
+    #include <pthread.h>
+    #include <unistd.h>
+#endif
+
+/* Defines for how long the writer thread can sleep, if there is nothing to write. */
+#define MAX_IDLE_SLEEP_MSEC (16)
+
+/* Defines maximum number of entries written in one go. System_log_write() callers may need to wait
+ * until the batch is written. */
+#define MAX_ENTRIES_PER_BATCH (4096)
+
+/* Marks a NULL string argument */
+#define NULL_STRING_LENGTH (0xFFFFFFFF)
+
+
+typedef struct
+{
+    const char*         file;
+    const char*         format;
+    unsigned char*      heap_data_ptr; /* Holds captured arguments, if they do not fit in data */
+    bool                include_prefix;
+    system_log_priority level;
+    int                 line;
+    unsigned int        n_args;
+    unsigned int        sequence;
+    unsigned char       data[LOG_ENTRY_INLINE_DATA_SIZE];
+} _system_log_entry;
+
+typedef struct
+{
+    /* Index of the next entry to write. Only modified by the writer. */
+    volatile unsigned int head;
+
+    _system_log_entry entries[LOG_RING_BUFFER_CAPACITY];
+
+    /* Index of the next free entry. Only modified by the owning thread.
+     *
+     * Kept away from the head, so that the owning thread and the writer do not fight for the same cache line. */
+    volatile unsigned int tail;
+
+    volatile unsigned int n_dropped_entries; /* Only modified by the owning thread */
+    volatile unsigned int is_released;       /* Set once the owning thread has quit */
+    system_thread_id      thread_id;
+} _system_log_ring;
+
+
+/* Please see header for specification. Drop all entries until the log is initialized. */
+volatile int _system_log_level = LOGLEVEL_FATAL + 1;
+
+PRIVATE FILE*                   _system_log_file_handle                = NULL;
+PRIVATE __uint64                _system_log_n_released_dropped_entries = 0;
+PRIVATE volatile __uint64       _system_log_n_written_entries          = 0;
+PRIVATE volatile unsigned int   _system_log_next_sequence              = 0;
+PRIVATE volatile int            _system_log_requested_level            = LOGLEVEL_BASE;
+PRIVATE system_resizable_vector _system_log_rings                      = NULL;
+PRIVATE system_critical_section _system_log_rings_cs                   = NULL;
+PRIVATE system_critical_section _system_log_writer_cs                  = NULL;
+PRIVATE volatile bool           _system_log_writer_should_quit         = false;
+
+/* Writer-side state. Only accessed while holding _system_log_writer_cs */
+PRIVATE std::vector<_system_log_ring*> _system_log_rings_snapshot;
+PRIVATE char                           _system_log_text[LOG_MAX_LENGTH];
+
+#ifdef _WIN32
+    PRIVATE HANDLE _system_log_writer_thread = NULL;
+
+    __declspec(thread) _system_log_ring* _system_log_thread_ring_ptr = NULL;
+#else
+    PRIVATE pthread_t _system_log_writer_thread;
+
+    __thread _system_log_ring* _system_log_thread_ring_ptr = NULL;
+#endif
+
+
+/** Appends formatted text to a buffer, making sure the buffer is never overrun.
+ *
+ *  @return Number of characters appended.
+ */
+PRIVATE size_t _system_log_append(char*       buffer_ptr,
+                                  size_t      buffer_size,
+                                  const char* format,
+                                  ...)
+{
+    va_list arguments;
+    int     result;
+
+    if (buffer_size <= 1)
+    {
+        return 0;
+    }
+
+    va_start(arguments,
+             format);
+    {
+        result = vsnprintf(buffer_ptr,
+                           buffer_size,
+                           format,
+                           arguments);
+    }
+    va_end(arguments);
+
+    if (result < 0)
+    {
+        /* Older MSVC runtimes report truncation this way */
+        buffer_ptr[buffer_size - 1] = 0;
+
+        return strlen(buffer_ptr);
+    }
+
+    return ((size_t) result < buffer_size) ? (size_t) result
+                                           : buffer_size - 1;
+}
+
+/** Creates and registers a ring buffer for the calling thread.
+ *
+ *  @return The new ring buffer, or NULL if the log has not been initialized.
+ */
+PRIVATE _system_log_ring* _system_log_create_thread_ring()
+{
+    _system_log_ring* ring_ptr = NULL;
+
+    if (_system_log_rings_cs == NULL)
+    {
+        goto end;
+    }
+
+    ring_ptr = new (std::nothrow) _system_log_ring;
+
+    if (ring_ptr == NULL)
+    {
+        goto end;
+    }
+
+    ring_ptr->head              = 0;
+    ring_ptr->is_released       = 0;
+    ring_ptr->n_dropped_entries = 0;
+    ring_ptr->tail              = 0;
+    ring_ptr->thread_id         = system_threads_get_thread_id();
+
+    system_critical_section_enter(_system_log_rings_cs);
+    {
+        system_resizable_vector_push(_system_log_rings,
+                                     ring_ptr);
+    }
+    system_critical_section_leave(_system_log_rings_cs);
+
+    _system_log_thread_ring_ptr = ring_ptr;
+
+end:
+    return ring_ptr;
+}
+
+/** Reads the next captured argument.
+ *
+ *  @return true if successful, false if all arguments have already been read.
+ */
+PRIVATE bool _system_log_read_arg(const unsigned char** data_ptr_ptr,
+                                  unsigned int*         n_args_left_ptr,
+                                  _system_log_arg*      out_arg_ptr)
+{
+    const unsigned char* data_ptr = *data_ptr_ptr;
+
+    if (*n_args_left_ptr == 0)
+    {
+        return false;
+    }
+
+    out_arg_ptr->type = (_system_log_arg_type) *(data_ptr++);
+
+    switch (out_arg_ptr->type)
+    {
+        case _SYSTEM_LOG_ARG_TYPE_DOUBLE:
+        {
+            memcpy(&out_arg_ptr->double_value,
+                   data_ptr,
+                   sizeof(double) );
+
+            data_ptr += sizeof(double);
+
+            break;
+        }
+
+        case _SYSTEM_LOG_ARG_TYPE_INTEGER:
+        {
+            memcpy(&out_arg_ptr->integer_value,
+                   data_ptr,
+                   sizeof(__int64) );
+
+            data_ptr += sizeof(__int64);
+
+            break;
+        }
+
+        case _SYSTEM_LOG_ARG_TYPE_POINTER:
+        {
+            memcpy(&out_arg_ptr->pointer_value,
+                   data_ptr,
+                   sizeof(void*) );
+
+            data_ptr += sizeof(void*);
+
+            break;
+        }
+
+        case _SYSTEM_LOG_ARG_TYPE_STRING:
+        {
+            uint32_t length;
+
+            memcpy(&length,
+                   data_ptr,
+                   sizeof(length) );
+
+            data_ptr += sizeof(length);
+
+            if (length == NULL_STRING_LENGTH)
+            {
+                out_arg_ptr->string_value = NULL;
+            }
+            else
+            {
+                out_arg_ptr->string_value = (const char*) data_ptr;
+
+                data_ptr += length + 1;
+            }
+
+            break;
+        }
+    } /* switch (out_arg_ptr->type) */
+
+    *data_ptr_ptr = data_ptr;
+    (*n_args_left_ptr)--;
+
+    return true;
+}
+
+/** Formats a log entry, using printf() rules.
+ *
+ *  @return Number of characters written to @param buffer_ptr.
+ */
+PRIVATE size_t _system_log_format(char*                buffer_ptr,
+                                  size_t               buffer_size,
+                                  const char*          format,
+                                  unsigned int         n_args,
+                                  const unsigned char* data_ptr)
+{
+    size_t length = 0;
+
+    while (*format != 0 && length + 1 < buffer_size)
+    {
+        _system_log_arg arg;
+        unsigned int    n_length_bits = 32;
+        char            spec[64];
+        size_t          spec_length   = 0;
+        const char*     spec_start_ptr;
+
+        if (*format != '%')
+        {
+            buffer_ptr[length++] = *(format++);
+
+            continue;
+        }
+
+        if (format[1] == '%')
+        {
+            buffer_ptr[length++] = '%';
+            format              += 2;
+
+            continue;
+        }
+
+        /* Copy flags, width and precision. Asterisks are replaced with the values of the corresponding arguments. */
+        spec_start_ptr         = format;
+        spec[spec_length++]    = *(format++);
+
+        while (*format != 0 && spec_length < sizeof(spec) - 24)
+        {
+            if (*format == '*')
+            {
+                int value = 0;
+
+                if (_system_log_read_arg(&data_ptr,
+                                         &n_args,
+                                         &arg) &&
+                    arg.type == _SYSTEM_LOG_ARG_TYPE_INTEGER)
+                {
+                    value = (int) arg.integer_value;
+                }
+
+                spec_length += _system_log_append(spec + spec_length,
+                                                  sizeof(spec) - spec_length,
+                                                  "%d",
+                                                  value);
+                format++;
+            }
+            else
+            if (strchr("-+ #0'.0123456789",
+                       *format) != NULL)
+            {
+                spec[spec_length++] = *(format++);
+            }
+            else
+            {
+                break;
+            }
+        }
+
+        /* Length modifiers only affect how integer arguments need to be truncated */
+        while (*format != 0 && strchr("hljztLqI",
+                                      *format) != NULL)
+        {
+            switch (*format)
+            {
+                case 'h': n_length_bits = (n_length_bits == 16) ? 8 : 16; break;
+                case 'j':
+                case 'q':
+                case 'L': n_length_bits = 64;                                    break;
+                case 'l': n_length_bits = (n_length_bits == 32) ? sizeof(long) * 8 : 64; break;
+                case 'z':
+                case 't': n_length_bits = sizeof(size_t) * 8;                    break;
+
+                case 'I':
+                {
+                    if (format[1] == '6' && format[2] == '4')
+                    {
+                        n_length_bits = 64;
+                        format       += 2;
+                    }
+                    else
+                    if (format[1] == '3' && format[2] == '2')
+                    {
+                        n_length_bits = 32;
+                        format       += 2;
+                    }
+                    else
+                    {
+                        n_length_bits = sizeof(size_t) * 8;
+                    }
+
+                    break;
+                }
+            }
+
+            format++;
+        }
+
+        if (*format == 0)
+        {
+            /* Incomplete conversion specification. Print it as-is. */
+            length += _system_log_append(buffer_ptr  + length,
+                                         buffer_size - length,
+                                         "%s",
+                                         spec_start_ptr);
+
+            break;
+        }
+
+        spec[spec_length]     = *(format++);
+        spec[spec_length + 1] = 0;
+
+        if (!_system_log_read_arg(&data_ptr,
+                                  &n_args,
+                                  &arg) )
+        {
+            length += _system_log_append(buffer_ptr  + length,
+                                         buffer_size - length,
+                                         "<missing argument>");
+
+            continue;
+        }
+
+        switch (spec[spec_length])
+        {
+            case 'c':
+            case 'd':
+            case 'i':
+            case 'o':
+            case 'u':
+            case 'x':
+            case 'X':
+            {
+                const char conversion = spec[spec_length];
+                __int64    value      = arg.integer_value;
+
+                if (arg.type != _SYSTEM_LOG_ARG_TYPE_INTEGER)
+                {
+                    goto mismatch;
+                }
+
+                if (conversion == 'c')
+                {
+                    length += _system_log_append(buffer_ptr  + length,
+                                                 buffer_size - length,
+                                                 spec,
+                                                 (int) value);
+
+                    break;
+                }
+
+                /* Mimic the truncation printf() would have applied, then print as a 64-bit value */
+                if (n_length_bits < 64)
+                {
+                    const __uint64 mask = (1ull << n_length_bits) - 1;
+
+                    if (conversion == 'd' || conversion == 'i')
+                    {
+                        const __uint64 sign_bit = 1ull << (n_length_bits - 1);
+
+                        value = (__int64) ((((__uint64) value & mask) ^ sign_bit) - sign_bit);
+                    }
+                    else
+                    {
+                        value = (__int64) ((__uint64) value & mask);
+                    }
+                }
+
+                spec[spec_length]     = 'l';
+                spec[spec_length + 1] = 'l';
+                spec[spec_length + 2] = conversion;
+                spec[spec_length + 3] = 0;
+
+                if (conversion == 'd' || conversion == 'i')
+                {
+                    length += _system_log_append(buffer_ptr  + length,
+                                                 buffer_size - length,
+                                                 spec,
+                                                 (long long) value);
+                }
+                else
+                {
+                    length += _system_log_append(buffer_ptr  + length,
+                                                 buffer_size - length,
+                                                 spec,
+                                                 (unsigned long long) value);
+                }
+
+                break;
+            }
+
+            case 'a':
+            case 'A':
+            case 'e':
+            case 'E':
+            case 'f':
+            case 'F':
+            case 'g':
+            case 'G':
+            {
+                if (arg.type != _SYSTEM_LOG_ARG_TYPE_DOUBLE)
+                {
+                    goto mismatch;
+                }
+
+                length += _system_log_append(buffer_ptr  + length,
+                                             buffer_size - length,
+                                             spec,
+                                             arg.double_value);
+
+                break;
+            }
+
+            case 'p':
+            {
+                if (arg.type != _SYSTEM_LOG_ARG_TYPE_POINTER)
+                {
+                    goto mismatch;
+                }
+
+                length += _system_log_append(buffer_ptr  + length,
+                                             buffer_size - length,
+                                             spec,
+                                             arg.pointer_value);
+
+                break;
+            }
+
+            case 's':
+            {
+                if (arg.type != _SYSTEM_LOG_ARG_TYPE_STRING)
+                {
+                    goto mismatch;
+                }
+
+                length += _system_log_append(buffer_ptr  + length,
+                                             buffer_size - length,
+                                             spec,
+                                             (arg.string_value != NULL) ? arg.string_value
+                                                                        : "(null)");
+
+                break;
+            }
+
+            default:
+            {
+                /* %n and unknown conversions. The argument has been consumed, so just skip it. */
+                break;
+            }
+        } /* switch (conversion) */
+
+        continue;
+
+mismatch:
+        length += _system_log_append(buffer_ptr  + length,
+                                     buffer_size - length,
+                                     "<argument type mismatch>");
+    }
+
+    buffer_ptr[length] = 0;
+
+    return length;
+}
+
+/** Writes a formatted line to all log outputs. */
+PRIVATE void _system_log_output(const char*      text,
+                                bool             include_tid_info,
+                                system_thread_id thread_id)
+{
+    char tid_info[32];
+
+    if (include_tid_info)
+    {
+        snprintf(tid_info,
+                 sizeof(tid_info),
+                 "[tid:%08x] ",
+                 (unsigned int) thread_id);
+    }
+    else
+    {
+        tid_info[0] = 0;
+    }
+
+#ifdef _WIN32
+    ::OutputDebugStringA(tid_info);
+    ::OutputDebugStringA(text);
+    ::OutputDebugStringA("\n");
+#else
+    printf("%s%s\n",
+           tid_info,
+           text);
+#endif
+
+    if (_system_log_file_handle != NULL)
+    {
+        fwrite(text,
+               strlen(text),
+               1, /* _Count */
+               _system_log_file_handle);
+        fwrite("\n",
+               1, /* _Size  */
+               1, /* _Count */
+               _system_log_file_handle);
+    }
+}
+
+/** Writes queued entries, oldest first. The caller must hold _system_log_writer_cs.
+ *
+ *  @return Number of entries written.
+ */
+PRIVATE unsigned int _system_log_drain()
+{
+    unsigned int n_entries_written = 0;
+    unsigned int n_rings           = 0;
+
+    system_critical_section_enter(_system_log_rings_cs);
+    {
+        system_resizable_vector_get_property(_system_log_rings,
+                                             SYSTEM_RESIZABLE_VECTOR_PROPERTY_N_ELEMENTS,
+                                            &n_rings);
+
+        _system_log_rings_snapshot.resize(n_rings);
+
+        for (unsigned int n_ring = 0;
+                          n_ring < n_rings;
+                        ++n_ring)
+        {
+            system_resizable_vector_get_element_at(_system_log_rings,
+                                                   n_ring,
+                                                  &_system_log_rings_snapshot[n_ring]);
+        }
+    }
+    system_critical_section_leave(_system_log_rings_cs);
+
+    while (n_entries_written < MAX_ENTRIES_PER_BATCH)
+    {
+        _system_log_entry* entry_ptr = NULL;
+        _system_log_ring*  ring_ptr  = NULL;
+
+        /* Pick the oldest entry */
+        for (unsigned int n_ring = 0;
+                          n_ring < n_rings;
+                        ++n_ring)
+        {
+            _system_log_ring*  current_ring_ptr  = _system_log_rings_snapshot[n_ring];
+            _system_log_entry* current_entry_ptr = current_ring_ptr->entries + (current_ring_ptr->head & (LOG_RING_BUFFER_CAPACITY - 1));
+
+            if (current_ring_ptr->head == system_atomics_load_acquire(&current_ring_ptr->tail) )
+            {
+                continue;
+            }
+
+            if (entry_ptr == NULL                                               ||
+                (int) (current_entry_ptr->sequence - entry_ptr->sequence) < 0)
+            {
+                entry_ptr = current_entry_ptr;
+                ring_ptr  = current_ring_ptr;
+            }
+        }
+
+        if (entry_ptr == NULL)
+        {
+            break;
+        }
+
+        /* Format & write it */
+        {
+            size_t length = 0;
+
+            if (entry_ptr->include_prefix)
+            {
+                length = _system_log_append(_system_log_text,
+                                            sizeof(_system_log_text),
+                                            "[File %s // line %d]: ",
+                                            entry_ptr->file,
+                                            entry_ptr->line);
+            }
+
+            _system_log_format(_system_log_text          + length,
+                               sizeof(_system_log_text) - length,
+                               entry_ptr->format,
+                               entry_ptr->n_args,
+                               (entry_ptr->heap_data_ptr != NULL) ? entry_ptr->heap_data_ptr
+                                                                  : entry_ptr->data);
+            _system_log_output(_system_log_text,
+                               entry_ptr->include_prefix,
+                               ring_ptr->thread_id);
+        }
+
+        if (entry_ptr->heap_data_ptr != NULL)
+        {
+            free(entry_ptr->heap_data_ptr);
+
+            entry_ptr->heap_data_ptr = NULL;
+        }
+
+        /* Hand the entry back to the owning thread */
+        system_atomics_store_release(&ring_ptr->head,
+                                     ring_ptr->head + 1);
+
+        n_entries_written++;
+    }
+
+    if (n_entries_written > 0)
+    {
+        _system_log_n_written_entries += n_entries_written;
+
+        if (_system_log_file_handle != NULL)
+        {
+            fflush(_system_log_file_handle);
+        }
+    }
+
+    /* Release rings of threads which have quit, once they are empty */
+    for (unsigned int n_ring = 0;
+                      n_ring < n_rings;
+                    ++n_ring)
+    {
+        _system_log_ring* ring_ptr = _system_log_rings_snapshot[n_ring];
+
+        if (system_atomics_load_acquire(&ring_ptr->is_released) == 0 ||
+            ring_ptr->head                                      != ring_ptr->tail)
+        {
+            continue;
+        }
+
+        system_critical_section_enter(_system_log_rings_cs);
+        {
+            system_resizable_vector_delete_element_at(_system_log_rings,
+                                                      system_resizable_vector_find(_system_log_rings,
+                                                                                   ring_ptr) );
+
+            _system_log_n_released_dropped_entries += ring_ptr->n_dropped_entries;
+        }
+        system_critical_section_leave(_system_log_rings_cs);
+
+        delete ring_ptr;
+    }
+
+    return n_entries_written;
+}
+
+/** Entry point of the writer thread. */
+#ifdef _WIN32
+    PRIVATE DWORD WINAPI _system_log_writer_thread_entrypoint(LPVOID)
+#else
+    PRIVATE void* _system_log_writer_thread_entrypoint(void*)
+#endif
+{
+    unsigned int sleep_msec = 1;
+
+    while (!_system_log_writer_should_quit)
+    {
+        unsigned int n_entries_written;
+
+        system_critical_section_enter(_system_log_writer_cs);
+        {
+            n_entries_written = _system_log_drain();
+        }
+        system_critical_section_leave(_system_log_writer_cs);
+
+        if (n_entries_written > 0)
+        {
+            sleep_msec = 1;
+
+            continue;
+        }
+
+        /* Nothing to do. Back off, so that an idle writer does not keep waking up. */
+#ifdef _WIN32
+        ::Sleep(sleep_msec);
+#else
+        usleep(sleep_msec * 1000);
+#endif
+
+        if (sleep_msec < MAX_IDLE_SLEEP_MSEC)
+        {
+            sleep_msec *= 2;
+        }
+    }
+
+    return 0;
+}
 
 
 /** Please see header for specification */
 PUBLIC void _system_log_init()
 {
-    log_file_handle    = fopen                         ("log.txt",
-                                                        "w");
-    log_file_handle_cs = system_critical_section_create();
+    _system_log_file_handle = fopen                         ("log.txt",
+                                                             "w");
+    _system_log_rings       = system_resizable_vector_create(16); /* capacity */
+    _system_log_rings_cs    = system_critical_section_create();
+    _system_log_writer_cs   = system_critical_section_create();
+
+    _system_log_writer_should_quit = false;
+
+#ifdef _WIN32
+    _system_log_writer_thread = ::CreateThread(NULL, /* lpThreadAttributes */
+                                               0,    /* dwStackSize        */
+                                               _system_log_writer_thread_entrypoint,
+                                               NULL, /* lpParameter        */
+                                               0,    /* dwCreationFlags    */
+                                               NULL);/* lpThreadId         */
+#else
+    pthread_create(&_system_log_writer_thread,
+                   NULL, /* attr */
+                   _system_log_writer_thread_entrypoint,
+                   NULL); /* arg */
+#endif
+
+    system_atomics_memory_barrier();
+
+    _system_log_level = _system_log_requested_level;
 }
 
 /** Please see header for spefification */
 PUBLIC void _system_log_deinit()
 {
-    if (log_file_handle != NULL)
+    unsigned int n_rings = 0;
+
+    /* Stop accepting new entries */
+    _system_log_level = LOGLEVEL_FATAL + 1;
+
+    _system_log_writer_should_quit = true;
+
+#ifdef _WIN32
+    ::WaitForSingleObject(_system_log_writer_thread,
+                          INFINITE);
+    ::CloseHandle        (_system_log_writer_thread);
+
+    _system_log_writer_thread = NULL;
+#else
+    pthread_join(_system_log_writer_thread,
+                 NULL); /* retval */
+#endif
+
+    system_log_flush();
+
+    /* Release all rings */
+    system_resizable_vector_get_property(_system_log_rings,
+                                         SYSTEM_RESIZABLE_VECTOR_PROPERTY_N_ELEMENTS,
+                                        &n_rings);
+
+    for (unsigned int n_ring = 0;
+                      n_ring < n_rings;
+                    ++n_ring)
+    {
+        _system_log_ring* ring_ptr = NULL;
+
+        system_resizable_vector_get_element_at(_system_log_rings,
+                                               n_ring,
+                                              &ring_ptr);
+
+        delete ring_ptr;
+    }
+
+    _system_log_thread_ring_ptr = NULL;
+
+    system_resizable_vector_release(_system_log_rings);
+    _system_log_rings = NULL;
+
+    if (_system_log_file_handle != NULL)
     {
-        fclose(log_file_handle);
+        fclose(_system_log_file_handle);
 
-        log_file_handle = NULL;
+        _system_log_file_handle = NULL;
     }
 
-    if (log_file_handle_cs != NULL)
+    if (_system_log_rings_cs != NULL)
     {
-        system_critical_section cs_cached = log_file_handle_cs;
-        log_file_handle_cs = NULL;
+        system_critical_section cs_cached = _system_log_rings_cs;
+        _system_log_rings_cs = NULL;
+
+        system_critical_section_release(cs_cached);
+    }
+
+    if (_system_log_writer_cs != NULL)
+    {
+        system_critical_section cs_cached = _system_log_writer_cs;
+        _system_log_writer_cs = NULL;
 
         system_critical_section_release(cs_cached);
     }
 }
 
 /** Please see header for specification */
-EMERALD_API void system_log_write(system_log_priority,
-                                  const char*         text,
-                                  bool                include_tid_info)
+PUBLIC EMERALD_API void _system_log_post(system_log_priority    level,
+                                         bool                   include_prefix,
+                                         const char*            file,
+                                         int                    line,
+                                         const char*            format,
+                                         unsigned int           n_args,
+                                         const _system_log_arg* args)
 {
+    size_t             data_size = 0;
+    unsigned char*     data_ptr  = NULL;
+    _system_log_entry* entry_ptr = NULL;
+    _system_log_ring*  ring_ptr  = _system_log_thread_ring_ptr;
+    unsigned int       tail;
+
+    if (ring_ptr == NULL)
     {
-        static char temp[16];
+        ring_ptr = _system_log_create_thread_ring();
 
-        if (include_tid_info)
+        if (ring_ptr == NULL)
         {
-            snprintf(temp,
-                     sizeof(temp),
-                     "[tid:%08x] ",
-                     system_threads_get_thread_id() );
+            return;
         }
-        else
+    }
+
+    /* Drop the entry if the ring is full */
+    tail = ring_ptr->tail;
+
+    if (tail - system_atomics_load_acquire(&ring_ptr->head) >= LOG_RING_BUFFER_CAPACITY)
+    {
+        ring_ptr->n_dropped_entries++;
+
+        return;
+    }
+
+    entry_ptr = ring_ptr->entries + (tail & (LOG_RING_BUFFER_CAPACITY - 1));
+
+    /* Capture the arguments */
+    for (unsigned int n_arg = 0;
+                      n_arg < n_args;
+                    ++n_arg)
+    {
+        data_size += 1; /* type */
+
+        switch (args[n_arg].type)
         {
-            memset(temp,
-                   0,
-                   sizeof(temp) );
+            case _SYSTEM_LOG_ARG_TYPE_DOUBLE:  data_size += sizeof(double);  break;
+            case _SYSTEM_LOG_ARG_TYPE_INTEGER: data_size += sizeof(__int64); break;
+            case _SYSTEM_LOG_ARG_TYPE_POINTER: data_size += sizeof(void*);   break;
+
+            case _SYSTEM_LOG_ARG_TYPE_STRING:
+            {
+                data_size += sizeof(uint32_t);
+
+                if (args[n_arg].string_value != NULL)
+                {
+                    data_size += strlen(args[n_arg].string_value) + 1;
+                }
+
+                break;
+            }
         }
-#ifdef _WIN32
-        ::OutputDebugStringA(temp);
-        ::OutputDebugStringA(text);
-        ::OutputDebugStringA("\n");
-#else
-        printf("%s%s\n",
-               temp,
-               text);
-#endif
+    }
 
-        if (log_file_handle != NULL)
+    if (data_size <= sizeof(entry_ptr->data) )
+    {
+        data_ptr                 = entry_ptr->data;
+        entry_ptr->heap_data_ptr = NULL;
+    }
+    else
+    {
+        data_ptr                 = (unsigned char*) malloc(data_size);
+        entry_ptr->heap_data_ptr = data_ptr;
+
+        if (data_ptr == NULL)
+        {
+            ring_ptr->n_dropped_entries++;
+
+            return;
+        }
+    }
+
+    for (unsigned int n_arg = 0;
+                      n_arg < n_args;
+                    ++n_arg)
+    {
+        *(data_ptr++) = (unsigned char) args[n_arg].type;
+
+        switch (args[n_arg].type)
+        {
+            case _SYSTEM_LOG_ARG_TYPE_DOUBLE:
+            {
+                memcpy(data_ptr,
+                      &args[n_arg].double_value,
+                       sizeof(double) );
+
+                data_ptr += sizeof(double);
+
+                break;
+            }
+
+            case _SYSTEM_LOG_ARG_TYPE_INTEGER:
+            {
+                memcpy(data_ptr,
+                      &args[n_arg].integer_value,
+                       sizeof(__int64) );
+
+                data_ptr += sizeof(__int64);
+
+                break;
+            }
+
+            case _SYSTEM_LOG_ARG_TYPE_POINTER:
+            {
+                memcpy(data_ptr,
+                      &args[n_arg].pointer_value,
+                       sizeof(void*) );
+
+                data_ptr += sizeof(void*);
+
+                break;
+            }
+
+            case _SYSTEM_LOG_ARG_TYPE_STRING:
+            {
+                uint32_t length = NULL_STRING_LENGTH;
+
+                if (args[n_arg].string_value != NULL)
+                {
+                    length = (uint32_t) strlen(args[n_arg].string_value);
+                }
+
+                memcpy(data_ptr,
+                      &length,
+                       sizeof(length) );
+
+                data_ptr += sizeof(length);
+
+                if (length != NULL_STRING_LENGTH)
+                {
+                    memcpy(data_ptr,
+                           args[n_arg].string_value,
+                           length + 1);
+
+                    data_ptr += length + 1;
+                }
+
+                break;
+            }
+        }
+    }
+
+    entry_ptr->file           = file;
+    entry_ptr->format         = format;
+    entry_ptr->include_prefix = include_prefix;
+    entry_ptr->level          = level;
+    entry_ptr->line           = line;
+    entry_ptr->n_args         = n_args;
+    entry_ptr->sequence       = system_atomics_increment(&_system_log_next_sequence);
+
+    /* Publish the entry */
+    system_atomics_store_release(&ring_ptr->tail,
+                                 tail + 1);
+}
+
+/** Please see header for specification */
+PUBLIC void _system_log_release_thread_ring()
+{
+    _system_log_ring* ring_ptr = _system_log_thread_ring_ptr;
+
+    if (ring_ptr == NULL)
+    {
+        return;
+    }
+
+    /* The writer will release the ring, once it has written all entries the ring holds */
+    _system_log_thread_ring_ptr = NULL;
+
+    system_atomics_store_release(&ring_ptr->is_released,
+                                 1);
+}
+
+/** Please see header for specification */
+PUBLIC EMERALD_API void system_log_flush()
+{
+    if (_system_log_writer_cs == NULL)
+    {
+        return;
+    }
+
+    system_critical_section_enter(_system_log_writer_cs);
+    {
+        while (_system_log_drain() == MAX_ENTRIES_PER_BATCH)
+        {
+            /* Keep going */
+        }
+    }
+    system_critical_section_leave(_system_log_writer_cs);
+}
+
+/** Please see header for specification */
+PUBLIC EMERALD_API void system_log_get_property(system_log_property property,
+                                                void*               out_result_ptr)
+{
+    switch (property)
+    {
+        case SYSTEM_LOG_PROPERTY_LEVEL:
         {
-            fwrite(text,
-                   strlen(text), 
-                   1, /* _Count */
-                   log_file_handle);
-            fwrite("\n",
-                   1, /* _Size  */
-                   1, /* _Count */
-                   log_file_handle);
+            *(system_log_priority*) out_result_ptr = (system_log_priority) _system_log_requested_level;
+
+            break;
+        }
+
+        case SYSTEM_LOG_PROPERTY_N_DROPPED_ENTRIES:
+        {
+            __uint64     result  = 0;
+            unsigned int n_rings = 0;
+
+            if (_system_log_rings_cs == NULL)
+            {
+                *(__uint64*) out_result_ptr = 0;
+
+                break;
+            }
+
+            system_critical_section_enter(_system_log_rings_cs);
+            {
+                system_resizable_vector_get_property(_system_log_rings,
+                                                     SYSTEM_RESIZABLE_VECTOR_PROPERTY_N_ELEMENTS,
+                                                    &n_rings);
+
+                for (unsigned int n_ring = 0;
+                                  n_ring < n_rings;
+                                ++n_ring)
+                {
+                    _system_log_ring* ring_ptr = NULL;
 
-            fflush(log_file_handle);
+                    system_resizable_vector_get_element_at(_system_log_rings,
+                                                           n_ring,
+                                                          &ring_ptr);
+
+                    result += ring_ptr->n_dropped_entries;
+                }
+
+                result += _system_log_n_released_dropped_entries;
+            }
+            system_critical_section_leave(_system_log_rings_cs);
+
+            *(__uint64*) out_result_ptr = result;
+
+            break;
+        }
+
+        case SYSTEM_LOG_PROPERTY_N_WRITTEN_ENTRIES:
+        {
+            *(__uint64*) out_result_ptr = _system_log_n_written_entries;
+
+            break;
+        }
+
+        default:
+        {
+            /* Can't use assertions here - they log */
+            break;
+        }
+    } /* switch (property) */
+}
+
+/** Please see header for specification */
+PUBLIC EMERALD_API void system_log_set_level(system_log_priority level)
+{
+    _system_log_requested_level = level;
+
+    /* Only take effect now if the log is up and running */
+    if (_system_log_writer_cs != NULL)
+    {
+        _system_log_level = level;
+    }
+}
+
+/** Please see header for specification */
+EMERALD_API void system_log_write(system_log_priority,
+                                  const char*         text,
+                                  bool                include_tid_info)
+{
+    if (_system_log_writer_cs == NULL)
+    {
+        /* The log is not up yet, or has already been torn down. */
+        _system_log_output(text,
+                           include_tid_info,
+                           system_threads_get_thread_id() );
+
+        return;
+    }
+
+    system_critical_section_enter(_system_log_writer_cs);
+    {
+        /* Preserve the order of entries */
+        while (_system_log_drain() == MAX_ENTRIES_PER_BATCH)
+        {
+            /* Keep going */
+        }
+
+        _system_log_output(text,
+                           include_tid_info,
+                           system_threads_get_thread_id() );
+
+        if (_system_log_file_handle != NULL)
+        {
+            fflush(_system_log_file_handle);
         }
     }
+    system_critical_section_leave(_system_log_writer_cs);
 }
@@ -5,7 +5,9 @@
  */
 #include "shared.h"
 #include "system/system_assertions.h"
+#include "system/system_capabilities.h"
 #include "system/system_constants.h"
+#include "system/system_math_matrix4x4.h"
 #include "system/system_math_vector.h"
 #include "system/system_matrix4x4.h"
 #include "system/system_resource_pool.h"
@@ -18,6 +20,20 @@
 #define COL_FROM_ELEMENT_INDEX(element_index) (element_index & 0x3)
 #define ROW_FROM_ELEMENT_INDEX(element_index) ((element_index & 0xC) >> 2)
 
+#ifdef SYSTEM_MATH_MATRIX4X4_USE_SSE
+    #if defined(_MSC_VER)
+        #include <immintrin.h>
+
+        #define SYSTEM_MATRIX4X4_AVX2_TARGET
+        #define SYSTEM_MATRIX4X4_USE_AVX2_KERNELS
+    #elif defined(__GNUC__)
+        #include <immintrin.h>
+
+        #define SYSTEM_MATRIX4X4_AVX2_TARGET __attribute__((target("avx2,fma")))
+        #define SYSTEM_MATRIX4X4_USE_AVX2_KERNELS
+    #endif
+#endif
+
 const float pi = 3.141592653589793238462f;
 
 
@@ -70,6 +86,535 @@ PRIVATE void _system_matrix4x4_generate_column_major_data(_system_matrix4x4* mat
     matrix_ptr->column_major_data[15] = matrix_ptr->data[15];
 }
 
+/** Batch kernels.
+ *
+ *  Matrices are always passed as row-major arrays of 16 floats. AVX2 kernels are compiled
+ *  for AVX2 & FMA3 regardless of the build settings, and are only called if the running CPU
+ *  supports both extensions.
+ */
+typedef void (*PFNMULTIPLYMANYPROC)      (const float* a_ptr,
+                                          const float* b_ptr,
+                                          unsigned int n_matrices,
+                                          float*       out_ptr);
+typedef void (*PFNTRANSFORMAABBSPROC)    (const float* matrix_data_ptr,
+                                          unsigned int n_aabbs,
+                                          const float* aabb_min_ptr,
+                                          const float* aabb_max_ptr,
+                                          float*       out_aabb_min_ptr,
+                                          float*       out_aabb_max_ptr);
+typedef void (*PFNTRANSFORMPOINTSSOAPROC)(const float* matrix_data_ptr,
+                                          unsigned int n_points,
+                                          const float* x_ptr,
+                                          const float* y_ptr,
+                                          const float* z_ptr,
+                                          float*       out_x_ptr,
+                                          float*       out_y_ptr,
+                                          float*       out_z_ptr);
+
+typedef struct
+{
+    PFNMULTIPLYMANYPROC       pMultiplyMany;
+    PFNTRANSFORMAABBSPROC     pTransformAABBs;
+    PFNTRANSFORMPOINTSSOAPROC pTransformPointsSOA;
+} _system_matrix4x4_kernels;
+
+
+/** Please see PFNMULTIPLYMANYPROC */
+PRIVATE void _system_matrix4x4_multiply_many_scalar(const float* a_ptr,
+                                                    const float* b_ptr,
+                                                    unsigned int n_matrices,
+                                                    float*       out_ptr)
+{
+    for (unsigned int n_matrix = 0;
+                      n_matrix < n_matrices;
+                    ++n_matrix)
+    {
+        float result[16];
+
+        for (unsigned char column = 0;
+                           column < 4;
+                         ++column)
+        {
+            for (unsigned char row = 0;
+                               row < 4;
+                             ++row)
+            {
+                result[WORD_INDEX(column, row)] = a_ptr[WORD_INDEX(0,      row)] * b_ptr[WORD_INDEX(column, 0)] +
+                                                  a_ptr[WORD_INDEX(1,      row)] * b_ptr[WORD_INDEX(column, 1)] +
+                                                  a_ptr[WORD_INDEX(2,      row)] * b_ptr[WORD_INDEX(column, 2)] +
+                                                  a_ptr[WORD_INDEX(3,      row)] * b_ptr[WORD_INDEX(column, 3)];
+            }
+        }
+
+        memcpy(out_ptr,
+               result,
+               sizeof(result) );
+
+        a_ptr   += 16;
+        b_ptr   += 16;
+        out_ptr += 16;
+    }
+}
+
+/** Please see PFNTRANSFORMAABBSPROC */
+PRIVATE void _system_matrix4x4_transform_aabbs_scalar(const float* matrix_data_ptr,
+                                                      unsigned int n_aabbs,
+                                                      const float* aabb_min_ptr,
+                                                      const float* aabb_max_ptr,
+                                                      float*       out_aabb_min_ptr,
+                                                      float*       out_aabb_max_ptr)
+{
+    for (unsigned int n_aabb = 0;
+                      n_aabb < n_aabbs;
+                    ++n_aabb)
+    {
+        float result_max[3];
+        float result_min[3];
+
+        /* Start with the translation. For each matrix element, the smaller of the two candidate
+         * contributions goes to the minimum, and the larger one to the maximum (Arvo's method) */
+        for (unsigned char row = 0;
+                           row < 3;
+                         ++row)
+        {
+            result_max[row] = matrix_data_ptr[WORD_INDEX(3, row)];
+            result_min[row] = matrix_data_ptr[WORD_INDEX(3, row)];
+
+            for (unsigned char column = 0;
+                               column < 3;
+                             ++column)
+            {
+                const float contribution1 = matrix_data_ptr[WORD_INDEX(column, row)] * aabb_min_ptr[column];
+                const float contribution2 = matrix_data_ptr[WORD_INDEX(column, row)] * aabb_max_ptr[column];
+
+                if (contribution1 < contribution2)
+                {
+                    result_min[row] += contribution1;
+                    result_max[row] += contribution2;
+                }
+                else
+                {
+                    result_min[row] += contribution2;
+                    result_max[row] += contribution1;
+                }
+            }
+        }
+
+        memcpy(out_aabb_max_ptr,
+               result_max,
+               sizeof(result_max) );
+        memcpy(out_aabb_min_ptr,
+               result_min,
+               sizeof(result_min) );
+
+        aabb_max_ptr     += 3;
+        aabb_min_ptr     += 3;
+        out_aabb_max_ptr += 3;
+        out_aabb_min_ptr += 3;
+    }
+}
+
+/** Please see PFNTRANSFORMPOINTSSOAPROC */
+PRIVATE void _system_matrix4x4_transform_points_soa_scalar(const float* matrix_data_ptr,
+                                                           unsigned int n_points,
+                                                           const float* x_ptr,
+                                                           const float* y_ptr,
+                                                           const float* z_ptr,
+                                                           float*       out_x_ptr,
+                                                           float*       out_y_ptr,
+                                                           float*       out_z_ptr)
+{
+    for (unsigned int n_point = 0;
+                      n_point < n_points;
+                    ++n_point)
+    {
+        const float x = x_ptr[n_point];
+        const float y = y_ptr[n_point];
+        const float z = z_ptr[n_point];
+
+        out_x_ptr[n_point] = matrix_data_ptr[0] * x + matrix_data_ptr[1] * y + matrix_data_ptr[2]  * z + matrix_data_ptr[3];
+        out_y_ptr[n_point] = matrix_data_ptr[4] * x + matrix_data_ptr[5] * y + matrix_data_ptr[6]  * z + matrix_data_ptr[7];
+        out_z_ptr[n_point] = matrix_data_ptr[8] * x + matrix_data_ptr[9] * y + matrix_data_ptr[10] * z + matrix_data_ptr[11];
+    }
+}
+
+#ifdef SYSTEM_MATH_MATRIX4X4_USE_SSE
+    /** Loads an XYZ triple into the first three components of a register, without reading past it. */
+    inline __m128 _system_matrix4x4_load_vec3_sse(const float* data_ptr)
+    {
+        return _mm_movelh_ps(_mm_loadl_pi(_mm_setzero_ps(),
+                                          reinterpret_cast<const __m64*>(data_ptr) ),
+                             _mm_load_ss (data_ptr + 2) );
+    }
+
+    /** Stores the first three components of a register, without writing past them. */
+    inline void _system_matrix4x4_store_vec3_sse(float* data_ptr,
+                                                 __m128 data)
+    {
+        _mm_storel_pi(reinterpret_cast<__m64*>(data_ptr),
+                      data);
+        _mm_store_ss (data_ptr + 2,
+                      _mm_movehl_ps(data, data) );
+    }
+
+    /** Please see PFNMULTIPLYMANYPROC */
+    PRIVATE void _system_matrix4x4_multiply_many_sse2(const float* a_ptr,
+                                                      const float* b_ptr,
+                                                      unsigned int n_matrices,
+                                                      float*       out_ptr)
+    {
+        for (unsigned int n_matrix = 0;
+                          n_matrix < n_matrices;
+                        ++n_matrix)
+        {
+            const __m128 b0 = _mm_loadu_ps(b_ptr + 0);
+            const __m128 b1 = _mm_loadu_ps(b_ptr + 4);
+            const __m128 b2 = _mm_loadu_ps(b_ptr + 8);
+            const __m128 b3 = _mm_loadu_ps(b_ptr + 12);
+            __m128       result[4];
+
+            /* result.row[n] = sum(a[n][k] * b.row[k]) */
+            for (unsigned int n_row = 0;
+                              n_row < 4;
+                            ++n_row)
+            {
+                const __m128 a_row = _mm_loadu_ps(a_ptr + n_row * 4);
+
+                result[n_row] = _mm_add_ps(_mm_add_ps(_mm_mul_ps(SYSTEM_MATH_MATRIX4X4_SWIZZLE(a_row, 0, 0, 0, 0), b0),
+                                                      _mm_mul_ps(SYSTEM_MATH_MATRIX4X4_SWIZZLE(a_row, 1, 1, 1, 1), b1) ),
+                                           _mm_add_ps(_mm_mul_ps(SYSTEM_MATH_MATRIX4X4_SWIZZLE(a_row, 2, 2, 2, 2), b2),
+                                                      _mm_mul_ps(SYSTEM_MATH_MATRIX4X4_SWIZZLE(a_row, 3, 3, 3, 3), b3) ));
+            }
+
+            for (unsigned int n_row = 0;
+                              n_row < 4;
+                            ++n_row)
+            {
+                _mm_storeu_ps(out_ptr + n_row * 4,
+                              result[n_row]);
+            }
+
+            a_ptr   += 16;
+            b_ptr   += 16;
+            out_ptr += 16;
+        }
+    }
+
+    /** Please see PFNTRANSFORMAABBSPROC */
+    PRIVATE void _system_matrix4x4_transform_aabbs_sse2(const float* matrix_data_ptr,
+                                                        unsigned int n_aabbs,
+                                                        const float* aabb_min_ptr,
+                                                        const float* aabb_max_ptr,
+                                                        float*       out_aabb_min_ptr,
+                                                        float*       out_aabb_max_ptr)
+    {
+        /* Transforms the box center by the matrix, and the half-extents by the matrix
+         * with all elements replaced by their absolute values. */
+        __m128       column0     = _mm_loadu_ps(matrix_data_ptr + 0);
+        __m128       column1     = _mm_loadu_ps(matrix_data_ptr + 4);
+        __m128       column2     = _mm_loadu_ps(matrix_data_ptr + 8);
+        __m128       translation = _mm_setzero_ps();
+        const __m128 abs_mask    = _mm_castsi128_ps(_mm_set1_epi32(0x7FFFFFFF) );
+        const __m128 half        = _mm_set1_ps     (0.5f);
+
+        _MM_TRANSPOSE4_PS(column0, column1, column2, translation);
+
+        const __m128 abs_column0 = _mm_and_ps(column0, abs_mask);
+        const __m128 abs_column1 = _mm_and_ps(column1, abs_mask);
+        const __m128 abs_column2 = _mm_and_ps(column2, abs_mask);
+
+        for (unsigned int n_aabb = 0;
+                          n_aabb < n_aabbs;
+                        ++n_aabb)
+        {
+            const __m128 aabb_max = _system_matrix4x4_load_vec3_sse(aabb_max_ptr + n_aabb * 3);
+            const __m128 aabb_min = _system_matrix4x4_load_vec3_sse(aabb_min_ptr + n_aabb * 3);
+            const __m128 center   = _mm_mul_ps(_mm_add_ps(aabb_max, aabb_min), half);
+            const __m128 extent   = _mm_mul_ps(_mm_sub_ps(aabb_max, aabb_min), half);
+
+            const __m128 new_center = _mm_add_ps(_mm_add_ps(_mm_mul_ps(column0, SYSTEM_MATH_MATRIX4X4_SWIZZLE(center, 0, 0, 0, 0) ),
+                                                            _mm_mul_ps(column1, SYSTEM_MATH_MATRIX4X4_SWIZZLE(center, 1, 1, 1, 1) )),
+                                                 _mm_add_ps(_mm_mul_ps(column2, SYSTEM_MATH_MATRIX4X4_SWIZZLE(center, 2, 2, 2, 2) ),
+                                                            translation) );
+            const __m128 new_extent = _mm_add_ps(_mm_add_ps(_mm_mul_ps(abs_column0, SYSTEM_MATH_MATRIX4X4_SWIZZLE(extent, 0, 0, 0, 0) ),
+                                                            _mm_mul_ps(abs_column1, SYSTEM_MATH_MATRIX4X4_SWIZZLE(extent, 1, 1, 1, 1) )),
+                                                 _mm_mul_ps(abs_column2, SYSTEM_MATH_MATRIX4X4_SWIZZLE(extent, 2, 2, 2, 2) ));
+
+            _system_matrix4x4_store_vec3_sse(out_aabb_max_ptr + n_aabb * 3,
+                                             _mm_add_ps(new_center, new_extent) );
+            _system_matrix4x4_store_vec3_sse(out_aabb_min_ptr + n_aabb * 3,
+                                             _mm_sub_ps(new_center, new_extent) );
+        }
+    }
+
+    /** Please see PFNTRANSFORMPOINTSSOAPROC */
+    PRIVATE void _system_matrix4x4_transform_points_soa_sse2(const float* matrix_data_ptr,
+                                                             unsigned int n_points,
+                                                             const float* x_ptr,
+                                                             const float* y_ptr,
+                                                             const float* z_ptr,
+                                                             float*       out_x_ptr,
+                                                             float*       out_y_ptr,
+                                                             float*       out_z_ptr)
+    {
+        __m128       matrix_data[12];
+        unsigned int n_point = 0;
+
+        for (unsigned int n_element = 0;
+                          n_element < 12;
+                        ++n_element)
+        {
+            matrix_data[n_element] = _mm_set1_ps(matrix_data_ptr[n_element]);
+        }
+
+        for (;
+             n_point + 4 <= n_points;
+             n_point += 4)
+        {
+            const __m128 x = _mm_loadu_ps(x_ptr + n_point);
+            const __m128 y = _mm_loadu_ps(y_ptr + n_point);
+            const __m128 z = _mm_loadu_ps(z_ptr + n_point);
+
+            _mm_storeu_ps(out_x_ptr + n_point,
+                          _mm_add_ps(_mm_add_ps(_mm_mul_ps(matrix_data[0], x),
+                                                _mm_mul_ps(matrix_data[1], y) ),
+                                     _mm_add_ps(_mm_mul_ps(matrix_data[2], z),
+                                                matrix_data[3]) ));
+            _mm_storeu_ps(out_y_ptr + n_point,
+                          _mm_add_ps(_mm_add_ps(_mm_mul_ps(matrix_data[4], x),
+                                                _mm_mul_ps(matrix_data[5], y) ),
+                                     _mm_add_ps(_mm_mul_ps(matrix_data[6], z),
+                                                matrix_data[7]) ));
+            _mm_storeu_ps(out_z_ptr + n_point,
+                          _mm_add_ps(_mm_add_ps(_mm_mul_ps(matrix_data[8],  x),
+                                                _mm_mul_ps(matrix_data[9],  y) ),
+                                     _mm_add_ps(_mm_mul_ps(matrix_data[10], z),
+                                                matrix_data[11]) ));
+        }
+
+        _system_matrix4x4_transform_points_soa_scalar(matrix_data_ptr,
+                                                      n_points - n_point,
+                                                      x_ptr     + n_point,
+                                                      y_ptr     + n_point,
+                                                      z_ptr     + n_point,
+                                                      out_x_ptr + n_point,
+                                                      out_y_ptr + n_point,
+                                                      out_z_ptr + n_point);
+    }
+#endif /* SYSTEM_MATH_MATRIX4X4_USE_SSE */
+
+#ifdef SYSTEM_MATRIX4X4_USE_AVX2_KERNELS
+    /** Please see PFNMULTIPLYMANYPROC */
+    SYSTEM_MATRIX4X4_AVX2_TARGET PRIVATE void _system_matrix4x4_multiply_many_avx2(const float* a_ptr,
+                                                                                   const float* b_ptr,
+                                                                                   unsigned int n_matrices,
+                                                                                   float*       out_ptr)
+    {
+        for (unsigned int n_matrix = 0;
+                          n_matrix < n_matrices;
+                        ++n_matrix)
+        {
+            /* Two result rows are computed at once. Each 128-bit lane holds one row of A and
+             * is multiplied by a copy of B's rows. */
+            const __m256 b0  = _mm256_broadcast_ps(reinterpret_cast<const __m128*>(b_ptr + 0) );
+            const __m256 b1  = _mm256_broadcast_ps(reinterpret_cast<const __m128*>(b_ptr + 4) );
+            const __m256 b2  = _mm256_broadcast_ps(reinterpret_cast<const __m128*>(b_ptr + 8) );
+            const __m256 b3  = _mm256_broadcast_ps(reinterpret_cast<const __m128*>(b_ptr + 12) );
+            const __m256 a01 = _mm256_loadu_ps    (a_ptr + 0);
+            const __m256 a23 = _mm256_loadu_ps    (a_ptr + 8);
+
+            const __m256 result01 = _mm256_fmadd_ps(_mm256_permute_ps(a01, 0xFF), b3,
+                                    _mm256_fmadd_ps(_mm256_permute_ps(a01, 0xAA), b2,
+                                    _mm256_fmadd_ps(_mm256_permute_ps(a01, 0x55), b1,
+                                    _mm256_mul_ps  (_mm256_permute_ps(a01, 0x00), b0) )));
+            const __m256 result23 = _mm256_fmadd_ps(_mm256_permute_ps(a23, 0xFF), b3,
+                                    _mm256_fmadd_ps(_mm256_permute_ps(a23, 0xAA), b2,
+                                    _mm256_fmadd_ps(_mm256_permute_ps(a23, 0x55), b1,
+                                    _mm256_mul_ps  (_mm256_permute_ps(a23, 0x00), b0) )));
+
+            _mm256_storeu_ps(out_ptr + 0,
+                             result01);
+            _mm256_storeu_ps(out_ptr + 8,
+                             result23);
+
+            a_ptr   += 16;
+            b_ptr   += 16;
+            out_ptr += 16;
+        }
+    }
+
+    /** Please see PFNTRANSFORMAABBSPROC */
+    SYSTEM_MATRIX4X4_AVX2_TARGET PRIVATE void _system_matrix4x4_transform_aabbs_avx2(const float* matrix_data_ptr,
+                                                                                     unsigned int n_aabbs,
+                                                                                     const float* aabb_min_ptr,
+                                                                                     const float* aabb_max_ptr,
+                                                                                     float*       out_aabb_min_ptr,
+                                                                                     float*       out_aabb_max_ptr)
+    {
+        /* Same as the SSE2 version, but processes two boxes at once, one per 128-bit lane */
+        __m128       column0     = _mm_loadu_ps(matrix_data_ptr + 0);
+        __m128       column1     = _mm_loadu_ps(matrix_data_ptr + 4);
+        __m128       column2     = _mm_loadu_ps(matrix_data_ptr + 8);
+        __m128       translation = _mm_setzero_ps();
+        const __m256 abs_mask    = _mm256_castsi256_ps(_mm256_set1_epi32(0x7FFFFFFF) );
+        const __m256 half        = _mm256_set1_ps     (0.5f);
+        unsigned int n_aabb      = 0;
+
+        _MM_TRANSPOSE4_PS(column0, column1, column2, translation);
+
+        const __m256 columns[3] =
+        {
+            _mm256_insertf128_ps(_mm256_castps128_ps256(column0), column0, 1),
+            _mm256_insertf128_ps(_mm256_castps128_ps256(column1), column1, 1),
+            _mm256_insertf128_ps(_mm256_castps128_ps256(column2), column2, 1)
+        };
+        const __m256 abs_columns[3] =
+        {
+            _mm256_and_ps(columns[0], abs_mask),
+            _mm256_and_ps(columns[1], abs_mask),
+            _mm256_and_ps(columns[2], abs_mask)
+        };
+        const __m256 translations = _mm256_insertf128_ps(_mm256_castps128_ps256(translation), translation, 1);
+
+        for (;
+             n_aabb + 2 <= n_aabbs;
+             n_aabb += 2)
+        {
+            const float* current_aabb_max_ptr = aabb_max_ptr + n_aabb * 3;
+            const float* current_aabb_min_ptr = aabb_min_ptr + n_aabb * 3;
+
+            const __m256 aabb_max = _mm256_insertf128_ps(_mm256_castps128_ps256(_system_matrix4x4_load_vec3_sse(current_aabb_max_ptr) ),
+                                                                                _system_matrix4x4_load_vec3_sse(current_aabb_max_ptr + 3),
+                                                         1);
+            const __m256 aabb_min = _mm256_insertf128_ps(_mm256_castps128_ps256(_system_matrix4x4_load_vec3_sse(current_aabb_min_ptr) ),
+                                                                                _system_matrix4x4_load_vec3_sse(current_aabb_min_ptr + 3),
+                                                         1);
+            const __m256 center   = _mm256_mul_ps(_mm256_add_ps(aabb_max, aabb_min), half);
+            const __m256 extent   = _mm256_mul_ps(_mm256_sub_ps(aabb_max, aabb_min), half);
+
+            const __m256 new_center = _mm256_fmadd_ps(columns[2], _mm256_permute_ps(center, 0xAA),
+                                      _mm256_fmadd_ps(columns[1], _mm256_permute_ps(center, 0x55),
+                                      _mm256_fmadd_ps(columns[0], _mm256_permute_ps(center, 0x00),
+                                                      translations) ));
+            const __m256 new_extent = _mm256_fmadd_ps(abs_columns[2], _mm256_permute_ps(extent, 0xAA),
+                                      _mm256_fmadd_ps(abs_columns[1], _mm256_permute_ps(extent, 0x55),
+                                      _mm256_mul_ps  (abs_columns[0], _mm256_permute_ps(extent, 0x00) )));
+            const __m256 new_max    = _mm256_add_ps(new_center, new_extent);
+            const __m256 new_min    = _mm256_sub_ps(new_center, new_extent);
+
+            _system_matrix4x4_store_vec3_sse(out_aabb_max_ptr + n_aabb * 3,     _mm256_castps256_ps128(new_max) );
+            _system_matrix4x4_store_vec3_sse(out_aabb_max_ptr + n_aabb * 3 + 3, _mm256_extractf128_ps (new_max, 1) );
+            _system_matrix4x4_store_vec3_sse(out_aabb_min_ptr + n_aabb * 3,     _mm256_castps256_ps128(new_min) );
+            _system_matrix4x4_store_vec3_sse(out_aabb_min_ptr + n_aabb * 3 + 3, _mm256_extractf128_ps (new_min, 1) );
+        }
+
+        _system_matrix4x4_transform_aabbs_sse2(matrix_data_ptr,
+                                               n_aabbs - n_aabb,
+                                               aabb_min_ptr     + n_aabb * 3,
+                                               aabb_max_ptr     + n_aabb * 3,
+                                               out_aabb_min_ptr + n_aabb * 3,
+                                               out_aabb_max_ptr + n_aabb * 3);
+    }
+
+    /** Please see PFNTRANSFORMPOINTSSOAPROC */
+    SYSTEM_MATRIX4X4_AVX2_TARGET PRIVATE void _system_matrix4x4_transform_points_soa_avx2(const float* matrix_data_ptr,
+                                                                                          unsigned int n_points,
+                                                                                          const float* x_ptr,
+                                                                                          const float* y_ptr,
+                                                                                          const float* z_ptr,
+                                                                                          float*       out_x_ptr,
+                                                                                          float*       out_y_ptr,
+                                                                                          float*       out_z_ptr)
+    {
+        __m256       matrix_data[12];
+        unsigned int n_point = 0;
+
+        for (unsigned int n_element = 0;
+                          n_element < 12;
+                        ++n_element)
+        {
+            matrix_data[n_element] = _mm256_set1_ps(matrix_data_ptr[n_element]);
+        }
+
+        for (;
+             n_point + 8 <= n_points;
+             n_point += 8)
+        {
+            const __m256 x = _mm256_loadu_ps(x_ptr + n_point);
+            const __m256 y = _mm256_loadu_ps(y_ptr + n_point);
+            const __m256 z = _mm256_loadu_ps(z_ptr + n_point);
+
+            _mm256_storeu_ps(out_x_ptr + n_point,
+                             _mm256_fmadd_ps(matrix_data[2], z,
+                             _mm256_fmadd_ps(matrix_data[1], y,
+                             _mm256_fmadd_ps(matrix_data[0], x, matrix_data[3]) )));
+            _mm256_storeu_ps(out_y_ptr + n_point,
+                             _mm256_fmadd_ps(matrix_data[6], z,
+                             _mm256_fmadd_ps(matrix_data[5], y,
+                             _mm256_fmadd_ps(matrix_data[4], x, matrix_data[7]) )));
+            _mm256_storeu_ps(out_z_ptr + n_point,
+                             _mm256_fmadd_ps(matrix_data[10], z,
+                             _mm256_fmadd_ps(matrix_data[9],  y,
+                             _mm256_fmadd_ps(matrix_data[8],  x, matrix_data[11]) )));
+        }
+
+        _system_matrix4x4_transform_points_soa_sse2(matrix_data_ptr,
+                                                    n_points - n_point,
+                                                    x_ptr     + n_point,
+                                                    y_ptr     + n_point,
+                                                    z_ptr     + n_point,
+                                                    out_x_ptr + n_point,
+                                                    out_y_ptr + n_point,
+                                                    out_z_ptr + n_point);
+    }
+#endif /* SYSTEM_MATRIX4X4_USE_AVX2_KERNELS */
+
+/** Batch kernels, indexed by system_matrix4x4_kernel_set. Kernel sets which could not be built
+ *  for the target platform are left empty. */
+PRIVATE const _system_matrix4x4_kernels kernel_sets[SYSTEM_MATRIX4X4_KERNEL_SET_COUNT] =
+{
+    /* SYSTEM_MATRIX4X4_KERNEL_SET_SCALAR */
+    {
+        _system_matrix4x4_multiply_many_scalar,
+        _system_matrix4x4_transform_aabbs_scalar,
+        _system_matrix4x4_transform_points_soa_scalar
+    },
+
+    /* SYSTEM_MATRIX4X4_KERNEL_SET_SSE2 */
+#ifdef SYSTEM_MATH_MATRIX4X4_USE_SSE
+    {
+        _system_matrix4x4_multiply_many_sse2,
+        _system_matrix4x4_transform_aabbs_sse2,
+        _system_matrix4x4_transform_points_soa_sse2
+    },
+#else
+    {
+        nullptr,
+        nullptr,
+        nullptr
+    },
+#endif
+
+    /* SYSTEM_MATRIX4X4_KERNEL_SET_AVX2 */
+#ifdef SYSTEM_MATRIX4X4_USE_AVX2_KERNELS
+    {
+        _system_matrix4x4_multiply_many_avx2,
+        _system_matrix4x4_transform_aabbs_avx2,
+        _system_matrix4x4_transform_points_soa_avx2
+    }
+#else
+    {
+        nullptr,
+        nullptr,
+        nullptr
+    }
+#endif
+};
+
+/** Kernel set used by the batch functions. Configured by _system_matrix4x4_init() */
+PRIVATE const _system_matrix4x4_kernels* active_kernels_ptr = kernel_sets + SYSTEM_MATRIX4X4_KERNEL_SET_SCALAR;
+PRIVATE system_matrix4x4_kernel_set      active_kernel_set  = SYSTEM_MATRIX4X4_KERNEL_SET_SCALAR;
+
 /** Please see header for specification */
 PUBLIC EMERALD_API system_matrix4x4 system_matrix4x4_create()
 {
@@ -339,59 +884,33 @@ PUBLIC EMERALD_API system_matrix4x4 system_matrix4x4_create_by_mul(system_matrix
     _system_matrix4x4* mat_b_ptr  = reinterpret_cast<_system_matrix4x4*>(mat_b);
     _system_matrix4x4* result_ptr = reinterpret_cast<_system_matrix4x4*>(result);
 
-    for (unsigned char column = 0;
-                       column < 4;
-                     ++column)
-    {
-        for (unsigned char row = 0;
-                           row < 4;
-                         ++row)
-        {
-            result_ptr->data[WORD_INDEX(column, row)] = 
-             mat_a_ptr->data[WORD_INDEX(0,      row)] * mat_b_ptr->data[WORD_INDEX(column, 0)] +
-             mat_a_ptr->data[WORD_INDEX(1,      row)] * mat_b_ptr->data[WORD_INDEX(column, 1)] +
-             mat_a_ptr->data[WORD_INDEX(2,      row)] * mat_b_ptr->data[WORD_INDEX(column, 2)] +
-             mat_a_ptr->data[WORD_INDEX(3,      row)] * mat_b_ptr->data[WORD_INDEX(column, 3)];
-        }
-    }
+    active_kernels_ptr->pMultiplyMany(mat_a_ptr->data,
+                                      mat_b_ptr->data,
+                                      1, /* n_matrices */
+                                      result_ptr->data);
 
     result_ptr->is_data_dirty = true;
 
     return result;
 }
 
+/** Please see header for specification */
+PUBLIC EMERALD_API system_matrix4x4_kernel_set system_matrix4x4_get_kernel_set()
+{
+    return active_kernel_set;
+}
+
 /** Please see header for specification */
 PUBLIC EMERALD_API bool system_matrix4x4_invert(system_matrix4x4 matrix)
 {
-    // Naive implementatino from http://www.euclideanspace.com/maths/algebra/matrix/functions/inverse/fourD/index.htm 
-    float              m[16];
-    _system_matrix4x4* matrix_ptr = reinterpret_cast<_system_matrix4x4*>(matrix);
-    float              det        = matrix_ptr->data[WORD_INDEX(0,3)] * matrix_ptr->data[WORD_INDEX(1,2)] * matrix_ptr->data[WORD_INDEX(2,1)] * matrix_ptr->data[WORD_INDEX(3,0)] -
-                                    matrix_ptr->data[WORD_INDEX(0,2)] * matrix_ptr->data[WORD_INDEX(1,3)] * matrix_ptr->data[WORD_INDEX(2,1)] * matrix_ptr->data[WORD_INDEX(3,0)] -
-                                    matrix_ptr->data[WORD_INDEX(0,3)] * matrix_ptr->data[WORD_INDEX(1,1)] * matrix_ptr->data[WORD_INDEX(2,2)] * matrix_ptr->data[WORD_INDEX(3,0)] +
-                                    matrix_ptr->data[WORD_INDEX(0,1)] * matrix_ptr->data[WORD_INDEX(1,3)] * matrix_ptr->data[WORD_INDEX(2,2)] * matrix_ptr->data[WORD_INDEX(3,0)] +
-                                    matrix_ptr->data[WORD_INDEX(0,2)] * matrix_ptr->data[WORD_INDEX(1,1)] * matrix_ptr->data[WORD_INDEX(2,3)] * matrix_ptr->data[WORD_INDEX(3,0)] -
-                                    matrix_ptr->data[WORD_INDEX(0,1)] * matrix_ptr->data[WORD_INDEX(1,2)] * matrix_ptr->data[WORD_INDEX(2,3)] * matrix_ptr->data[WORD_INDEX(3,0)] -
-                                    matrix_ptr->data[WORD_INDEX(0,3)] * matrix_ptr->data[WORD_INDEX(1,2)] * matrix_ptr->data[WORD_INDEX(2,0)] * matrix_ptr->data[WORD_INDEX(3,1)] +
-                                    matrix_ptr->data[WORD_INDEX(0,2)] * matrix_ptr->data[WORD_INDEX(1,3)] * matrix_ptr->data[WORD_INDEX(2,0)] * matrix_ptr->data[WORD_INDEX(3,1)] +
-                                    matrix_ptr->data[WORD_INDEX(0,3)] * matrix_ptr->data[WORD_INDEX(1,0)] * matrix_ptr->data[WORD_INDEX(2,2)] * matrix_ptr->data[WORD_INDEX(3,1)] -
-                                    matrix_ptr->data[WORD_INDEX(0,0)] * matrix_ptr->data[WORD_INDEX(1,3)] * matrix_ptr->data[WORD_INDEX(2,2)] * matrix_ptr->data[WORD_INDEX(3,1)] -
-                                    matrix_ptr->data[WORD_INDEX(0,2)] * matrix_ptr->data[WORD_INDEX(1,0)] * matrix_ptr->data[WORD_INDEX(2,3)] * matrix_ptr->data[WORD_INDEX(3,1)] +
-                                    matrix_ptr->data[WORD_INDEX(0,0)] * matrix_ptr->data[WORD_INDEX(1,2)] * matrix_ptr->data[WORD_INDEX(2,3)] * matrix_ptr->data[WORD_INDEX(3,1)] +
-                                    matrix_ptr->data[WORD_INDEX(0,3)] * matrix_ptr->data[WORD_INDEX(1,1)] * matrix_ptr->data[WORD_INDEX(2,0)] * matrix_ptr->data[WORD_INDEX(3,2)] -
-                                    matrix_ptr->data[WORD_INDEX(0,1)] * matrix_ptr->data[WORD_INDEX(1,3)] * matrix_ptr->data[WORD_INDEX(2,0)] * matrix_ptr->data[WORD_INDEX(3,2)] -
-                                    matrix_ptr->data[WORD_INDEX(0,3)] * matrix_ptr->data[WORD_INDEX(1,0)] * matrix_ptr->data[WORD_INDEX(2,1)] * matrix_ptr->data[WORD_INDEX(3,2)] +
-                                    matrix_ptr->data[WORD_INDEX(0,0)] * matrix_ptr->data[WORD_INDEX(1,3)] * matrix_ptr->data[WORD_INDEX(2,1)] * matrix_ptr->data[WORD_INDEX(3,2)] +
-                                    matrix_ptr->data[WORD_INDEX(0,1)] * matrix_ptr->data[WORD_INDEX(1,0)] * matrix_ptr->data[WORD_INDEX(2,3)] * matrix_ptr->data[WORD_INDEX(3,2)] -
-                                    matrix_ptr->data[WORD_INDEX(0,0)] * matrix_ptr->data[WORD_INDEX(1,1)] * matrix_ptr->data[WORD_INDEX(2,3)] * matrix_ptr->data[WORD_INDEX(3,2)] -
-                                    matrix_ptr->data[WORD_INDEX(0,2)] * matrix_ptr->data[WORD_INDEX(1,1)] * matrix_ptr->data[WORD_INDEX(2,0)] * matrix_ptr->data[WORD_INDEX(3,3)] +
-                                    matrix_ptr->data[WORD_INDEX(0,1)] * matrix_ptr->data[WORD_INDEX(1,2)] * matrix_ptr->data[WORD_INDEX(2,0)] * matrix_ptr->data[WORD_INDEX(3,3)] +
-                                    matrix_ptr->data[WORD_INDEX(0,2)] * matrix_ptr->data[WORD_INDEX(1,0)] * matrix_ptr->data[WORD_INDEX(2,1)] * matrix_ptr->data[WORD_INDEX(3,3)] -
-                                    matrix_ptr->data[WORD_INDEX(0,0)] * matrix_ptr->data[WORD_INDEX(1,2)] * matrix_ptr->data[WORD_INDEX(2,1)] * matrix_ptr->data[WORD_INDEX(3,3)] -
-                                    matrix_ptr->data[WORD_INDEX(0,1)] * matrix_ptr->data[WORD_INDEX(1,0)] * matrix_ptr->data[WORD_INDEX(2,2)] * matrix_ptr->data[WORD_INDEX(3,3)] +
-                                    matrix_ptr->data[WORD_INDEX(0,0)] * matrix_ptr->data[WORD_INDEX(1,1)] * matrix_ptr->data[WORD_INDEX(2,2)] * matrix_ptr->data[WORD_INDEX(3,3)];
-
-    if (fabs(det) <= 0.0000001f)
+    _system_matrix4x4*    matrix_ptr = reinterpret_cast<_system_matrix4x4*>(matrix);
+    system_math_matrix4x4 temp;
+
+    system_math_matrix4x4_set_from_row_major(matrix_ptr->data,
+                                            &temp);
+
+    if (!system_math_matrix4x4_invert(&temp,
+                                      &temp) )
     {
         ASSERT_DEBUG_SYNC(false,
                           "Determinant is very close to 0, this matrix is most likely non-invertable.");
@@ -399,111 +918,9 @@ PUBLIC EMERALD_API bool system_matrix4x4_invert(system_matrix4x4 matrix)
         return false;
     }
 
-    m[WORD_INDEX(0, 0)] = matrix_ptr->data[WORD_INDEX(1,2)] * matrix_ptr->data[WORD_INDEX(2,3)] * matrix_ptr->data[WORD_INDEX(3,1)] -
-                          matrix_ptr->data[WORD_INDEX(1,3)] * matrix_ptr->data[WORD_INDEX(2,2)] * matrix_ptr->data[WORD_INDEX(3,1)] +
-                          matrix_ptr->data[WORD_INDEX(1,3)] * matrix_ptr->data[WORD_INDEX(2,1)] * matrix_ptr->data[WORD_INDEX(3,2)] -
-                          matrix_ptr->data[WORD_INDEX(1,1)] * matrix_ptr->data[WORD_INDEX(2,3)] * matrix_ptr->data[WORD_INDEX(3,2)] -
-                          matrix_ptr->data[WORD_INDEX(1,2)] * matrix_ptr->data[WORD_INDEX(2,1)] * matrix_ptr->data[WORD_INDEX(3,3)] +
-                          matrix_ptr->data[WORD_INDEX(1,1)] * matrix_ptr->data[WORD_INDEX(2,2)] * matrix_ptr->data[WORD_INDEX(3,3)];
-    m[WORD_INDEX(0, 1)] = matrix_ptr->data[WORD_INDEX(0,3)] * matrix_ptr->data[WORD_INDEX(2,2)] * matrix_ptr->data[WORD_INDEX(3,1)] -
-                          matrix_ptr->data[WORD_INDEX(0,2)] * matrix_ptr->data[WORD_INDEX(2,3)] * matrix_ptr->data[WORD_INDEX(3,1)] -
-                          matrix_ptr->data[WORD_INDEX(0,3)] * matrix_ptr->data[WORD_INDEX(2,1)] * matrix_ptr->data[WORD_INDEX(3,2)] +
-                          matrix_ptr->data[WORD_INDEX(0,1)] * matrix_ptr->data[WORD_INDEX(2,3)] * matrix_ptr->data[WORD_INDEX(3,2)] +
-                          matrix_ptr->data[WORD_INDEX(0,2)] * matrix_ptr->data[WORD_INDEX(2,1)] * matrix_ptr->data[WORD_INDEX(3,3)] -
-                          matrix_ptr->data[WORD_INDEX(0,1)] * matrix_ptr->data[WORD_INDEX(2,2)] * matrix_ptr->data[WORD_INDEX(3,3)];
-    m[WORD_INDEX(0, 2)] = matrix_ptr->data[WORD_INDEX(0,2)] * matrix_ptr->data[WORD_INDEX(1,3)] * matrix_ptr->data[WORD_INDEX(3,1)] -
-                          matrix_ptr->data[WORD_INDEX(0,3)] * matrix_ptr->data[WORD_INDEX(1,2)] * matrix_ptr->data[WORD_INDEX(3,1)] +
-                          matrix_ptr->data[WORD_INDEX(0,3)] * matrix_ptr->data[WORD_INDEX(1,1)] * matrix_ptr->data[WORD_INDEX(3,2)] -
-                          matrix_ptr->data[WORD_INDEX(0,1)] * matrix_ptr->data[WORD_INDEX(1,3)] * matrix_ptr->data[WORD_INDEX(3,2)] -
-                          matrix_ptr->data[WORD_INDEX(0,2)] * matrix_ptr->data[WORD_INDEX(1,1)] * matrix_ptr->data[WORD_INDEX(3,3)] +
-                          matrix_ptr->data[WORD_INDEX(0,1)] * matrix_ptr->data[WORD_INDEX(1,2)] * matrix_ptr->data[WORD_INDEX(3,3)];
-    m[WORD_INDEX(0, 3)] = matrix_ptr->data[WORD_INDEX(0,3)] * matrix_ptr->data[WORD_INDEX(1,2)] * matrix_ptr->data[WORD_INDEX(2,1)] -
-                          matrix_ptr->data[WORD_INDEX(0,2)] * matrix_ptr->data[WORD_INDEX(1,3)] * matrix_ptr->data[WORD_INDEX(2,1)] -
-                          matrix_ptr->data[WORD_INDEX(0,3)] * matrix_ptr->data[WORD_INDEX(1,1)] * matrix_ptr->data[WORD_INDEX(2,2)] +
-                          matrix_ptr->data[WORD_INDEX(0,1)] * matrix_ptr->data[WORD_INDEX(1,3)] * matrix_ptr->data[WORD_INDEX(2,2)] +
-                          matrix_ptr->data[WORD_INDEX(0,2)] * matrix_ptr->data[WORD_INDEX(1,1)] * matrix_ptr->data[WORD_INDEX(2,3)] -
-                          matrix_ptr->data[WORD_INDEX(0,1)] * matrix_ptr->data[WORD_INDEX(1,2)] * matrix_ptr->data[WORD_INDEX(2,3)];
-    m[WORD_INDEX(1, 0)] = matrix_ptr->data[WORD_INDEX(1,3)] * matrix_ptr->data[WORD_INDEX(2,2)] * matrix_ptr->data[WORD_INDEX(3,0)] -
-                          matrix_ptr->data[WORD_INDEX(1,2)] * matrix_ptr->data[WORD_INDEX(2,3)] * matrix_ptr->data[WORD_INDEX(3,0)] -
-                          matrix_ptr->data[WORD_INDEX(1,3)] * matrix_ptr->data[WORD_INDEX(2,0)] * matrix_ptr->data[WORD_INDEX(3,2)] +
-                          matrix_ptr->data[WORD_INDEX(1,0)] * matrix_ptr->data[WORD_INDEX(2,3)] * matrix_ptr->data[WORD_INDEX(3,2)] +
-                          matrix_ptr->data[WORD_INDEX(1,2)] * matrix_ptr->data[WORD_INDEX(2,0)] * matrix_ptr->data[WORD_INDEX(3,3)] -
-                          matrix_ptr->data[WORD_INDEX(1,0)] * matrix_ptr->data[WORD_INDEX(2,2)] * matrix_ptr->data[WORD_INDEX(3,3)];
-    m[WORD_INDEX(1, 1)] = matrix_ptr->data[WORD_INDEX(0,2)] * matrix_ptr->data[WORD_INDEX(2,3)] * matrix_ptr->data[WORD_INDEX(3,0)] -
-                          matrix_ptr->data[WORD_INDEX(0,3)] * matrix_ptr->data[WORD_INDEX(2,2)] * matrix_ptr->data[WORD_INDEX(3,0)] +
-                          matrix_ptr->data[WORD_INDEX(0,3)] * matrix_ptr->data[WORD_INDEX(2,0)] * matrix_ptr->data[WORD_INDEX(3,2)] -
-                          matrix_ptr->data[WORD_INDEX(0,0)] * matrix_ptr->data[WORD_INDEX(2,3)] * matrix_ptr->data[WORD_INDEX(3,2)] -
-                          matrix_ptr->data[WORD_INDEX(0,2)] * matrix_ptr->data[WORD_INDEX(2,0)] * matrix_ptr->data[WORD_INDEX(3,3)] +
-                          matrix_ptr->data[WORD_INDEX(0,0)] * matrix_ptr->data[WORD_INDEX(2,2)] * matrix_ptr->data[WORD_INDEX(3,3)];
-    m[WORD_INDEX(1, 2)] = matrix_ptr->data[WORD_INDEX(0,3)] * matrix_ptr->data[WORD_INDEX(1,2)] * matrix_ptr->data[WORD_INDEX(3,0)] -
-                          matrix_ptr->data[WORD_INDEX(0,2)] * matrix_ptr->data[WORD_INDEX(1,3)] * matrix_ptr->data[WORD_INDEX(3,0)] -
-                          matrix_ptr->data[WORD_INDEX(0,3)] * matrix_ptr->data[WORD_INDEX(1,0)] * matrix_ptr->data[WORD_INDEX(3,2)] +
-                          matrix_ptr->data[WORD_INDEX(0,0)] * matrix_ptr->data[WORD_INDEX(1,3)] * matrix_ptr->data[WORD_INDEX(3,2)] +
-                          matrix_ptr->data[WORD_INDEX(0,2)] * matrix_ptr->data[WORD_INDEX(1,0)] * matrix_ptr->data[WORD_INDEX(3,3)] -
-                          matrix_ptr->data[WORD_INDEX(0,0)] * matrix_ptr->data[WORD_INDEX(1,2)] * matrix_ptr->data[WORD_INDEX(3,3)];
-    m[WORD_INDEX(1, 3)] = matrix_ptr->data[WORD_INDEX(0,2)] * matrix_ptr->data[WORD_INDEX(1,3)] * matrix_ptr->data[WORD_INDEX(2,0)] -
-                          matrix_ptr->data[WORD_INDEX(0,3)] * matrix_ptr->data[WORD_INDEX(1,2)] * matrix_ptr->data[WORD_INDEX(2,0)] +
-                          matrix_ptr->data[WORD_INDEX(0,3)] * matrix_ptr->data[WORD_INDEX(1,0)] * matrix_ptr->data[WORD_INDEX(2,2)] -
-                          matrix_ptr->data[WORD_INDEX(0,0)] * matrix_ptr->data[WORD_INDEX(1,3)] * matrix_ptr->data[WORD_INDEX(2,2)] -
-                          matrix_ptr->data[WORD_INDEX(0,2)] * matrix_ptr->data[WORD_INDEX(1,0)] * matrix_ptr->data[WORD_INDEX(2,3)] +
-                          matrix_ptr->data[WORD_INDEX(0,0)] * matrix_ptr->data[WORD_INDEX(1,2)] * matrix_ptr->data[WORD_INDEX(2,3)];
-    m[WORD_INDEX(2, 0)] = matrix_ptr->data[WORD_INDEX(1,1)] * matrix_ptr->data[WORD_INDEX(2,3)] * matrix_ptr->data[WORD_INDEX(3,0)] -
-                          matrix_ptr->data[WORD_INDEX(1,3)] * matrix_ptr->data[WORD_INDEX(2,1)] * matrix_ptr->data[WORD_INDEX(3,0)] +
-                          matrix_ptr->data[WORD_INDEX(1,3)] * matrix_ptr->data[WORD_INDEX(2,0)] * matrix_ptr->data[WORD_INDEX(3,1)] -
-                          matrix_ptr->data[WORD_INDEX(1,0)] * matrix_ptr->data[WORD_INDEX(2,3)] * matrix_ptr->data[WORD_INDEX(3,1)] -
-                          matrix_ptr->data[WORD_INDEX(1,1)] * matrix_ptr->data[WORD_INDEX(2,0)] * matrix_ptr->data[WORD_INDEX(3,3)] +
-                          matrix_ptr->data[WORD_INDEX(1,0)] * matrix_ptr->data[WORD_INDEX(2,1)] * matrix_ptr->data[WORD_INDEX(3,3)];
-    m[WORD_INDEX(2, 1)] = matrix_ptr->data[WORD_INDEX(0,3)] * matrix_ptr->data[WORD_INDEX(2,1)] * matrix_ptr->data[WORD_INDEX(3,0)] -
-                          matrix_ptr->data[WORD_INDEX(0,1)] * matrix_ptr->data[WORD_INDEX(2,3)] * matrix_ptr->data[WORD_INDEX(3,0)] -
-                          matrix_ptr->data[WORD_INDEX(0,3)] * matrix_ptr->data[WORD_INDEX(2,0)] * matrix_ptr->data[WORD_INDEX(3,1)] +
-                          matrix_ptr->data[WORD_INDEX(0,0)] * matrix_ptr->data[WORD_INDEX(2,3)] * matrix_ptr->data[WORD_INDEX(3,1)] +
-                          matrix_ptr->data[WORD_INDEX(0,1)] * matrix_ptr->data[WORD_INDEX(2,0)] * matrix_ptr->data[WORD_INDEX(3,3)] -
-                          matrix_ptr->data[WORD_INDEX(0,0)] * matrix_ptr->data[WORD_INDEX(2,1)] * matrix_ptr->data[WORD_INDEX(3,3)];
-    m[WORD_INDEX(2, 2)] = matrix_ptr->data[WORD_INDEX(0,1)] * matrix_ptr->data[WORD_INDEX(1,3)] * matrix_ptr->data[WORD_INDEX(3,0)] -
-                          matrix_ptr->data[WORD_INDEX(0,3)] * matrix_ptr->data[WORD_INDEX(1,1)] * matrix_ptr->data[WORD_INDEX(3,0)] +
-                          matrix_ptr->data[WORD_INDEX(0,3)] * matrix_ptr->data[WORD_INDEX(1,0)] * matrix_ptr->data[WORD_INDEX(3,1)] -
-                          matrix_ptr->data[WORD_INDEX(0,0)] * matrix_ptr->data[WORD_INDEX(1,3)] * matrix_ptr->data[WORD_INDEX(3,1)] -
-                          matrix_ptr->data[WORD_INDEX(0,1)] * matrix_ptr->data[WORD_INDEX(1,0)] * matrix_ptr->data[WORD_INDEX(3,3)] +
-                          matrix_ptr->data[WORD_INDEX(0,0)] * matrix_ptr->data[WORD_INDEX(1,1)] * matrix_ptr->data[WORD_INDEX(3,3)];
-    m[WORD_INDEX(2, 3)] = matrix_ptr->data[WORD_INDEX(0,3)] * matrix_ptr->data[WORD_INDEX(1,1)] * matrix_ptr->data[WORD_INDEX(2,0)] -
-                          matrix_ptr->data[WORD_INDEX(0,1)] * matrix_ptr->data[WORD_INDEX(1,3)] * matrix_ptr->data[WORD_INDEX(2,0)] -
-                          matrix_ptr->data[WORD_INDEX(0,3)] * matrix_ptr->data[WORD_INDEX(1,0)] * matrix_ptr->data[WORD_INDEX(2,1)] +
-                          matrix_ptr->data[WORD_INDEX(0,0)] * matrix_ptr->data[WORD_INDEX(1,3)] * matrix_ptr->data[WORD_INDEX(2,1)] +
-                          matrix_ptr->data[WORD_INDEX(0,1)] * matrix_ptr->data[WORD_INDEX(1,0)] * matrix_ptr->data[WORD_INDEX(2,3)] -
-                          matrix_ptr->data[WORD_INDEX(0,0)] * matrix_ptr->data[WORD_INDEX(1,1)] * matrix_ptr->data[WORD_INDEX(2,3)];
-    m[WORD_INDEX(3, 0)] = matrix_ptr->data[WORD_INDEX(1,2)] * matrix_ptr->data[WORD_INDEX(2,1)] * matrix_ptr->data[WORD_INDEX(3,0)] -
-                          matrix_ptr->data[WORD_INDEX(1,1)] * matrix_ptr->data[WORD_INDEX(2,2)] * matrix_ptr->data[WORD_INDEX(3,0)] -
-                          matrix_ptr->data[WORD_INDEX(1,2)] * matrix_ptr->data[WORD_INDEX(2,0)] * matrix_ptr->data[WORD_INDEX(3,1)] +
-                          matrix_ptr->data[WORD_INDEX(1,0)] * matrix_ptr->data[WORD_INDEX(2,2)] * matrix_ptr->data[WORD_INDEX(3,1)] +
-                          matrix_ptr->data[WORD_INDEX(1,1)] * matrix_ptr->data[WORD_INDEX(2,0)] * matrix_ptr->data[WORD_INDEX(3,2)] -
-                          matrix_ptr->data[WORD_INDEX(1,0)] * matrix_ptr->data[WORD_INDEX(2,1)] * matrix_ptr->data[WORD_INDEX(3,2)];
-    m[WORD_INDEX(3, 1)] = matrix_ptr->data[WORD_INDEX(0,1)] * matrix_ptr->data[WORD_INDEX(2,2)] * matrix_ptr->data[WORD_INDEX(3,0)] -
-                          matrix_ptr->data[WORD_INDEX(0,2)] * matrix_ptr->data[WORD_INDEX(2,1)] * matrix_ptr->data[WORD_INDEX(3,0)] +
-                          matrix_ptr->data[WORD_INDEX(0,2)] * matrix_ptr->data[WORD_INDEX(2,0)] * matrix_ptr->data[WORD_INDEX(3,1)] -
-                          matrix_ptr->data[WORD_INDEX(0,0)] * matrix_ptr->data[WORD_INDEX(2,2)] * matrix_ptr->data[WORD_INDEX(3,1)] -
-                          matrix_ptr->data[WORD_INDEX(0,1)] * matrix_ptr->data[WORD_INDEX(2,0)] * matrix_ptr->data[WORD_INDEX(3,2)] +
-                          matrix_ptr->data[WORD_INDEX(0,0)] * matrix_ptr->data[WORD_INDEX(2,1)] * matrix_ptr->data[WORD_INDEX(3,2)];
-    m[WORD_INDEX(3, 2)] = matrix_ptr->data[WORD_INDEX(0,2)] * matrix_ptr->data[WORD_INDEX(1,1)] * matrix_ptr->data[WORD_INDEX(3,0)] -
-                          matrix_ptr->data[WORD_INDEX(0,1)] * matrix_ptr->data[WORD_INDEX(1,2)] * matrix_ptr->data[WORD_INDEX(3,0)] -
-                          matrix_ptr->data[WORD_INDEX(0,2)] * matrix_ptr->data[WORD_INDEX(1,0)] * matrix_ptr->data[WORD_INDEX(3,1)] +
-                          matrix_ptr->data[WORD_INDEX(0,0)] * matrix_ptr->data[WORD_INDEX(1,2)] * matrix_ptr->data[WORD_INDEX(3,1)] +
-                          matrix_ptr->data[WORD_INDEX(0,1)] * matrix_ptr->data[WORD_INDEX(1,0)] * matrix_ptr->data[WORD_INDEX(3,2)] -
-                          matrix_ptr->data[WORD_INDEX(0,0)] * matrix_ptr->data[WORD_INDEX(1,1)] * matrix_ptr->data[WORD_INDEX(3,2)];
-    m[WORD_INDEX(3, 3)] = matrix_ptr->data[WORD_INDEX(0,1)] * matrix_ptr->data[WORD_INDEX(1,2)] * matrix_ptr->data[WORD_INDEX(2,0)] -
-                          matrix_ptr->data[WORD_INDEX(0,2)] * matrix_ptr->data[WORD_INDEX(1,1)] * matrix_ptr->data[WORD_INDEX(2,0)] +
-                          matrix_ptr->data[WORD_INDEX(0,2)] * matrix_ptr->data[WORD_INDEX(1,0)] * matrix_ptr->data[WORD_INDEX(2,1)] -
-                          matrix_ptr->data[WORD_INDEX(0,0)] * matrix_ptr->data[WORD_INDEX(1,2)] * matrix_ptr->data[WORD_INDEX(2,1)] -
-                          matrix_ptr->data[WORD_INDEX(0,1)] * matrix_ptr->data[WORD_INDEX(1,0)] * matrix_ptr->data[WORD_INDEX(2,2)] +
-                          matrix_ptr->data[WORD_INDEX(0,0)] * matrix_ptr->data[WORD_INDEX(1,1)] * matrix_ptr->data[WORD_INDEX(2,2)];
-
-    const float invDet = 1.0f / det;
-
-    for (int i = 0;
-             i < 16;
-             i++)
-    {
-        matrix_ptr->data[i] = m[i] * invDet;
-    }
+    memcpy(matrix_ptr->data,
+           temp.data,
+           sizeof(temp.data) );
 
     matrix_ptr->is_data_dirty = true;
     return true;
@@ -733,30 +1150,28 @@ PUBLIC EMERALD_API void system_matrix4x4_multiply_by_matrix4x4(system_matrix4x4
 {
     _system_matrix4x4* a_ptr = reinterpret_cast<_system_matrix4x4*>(a);
     _system_matrix4x4* b_ptr = reinterpret_cast<_system_matrix4x4*>(b);
-    _system_matrix4x4  temp;
 
-    for (unsigned char column = 0;
-                       column < 4;
-                     ++column)
-    {
-        for (unsigned char row = 0;
-                           row < 4;
-                         ++row)
-        {
-            temp.data[WORD_INDEX(column, row)] = a_ptr->data[WORD_INDEX(0, row)] * b_ptr->data[WORD_INDEX(column, 0)] +
-                                                 a_ptr->data[WORD_INDEX(1, row)] * b_ptr->data[WORD_INDEX(column, 1)] +
-                                                 a_ptr->data[WORD_INDEX(2, row)] * b_ptr->data[WORD_INDEX(column, 2)] +
-                                                 a_ptr->data[WORD_INDEX(3, row)] * b_ptr->data[WORD_INDEX(column, 3)];
-        }
-    }
-
-    memcpy(&a_ptr->data,
-           temp.data,
-           sizeof(temp.data) );
+    /* All kernels read both operands before storing the result, so in-place multiplication is safe. */
+    active_kernels_ptr->pMultiplyMany(a_ptr->data,
+                                      b_ptr->data,
+                                      1, /* n_matrices */
+                                      a_ptr->data);
 
     a_ptr->is_data_dirty = true;
 }
 
+/** Please see header for specification */
+PUBLIC EMERALD_API void system_matrix4x4_multiply_many(const float* a_row_major_data_ptr,
+                                                       const float* b_row_major_data_ptr,
+                                                       unsigned int n_matrices,
+                                                       float*       out_row_major_data_ptr)
+{
+    active_kernels_ptr->pMultiplyMany(a_row_major_data_ptr,
+                                      b_row_major_data_ptr,
+                                      n_matrices,
+                                      out_row_major_data_ptr);
+}
+
 /** Please see header for specification */
 PUBLIC EMERALD_API void system_matrix4x4_multiply_by_vector4(system_matrix4x4 matrix,
                                                              const float*     vector_ptr,
@@ -1001,6 +1416,46 @@ PUBLIC EMERALD_API void system_matrix4x4_set_from_matrix4x4(system_matrix4x4 dst
            sizeof(_system_matrix4x4) );
 }
 
+/** Please see header for specification */
+PUBLIC EMERALD_API bool system_matrix4x4_set_kernel_set(system_matrix4x4_kernel_set kernel_set)
+{
+    bool result = false;
+
+    if (kernel_set >= SYSTEM_MATRIX4X4_KERNEL_SET_COUNT)
+    {
+        ASSERT_DEBUG_SYNC(false,
+                          "Invalid system_matrix4x4_kernel_set value");
+
+        goto end;
+    }
+
+    if (kernel_sets[kernel_set].pMultiplyMany == nullptr)
+    {
+        /* Not built for this platform */
+        goto end;
+    }
+
+    if (kernel_set == SYSTEM_MATRIX4X4_KERNEL_SET_AVX2)
+    {
+        bool cpu_supports_avx2 = false;
+
+        system_capabilities_get(SYSTEM_CAPABILITIES_PROPERTY_CPU_SUPPORTS_AVX2,
+                               &cpu_supports_avx2);
+
+        if (!cpu_supports_avx2)
+        {
+            goto end;
+        }
+    }
+
+    active_kernel_set  = kernel_set;
+    active_kernels_ptr = kernel_sets + kernel_set;
+    result             = true;
+
+end:
+    return result;
+}
+
 /** Please see header for specification */
 PUBLIC EMERALD_API void system_matrix4x4_translate(system_matrix4x4 matrix,
                                                    const float*     xyz_ptr)
@@ -1031,6 +1486,42 @@ PUBLIC EMERALD_API void system_matrix4x4_translate(system_matrix4x4 matrix,
     system_matrix4x4_release(translation_matrix);
 }
 
+/** Please see header for specification */
+PUBLIC EMERALD_API void system_matrix4x4_transform_aabbs(system_matrix4x4 matrix,
+                                                         unsigned int     n_aabbs,
+                                                         const float*     aabb_min_ptr,
+                                                         const float*     aabb_max_ptr,
+                                                         float*           out_aabb_min_ptr,
+                                                         float*           out_aabb_max_ptr)
+{
+    active_kernels_ptr->pTransformAABBs(reinterpret_cast<_system_matrix4x4*>(matrix)->data,
+                                        n_aabbs,
+                                        aabb_min_ptr,
+                                        aabb_max_ptr,
+                                        out_aabb_min_ptr,
+                                        out_aabb_max_ptr);
+}
+
+/** Please see header for specification */
+PUBLIC EMERALD_API void system_matrix4x4_transform_points_soa(system_matrix4x4 matrix,
+                                                              unsigned int     n_points,
+                                                              const float*     x_ptr,
+                                                              const float*     y_ptr,
+                                                              const float*     z_ptr,
+                                                              float*           out_x_ptr,
+                                                              float*           out_y_ptr,
+                                                              float*           out_z_ptr)
+{
+    active_kernels_ptr->pTransformPointsSOA(reinterpret_cast<_system_matrix4x4*>(matrix)->data,
+                                            n_points,
+                                            x_ptr,
+                                            y_ptr,
+                                            z_ptr,
+                                            out_x_ptr,
+                                            out_y_ptr,
+                                            out_z_ptr);
+}
+
 /** Please see header for specification */
 PUBLIC EMERALD_API void system_matrix4x4_transpose(system_matrix4x4 matrix)
 {
@@ -1072,6 +1563,13 @@ PUBLIC void _system_matrix4x4_init()
         ASSERT_ALWAYS_SYNC(matrix_pool != nullptr,
                            "Could not create a 4x4 matrix pool");
     }
+
+    /* Pick the fastest kernel set the running CPU can handle. */
+    if (!system_matrix4x4_set_kernel_set(SYSTEM_MATRIX4X4_KERNEL_SET_AVX2) &&
+        !system_matrix4x4_set_kernel_set(SYSTEM_MATRIX4X4_KERNEL_SET_SSE2) )
+    {
+        system_matrix4x4_set_kernel_set(SYSTEM_MATRIX4X4_KERNEL_SET_SCALAR);
+    }
 }
 
 /** Please see header for specification */
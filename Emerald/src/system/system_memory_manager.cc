@@ -6,6 +6,7 @@
 #include "shared.h"
 #include "system/system_critical_section.h"
 #include "system/system_file_serializer.h"
+#include "system/system_hash64map.h"
 #include "system/system_list_bidirectional.h"
 #include "system/system_memory_manager.h"
 #include "system/system_resource_pool.h"
@@ -13,6 +14,16 @@
 
 #define MIN_PAGE_SIZE 4096
 
+/* TLSF configuration. Each first-level class covers a power-of-two size range, which is further
+ * split into (1 << TLSF_SL_INDEX_COUNT_LOG2) linearly-spaced second-level classes. Sizes smaller
+ * than TLSF_SMALL_BLOCK_SIZE are all mapped to the first first-level class, with one second-level
+ * class per byte count.
+ */
+#define TLSF_SL_INDEX_COUNT_LOG2 (5)
+#define TLSF_SL_INDEX_COUNT      (1 << TLSF_SL_INDEX_COUNT_LOG2)
+#define TLSF_SMALL_BLOCK_SIZE    (TLSF_SL_INDEX_COUNT)
+#define TLSF_FL_INDEX_COUNT      (32 - TLSF_SL_INDEX_COUNT_LOG2 + 1)
+
 /* If this is defined, alloc and free operations will be logged to a text file.
  * This is useful for hunting down bugs in the memory manager layer */
 #ifdef _DEBUG
@@ -39,11 +50,37 @@ typedef struct _system_memory_manager_block
     unsigned int result_offset; /* the offset returned by the alloc() function. takes user-specified alignment into consideration */
 } _system_memory_manager_block;
 
+/* Describes a single contiguous memory region, managed by the TLSF policy. Regions tile the whole
+ * managed memory block, are linked in address order and never leave two free regions next to each
+ * other. Free regions are additionally linked into the free list of their size class.
+ */
+typedef struct _system_memory_manager_tlsf_block
+{
+    unsigned int offset;
+    unsigned int size;
+    bool         is_free;
+
+    _system_memory_manager_tlsf_block* next_free;
+    _system_memory_manager_tlsf_block* next_physical;
+    _system_memory_manager_tlsf_block* prev_free;
+    _system_memory_manager_tlsf_block* prev_physical;
+} _system_memory_manager_tlsf_block;
+
 typedef struct _system_memory_manager
 {
+    system_memory_manager_policy policy;
+
+    /* SYSTEM_MEMORY_MANAGER_POLICY_FIRST_FIT: */
     system_list_bidirectional alloced_blocks;        /* holds allocated memory region descriptors (owned by block_descriptor_pool) */
     system_list_bidirectional available_blocks;      /* holds available memory region descriptors (owned by block_descriptor_pool) */
-    system_resource_pool      block_descriptor_pool; /* holds _system_memory_manager_block items */
+
+    /* SYSTEM_MEMORY_MANAGER_POLICY_TLSF: */
+    _system_memory_manager_tlsf_block* tlsf_free_blocks[TLSF_FL_INDEX_COUNT][TLSF_SL_INDEX_COUNT];
+    uint32_t                           tlsf_fl_bitmap;                      /* n-th bit set if tlsf_sl_bitmaps[n] != 0 */
+    uint32_t                           tlsf_sl_bitmaps[TLSF_FL_INDEX_COUNT]; /* m-th bit of n-th item set if tlsf_free_blocks[n][m] != NULL */
+    system_hash64map                   tlsf_used_blocks;                    /* maps alloc offsets to _system_memory_manager_tlsf_block instances */
+
+    system_resource_pool      block_descriptor_pool; /* holds _system_memory_manager_block or _system_memory_manager_tlsf_block items, depending on the policy */
 
     system_critical_section              cs;
     unsigned int                         memory_region_size;
@@ -68,6 +105,7 @@ typedef struct _system_memory_manager
     unsigned int* page_owners;
 
     explicit _system_memory_manager(bool                                 in_thread_safe,
+                                    system_memory_manager_policy         in_policy,
                                     unsigned int                         in_memory_region_size,
                                     unsigned int                         in_page_size,
                                     void*                                in_user_arg,
@@ -87,19 +125,43 @@ typedef struct _system_memory_manager
             cs = NULL;
         }
 
-        alloced_blocks              = system_list_bidirectional_create();
-        available_blocks            = system_list_bidirectional_create();
-        block_descriptor_pool       = system_resource_pool_create     (sizeof(_system_memory_manager_block),
-                                                                       16,  /* n_elements */
-                                                                       NULL,  /* init_fn */
-                                                                       NULL); /* deinit_fn */
+        if (in_policy == SYSTEM_MEMORY_MANAGER_POLICY_TLSF)
+        {
+            alloced_blocks        = NULL;
+            available_blocks      = NULL;
+            block_descriptor_pool = system_resource_pool_create(sizeof(_system_memory_manager_tlsf_block),
+                                                                16,    /* n_elements */
+                                                                NULL,  /* init_fn */
+                                                                NULL); /* deinit_fn */
+            tlsf_used_blocks      = system_hash64map_create    (sizeof(_system_memory_manager_tlsf_block*) );
+        }
+        else
+        {
+            alloced_blocks        = system_list_bidirectional_create();
+            available_blocks      = system_list_bidirectional_create();
+            block_descriptor_pool = system_resource_pool_create     (sizeof(_system_memory_manager_block),
+                                                                     16,    /* n_elements */
+                                                                     NULL,  /* init_fn */
+                                                                     NULL); /* deinit_fn */
+            tlsf_used_blocks      = NULL;
+        }
+
         memory_region_size          = in_memory_region_size;
         page_owners                 = new (std::nothrow) unsigned int[n_page_owners];
         page_size                   = in_page_size;
         pfn_on_memory_block_alloced = in_pfn_on_memory_block_alloced;
         pfn_on_memory_block_freed   = in_pfn_on_memory_block_freed;
+        policy                      = in_policy;
+        tlsf_fl_bitmap              = 0;
         user_arg                    = in_user_arg;
 
+        memset(tlsf_free_blocks,
+               0,
+               sizeof(tlsf_free_blocks) );
+        memset(tlsf_sl_bitmaps,
+               0,
+               sizeof(tlsf_sl_bitmaps) );
+
         #ifdef LOG_ALLOC_HISTORY
         {
             char temp[1024];
@@ -160,6 +222,13 @@ typedef struct _system_memory_manager
             block_descriptor_pool = NULL;
         }
 
+        if (tlsf_used_blocks != NULL)
+        {
+            system_hash64map_release(tlsf_used_blocks);
+
+            tlsf_used_blocks = NULL;
+        }
+
         if (cs != NULL)
         {
             system_critical_section_release(cs);
@@ -180,36 +249,580 @@ typedef struct _system_memory_manager
     unsigned int _system_memory_manager::n_alloc_log_serializers = 0;
 #endif
 
-/** Please see header for spec */
-PUBLIC EMERALD_API bool system_memory_manager_alloc_block(system_memory_manager manager,
-                                                          unsigned int          size,
-                                                          unsigned int          required_alignment,
-                                                          unsigned int*         out_allocation_offset)
+/** Returns index of the highest bit set in a non-zero 32-bit value. */
+PRIVATE inline unsigned int _system_memory_manager_get_highest_bit_index(uint32_t value)
 {
-    _system_memory_manager* manager_ptr = (_system_memory_manager*) manager;
-    bool                    result      = false;
+#ifdef _WIN32
+    unsigned long result = 0;
 
-    if (manager_ptr->cs != NULL)
+    _BitScanReverse(&result,
+                    value);
+
+    return (unsigned int) result;
+#else
+    return 31 - __builtin_clz(value);
+#endif
+}
+
+/** Returns index of the lowest bit set in a non-zero 32-bit value. */
+PRIVATE inline unsigned int _system_memory_manager_get_lowest_bit_index(uint32_t value)
+{
+#ifdef _WIN32
+    unsigned long result = 0;
+
+    _BitScanForward(&result,
+                    value);
+
+    return (unsigned int) result;
+#else
+    return __builtin_ctz(value);
+#endif
+}
+
+/** Updates page owner counters for all pages touched by the specified memory region and
+ *  calls back the owner for each run of pages, which have just become used.
+ *
+ *  Only used by the TLSF policy.
+ */
+PRIVATE void _system_memory_manager_commit_pages(_system_memory_manager* manager_ptr,
+                                                 unsigned int            offset,
+                                                 unsigned int            size)
+{
+    const unsigned int page_index_start = offset              / manager_ptr->page_size;
+    const unsigned int page_index_end   = (offset + size - 1) / manager_ptr->page_size + 1;
+          unsigned int run_page_index   = UINT32_MAX; /* first page of the run of pages that have not been reported yet */
+
+    for (unsigned int page_index  = page_index_start;
+                      page_index <= page_index_end;
+                    ++page_index)
     {
-        system_critical_section_enter(manager_ptr->cs);
+        const bool is_newly_used_page = (page_index < page_index_end) &&
+                                        (++manager_ptr->page_owners[page_index] == 1);
+
+        if (is_newly_used_page)
+        {
+            if (run_page_index == UINT32_MAX)
+            {
+                run_page_index = page_index;
+            }
+        }
+        else
+        if (run_page_index != UINT32_MAX)
+        {
+            if (manager_ptr->pfn_on_memory_block_alloced != NULL)
+            {
+                manager_ptr->pfn_on_memory_block_alloced((system_memory_manager) manager_ptr,
+                                                          run_page_index                * manager_ptr->page_size,
+                                                         (page_index - run_page_index) * manager_ptr->page_size,
+                                                         manager_ptr->user_arg);
+            }
+
+            run_page_index = UINT32_MAX;
+        }
     }
+}
 
-    #ifdef LOG_ALLOC_HISTORY
+/** Counterpart of _system_memory_manager_commit_pages(). Calls back the owner for each run of pages,
+ *  which no longer hold any allocation.
+ *
+ *  Only used by the TLSF policy.
+ */
+PRIVATE void _system_memory_manager_decommit_pages(_system_memory_manager* manager_ptr,
+                                                   unsigned int            offset,
+                                                   unsigned int            size)
+{
+    const unsigned int page_index_start = offset              / manager_ptr->page_size;
+    const unsigned int page_index_end   = (offset + size - 1) / manager_ptr->page_size + 1;
+          unsigned int run_page_index   = UINT32_MAX; /* first page of the run of pages that have not been reported yet */
+
+    for (unsigned int page_index  = page_index_start;
+                      page_index <= page_index_end;
+                    ++page_index)
     {
-        char temp[1024];
+        bool is_newly_unused_page = false;
 
-        snprintf(temp,
-                 sizeof(temp),
-                 "system_memory_manager_alloc_block(size:%d required_alignment:%d)\n",
-                 size,
-                 required_alignment);
+        if (page_index < page_index_end)
+        {
+            ASSERT_DEBUG_SYNC(manager_ptr->page_owners[page_index] > 0,
+                              "Zero counter detected!");
 
-        system_file_serializer_write       (manager_ptr->alloc_log_serializer,
-                                            strlen(temp),
-                                            temp);
-        system_file_serializer_flush_writes(manager_ptr->alloc_log_serializer);
+            is_newly_unused_page = (--manager_ptr->page_owners[page_index] == 0);
+        }
+
+        if (is_newly_unused_page)
+        {
+            if (run_page_index == UINT32_MAX)
+            {
+                run_page_index = page_index;
+            }
+        }
+        else
+        if (run_page_index != UINT32_MAX)
+        {
+            if (manager_ptr->pfn_on_memory_block_freed != NULL)
+            {
+                manager_ptr->pfn_on_memory_block_freed((system_memory_manager) manager_ptr,
+                                                        run_page_index                * manager_ptr->page_size,
+                                                       (page_index - run_page_index) * manager_ptr->page_size,
+                                                       manager_ptr->user_arg);
+            }
+
+            run_page_index = UINT32_MAX;
+        }
+    }
+}
+
+/** Calculates the first- and second-level class indices of the free list a block of the specified size
+ *  should be stored in.
+ */
+PRIVATE inline void _system_memory_manager_tlsf_get_class_for_block_size(uint64_t      size,
+                                                                         unsigned int* out_fl_index_ptr,
+                                                                         unsigned int* out_sl_index_ptr)
+{
+    if (size < TLSF_SMALL_BLOCK_SIZE)
+    {
+        *out_fl_index_ptr = 0;
+        *out_sl_index_ptr = (unsigned int) size;
+    }
+    else
+    {
+        const unsigned int highest_bit_index = _system_memory_manager_get_highest_bit_index( (uint32_t) size);
+
+        *out_fl_index_ptr = highest_bit_index - TLSF_SL_INDEX_COUNT_LOG2 + 1;
+        *out_sl_index_ptr = (unsigned int) (size >> (highest_bit_index - TLSF_SL_INDEX_COUNT_LOG2)) ^ TLSF_SL_INDEX_COUNT;
+    }
+}
+
+/** Calculates the first- and second-level class indices of the first free list, whose blocks are all
+ *  guaranteed to be at least @param size bytes large.
+ *
+ *  @return true if successful, false if the requested size is too large to be mapped.
+ */
+PRIVATE inline bool _system_memory_manager_tlsf_get_class_for_alloc_size(uint64_t      size,
+                                                                         unsigned int* out_fl_index_ptr,
+                                                                         unsigned int* out_sl_index_ptr)
+{
+    if (size > UINT32_MAX)
+    {
+        return false;
+    }
+
+    if (size >= TLSF_SMALL_BLOCK_SIZE)
+    {
+        /* Round the size up to the start of the next second-level class */
+        const unsigned int highest_bit_index = _system_memory_manager_get_highest_bit_index( (uint32_t) size);
+
+        size += (1ull << (highest_bit_index - TLSF_SL_INDEX_COUNT_LOG2)) - 1;
+    }
+
+    if (size > UINT32_MAX)
+    {
+        return false;
+    }
+
+    _system_memory_manager_tlsf_get_class_for_block_size(size,
+                                                         out_fl_index_ptr,
+                                                         out_sl_index_ptr);
+
+    return true;
+}
+
+/** Returns the head of the first non-empty free list of a class equal to or larger than the specified one,
+ *  or NULL if no such list exists. Class indices are updated to point to the returned block's class.
+ */
+PRIVATE inline _system_memory_manager_tlsf_block* _system_memory_manager_tlsf_find_free_block(_system_memory_manager* manager_ptr,
+                                                                                              unsigned int*           inout_fl_index_ptr,
+                                                                                              unsigned int*           inout_sl_index_ptr)
+{
+    unsigned int fl_index  = *inout_fl_index_ptr;
+    uint32_t     sl_bitmap = manager_ptr->tlsf_sl_bitmaps[fl_index] & (UINT32_MAX << *inout_sl_index_ptr);
+
+    if (sl_bitmap == 0)
+    {
+        /* No suitable block in this first-level class. Move to the next non-empty one. */
+        const uint32_t fl_bitmap = (fl_index + 1 < TLSF_FL_INDEX_COUNT) ? manager_ptr->tlsf_fl_bitmap & (UINT32_MAX << (fl_index + 1) )
+                                                                        : 0;
+
+        if (fl_bitmap == 0)
+        {
+            return NULL;
+        }
+
+        fl_index  = _system_memory_manager_get_lowest_bit_index(fl_bitmap);
+        sl_bitmap = manager_ptr->tlsf_sl_bitmaps[fl_index];
+    }
+
+    *inout_fl_index_ptr = fl_index;
+    *inout_sl_index_ptr = _system_memory_manager_get_lowest_bit_index(sl_bitmap);
+
+    return manager_ptr->tlsf_free_blocks[fl_index][*inout_sl_index_ptr];
+}
+
+/** Links a free block into the free list of its size class. */
+PRIVATE void _system_memory_manager_tlsf_insert_free_block(_system_memory_manager*            manager_ptr,
+                                                           _system_memory_manager_tlsf_block* block_ptr)
+{
+    unsigned int fl_index = 0;
+    unsigned int sl_index = 0;
+
+    _system_memory_manager_tlsf_get_class_for_block_size(block_ptr->size,
+                                                        &fl_index,
+                                                        &sl_index);
+
+    block_ptr->is_free   = true;
+    block_ptr->next_free = manager_ptr->tlsf_free_blocks[fl_index][sl_index];
+    block_ptr->prev_free = NULL;
+
+    if (block_ptr->next_free != NULL)
+    {
+        block_ptr->next_free->prev_free = block_ptr;
+    }
+
+    manager_ptr->tlsf_free_blocks[fl_index][sl_index]  = block_ptr;
+    manager_ptr->tlsf_fl_bitmap                       |= (1u << fl_index);
+    manager_ptr->tlsf_sl_bitmaps[fl_index]            |= (1u << sl_index);
+}
+
+/** Unlinks a free block from the free list of its size class. */
+PRIVATE void _system_memory_manager_tlsf_remove_free_block(_system_memory_manager*            manager_ptr,
+                                                           _system_memory_manager_tlsf_block* block_ptr)
+{
+    unsigned int fl_index = 0;
+    unsigned int sl_index = 0;
+
+    _system_memory_manager_tlsf_get_class_for_block_size(block_ptr->size,
+                                                        &fl_index,
+                                                        &sl_index);
+
+    if (block_ptr->prev_free != NULL)
+    {
+        block_ptr->prev_free->next_free = block_ptr->next_free;
+    }
+    else
+    {
+        ASSERT_DEBUG_SYNC(manager_ptr->tlsf_free_blocks[fl_index][sl_index] == block_ptr,
+                          "Free list corruption detected.");
+
+        manager_ptr->tlsf_free_blocks[fl_index][sl_index] = block_ptr->next_free;
+
+        if (block_ptr->next_free == NULL)
+        {
+            manager_ptr->tlsf_sl_bitmaps[fl_index] &= ~(1u << sl_index);
+
+            if (manager_ptr->tlsf_sl_bitmaps[fl_index] == 0)
+            {
+                manager_ptr->tlsf_fl_bitmap &= ~(1u << fl_index);
+            }
+        }
+    }
+
+    if (block_ptr->next_free != NULL)
+    {
+        block_ptr->next_free->prev_free = block_ptr->prev_free;
+    }
+
+    block_ptr->is_free   = false;
+    block_ptr->next_free = NULL;
+    block_ptr->prev_free = NULL;
+}
+
+/** Tells whether an allocation of the specified size & alignment can be carved out of the block. */
+PRIVATE inline bool _system_memory_manager_tlsf_does_block_fit(const _system_memory_manager_tlsf_block* block_ptr,
+                                                               unsigned int                             size,
+                                                               unsigned int                             alignment)
+{
+    const unsigned int padding = (alignment - block_ptr->offset % alignment) % alignment;
+
+    return (uint64_t) block_ptr->size >= (uint64_t) size + padding;
+}
+
+/** Splits the first @param size bytes off a block. The remaining part is returned to the free lists.
+ *
+ *  @return The newly created block describing the remaining part, or NULL if the block was not split.
+ */
+PRIVATE _system_memory_manager_tlsf_block* _system_memory_manager_tlsf_split_block(_system_memory_manager*            manager_ptr,
+                                                                                   _system_memory_manager_tlsf_block* block_ptr,
+                                                                                   unsigned int                       size)
+{
+    _system_memory_manager_tlsf_block* remainder_block_ptr = NULL;
+
+    if (block_ptr->size > size)
+    {
+        remainder_block_ptr = (_system_memory_manager_tlsf_block*) system_resource_pool_get_from_pool(manager_ptr->block_descriptor_pool);
+
+        remainder_block_ptr->offset        = block_ptr->offset + size;
+        remainder_block_ptr->size          = block_ptr->size   - size;
+        remainder_block_ptr->next_physical = block_ptr->next_physical;
+        remainder_block_ptr->prev_physical = block_ptr;
+
+        if (block_ptr->next_physical != NULL)
+        {
+            block_ptr->next_physical->prev_physical = remainder_block_ptr;
+        }
+
+        block_ptr->next_physical = remainder_block_ptr;
+        block_ptr->size          = size;
+
+        _system_memory_manager_tlsf_insert_free_block(manager_ptr,
+                                                      remainder_block_ptr);
+    }
+
+    return remainder_block_ptr;
+}
+
+/** Merges the block physically following @param block_ptr into it and returns the merged block's descriptor to the pool. */
+PRIVATE void _system_memory_manager_tlsf_merge_with_next_block(_system_memory_manager*            manager_ptr,
+                                                               _system_memory_manager_tlsf_block* block_ptr)
+{
+    _system_memory_manager_tlsf_block* next_block_ptr = block_ptr->next_physical;
+
+    block_ptr->size          += next_block_ptr->size;
+    block_ptr->next_physical  = next_block_ptr->next_physical;
+
+    if (next_block_ptr->next_physical != NULL)
+    {
+        next_block_ptr->next_physical->prev_physical = block_ptr;
+    }
+
+    system_resource_pool_return_to_pool(manager_ptr->block_descriptor_pool,
+                                        (system_resource_pool_block) next_block_ptr);
+}
+
+/** TLSF implementation of system_memory_manager_alloc_block(). */
+PRIVATE bool _system_memory_manager_alloc_block_tlsf(system_memory_manager manager,
+                                                     unsigned int          size,
+                                                     unsigned int          required_alignment,
+                                                     unsigned int*         out_allocation_offset)
+{
+    const unsigned int                       alignment   = (required_alignment != 0) ? required_alignment : 1;
+          _system_memory_manager_tlsf_block* block_ptr   = NULL;
+          unsigned int                       fl_index    = 0;
+          _system_memory_manager*            manager_ptr = (_system_memory_manager*) manager;
+          unsigned int                       sl_index    = 0;
+
+    if (size == 0)
+    {
+        size = 1;
+    }
+
+    /* 1. Check the head of the first class, whose blocks are all large enough to hold the allocation.
+     *    Unless the alignment requirements get in the way, this is the good-fit block.
+     */
+    if (_system_memory_manager_tlsf_get_class_for_alloc_size(size,
+                                                            &fl_index,
+                                                            &sl_index) )
+    {
+        block_ptr = _system_memory_manager_tlsf_find_free_block(manager_ptr,
+                                                               &fl_index,
+                                                               &sl_index);
+
+        if (block_ptr != NULL                                      &&
+            !_system_memory_manager_tlsf_does_block_fit(block_ptr,
+                                                        size,
+                                                        alignment) )
+        {
+            block_ptr = NULL;
+        }
+    }
+
+    /* 2. Look for a block that is guaranteed to fit the allocation, regardless of its offset */
+    if (block_ptr == NULL                                                                 &&
+        alignment > 1                                                                     &&
+        _system_memory_manager_tlsf_get_class_for_alloc_size((uint64_t) size + alignment - 1,
+                                                             &fl_index,
+                                                             &sl_index) )
+    {
+        block_ptr = _system_memory_manager_tlsf_find_free_block(manager_ptr,
+                                                               &fl_index,
+                                                               &sl_index);
+    }
+
+    /* 3. The memory region is nearly exhausted. Before giving up, walk all free lists which may hold
+     *    a large enough block. This is linear in the number of free blocks, but it makes sure
+     *    we never fail an allocation the first-fit policy would have served.
+     */
+    if (block_ptr == NULL)
+    {
+        _system_memory_manager_tlsf_get_class_for_block_size(size,
+                                                            &fl_index,
+                                                            &sl_index);
+
+        while (block_ptr == NULL)
+        {
+            _system_memory_manager_tlsf_block* current_block_ptr = _system_memory_manager_tlsf_find_free_block(manager_ptr,
+                                                                                                              &fl_index,
+                                                                                                              &sl_index);
+
+            if (current_block_ptr == NULL)
+            {
+                break;
+            }
+
+            while (current_block_ptr != NULL)
+            {
+                if (_system_memory_manager_tlsf_does_block_fit(current_block_ptr,
+                                                               size,
+                                                               alignment) )
+                {
+                    block_ptr = current_block_ptr;
+
+                    break;
+                }
+
+                current_block_ptr = current_block_ptr->next_free;
+            }
+
+            /* Move to the next class */
+            if (++sl_index == TLSF_SL_INDEX_COUNT)
+            {
+                if (++fl_index == TLSF_FL_INDEX_COUNT)
+                {
+                    break;
+                }
+
+                sl_index = 0;
+            }
+        }
+    }
+
+    if (block_ptr == NULL)
+    {
+        return false;
+    }
+
+    /* Carve the allocation out of the block. Any padding required to meet the alignment requirements
+     * is split off and returned to the free lists, so that the allocated block starts exactly at the
+     * reported offset. Since free blocks are always coalesced, neither of the block's physical
+     * neighbours can be free at this point.
+     */
+    const unsigned int padding = (alignment - block_ptr->offset % alignment) % alignment;
+
+    _system_memory_manager_tlsf_remove_free_block(manager_ptr,
+                                                  block_ptr);
+
+    if (padding != 0)
+    {
+        _system_memory_manager_tlsf_block* padding_block_ptr = block_ptr;
+
+        block_ptr = _system_memory_manager_tlsf_split_block(manager_ptr,
+                                                            padding_block_ptr,
+                                                            padding);
+
+        _system_memory_manager_tlsf_remove_free_block(manager_ptr,
+                                                      block_ptr);
+        _system_memory_manager_tlsf_insert_free_block(manager_ptr,
+                                                      padding_block_ptr);
+    }
+
+    _system_memory_manager_tlsf_split_block(manager_ptr,
+                                            block_ptr,
+                                            size);
+
+    ASSERT_DEBUG_SYNC(block_ptr->offset + block_ptr->size <= manager_ptr->memory_region_size,
+                      "Allocation exceeding available pages!");
+
+    system_hash64map_insert(manager_ptr->tlsf_used_blocks,
+                            block_ptr->offset,
+                            block_ptr,
+                            NULL,  /* callback */
+                            NULL); /* callback_user_arg */
+
+    if (manager_ptr->pfn_on_memory_block_alloced != NULL ||
+        manager_ptr->pfn_on_memory_block_freed   != NULL)
+    {
+        _system_memory_manager_commit_pages(manager_ptr,
+                                            block_ptr->offset,
+                                            block_ptr->size);
+    }
+
+    *out_allocation_offset = block_ptr->offset;
+
+    return true;
+}
+
+/** TLSF implementation of system_memory_manager_free_block(). */
+PRIVATE void _system_memory_manager_free_block_tlsf(system_memory_manager manager,
+                                                    unsigned int          alloc_offset)
+{
+    _system_memory_manager_tlsf_block* block_ptr   = NULL;
+    _system_memory_manager*            manager_ptr = (_system_memory_manager*) manager;
+
+    if (!system_hash64map_get(manager_ptr->tlsf_used_blocks,
+                              alloc_offset,
+                             &block_ptr) )
+    {
+        ASSERT_DEBUG_SYNC(false,
+                          "Submitted memory block was not found.");
+
+        return;
+    }
+
+    system_hash64map_remove(manager_ptr->tlsf_used_blocks,
+                            alloc_offset);
+
+    if (manager_ptr->pfn_on_memory_block_alloced != NULL ||
+        manager_ptr->pfn_on_memory_block_freed   != NULL)
+    {
+        _system_memory_manager_decommit_pages(manager_ptr,
+                                              block_ptr->offset,
+                                              block_ptr->size);
+    }
+
+    /* Coalesce with free physical neighbours */
+    if (block_ptr->next_physical          != NULL &&
+        block_ptr->next_physical->is_free)
+    {
+        _system_memory_manager_tlsf_remove_free_block    (manager_ptr,
+                                                          block_ptr->next_physical);
+        _system_memory_manager_tlsf_merge_with_next_block(manager_ptr,
+                                                          block_ptr);
+    }
+
+    if (block_ptr->prev_physical          != NULL &&
+        block_ptr->prev_physical->is_free)
+    {
+        _system_memory_manager_tlsf_block* prev_block_ptr = block_ptr->prev_physical;
+
+        _system_memory_manager_tlsf_remove_free_block    (manager_ptr,
+                                                          prev_block_ptr);
+        _system_memory_manager_tlsf_merge_with_next_block(manager_ptr,
+                                                          prev_block_ptr);
+
+        block_ptr = prev_block_ptr;
+    }
+
+    _system_memory_manager_tlsf_insert_free_block(manager_ptr,
+                                                  block_ptr);
+}
+
+/** Accounts for a single free block in a fragmentation report. */
+PRIVATE void _system_memory_manager_add_free_block_to_fragmentation_report(unsigned int                                block_size,
+                                                                           system_memory_manager_fragmentation_report* report_ptr)
+{
+    if (block_size == 0)
+    {
+        return;
+    }
+
+    if (report_ptr->largest_free_block_size < block_size)
+    {
+        report_ptr->largest_free_block_size = block_size;
     }
-    #endif /* LOG_ALLOC_HISTORY */
+
+    report_ptr->n_free_blocks   ++;
+    report_ptr->total_free_size += block_size;
+
+    report_ptr->n_free_blocks_per_size_log2[_system_memory_manager_get_highest_bit_index(block_size)]++;
+}
+
+/** First-fit implementation of system_memory_manager_alloc_block(). */
+PRIVATE bool _system_memory_manager_alloc_block_first_fit(system_memory_manager manager,
+                                                          unsigned int          size,
+                                                          unsigned int          required_alignment,
+                                                          unsigned int*         out_allocation_offset)
+{
+    _system_memory_manager* manager_ptr = (_system_memory_manager*) manager;
+    bool                    result      = false;
 
     /* Check if there's any memory region that can fit the requested block */
     system_list_bidirectional_item current_memory_item = system_list_bidirectional_get_head_item(manager_ptr->available_blocks);
@@ -339,89 +952,15 @@ PUBLIC EMERALD_API bool system_memory_manager_alloc_block(system_memory_manager
         current_memory_item = system_list_bidirectional_get_next_item(current_memory_item);
     } /* while (current_memory_item != NULL) */
 
-    /* All done */
-    if (manager_ptr->cs != NULL)
-    {
-        system_critical_section_leave(manager_ptr->cs);
-    }
-
     return result;
 }
 
-/** Please see header for spec */
-PUBLIC EMERALD_API system_memory_manager system_memory_manager_create(unsigned int                         memory_region_size,
-                                                                      unsigned int                         page_size,
-                                                                      PFNSYSTEMMEMORYMANAGERALLOCBLOCKPROC pfn_on_memory_block_alloced,
-                                                                      PFNSYSTEMMEMORYMANAGERFREEBLOCKPROC  pfn_on_memory_block_freed,
-                                                                      void*                                user_arg,
-                                                                      bool                                 should_be_thread_safe)
-{
-    /* Sanity checks */
-    ASSERT_DEBUG_SYNC(memory_region_size != 0,
-                      "Input memory region size is zero.");
-    ASSERT_DEBUG_SYNC(page_size != 0,
-                      "Input page size is zero");
-    ASSERT_DEBUG_SYNC(memory_region_size >= page_size,
-                      "Page size is smaller than the manageable memory region size");
-
-    /* Spawn the allocator */
-    _system_memory_manager* new_manager = new (std::nothrow) _system_memory_manager(should_be_thread_safe,
-                                                                                    memory_region_size,
-                                                                                    page_size,
-                                                                                    user_arg,
-                                                                                    pfn_on_memory_block_alloced,
-                                                                                    pfn_on_memory_block_freed);
-
-    ASSERT_ALWAYS_SYNC(new_manager != NULL,
-                       "Out of memory");
-
-    if (new_manager != NULL)
-    {
-        /* Create a descriptor for the memory region we are responsible for */
-        _system_memory_manager_block* new_block_ptr = (_system_memory_manager_block*) system_resource_pool_get_from_pool(new_manager->block_descriptor_pool);
-
-        new_block_ptr->block_offset  = 0;
-        new_block_ptr->block_size    = memory_region_size;
-        new_block_ptr->page_offset   = 0;
-        new_block_ptr->page_size     = 0; /* block does not use any committed pages */
-        new_block_ptr->result_offset = 0;
-
-        /* ..and store it */
-        system_list_bidirectional_push_at_end(new_manager->available_blocks,
-                                              new_block_ptr);
-    } /* if (new_allocator != NULL) */
-
-    /* All done */
-    return (system_memory_manager) new_manager;
-}
-
-/** Please see header for spec */
-PUBLIC EMERALD_API void system_memory_manager_free_block(system_memory_manager manager,
+/** First-fit implementation of system_memory_manager_free_block(). */
+PRIVATE void _system_memory_manager_free_block_first_fit(system_memory_manager manager,
                                                          unsigned int          alloc_offset)
 {
     _system_memory_manager* manager_ptr = (_system_memory_manager*) manager;
 
-    if (manager_ptr->cs)
-    {
-        system_critical_section_enter(manager_ptr->cs);
-    }
-
-    #ifdef LOG_ALLOC_HISTORY
-    {
-        char temp[1024];
-
-        snprintf(temp,
-                 sizeof(temp),
-                 "system_memory_manager_free_block(alloc_offset:%d)\n",
-                 alloc_offset);
-
-        system_file_serializer_write       (manager_ptr->alloc_log_serializer,
-                                            strlen(temp),
-                                            temp);
-        system_file_serializer_flush_writes(manager_ptr->alloc_log_serializer);
-    }
-    #endif /* LOG_ALLOC_HISTORY */
-
     /* We could optimize this, but, for simplicity's sake, let's do a linear search here for now. */
     system_list_bidirectional_item current_item = system_list_bidirectional_get_head_item(manager_ptr->alloced_blocks);
     bool                           has_found    = false;
@@ -597,6 +1136,164 @@ PUBLIC EMERALD_API void system_memory_manager_free_block(system_memory_manager m
         } /* if (has_found) */
     }
     #endif /* ENABLE_INTEGRITY_CHECKS_AT_FREE_CALL_TIME */
+}
+
+/** Please see header for spec */
+PUBLIC EMERALD_API bool system_memory_manager_alloc_block(system_memory_manager manager,
+                                                          unsigned int          size,
+                                                          unsigned int          required_alignment,
+                                                          unsigned int*         out_allocation_offset)
+{
+    _system_memory_manager* manager_ptr = (_system_memory_manager*) manager;
+    bool                    result      = false;
+
+    if (manager_ptr->cs != NULL)
+    {
+        system_critical_section_enter(manager_ptr->cs);
+    }
+
+    #ifdef LOG_ALLOC_HISTORY
+    {
+        char temp[1024];
+
+        snprintf(temp,
+                 sizeof(temp),
+                 "system_memory_manager_alloc_block(size:%d required_alignment:%d)\n",
+                 size,
+                 required_alignment);
+
+        system_file_serializer_write       (manager_ptr->alloc_log_serializer,
+                                            strlen(temp),
+                                            temp);
+        system_file_serializer_flush_writes(manager_ptr->alloc_log_serializer);
+    }
+    #endif /* LOG_ALLOC_HISTORY */
+
+    if (manager_ptr->policy == SYSTEM_MEMORY_MANAGER_POLICY_TLSF)
+    {
+        result = _system_memory_manager_alloc_block_tlsf(manager,
+                                                         size,
+                                                         required_alignment,
+                                                         out_allocation_offset);
+    }
+    else
+    {
+        result = _system_memory_manager_alloc_block_first_fit(manager,
+                                                              size,
+                                                              required_alignment,
+                                                              out_allocation_offset);
+    }
+
+    /* All done */
+    if (manager_ptr->cs != NULL)
+    {
+        system_critical_section_leave(manager_ptr->cs);
+    }
+
+    return result;
+}
+
+/** Please see header for spec */
+PUBLIC EMERALD_API system_memory_manager system_memory_manager_create(unsigned int                         memory_region_size,
+                                                                      unsigned int                         page_size,
+                                                                      PFNSYSTEMMEMORYMANAGERALLOCBLOCKPROC pfn_on_memory_block_alloced,
+                                                                      PFNSYSTEMMEMORYMANAGERFREEBLOCKPROC  pfn_on_memory_block_freed,
+                                                                      void*                                user_arg,
+                                                                      bool                                 should_be_thread_safe,
+                                                                      system_memory_manager_policy         policy)
+{
+    /* Sanity checks */
+    ASSERT_DEBUG_SYNC(memory_region_size != 0,
+                      "Input memory region size is zero.");
+    ASSERT_DEBUG_SYNC(page_size != 0,
+                      "Input page size is zero");
+    ASSERT_DEBUG_SYNC(memory_region_size >= page_size,
+                      "Page size is smaller than the manageable memory region size");
+
+    /* Spawn the allocator */
+    _system_memory_manager* new_manager = new (std::nothrow) _system_memory_manager(should_be_thread_safe,
+                                                                                    policy,
+                                                                                    memory_region_size,
+                                                                                    page_size,
+                                                                                    user_arg,
+                                                                                    pfn_on_memory_block_alloced,
+                                                                                    pfn_on_memory_block_freed);
+
+    ASSERT_ALWAYS_SYNC(new_manager != NULL,
+                       "Out of memory");
+
+    if (new_manager != NULL &&
+        policy      == SYSTEM_MEMORY_MANAGER_POLICY_TLSF)
+    {
+        /* Create a descriptor for the memory region we are responsible for */
+        _system_memory_manager_tlsf_block* new_block_ptr = (_system_memory_manager_tlsf_block*) system_resource_pool_get_from_pool(new_manager->block_descriptor_pool);
+
+        new_block_ptr->offset        = 0;
+        new_block_ptr->size          = memory_region_size;
+        new_block_ptr->next_physical = NULL;
+        new_block_ptr->prev_physical = NULL;
+
+        _system_memory_manager_tlsf_insert_free_block(new_manager,
+                                                      new_block_ptr);
+    }
+    else
+    if (new_manager != NULL)
+    {
+        /* Create a descriptor for the memory region we are responsible for */
+        _system_memory_manager_block* new_block_ptr = (_system_memory_manager_block*) system_resource_pool_get_from_pool(new_manager->block_descriptor_pool);
+
+        new_block_ptr->block_offset  = 0;
+        new_block_ptr->block_size    = memory_region_size;
+        new_block_ptr->page_offset   = 0;
+        new_block_ptr->page_size     = 0; /* block does not use any committed pages */
+        new_block_ptr->result_offset = 0;
+
+        /* ..and store it */
+        system_list_bidirectional_push_at_end(new_manager->available_blocks,
+                                              new_block_ptr);
+    } /* if (new_allocator != NULL) */
+
+    /* All done */
+    return (system_memory_manager) new_manager;
+}
+
+/** Please see header for spec */
+PUBLIC EMERALD_API void system_memory_manager_free_block(system_memory_manager manager,
+                                                         unsigned int          alloc_offset)
+{
+    _system_memory_manager* manager_ptr = (_system_memory_manager*) manager;
+
+    if (manager_ptr->cs)
+    {
+        system_critical_section_enter(manager_ptr->cs);
+    }
+
+    #ifdef LOG_ALLOC_HISTORY
+    {
+        char temp[1024];
+
+        snprintf(temp,
+                 sizeof(temp),
+                 "system_memory_manager_free_block(alloc_offset:%d)\n",
+                 alloc_offset);
+
+        system_file_serializer_write       (manager_ptr->alloc_log_serializer,
+                                            strlen(temp),
+                                            temp);
+        system_file_serializer_flush_writes(manager_ptr->alloc_log_serializer);
+    }
+    #endif /* LOG_ALLOC_HISTORY */
+
+    if (manager_ptr->policy == SYSTEM_MEMORY_MANAGER_POLICY_TLSF)
+    {
+        _system_memory_manager_free_block_tlsf(manager,
+                                               alloc_offset);
+    }
+    else
+    {
+        _system_memory_manager_free_block_first_fit(manager,
+                                                    alloc_offset);
+    }
 
     if (manager_ptr->cs)
     {
@@ -604,6 +1301,72 @@ PUBLIC EMERALD_API void system_memory_manager_free_block(system_memory_manager m
     }
 }
 
+/** Please see header for spec */
+PUBLIC EMERALD_API void system_memory_manager_get_fragmentation_report(system_memory_manager                       manager,
+                                                                       system_memory_manager_fragmentation_report* out_report_ptr)
+{
+    _system_memory_manager* manager_ptr = (_system_memory_manager*) manager;
+
+    memset(out_report_ptr,
+           0,
+           sizeof(*out_report_ptr) );
+
+    if (manager_ptr->cs != NULL)
+    {
+        system_critical_section_enter(manager_ptr->cs);
+    }
+
+    if (manager_ptr->policy == SYSTEM_MEMORY_MANAGER_POLICY_TLSF)
+    {
+        uint32_t fl_bitmap = manager_ptr->tlsf_fl_bitmap;
+
+        while (fl_bitmap != 0)
+        {
+            const unsigned int fl_index  = _system_memory_manager_get_lowest_bit_index(fl_bitmap);
+                  uint32_t     sl_bitmap = manager_ptr->tlsf_sl_bitmaps[fl_index];
+
+            while (sl_bitmap != 0)
+            {
+                const unsigned int sl_index = _system_memory_manager_get_lowest_bit_index(sl_bitmap);
+
+                for (const _system_memory_manager_tlsf_block* block_ptr  = manager_ptr->tlsf_free_blocks[fl_index][sl_index];
+                                                              block_ptr != NULL;
+                                                              block_ptr  = block_ptr->next_free)
+                {
+                    _system_memory_manager_add_free_block_to_fragmentation_report(block_ptr->size,
+                                                                                  out_report_ptr);
+                }
+
+                sl_bitmap &= ~(1u << sl_index);
+            }
+
+            fl_bitmap &= ~(1u << fl_index);
+        }
+    }
+    else
+    {
+        system_list_bidirectional_item current_item = system_list_bidirectional_get_head_item(manager_ptr->available_blocks);
+
+        while (current_item != NULL)
+        {
+            _system_memory_manager_block* current_block_ptr = NULL;
+
+            system_list_bidirectional_get_item_data(current_item,
+                                                   (void**) &current_block_ptr);
+
+            _system_memory_manager_add_free_block_to_fragmentation_report(current_block_ptr->block_size,
+                                                                          out_report_ptr);
+
+            current_item = system_list_bidirectional_get_next_item(current_item);
+        }
+    }
+
+    if (manager_ptr->cs != NULL)
+    {
+        system_critical_section_leave(manager_ptr->cs);
+    }
+}
+
 /** Please see header for spec */
 PUBLIC EMERALD_API void system_memory_manager_release(system_memory_manager manager)
 {
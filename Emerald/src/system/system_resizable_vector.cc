@@ -6,9 +6,20 @@
 #include "shared.h"
 #include <stdlib.h>
 #include "system/system_assertions.h"
+#include "system/system_constants.h"
 #include "system/system_log.h"
 #include "system/system_read_write_mutex.h"
 #include "system/system_resizable_vector.h"
+#include "system/system_thread_pool.h"
+
+/* Ranges shorter than this are sorted with insertion sort */
+#define RESIZABLE_VECTOR_INSERTION_SORT_THRESHOLD (24)
+
+/* Ranges longer than this use a pseudo-median of 9 elements as the pivot, instead of a median of 3 */
+#define RESIZABLE_VECTOR_NINTHER_THRESHOLD (128)
+
+/* Number of element moves, after which an attempt to finish off a nearly sorted range with insertion sort is abandoned */
+#define RESIZABLE_VECTOR_PARTIAL_INSERTION_SORT_LIMIT (8)
 
 /** TODO */
 struct _system_resizable_vector
@@ -604,114 +615,617 @@ PUBLIC EMERALD_API void system_resizable_vector_set_element_at(system_resizable_
     }
 }
 
-/** TODO 
+/** Comparator function type used by system_resizable_vector_sort(). Returns true if the first element
+ *  should be placed before the second one. */
+typedef bool (*PFNSORTCOMPARATORPROC)(const void*, const void*);
+
+/** Argument passed to parallel sort call-backs */
+typedef struct
+{
+    PFNSORTCOMPARATORPROC comparator_func_ptr;
+    void**                dst_elements;
+    uint32_t              n_elements;
+    uint32_t              n_segments_per_merge;
+    uint32_t              run_size;
+    void**                src_elements;
+} _system_resizable_vector_parallel_sort_arg;
+
+
+/** TODO */
+PRIVATE inline void _system_resizable_vector_sort_swap(void** element1_ptr,
+                                                       void** element2_ptr)
+{
+    void* temp = *element1_ptr;
+
+    *element1_ptr = *element2_ptr;
+    *element2_ptr = temp;
+}
+
+/** Sorts three elements in place. */
+PRIVATE inline void _system_resizable_vector_sort_3(void**                element1_ptr,
+                                                    void**                element2_ptr,
+                                                    void**                element3_ptr,
+                                                    PFNSORTCOMPARATORPROC comparator_func_ptr)
+{
+    if (comparator_func_ptr(*element2_ptr, *element1_ptr) )
+    {
+        _system_resizable_vector_sort_swap(element1_ptr,
+                                           element2_ptr);
+    }
+
+    if (comparator_func_ptr(*element3_ptr, *element2_ptr) )
+    {
+        _system_resizable_vector_sort_swap(element2_ptr,
+                                           element3_ptr);
+
+        if (comparator_func_ptr(*element2_ptr, *element1_ptr) )
+        {
+            _system_resizable_vector_sort_swap(element1_ptr,
+                                               element2_ptr);
+        }
+    }
+}
+
+/** TODO */
+PRIVATE void _system_resizable_vector_sort_heap_sift_down(void**                elements,
+                                                          size_t                n_root,
+                                                          size_t                n_elements,
+                                                          PFNSORTCOMPARATORPROC comparator_func_ptr)
+{
+    void* root_element = elements[n_root];
+
+    while (true)
+    {
+        size_t n_child = n_root * 2 + 1;
+
+        if (n_child >= n_elements)
+        {
+            break;
+        }
+
+        if (n_child + 1 < n_elements                                       &&
+            comparator_func_ptr(elements[n_child], elements[n_child + 1]) )
+        {
+            ++n_child;
+        }
+
+        if (!comparator_func_ptr(root_element, elements[n_child]) )
+        {
+            break;
+        }
+
+        elements[n_root] = elements[n_child];
+        n_root           = n_child;
+    }
+
+    elements[n_root] = root_element;
+}
+
+/** Fall-back used when the quicksort keeps picking bad pivots. Guarantees O(n log n). */
+PRIVATE void _system_resizable_vector_sort_heapsort(void**                begin,
+                                                    void**                end,
+                                                    PFNSORTCOMPARATORPROC comparator_func_ptr)
+{
+    const size_t n_elements = end - begin;
+
+    for (size_t n_element = n_elements / 2;
+                n_element > 0;
+              --n_element)
+    {
+        _system_resizable_vector_sort_heap_sift_down(begin,
+                                                     n_element - 1,
+                                                     n_elements,
+                                                     comparator_func_ptr);
+    }
+
+    for (size_t n_heap_elements = n_elements;
+                n_heap_elements > 1;
+              --n_heap_elements)
+    {
+        _system_resizable_vector_sort_swap(begin,
+                                           begin + n_heap_elements - 1);
+
+        _system_resizable_vector_sort_heap_sift_down(begin,
+                                                     0, /* n_root */
+                                                     n_heap_elements - 1,
+                                                     comparator_func_ptr);
+    }
+}
+
+/** Sorts <begin, end) with insertion sort. If @param max_n_moves is not 0, gives up as soon as more
+ *  than max_n_moves element moves have been made.
  *
- *  comparator_func_ptr() = operator<
+ *  @return true if the range has been sorted, false if the function gave up.
  */
-PRIVATE void _system_resizable_vector_sort_recursive(system_resizable_vector resizable_vector,
-                                                     bool                  (*comparator_func_ptr)(const void*, const void*),
-                                                     int                     start_index,
-                                                     int                     end_index)
+PRIVATE bool _system_resizable_vector_sort_insertion_sort(void**                begin,
+                                                          void**                end,
+                                                          PFNSORTCOMPARATORPROC comparator_func_ptr,
+                                                          size_t                max_n_moves)
 {
-    /* Based on http://www.mycstutorials.com/articles/sorting/quicksort */
-    int   left   = start_index; // i
-    void* pivot  = NULL;
-    bool  result = false;
-    int   right  = end_index;   // j
-    void* value  = NULL;
+    size_t n_moves = 0;
 
-    if (end_index - start_index >= 1)
+    if (begin == end)
     {
-        result = system_resizable_vector_get_element_at(resizable_vector,
-                                                        start_index,
-                                                       &pivot);
+        return true;
+    }
 
-        ASSERT_DEBUG_SYNC(result,
-                          "Could not retrieve reference element [%d] from the vector",
-                          start_index);
+    for (void** current_ptr  = begin + 1;
+                current_ptr != end;
+              ++current_ptr)
+    {
+        void** sift_ptr = current_ptr;
+        void*  element  = *current_ptr;
 
-        while (right > left)
+        while (sift_ptr != begin                                 &&
+               comparator_func_ptr(element, *(sift_ptr - 1) ) )
         {
-            while (true)
+            *sift_ptr = *(sift_ptr - 1);
+            --sift_ptr;
+        }
+
+        *sift_ptr = element;
+        n_moves  += current_ptr - sift_ptr;
+
+        if (max_n_moves != 0          &&
+            n_moves     >  max_n_moves)
+        {
+            return false;
+        }
+    }
+
+    return true;
+}
+
+/** Moves elements which are not ordered after the pivot (stored at @param begin) to the left side of the range.
+ *
+ *  @param out_already_partitioned_ptr Deref will be set to true if no elements had to be swapped.
+ *
+ *  @return Final position of the pivot.
+ */
+PRIVATE void** _system_resizable_vector_sort_partition_right(void**                begin,
+                                                             void**                end,
+                                                             PFNSORTCOMPARATORPROC comparator_func_ptr,
+                                                             bool*                 out_already_partitioned_ptr)
+{
+    /* NOTE: Some of the callers pass non-strict comparators (<=), so all loops need to be bounded */
+    void*  pivot     = *begin;
+    void** first_ptr = begin + 1;
+    void** last_ptr  = end   - 1;
+
+    while (first_ptr <= last_ptr && comparator_func_ptr(*first_ptr, pivot) )
+    {
+        ++first_ptr;
+    }
+
+    while (first_ptr <= last_ptr && !comparator_func_ptr(*last_ptr, pivot) )
+    {
+        --last_ptr;
+    }
+
+    *out_already_partitioned_ptr = (first_ptr > last_ptr);
+
+    while (first_ptr < last_ptr)
+    {
+        _system_resizable_vector_sort_swap(first_ptr,
+                                           last_ptr);
+
+        ++first_ptr;
+        --last_ptr;
+
+        while (first_ptr <= last_ptr && comparator_func_ptr(*first_ptr, pivot) )
+        {
+            ++first_ptr;
+        }
+
+        while (first_ptr <= last_ptr && !comparator_func_ptr(*last_ptr, pivot) )
+        {
+            --last_ptr;
+        }
+    }
+
+    *begin    = *last_ptr;
+    *last_ptr = pivot;
+
+    return last_ptr;
+}
+
+/** Moves elements which are ordered after the pivot (stored at @param begin) to the right side of the range.
+ *  Used for ranges which are known to hold many elements equal to the pivot, which all end up on the left
+ *  side and do not need to be sorted any further.
+ *
+ *  @return Final position of the pivot.
+ */
+PRIVATE void** _system_resizable_vector_sort_partition_left(void**                begin,
+                                                            void**                end,
+                                                            PFNSORTCOMPARATORPROC comparator_func_ptr)
+{
+    void*  pivot     = *begin;
+    void** first_ptr = begin + 1;
+    void** last_ptr  = end   - 1;
+
+    while (first_ptr <= last_ptr && comparator_func_ptr(pivot, *last_ptr) )
+    {
+        --last_ptr;
+    }
+
+    while (first_ptr <= last_ptr && !comparator_func_ptr(pivot, *first_ptr) )
+    {
+        ++first_ptr;
+    }
+
+    while (first_ptr < last_ptr)
+    {
+        _system_resizable_vector_sort_swap(first_ptr,
+                                           last_ptr);
+
+        ++first_ptr;
+        --last_ptr;
+
+        while (first_ptr <= last_ptr && comparator_func_ptr(pivot, *last_ptr) )
+        {
+            --last_ptr;
+        }
+
+        while (first_ptr <= last_ptr && !comparator_func_ptr(pivot, *first_ptr) )
+        {
+            ++first_ptr;
+        }
+    }
+
+    *begin    = *last_ptr;
+    *last_ptr = pivot;
+
+    return last_ptr;
+}
+
+/** Pattern-defeating introsort.
+ *
+ *  Pivots are picked with median-of-3 (or a pseudo-median of 9 for larger ranges). Ranges which turn out
+ *  to be partitioned already are finished off with a bounded insertion sort, so sorted and reverse-sorted
+ *  input takes linear time. Ranges holding many copies of the same element are handled by partitioning
+ *  equal elements out of the way. Each highly unbalanced partition shuffles a few elements around to break
+ *  up adversarial patterns. After too many of these, the range is heap-sorted, which bounds the
+ *  worst case to O(n log n).
+ *
+ *  @param begin                    First element of the range to sort.
+ *  @param end                      Element following the last element of the range to sort.
+ *  @param comparator_func_ptr      Comparator to use.
+ *  @param n_bad_partitions_allowed Number of highly unbalanced partitions allowed before falling back to heapsort.
+ *  @param is_leftmost              true if @param begin is the first element of the vector. Otherwise, the element
+ *                                  preceding @param begin is known not to be ordered after any element of the range.
+ */
+PRIVATE void _system_resizable_vector_sort_introsort(void**                begin,
+                                                     void**                end,
+                                                     PFNSORTCOMPARATORPROC comparator_func_ptr,
+                                                     unsigned int          n_bad_partitions_allowed,
+                                                     bool                  is_leftmost)
+{
+    while (true)
+    {
+        const size_t n_elements = end - begin;
+
+        if (n_elements < RESIZABLE_VECTOR_INSERTION_SORT_THRESHOLD)
+        {
+            _system_resizable_vector_sort_insertion_sort(begin,
+                                                         end,
+                                                         comparator_func_ptr,
+                                                         0); /* max_n_moves */
+
+            break;
+        }
+
+        /* Pick the pivot and move it to the beginning of the range */
+        const size_t n_half = n_elements / 2;
+
+        if (n_elements > RESIZABLE_VECTOR_NINTHER_THRESHOLD)
+        {
+            _system_resizable_vector_sort_3(begin,              begin + n_half,     end - 1, comparator_func_ptr);
+            _system_resizable_vector_sort_3(begin + 1,          begin + n_half - 1, end - 2, comparator_func_ptr);
+            _system_resizable_vector_sort_3(begin + 2,          begin + n_half + 1, end - 3, comparator_func_ptr);
+            _system_resizable_vector_sort_3(begin + n_half - 1, begin + n_half,     begin + n_half + 1, comparator_func_ptr);
+
+            _system_resizable_vector_sort_swap(begin,
+                                               begin + n_half);
+        }
+        else
+        {
+            _system_resizable_vector_sort_3(begin + n_half,
+                                            begin,
+                                            end - 1,
+                                            comparator_func_ptr);
+        }
+
+        /* If the pivot is equal to the element preceding the range, the range holds many equal elements.
+         * Put all of them on the left side, and only continue with the right side. */
+        if (!is_leftmost                                       &&
+            !comparator_func_ptr(*(begin - 1), *begin) )
+        {
+            begin = _system_resizable_vector_sort_partition_left(begin,
+                                                                 end,
+                                                                 comparator_func_ptr) + 1;
+
+            continue;
+        }
+
+        bool         is_already_partitioned = false;
+        void**       pivot_ptr              = _system_resizable_vector_sort_partition_right(begin,
+                                                                                            end,
+                                                                                            comparator_func_ptr,
+                                                                                           &is_already_partitioned);
+        const size_t n_left_elements        = pivot_ptr - begin;
+        const size_t n_right_elements       = end       - (pivot_ptr + 1);
+
+        if (n_left_elements  < n_elements / 8 ||
+            n_right_elements < n_elements / 8)
+        {
+            if (--n_bad_partitions_allowed == 0)
             {
-                if (left > end_index)
-                {
-                    break;
-                }
-
-                result = system_resizable_vector_get_element_at(resizable_vector,
-                                                                left,
-                                                               &value);
-
-                ASSERT_DEBUG_SYNC(result,
-                                 "system_resizable_vector_get_element_at() failed.");
-
-                if (comparator_func_ptr(value, pivot) && right > left)
-                {
-                    ++left;
-                }
-                else
-                {
-                    break;
-                }
-            } /* while (true) */
-
-            while (true)
+                _system_resizable_vector_sort_heapsort(begin,
+                                                       end,
+                                                       comparator_func_ptr);
+
+                break;
+            }
+
+            /* Shuffle a few elements around to break up the pattern which led to the bad partition */
+            if (n_left_elements >= RESIZABLE_VECTOR_INSERTION_SORT_THRESHOLD)
             {
-                if (right < start_index)
-                {
-                    break;
-                }
-
-                result = system_resizable_vector_get_element_at(resizable_vector,
-                                                                right,
-                                                               &value);
-
-                ASSERT_DEBUG_SYNC(result,
-                                  "system_resizable_vector_get_element_at() failed.");
-
-                if (!comparator_func_ptr(value, pivot) && right >= left)
-                {
-                    --right;
-                }
-                else
-                {
-                    break;
-                }
-            } /* while (true) */
-
-            if (right > left)
+                _system_resizable_vector_sort_swap(begin,         begin     + n_left_elements / 4);
+                _system_resizable_vector_sort_swap(pivot_ptr - 1, pivot_ptr - n_left_elements / 4);
+            }
+
+            if (n_right_elements >= RESIZABLE_VECTOR_INSERTION_SORT_THRESHOLD)
             {
-                system_resizable_vector_swap(resizable_vector,
-                                             left,
-                                             right);
+                _system_resizable_vector_sort_swap(pivot_ptr + 1, pivot_ptr + 1 + n_right_elements / 4);
+                _system_resizable_vector_sort_swap(end       - 1, end           - n_right_elements / 4);
             }
-        } /* while (right > left) */
+        }
+        else
+        if (is_already_partitioned)
+        {
+            /* The input might be (nearly) sorted. Try to finish it off cheaply */
+            if (_system_resizable_vector_sort_insertion_sort(begin,
+                                                             pivot_ptr,
+                                                             comparator_func_ptr,
+                                                             RESIZABLE_VECTOR_PARTIAL_INSERTION_SORT_LIMIT) &&
+                _system_resizable_vector_sort_insertion_sort(pivot_ptr + 1,
+                                                             end,
+                                                             comparator_func_ptr,
+                                                             RESIZABLE_VECTOR_PARTIAL_INSERTION_SORT_LIMIT) )
+            {
+                break;
+            }
+        }
+
+        /* Recurse into the left side & iterate over the right side */
+        _system_resizable_vector_sort_introsort(begin,
+                                                pivot_ptr,
+                                                comparator_func_ptr,
+                                                n_bad_partitions_allowed,
+                                                is_leftmost);
+
+        begin       = pivot_ptr + 1;
+        is_leftmost = false;
+    }
+}
+
+/** Sorts <begin, end) on the calling thread. */
+PRIVATE void _system_resizable_vector_sort_sequential(void**                begin,
+                                                      void**                end,
+                                                      PFNSORTCOMPARATORPROC comparator_func_ptr)
+{
+    unsigned int n_bad_partitions_allowed = 1;
+
+    for (size_t n_elements  = end - begin;
+                n_elements  > 1;
+                n_elements /= 2)
+    {
+        ++n_bad_partitions_allowed;
+    }
+
+    _system_resizable_vector_sort_introsort(begin,
+                                            end,
+                                            comparator_func_ptr,
+                                            n_bad_partitions_allowed,
+                                            true); /* is_leftmost */
+}
+
+/** Returns the number of elements, which the first @param n_output_elements elements of a merge of
+ *  @param a_elements and @param b_elements take from @param a_elements. */
+PRIVATE uint32_t _system_resizable_vector_sort_get_merge_split(void**                a_elements,
+                                                               uint32_t              n_a_elements,
+                                                               void**                b_elements,
+                                                               uint32_t              n_b_elements,
+                                                               uint32_t              n_output_elements,
+                                                               PFNSORTCOMPARATORPROC comparator_func_ptr)
+{
+    uint32_t n_first = (n_output_elements > n_b_elements) ? (n_output_elements - n_b_elements) : 0;
+    uint32_t n_last  = (n_output_elements < n_a_elements) ? n_output_elements                  : n_a_elements;
+
+    while (n_first < n_last)
+    {
+        const uint32_t n_a = n_first + (n_last - n_first) / 2;
+        const uint32_t n_b = n_output_elements - n_a;
+
+        /* Elements of A which are not ordered after the preceding element of B go first */
+        if (!comparator_func_ptr(b_elements[n_b - 1], a_elements[n_a]) )
+        {
+            n_first = n_a + 1;
+        }
+        else
+        {
+            n_last = n_a;
+        }
+    }
+
+    return n_first;
+}
+
+/** Parallel sort call-back. Sorts a single run of the vector. */
+PRIVATE void _system_resizable_vector_sort_runs(uint32_t range_start,
+                                                uint32_t range_end,
+                                                void*    user_arg)
+{
+    _system_resizable_vector_parallel_sort_arg* arg_ptr = (_system_resizable_vector_parallel_sort_arg*) user_arg;
 
-        if (right >= 0)
+    for (uint32_t n_run = range_start;
+                  n_run < range_end;
+                ++n_run)
+    {
+        const uint32_t run_start = n_run * arg_ptr->run_size;
+        const uint32_t run_end   = (run_start + arg_ptr->run_size < arg_ptr->n_elements) ? (run_start + arg_ptr->run_size)
+                                                                                         : arg_ptr->n_elements;
+
+        if (run_start < run_end)
         {
-            system_resizable_vector_swap(resizable_vector,
-                                         start_index,
-                                         right);
-
-            _system_resizable_vector_sort_recursive(resizable_vector,
-                                                    comparator_func_ptr,
-                                                    start_index,
-                                                    right - 1);
-            _system_resizable_vector_sort_recursive(resizable_vector,
-                                                    comparator_func_ptr,
-                                                    right + 1,
-                                                    end_index);
+            _system_resizable_vector_sort_sequential(arg_ptr->src_elements + run_start,
+                                                     arg_ptr->src_elements + run_end,
+                                                     arg_ptr->comparator_func_ptr);
         }
-    } /* if (end_index - start_index >= 1) */
+    }
+}
+
+/** Parallel sort call-back. Merges a single segment of a pair of adjacent runs. Each pair of runs is split
+ *  into n_segments_per_merge segments of equal output size, so that all workers stay busy, even when
+ *  there are fewer pairs of runs left to merge than there are workers.
+ */
+PRIVATE void _system_resizable_vector_sort_merge_runs(uint32_t range_start,
+                                                      uint32_t range_end,
+                                                      void*    user_arg)
+{
+    _system_resizable_vector_parallel_sort_arg* arg_ptr = (_system_resizable_vector_parallel_sort_arg*) user_arg;
+
+    for (uint32_t n_task = range_start;
+                  n_task < range_end;
+                ++n_task)
+    {
+        const uint32_t n_merge   = n_task / arg_ptr->n_segments_per_merge;
+        const uint32_t n_segment = n_task % arg_ptr->n_segments_per_merge;
+        const uint32_t a_start   = n_merge * arg_ptr->run_size * 2;
+
+        if (a_start >= arg_ptr->n_elements)
+        {
+            continue;
+        }
+
+        const uint32_t a_end            = (arg_ptr->n_elements - a_start > arg_ptr->run_size) ? (a_start + arg_ptr->run_size) : arg_ptr->n_elements;
+        const uint32_t b_end            = (arg_ptr->n_elements - a_end   > arg_ptr->run_size) ? (a_end   + arg_ptr->run_size) : arg_ptr->n_elements;
+        void**         a_elements       = arg_ptr->src_elements + a_start;
+        void**         b_elements       = arg_ptr->src_elements + a_end;
+        const uint32_t n_a_elements     = a_end - a_start;
+        const uint32_t n_b_elements     = b_end - a_end;
+        const uint32_t n_total_elements = n_a_elements + n_b_elements;
+        const uint32_t output_start     = (uint32_t) ( (__uint64) n_total_elements *  n_segment      / arg_ptr->n_segments_per_merge);
+        const uint32_t output_end       = (uint32_t) ( (__uint64) n_total_elements * (n_segment + 1) / arg_ptr->n_segments_per_merge);
+        uint32_t       n_a              = _system_resizable_vector_sort_get_merge_split(a_elements,
+                                                                                        n_a_elements,
+                                                                                        b_elements,
+                                                                                        n_b_elements,
+                                                                                        output_start,
+                                                                                        arg_ptr->comparator_func_ptr);
+        uint32_t       n_b              = output_start - n_a;
+        void**         dst_ptr          = arg_ptr->dst_elements + a_start + output_start;
+
+        for (uint32_t n_output_element = output_start;
+                      n_output_element < output_end;
+                    ++n_output_element)
+        {
+            if ( n_b >= n_b_elements                                                               ||
+                (n_a <  n_a_elements && !arg_ptr->comparator_func_ptr(b_elements[n_b], a_elements[n_a]) ))
+            {
+                *dst_ptr++ = a_elements[n_a++];
+            }
+            else
+            {
+                *dst_ptr++ = b_elements[n_b++];
+            }
+        }
+    }
+}
+
+/** Sorts @param elements using all thread pool workers. The array is split into runs, which are sorted
+ *  in parallel and then merged pair-wise, ping-ponging between the array and a temporary buffer.
+ *
+ *  @return true if successful, false if the temporary buffer could not be allocated.
+ */
+PRIVATE bool _system_resizable_vector_sort_parallel(void**                elements,
+                                                    uint32_t              n_elements,
+                                                    PFNSORTCOMPARATORPROC comparator_func_ptr)
+{
+    _system_resizable_vector_parallel_sort_arg arg;
+    uint32_t                                   n_runs      = 1;
+    uint32_t                                   n_workers   = 0;
+    void**                                     temp_buffer = new (std::nothrow) void*[n_elements];
+
+    if (temp_buffer == NULL)
+    {
+        return false;
+    }
+
+    system_thread_pool_get_property(SYSTEM_THREAD_POOL_PROPERTY_N_WORKERS,
+                                   &n_workers);
+
+    /* Use a power-of-two number of runs, so that the merge passes pair all of them up. Give each worker
+     * (and the calling thread) a couple of runs to balance the load. */
+    while (n_runs < (n_workers + 1) * 2)
+    {
+        n_runs *= 2;
+    }
+
+    arg.comparator_func_ptr  = comparator_func_ptr;
+    arg.dst_elements         = temp_buffer;
+    arg.n_elements           = n_elements;
+    arg.n_segments_per_merge = 0;
+    arg.run_size             = (n_elements + n_runs - 1) / n_runs;
+    arg.src_elements         = elements;
+
+    system_thread_pool_parallel_for(0, /* range_start */
+                                    n_runs,
+                                    1, /* grain_size */
+                                    _system_resizable_vector_sort_runs,
+                                   &arg);
+
+    /* Keep the number of merge tasks constant across passes, by splitting each pair of runs into more
+     * segments as the number of pairs drops. */
+    const uint32_t n_tasks = n_runs;
+
+    while (arg.run_size < n_elements)
+    {
+        const uint32_t n_merges = (n_runs + 1) / 2;
+
+        arg.n_segments_per_merge = (n_tasks > n_merges) ? (n_tasks / n_merges) : 1;
+
+        system_thread_pool_parallel_for(0, /* range_start */
+                                        n_merges * arg.n_segments_per_merge,
+                                        1, /* grain_size */
+                                        _system_resizable_vector_sort_merge_runs,
+                                       &arg);
+
+        void** temp_ptr = arg.src_elements;
+
+        arg.src_elements = arg.dst_elements;
+        arg.dst_elements = temp_ptr;
+        arg.run_size    *= 2;
+        n_runs           = (n_runs + 1) / 2;
+    }
+
+    if (arg.src_elements != elements)
+    {
+        memcpy(elements,
+               arg.src_elements,
+               n_elements * sizeof(void*) );
+    }
+
+    delete [] temp_buffer;
+
+    return true;
 }
 
 /** Please see header for specification */
 PUBLIC EMERALD_API void system_resizable_vector_sort(system_resizable_vector resizable_vector,
                                                      bool                  (*comparator_func_ptr)(const void*, const void*) )
 {
-    uint32_t                  n_vector_items = 0;
-    _system_resizable_vector* vector_ptr     = (_system_resizable_vector*) resizable_vector;
+    _system_resizable_vector* vector_ptr = (_system_resizable_vector*) resizable_vector;
 
     if (vector_ptr->access_mutex != NULL)
     {
@@ -719,14 +1233,28 @@ PUBLIC EMERALD_API void system_resizable_vector_sort(system_resizable_vector res
                                      ACCESS_WRITE);
     }
 
-    system_resizable_vector_get_property(resizable_vector,
-                                         SYSTEM_RESIZABLE_VECTOR_PROPERTY_N_ELEMENTS,
-                                        &n_vector_items);
+    ASSERT_DEBUG_SYNC(vector_ptr->element_size == sizeof(void*),
+                      "Sort implementation assumes pointer-sized elements");
 
-    _system_resizable_vector_sort_recursive(resizable_vector,
-                                            comparator_func_ptr,
-                                            0,
-                                            n_vector_items - 1);
+    if (vector_ptr->n_elements > 1)
+    {
+        void** elements  = (void**) vector_ptr->elements;
+        bool   is_sorted = false;
+
+        if (vector_ptr->n_elements >= RESIZABLE_VECTOR_PARALLEL_SORT_THRESHOLD)
+        {
+            is_sorted = _system_resizable_vector_sort_parallel(elements,
+                                                               (uint32_t) vector_ptr->n_elements,
+                                                               comparator_func_ptr);
+        }
+
+        if (!is_sorted)
+        {
+            _system_resizable_vector_sort_sequential(elements,
+                                                     elements + vector_ptr->n_elements,
+                                                     comparator_func_ptr);
+        }
+    }
 
     if (vector_ptr->access_mutex != NULL)
     {
@@ -5,34 +5,365 @@
  */
 #include "shared.h"
 #include "system/system_assertions.h"
+#include "system/system_atomics.h"
+#include "system/system_constants.h"
 #include "system/system_critical_section.h"
 #include "system/system_linear_alloc_pin.h"
-#include "system/system_resizable_vector.h"
 #include "system/system_resource_pool.h"
+#include <string.h>
+
+#ifdef _WIN32
+    #include <intrin.h>
+#endif
+
+/* Number of nodes in the first node chunk is (1 << FIRST_NODE_CHUNK_SIZE_LOG2). Each subsequent chunk
+ * is twice as large as the previous one. */
+#define FIRST_NODE_CHUNK_SIZE_LOG2 (6)
+
+/* Maximum number of node chunks. Enough to address all 32-bit node indices. */
+#define MAX_NODE_CHUNKS            (32 - FIRST_NODE_CHUNK_SIZE_LOG2)
+
+
+/** Batch of blocks stored in one of the global node lists. Nodes are never released before the pool
+ *  itself is, so a node can safely be read by a thread which then loses a race for it. */
+typedef struct
+{
+    system_resource_pool_block blocks[RESOURCE_POOL_BATCH_SIZE];
+    unsigned int               index;
+    unsigned int               n_blocks;
+
+    /** Index of the next node in the list, plus one. 0 terminates the list. */
+    volatile unsigned int      next_node_index_plus_one;
+} _system_resource_pool_node;
+
+/** Per-thread cache of blocks. Only accessed by the owning thread, so needs no synchronization. */
+typedef struct
+{
+    system_resource_pool_block blocks[RESOURCE_POOL_MAGAZINE_CAPACITY];
+    unsigned int               n_blocks;
+
+    /* Statistics. Other threads only read these when the pool's properties are queried. */
+    __uint64                   n_hits;
+    __uint64                   n_refills;
+} _system_resource_pool_magazine;
 
 /** Internal type definitions */
 typedef struct
 {
-    /* Allocator is used to obtain variants in a cache-line friendly manner.
-     *  If a variant is released by caller, it is transferred to released_variants_pool to be
-     *  provided for next create() call. Hence, we do not use pins.
+    /* Allocator is used to obtain blocks in a cache-line friendly manner.
+     *  If a block is released by caller, it is cached by the pool to be provided for one
+     *  of the subsequent get_from_pool() calls. Hence, we do not use pins.
      */
     system_linear_alloc_pin allocator;
-    /* Critical section is used to make the implementation multithread-safe */
+    /* Critical section protects the allocator, node storage and the shared magazine */
     system_critical_section cs;
     /* Please see system_resource_pool_create() documentation for details. */
     PFNSYSTEMRESOURCEPOOLDEINITBLOCK deinit_block_fn;
     /* Please see system_resource_pool_create() documentation for details. */
     PFNSYSTEMRESOURCEPOOLINITBLOCK init_block_fn;
 
-    /* Released variants pool is sued to store already allocated blocks that have been released
-     *  by the caller. They will be returned to the caller the next create() call. Only if the pool
-     *  runs out of elements, should we obtain new blocks from the pool
+    /* Released blocks are first cached in the releasing thread's magazine. Once a magazine fills up,
+     * a batch of blocks is moved to the full node list, where any thread can pick it up when its
+     * magazine runs dry. Only if both are empty, should we obtain new blocks from the allocator.
+     *
+     * Both node lists are Treiber stacks. The lower 32 bits of each head hold index of the first node plus
+     * one, the upper 32 bits hold a tag which is bumped at every update to avoid the ABA problem.
      */
-    system_resizable_vector released_blocks;
+    volatile __uint64 empty_nodes_head;
+    volatile __uint64 full_nodes_head;
+
+    _system_resource_pool_node* node_chunks[MAX_NODE_CHUNKS];
+    unsigned int                n_nodes_allocated;
+
+    /* Magazines of the threads which have been assigned a thread slot. Allocated on first use. */
+    _system_resource_pool_magazine* magazines[RESOURCE_POOL_MAX_THREAD_SLOTS];
+
+    /* Magazine used by all threads which have not been assigned a thread slot. Protected by cs. */
+    _system_resource_pool_magazine shared_magazine;
+
+    unsigned int n_blocks_allocated;
 } _system_resource_pool_internals;
 
 
+/** Internal variables */
+
+/* Non-zero for each thread slot that is currently owned by a thread */
+volatile unsigned int _system_resource_pool_is_thread_slot_used[RESOURCE_POOL_MAX_THREAD_SLOTS] = {0};
+
+/* Index of the magazine slot assigned to the current thread, or -1 if none has been assigned yet.
+ * RESOURCE_POOL_MAX_THREAD_SLOTS is used for threads, for which no slot was available. */
+#ifdef _WIN32
+    __declspec(thread) int _system_resource_pool_thread_slot = -1;
+#else
+    __thread int _system_resource_pool_thread_slot = -1;
+#endif
+
+
+/** Returns index of the node chunk, which holds the node at user-specified index.
+ *
+ *  Chunk n holds (1 << (n + FIRST_NODE_CHUNK_SIZE_LOG2)) nodes, so the chunk index is the position of
+ *  the highest bit set in (node_index >> FIRST_NODE_CHUNK_SIZE_LOG2) + 1.
+ */
+PRIVATE inline unsigned int _system_resource_pool_get_node_chunk_index(unsigned int node_index)
+{
+    const unsigned int chunk_key = (node_index >> FIRST_NODE_CHUNK_SIZE_LOG2) + 1;
+
+#ifdef _WIN32
+    unsigned long highest_bit_index = 0;
+
+    _BitScanReverse(&highest_bit_index,
+                    chunk_key);
+
+    return (unsigned int) highest_bit_index;
+#else
+    return 31 - __builtin_clz(chunk_key);
+#endif
+}
+
+/** Converts a node index to the node's address.
+ *
+ *  @param pool_ptr   Resource pool to use.
+ *  @param node_index Index of the node. Must have been allocated.
+ *
+ *  @return As per description.
+ */
+PRIVATE inline _system_resource_pool_node* _system_resource_pool_get_node(_system_resource_pool_internals* pool_ptr,
+                                                                          unsigned int                     node_index)
+{
+    const unsigned int chunk_index = _system_resource_pool_get_node_chunk_index(node_index);
+
+    return pool_ptr->node_chunks[chunk_index] + (node_index - ( ((1 << chunk_index) - 1) << FIRST_NODE_CHUNK_SIZE_LOG2) );
+}
+
+/** Returns magazine slot index assigned to the calling thread. Assigns one, if this is the first time
+ *  the thread uses any resource pool.
+ *
+ *  Slots are returned by threads spawned with system_threads_spawn() when they quit. A thread which
+ *  takes over a slot also takes over the blocks cached in the slot's magazines, which is fine,
+ *  since magazines can only be accessed by one thread at a time.
+ *
+ *  @return Slot index or RESOURCE_POOL_MAX_THREAD_SLOTS if the calling thread should use the
+ *          shared magazine.
+ */
+PRIVATE inline int _system_resource_pool_get_thread_slot()
+{
+    if (_system_resource_pool_thread_slot == -1)
+    {
+        _system_resource_pool_thread_slot = RESOURCE_POOL_MAX_THREAD_SLOTS;
+
+        for (unsigned int n_slot = 0;
+                          n_slot < RESOURCE_POOL_MAX_THREAD_SLOTS;
+                        ++n_slot)
+        {
+            if (_system_resource_pool_is_thread_slot_used[n_slot] == 0 &&
+                system_atomics_compare_exchange(_system_resource_pool_is_thread_slot_used + n_slot,
+                                                0,   /* expected_value */
+                                                1) ) /* new_value      */
+            {
+                _system_resource_pool_thread_slot = (int) n_slot;
+
+                break;
+            }
+        }
+    }
+
+    return _system_resource_pool_thread_slot;
+}
+
+/** Pops a node from one of the pool's node lists.
+ *
+ *  @param pool_ptr Resource pool to use.
+ *  @param head_ptr Head of the list.
+ *
+ *  @return Node popped from the list or NULL if the list is empty.
+ */
+PRIVATE _system_resource_pool_node* _system_resource_pool_pop_node(_system_resource_pool_internals* pool_ptr,
+                                                                   volatile __uint64*               head_ptr)
+{
+    while (true)
+    {
+        const __uint64     head                = system_atomics_load_acquire_uint64(head_ptr);
+        const unsigned int node_index_plus_one = (unsigned int) (head & 0xFFFFFFFF);
+
+        if (node_index_plus_one == 0)
+        {
+            return NULL;
+        }
+
+        /* The node may be popped and pushed back by other threads before we get to swap the head, in which
+         * case the tag will have changed and the exchange will fail. */
+        _system_resource_pool_node* node_ptr = _system_resource_pool_get_node(pool_ptr,
+                                                                              node_index_plus_one - 1);
+        const __uint64              new_head = (((head >> 32) + 1) << 32) | node_ptr->next_node_index_plus_one;
+
+        if (system_atomics_compare_exchange_uint64(head_ptr,
+                                                   head,
+                                                   new_head) )
+        {
+            return node_ptr;
+        }
+    }
+}
+
+/** Pushes a node onto one of the pool's node lists.
+ *
+ *  @param head_ptr Head of the list.
+ *  @param node_ptr Node to push.
+ */
+PRIVATE void _system_resource_pool_push_node(volatile __uint64*          head_ptr,
+                                             _system_resource_pool_node* node_ptr)
+{
+    while (true)
+    {
+        const __uint64 head     = system_atomics_load_acquire_uint64(head_ptr);
+        const __uint64 new_head = (((head >> 32) + 1) << 32) | (node_ptr->index + 1);
+
+        node_ptr->next_node_index_plus_one = (unsigned int) (head & 0xFFFFFFFF);
+
+        if (system_atomics_compare_exchange_uint64(head_ptr,
+                                                   head,
+                                                   new_head) )
+        {
+            break;
+        }
+    }
+}
+
+/** Retrieves an empty node. Allocates a new one if the empty node list is exhausted.
+ *
+ *  @param pool_ptr Resource pool to use.
+ *
+ *  @return Node descriptor.
+ */
+PRIVATE _system_resource_pool_node* _system_resource_pool_get_empty_node(_system_resource_pool_internals* pool_ptr)
+{
+    _system_resource_pool_node* result_ptr = _system_resource_pool_pop_node(pool_ptr,
+                                                                           &pool_ptr->empty_nodes_head);
+
+    if (result_ptr == NULL)
+    {
+        system_critical_section_enter(pool_ptr->cs);
+        {
+            const unsigned int node_index  = pool_ptr->n_nodes_allocated;
+            const unsigned int chunk_index = _system_resource_pool_get_node_chunk_index(node_index);
+
+            ASSERT_ALWAYS_SYNC(chunk_index < MAX_NODE_CHUNKS,
+                               "Resource pool node storage exhausted");
+
+            if (pool_ptr->node_chunks[chunk_index] == NULL)
+            {
+                pool_ptr->node_chunks[chunk_index] = new _system_resource_pool_node[1 << (chunk_index + FIRST_NODE_CHUNK_SIZE_LOG2)];
+            }
+
+            result_ptr        = _system_resource_pool_get_node(pool_ptr,
+                                                               node_index);
+            result_ptr->index = node_index;
+
+            pool_ptr->n_nodes_allocated++;
+        }
+        system_critical_section_leave(pool_ptr->cs);
+    }
+
+    return result_ptr;
+}
+
+/** Fills an empty magazine with blocks. Takes a batch of released blocks from the full node list,
+ *  or carves a new batch out of the allocator if none is available.
+ *
+ *  @param pool_ptr     Resource pool to use.
+ *  @param magazine_ptr Magazine to refill. Must be empty.
+ *  @param is_locked    true if the caller has already entered pool's critical section.
+ */
+PRIVATE void _system_resource_pool_refill_magazine(_system_resource_pool_internals* pool_ptr,
+                                                   _system_resource_pool_magazine*  magazine_ptr,
+                                                   bool                             is_locked)
+{
+    _system_resource_pool_node* node_ptr = _system_resource_pool_pop_node(pool_ptr,
+                                                                         &pool_ptr->full_nodes_head);
+
+    magazine_ptr->n_refills++;
+
+    if (node_ptr != NULL)
+    {
+        memcpy(magazine_ptr->blocks,
+               node_ptr->blocks,
+               sizeof(system_resource_pool_block) * node_ptr->n_blocks);
+
+        magazine_ptr->n_blocks = node_ptr->n_blocks;
+
+        _system_resource_pool_push_node(&pool_ptr->empty_nodes_head,
+                                         node_ptr);
+    }
+    else
+    {
+        if (!is_locked)
+        {
+            system_critical_section_enter(pool_ptr->cs);
+        }
+
+        for (unsigned int n_block = 0;
+                          n_block < RESOURCE_POOL_BATCH_SIZE;
+                        ++n_block)
+        {
+            system_resource_pool_block new_block = (system_resource_pool_block) system_linear_alloc_pin_get_from_pool(pool_ptr->allocator);
+
+            /* Init the block if a call-back function pointer was provided. */
+            if (pool_ptr->init_block_fn != NULL)
+            {
+                pool_ptr->init_block_fn(new_block);
+            }
+
+            /* Blocks are handed out from the end of the magazine. Store them in reverse order, so that
+             * they are handed out in the order they were carved out. */
+            magazine_ptr->blocks[RESOURCE_POOL_BATCH_SIZE - 1 - n_block] = new_block;
+        }
+
+        pool_ptr->n_blocks_allocated += RESOURCE_POOL_BATCH_SIZE;
+
+        if (!is_locked)
+        {
+            system_critical_section_leave(pool_ptr->cs);
+        }
+
+        magazine_ptr->n_blocks = RESOURCE_POOL_BATCH_SIZE;
+    }
+}
+
+/** Moves a batch of blocks from a full magazine to the full node list.
+ *
+ *  @param pool_ptr     Resource pool to use.
+ *  @param magazine_ptr Magazine to flush. Must be full.
+ */
+PRIVATE void _system_resource_pool_flush_magazine(_system_resource_pool_internals* pool_ptr,
+                                                  _system_resource_pool_magazine*  magazine_ptr)
+{
+    _system_resource_pool_node* node_ptr = _system_resource_pool_get_empty_node(pool_ptr);
+
+    magazine_ptr->n_blocks -= RESOURCE_POOL_BATCH_SIZE;
+
+    memcpy(node_ptr->blocks,
+           magazine_ptr->blocks + magazine_ptr->n_blocks,
+           sizeof(system_resource_pool_block) * RESOURCE_POOL_BATCH_SIZE);
+
+    node_ptr->n_blocks = RESOURCE_POOL_BATCH_SIZE;
+
+    _system_resource_pool_push_node(&pool_ptr->full_nodes_head,
+                                     node_ptr);
+}
+
+/** Calls the deinit call-back for all blocks stored in a magazine. */
+PRIVATE void _system_resource_pool_deinit_magazine_blocks(_system_resource_pool_internals*      pool_ptr,
+                                                          const _system_resource_pool_magazine* magazine_ptr)
+{
+    for (unsigned int n_block = 0;
+                      n_block < magazine_ptr->n_blocks;
+                    ++n_block)
+    {
+        pool_ptr->deinit_block_fn(magazine_ptr->blocks[n_block]);
+    }
+}
+
+
 /** Please see header for specification */
 PUBLIC EMERALD_API system_resource_pool system_resource_pool_create(size_t                           element_size,
                                                                     size_t                           n_elements_per_blob,
@@ -46,59 +377,83 @@ PUBLIC EMERALD_API system_resource_pool system_resource_pool_create(size_t
 
     if (result != NULL)
     {
+        memset(result,
+               0,
+               sizeof(*result) );
+
         result->allocator       = system_linear_alloc_pin_create(element_size,
                                                                  n_elements_per_blob,
                                                                  1); /* n_pins_to_prealloc */
         result->cs              = system_critical_section_create();
         result->deinit_block_fn = deinit_block_fn;
         result->init_block_fn   = init_block_fn;
-        result->released_blocks = system_resizable_vector_create(n_elements_per_blob);
 
         ASSERT_ALWAYS_SYNC(result->allocator != NULL,
                            "Allocator could not have been created.");
         ASSERT_ALWAYS_SYNC(result->cs != NULL,
                            "Could not create critical section");
-        ASSERT_ALWAYS_SYNC(result->released_blocks != NULL,
-                           "Released blocks vector could not have been created.");
     }
-    
+
     return (system_resource_pool) result;
 }
 
 /** Please see header for specification */
 PUBLIC EMERALD_API system_resource_pool_block system_resource_pool_get_from_pool(system_resource_pool pool)
 {
-    _system_resource_pool_internals* descriptor = (_system_resource_pool_internals*) pool;
-    system_resource_pool_block       result     = NULL;
+    _system_resource_pool_internals* pool_ptr    = (_system_resource_pool_internals*) pool;
+    system_resource_pool_block       result      = NULL;
+    const int                        thread_slot = _system_resource_pool_get_thread_slot();
 
-    system_critical_section_enter(descriptor->cs);
+    if (thread_slot != RESOURCE_POOL_MAX_THREAD_SLOTS)
     {
-        unsigned int n_cached_released_blocks = 0;
-
-        system_resizable_vector_get_property(descriptor->released_blocks,
-                                             SYSTEM_RESIZABLE_VECTOR_PROPERTY_N_ELEMENTS,
-                                             &n_cached_released_blocks);
+        _system_resource_pool_magazine* magazine_ptr = pool_ptr->magazines[thread_slot];
 
-        if (n_cached_released_blocks > 0)
+        if (magazine_ptr == NULL)
         {
-            bool result_get = system_resizable_vector_pop(descriptor->released_blocks,
-                                                         &result);
+            /* Only the owning thread ever accesses its slot, so no synchronization is needed here */
+            magazine_ptr = new _system_resource_pool_magazine;
+
+            memset(magazine_ptr,
+                   0,
+                   sizeof(*magazine_ptr) );
 
-            ASSERT_DEBUG_SYNC(result_get,
-                              "Could not retrieve resource pool block.");
+            pool_ptr->magazines[thread_slot] = magazine_ptr;
+        }
+
+        if (magazine_ptr->n_blocks == 0)
+        {
+            _system_resource_pool_refill_magazine(pool_ptr,
+                                                  magazine_ptr,
+                                                  false); /* is_locked */
         }
         else
         {
-            result = (system_resource_pool_block) system_linear_alloc_pin_get_from_pool(descriptor->allocator);
+            magazine_ptr->n_hits++;
+        }
 
-            /* Init the block if a call-back function pointer was provided. */
-            if (descriptor->init_block_fn != NULL)
+        result = magazine_ptr->blocks[--magazine_ptr->n_blocks];
+    }
+    else
+    {
+        system_critical_section_enter(pool_ptr->cs);
+        {
+            _system_resource_pool_magazine* magazine_ptr = &pool_ptr->shared_magazine;
+
+            if (magazine_ptr->n_blocks == 0)
+            {
+                _system_resource_pool_refill_magazine(pool_ptr,
+                                                      magazine_ptr,
+                                                      true); /* is_locked */
+            }
+            else
             {
-                descriptor->init_block_fn(result);
+                magazine_ptr->n_hits++;
             }
+
+            result = magazine_ptr->blocks[--magazine_ptr->n_blocks];
         }
+        system_critical_section_leave(pool_ptr->cs);
     }
-    system_critical_section_leave(descriptor->cs);
 
     ASSERT_DEBUG_SYNC(result != NULL,
                       "NULL blob returned by system_resource_pool");
@@ -106,6 +461,71 @@ PUBLIC EMERALD_API system_resource_pool_block system_resource_pool_get_from_pool
     return result;
 }
 
+/** Please see header for specification */
+PUBLIC EMERALD_API void system_resource_pool_get_property(system_resource_pool          pool,
+                                                          system_resource_pool_property property,
+                                                          void*                         out_result_ptr)
+{
+    _system_resource_pool_internals* pool_ptr = (_system_resource_pool_internals*) pool;
+
+    switch (property)
+    {
+        case SYSTEM_RESOURCE_POOL_PROPERTY_HIGH_WATER_MARK:
+        {
+            *(unsigned int*) out_result_ptr = pool_ptr->n_blocks_allocated;
+
+            break;
+        }
+
+        case SYSTEM_RESOURCE_POOL_PROPERTY_N_CACHE_HITS:
+        case SYSTEM_RESOURCE_POOL_PROPERTY_N_REFILLS:
+        {
+            __uint64 result = 0;
+
+            system_critical_section_enter(pool_ptr->cs);
+            {
+                for (unsigned int n_magazine = 0;
+                                  n_magazine <= RESOURCE_POOL_MAX_THREAD_SLOTS;
+                                ++n_magazine)
+                {
+                    const _system_resource_pool_magazine* magazine_ptr = (n_magazine < RESOURCE_POOL_MAX_THREAD_SLOTS) ? pool_ptr->magazines[n_magazine]
+                                                                                                                      : &pool_ptr->shared_magazine;
+
+                    if (magazine_ptr != NULL)
+                    {
+                        result += (property == SYSTEM_RESOURCE_POOL_PROPERTY_N_CACHE_HITS) ? magazine_ptr->n_hits
+                                                                                           : magazine_ptr->n_refills;
+                    }
+                }
+            }
+            system_critical_section_leave(pool_ptr->cs);
+
+            *(__uint64*) out_result_ptr = result;
+
+            break;
+        }
+
+        default:
+        {
+            ASSERT_DEBUG_SYNC(false,
+                              "Unrecognized system_resource_pool_property value");
+        }
+    } /* switch (property) */
+}
+
+/** Please see header for specification */
+PUBLIC void _system_resource_pool_release_thread_slot()
+{
+    if (_system_resource_pool_thread_slot != -1 &&
+        _system_resource_pool_thread_slot != RESOURCE_POOL_MAX_THREAD_SLOTS)
+    {
+        system_atomics_store_release(_system_resource_pool_is_thread_slot_used + _system_resource_pool_thread_slot,
+                                     0);
+    }
+
+    _system_resource_pool_thread_slot = -1;
+}
+
 /** Please see header for specification */
 PUBLIC EMERALD_API void system_resource_pool_return_all_allocations(system_resource_pool pool)
 {
@@ -115,7 +535,33 @@ PUBLIC EMERALD_API void system_resource_pool_return_all_allocations(system_resou
     {
         if (pool_ptr->deinit_block_fn == NULL)
         {
-            /* Faster code-path */
+            /* Faster code-path. Blocks cached by the pool are about to become invalid, so drop them.
+             * This requires that no other thread uses the pool at the same time. */
+            for (unsigned int n_magazine = 0;
+                              n_magazine < RESOURCE_POOL_MAX_THREAD_SLOTS;
+                            ++n_magazine)
+            {
+                if (pool_ptr->magazines[n_magazine] != NULL)
+                {
+                    pool_ptr->magazines[n_magazine]->n_blocks = 0;
+                }
+            }
+
+            pool_ptr->shared_magazine.n_blocks = 0;
+
+            /* All nodes become empty nodes. */
+            pool_ptr->empty_nodes_head = 0;
+            pool_ptr->full_nodes_head  = 0;
+
+            for (unsigned int n_node = 0;
+                              n_node < pool_ptr->n_nodes_allocated;
+                            ++n_node)
+            {
+                _system_resource_pool_push_node(&pool_ptr->empty_nodes_head,
+                                                 _system_resource_pool_get_node(pool_ptr,
+                                                                                n_node) );
+            }
+
             system_linear_alloc_pin_return_all(pool_ptr->allocator);
         }
         else
@@ -132,65 +578,125 @@ PUBLIC EMERALD_API void system_resource_pool_return_all_allocations(system_resou
 PUBLIC EMERALD_API void system_resource_pool_return_to_pool(system_resource_pool       pool,
                                                             system_resource_pool_block block)
 {
-    _system_resource_pool_internals* descriptor = (_system_resource_pool_internals*) pool;
+    _system_resource_pool_internals* pool_ptr    = (_system_resource_pool_internals*) pool;
+    const int                        thread_slot = _system_resource_pool_get_thread_slot();
 
     ASSERT_DEBUG_SYNC(block != NULL,
                       "NULL block returned to the pool!");
-    system_critical_section_enter(descriptor->cs);
+
+    if (thread_slot != RESOURCE_POOL_MAX_THREAD_SLOTS)
+    {
+        _system_resource_pool_magazine* magazine_ptr = pool_ptr->magazines[thread_slot];
+
+        if (magazine_ptr == NULL)
+        {
+            magazine_ptr = new _system_resource_pool_magazine;
+
+            memset(magazine_ptr,
+                   0,
+                   sizeof(*magazine_ptr) );
+
+            pool_ptr->magazines[thread_slot] = magazine_ptr;
+        }
+
+        if (magazine_ptr->n_blocks == RESOURCE_POOL_MAGAZINE_CAPACITY)
+        {
+            _system_resource_pool_flush_magazine(pool_ptr,
+                                                 magazine_ptr);
+        }
+
+        magazine_ptr->blocks[magazine_ptr->n_blocks++] = block;
+    }
+    else
     {
-        system_resizable_vector_push(descriptor->released_blocks,
-                                     block);
+        system_critical_section_enter(pool_ptr->cs);
+        {
+            _system_resource_pool_magazine* magazine_ptr = &pool_ptr->shared_magazine;
+
+            if (magazine_ptr->n_blocks == RESOURCE_POOL_MAGAZINE_CAPACITY)
+            {
+                _system_resource_pool_flush_magazine(pool_ptr,
+                                                     magazine_ptr);
+            }
+
+            magazine_ptr->blocks[magazine_ptr->n_blocks++] = block;
+        }
+        system_critical_section_leave(pool_ptr->cs);
     }
-    system_critical_section_leave(descriptor->cs);
 }
 
 /** Please see header for specification */
 PUBLIC EMERALD_API void system_resource_pool_release(system_resource_pool pool)
 {
-    _system_resource_pool_internals* descriptor = (_system_resource_pool_internals*) pool;
+    _system_resource_pool_internals* pool_ptr = (_system_resource_pool_internals*) pool;
 
-    ASSERT_ALWAYS_SYNC(descriptor != NULL,
+    ASSERT_ALWAYS_SYNC(pool_ptr != NULL,
                        "Pool cannot be null");
 
-    if (descriptor != NULL)
+    if (pool_ptr != NULL)
     {
-        /* Deinit all returned blocks before we continue */
-        if (descriptor->deinit_block_fn != NULL)
+        /* Deinit all blocks cached by the pool before we continue */
+        if (pool_ptr->deinit_block_fn != NULL)
         {
-            unsigned int n_elements = 0;
-
-            system_resizable_vector_get_property(descriptor->released_blocks,
-                                                 SYSTEM_RESIZABLE_VECTOR_PROPERTY_N_ELEMENTS,
-                                                &n_elements);
+            _system_resource_pool_node* node_ptr = NULL;
 
-            for (unsigned int n_element = 0;
-                              n_element < n_elements;
-                            ++n_element)
+            for (unsigned int n_magazine = 0;
+                              n_magazine < RESOURCE_POOL_MAX_THREAD_SLOTS;
+                            ++n_magazine)
             {
-                system_resource_pool_block item       = NULL;
-                bool                       result_get = false;
-
-                result_get = system_resizable_vector_get_element_at(descriptor->released_blocks,
-                                                                    n_element,
-                                                                   &item);
+                if (pool_ptr->magazines[n_magazine] != NULL)
+                {
+                    _system_resource_pool_deinit_magazine_blocks(pool_ptr,
+                                                                 pool_ptr->magazines[n_magazine]);
+                }
+            }
 
-                ASSERT_DEBUG_SYNC(result_get,
-                                  "Could not retrieve block item to release.");
+            _system_resource_pool_deinit_magazine_blocks(pool_ptr,
+                                                        &pool_ptr->shared_magazine);
 
-                descriptor->deinit_block_fn(item);
+            while ( (node_ptr = _system_resource_pool_pop_node(pool_ptr,
+                                                              &pool_ptr->full_nodes_head)) != NULL)
+            {
+                for (unsigned int n_block = 0;
+                                  n_block < node_ptr->n_blocks;
+                                ++n_block)
+                {
+                    pool_ptr->deinit_block_fn(node_ptr->blocks[n_block]);
+                }
             }
         }
 
         /* Okay, carry on. */
-        system_linear_alloc_pin_release(descriptor->allocator);
-        descriptor->allocator = NULL;
+        for (unsigned int n_magazine = 0;
+                          n_magazine < RESOURCE_POOL_MAX_THREAD_SLOTS;
+                        ++n_magazine)
+        {
+            if (pool_ptr->magazines[n_magazine] != NULL)
+            {
+                delete pool_ptr->magazines[n_magazine];
+
+                pool_ptr->magazines[n_magazine] = NULL;
+            }
+        }
 
-        system_critical_section_release(descriptor->cs);
-        descriptor->cs = NULL;
+        for (unsigned int n_chunk = 0;
+                          n_chunk < MAX_NODE_CHUNKS;
+                        ++n_chunk)
+        {
+            if (pool_ptr->node_chunks[n_chunk] != NULL)
+            {
+                delete [] pool_ptr->node_chunks[n_chunk];
 
-        system_resizable_vector_release(descriptor->released_blocks);
-        descriptor->released_blocks = NULL;
+                pool_ptr->node_chunks[n_chunk] = NULL;
+            }
+        }
 
-        delete descriptor;
+        system_linear_alloc_pin_release(pool_ptr->allocator);
+        pool_ptr->allocator = NULL;
+
+        system_critical_section_release(pool_ptr->cs);
+        pool_ptr->cs = NULL;
+
+        delete pool_ptr;
     }
-}
\ No newline at end of file
+}
@@ -126,18 +126,33 @@ EMERALD_API void system_semaphore_enter(system_semaphore semaphore,
             system_time_get_msec_for_time(timeout,
                                          &timeout_msec);
 
-            timeout_api.tv_sec  = timeout_msec / 1000;
-            timeout_api.tv_nsec = long(timeout_msec % 1000) * NSEC_PER_SEC;
+            /* sem_timedwait() takes an absolute time-out */
+            clock_gettime(CLOCK_REALTIME,
+                         &timeout_api);
+
+            timeout_api.tv_sec  += timeout_msec / 1000;
+            timeout_api.tv_nsec += long(timeout_msec % 1000) * (NSEC_PER_SEC / 1000);
+
+            if (timeout_api.tv_nsec >= NSEC_PER_SEC)
+            {
+                timeout_api.tv_sec  ++;
+                timeout_api.tv_nsec -= NSEC_PER_SEC;
+            }
 
             system_critical_section_enter(semaphore_ptr->cs);
             {
-                result = sem_timedwait(&semaphore_ptr->semaphore,
-                                       &timeout_api);
+                do
+                {
+                    result = sem_timedwait(&semaphore_ptr->semaphore,
+                                           &timeout_api);
+                }
+                while (result == -1    &&
+                       errno  == EINTR);
             }
             system_critical_section_leave(semaphore_ptr->cs);
 
-            if (result == -1        &&
-                errno  == ETIMEDOUT)
+            /* Any failure means the semaphore has not been entered */
+            if (result != 0)
             {
                 if (out_has_timed_out_ptr != NULL)
                 {
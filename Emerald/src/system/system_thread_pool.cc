@@ -5,6 +5,7 @@
  */
 #include "shared.h"
 #include "system/system_assertions.h"
+#include "system/system_capabilities.h"
 #include "system/system_critical_section.h"
 #include "system/system_event.h"
 #include "system/system_log.h"
@@ -23,9 +24,39 @@ typedef enum
 {
     SYSTEM_THREAD_POOL_ORDER_TYPE_TASK,             /* single task */
     SYSTEM_THREAD_POOL_ORDER_TYPE_GROUP_OF_TASKS,   /* multiple tasks */
-    SYSTEM_THREAD_POOL_ORDER_TYPE_JOB               /* multiple groups of tasks */
+    SYSTEM_THREAD_POOL_ORDER_TYPE_JOB               /* single task, forked off a job */
 } _system_thread_pool_order_type;
 
+typedef struct
+{
+    /** Number of forked tasks which have not finished executing yet. */
+    volatile unsigned int n_tasks_in_flight;
+
+    /** Number of threads blocked in system_thread_pool_wait_for_job(). Forking a task off the job only
+     *  sets tasks_finished_event if this counter is non-zero. A waiter which wakes up to find the job
+     *  finished sets the event again if the counter is still non-zero, so that every waiter wakes up. */
+    volatile unsigned int n_waiters;
+
+    /** Number of references to the job. The owner holds one until it releases the job. A thread which
+     *  is about to set tasks_finished_event, or is waiting for the job, holds another one, so that the job
+     *  outlives the call even if the owner has already seen n_tasks_in_flight drop to zero and released it.
+     *  Whoever drops the last reference destroys the job. */
+    volatile unsigned int ref_counter;
+
+    /** Auto-reset event set whenever the number of tasks in flight drops to zero, or a task is forked off
+     *  the job while threads are waiting for it. Only used as a hint for waiting threads - job completion
+     *  is always determined by n_tasks_in_flight. */
+    system_event tasks_finished_event;
+} _system_thread_pool_job;
+
+typedef struct
+{
+    PFNSYSTEMTHREADPOOLPARALLELFORPROC pfn_callback_proc;
+    uint32_t                           range_end;
+    uint32_t                           range_start;
+    void*                              user_arg;
+} _system_thread_pool_parallel_for_chunk;
+
 typedef struct
 {
     /** Event to set on finishing the task. Can be NULL. */
@@ -40,6 +71,8 @@ typedef struct
     PFNSYSTEMTHREADPOOLCALLBACKPROC on_finish_callback;
     /** Priority of the task. Used for task scheduling */
     system_thread_pool_task_priority task_priority;
+    /** Job the task has been forked off. NULL for tasks not belonging to any job. */
+    _system_thread_pool_job* job_ptr;
 
 } _system_thread_pool_task;
 
@@ -63,15 +96,43 @@ typedef struct
      *
      * _system_thread_pool_task*       if order_type is SYSTEM_THREAD_POOL_ORDER_TYPE_TASK
      * _system_thread_pool_task_group* if order_type is SYSTEM_THREAD_POOL_ORDER_TYPE_GROUP_OF_TASKS
-     * _system_thread_pool_task_job*   if order_type is SYSTEM_THREAD_POOL_ORDER_TYPE_JOB
+     * _system_thread_pool_task*       if order_type is SYSTEM_THREAD_POOL_ORDER_TYPE_JOB
      */
     void* order_ptr;
 } _system_thread_pool_order;
 
 typedef _system_thread_pool_order* _system_thread_pool_order_ptr;
 
+/** Chase-Lev work-stealing deque. The owning worker pushes and pops orders at the bottom end,
+ *  while all other workers steal from the top end.
+ */
+typedef struct
+{
+    volatile unsigned int bottom;
+    char                  padding[64 - sizeof(unsigned int)]; /* keep top & bottom in separate cache lines */
+    volatile unsigned int top;
+
+    _system_thread_pool_order_ptr volatile orders[THREAD_POOL_WORK_STEALING_DEQUE_CAPACITY];
+} _system_thread_pool_deque;
+
+typedef struct
+{
+    /** One deque per task priority. */
+    _system_thread_pool_deque deques[THREAD_POOL_TASK_PRIORITY_COUNT];
+
+    /** Index of the worker to start stealing from at the next attempt. */
+    unsigned int steal_start_index;
+
+    /** Utilization counters. Only updated by the owning worker. */
+    __uint64     busy_time_usec;
+    unsigned int n_orders_executed;
+    unsigned int n_orders_stolen;
+} _system_thread_pool_worker;
+
 
 /* Internal variables */
+volatile unsigned int   n_globally_queued_orders                               =  0;
+volatile unsigned int   n_sleeping_workers                                     =  0;
 system_resource_pool    order_pool                                             =  NULL;
 system_resizable_vector queued_tasks         [THREAD_POOL_TASK_PRIORITY_COUNT] = {NULL};
 system_critical_section queued_tasks_cs                                        =  NULL;
@@ -82,22 +143,379 @@ system_resource_pool    task_group_pool                                        =
 system_event            threads_spawned_event                                  =  NULL;
 
 
-system_thread_id thread_id_array   [THREAD_POOL_AMOUNT_OF_THREADS] = { (system_thread_id) NULL};
-system_event     thread_wait_events[THREAD_POOL_AMOUNT_OF_THREADS] = { (system_event)     NULL};
+/* Worker thread storage. Sized at init time. */
+unsigned int                n_workers          = 0;
+bool                        should_pin_workers = false;
+system_thread_id*           thread_id_array    = NULL;
+system_event*               thread_wait_events = NULL;
+bool                        use_work_stealing  = THREAD_POOL_USE_WORK_STEALING;
+_system_thread_pool_worker* workers            = NULL;
+
+/* Index of the worker the current thread corresponds to, or -1 if the thread is not a thread pool worker. */
+#ifdef _WIN32
+    __declspec(thread) int current_worker_index = -1;
+#else
+    __thread int current_worker_index = -1;
+#endif
 
 
 /* Forward declarations */
+PRIVATE inline _system_thread_pool_order_ptr _system_thread_pool_deque_pop  (_system_thread_pool_deque*          deque_ptr);
+PRIVATE inline bool _system_thread_pool_deque_push                          (_system_thread_pool_deque*          deque_ptr,
+                                                                             _system_thread_pool_order_ptr       order_ptr);
+PRIVATE inline _system_thread_pool_order_ptr _system_thread_pool_deque_steal(_system_thread_pool_deque*          deque_ptr,
+                                                                             _system_thread_pool_job*            job_ptr);
 PRIVATE void        _system_thread_pool_deinit_system_thread_pool_task      (system_resource_pool_block          task_descriptor_block);
 PRIVATE void        _system_thread_pool_deinit_system_thread_pool_task_group(system_resource_pool_block          task_group_block);
+PRIVATE inline _system_thread_pool_order_ptr _system_thread_pool_dequeue_order(_system_thread_pool_job* job_ptr);
+PRIVATE inline void _system_thread_pool_enqueue_order                       (_system_thread_pool_order_ptr       order_ptr,
+                                                                             system_thread_pool_task_priority    order_priority);
+PRIVATE unsigned int _system_thread_pool_get_env_variable_value             (const char*                         name,
+                                                                             unsigned int                        default_value);
 PRIVATE void        _system_thread_pool_init_system_thread_pool_task        (system_resource_pool_block          task_block);
 PRIVATE void        _system_thread_pool_init_system_thread_pool_task_group  (system_resource_pool_block          task_group_block);
-PRIVATE inline void _system_thread_pool_submit_single_task                  (system_thread_pool_task             task,
-                                                                             bool                                enter_cs);
-PRIVATE void        _system_thread_pool_worker_entrypoint                   (system_threads_entry_point_argument);
+PRIVATE void        _system_thread_pool_job_release_reference               (_system_thread_pool_job*            job_ptr);
+PRIVATE inline bool _system_thread_pool_order_belongs_to_job                 (_system_thread_pool_order_ptr       order_ptr,
+                                                                             _system_thread_pool_job*            job_ptr);
+PRIVATE inline void _system_thread_pool_submit_single_task                  (system_thread_pool_task             task);
+PRIVATE void        _system_thread_pool_worker_entrypoint                   (system_threads_entry_point_argument worker_index);
+PRIVATE inline void _system_thread_pool_worker_run_order                    (_system_thread_pool_worker*         worker_ptr,
+                                                                             void*                               order);
 PRIVATE inline void _system_thread_pool_worker_execute_order                (void*                               order);
 PRIVATE inline void _system_thread_pool_worker_execute_task                 (_system_thread_pool_task*           task_ptr);
 PRIVATE inline void _system_thread_pool_worker_execute_task_group           (_system_thread_pool_task_group*     task_group_ptr);
+PRIVATE volatile void _system_thread_pool_parallel_for_chunk_handler        (system_thread_pool_callback_argument chunk);
+
+
+/** Pops an order from the bottom end of the deque. Must only be called by the worker owning the deque.
+ *
+ *  @param deque_ptr Deque to use.
+ *
+ *  @return Order descriptor or NULL if the deque is empty.
+ **/
+PRIVATE inline _system_thread_pool_order_ptr _system_thread_pool_deque_pop(_system_thread_pool_deque* deque_ptr)
+{
+    _system_thread_pool_order_ptr result = NULL;
+    const unsigned int            bottom = deque_ptr->bottom - 1;
+    unsigned int                  top;
+
+    deque_ptr->bottom = bottom;
+
+    /* The store above must become visible before we read the top index, or we could race with a thief
+     * for the last order in the deque. */
+    system_atomics_memory_barrier();
+
+    top = deque_ptr->top;
 
+    if ((int) (bottom - top) >= 0)
+    {
+        result = deque_ptr->orders[bottom & (THREAD_POOL_WORK_STEALING_DEQUE_CAPACITY - 1)];
+
+        if (bottom == top)
+        {
+            /* This is the last order. Compete with thieves for it. */
+            if (!system_atomics_compare_exchange(&deque_ptr->top,
+                                                 top,
+                                                 top + 1) )
+            {
+                result = NULL;
+            }
+
+            deque_ptr->bottom = bottom + 1;
+        }
+    }
+    else
+    {
+        /* Deque is empty */
+        deque_ptr->bottom = bottom + 1;
+    }
+
+    return result;
+}
+
+/** Pushes an order onto the bottom end of the deque. Must only be called by the worker owning the deque.
+ *
+ *  @param deque_ptr Deque to use.
+ *  @param order_ptr Order to push.
+ *
+ *  @return true if successful, false if the deque is full.
+ **/
+PRIVATE inline bool _system_thread_pool_deque_push(_system_thread_pool_deque*    deque_ptr,
+                                                   _system_thread_pool_order_ptr order_ptr)
+{
+    const unsigned int bottom = deque_ptr->bottom;
+    const unsigned int top    = system_atomics_load_acquire(&deque_ptr->top);
+
+    if (bottom - top >= THREAD_POOL_WORK_STEALING_DEQUE_CAPACITY)
+    {
+        return false;
+    }
+
+    deque_ptr->orders[bottom & (THREAD_POOL_WORK_STEALING_DEQUE_CAPACITY - 1)] = order_ptr;
+
+    system_atomics_store_release(&deque_ptr->bottom,
+                                 bottom + 1);
+
+    return true;
+}
+
+/** Steals an order from the top end of the deque. Can be called from any thread.
+ *
+ *  @param deque_ptr Deque to use.
+ *  @param job_ptr   If not NULL, the order is only stolen if it is a task forked off this job.
+ *
+ *  @return Order descriptor or NULL if the deque is empty, the order at the top end does not belong
+ *          to @param job_ptr, or another thread has won the race for the order.
+ **/
+PRIVATE inline _system_thread_pool_order_ptr _system_thread_pool_deque_steal(_system_thread_pool_deque* deque_ptr,
+                                                                             _system_thread_pool_job*   job_ptr)
+{
+    _system_thread_pool_order_ptr result = NULL;
+    const unsigned int            top    = system_atomics_load_acquire(&deque_ptr->top);
+    unsigned int                  bottom;
+
+    system_atomics_memory_barrier();
+
+    bottom = system_atomics_load_acquire(&deque_ptr->bottom);
+
+    if ((int) (bottom - top) > 0)
+    {
+        result = deque_ptr->orders[top & (THREAD_POOL_WORK_STEALING_DEQUE_CAPACITY - 1)];
+
+        /* The order may be taken by someone else while we're inspecting it. Order descriptors are
+         * pooled, so the memory stays valid, and the CAS below fails in that case anyway. */
+        if (job_ptr != NULL                                            &&
+            !_system_thread_pool_order_belongs_to_job(result, job_ptr) )
+        {
+            result = NULL;
+        }
+        else
+        if (!system_atomics_compare_exchange(&deque_ptr->top,
+                                             top,
+                                             top + 1) )
+        {
+            result = NULL;
+        }
+    }
+
+    return result;
+}
+
+/** Retrieves the next order to execute, following the priorities. For each priority, starting from the highest,
+ *  the worker first checks its own deque, then the shared queue, and finally tries to steal an order from
+ *  the other workers.
+ *
+ *  Can be called from any thread. Threads which are not thread pool workers do not own a deque, so they
+ *  only check the shared queue and steal from the workers.
+ *
+ *  @param job_ptr If not NULL, only tasks forked off this job are considered.
+ *
+ *  @return Order descriptor or NULL if no order could have been found.
+ **/
+PRIVATE inline _system_thread_pool_order_ptr _system_thread_pool_dequeue_order(_system_thread_pool_job* job_ptr)
+{
+    _system_thread_pool_order_ptr result            = NULL;
+    unsigned int                  steal_start_index = 0;
+    _system_thread_pool_worker*   worker_ptr        = (current_worker_index != -1) ? workers + current_worker_index
+                                                                                   : NULL;
+
+    if (worker_ptr != NULL)
+    {
+        steal_start_index = worker_ptr->steal_start_index;
+    }
+
+    for (system_thread_pool_task_priority current_priority   = (system_thread_pool_task_priority) (THREAD_POOL_TASK_PRIORITY_COUNT - 1);
+                                          current_priority  >= THREAD_POOL_TASK_PRIORITY_FIRST;
+                                   ((int&)current_priority) --)
+    {
+        /* 1. Own deque, if the caller is a worker. Threads helping out while waiting on a job have none. */
+        if (worker_ptr != NULL &&
+            job_ptr    == NULL)
+        {
+            result = _system_thread_pool_deque_pop(worker_ptr->deques + current_priority);
+
+            if (result != NULL)
+            {
+                break;
+            }
+        }
+
+        /* 2. Shared queue. Only take the lock if there's a chance to find something there. */
+        if (system_atomics_load_acquire(&n_globally_queued_orders) > 0)
+        {
+            system_critical_section_enter(queued_tasks_cs);
+            {
+                if (job_ptr == NULL)
+                {
+                    if (system_resizable_vector_pop(queued_tasks[current_priority],
+                                                   &result) )
+                    {
+                        system_atomics_decrement(&n_globally_queued_orders);
+                    }
+                }
+                else
+                {
+                    /* Look for the most recently queued task of the job */
+                    unsigned int n_orders = 0;
+
+                    system_resizable_vector_get_property(queued_tasks[current_priority],
+                                                         SYSTEM_RESIZABLE_VECTOR_PROPERTY_N_ELEMENTS,
+                                                        &n_orders);
+
+                    for (unsigned int n_order = n_orders;
+                                      n_order > 0;
+                                    --n_order)
+                    {
+                        _system_thread_pool_order_ptr order_ptr = NULL;
+
+                        system_resizable_vector_get_element_at(queued_tasks[current_priority],
+                                                               n_order - 1,
+                                                              &order_ptr);
+
+                        if (_system_thread_pool_order_belongs_to_job(order_ptr,
+                                                                     job_ptr) )
+                        {
+                            system_resizable_vector_delete_element_at(queued_tasks[current_priority],
+                                                                      n_order - 1);
+                            system_atomics_decrement                 (&n_globally_queued_orders);
+
+                            result = order_ptr;
+                            break;
+                        }
+                    }
+                }
+            }
+            system_critical_section_leave(queued_tasks_cs);
+
+            if (result != NULL)
+            {
+                break;
+            }
+        }
+
+        /* 3. Other workers */
+        for (unsigned int n_victim = 0;
+                          n_victim < n_workers;
+                        ++n_victim)
+        {
+            const unsigned int victim_index = (steal_start_index + n_victim) % n_workers;
+
+            if (victim_index == (unsigned int) current_worker_index)
+            {
+                continue;
+            }
+
+            result = _system_thread_pool_deque_steal(workers[victim_index].deques + current_priority,
+                                                     job_ptr);
+
+            if (result != NULL)
+            {
+                if (worker_ptr != NULL)
+                {
+                    worker_ptr->n_orders_stolen  ++;
+                    worker_ptr->steal_start_index = victim_index;
+                }
+
+                break;
+            }
+        }
+
+        if (result != NULL)
+        {
+            break;
+        }
+    }
+
+    return result;
+}
+
+/** Enqueues an order for execution. If work stealing is enabled and the caller is a worker thread,
+ *  the order is pushed onto the worker's own deque. Otherwise, the order is inserted into the shared queue.
+ *
+ *  @param order_ptr      Order to enqueue.
+ *  @param order_priority Priority to use for the order.
+ **/
+PRIVATE inline void _system_thread_pool_enqueue_order(_system_thread_pool_order_ptr    order_ptr,
+                                                      system_thread_pool_task_priority order_priority)
+{
+    bool is_enqueued = false;
+
+    ASSERT_DEBUG_SYNC(order_priority >= THREAD_POOL_TASK_PRIORITY_FIRST &&
+                      order_priority  < THREAD_POOL_TASK_PRIORITY_COUNT,
+                      "Corrupt task priority [%d]",
+                      order_priority);
+
+    if (use_work_stealing &&
+        current_worker_index != -1)
+    {
+        is_enqueued = _system_thread_pool_deque_push(workers[current_worker_index].deques + order_priority,
+                                                     order_ptr);
+    }
+
+    if (!is_enqueued)
+    {
+        system_critical_section_enter(queued_tasks_cs);
+        {
+            system_resizable_vector_push(queued_tasks[order_priority],
+                                         order_ptr);
+
+            system_atomics_increment(&n_globally_queued_orders);
+        }
+        system_critical_section_leave(queued_tasks_cs);
+    }
+
+    if (use_work_stealing)
+    {
+        /* Only wake a worker up if there's anyone asleep. The barrier pairs with the one in the worker
+         * entry-point, so that either the worker sees the new order, or we see the sleeping worker. */
+        system_atomics_memory_barrier();
+
+        if (n_sleeping_workers > 0)
+        {
+            system_semaphore_leave(queued_tasks_semaphore);
+        }
+    }
+    else
+    {
+        system_semaphore_leave(queued_tasks_semaphore);
+    }
+}
+
+/** Reads an unsigned integer value from an environment variable.
+ *
+ *  @param name          Name of the environment variable.
+ *  @param default_value Value to return if the variable is not set or does not hold a valid value.
+ *
+ *  @return As per description.
+ **/
+PRIVATE unsigned int _system_thread_pool_get_env_variable_value(const char*  name,
+                                                                unsigned int default_value)
+{
+    const char*  env_value_ptr = getenv(name);
+    char*        end_ptr       = NULL;
+    unsigned int result        = default_value;
+
+    if (env_value_ptr != NULL)
+    {
+        const unsigned long env_value = strtoul(env_value_ptr,
+                                               &end_ptr,
+                                                10); /* base */
+
+        if (end_ptr != env_value_ptr &&
+            *end_ptr == 0)
+        {
+            result = (unsigned int) env_value;
+        }
+        else
+        {
+            LOG_ERROR("Ignoring invalid value [%s] of environment variable [%s]",
+                      env_value_ptr,
+                      name);
+        }
+    }
+
+    return result;
+}
 
 /** TODO */
 PRIVATE void _system_thread_pool_deinit_system_thread_pool_task(system_resource_pool_block task_descriptor_block)
@@ -130,16 +548,39 @@ PRIVATE void _system_thread_pool_init_system_thread_pool_task_group(system_resou
                        "Could not preallocate task slots for task group descriptor.");
 }
 
-/* This procedure implements the process of submitting a single task into a priority queue. The reason
- * it is a private impl of system_thread_pool_submit_single_task() is that it is also called from task
- * execution routine which already locks the relevant CS.
+/** Drops a reference to a job. The job is destroyed once no references are left.
+ *
+ *  @param job_ptr Job to drop the reference to.
+ */
+PRIVATE void _system_thread_pool_job_release_reference(_system_thread_pool_job* job_ptr)
+{
+    if (system_atomics_decrement(&job_ptr->ref_counter) == 0)
+    {
+        system_event_release(job_ptr->tasks_finished_event);
+
+        delete job_ptr;
+    }
+}
+
+/** Tells whether an order is a task forked off the specified job.
  *
- * @param task     Descriptor of a task to submit.
- * @param enter_cs True to enter queued_tasks_cs critical section before submitting, false if no need to.
- *                 False should only be used from private implementation!
+ *  @param order_ptr Order to check.
+ *  @param job_ptr   Job to check against.
+ *
+ *  @return As per description.
  */
-PRIVATE inline void _system_thread_pool_submit_single_task(system_thread_pool_task task,
-                                                           bool                    enter_cs)
+PRIVATE inline bool _system_thread_pool_order_belongs_to_job(_system_thread_pool_order_ptr order_ptr,
+                                                             _system_thread_pool_job*      job_ptr)
+{
+    return order_ptr->order_type                                       == SYSTEM_THREAD_POOL_ORDER_TYPE_JOB &&
+           ((_system_thread_pool_task*) order_ptr->order_ptr)->job_ptr == job_ptr;
+}
+
+/** Wraps a task in an order descriptor and enqueues it for execution.
+ *
+ * @param task Descriptor of a task to submit.
+ */
+PRIVATE inline void _system_thread_pool_submit_single_task(system_thread_pool_task task)
 {
     /* Create order descriptor */
     _system_thread_pool_order_ptr new_order_ptr = (_system_thread_pool_order_ptr) system_resource_pool_get_from_pool(order_pool);
@@ -148,38 +589,36 @@ PRIVATE inline void _system_thread_pool_submit_single_task(system_thread_pool_ta
     new_order_ptr->order_type = SYSTEM_THREAD_POOL_ORDER_TYPE_TASK;
     new_order_ptr->order_ptr  = task_ptr;
 
-    /* Insert into the queue. */
-    if (enter_cs)
-    {
-        system_critical_section_enter(queued_tasks_cs);
-    }
-    {
-        ASSERT_DEBUG_SYNC(task_ptr->task_priority >= THREAD_POOL_TASK_PRIORITY_FIRST &&
-                          task_ptr->task_priority  < THREAD_POOL_TASK_PRIORITY_COUNT,
-                          "Corrupt task priority [%d]",
-                          task_ptr->task_priority
-                         );
-
-        system_resizable_vector_push(queued_tasks[task_ptr->task_priority],
-                                     new_order_ptr);
-    }
-    if (enter_cs)
-    {
-        system_critical_section_leave(queued_tasks_cs);
-    }
-
-    system_semaphore_leave(queued_tasks_semaphore);
+    _system_thread_pool_enqueue_order(new_order_ptr,
+                                      task_ptr->task_priority);
 }
 
 /** Entry point for every thread pool worker. Waits for task notifications and handles
  *  submitted tasks / tasks groups or jobs.
  *
- *  @param system_threads_entry_point_argument Not used.
+ *  @param system_threads_entry_point_argument Index of the worker.
  *
  **/
-PRIVATE void _system_thread_pool_worker_entrypoint(system_threads_entry_point_argument)
+PRIVATE void _system_thread_pool_worker_entrypoint(system_threads_entry_point_argument worker_index)
 {
-    system_thread_id current_thread_id = system_threads_get_thread_id();
+    system_thread_id            current_thread_id = system_threads_get_thread_id();
+    _system_thread_pool_worker* worker_ptr        = NULL;
+
+    current_worker_index = (int) (intptr_t) worker_index;
+    worker_ptr           = workers + current_worker_index;
+
+    /* Spread the initial steal attempts across the workers */
+    worker_ptr->steal_start_index = (current_worker_index + 1) % n_workers;
+
+    if (should_pin_workers)
+    {
+        unsigned int n_cpu_cores = 0;
+
+        system_capabilities_get(SYSTEM_CAPABILITIES_PROPERTY_NUMBER_OF_CPU_CORES,
+                               &n_cpu_cores);
+
+        system_threads_pin_current_thread_to_cpu_core(current_worker_index % n_cpu_cores);
+    }
 
     /* Enter wait loop */
     LOG_INFO("Worker thread [%d] starting.",
@@ -190,41 +629,86 @@ PRIVATE void _system_thread_pool_worker_entrypoint(system_threads_entry_point_ar
 
         while (should_live)
         {
-            void* current_order = NULL;
-            bool  result_get    = false;
+            if (use_work_stealing)
+            {
+                _system_thread_pool_order_ptr current_order_ptr = NULL;
 
-            /* Wait for the task to arrive. */
-            system_semaphore_enter(queued_tasks_semaphore,
-                                   SYSTEM_TIME_INFINITE);
+                /* Keep on executing orders for as long as there's anything to execute, either in the
+                 * worker's own deques, the shared queue, or other workers' deques. */
+                while ( should_live                                                           &&
+                       (current_order_ptr = _system_thread_pool_dequeue_order(NULL) ) != NULL)
+                {
+                    _system_thread_pool_worker_run_order(worker_ptr,
+                                                         current_order_ptr);
+                }
 
-            if (!should_live)
-            {
-                continue;
-            }
+                if (!should_live)
+                {
+                    break;
+                }
 
-            /* Extract the task */
-            system_critical_section_enter(queued_tasks_cs);
-            {
-                for (system_thread_pool_task_priority current_priority   = (system_thread_pool_task_priority) (THREAD_POOL_TASK_PRIORITY_COUNT - 1);
-                                                      current_priority  >= THREAD_POOL_TASK_PRIORITY_FIRST;
-                                               ((int&)current_priority) --)
+                /* Announce we're about to go to sleep and check one more time if no new order has arrived
+                 * in the meantime. Producers check the counter after enqueuing, so no wake-up can be lost. */
+                system_atomics_increment(&n_sleeping_workers);
+
+                current_order_ptr = _system_thread_pool_dequeue_order(NULL);
+
+                if (current_order_ptr != NULL)
                 {
-                    system_resizable_vector& queue = queued_tasks[current_priority];
+                    system_atomics_decrement(&n_sleeping_workers);
 
-                    result_get = system_resizable_vector_pop(queue,
-                                                            &current_order);
+                    _system_thread_pool_worker_run_order(worker_ptr,
+                                                         current_order_ptr);
 
-                    if (result_get && current_order != NULL)
+                    continue;
+                }
+
+                system_semaphore_enter(queued_tasks_semaphore,
+                                       SYSTEM_TIME_INFINITE);
+
+                system_atomics_decrement(&n_sleeping_workers);
+            } /* if (use_work_stealing) */
+            else
+            {
+                void* current_order = NULL;
+                bool  result_get    = false;
+
+                /* Wait for the task to arrive. */
+                system_semaphore_enter(queued_tasks_semaphore,
+                                       SYSTEM_TIME_INFINITE);
+
+                if (!should_live)
+                {
+                    continue;
+                }
+
+                /* Extract the task */
+                system_critical_section_enter(queued_tasks_cs);
+                {
+                    for (system_thread_pool_task_priority current_priority   = (system_thread_pool_task_priority) (THREAD_POOL_TASK_PRIORITY_COUNT - 1);
+                                                          current_priority  >= THREAD_POOL_TASK_PRIORITY_FIRST;
+                                                   ((int&)current_priority) --)
                     {
-                        break;
+                        system_resizable_vector& queue = queued_tasks[current_priority];
+
+                        result_get = system_resizable_vector_pop(queue,
+                                                                &current_order);
+
+                        if (result_get && current_order != NULL)
+                        {
+                            system_atomics_decrement(&n_globally_queued_orders);
+
+                            break;
+                        }
                     }
                 }
-            }
-            system_critical_section_leave(queued_tasks_cs);
+                system_critical_section_leave(queued_tasks_cs);
 
-            if (result_get)
-            {
-                _system_thread_pool_worker_execute_order(current_order);
+                if (result_get)
+                {
+                    _system_thread_pool_worker_run_order(worker_ptr,
+                                                         current_order);
+                }
             }
         } /* while (should_live) */
     }
@@ -265,7 +749,33 @@ PRIVATE inline void _system_thread_pool_worker_execute_order(void* order)
             break;
         }
 
-        case SYSTEM_THREAD_POOL_ORDER_TYPE_JOB: /* TODO TODO TODO */
+        case SYSTEM_THREAD_POOL_ORDER_TYPE_JOB:
+        {
+            _system_thread_pool_task* task_ptr = (_system_thread_pool_task*) order_ptr->order_ptr;
+            _system_thread_pool_job*  job_ptr  = task_ptr->job_ptr;
+
+            _system_thread_pool_worker_execute_task(task_ptr);
+
+            system_resource_pool_return_to_pool(task_pool,
+                                                (system_resource_pool_block) task_ptr);
+
+            /* Any tasks the task has forked have already been accounted for, so the job may now be finished.
+             *
+             * NOTE: A thread waiting for the job may notice the counter has dropped to zero and release the job
+             *       before we get a chance to set the event. The extra reference keeps the job alive until
+             *       we are done with it. */
+            system_atomics_increment(&job_ptr->ref_counter);
+            {
+                if (system_atomics_decrement(&job_ptr->n_tasks_in_flight) == 0)
+                {
+                    system_event_set(job_ptr->tasks_finished_event);
+                }
+            }
+            _system_thread_pool_job_release_reference(job_ptr);
+
+            break;
+        }
+
         default:
         {
             ASSERT_ALWAYS_SYNC(false,
@@ -273,6 +783,9 @@ PRIVATE inline void _system_thread_pool_worker_execute_order(void* order)
                                order_ptr->order_type);
         } /* default: */
     } /* switch(order_ptr->order_type) */
+
+    system_resource_pool_return_to_pool(order_pool,
+                                        (system_resource_pool_block) order_ptr);
 }
 
 /** Procedure that executes a task, according to its descriptor's contents.
@@ -324,8 +837,7 @@ PRIVATE inline void _system_thread_pool_worker_execute_task_group(_system_thread
 
             if (task_ptr != NULL)
             {
-                _system_thread_pool_submit_single_task((system_thread_pool_task) task_ptr,
-                                                       true); /* enter_cs */
+                _system_thread_pool_submit_single_task( (system_thread_pool_task) task_ptr);
             }
             else
             {
@@ -374,6 +886,54 @@ PRIVATE inline void _system_thread_pool_worker_execute_task_group(_system_thread
     }
 }
 
+/** Executes an order on behalf of a worker thread and updates the worker's utilization counters.
+ *
+ *  @param worker_ptr Worker executing the order.
+ *  @param order      Order to execute.
+ */
+PRIVATE inline void _system_thread_pool_worker_run_order(_system_thread_pool_worker* worker_ptr,
+                                                         void*                       order)
+{
+    const __uint64 start_time_usec = system_time_now_usec();
+
+    _system_thread_pool_worker_execute_order(order);
+
+    worker_ptr->busy_time_usec    += system_time_now_usec() - start_time_usec;
+    worker_ptr->n_orders_executed ++;
+}
+
+/** Thread pool task handler which processes a single parallel-for sub-range.
+ *
+ *  @param chunk Sub-range descriptor (_system_thread_pool_parallel_for_chunk*).
+ */
+PRIVATE volatile void _system_thread_pool_parallel_for_chunk_handler(system_thread_pool_callback_argument chunk)
+{
+    _system_thread_pool_parallel_for_chunk* chunk_ptr = (_system_thread_pool_parallel_for_chunk*) chunk;
+
+    chunk_ptr->pfn_callback_proc(chunk_ptr->range_start,
+                                 chunk_ptr->range_end,
+                                 chunk_ptr->user_arg);
+}
+
+
+/** Please see header for specification */
+PUBLIC EMERALD_API system_thread_pool_job system_thread_pool_create_job()
+{
+    _system_thread_pool_job* job_ptr = new (std::nothrow) _system_thread_pool_job;
+
+    ASSERT_ALWAYS_SYNC(job_ptr != NULL,
+                       "Out of memory");
+
+    if (job_ptr != NULL)
+    {
+        job_ptr->n_tasks_in_flight    = 0;
+        job_ptr->n_waiters            = 0;
+        job_ptr->ref_counter          = 1; /* owner's reference */
+        job_ptr->tasks_finished_event = system_event_create(false); /* auto-reset */
+    }
+
+    return (system_thread_pool_job) job_ptr;
+}
 
 /** Please see header for specification */
 PUBLIC EMERALD_API system_thread_pool_task_group system_thread_pool_create_task_group(bool is_distributable)
@@ -419,6 +979,7 @@ PUBLIC EMERALD_API system_thread_pool_task system_thread_pool_create_task_handle
     task_ptr->on_finish_callback             = NULL;
     task_ptr->on_finish_callback_argument    = NULL;
     task_ptr->task_priority                  = task_priority;
+    task_ptr->job_ptr                        = NULL;
 
     return (system_thread_pool_task) task_ptr;
 }
@@ -438,6 +999,7 @@ PUBLIC EMERALD_API system_thread_pool_task system_thread_pool_create_task_handle
     task_ptr->on_finish_callback             = on_finish_handler;
     task_ptr->on_finish_callback_argument    = on_finish_handler_argument;
     task_ptr->task_priority                  = task_priority;
+    task_ptr->job_ptr                        = NULL;
 
     return (system_thread_pool_task) task_ptr;
 }
@@ -456,10 +1018,129 @@ PUBLIC EMERALD_API system_thread_pool_task system_thread_pool_create_task_handle
     task_ptr->on_finish_callback             = NULL;
     task_ptr->on_finish_callback_argument    = NULL;
     task_ptr->task_priority                  = task_priority;
+    task_ptr->job_ptr                        = NULL;
 
     return (system_thread_pool_task) task_ptr;
 }
 
+/** Please see header for specification */
+PUBLIC EMERALD_API void system_thread_pool_fork_job_task(system_thread_pool_job               job,
+                                                         system_thread_pool_task_priority     task_priority,
+                                                         PFNSYSTEMTHREADPOOLCALLBACKPROC      execution_handler,
+                                                         system_thread_pool_callback_argument execution_handler_argument)
+{
+    _system_thread_pool_job*      job_ptr       = (_system_thread_pool_job*)      job;
+    _system_thread_pool_order_ptr new_order_ptr = (_system_thread_pool_order_ptr) system_resource_pool_get_from_pool(order_pool);
+    _system_thread_pool_task*     task_ptr      = (_system_thread_pool_task*)     system_thread_pool_create_task_handler_only(task_priority,
+                                                                                                                              execution_handler,
+                                                                                                                              execution_handler_argument);
+
+    task_ptr->job_ptr = job_ptr;
+
+    /* The counter must be bumped before the task becomes visible to the workers */
+    system_atomics_increment(&job_ptr->n_tasks_in_flight);
+
+    new_order_ptr->order_type = SYSTEM_THREAD_POOL_ORDER_TYPE_JOB;
+    new_order_ptr->order_ptr  = task_ptr;
+
+    _system_thread_pool_enqueue_order(new_order_ptr,
+                                      task_priority);
+
+    /* Let any waiting threads help out with the new task. Either the job's owner or one of the job's tasks
+     * is forking, so the job cannot be released in the meantime. */
+    if (system_atomics_load_acquire(&job_ptr->n_waiters) != 0)
+    {
+        system_event_set(job_ptr->tasks_finished_event);
+    }
+}
+
+/** Please see header for specification */
+PUBLIC EMERALD_API void system_thread_pool_get_property(system_thread_pool_property property,
+                                                        void*                       out_result_ptr)
+{
+    switch (property)
+    {
+        case SYSTEM_THREAD_POOL_PROPERTY_ARE_WORKERS_PINNED:
+        {
+            *(bool*) out_result_ptr = should_pin_workers;
+
+            break;
+        }
+
+        case SYSTEM_THREAD_POOL_PROPERTY_N_WORKERS:
+        {
+            *(unsigned int*) out_result_ptr = n_workers;
+
+            break;
+        }
+
+        case SYSTEM_THREAD_POOL_PROPERTY_USES_WORK_STEALING:
+        {
+            *(bool*) out_result_ptr = use_work_stealing;
+
+            break;
+        }
+
+        default:
+        {
+            ASSERT_DEBUG_SYNC(false,
+                              "Unrecognized system_thread_pool_property value");
+        }
+    } /* switch (property) */
+}
+
+/** Please see header for specification */
+PUBLIC EMERALD_API void system_thread_pool_get_worker_property(unsigned int                       n_worker,
+                                                               system_thread_pool_worker_property property,
+                                                               void*                              out_result_ptr)
+{
+    ASSERT_DEBUG_SYNC(n_worker < n_workers,
+                      "Invalid worker index [%u] requested",
+                      n_worker);
+
+    if (n_worker >= n_workers)
+    {
+        return;
+    }
+
+    switch (property)
+    {
+        case SYSTEM_THREAD_POOL_WORKER_PROPERTY_BUSY_TIME_USEC:
+        {
+            *(__uint64*) out_result_ptr = workers[n_worker].busy_time_usec;
+
+            break;
+        }
+
+        case SYSTEM_THREAD_POOL_WORKER_PROPERTY_N_ORDERS_EXECUTED:
+        {
+            *(unsigned int*) out_result_ptr = workers[n_worker].n_orders_executed;
+
+            break;
+        }
+
+        case SYSTEM_THREAD_POOL_WORKER_PROPERTY_N_ORDERS_STOLEN:
+        {
+            *(unsigned int*) out_result_ptr = workers[n_worker].n_orders_stolen;
+
+            break;
+        }
+
+        case SYSTEM_THREAD_POOL_WORKER_PROPERTY_THREAD_ID:
+        {
+            *(system_thread_id*) out_result_ptr = thread_id_array[n_worker];
+
+            break;
+        }
+
+        default:
+        {
+            ASSERT_DEBUG_SYNC(false,
+                              "Unrecognized system_thread_pool_worker_property value");
+        }
+    } /* switch (property) */
+}
+
 /** Please see header for specification */
 PUBLIC void _system_thread_pool_deinit()
 {
@@ -470,18 +1151,26 @@ PUBLIC void _system_thread_pool_deinit()
     should_live = false;
 
     system_semaphore_leave_multiple(queued_tasks_semaphore,
-                                    THREAD_POOL_AMOUNT_OF_THREADS);
+                                    n_workers);
 
-    system_event_wait_multiple(thread_wait_events,
-                               THREAD_POOL_AMOUNT_OF_THREADS,
-                               true, /* wait_on_all_objects */
-                               SYSTEM_TIME_INFINITE,
-                              &has_timed_out);
+    /* NOTE: The number of workers can exceed the number of objects a single multi-object wait can handle
+     *       on some platforms, so wait for the workers one by one. */
+    for (unsigned int n_worker = 0;
+                      n_worker < n_workers;
+                    ++n_worker)
+    {
+        system_event_wait_multiple(thread_wait_events + n_worker,
+                                   1,    /* n_elements          */
+                                   true, /* wait_on_all_objects */
+                                   SYSTEM_TIME_INFINITE,
+                                  &has_timed_out);
 
-    wait_result = !has_timed_out;
+        wait_result = !has_timed_out;
 
-    ASSERT_DEBUG_SYNC(wait_result,
-                      "Could not wait for the worker threads to finish");
+        ASSERT_DEBUG_SYNC(wait_result,
+                          "Could not wait for worker thread [%d] to finish",
+                          n_worker);
+    }
 
     /* All threads should have died by now. Deinit all remaining objects */
     system_resource_pool_release(order_pool);
@@ -494,6 +1183,15 @@ PUBLIC void _system_thread_pool_deinit()
 
     system_critical_section_release(queued_tasks_cs);
     system_semaphore_release       (queued_tasks_semaphore);
+
+    delete [] thread_id_array;
+    delete [] thread_wait_events;
+    delete [] workers;
+
+    n_workers          = 0;
+    thread_id_array    = NULL;
+    thread_wait_events = NULL;
+    workers            = NULL;
 }
 
 
@@ -544,6 +1242,55 @@ PUBLIC void _system_thread_pool_init()
                                "Could not create a queued tasks resizable vector.");
         }
 
+        /* Determine how many worker threads to spawn */
+        unsigned int n_cpu_cores = 0;
+
+        system_capabilities_get(SYSTEM_CAPABILITIES_PROPERTY_NUMBER_OF_CPU_CORES,
+                               &n_cpu_cores);
+
+        n_workers          = _system_thread_pool_get_env_variable_value(THREAD_POOL_AMOUNT_OF_THREADS_ENV_VARIABLE,
+                                                                        THREAD_POOL_AMOUNT_OF_THREADS);
+        should_pin_workers = _system_thread_pool_get_env_variable_value(THREAD_POOL_PIN_WORKER_THREADS_ENV_VARIABLE,
+                                                                        THREAD_POOL_PIN_WORKER_THREADS ? 1 : 0) != 0;
+        use_work_stealing  = _system_thread_pool_get_env_variable_value(THREAD_POOL_USE_WORK_STEALING_ENV_VARIABLE,
+                                                                        THREAD_POOL_USE_WORK_STEALING  ? 1 : 0) != 0;
+
+        if (n_workers == 0)
+        {
+            n_workers = (n_cpu_cores > THREAD_POOL_MIN_AMOUNT_OF_THREADS) ? n_cpu_cores
+                                                                          : THREAD_POOL_MIN_AMOUNT_OF_THREADS;
+        }
+
+        if (n_workers > THREAD_POOL_MAX_AMOUNT_OF_THREADS)
+        {
+            n_workers = THREAD_POOL_MAX_AMOUNT_OF_THREADS;
+        }
+
+        LOG_INFO("Thread pool: Spawning [%u] worker threads for [%u] CPU cores%s%s.",
+                 n_workers,
+                 n_cpu_cores,
+                 should_pin_workers ? ", pinning enabled"       : "",
+                 use_work_stealing  ? ", work stealing enabled" : "");
+
+        thread_id_array    = new (std::nothrow) system_thread_id          [n_workers];
+        thread_wait_events = new (std::nothrow) system_event              [n_workers];
+        workers            = new (std::nothrow) _system_thread_pool_worker[n_workers];
+
+        ASSERT_ALWAYS_SYNC(thread_id_array    != NULL &&
+                           thread_wait_events != NULL &&
+                           workers            != NULL,
+                           "Out of memory");
+
+        memset(thread_id_array,
+               0,
+               sizeof(system_thread_id) * n_workers);
+        memset(thread_wait_events,
+               0,
+               sizeof(system_event) * n_workers);
+        memset(workers,
+               0,
+               sizeof(_system_thread_pool_worker) * n_workers);
+
         queued_tasks_cs        = system_critical_section_create();
         queued_tasks_semaphore = system_semaphore_create       (MAX_TASKS_ENQUEUEABLE_WITHOUT_STALL, /* semaphore_capacity      */
                                                                 0);                                  /* semaphore_default_value */
@@ -563,7 +1310,7 @@ PUBLIC void _system_thread_pool_init()
 
         /* Got to spawn thread pool worker threads now. */
         for (unsigned int n_thread = 0;
-                          n_thread < THREAD_POOL_AMOUNT_OF_THREADS;
+                          n_thread < n_workers;
                         ++n_thread)
         {
             char temp_buffer[64];
@@ -574,7 +1321,7 @@ PUBLIC void _system_thread_pool_init()
                      n_thread);
 
             thread_id_array[n_thread] = system_threads_spawn(_system_thread_pool_worker_entrypoint,
-                                                             NULL, /* callback_func_argument */
+                                                             (system_threads_entry_point_argument) (intptr_t) n_thread,
                                                              thread_wait_events + n_thread,
                                                              system_hashed_ansi_string_create(temp_buffer) );
 
@@ -598,6 +1345,87 @@ PUBLIC EMERALD_API void system_thread_pool_insert_task_to_task_group(system_thre
                                  task);
 }
 
+/** Please see header for specification */
+PUBLIC EMERALD_API void system_thread_pool_parallel_for(uint32_t                           range_start,
+                                                        uint32_t                           range_end,
+                                                        uint32_t                           grain_size,
+                                                        PFNSYSTEMTHREADPOOLPARALLELFORPROC pfn_callback_proc,
+                                                        void*                              user_arg)
+{
+    _system_thread_pool_parallel_for_chunk* chunks   = NULL;
+    system_thread_pool_job                  job      = NULL;
+    uint32_t                                n_chunks = 0;
+
+    ASSERT_DEBUG_SYNC(grain_size != 0,
+                      "Grain size must not be 0");
+    ASSERT_DEBUG_SYNC(range_start <= range_end,
+                      "Invalid range requested");
+
+    if (range_end - range_start <= grain_size)
+    {
+        /* Not worth distributing */
+        if (range_end != range_start)
+        {
+            pfn_callback_proc(range_start,
+                              range_end,
+                              user_arg);
+        }
+
+        return;
+    }
+
+    n_chunks = (range_end - range_start + grain_size - 1) / grain_size;
+    chunks   = new (std::nothrow) _system_thread_pool_parallel_for_chunk[n_chunks];
+
+    ASSERT_ALWAYS_SYNC(chunks != NULL,
+                       "Out of memory");
+
+    for (uint32_t n_chunk = 0;
+                  n_chunk < n_chunks;
+                ++n_chunk)
+    {
+        chunks[n_chunk].pfn_callback_proc = pfn_callback_proc;
+        chunks[n_chunk].range_start       = range_start + n_chunk * grain_size;
+        chunks[n_chunk].range_end         = (n_chunk == n_chunks - 1) ? range_end
+                                                                      : chunks[n_chunk].range_start + grain_size;
+        chunks[n_chunk].user_arg          = user_arg;
+    }
+
+    /* Fork off all but the first sub-range, which the calling thread takes care of, before helping out
+     * with the remaining ones. */
+    job = system_thread_pool_create_job();
+
+    for (uint32_t n_chunk = 1;
+                  n_chunk < n_chunks;
+                ++n_chunk)
+    {
+        system_thread_pool_fork_job_task(job,
+                                         THREAD_POOL_TASK_PRIORITY_NORMAL,
+                                         _system_thread_pool_parallel_for_chunk_handler,
+                                         chunks + n_chunk);
+    }
+
+    _system_thread_pool_parallel_for_chunk_handler(chunks + 0);
+
+    system_thread_pool_wait_for_job   (job);
+    system_thread_pool_release_job    (job);
+
+    delete [] chunks;
+}
+
+/** Please see header for specification */
+PUBLIC EMERALD_API void system_thread_pool_release_job(system_thread_pool_job job)
+{
+    _system_thread_pool_job* job_ptr = (_system_thread_pool_job*) job;
+
+    ASSERT_DEBUG_SYNC(job_ptr->n_tasks_in_flight == 0,
+                      "Job released while its tasks are still being executed.");
+
+    /* A worker which has finished the last task may still be setting the job's event. If so, it will
+     * destroy the job instead. */
+    _system_thread_pool_job_release_reference(job_ptr);
+}
+
 /** Please see header for specification */
 PUBLIC EMERALD_API void system_thread_pool_release_task_group(system_thread_pool_task_group task_group)
 {
@@ -614,8 +1442,7 @@ PUBLIC EMERALD_API void system_thread_pool_release_task_group(system_thread_pool
 /** Please see header for specification */
 PUBLIC EMERALD_API void system_thread_pool_submit_single_task(system_thread_pool_task task)
 {
-    _system_thread_pool_submit_single_task(task,
-                                           true); /* enter_cs */
+    _system_thread_pool_submit_single_task(task);
 }
 
 /** Please see header for specification */
@@ -627,14 +1454,53 @@ PUBLIC EMERALD_API void system_thread_pool_submit_single_task_group(system_threa
     new_order_ptr->order_type = SYSTEM_THREAD_POOL_ORDER_TYPE_GROUP_OF_TASKS;
     new_order_ptr->order_ptr  = task_group;
 
-    /* Insert into the queue. */
-    system_critical_section_enter(queued_tasks_cs);
+    /* De-batching of the tasks should be performed with critical priority */
+    _system_thread_pool_enqueue_order(new_order_ptr,
+                                      THREAD_POOL_TASK_PRIORITY_CRITICAL);
+}
+
+/** Please see header for specification */
+PUBLIC EMERALD_API void system_thread_pool_wait_for_job(system_thread_pool_job job)
+{
+    _system_thread_pool_job* job_ptr = (_system_thread_pool_job*) job;
+
+    /* Other threads waiting for the job may still be on their way out by the time the owner wakes up
+     * and releases the job. Keep it alive until we are done with it. */
+    system_atomics_increment(&job_ptr->ref_counter);
+
+    while (system_atomics_load_acquire(&job_ptr->n_tasks_in_flight) != 0)
     {
-        /* De-batching of the tasks should be performed with critical priority */
-        system_resizable_vector_push(queued_tasks[THREAD_POOL_TASK_PRIORITY_CRITICAL],
-                                     new_order_ptr);
+        /* Help out, instead of blocking. Workers pick up any order, so that the pool keeps making progress.
+         * Other threads only execute the job's own tasks, so that they are not held up by unrelated work. */
+        _system_thread_pool_order_ptr order_ptr = _system_thread_pool_dequeue_order( (current_worker_index == -1) ? job_ptr
+                                                                                                                 : NULL);
+
+        if (order_ptr != NULL)
+        {
+            _system_thread_pool_worker_execute_order(order_ptr);
+
+            continue;
+        }
+
+        /* Nothing left to pick up - the remaining tasks are being executed by other threads. Sleep until the
+         * job's counter drops to zero, or until another task is forked off the job. The counter is checked
+         * again after registering as a waiter. The event is always set when the job finishes, so the
+         * wake-up cannot be missed. */
+        system_atomics_increment(&job_ptr->n_waiters);
+        {
+            if (system_atomics_load_acquire(&job_ptr->n_tasks_in_flight) != 0)
+            {
+                system_event_wait_single(job_ptr->tasks_finished_event);
+            }
+        }
+        if (system_atomics_decrement (&job_ptr->n_waiters)          != 0 &&
+            system_atomics_load_acquire(&job_ptr->n_tasks_in_flight) == 0)
+        {
+            /* The event is auto-reset, so only one waiter wakes up per set. Pass the wake-up on to
+             * the next one. */
+            system_event_set(job_ptr->tasks_finished_event);
+        }
     }
-    system_critical_section_leave(queued_tasks_cs);
 
-    system_semaphore_leave(queued_tasks_semaphore);
+    _system_thread_pool_job_release_reference(job_ptr);
 }
@@ -8,6 +8,7 @@
 #include "system/system_constants.h"
 #include "system/system_critical_section.h"
 #include "system/system_event.h"
+#include "system/system_frame_arena.h"
 #include "system/system_hash64map.h"
 #include "system/system_log.h"
 #include "system/system_resizable_vector.h"
@@ -17,6 +18,7 @@
 #ifdef __linux__
     #include <errno.h>
     #include <pthread.h>
+    #include <sched.h>
     #include <unistd.h>
     #include <sys/syscall.h>
     #include <sys/types.h>
@@ -116,6 +118,26 @@ system_resource_pool    thread_descriptor_pool   = NULL;
     }
     system_critical_section_leave(active_threads_vector_cs);
 
+    /* Let other threads take over the resource pool blocks cached by this thread */
+    _system_resource_pool_release_thread_slot();
+
+    /* Return the thread's frame arena chunks to the heap */
+    _system_frame_arena_release_thread_arena();
+
+    /* Let the log writer release the thread's log entry queue, once it has been drained */
+    _system_log_release_thread_ring();
+
+    #ifdef USE_FUTEX_EVENTS
+    {
+        /* Wake up threads waiting for this thread to quit. This must be the very last thing the thread
+         * does, as the waiters are free to reap the thread as soon as the event is signalled. */
+        if (exit_event != NULL)
+        {
+            _system_event_signal_thread_exit(exit_event);
+        }
+    }
+    #endif
+
     /* We're done */
     return NULL;
 }
@@ -189,6 +211,40 @@ PUBLIC EMERALD_API void system_threads_join_thread(system_thread thread,
     }
 }
 
+/** Please see header for specification */
+PUBLIC EMERALD_API bool system_threads_pin_current_thread_to_cpu_core(unsigned int n_cpu_core)
+{
+    bool result = false;
+
+#ifdef _WIN32
+    ASSERT_DEBUG_SYNC(n_cpu_core < sizeof(DWORD_PTR) * 8,
+                      "CPU core index [%d] exceeds affinity mask capacity",
+                      n_cpu_core);
+
+    result = (::SetThreadAffinityMask(::GetCurrentThread(),
+                                      ((DWORD_PTR) 1) << n_cpu_core) != 0);
+#else
+    cpu_set_t cpu_set;
+
+    CPU_ZERO(&cpu_set);
+    CPU_SET (n_cpu_core,
+            &cpu_set);
+
+    result = (pthread_setaffinity_np(pthread_self(),
+                                     sizeof(cpu_set),
+                                    &cpu_set) == 0);
+#endif
+
+    if (!result)
+    {
+        LOG_ERROR("Could not pin thread [%d] to CPU core [%d]",
+                  system_threads_get_thread_id(),
+                  n_cpu_core);
+    }
+
+    return result;
+}
+
 /** Please see header for specification */
 PUBLIC EMERALD_API system_thread_id system_threads_spawn(PFNSYSTEMTHREADSENTRYPOINTPROC      callback_func,
                                                          system_threads_entry_point_argument callback_func_argument,
@@ -211,20 +267,33 @@ PUBLIC EMERALD_API system_thread_id system_threads_spawn(PFNSYSTEMTHREADSENTRYPO
 
         if (thread_ptr != NULL)
         {
+            system_event thread_kill_event = NULL;
+
             thread_ptr->callback_func          = callback_func;
             thread_ptr->callback_func_argument = callback_func_argument;
 
-            /* Spawn the thread. */
+            /* Spawn the thread.
+             *
+             * The thread unregisters itself from the active threads vector when it quits, which may
+             * happen before the spawn call returns. Registration is therefore done under the vector's
+             * critical section, which the thread will not get hold of until the handle is stored. */
 #ifdef _WIN32
-            thread_ptr->thread_handle = ::CreateThread(NULL,                                /* no security attribs */
-                                                       0,                                   /* default stack size */
-                                                      &_system_threads_entry_point_wrapper,
-                                                       thread_ptr,
-                                                       0,                                   /* run immediately after creation */
-                                                      &thread_ptr->thread_id);
-
-            ASSERT_ALWAYS_SYNC(thread_ptr->thread_handle != NULL,
-                               "Could not create a new thread");
+            system_critical_section_enter(active_threads_vector_cs);
+            {
+                thread_ptr->thread_handle = ::CreateThread(NULL,                                /* no security attribs */
+                                                           0,                                   /* default stack size */
+                                                          &_system_threads_entry_point_wrapper,
+                                                           thread_ptr,
+                                                           0,                                   /* run immediately after creation */
+                                                          &thread_ptr->thread_id);
+
+                ASSERT_ALWAYS_SYNC(thread_ptr->thread_handle != NULL,
+                                   "Could not create a new thread");
+
+                system_resizable_vector_push(active_threads_vector,
+                                             (void*) thread_ptr->thread_handle);
+            }
+            system_critical_section_leave(active_threads_vector_cs);
 #else
             /* Instantiate a 'thread started' event we will use to wait until the newly spawned thread
              * submits its thread ID to the descriptor.
@@ -236,13 +305,30 @@ PUBLIC EMERALD_API system_thread_id system_threads_spawn(PFNSYSTEMTHREADSENTRYPO
             ASSERT_DEBUG_SYNC(thread_ptr->thread_id_submitted_event != NULL,
                               "Could not create 'thread ID submitted' event");
 
-            int creation_result = pthread_create(&thread_ptr->thread_handle,
-                                                  NULL,
-                                                  _system_threads_entry_point_wrapper,
-                                                  thread_ptr);
+            #ifdef USE_FUTEX_EVENTS
+            {
+                /* The thread signals the wait event on its own when it quits, so the event needs to
+                 * be created before the thread starts running. */
+                thread_ptr->kill_event = (thread_wait_event != NULL) ? _system_event_create_for_spawned_thread()
+                                                                     : NULL;
+                thread_kill_event      = thread_ptr->kill_event;
+            }
+            #endif
 
-            ASSERT_ALWAYS_SYNC(creation_result == 0,
-                               "Could not create a new thread");
+            system_critical_section_enter(active_threads_vector_cs);
+            {
+                int creation_result = pthread_create(&thread_ptr->thread_handle,
+                                                      NULL,
+                                                      _system_threads_entry_point_wrapper,
+                                                      thread_ptr);
+
+                ASSERT_ALWAYS_SYNC(creation_result == 0,
+                                   "Could not create a new thread");
+
+                system_resizable_vector_push(active_threads_vector,
+                                             (void*) thread_ptr->thread_handle);
+            }
+            system_critical_section_leave(active_threads_vector_cs);
 
             system_event_wait_single(thread_ptr->thread_id_submitted_event);
 
@@ -257,15 +343,29 @@ PUBLIC EMERALD_API system_thread_id system_threads_spawn(PFNSYSTEMTHREADSENTRYPO
                 *out_thread_ptr = thread_ptr->thread_handle;
             }
 
-            if (thread_wait_event != NULL)
+            #ifdef USE_FUTEX_EVENTS
             {
-                *thread_wait_event     = system_event_create_from_thread(thread_ptr->thread_handle);
-                thread_ptr->kill_event = *thread_wait_event;
+                if (thread_wait_event != NULL)
+                {
+                    *thread_wait_event = thread_kill_event;
+
+                    _system_event_set_spawned_thread(thread_kill_event,
+                                                     thread_ptr->thread_handle);
+                }
             }
-            else
+            #else
             {
-                thread_ptr->kill_event = NULL;
+                if (thread_wait_event != NULL)
+                {
+                    *thread_wait_event     = system_event_create_from_thread(thread_ptr->thread_handle);
+                    thread_ptr->kill_event = *thread_wait_event;
+                }
+                else
+                {
+                    thread_ptr->kill_event = NULL;
+                }
             }
+            #endif
 
             /* Assign a name to the thread, if one has been provided by the caller. */
             if (thread_name != NULL)
@@ -303,14 +403,6 @@ PUBLIC EMERALD_API system_thread_id system_threads_spawn(PFNSYSTEMTHREADSENTRYPO
                 }
                 #endif
             } /* if (thread_name != NULL) */
-
-            system_critical_section_enter(active_threads_vector_cs);
-            {
-                system_resizable_vector_push(active_threads_vector,
-                                             (void*) thread_ptr->thread_handle);
-            }
-            system_critical_section_leave(active_threads_vector_cs);
-
         } /* if (thread_ptr != NULL) */
     }
 
@@ -326,7 +418,7 @@ PUBLIC void system_threads_yield()
     }
     #else
     {
-        todo;
+        sched_yield();
     }
     #endif
 }
@@ -123,6 +123,34 @@ PUBLIC EMERALD_API system_time system_time_now()
     return result;
 }
 
+/** Please see header for specification */
+PUBLIC EMERALD_API __uint64 system_time_now_usec()
+{
+    __uint64 result = 0;
+
+#ifdef _WIN32
+    LARGE_INTEGER current_time = {0, 0};
+
+    if (::QueryPerformanceCounter(&current_time) == FALSE)
+    {
+        LOG_FATAL("Could not obtain performance counter information.");
+    }
+    else
+    {
+        result = (__uint64) ((current_time.QuadPart - start_time.QuadPart) * 1000000LL /* SEC_TO_USEC */ / time_frequency.QuadPart);
+    }
+#else
+    struct timespec current_timespec;
+
+    clock_gettime(CLOCK_MONOTONIC,
+                 &current_timespec);
+
+    result = (__uint64) (1000000LL /* SEC_TO_USEC */ * current_timespec.tv_sec + current_timespec.tv_nsec / 1000LL /* USEC_TO_NSEC */ - start_time_msec * 1000LL /* MSEC_TO_USEC */);
+#endif
+
+    return result;
+}
+
 /** Please see header for specificaton */
 PUBLIC void _system_time_init()
 {
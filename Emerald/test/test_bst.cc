@@ -0,0 +1,293 @@
+/**
+ *
+ * Emerald (kbi/elude @2012-2015)
+ *
+ */
+#include "test_bst.h"
+#include "gtest/gtest.h"
+#include "shared.h"
+#include "system/system_bst.h"
+#include "system/system_log.h"
+#include "system/system_time.h"
+#include <map>
+
+#define N_RANDOM_OPERATIONS (100000)
+
+
+PRIVATE bool _is_uint32_key_equal(size_t key_size,
+                                  void*  key1,
+                                  void*  key2)
+{
+    return *(uint32_t*) key1 == *(uint32_t*) key2;
+}
+
+PRIVATE bool _is_uint32_key_lower(size_t key_size,
+                                  void*  key1,
+                                  void*  key2)
+{
+    return *(uint32_t*) key1 < *(uint32_t*) key2;
+}
+
+/** Fills @param out_key with position of n-th vertex of a regular grid. Vertices are generated in
+ *  the order in which exporters tend to emit them, which makes the keys sorted. */
+PRIVATE void _get_grid_vertex(uint32_t n_vertex,
+                              float*   out_key)
+{
+    out_key[0] = float(n_vertex / 1024);
+    out_key[1] = float(n_vertex % 1024);
+    out_key[2] = 0.5f;
+}
+
+/** Checks that @param bst stores the same key->value pairs as @param reference_map. */
+PRIVATE void _verify_bst_contents(system_bst                          bst,
+                                  const std::map<uint32_t, uint32_t>& reference_map,
+                                  uint32_t                            max_key)
+{
+    for (uint32_t key = 0;
+                  key < max_key;
+                ++key)
+    {
+        std::map<uint32_t, uint32_t>::const_iterator reference_iterator = reference_map.find(key);
+        uint32_t                                     value              = 0;
+
+        ASSERT_EQ(system_bst_get(bst,
+                                 (system_bst_key)    &key,
+                                 (system_bst_value*) &value),
+                  reference_iterator != reference_map.end() );
+
+        if (reference_iterator != reference_map.end() )
+        {
+            ASSERT_EQ(value,
+                      reference_iterator->second);
+        }
+    }
+}
+
+
+/* Inserts keys in ascending & descending order, which used to degenerate the tree into a list */
+TEST(BSTTest, SortedInsertions)
+{
+    const uint32_t n_keys = 10000;
+
+    for (uint32_t n_iteration = 0;
+                  n_iteration < 2;
+                ++n_iteration)
+    {
+        const bool                   is_ascending = (n_iteration == 0);
+        std::map<uint32_t, uint32_t> reference_map;
+        system_bst                   bst          = NULL;
+
+        for (uint32_t n_key = 0;
+                      n_key < n_keys;
+                    ++n_key)
+        {
+            uint32_t key   = (is_ascending) ? (n_key * 2) : (2 * (n_keys - 1 - n_key) );
+            uint32_t value = n_key;
+
+            if (bst == NULL)
+            {
+                bst = system_bst_create_for_key_type(SYSTEM_BST_KEY_TYPE_UINT32_ARRAY,
+                                                     sizeof(uint32_t),
+                                                     sizeof(uint32_t),
+                                                     (system_bst_key)   &key,
+                                                     (system_bst_value) &value);
+            }
+            else
+            {
+                system_bst_insert(bst,
+                                  (system_bst_key)   &key,
+                                  (system_bst_value) &value);
+            }
+
+            reference_map[key] = value;
+        }
+
+        _verify_bst_contents(bst,
+                             reference_map,
+                             n_keys * 2 + 1);
+
+        system_bst_release(bst);
+    }
+}
+
+/* Inserts random keys into BSTs using both built-in and custom comparison functions and compares
+ * the outcome against std::map */
+TEST(BSTTest, RandomInsertions)
+{
+    uint32_t                     initial_key    = 0;
+    uint32_t                     initial_value  = 0;
+    system_bst                   bst_custom     = system_bst_create             (sizeof(uint32_t),
+                                                                                 sizeof(uint32_t),
+                                                                                 _is_uint32_key_lower,
+                                                                                 _is_uint32_key_equal,
+                                                                                 (system_bst_key)   &initial_key,
+                                                                                 (system_bst_value) &initial_value);
+    system_bst                   bst_typed      = system_bst_create_for_key_type(SYSTEM_BST_KEY_TYPE_UINT32_ARRAY,
+                                                                                 sizeof(uint32_t),
+                                                                                 sizeof(uint32_t),
+                                                                                 (system_bst_key)   &initial_key,
+                                                                                 (system_bst_value) &initial_value);
+    std::map<uint32_t, uint32_t> reference_map;
+
+    reference_map[initial_key] = initial_value;
+
+    srand(0x4321);
+
+    for (uint32_t n_operation = 0;
+                  n_operation < N_RANDOM_OPERATIONS;
+                ++n_operation)
+    {
+        uint32_t key   = rand() % (N_RANDOM_OPERATIONS * 2);
+        uint32_t value = n_operation;
+
+        system_bst_insert(bst_custom,
+                          (system_bst_key)   &key,
+                          (system_bst_value) &value);
+        system_bst_insert(bst_typed,
+                          (system_bst_key)   &key,
+                          (system_bst_value) &value);
+
+        /* Values of keys which are already stored are not overwritten */
+        if (reference_map.find(key) == reference_map.end() )
+        {
+            reference_map[key] = value;
+        }
+    }
+
+    _verify_bst_contents(bst_custom,
+                         reference_map,
+                         N_RANDOM_OPERATIONS * 2);
+    _verify_bst_contents(bst_typed,
+                         reference_map,
+                         N_RANDOM_OPERATIONS * 2);
+
+    system_bst_release(bst_custom);
+    system_bst_release(bst_typed);
+}
+
+/* Uses the BST for vertex welding, the way mesh does */
+TEST(BSTTest, FloatArrayKeys)
+{
+    const float vertices[][3] =
+    {
+        {0.0f,  0.0f, 0.0f},
+        {1.0f,  0.0f, 0.0f},
+        {0.0f,  1.0f, 0.0f},
+        {1.0f,  0.0f, 0.0f},
+        {0.0f,  0.0f, 1.0f},
+        {-1.0f, 0.0f, 0.0f},
+        {0.0f,  1.0f, 0.0f},
+        {-0.0f, 0.0f, 0.0f},
+    };
+    const uint32_t expected_vertex_ids[] =
+    {
+        0, 1, 2, 1, 3, 4, 2, 0
+    };
+    const uint32_t n_vertices            = sizeof(vertices) / sizeof(vertices[0]);
+    uint32_t       n_unique_vertices     = 0;
+    system_bst     bst                   = system_bst_create_for_key_type(SYSTEM_BST_KEY_TYPE_FLOAT_ARRAY,
+                                                                          sizeof(float) * 3,
+                                                                          sizeof(uint32_t),
+                                                                          (system_bst_key)   vertices[0],
+                                                                          (system_bst_value) &n_unique_vertices);
+
+    n_unique_vertices++;
+
+    for (uint32_t n_vertex = 0;
+                  n_vertex < n_vertices;
+                ++n_vertex)
+    {
+        uint32_t vertex_id = 0;
+
+        if (!system_bst_get(bst,
+                            (system_bst_key)    vertices[n_vertex],
+                            (system_bst_value*) &vertex_id) )
+        {
+            vertex_id = n_unique_vertices++;
+
+            system_bst_insert(bst,
+                              (system_bst_key)   vertices[n_vertex],
+                              (system_bst_value) &vertex_id);
+        }
+
+        ASSERT_EQ(vertex_id,
+                  expected_vertex_ids[n_vertex]);
+    }
+
+    ASSERT_EQ(n_unique_vertices,
+              5);
+
+    system_bst_release(bst);
+}
+
+/* Welds vertices of a regular grid, emitted in sorted order, which is the worst case for an unbalanced tree.
+ * Disabled by default, since it takes a while to complete. Run with --gtest_also_run_disabled_tests. */
+TEST(BSTTest, DISABLED_SortedInputBenchmark)
+{
+    const uint32_t n_entries_array[] =
+    {
+        1000,
+        10000,
+        100000,
+        1000000
+    };
+    const uint32_t n_entries_array_size = sizeof(n_entries_array) / sizeof(n_entries_array[0]);
+
+    for (uint32_t n_size = 0;
+                  n_size < n_entries_array_size;
+                ++n_size)
+    {
+        const uint32_t n_entries  = n_entries_array[n_size];
+        float          key[3];
+        uint32_t       n_found    = 0;
+        __uint64       time_start = 0;
+        __uint64       time_total = 0;
+        system_bst     tree       = NULL;
+        uint32_t       value      = 0;
+
+        /* Each vertex is looked up before it gets inserted and then looked up again, as if it was shared
+         * by two triangles. */
+        time_start = system_time_now_usec();
+        {
+            for (uint32_t n_vertex = 0;
+                          n_vertex < n_entries;
+                        ++n_vertex)
+            {
+                _get_grid_vertex(n_vertex,
+                                 key);
+
+                if (tree == NULL)
+                {
+                    tree = system_bst_create_for_key_type(SYSTEM_BST_KEY_TYPE_FLOAT_ARRAY,
+                                                          sizeof(key),
+                                                          sizeof(uint32_t),
+                                                          (system_bst_key)   key,
+                                                          (system_bst_value) &n_vertex);
+                }
+                else
+                if (!system_bst_get(tree,
+                                    (system_bst_key)    key,
+                                    (system_bst_value*) &value) )
+                {
+                    system_bst_insert(tree,
+                                      (system_bst_key)   key,
+                                      (system_bst_value) &n_vertex);
+                }
+
+                n_found += system_bst_get(tree,
+                                          (system_bst_key)    key,
+                                          (system_bst_value*) &value) ? 1 : 0;
+            }
+        }
+        time_total = system_time_now_usec() - time_start;
+
+        ASSERT_EQ(n_found,
+                  n_entries);
+
+        LOG_INFO("[%8u sorted vertices] ns per vertex: %10.1f",
+                 n_entries,
+                 double(time_total) * 1000.0 / n_entries);
+
+        system_bst_release(tree);
+    }
+}
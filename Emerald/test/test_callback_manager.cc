@@ -0,0 +1,478 @@
+/**
+ *
+ * Emerald (kbi/elude @2016)
+ *
+ */
+#include "test_callback_manager.h"
+#include "gtest/gtest.h"
+#include "shared.h"
+#include "system/system_atomics.h"
+#include "system/system_callback_manager.h"
+#include "system/system_event.h"
+#include "system/system_hashed_ansi_string.h"
+#include "system/system_log.h"
+#include "system/system_thread_pool.h"
+#include "system/system_threads.h"
+#include "system/system_time.h"
+#include <vector>
+
+#define BENCHMARK_N_CALLS     (1000000)
+#define BENCHMARK_N_THREADS   (4)
+#define N_CHURN_ITERATIONS    (2000)
+#define N_SUBSCRIBERS         (8)
+#define TEST_CALLBACK_ID      ( (_callback_id) 0)
+#define TEST_MAX_CALLBACK_ID  ( (_callback_id) 1)
+
+
+typedef struct
+{
+    volatile unsigned int n_calls;
+    volatile __uint64     payload_sum;
+} subscriber_data;
+
+typedef struct
+{
+    system_callback_manager callback_manager;
+    unsigned int            n_calls_per_thread;
+    system_event            start_event;
+} thread_test_data;
+
+
+/** Counts call-backs & sums up the payloads they carry */
+PRIVATE void _on_callback(const void* callback_data,
+                          void*       user_arg)
+{
+    subscriber_data* data_ptr = (subscriber_data*) user_arg;
+    __uint64         payload  = (callback_data != nullptr) ? (__uint64) *(void* const*) callback_data
+                                                           : 0;
+
+    system_atomics_increment(&data_ptr->n_calls);
+
+    while (true)
+    {
+        const __uint64 current_sum = data_ptr->payload_sum;
+
+        if (system_atomics_compare_exchange_uint64(&data_ptr->payload_sum,
+                                                   current_sum,
+                                                   current_sum + payload) )
+        {
+            break;
+        }
+    }
+}
+
+/** Cancels its own subscription */
+PRIVATE void _on_callback_unsubscribe(const void* callback_data,
+                                      void*       user_arg)
+{
+    system_callback_manager callback_manager = (system_callback_manager) user_arg;
+
+    system_callback_manager_unsubscribe_from_callbacks(callback_manager,
+                                                       TEST_CALLBACK_ID,
+                                                       _on_callback_unsubscribe,
+                                                       user_arg);
+}
+
+/** Blocks a thread pool worker until the event passed as the argument is set */
+PRIVATE volatile void _on_blocking_task(system_thread_pool_callback_argument arg)
+{
+    system_event_wait_single( (system_event) arg);
+}
+
+/** Issues the requested number of call-backs */
+PRIVATE void _thread_entrypoint(system_threads_entry_point_argument arg)
+{
+    thread_test_data* data_ptr = (thread_test_data*) arg;
+
+    system_event_wait_single(data_ptr->start_event);
+
+    for (unsigned int n_call = 0;
+                      n_call < data_ptr->n_calls_per_thread;
+                    ++n_call)
+    {
+        void* payload = (void*) (size_t) 1;
+
+        system_callback_manager_call_back(data_ptr->callback_manager,
+                                          TEST_CALLBACK_ID,
+                                         &payload);
+    }
+}
+
+/** Spawns @param n_threads threads issuing call-backs and waits until they quit. */
+PRIVATE void _run_threads(thread_test_data* data_ptr,
+                          unsigned int      n_threads)
+{
+    std::vector<system_event> thread_wait_events(n_threads);
+
+    data_ptr->start_event = system_event_create(true); /* manual_reset */
+
+    for (unsigned int n_thread = 0;
+                      n_thread < n_threads;
+                    ++n_thread)
+    {
+        system_threads_spawn(_thread_entrypoint,
+                             data_ptr,
+                            &thread_wait_events[n_thread],
+                             system_hashed_ansi_string_create("Callback manager test thread") );
+    }
+
+    system_event_set(data_ptr->start_event);
+
+    system_event_wait_multiple(&thread_wait_events[0],
+                               n_threads,
+                               true, /* wait_on_all_objects */
+                               SYSTEM_TIME_INFINITE,
+                               NULL); /* out_result_ptr */
+
+    system_event_release(data_ptr->start_event);
+}
+
+/** Waits until @param n_calls call-backs have been received by @param data_ptr */
+PRIVATE void _wait_for_calls(const subscriber_data* data_ptr,
+                             unsigned int           n_calls)
+{
+    const __uint64 timeout_usec = system_time_now_usec() + 10000000; /* 10 s */
+
+    while (data_ptr->n_calls < n_calls        &&
+           system_time_now_usec() < timeout_usec)
+    {
+        system_threads_yield();
+    }
+}
+
+/** Returns the value of a __uint64 callback property */
+PRIVATE __uint64 _get_counter(system_callback_manager                   callback_manager,
+                              system_callback_manager_callback_property property)
+{
+    __uint64 result = 0;
+
+    system_callback_manager_get_callback_property(callback_manager,
+                                                  TEST_CALLBACK_ID,
+                                                  property,
+                                                 &result);
+
+    return result;
+}
+
+
+TEST(CallbackManagerTest, AsyncSubscribersShareASingleDispatch)
+{
+    system_callback_manager callback_manager = system_callback_manager_create(TEST_MAX_CALLBACK_ID);
+    void*                   payload          = (void*) (size_t) 7;
+    subscriber_data         subscribers[N_SUBSCRIBERS];
+
+    for (unsigned int n_subscriber = 0;
+                      n_subscriber < N_SUBSCRIBERS;
+                    ++n_subscriber)
+    {
+        subscribers[n_subscriber].n_calls     = 0;
+        subscribers[n_subscriber].payload_sum = 0;
+
+        system_callback_manager_subscribe_for_callbacks(callback_manager,
+                                                        TEST_CALLBACK_ID,
+                                                        CALLBACK_SYNCHRONICITY_ASYNCHRONOUS,
+                                                        _on_callback,
+                                                        subscribers + n_subscriber);
+    }
+
+    system_callback_manager_call_back(callback_manager,
+                                      TEST_CALLBACK_ID,
+                                     &payload);
+
+    /* Make sure the payload was captured at call-back time */
+    payload = nullptr;
+
+    for (unsigned int n_subscriber = 0;
+                      n_subscriber < N_SUBSCRIBERS;
+                    ++n_subscriber)
+    {
+        _wait_for_calls(subscribers + n_subscriber,
+                        1);
+
+        ASSERT_EQ(subscribers[n_subscriber].n_calls,
+                  1);
+        ASSERT_EQ(subscribers[n_subscriber].payload_sum,
+                  7);
+    }
+
+    ASSERT_EQ(_get_counter(callback_manager,
+                           SYSTEM_CALLBACK_MANAGER_CALLBACK_PROPERTY_N_ASYNC_DISPATCHES),
+              1);
+    ASSERT_EQ(_get_counter(callback_manager,
+                           SYSTEM_CALLBACK_MANAGER_CALLBACK_PROPERTY_N_ASYNC_INVOCATIONS),
+              N_SUBSCRIBERS);
+    ASSERT_EQ(_get_counter(callback_manager,
+                           SYSTEM_CALLBACK_MANAGER_CALLBACK_PROPERTY_N_CALLS),
+              1);
+
+    for (unsigned int n_subscriber = 0;
+                      n_subscriber < N_SUBSCRIBERS;
+                    ++n_subscriber)
+    {
+        system_callback_manager_unsubscribe_from_callbacks(callback_manager,
+                                                           TEST_CALLBACK_ID,
+                                                           _on_callback,
+                                                           subscribers + n_subscriber);
+    }
+
+    system_callback_manager_release(callback_manager);
+}
+
+TEST(CallbackManagerTest, IdenticalAsyncCallsAreCoalesced)
+{
+    system_event            blocking_event   = system_event_create(true); /* manual_reset */
+    system_callback_manager callback_manager = system_callback_manager_create(TEST_MAX_CALLBACK_ID);
+    const bool              coalesce         = true;
+    unsigned int            n_workers        = 0;
+    subscriber_data         subscriber;
+
+    subscriber.n_calls     = 0;
+    subscriber.payload_sum = 0;
+
+    system_callback_manager_set_callback_property  (callback_manager,
+                                                    TEST_CALLBACK_ID,
+                                                    SYSTEM_CALLBACK_MANAGER_CALLBACK_PROPERTY_COALESCE_ASYNC_CALLS,
+                                                   &coalesce);
+    system_callback_manager_subscribe_for_callbacks(callback_manager,
+                                                    TEST_CALLBACK_ID,
+                                                    CALLBACK_SYNCHRONICITY_ASYNCHRONOUS,
+                                                    _on_callback,
+                                                   &subscriber);
+
+    /* Keep all thread pool workers busy, so that the dispatches stay pending */
+    system_thread_pool_get_property(SYSTEM_THREAD_POOL_PROPERTY_N_WORKERS,
+                                   &n_workers);
+
+    for (unsigned int n_worker = 0;
+                      n_worker < n_workers;
+                    ++n_worker)
+    {
+        system_thread_pool_submit_single_task(system_thread_pool_create_task_handler_only(THREAD_POOL_TASK_PRIORITY_NORMAL,
+                                                                                          _on_blocking_task,
+                                                                                          blocking_event) );
+    }
+
+    for (unsigned int n_call = 0;
+                      n_call < 5;
+                    ++n_call)
+    {
+        void* payload = (void*) (size_t) 1;
+
+        system_callback_manager_call_back(callback_manager,
+                                          TEST_CALLBACK_ID,
+                                         &payload);
+    }
+
+    {
+        void* payload = (void*) (size_t) 100;
+
+        system_callback_manager_call_back(callback_manager,
+                                          TEST_CALLBACK_ID,
+                                         &payload);
+    }
+
+    system_event_set(blocking_event);
+
+    _wait_for_calls(&subscriber,
+                    2);
+
+    ASSERT_EQ(subscriber.n_calls,
+              2);
+    ASSERT_EQ(subscriber.payload_sum,
+              101);
+    ASSERT_EQ(_get_counter(callback_manager,
+                           SYSTEM_CALLBACK_MANAGER_CALLBACK_PROPERTY_N_COALESCED_CALLS),
+              4);
+    ASSERT_EQ(_get_counter(callback_manager,
+                           SYSTEM_CALLBACK_MANAGER_CALLBACK_PROPERTY_N_ASYNC_DISPATCHES),
+              2);
+
+    /* Once a dispatch has started executing, an identical notification must be delivered again */
+    {
+        void* payload = (void*) (size_t) 1;
+
+        system_callback_manager_call_back(callback_manager,
+                                          TEST_CALLBACK_ID,
+                                         &payload);
+    }
+
+    _wait_for_calls(&subscriber,
+                    3);
+
+    ASSERT_EQ(subscriber.n_calls,
+              3);
+
+    system_callback_manager_unsubscribe_from_callbacks(callback_manager,
+                                                       TEST_CALLBACK_ID,
+                                                       _on_callback,
+                                                      &subscriber);
+    system_callback_manager_release                   (callback_manager);
+    system_event_release                              (blocking_event);
+}
+
+TEST(CallbackManagerTest, SubscriptionsCanBeCancelledFromWithinCallbacks)
+{
+    system_callback_manager callback_manager = system_callback_manager_create(TEST_MAX_CALLBACK_ID);
+    subscriber_data         subscriber;
+
+    subscriber.n_calls     = 0;
+    subscriber.payload_sum = 0;
+
+    system_callback_manager_subscribe_for_callbacks(callback_manager,
+                                                    TEST_CALLBACK_ID,
+                                                    CALLBACK_SYNCHRONICITY_SYNCHRONOUS,
+                                                    _on_callback_unsubscribe,
+                                                    callback_manager);
+    system_callback_manager_subscribe_for_callbacks(callback_manager,
+                                                    TEST_CALLBACK_ID,
+                                                    CALLBACK_SYNCHRONICITY_SYNCHRONOUS,
+                                                    _on_callback,
+                                                   &subscriber);
+
+    /* The first call-back cancels the first subscription, but the call must still reach the other subscriber */
+    system_callback_manager_call_back(callback_manager,
+                                      TEST_CALLBACK_ID,
+                                      nullptr);
+    system_callback_manager_call_back(callback_manager,
+                                      TEST_CALLBACK_ID,
+                                      nullptr);
+
+    ASSERT_EQ(subscriber.n_calls,
+              2);
+    ASSERT_EQ(_get_counter(callback_manager,
+                           SYSTEM_CALLBACK_MANAGER_CALLBACK_PROPERTY_N_SYNC_INVOCATIONS),
+              3);
+
+    system_callback_manager_unsubscribe_from_callbacks(callback_manager,
+                                                       TEST_CALLBACK_ID,
+                                                       _on_callback,
+                                                      &subscriber);
+    system_callback_manager_release                   (callback_manager);
+}
+
+TEST(CallbackManagerTest, SubscriptionsCanChangeWhileCallingBack)
+{
+    system_callback_manager callback_manager = system_callback_manager_create(TEST_MAX_CALLBACK_ID);
+    subscriber_data         churn_subscriber;
+    thread_test_data        data;
+    subscriber_data         subscriber;
+    system_event            thread_wait_event;
+
+    churn_subscriber.n_calls     = 0;
+    churn_subscriber.payload_sum = 0;
+    subscriber.n_calls           = 0;
+    subscriber.payload_sum       = 0;
+
+    system_callback_manager_subscribe_for_callbacks(callback_manager,
+                                                    TEST_CALLBACK_ID,
+                                                    CALLBACK_SYNCHRONICITY_SYNCHRONOUS,
+                                                    _on_callback,
+                                                   &subscriber);
+
+    data.callback_manager   = callback_manager;
+    data.n_calls_per_thread = N_CHURN_ITERATIONS * 10;
+    data.start_event        = system_event_create(true); /* manual_reset */
+
+    system_threads_spawn(_thread_entrypoint,
+                        &data,
+                        &thread_wait_event,
+                         system_hashed_ansi_string_create("Callback manager test thread") );
+
+    system_event_set(data.start_event);
+
+    for (unsigned int n_iteration = 0;
+                      n_iteration < N_CHURN_ITERATIONS;
+                    ++n_iteration)
+    {
+        system_callback_manager_subscribe_for_callbacks   (callback_manager,
+                                                           TEST_CALLBACK_ID,
+                                                           (n_iteration % 2) ? CALLBACK_SYNCHRONICITY_SYNCHRONOUS
+                                                                             : CALLBACK_SYNCHRONICITY_ASYNCHRONOUS,
+                                                           _on_callback,
+                                                          &churn_subscriber);
+        system_callback_manager_unsubscribe_from_callbacks(callback_manager,
+                                                           TEST_CALLBACK_ID,
+                                                           _on_callback,
+                                                          &churn_subscriber);
+    }
+
+    system_event_wait_single(thread_wait_event);
+    system_event_release    (data.start_event);
+
+    /* The permanent subscriber must have been called back exactly once per call */
+    ASSERT_EQ(subscriber.n_calls,
+              N_CHURN_ITERATIONS * 10);
+    ASSERT_EQ(subscriber.payload_sum,
+              N_CHURN_ITERATIONS * 10);
+
+    system_callback_manager_unsubscribe_from_callbacks(callback_manager,
+                                                       TEST_CALLBACK_ID,
+                                                       _on_callback,
+                                                      &subscriber);
+    system_callback_manager_release                   (callback_manager);
+}
+
+TEST(CallbackManagerTest, DISABLED_CallBackBenchmark)
+{
+    thread_test_data data;
+    __uint64         duration_usec;
+    __uint64         n_async_dispatches;
+    __uint64         n_coalesced_calls;
+    __uint64         start_time_usec;
+    subscriber_data  subscribers[N_SUBSCRIBERS];
+    const bool       coalesce = true;
+
+    data.callback_manager   = system_callback_manager_create(TEST_MAX_CALLBACK_ID);
+    data.n_calls_per_thread = BENCHMARK_N_CALLS / BENCHMARK_N_THREADS;
+
+    system_callback_manager_set_callback_property(data.callback_manager,
+                                                  TEST_CALLBACK_ID,
+                                                  SYSTEM_CALLBACK_MANAGER_CALLBACK_PROPERTY_COALESCE_ASYNC_CALLS,
+                                                 &coalesce);
+
+    /* Mimic a typical notification: a few synchronous subscribers and a few asynchronous ones */
+    for (unsigned int n_subscriber = 0;
+                      n_subscriber < N_SUBSCRIBERS;
+                    ++n_subscriber)
+    {
+        subscribers[n_subscriber].n_calls     = 0;
+        subscribers[n_subscriber].payload_sum = 0;
+
+        system_callback_manager_subscribe_for_callbacks(data.callback_manager,
+                                                        TEST_CALLBACK_ID,
+                                                        (n_subscriber % 2) ? CALLBACK_SYNCHRONICITY_SYNCHRONOUS
+                                                                           : CALLBACK_SYNCHRONICITY_ASYNCHRONOUS,
+                                                        _on_callback,
+                                                        subscribers + n_subscriber);
+    }
+
+    start_time_usec = system_time_now_usec();
+    {
+        _run_threads(&data,
+                     BENCHMARK_N_THREADS);
+    }
+    duration_usec = system_time_now_usec() - start_time_usec;
+
+    n_async_dispatches = _get_counter(data.callback_manager,
+                                      SYSTEM_CALLBACK_MANAGER_CALLBACK_PROPERTY_N_ASYNC_DISPATCHES);
+    n_coalesced_calls  = _get_counter(data.callback_manager,
+                                      SYSTEM_CALLBACK_MANAGER_CALLBACK_PROPERTY_N_COALESCED_CALLS);
+
+    LOG_INFO("Call-backs per second on [%d] threads: %12.0f (async dispatches: %llu, coalesced: %llu)",
+             BENCHMARK_N_THREADS,
+             double(BENCHMARK_N_CALLS) * 1000000.0 / double(duration_usec + 1),
+             n_async_dispatches,
+             n_coalesced_calls);
+
+    for (unsigned int n_subscriber = 0;
+                      n_subscriber < N_SUBSCRIBERS;
+                    ++n_subscriber)
+    {
+        system_callback_manager_unsubscribe_from_callbacks(data.callback_manager,
+                                                           TEST_CALLBACK_ID,
+                                                           _on_callback,
+                                                           subscribers + n_subscriber);
+    }
+
+    system_callback_manager_release(data.callback_manager);
+}
@@ -0,0 +1,529 @@
+/**
+ *
+ * Emerald (kbi/elude @2014-2016)
+ *
+ */
+#include "test_dag.h"
+#include "gtest/gtest.h"
+#include "shared.h"
+#include "system/system_dag.h"
+#include "system/system_log.h"
+#include "system/system_resizable_vector.h"
+#include "system/system_time.h"
+#include <algorithm>
+#include <atomic>
+#include <vector>
+
+#define N_BENCHMARK_EDITS (1000)
+#define N_EDITS           (2000)
+#define N_NODES           (500)
+
+
+typedef struct
+{
+    uint32_t src;
+    uint32_t dst;
+} test_edge;
+
+typedef struct
+{
+    std::vector<std::vector<uint32_t> >* incoming_nodes;
+    std::atomic<uint32_t>                n_errors;
+    std::vector<std::atomic<bool> >*     processed_nodes;
+} test_process_by_level_data;
+
+
+/** Returns a random edge which does not violate the order defined by @param hidden_order. */
+PRIVATE test_edge get_random_dag_edge(const std::vector<uint32_t>& hidden_order)
+{
+    test_edge      result;
+    const uint32_t n_nodes = (uint32_t) hidden_order.size();
+
+    do
+    {
+        result.src = rand() % n_nodes;
+        result.dst = rand() % n_nodes;
+    }
+    while (result.src == result.dst);
+
+    if (hidden_order[result.src] > hidden_order[result.dst])
+    {
+        std::swap(result.src,
+                  result.dst);
+    }
+
+    return result;
+}
+
+/** Creates a permutation of node indices, which defines the order random DAG edges are going to respect. */
+PRIVATE void get_hidden_order(uint32_t               n_nodes,
+                              std::vector<uint32_t>& result)
+{
+    result.resize(n_nodes);
+
+    for (uint32_t n_node = 0;
+                  n_node < n_nodes;
+                ++n_node)
+    {
+        result[n_node] = n_node;
+    }
+
+    for (uint32_t n_node = n_nodes - 1;
+                  n_node > 0;
+                --n_node)
+    {
+        std::swap(result[n_node],
+                  result[rand() % (n_node + 1)]);
+    }
+}
+
+/** Verifies that every edge points from a node placed earlier to a node placed later in the order
+ *  reported by the DAG, which must contain every node exactly once. */
+PRIVATE void verify_topological_order(system_dag                    dag,
+                                      uint32_t                      n_nodes,
+                                      const std::vector<test_edge>& edges)
+{
+    std::vector<uint32_t>   positions(n_nodes,
+                                      UINT32_MAX);
+    system_resizable_vector sorted_values   = system_resizable_vector_create(n_nodes);
+    uint32_t                n_sorted_values = 0;
+
+    ASSERT_TRUE(system_dag_get_topologically_sorted_node_values(dag,
+                                                                sorted_values) );
+
+    system_resizable_vector_get_property(sorted_values,
+                                         SYSTEM_RESIZABLE_VECTOR_PROPERTY_N_ELEMENTS,
+                                        &n_sorted_values);
+
+    ASSERT_EQ(n_sorted_values,
+              n_nodes);
+
+    for (uint32_t n_value = 0;
+                  n_value < n_sorted_values;
+                ++n_value)
+    {
+        system_dag_node_value value = nullptr;
+
+        system_resizable_vector_get_element_at(sorted_values,
+                                               n_value,
+                                              &value);
+
+        ASSERT_EQ(positions[(uint32_t) (intptr_t) value],
+                  UINT32_MAX);
+
+        positions[(uint32_t) (intptr_t) value] = n_value;
+    }
+
+    for (size_t n_edge = 0;
+                n_edge < edges.size();
+              ++n_edge)
+    {
+        ASSERT_LT(positions[edges[n_edge].src],
+                  positions[edges[n_edge].dst]);
+    }
+
+    system_resizable_vector_release(sorted_values);
+}
+
+PRIVATE void process_by_level_callback(system_dag_node_value value,
+                                       void*                 user_arg)
+{
+    test_process_by_level_data* data_ptr = (test_process_by_level_data*) user_arg;
+    const uint32_t              n_node   = (uint32_t) (intptr_t) value;
+
+    for (size_t n_incoming_node = 0;
+                n_incoming_node < (*data_ptr->incoming_nodes)[n_node].size();
+              ++n_incoming_node)
+    {
+        if (!(*data_ptr->processed_nodes)[(*data_ptr->incoming_nodes)[n_node][n_incoming_node] ])
+        {
+            data_ptr->n_errors++;
+        }
+    }
+
+    (*data_ptr->processed_nodes)[n_node] = true;
+}
+
+
+/* Builds a random DAG, solves it and then keeps on adding & removing connections. The topological order
+ * maintained by the DAG must stay valid after each modification. */
+TEST(DAGTest, IncrementalTopologicalOrder)
+{
+    std::vector<system_dag_connection> connections;
+    system_dag                         dag = system_dag_create();
+    std::vector<test_edge>             edges;
+    std::vector<uint32_t>              hidden_order;
+    std::vector<system_dag_node>       nodes;
+
+    srand(0x1234);
+
+    get_hidden_order(N_NODES,
+                     hidden_order);
+
+    for (uint32_t n_node = 0;
+                  n_node < N_NODES;
+                ++n_node)
+    {
+        nodes.push_back(system_dag_add_node(dag,
+                                            (system_dag_node_value) (intptr_t) n_node) );
+    }
+
+    for (uint32_t n_edge = 0;
+                  n_edge < N_NODES;
+                ++n_edge)
+    {
+        const test_edge edge = get_random_dag_edge(hidden_order);
+
+        edges.push_back      (edge);
+        connections.push_back(system_dag_add_connection(dag,
+                                                        nodes[edge.src],
+                                                        nodes[edge.dst]) );
+    }
+
+    ASSERT_TRUE (system_dag_is_dirty(dag) );
+    ASSERT_TRUE (system_dag_solve   (dag) );
+    ASSERT_FALSE(system_dag_is_dirty(dag) );
+
+    verify_topological_order(dag,
+                             N_NODES,
+                             edges);
+
+    for (uint32_t n_edit = 0;
+                  n_edit < N_EDITS;
+                ++n_edit)
+    {
+        if (rand() % 3 == 0)
+        {
+            const uint32_t n_edge = rand() % edges.size();
+
+            system_dag_delete_connection(dag,
+                                         connections[n_edge]);
+
+            connections.erase(connections.begin() + n_edge);
+            edges.erase      (edges.begin()       + n_edge);
+        }
+        else
+        {
+            const test_edge edge = get_random_dag_edge(hidden_order);
+
+            edges.push_back      (edge);
+            connections.push_back(system_dag_add_connection(dag,
+                                                            nodes[edge.src],
+                                                            nodes[edge.dst]) );
+        }
+
+        ASSERT_FALSE(system_dag_is_dirty(dag) );
+
+        if ((n_edit % 100) == 0)
+        {
+            verify_topological_order(dag,
+                                     N_NODES,
+                                     edges);
+        }
+    }
+
+    verify_topological_order(dag,
+                             N_NODES,
+                             edges);
+
+    system_dag_release(dag);
+}
+
+/* A connection closing a cycle should mark the DAG as dirty. Once it is removed, the DAG should be solvable again. */
+TEST(DAGTest, CycleDetection)
+{
+    system_dag             dag = system_dag_create();
+    std::vector<test_edge> edges;
+    system_dag_node        nodes[4];
+
+    for (uint32_t n_node = 0;
+                  n_node < sizeof(nodes) / sizeof(nodes[0]);
+                ++n_node)
+    {
+        nodes[n_node] = system_dag_add_node(dag,
+                                            (system_dag_node_value) (intptr_t) n_node);
+    }
+
+    for (uint32_t n_node = 0;
+                  n_node < sizeof(nodes) / sizeof(nodes[0]) - 1;
+                ++n_node)
+    {
+        const test_edge edge = {n_node, n_node + 1};
+
+        edges.push_back(edge);
+
+        system_dag_add_connection(dag,
+                                  nodes[edge.src],
+                                  nodes[edge.dst]);
+    }
+
+    ASSERT_TRUE(system_dag_solve(dag) );
+
+    /* 3 -> 0 closes a cycle */
+    system_dag_connection cycle_connection = system_dag_add_connection(dag,
+                                                                       nodes[3],
+                                                                       nodes[0]);
+
+    ASSERT_TRUE(system_dag_is_dirty(dag) );
+
+    system_dag_delete_connection(dag,
+                                 cycle_connection);
+
+    ASSERT_TRUE (system_dag_solve   (dag) );
+    ASSERT_FALSE(system_dag_is_dirty(dag) );
+
+    verify_topological_order(dag,
+                             sizeof(nodes) / sizeof(nodes[0]),
+                             edges);
+
+    /* After 1 -> 2 is removed, 3 -> 1 does not close a cycle, but violates the current order. */
+    const test_edge edge = {3, 1};
+
+    system_dag_delete_connections(dag,
+                                  nodes[1],
+                                  nullptr);
+    system_dag_add_connection    (dag,
+                                  nodes[edge.src],
+                                  nodes[edge.dst]);
+
+    ASSERT_FALSE(system_dag_is_dirty(dag) );
+
+    edges.erase    (edges.begin() + 1);
+    edges.push_back(edge);
+
+    verify_topological_order(dag,
+                             sizeof(nodes) / sizeof(nodes[0]),
+                             edges);
+
+    system_dag_release(dag);
+}
+
+/* Verifies dependency levels, and checks that nodes are processed only after all nodes they depend on. */
+TEST(DAGTest, ProcessByLevel)
+{
+    system_dag                           dag = system_dag_create();
+    std::vector<uint32_t>                expected_levels(N_NODES, 0);
+    std::vector<uint32_t>                hidden_order;
+    std::vector<std::vector<uint32_t> >  incoming_nodes(N_NODES);
+    uint32_t                             n_expected_levels = 0;
+    uint32_t                             n_levels          = 0;
+    uint32_t                             n_level_values    = 0;
+    std::vector<system_dag_node>         nodes;
+    std::vector<uint32_t>                nodes_by_hidden_order(N_NODES);
+    std::vector<std::atomic<bool> >      processed_nodes(N_NODES);
+    test_process_by_level_data           process_data;
+    system_resizable_vector              values = system_resizable_vector_create(N_NODES);
+
+    srand(0x4321);
+
+    get_hidden_order(N_NODES,
+                     hidden_order);
+
+    for (uint32_t n_node = 0;
+                  n_node < N_NODES;
+                ++n_node)
+    {
+        nodes.push_back(system_dag_add_node(dag,
+                                            (system_dag_node_value) (intptr_t) n_node) );
+
+        nodes_by_hidden_order[hidden_order[n_node] ] = n_node;
+        processed_nodes      [n_node]                = false;
+    }
+
+    for (uint32_t n_edge = 0;
+                  n_edge < N_NODES * 2;
+                ++n_edge)
+    {
+        const test_edge edge = get_random_dag_edge(hidden_order);
+
+        incoming_nodes[edge.dst].push_back(edge.src);
+
+        system_dag_add_connection(dag,
+                                  nodes[edge.src],
+                                  nodes[edge.dst]);
+    }
+
+    /* Compute the expected levels, visiting the nodes in the hidden order */
+    for (uint32_t n_node = 0;
+                  n_node < N_NODES;
+                ++n_node)
+    {
+        const uint32_t node = nodes_by_hidden_order[n_node];
+
+        for (size_t n_incoming_node = 0;
+                    n_incoming_node < incoming_nodes[node].size();
+                  ++n_incoming_node)
+        {
+            expected_levels[node] = std::max(expected_levels[node],
+                                             expected_levels[incoming_nodes[node][n_incoming_node] ] + 1);
+        }
+
+        n_expected_levels = std::max(n_expected_levels,
+                                     expected_levels[node] + 1);
+    }
+
+    ASSERT_TRUE(system_dag_get_n_levels(dag,
+                                       &n_levels) );
+    ASSERT_EQ  (n_levels,
+                n_expected_levels);
+
+    for (uint32_t n_level = 0;
+                  n_level < n_levels;
+                ++n_level)
+    {
+        uint32_t n_values = 0;
+
+        ASSERT_TRUE(system_dag_get_level_node_values(dag,
+                                                     n_level,
+                                                     values) );
+
+        system_resizable_vector_get_property(values,
+                                             SYSTEM_RESIZABLE_VECTOR_PROPERTY_N_ELEMENTS,
+                                            &n_values);
+
+        for (uint32_t n_value = 0;
+                      n_value < n_values;
+                    ++n_value)
+        {
+            system_dag_node_value value = nullptr;
+
+            system_resizable_vector_get_element_at(values,
+                                                   n_value,
+                                                  &value);
+
+            ASSERT_EQ(expected_levels[(uint32_t) (intptr_t) value],
+                      n_level);
+        }
+
+        n_level_values += n_values;
+    }
+
+    ASSERT_EQ(n_level_values,
+              N_NODES);
+
+    process_data.incoming_nodes  = &incoming_nodes;
+    process_data.n_errors        = 0;
+    process_data.processed_nodes = &processed_nodes;
+
+    ASSERT_TRUE(system_dag_process_node_values_by_level(dag,
+                                                        process_by_level_callback,
+                                                       &process_data) );
+
+    ASSERT_EQ(process_data.n_errors.load(),
+              0u);
+
+    for (uint32_t n_node = 0;
+                  n_node < N_NODES;
+                ++n_node)
+    {
+        ASSERT_TRUE(processed_nodes[n_node]);
+    }
+
+    system_resizable_vector_release(values);
+    system_dag_release             (dag);
+}
+
+/* Measures how long it takes to bring the topological order up-to-date after a small modification
+ * of a large graph. */
+TEST(DAGTest, DISABLED_IncrementalUpdateBenchmark)
+{
+    const uint32_t n_nodes_array[] =
+    {
+        1000,
+        10000,
+        50000
+    };
+    const uint32_t n_nodes_array_size = sizeof(n_nodes_array) / sizeof(n_nodes_array[0]);
+
+    srand(0x5678);
+
+    for (uint32_t n_size = 0;
+                  n_size < n_nodes_array_size;
+                ++n_size)
+    {
+        std::vector<system_dag_connection> connections;
+        system_dag                         dag           = system_dag_create();
+        std::vector<test_edge>             edges;
+        std::vector<uint32_t>              hidden_order;
+        const uint32_t                     n_nodes       = n_nodes_array[n_size];
+        std::vector<system_dag_node>       nodes;
+        system_resizable_vector            sorted_values = system_resizable_vector_create(n_nodes);
+        __uint64                           time_start    = 0;
+        __uint64                           time_total    = 0;
+
+        get_hidden_order(n_nodes,
+                         hidden_order);
+
+        for (uint32_t n_node = 0;
+                      n_node < n_nodes;
+                    ++n_node)
+        {
+            nodes.push_back(system_dag_add_node(dag,
+                                                (system_dag_node_value) (intptr_t) n_node) );
+        }
+
+        for (uint32_t n_edge = 0;
+                      n_edge < n_nodes * 2;
+                    ++n_edge)
+        {
+            const test_edge edge = get_random_dag_edge(hidden_order);
+
+            edges.push_back      (edge);
+            connections.push_back(system_dag_add_connection(dag,
+                                                            nodes[edge.src],
+                                                            nodes[edge.dst]) );
+        }
+
+        ASSERT_TRUE(system_dag_solve(dag) );
+
+        /* Each edit removes one connection, adds a new one and then retrieves the sorted nodes. */
+        std::vector<test_edge> new_edges;
+        std::vector<uint32_t>  removed_edges;
+
+        for (uint32_t n_edit = 0;
+                      n_edit < N_BENCHMARK_EDITS;
+                    ++n_edit)
+        {
+            new_edges.push_back    (get_random_dag_edge(hidden_order) );
+            removed_edges.push_back(rand() % edges.size() );
+        }
+
+        time_start = system_time_now_usec();
+        {
+            for (uint32_t n_edit = 0;
+                          n_edit < N_BENCHMARK_EDITS;
+                        ++n_edit)
+            {
+                system_dag_delete_connection(dag,
+                                             connections[removed_edges[n_edit] ]);
+
+                connections[removed_edges[n_edit] ] = system_dag_add_connection(dag,
+                                                                                nodes[new_edges[n_edit].src],
+                                                                                nodes[new_edges[n_edit].dst]);
+
+                system_dag_solve                               (dag);
+                system_dag_get_topologically_sorted_node_values(dag,
+                                                                sorted_values);
+            }
+        }
+        time_total = system_time_now_usec() - time_start;
+
+        for (uint32_t n_edit = 0;
+                      n_edit < N_BENCHMARK_EDITS;
+                    ++n_edit)
+        {
+            edges[removed_edges[n_edit] ] = new_edges[n_edit];
+        }
+
+        verify_topological_order(dag,
+                                 n_nodes,
+                                 edges);
+
+        LOG_INFO("[%7u nodes] usec per edit: %10.2f",
+                 n_nodes,
+                 double(time_total) / N_BENCHMARK_EDITS);
+
+        system_resizable_vector_release(sorted_values);
+        system_dag_release             (dag);
+    }
+}
@@ -7,7 +7,12 @@
 #include "gtest/gtest.h"
 #include "shared.h"
 #include "system/system_event.h"
+#include "system/system_hashed_ansi_string.h"
+#include "system/system_log.h"
 #include "system/system_threads.h"
+#include "system/system_time.h"
+
+#define BENCHMARK_N_ROUND_TRIPS (100000)
 
 /* ------ "Wait, then set" functional test ------ */
 typedef struct _wait_then_set_test_data
@@ -57,3 +62,206 @@ TEST(EventsTest, WaitThenSet)
     data.wakeup_event = NULL;
 }
 
+
+/* ------ Auto-reset & wait_multiple() functional tests ------ */
+TEST(EventsTest, AutoResetEventIsConsumedByASingleWait)
+{
+    system_event event = system_event_create(false); /* manual_reset */
+
+    ASSERT_FALSE(system_event_wait_single_peek(event) );
+
+    system_event_set(event);
+    system_event_set(event);
+
+    ASSERT_TRUE (system_event_wait_single_peek(event) );
+    ASSERT_FALSE(system_event_wait_single_peek(event) );
+
+    system_event_release(event);
+}
+
+TEST(EventsTest, WaitMultipleReportsSignalledEventAndTimeouts)
+{
+    system_event events[3];
+    bool         has_timed_out = true;
+    size_t       result;
+
+    for (unsigned int n_event = 0;
+                      n_event < 3;
+                    ++n_event)
+    {
+        events[n_event] = system_event_create(false); /* manual_reset */
+    }
+
+    /* Wait-any should report the index of the signalled event & consume it */
+    system_event_set(events[2]);
+
+    result = system_event_wait_multiple(events,
+                                        3,     /* n_elements          */
+                                        false, /* wait_on_all_objects */
+                                        system_time_get_time_for_msec(1000),
+                                       &has_timed_out);
+
+    ASSERT_FALSE(has_timed_out);
+    ASSERT_EQ   (result,
+                 2);
+    ASSERT_FALSE(system_event_wait_single_peek(events[2]) );
+
+    /* Wait-all should not consume any of the events unless all of them are signalled */
+    system_event_set(events[0]);
+    system_event_set(events[1]);
+
+    system_event_wait_multiple(events,
+                               3,    /* n_elements          */
+                               true, /* wait_on_all_objects */
+                               system_time_get_time_for_msec(20),
+                              &has_timed_out);
+
+    ASSERT_TRUE(has_timed_out);
+
+    system_event_set(events[2]);
+
+    system_event_wait_multiple(events,
+                               3,    /* n_elements          */
+                               true, /* wait_on_all_objects */
+                               system_time_get_time_for_msec(1000),
+                              &has_timed_out);
+
+    ASSERT_FALSE(has_timed_out);
+
+    for (unsigned int n_event = 0;
+                      n_event < 3;
+                    ++n_event)
+    {
+        ASSERT_FALSE(system_event_wait_single_peek(events[n_event]) );
+
+        system_event_release(events[n_event]);
+    }
+}
+
+
+/* ------ Thread events test ------ */
+PRIVATE void _thread_event_test_thread(void* user_arg)
+{
+    system_event wakeup_event = (system_event) user_arg;
+
+    system_event_wait_single(wakeup_event);
+}
+
+
+TEST(EventsTest, ThreadEventIsSignalledWhenThreadQuits)
+{
+    system_event thread_event = NULL;
+    system_event wakeup_event = system_event_create(true); /* manual_reset */
+    bool         has_timed_out = false;
+
+    system_threads_spawn(_thread_event_test_thread,
+                         wakeup_event,
+                        &thread_event,
+                         system_hashed_ansi_string_create("Thread event") );
+
+    ASSERT_TRUE(thread_event != NULL);
+
+    system_event_wait_multiple(&thread_event,
+                               1,     /* n_elements          */
+                               false, /* wait_on_all_objects */
+                               system_time_get_time_for_msec(50),
+                              &has_timed_out);
+
+    ASSERT_TRUE(has_timed_out);
+
+    system_event_set        (wakeup_event);
+    system_event_wait_single(thread_event);
+
+    ASSERT_TRUE(system_event_wait_single_peek(thread_event) );
+
+    system_event_release(thread_event);
+    system_event_release(wakeup_event);
+}
+
+
+/* ------ Set->wake latency benchmark ------ */
+typedef struct
+{
+    system_event ping_event;
+    system_event pong_event;
+    bool         use_wait_multiple;
+} _ping_pong_test_data;
+
+
+PRIVATE void _ping_pong_wait(_ping_pong_test_data* data_ptr,
+                             system_event          event)
+{
+    if (data_ptr->use_wait_multiple)
+    {
+        system_event_wait_multiple(&event,
+                                   1,     /* n_elements          */
+                                   false, /* wait_on_all_objects */
+                                   SYSTEM_TIME_INFINITE,
+                                   NULL); /* out_has_timed_out_ptr */
+    }
+    else
+    {
+        system_event_wait_single(event);
+    }
+}
+
+PRIVATE void _ping_pong_test_thread(void* user_arg)
+{
+    _ping_pong_test_data* data_ptr = (_ping_pong_test_data*) user_arg;
+
+    for (unsigned int n_round_trip = 0;
+                      n_round_trip < BENCHMARK_N_ROUND_TRIPS;
+                    ++n_round_trip)
+    {
+        _ping_pong_wait (data_ptr,
+                         data_ptr->ping_event);
+        system_event_set(data_ptr->pong_event);
+    }
+}
+
+
+TEST(EventsTest, DISABLED_SetToWakeLatencyBenchmark)
+{
+    for (unsigned int n_run = 0;
+                      n_run < 2;
+                    ++n_run)
+    {
+        _ping_pong_test_data data;
+        __uint64             duration_usec;
+        __uint64             start_time_usec;
+        system_event         thread_event = NULL;
+
+        data.ping_event        = system_event_create(false); /* manual_reset */
+        data.pong_event        = system_event_create(false); /* manual_reset */
+        data.use_wait_multiple = (n_run == 1);
+
+        system_threads_spawn(_ping_pong_test_thread,
+                            &data,
+                            &thread_event,
+                             system_hashed_ansi_string_create("Ping-pong") );
+
+        start_time_usec = system_time_now_usec();
+        {
+            for (unsigned int n_round_trip = 0;
+                              n_round_trip < BENCHMARK_N_ROUND_TRIPS;
+                            ++n_round_trip)
+            {
+                system_event_set(data.ping_event);
+                _ping_pong_wait (&data,
+                                 data.pong_event);
+            }
+        }
+        duration_usec = system_time_now_usec() - start_time_usec;
+
+        system_event_wait_single(thread_event);
+
+        /* Each round trip consists of two set->wake transitions */
+        LOG_INFO("Set->wake latency (%s): %8.3f usec",
+                 data.use_wait_multiple ? "system_event_wait_multiple()" : "system_event_wait_single()",
+                 double(duration_usec) / double(2 * BENCHMARK_N_ROUND_TRIPS) );
+
+        system_event_release(thread_event);
+        system_event_release(data.ping_event);
+        system_event_release(data.pong_event);
+    }
+}
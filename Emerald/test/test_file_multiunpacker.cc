@@ -0,0 +1,432 @@
+/**
+ *
+ * Emerald (kbi/elude @2015)
+ *
+ */
+#include "test_file_multiunpacker.h"
+#include "gtest/gtest.h"
+#include "shared.h"
+#include "system/system_atomics.h"
+#include "system/system_file_multiunpacker.h"
+#include "system/system_file_packer.h"
+#include "system/system_file_serializer.h"
+#include "system/system_file_unpacker.h"
+#include "system/system_hashed_ansi_string.h"
+#include "system/system_log.h"
+#include "system/system_thread_pool.h"
+#include "system/system_time.h"
+#include <string.h>
+
+/* The benchmark mimics the asset set of a demo: a few packed files holding scenes, meshes
+ * & textures of varying sizes. */
+#define BENCHMARK_MAX_FILE_SIZE    (4 * 1024 * 1024)
+#define BENCHMARK_N_DECODE_PASSES  (4)
+#define BENCHMARK_N_FILES_PER_PACK (24)
+#define BENCHMARK_N_PACKS          (4)
+
+#define TEST_N_FILES_PER_PACK (3)
+#define TEST_N_PACKS          (2)
+
+
+typedef struct
+{
+    __uint64              first_file_decoded_time_usec;
+    volatile unsigned int n_decoded_files;
+    __uint64              start_time_usec;
+} _benchmark_state;
+
+typedef struct
+{
+    const unsigned char*  expected_data;
+    uint32_t              expected_size;
+    bool                  is_data_valid;
+    volatile unsigned int n_calls;
+} _test_subscription;
+
+
+/** Fills a buffer with deterministic, moderately compressible contents */
+PRIVATE void _fill_test_data(unsigned char* data,
+                             uint32_t       n_bytes,
+                             uint32_t       seed)
+{
+    uint32_t state = seed * 2654435761u + 1;
+
+    for (uint32_t n_byte = 0;
+                  n_byte < n_bytes;
+                ++n_byte)
+    {
+        state        = state * 1664525u + 1013904223u;
+        data[n_byte] = (unsigned char) ('a' + ( (state >> 24) & 0xF) );
+    }
+}
+
+/** Creates a packed file, holding files filled with test data. Returns contents of the files. */
+PRIVATE void _create_test_pack(const char*     packed_file_name,
+                               uint32_t        n_files,
+                               const char**    file_names,
+                               const uint32_t* file_sizes,
+                               unsigned char** out_file_data)
+{
+    system_file_packer packer = system_file_packer_create();
+
+    for (uint32_t n_file = 0;
+                  n_file < n_files;
+                ++n_file)
+    {
+        system_file_serializer serializer = system_file_serializer_create_for_writing(system_hashed_ansi_string_create(file_names[n_file]) );
+
+        out_file_data[n_file] = new unsigned char[file_sizes[n_file] + 1];
+
+        _fill_test_data(out_file_data[n_file],
+                        file_sizes[n_file],
+                        n_file);
+
+        system_file_serializer_write  (serializer,
+                                       file_sizes[n_file],
+                                       out_file_data[n_file]);
+        system_file_serializer_release(serializer);
+
+        system_file_packer_add_file(packer,
+                                    system_hashed_ansi_string_create(file_names[n_file]) );
+    }
+
+    system_file_packer_save   (packer,
+                               system_hashed_ansi_string_create(packed_file_name) );
+    system_file_packer_release(packer);
+
+    for (uint32_t n_file = 0;
+                  n_file < n_files;
+                ++n_file)
+    {
+        remove(file_names[n_file]);
+    }
+}
+
+/** Stands in for a decoder (eg. a PNG decompressor or a mesh loader) in the benchmark. */
+PRIVATE unsigned int _decode_file(system_file_serializer serializer)
+{
+    unsigned int         checksum = 0;
+    const unsigned char* data     = NULL;
+    uint32_t             size     = 0;
+
+    system_file_serializer_get_property(serializer,
+                                        SYSTEM_FILE_SERIALIZER_PROPERTY_RAW_STORAGE,
+                                       &data);
+    system_file_serializer_get_property(serializer,
+                                        SYSTEM_FILE_SERIALIZER_PROPERTY_SIZE,
+                                       &size);
+
+    for (unsigned int n_pass = 0;
+                      n_pass < BENCHMARK_N_DECODE_PASSES;
+                    ++n_pass)
+    {
+        for (uint32_t n_byte = 0;
+                      n_byte < size;
+                    ++n_byte)
+        {
+            checksum = checksum * 31 + data[n_byte];
+        }
+    }
+
+    return checksum;
+}
+
+PRIVATE void _on_benchmark_file_ready(system_hashed_ansi_string file_name,
+                                      system_file_unpacker      unpacker,
+                                      system_file_serializer    serializer,
+                                      void*                     user_arg)
+{
+    _benchmark_state* state_ptr = (_benchmark_state*) user_arg;
+
+    if (_decode_file(serializer) == 0)
+    {
+        LOG_INFO("Decoded file [%s] has a zero checksum.",
+                 system_hashed_ansi_string_get_buffer(file_name) );
+    }
+
+    if (system_atomics_increment(&state_ptr->n_decoded_files) == 1)
+    {
+        state_ptr->first_file_decoded_time_usec = system_time_now_usec() - state_ptr->start_time_usec;
+    }
+}
+
+PRIVATE void _on_test_file_ready(system_hashed_ansi_string file_name,
+                                 system_file_unpacker      unpacker,
+                                 system_file_serializer    serializer,
+                                 void*                     user_arg)
+{
+    _test_subscription* subscription_ptr = (_test_subscription*) user_arg;
+
+    if (subscription_ptr->expected_data == NULL)
+    {
+        subscription_ptr->is_data_valid = (unpacker   == NULL &&
+                                           serializer == NULL);
+    }
+    else
+    {
+        const void* data = NULL;
+        uint32_t    size = 0;
+
+        system_file_serializer_get_property(serializer,
+                                            SYSTEM_FILE_SERIALIZER_PROPERTY_RAW_STORAGE,
+                                           &data);
+        system_file_serializer_get_property(serializer,
+                                            SYSTEM_FILE_SERIALIZER_PROPERTY_SIZE,
+                                           &size);
+
+        subscription_ptr->is_data_valid = (size == subscription_ptr->expected_size &&
+                                           memcmp(data,
+                                                  subscription_ptr->expected_data,
+                                                  size) == 0);
+    }
+
+    system_atomics_increment(&subscription_ptr->n_calls);
+}
+
+
+TEST(FileMultiunpackerTest, SubscribersReceiveFilesFromAllPacks)
+{
+    unsigned char*            file_data [TEST_N_PACKS][TEST_N_FILES_PER_PACK];
+    const char*               file_names[TEST_N_PACKS][TEST_N_FILES_PER_PACK] =
+    {
+        {"MultiunpackerA0", "MultiunpackerA1", "MultiunpackerA2"},
+        {"MultiunpackerB0", "MultiunpackerB1", "MultiunpackerB2"}
+    };
+    const uint32_t            file_sizes[TEST_N_PACKS][TEST_N_FILES_PER_PACK] =
+    {
+        {100,    300000, 7},
+        {600000, 0,      5000}
+    };
+    system_file_multiunpacker multiunpacker = NULL;
+    _test_subscription        missing_file_subscription;
+    system_hashed_ansi_string packed_file_names[TEST_N_PACKS] =
+    {
+        system_hashed_ansi_string_create("MultiunpackerA.pak"),
+        system_hashed_ansi_string_create("MultiunpackerB.pak")
+    };
+    _test_subscription        subscriptions[TEST_N_PACKS][TEST_N_FILES_PER_PACK];
+
+    for (uint32_t n_pack = 0;
+                  n_pack < TEST_N_PACKS;
+                ++n_pack)
+    {
+        _create_test_pack(system_hashed_ansi_string_get_buffer(packed_file_names[n_pack]),
+                          TEST_N_FILES_PER_PACK,
+                          file_names[n_pack],
+                          file_sizes[n_pack],
+                          file_data [n_pack]);
+    }
+
+    multiunpacker = system_file_multiunpacker_create(packed_file_names,
+                                                     TEST_N_PACKS);
+
+    /* Subscribe to all files, including one which is not stored in any of the packs */
+    memset(&missing_file_subscription,
+           0,
+           sizeof(missing_file_subscription) );
+
+    system_file_multiunpacker_subscribe_to_file(multiunpacker,
+                                                system_hashed_ansi_string_create("MultiunpackerMissing"),
+                                                _on_test_file_ready,
+                                               &missing_file_subscription);
+
+    for (uint32_t n_pack = 0;
+                  n_pack < TEST_N_PACKS;
+                ++n_pack)
+    {
+        for (uint32_t n_file = 0;
+                      n_file < TEST_N_FILES_PER_PACK;
+                    ++n_file)
+        {
+            _test_subscription* subscription_ptr = &subscriptions[n_pack][n_file];
+
+            subscription_ptr->expected_data = file_data [n_pack][n_file];
+            subscription_ptr->expected_size = file_sizes[n_pack][n_file];
+            subscription_ptr->is_data_valid = false;
+            subscription_ptr->n_calls       = 0;
+
+            system_file_multiunpacker_subscribe_to_file(multiunpacker,
+                                                        system_hashed_ansi_string_create(file_names[n_pack][n_file]),
+                                                        _on_test_file_ready,
+                                                        subscription_ptr);
+        }
+    }
+
+    system_file_multiunpacker_wait_till_ready(multiunpacker);
+
+    ASSERT_EQ  (missing_file_subscription.n_calls,
+                1);
+    ASSERT_TRUE(missing_file_subscription.is_data_valid);
+
+    for (uint32_t n_pack = 0;
+                  n_pack < TEST_N_PACKS;
+                ++n_pack)
+    {
+        for (uint32_t n_file = 0;
+                      n_file < TEST_N_FILES_PER_PACK;
+                    ++n_file)
+        {
+            ASSERT_EQ  (subscriptions[n_pack][n_file].n_calls,
+                        1);
+            ASSERT_TRUE(subscriptions[n_pack][n_file].is_data_valid);
+
+            delete [] file_data[n_pack][n_file];
+        }
+    }
+
+    /* Subscriptions made after all packs have been opened should also be served */
+    subscriptions[0][0].expected_data = NULL;
+    subscriptions[0][0].n_calls       = 0;
+
+    system_file_multiunpacker_subscribe_to_file(multiunpacker,
+                                                system_hashed_ansi_string_create("MultiunpackerMissing"),
+                                                _on_test_file_ready,
+                                               &subscriptions[0][0]);
+    system_file_multiunpacker_release          (multiunpacker);
+
+    ASSERT_EQ  (subscriptions[0][0].n_calls,
+                1);
+    ASSERT_TRUE(subscriptions[0][0].is_data_valid);
+
+    for (uint32_t n_pack = 0;
+                  n_pack < TEST_N_PACKS;
+                ++n_pack)
+    {
+        remove(system_hashed_ansi_string_get_buffer(packed_file_names[n_pack]) );
+    }
+}
+
+TEST(FileMultiunpackerTest, DISABLED_LoaderCriticalPathBenchmark)
+{
+    char                      file_name_buffers       [BENCHMARK_N_PACKS][BENCHMARK_N_FILES_PER_PACK][32];
+    unsigned char*            file_data               [BENCHMARK_N_PACKS][BENCHMARK_N_FILES_PER_PACK];
+    const char*               file_names              [BENCHMARK_N_PACKS][BENCHMARK_N_FILES_PER_PACK];
+    uint32_t                  file_sizes              [BENCHMARK_N_PACKS][BENCHMARK_N_FILES_PER_PACK];
+    char                      packed_file_name_buffers[BENCHMARK_N_PACKS][32];
+    system_hashed_ansi_string packed_file_names       [BENCHMARK_N_PACKS];
+    __uint64                  total_size = 0;
+
+    for (uint32_t n_pack = 0;
+                  n_pack < BENCHMARK_N_PACKS;
+                ++n_pack)
+    {
+        for (uint32_t n_file = 0;
+                      n_file < BENCHMARK_N_FILES_PER_PACK;
+                    ++n_file)
+        {
+            snprintf(file_name_buffers[n_pack][n_file],
+                     sizeof(file_name_buffers[n_pack][n_file]),
+                     "LoaderBenchmark%d_%d.bin",
+                     n_pack,
+                     n_file);
+
+            file_names[n_pack][n_file]  = file_name_buffers[n_pack][n_file];
+            file_sizes[n_pack][n_file]  = BENCHMARK_MAX_FILE_SIZE >> (n_file % 4);
+            total_size                 += file_sizes[n_pack][n_file];
+        }
+
+        snprintf(packed_file_name_buffers[n_pack],
+                 sizeof(packed_file_name_buffers[n_pack]),
+                 "LoaderBenchmark%d.pak",
+                 n_pack);
+
+        packed_file_names[n_pack] = system_hashed_ansi_string_create(packed_file_name_buffers[n_pack]);
+
+        _create_test_pack(packed_file_name_buffers[n_pack],
+                          BENCHMARK_N_FILES_PER_PACK,
+                          file_names[n_pack],
+                          file_sizes[n_pack],
+                          file_data [n_pack]);
+    }
+
+    /* Staged loading: wait for all packs to be opened, then unpack & decode the files one after another.
+     * Pipelined loading: decode each file as soon as it becomes available. */
+    for (uint32_t n_mode = 0;
+                  n_mode < 2;
+                ++n_mode)
+    {
+        const bool                is_pipelined  = (n_mode == 1);
+        system_file_multiunpacker multiunpacker = NULL;
+        _benchmark_state          state;
+
+        memset(&state,
+               0,
+               sizeof(state) );
+
+        state.start_time_usec = system_time_now_usec();
+        {
+            multiunpacker = system_file_multiunpacker_create(packed_file_names,
+                                                             BENCHMARK_N_PACKS);
+
+            for (uint32_t n_pack = 0;
+                          n_pack < BENCHMARK_N_PACKS;
+                        ++n_pack)
+            {
+                for (uint32_t n_file = 0;
+                              n_file < BENCHMARK_N_FILES_PER_PACK;
+                            ++n_file)
+                {
+                    if (is_pipelined)
+                    {
+                        system_file_multiunpacker_subscribe_to_file(multiunpacker,
+                                                                    system_hashed_ansi_string_create(file_names[n_pack][n_file]),
+                                                                    _on_benchmark_file_ready,
+                                                                   &state);
+                    }
+                    else
+                    {
+                        system_file_serializer serializer = NULL;
+                        system_file_unpacker   unpacker   = NULL;
+
+                        if (n_pack == 0 &&
+                            n_file == 0)
+                        {
+                            system_file_multiunpacker_wait_till_ready(multiunpacker);
+                        }
+
+                        system_file_multiunpacker_get_indexed_property(multiunpacker,
+                                                                       n_pack,
+                                                                       SYSTEM_FILE_MULTIUNPACKER_PROPERTY_FILE_UNPACKER,
+                                                                      &unpacker);
+                        system_file_unpacker_get_file_property        (unpacker,
+                                                                       n_file,
+                                                                       SYSTEM_FILE_UNPACKER_FILE_PROPERTY_FILE_SERIALIZER,
+                                                                      &serializer);
+
+                        _on_benchmark_file_ready(system_hashed_ansi_string_create(file_names[n_pack][n_file]),
+                                                 unpacker,
+                                                 serializer,
+                                                &state);
+                    }
+                }
+            }
+
+            system_file_multiunpacker_wait_till_ready(multiunpacker);
+        }
+
+        ASSERT_EQ(state.n_decoded_files,
+                  BENCHMARK_N_PACKS * BENCHMARK_N_FILES_PER_PACK);
+
+        LOG_INFO("%s loading of %d MB: first file decoded after %d ms, critical path: %d ms",
+                 is_pipelined ? "Pipelined" : "Staged",
+                 (int) (total_size >> 20),
+                 (int) (state.first_file_decoded_time_usec / 1000),
+                 (int) ((system_time_now_usec() - state.start_time_usec) / 1000) );
+
+        system_file_multiunpacker_release(multiunpacker);
+    }
+
+    for (uint32_t n_pack = 0;
+                  n_pack < BENCHMARK_N_PACKS;
+                ++n_pack)
+    {
+        for (uint32_t n_file = 0;
+                      n_file < BENCHMARK_N_FILES_PER_PACK;
+                    ++n_file)
+        {
+            delete [] file_data[n_pack][n_file];
+        }
+
+        remove(packed_file_name_buffers[n_pack]);
+    }
+}
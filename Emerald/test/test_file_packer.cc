@@ -0,0 +1,425 @@
+/**
+ *
+ * Emerald (kbi/elude @2015)
+ *
+ */
+#include "test_file_packer.h"
+#include "gtest/gtest.h"
+#include "shared.h"
+#include "system/system_constants.h"
+#include "system/system_file_packer.h"
+#include "system/system_file_serializer.h"
+#include "system/system_file_unpacker.h"
+#include "system/system_hashed_ansi_string.h"
+#include "system/system_log.h"
+#include "system/system_time.h"
+#include <string.h>
+#include <zlib.h>
+
+#define BENCHMARK_FILE_SIZE (4 * 1024 * 1024)
+#define BENCHMARK_N_FILES   (125)
+
+
+/** Fills a buffer with deterministic, moderately compressible contents */
+PRIVATE void _fill_test_data(unsigned char* data,
+                             uint32_t       n_bytes,
+                             uint32_t       seed)
+{
+    uint32_t state = seed * 2654435761u + 1;
+
+    for (uint32_t n_byte = 0;
+                  n_byte < n_bytes;
+                ++n_byte)
+    {
+        state        = state * 1664525u + 1013904223u;
+        data[n_byte] = (unsigned char) ('a' + ( (state >> 24) & 0xF) );
+    }
+}
+
+/** Creates a file of the specified size, filled with test data. Returns the file's contents. */
+PRIVATE unsigned char* _create_test_file(const char* file_name,
+                                         uint32_t    file_size,
+                                         uint32_t    seed)
+{
+    unsigned char*         data       = new unsigned char[(file_size > 0) ? file_size : 1];
+    system_file_serializer serializer = system_file_serializer_create_for_writing(system_hashed_ansi_string_create(file_name) );
+
+    _fill_test_data(data,
+                    file_size,
+                    seed);
+
+    system_file_serializer_write  (serializer,
+                                   file_size,
+                                   data);
+    system_file_serializer_release(serializer);
+
+    return data;
+}
+
+/** Creates a packed file using the v1 format, which the packer no longer produces. */
+PRIVATE void _create_v1_packed_file(const char*           packed_file_name,
+                                    uint32_t              n_files,
+                                    const char**          file_names,
+                                    const uint32_t*       file_sizes,
+                                    const unsigned char** file_data)
+{
+    uint32_t               data_offset   = 0;
+    uLongf                 packed_size   = 0;
+    unsigned char*         packed_data   = NULL;
+    system_file_serializer serializer    = NULL;
+    unsigned char*         traveller_ptr = NULL;
+    uint32_t               unpacked_size = sizeof(uint32_t);
+    unsigned char*         unpacked_data = NULL;
+
+    for (uint32_t n_file = 0;
+                  n_file < n_files;
+                ++n_file)
+    {
+        unpacked_size += 2 * sizeof(uint32_t) + (uint32_t) strlen(file_names[n_file]) + file_sizes[n_file];
+    }
+
+    unpacked_data = new unsigned char[unpacked_size];
+    traveller_ptr = unpacked_data;
+
+    *(uint32_t*) traveller_ptr  = n_files;
+    traveller_ptr              += sizeof(uint32_t);
+
+    for (uint32_t n_file = 0;
+                  n_file < n_files;
+                ++n_file)
+    {
+        const uint32_t name_length = (uint32_t) strlen(file_names[n_file]);
+
+        *(uint32_t*) traveller_ptr  = name_length;
+        traveller_ptr              += sizeof(uint32_t);
+
+        memcpy(traveller_ptr,
+               file_names[n_file],
+               name_length);
+
+        traveller_ptr              += name_length;
+        *(uint32_t*) traveller_ptr  = data_offset;
+        traveller_ptr              += sizeof(uint32_t);
+        data_offset                += file_sizes[n_file];
+    }
+
+    for (uint32_t n_file = 0;
+                  n_file < n_files;
+                ++n_file)
+    {
+        memcpy(traveller_ptr,
+               file_data[n_file],
+               file_sizes[n_file]);
+
+        traveller_ptr += file_sizes[n_file];
+    }
+
+    packed_size = compressBound(unpacked_size);
+    packed_data = new unsigned char[packed_size];
+
+    ASSERT_EQ(compress2(packed_data,
+                       &packed_size,
+                        unpacked_data,
+                        unpacked_size,
+                        Z_DEFAULT_COMPRESSION),
+              Z_OK);
+
+    serializer = system_file_serializer_create_for_writing(system_hashed_ansi_string_create(packed_file_name) );
+
+    system_file_serializer_write  (serializer,
+                                   sizeof(unpacked_size),
+                                  &unpacked_size);
+    system_file_serializer_write  (serializer,
+                                   (uint32_t) packed_size,
+                                   packed_data);
+    system_file_serializer_release(serializer);
+
+    delete [] packed_data;
+    delete [] unpacked_data;
+}
+
+/** Verifies that the unpacker holds the specified files, accessing them in reverse order. */
+PRIVATE void _verify_unpacked_files(system_file_unpacker  unpacker,
+                                    uint32_t              n_files,
+                                    const char**          file_names,
+                                    const uint32_t*       file_sizes,
+                                    const unsigned char** file_data)
+{
+    uint32_t n_embedded_files = 0;
+
+    system_file_unpacker_get_property(unpacker,
+                                      SYSTEM_FILE_UNPACKER_PROPERTY_N_OF_EMBEDDED_FILES,
+                                     &n_embedded_files);
+
+    ASSERT_EQ(n_embedded_files,
+              n_files);
+
+    for (int32_t n_file = (int32_t) n_files - 1;
+                 n_file >= 0;
+               --n_file)
+    {
+        system_hashed_ansi_string file_name       = NULL;
+        const void*               raw_storage_ptr = NULL;
+        system_file_serializer    serializer      = NULL;
+        uint32_t                  serializer_size = 0;
+
+        system_file_unpacker_get_file_property(unpacker,
+                                               n_file,
+                                               SYSTEM_FILE_UNPACKER_FILE_PROPERTY_NAME,
+                                              &file_name);
+        system_file_unpacker_get_file_property(unpacker,
+                                               n_file,
+                                               SYSTEM_FILE_UNPACKER_FILE_PROPERTY_FILE_SERIALIZER,
+                                              &serializer);
+
+        ASSERT_STREQ(system_hashed_ansi_string_get_buffer(file_name),
+                     file_names[n_file]);
+        ASSERT_TRUE (serializer != NULL);
+
+        system_file_serializer_get_property(serializer,
+                                            SYSTEM_FILE_SERIALIZER_PROPERTY_RAW_STORAGE,
+                                           &raw_storage_ptr);
+        system_file_serializer_get_property(serializer,
+                                            SYSTEM_FILE_SERIALIZER_PROPERTY_SIZE,
+                                           &serializer_size);
+
+        ASSERT_EQ(serializer_size,
+                  file_sizes[n_file]);
+        ASSERT_EQ(memcmp(raw_storage_ptr,
+                         file_data[n_file],
+                         file_sizes[n_file]),
+                  0);
+    }
+}
+
+
+TEST(FilePackerTest, PackedFilesCanBeUnpacked)
+{
+    const char*          file_names[] =
+    {
+        "PackerTestEmpty.bin",
+        "PackerTestSmall.bin",
+        "PackerTestLarge.bin",
+        "PackerTestTail.bin"
+    };
+    const uint32_t       file_sizes[] =
+    {
+        0,
+        1000,
+        3 * FILE_PACKER_CHUNK_SIZE + 17,
+        100
+    };
+    const uint32_t       n_files  = sizeof(file_names) / sizeof(file_names[0]);
+    const unsigned char* file_data[n_files];
+    system_file_packer   packer   = system_file_packer_create();
+    system_file_unpacker unpacker = NULL;
+
+    for (uint32_t n_file = 0;
+                  n_file < n_files;
+                ++n_file)
+    {
+        file_data[n_file] = _create_test_file(file_names[n_file],
+                                              file_sizes[n_file],
+                                              n_file);
+
+        ASSERT_TRUE(system_file_packer_add_file(packer,
+                                                system_hashed_ansi_string_create(file_names[n_file]) ));
+    }
+
+    ASSERT_TRUE(system_file_packer_save(packer,
+                                        system_hashed_ansi_string_create("PackerTest.pak") ));
+
+    system_file_packer_release(packer);
+
+    unpacker = system_file_unpacker_create(system_hashed_ansi_string_create("PackerTest.pak") );
+
+    ASSERT_TRUE(unpacker != NULL);
+
+    _verify_unpacked_files(unpacker,
+                           n_files,
+                           file_names,
+                           file_sizes,
+                           file_data);
+
+    system_file_unpacker_release(unpacker);
+
+    for (uint32_t n_file = 0;
+                  n_file < n_files;
+                ++n_file)
+    {
+        delete [] file_data[n_file];
+    }
+}
+
+TEST(FilePackerTest, V1PackedFilesCanStillBeUnpacked)
+{
+    const char*          file_names[] =
+    {
+        "First",
+        "Second",
+        "Third"
+    };
+    const uint32_t       file_sizes[] =
+    {
+        12345,
+        0,
+        678
+    };
+    const uint32_t       n_files  = sizeof(file_names) / sizeof(file_names[0]);
+    const unsigned char* file_data[n_files];
+    system_file_unpacker unpacker = NULL;
+
+    for (uint32_t n_file = 0;
+                  n_file < n_files;
+                ++n_file)
+    {
+        unsigned char* data = new unsigned char[file_sizes[n_file] + 1];
+
+        _fill_test_data(data,
+                        file_sizes[n_file],
+                        n_file);
+
+        file_data[n_file] = data;
+    }
+
+    _create_v1_packed_file("PackerTestV1.pak",
+                           n_files,
+                           file_names,
+                           file_sizes,
+                           file_data);
+
+    unpacker = system_file_unpacker_create(system_hashed_ansi_string_create("PackerTestV1.pak") );
+
+    ASSERT_TRUE(unpacker != NULL);
+
+    _verify_unpacked_files(unpacker,
+                           n_files,
+                           file_names,
+                           file_sizes,
+                           file_data);
+
+    system_file_unpacker_release(unpacker);
+
+    for (uint32_t n_file = 0;
+                  n_file < n_files;
+                ++n_file)
+    {
+        delete [] file_data[n_file];
+    }
+}
+
+TEST(FilePackerTest, DISABLED_UnpackBenchmark)
+{
+    unsigned char*     file_data[BENCHMARK_N_FILES];
+    const char*        file_names[BENCHMARK_N_FILES];
+    char               file_name_buffers[BENCHMARK_N_FILES][32];
+    uint32_t           file_sizes[BENCHMARK_N_FILES];
+    __uint64           pack_duration_usec;
+    system_file_packer packer = system_file_packer_create();
+    __uint64           start_time_usec;
+
+    /* Prepare BENCHMARK_N_FILES * BENCHMARK_FILE_SIZE bytes of data */
+    for (uint32_t n_file = 0;
+                  n_file < BENCHMARK_N_FILES;
+                ++n_file)
+    {
+        snprintf(file_name_buffers[n_file],
+                 sizeof(file_name_buffers[n_file]),
+                 "PackerBenchmark%d.bin",
+                 n_file);
+
+        file_names[n_file] = file_name_buffers[n_file];
+        file_sizes[n_file] = BENCHMARK_FILE_SIZE;
+        file_data [n_file] = _create_test_file(file_names[n_file],
+                                               file_sizes[n_file],
+                                               n_file);
+
+        system_file_packer_add_file(packer,
+                                    system_hashed_ansi_string_create(file_names[n_file]) );
+    }
+
+    start_time_usec = system_time_now_usec();
+    {
+        ASSERT_TRUE(system_file_packer_save(packer,
+                                            system_hashed_ansi_string_create("PackerBenchmark.pak") ));
+    }
+    pack_duration_usec = system_time_now_usec() - start_time_usec;
+
+    system_file_packer_release(packer);
+
+    _create_v1_packed_file("PackerBenchmarkV1.pak",
+                           BENCHMARK_N_FILES,
+                           file_names,
+                           file_sizes,
+                           (const unsigned char**) file_data);
+
+    LOG_INFO("Packing %d MB took %d ms",
+             (BENCHMARK_N_FILES * BENCHMARK_FILE_SIZE) >> 20,
+             (int) (pack_duration_usec / 1000) );
+
+    /* Measure how long it takes to get hold of the first file, and of all files */
+    for (uint32_t n_format = 0;
+                  n_format < 2;
+                ++n_format)
+    {
+        const bool           is_v1                    = (n_format == 0);
+        __uint64             all_files_duration_usec  = 0;
+        __uint64             first_file_duration_usec = 0;
+        system_file_unpacker unpacker                 = NULL;
+
+        start_time_usec = system_time_now_usec();
+        {
+            for (uint32_t n_file = 0;
+                          n_file < BENCHMARK_N_FILES;
+                        ++n_file)
+            {
+                const void*            raw_storage_ptr = NULL;
+                system_file_serializer serializer      = NULL;
+
+                if (unpacker == NULL)
+                {
+                    unpacker = system_file_unpacker_create(system_hashed_ansi_string_create(is_v1 ? "PackerBenchmarkV1.pak"
+                                                                                                  : "PackerBenchmark.pak") );
+                }
+
+                system_file_unpacker_get_file_property(unpacker,
+                                                       n_file,
+                                                       SYSTEM_FILE_UNPACKER_FILE_PROPERTY_FILE_SERIALIZER,
+                                                      &serializer);
+                system_file_serializer_get_property   (serializer,
+                                                       SYSTEM_FILE_SERIALIZER_PROPERTY_RAW_STORAGE,
+                                                      &raw_storage_ptr);
+
+                ASSERT_EQ(memcmp(raw_storage_ptr,
+                                 file_data[n_file],
+                                 BENCHMARK_FILE_SIZE),
+                          0);
+
+                if (n_file == 0)
+                {
+                    first_file_duration_usec = system_time_now_usec() - start_time_usec;
+                }
+            }
+        }
+        all_files_duration_usec = system_time_now_usec() - start_time_usec;
+
+        LOG_INFO("v%d pack: time to first file: %d ms, time to all files: %d ms",
+                 is_v1 ? 1 : 2,
+                 (int) (first_file_duration_usec / 1000),
+                 (int) (all_files_duration_usec  / 1000) );
+
+        system_file_unpacker_release(unpacker);
+    }
+
+    for (uint32_t n_file = 0;
+                  n_file < BENCHMARK_N_FILES;
+                ++n_file)
+    {
+        remove(file_names[n_file]);
+
+        delete [] file_data[n_file];
+    }
+
+    remove("PackerBenchmark.pak");
+    remove("PackerBenchmarkV1.pak");
+}
@@ -9,10 +9,33 @@
 #include "system/system_event.h"
 #include "system/system_file_monitor.h"
 #include "system/system_file_serializer.h"
+#include "system/system_hashed_ansi_string.h"
+#include "system/system_log.h"
+#include "system/system_time.h"
+#include <atomic>
+#include <string>
+#include <vector>
+
+#ifdef _WIN32
+    #include <direct.h>
+#else
+    #include <sys/stat.h>
+#endif
+
+#define BENCHMARK_FILE_SIZE           (256 * 1024 * 1024)
+#define BENCHMARK_CHUNK_SIZE          (1024 * 1024)
+#define STRESS_TEST_N_FILES           (10000)
+#define STRESS_TEST_N_WRITES_PER_FILE (3)
 
 
 PRIVATE const char* test_file_name = "Oink";
 
+typedef struct
+{
+    std::atomic<unsigned int> n_callbacks;
+    __uint64                  last_callback_time_usec;
+} _file_monitor_stress_test_file;
+
 
 PRIVATE void _create_test_file()
 {
@@ -32,6 +55,38 @@ PRIVATE void _create_test_file()
     test_file_serializer = NULL;
 }
 
+/** Retrieves the amount of anonymous (heap) & file-backed memory resident in the process, if the OS
+ *  exposes that information. */
+PRIVATE void _get_rss_kb(unsigned int* out_anonymous_rss_kb_ptr,
+                         unsigned int* out_file_rss_kb_ptr)
+{
+    *out_anonymous_rss_kb_ptr = 0;
+    *out_file_rss_kb_ptr      = 0;
+
+#ifdef __linux
+    char  line[256];
+    FILE* status_file_handle = fopen("/proc/self/status",
+                                     "r");
+
+    if (status_file_handle != NULL)
+    {
+        while (fgets(line,
+                     sizeof(line),
+                     status_file_handle) != NULL)
+        {
+            sscanf(line,
+                   "RssAnon: %u kB",
+                   out_anonymous_rss_kb_ptr);
+            sscanf(line,
+                   "RssFile: %u kB",
+                   out_file_rss_kb_ptr);
+        }
+
+        fclose(status_file_handle);
+    }
+#endif
+}
+
 PRIVATE void _on_file_contents_changed(system_hashed_ansi_string file_name,
                                        void*                     user_arg)
 {
@@ -40,6 +95,47 @@ PRIVATE void _on_file_contents_changed(system_hashed_ansi_string file_name,
     system_event_set(*event_ptr);
 }
 
+PRIVATE void _on_file_contents_changed_count(system_hashed_ansi_string file_name,
+                                             void*                     user_arg)
+{
+    std::atomic<unsigned int>* n_callbacks_ptr = (std::atomic<unsigned int>*) user_arg;
+
+    (*n_callbacks_ptr)++;
+}
+
+PRIVATE void _on_stress_test_file_contents_changed(system_hashed_ansi_string file_name,
+                                                   void*                     user_arg)
+{
+    _file_monitor_stress_test_file* file_ptr = (_file_monitor_stress_test_file*) user_arg;
+
+    file_ptr->last_callback_time_usec = system_time_now_usec();
+    file_ptr->n_callbacks++;
+}
+
+PRIVATE void _sleep_msec(unsigned int n_msec)
+{
+#ifdef _WIN32
+    Sleep(n_msec);
+#else
+    usleep(n_msec * 1000);
+#endif
+}
+
+PRIVATE void _write_test_file(const char* file_name,
+                              const char* contents)
+{
+    FILE* file_handle = fopen(file_name,
+                              "w+");
+
+    ASSERT_TRUE(file_handle != NULL);
+
+    fwrite(contents,
+           strlen(contents),
+           1, /* _Count */
+           file_handle);
+    fclose(file_handle);
+}
+
 TEST(FilesTest, NoCallbackFromFileMonitorForReadFilesTest)
 {
     system_event              callback_received_event = system_event_create(true); /* manual_reset */
@@ -151,3 +247,343 @@ TEST(FilesTest, SingleFileMonitorTest)
     system_event_release(callback_received_event);
 }
 
+
+/* A burst of writes to a monitored file should result in a single call-back, issued after the file's
+ * coalescing window expires. */
+TEST(FilesTest, FileMonitorCoalescesBurstsOfWritesTest)
+{
+    std::atomic<unsigned int> n_callbacks;
+    system_hashed_ansi_string test_file_name_has = system_hashed_ansi_string_create(test_file_name);
+
+    n_callbacks = 0;
+
+    _create_test_file();
+
+    system_file_monitor_monitor_file_changes(test_file_name_has,
+                                             true, /* should_enable */
+                                            &_on_file_contents_changed_count,
+                                            &n_callbacks,
+                                             200); /* coalescing_window_msec */
+
+    for (unsigned int n_iteration = 0;
+                      n_iteration < 2;
+                    ++n_iteration)
+    {
+        for (unsigned int n_write = 0;
+                          n_write < 10;
+                        ++n_write)
+        {
+            _write_test_file(test_file_name,
+                             "Burst");
+        }
+
+        /* Wait for the coalescing window to expire */
+        for (unsigned int n_wait = 0;
+                          n_wait < 100 && n_callbacks < n_iteration + 1;
+                        ++n_wait)
+        {
+            _sleep_msec(20);
+        }
+
+        /* Make sure no further call-backs arrive */
+        _sleep_msec(400);
+
+        ASSERT_EQ(n_callbacks,
+                  n_iteration + 1);
+    }
+
+    system_file_monitor_monitor_file_changes(test_file_name_has,
+                                             false, /* should_enable */
+                                             NULL,  /* pfn_file_changed_proc */
+                                             NULL); /* user_arg */
+}
+
+TEST(FilesTest, MappedSerializerReadsFileContents)
+{
+    const char                expected_contents[] = "This is an example sentence.";
+    bool                      is_mapped           = false;
+    const void*               no_copy_data_ptr    = NULL;
+    const char*               raw_storage_ptr     = NULL;
+    char                      read_data[8]        = {0};
+    uint32_t                  serializer_size     = 0;
+    system_file_serializer    serializer          = NULL;
+
+    /* Create the test file */
+    _create_test_file();
+
+    /* Map it & make sure both the copying and the zero-copy reads return the file contents */
+    serializer = system_file_serializer_create_for_reading_mapped_file(system_hashed_ansi_string_create(test_file_name) );
+
+    system_file_serializer_get_property(serializer,
+                                        SYSTEM_FILE_SERIALIZER_PROPERTY_IS_MAPPED,
+                                       &is_mapped);
+    system_file_serializer_get_property(serializer,
+                                        SYSTEM_FILE_SERIALIZER_PROPERTY_RAW_STORAGE,
+                                       &raw_storage_ptr);
+    system_file_serializer_get_property(serializer,
+                                        SYSTEM_FILE_SERIALIZER_PROPERTY_SIZE,
+                                       &serializer_size);
+
+    ASSERT_TRUE(is_mapped);
+    ASSERT_EQ  (serializer_size,
+                sizeof(expected_contents) );
+    ASSERT_EQ  (memcmp(raw_storage_ptr,
+                       expected_contents,
+                       sizeof(expected_contents) ),
+                0);
+
+    ASSERT_TRUE(system_file_serializer_read_no_copy(serializer,
+                                                    5, /* n_bytes */
+                                                   &no_copy_data_ptr) );
+    ASSERT_TRUE(no_copy_data_ptr == raw_storage_ptr);
+
+    ASSERT_TRUE(system_file_serializer_read(serializer,
+                                            2, /* n_bytes */
+                                            read_data) );
+    ASSERT_EQ  (memcmp(read_data,
+                       "is",
+                       2),
+                0);
+
+    ASSERT_FALSE(system_file_serializer_read_no_copy(serializer,
+                                                     sizeof(expected_contents),
+                                                    &no_copy_data_ptr) );
+
+    system_file_serializer_release(serializer);
+
+    /* Reads from serializers created for files which do not exist should fail */
+    serializer = system_file_serializer_create_for_reading_mapped_file(system_hashed_ansi_string_create("IAmNotHere") );
+
+    ASSERT_FALSE(system_file_serializer_read(serializer,
+                                             1, /* n_bytes */
+                                             read_data) );
+
+    system_file_serializer_release(serializer);
+}
+
+TEST(FilesTest, DISABLED_MappedSerializerReadBenchmark)
+{
+    const char* benchmark_file_name = "MappedSerializerBenchmark.bin";
+    char*       chunk               = new char[BENCHMARK_CHUNK_SIZE];
+    FILE*       file_handle         = NULL;
+
+    /* Create a large test file */
+    file_handle = fopen(benchmark_file_name,
+                        "wb");
+
+    ASSERT_TRUE(file_handle != NULL);
+
+    for (unsigned int n_chunk = 0;
+                      n_chunk < BENCHMARK_FILE_SIZE / BENCHMARK_CHUNK_SIZE;
+                    ++n_chunk)
+    {
+        memset(chunk,
+               n_chunk & 0xFF,
+               BENCHMARK_CHUNK_SIZE);
+
+        fwrite(chunk,
+               BENCHMARK_CHUNK_SIZE,
+               1, /* _Count */
+               file_handle);
+    }
+
+    fclose(file_handle);
+
+    /* Parse the file once, as a loader would, in both reading modes */
+    for (unsigned int n_mode = 0;
+                      n_mode < 2;
+                    ++n_mode)
+    {
+        const bool             use_mapping    = (n_mode == 1);
+        unsigned int           checksum       = 0;
+        __uint64               duration_usec;
+        unsigned int           end_anonymous_rss_kb;
+        unsigned int           end_file_rss_kb;
+        system_file_serializer serializer;
+        unsigned int           start_anonymous_rss_kb;
+        unsigned int           start_file_rss_kb;
+        __uint64               start_time_usec;
+
+        _get_rss_kb(&start_anonymous_rss_kb,
+                    &start_file_rss_kb);
+
+        start_time_usec = system_time_now_usec();
+        {
+            serializer = use_mapping ? system_file_serializer_create_for_reading_mapped_file(system_hashed_ansi_string_create(benchmark_file_name) )
+                                     : system_file_serializer_create_for_reading           (system_hashed_ansi_string_create(benchmark_file_name) );
+
+            for (unsigned int n_chunk = 0;
+                              n_chunk < BENCHMARK_FILE_SIZE / BENCHMARK_CHUNK_SIZE;
+                            ++n_chunk)
+            {
+                const void* chunk_data_ptr = NULL;
+
+                ASSERT_TRUE(system_file_serializer_read_no_copy(serializer,
+                                                                BENCHMARK_CHUNK_SIZE,
+                                                               &chunk_data_ptr) );
+
+                /* Touch every page of the chunk */
+                for (unsigned int n_byte = 0;
+                                  n_byte < BENCHMARK_CHUNK_SIZE;
+                                  n_byte += 4096)
+                {
+                    checksum += ((const unsigned char*) chunk_data_ptr)[n_byte];
+                }
+            }
+        }
+        duration_usec = system_time_now_usec() - start_time_usec;
+
+        /* Mapped pages are backed by the page cache & can be dropped by the OS at any time. Heap pages
+         * need to be written out to the swap file first. */
+        _get_rss_kb(&end_anonymous_rss_kb,
+                    &end_file_rss_kb);
+
+        system_file_serializer_release(serializer);
+
+        LOG_INFO("Parsing a %u MB file (%s): %8.3f ms, resident heap memory: %4d MB, resident file-backed memory: %4d MB (checksum: %u)",
+                 BENCHMARK_FILE_SIZE / (1024 * 1024),
+                 use_mapping ? "mapped  " : "buffered",
+                 double(duration_usec) / 1000.0,
+                 (int(end_anonymous_rss_kb) - int(start_anonymous_rss_kb)) / 1024,
+                 (int(end_file_rss_kb)      - int(start_file_rss_kb))      / 1024,
+                 checksum);
+    }
+
+    delete [] chunk;
+
+    remove(benchmark_file_name);
+}
+
+/* Monitors STRESS_TEST_N_FILES files located in a single directory, writes each of them a few times in a row
+ * and measures how long it takes for the call-backs to arrive. */
+TEST(FilesTest, DISABLED_FileMonitorStressTest)
+{
+    const char*                     directory_name         = "FileMonitorStressTest";
+    __uint64                        end_time_usec          = 0;
+    std::vector<std::string>        file_names(STRESS_TEST_N_FILES);
+    _file_monitor_stress_test_file* files                  = new _file_monitor_stress_test_file[STRESS_TEST_N_FILES];
+    __uint64                        max_latency_usec       = 0;
+    unsigned int                    n_callbacks            = 0;
+    unsigned int                    n_files_with_callbacks = 0;
+    __uint64                        start_time_usec        = 0;
+    __uint64                        total_latency_usec     = 0;
+    std::vector<__uint64>           write_time_usec(STRESS_TEST_N_FILES);
+
+#ifdef _WIN32
+    _mkdir(directory_name);
+#else
+    mkdir(directory_name,
+          0755);
+#endif
+
+    for (unsigned int n_file = 0;
+                      n_file < STRESS_TEST_N_FILES;
+                    ++n_file)
+    {
+        char file_name[64];
+
+        snprintf(file_name,
+                 sizeof(file_name),
+                 "%s/file%05u.txt",
+                 directory_name,
+                 n_file);
+
+        file_names[n_file]                         = file_name;
+        files     [n_file].last_callback_time_usec = 0;
+        files     [n_file].n_callbacks             = 0;
+
+        _write_test_file(file_name,
+                         "Initial contents");
+
+        system_file_monitor_monitor_file_changes(system_hashed_ansi_string_create(file_name),
+                                                 true, /* should_enable */
+                                                 _on_stress_test_file_contents_changed,
+                                                 files + n_file);
+    }
+
+    /* Write all the files, as an asset exporter would */
+    start_time_usec = system_time_now_usec();
+
+    for (unsigned int n_file = 0;
+                      n_file < STRESS_TEST_N_FILES;
+                    ++n_file)
+    {
+        for (unsigned int n_write = 0;
+                          n_write < STRESS_TEST_N_WRITES_PER_FILE;
+                        ++n_write)
+        {
+            _write_test_file(file_names[n_file].c_str(),
+                             "Modified contents");
+        }
+
+        write_time_usec[n_file] = system_time_now_usec();
+    }
+
+    /* Wait until all call-backs arrive, or until we give up */
+    for (unsigned int n_wait = 0;
+                      n_wait < 3000 && n_files_with_callbacks < STRESS_TEST_N_FILES;
+                    ++n_wait)
+    {
+        _sleep_msec(10);
+
+        n_files_with_callbacks = 0;
+
+        for (unsigned int n_file = 0;
+                          n_file < STRESS_TEST_N_FILES;
+                        ++n_file)
+        {
+            n_files_with_callbacks += (files[n_file].n_callbacks > 0) ? 1 : 0;
+        }
+    }
+
+    end_time_usec = system_time_now_usec();
+
+    /* Give spurious call-backs a chance to arrive */
+    _sleep_msec(FILE_MONITOR_MAX_COALESCING_DELAY_MSEC);
+
+    for (unsigned int n_file = 0;
+                      n_file < STRESS_TEST_N_FILES;
+                    ++n_file)
+    {
+        system_file_monitor_monitor_file_changes(system_hashed_ansi_string_create(file_names[n_file].c_str() ),
+                                                 false, /* should_enable */
+                                                 NULL,  /* pfn_file_changed_proc */
+                                                 NULL); /* user_arg */
+
+        if (files[n_file].n_callbacks > 0)
+        {
+            const __uint64 latency_usec = files[n_file].last_callback_time_usec - write_time_usec[n_file];
+
+            if (max_latency_usec < latency_usec)
+            {
+                max_latency_usec = latency_usec;
+            }
+
+            total_latency_usec += latency_usec;
+        }
+
+        n_callbacks += files[n_file].n_callbacks;
+
+        remove(file_names[n_file].c_str() );
+    }
+
+#ifdef _WIN32
+    _rmdir(directory_name);
+#else
+    rmdir(directory_name);
+#endif
+
+    LOG_INFO("File monitor stress test: %u files written %u times each, %u call-backs received for %u files in %8.3f ms. Latency: average %8.3f ms, max %8.3f ms",
+             STRESS_TEST_N_FILES,
+             STRESS_TEST_N_WRITES_PER_FILE,
+             n_callbacks,
+             n_files_with_callbacks,
+             double(end_time_usec - start_time_usec) / 1000.0,
+             (n_files_with_callbacks > 0) ? double(total_latency_usec) / 1000.0 / n_files_with_callbacks : 0.0,
+             double(max_latency_usec) / 1000.0);
+
+    delete [] files;
+
+    ASSERT_EQ(n_files_with_callbacks,
+              STRESS_TEST_N_FILES);
+}
@@ -0,0 +1,303 @@
+/**
+ *
+ * Emerald (kbi/elude @2016)
+ *
+ */
+#include "test_frame_arena.h"
+#include "gtest/gtest.h"
+#include "shared.h"
+#include "system/system_atomics.h"
+#include "system/system_constants.h"
+#include "system/system_event.h"
+#include "system/system_frame_arena.h"
+#include "system/system_hashed_ansi_string.h"
+#include "system/system_threads.h"
+#include "system/system_time.h"
+#include <string.h>
+#include <vector>
+
+#define N_ALLOCATIONS_PER_FRAME       (512)
+#define N_THREADS                     (4)
+#define N_THREAD_ALLOCATIONS          (2048)
+
+
+typedef struct
+{
+    system_event          all_threads_done_event;
+    volatile unsigned int n_errors;
+    volatile unsigned int n_threads_done;
+    volatile unsigned int n_threads_started;
+} thread_test_data;
+
+
+PRIVATE void _thread_entrypoint(system_threads_entry_point_argument arg)
+{
+    unsigned char*     allocations[N_THREAD_ALLOCATIONS];
+    thread_test_data*  data_ptr     = (thread_test_data*) arg;
+    const unsigned int thread_index = system_atomics_increment(&data_ptr->n_threads_started);
+
+    for (unsigned int n_allocation = 0;
+                      n_allocation < N_THREAD_ALLOCATIONS;
+                    ++n_allocation)
+    {
+        allocations[n_allocation] = (unsigned char*) system_frame_arena_alloc(64);
+
+        memset(allocations[n_allocation],
+               thread_index,
+               64);
+    }
+
+    /* Wait until all threads have finished filling their allocations */
+    if (system_atomics_increment(&data_ptr->n_threads_done) == N_THREADS)
+    {
+        system_event_set(data_ptr->all_threads_done_event);
+    }
+
+    system_event_wait_single(data_ptr->all_threads_done_event);
+
+    for (unsigned int n_allocation = 0;
+                      n_allocation < N_THREAD_ALLOCATIONS;
+                    ++n_allocation)
+    {
+        for (unsigned int n_byte = 0;
+                          n_byte < 64;
+                        ++n_byte)
+        {
+            if (allocations[n_allocation][n_byte] != thread_index)
+            {
+                system_atomics_increment(&data_ptr->n_errors);
+
+                break;
+            }
+        }
+    }
+}
+
+
+TEST(FrameArenaTest, AllocationsAreAlignedAndDoNotOverlap)
+{
+    unsigned char* allocations     [N_ALLOCATIONS_PER_FRAME];
+    size_t         allocation_sizes[N_ALLOCATIONS_PER_FRAME];
+    __uint64       n_bytes_allocated = 0;
+    __uint64       n_bytes_expected  = 0;
+    unsigned int   n_allocations     = 0;
+
+    system_frame_arena_begin_frame();
+    {
+        ASSERT_TRUE(system_frame_arena_is_frame_in_progress() );
+
+        for (unsigned int n_allocation = 0;
+                          n_allocation < N_ALLOCATIONS_PER_FRAME;
+                        ++n_allocation)
+        {
+            const size_t alignment = (size_t) 1 << (n_allocation % 8);
+
+            /* Every 64th allocation is larger than a whole chunk */
+            allocation_sizes[n_allocation] = ((n_allocation % 64) == 63) ? (FRAME_ARENA_CHUNK_SIZE + 1)
+                                                                         : (1 + n_allocation % 97);
+            allocations     [n_allocation] = (unsigned char*) system_frame_arena_alloc(allocation_sizes[n_allocation],
+                                                                                       alignment);
+            n_bytes_expected              += allocation_sizes[n_allocation];
+
+            ASSERT_TRUE(allocations[n_allocation] != NULL);
+            ASSERT_EQ  (((size_t) allocations[n_allocation]) & (alignment - 1),
+                        0);
+
+            memset(allocations[n_allocation],
+                   n_allocation & 0xFF,
+                   allocation_sizes[n_allocation]);
+        }
+
+        for (unsigned int n_allocation = 0;
+                          n_allocation < N_ALLOCATIONS_PER_FRAME;
+                        ++n_allocation)
+        {
+            for (size_t n_byte = 0;
+                        n_byte < allocation_sizes[n_allocation];
+                      ++n_byte)
+            {
+                ASSERT_EQ(allocations[n_allocation][n_byte],
+                          n_allocation & 0xFF);
+            }
+        }
+    }
+    system_frame_arena_end_frame();
+
+    ASSERT_FALSE(system_frame_arena_is_frame_in_progress() );
+
+    system_frame_arena_get_property(SYSTEM_FRAME_ARENA_PROPERTY_N_ALLOCATIONS_LAST_FRAME,
+                                   &n_allocations);
+    system_frame_arena_get_property(SYSTEM_FRAME_ARENA_PROPERTY_N_BYTES_ALLOCATED_LAST_FRAME,
+                                   &n_bytes_allocated);
+
+    ASSERT_EQ(n_allocations,
+              N_ALLOCATIONS_PER_FRAME);
+    ASSERT_EQ(n_bytes_allocated,
+              n_bytes_expected);
+}
+
+/* Makes sure an arena which had to grow in one frame does not allocate in the following frames */
+TEST(FrameArenaTest, ArenaStopsGrowing)
+{
+    unsigned int n_chunk_allocations[3] = {0};
+    void*        first_allocations  [3] = {NULL};
+
+    for (unsigned int n_frame = 0;
+                      n_frame < 3;
+                    ++n_frame)
+    {
+        system_frame_arena_begin_frame();
+        {
+            for (unsigned int n_allocation = 0;
+                              n_allocation < 8 * FRAME_ARENA_CHUNK_SIZE / 1024;
+                            ++n_allocation)
+            {
+                void* allocation_ptr = system_frame_arena_alloc(1024);
+
+                if (n_allocation == 0)
+                {
+                    first_allocations[n_frame] = allocation_ptr;
+                }
+            }
+        }
+        system_frame_arena_end_frame();
+
+        system_frame_arena_get_property(SYSTEM_FRAME_ARENA_PROPERTY_N_CHUNK_ALLOCATIONS_LAST_FRAME,
+                                        n_chunk_allocations + n_frame);
+    }
+
+    ASSERT_EQ(n_chunk_allocations[2],
+              0);
+    ASSERT_EQ(first_allocations[1],
+              first_allocations[2]);
+}
+
+TEST(FrameArenaTest, OverlappingFramesKeepAllocations)
+{
+    unsigned int   n_frames_completed_after  = 0;
+    unsigned int   n_frames_completed_before = 0;
+    unsigned char* outer_allocation_ptr      = NULL;
+
+    system_frame_arena_get_property(SYSTEM_FRAME_ARENA_PROPERTY_N_FRAMES_COMPLETED,
+                                   &n_frames_completed_before);
+
+    system_frame_arena_begin_frame();
+    {
+        outer_allocation_ptr = (unsigned char*) system_frame_arena_alloc(256);
+
+        memset(outer_allocation_ptr,
+               0xAB,
+               256);
+
+        /* Another rendering handler starts and finishes a frame in the meantime */
+        system_frame_arena_begin_frame();
+        {
+            memset(system_frame_arena_alloc(256),
+                   0xCD,
+                   256);
+        }
+        system_frame_arena_end_frame();
+
+        ASSERT_TRUE(system_frame_arena_is_frame_in_progress() );
+
+        memset(system_frame_arena_alloc(256),
+               0xEF,
+               256);
+
+        for (unsigned int n_byte = 0;
+                          n_byte < 256;
+                        ++n_byte)
+        {
+            ASSERT_EQ(outer_allocation_ptr[n_byte],
+                      0xAB);
+        }
+    }
+    system_frame_arena_end_frame();
+
+    system_frame_arena_get_property(SYSTEM_FRAME_ARENA_PROPERTY_N_FRAMES_COMPLETED,
+                                   &n_frames_completed_after);
+
+    ASSERT_EQ(n_frames_completed_after,
+              n_frames_completed_before + 1);
+}
+
+TEST(FrameArenaTest, AllocatorFallsBackToHeapOutsideFrame)
+{
+    unsigned int n_allocations = 0;
+
+    {
+        std::vector<unsigned int, system_frame_arena_allocator<unsigned int> > heap_vector;
+
+        ASSERT_FALSE(heap_vector.get_allocator().is_frame_arena_backed);
+
+        for (unsigned int n = 0;
+                          n < 1000;
+                        ++n)
+        {
+            heap_vector.push_back(n);
+        }
+
+        ASSERT_EQ(heap_vector[999],
+                  999);
+    }
+
+    system_frame_arena_begin_frame();
+    {
+        std::vector<unsigned int, system_frame_arena_allocator<unsigned int> > arena_vector;
+
+        ASSERT_TRUE(arena_vector.get_allocator().is_frame_arena_backed);
+
+        for (unsigned int n = 0;
+                          n < 1000;
+                        ++n)
+        {
+            arena_vector.push_back(n);
+        }
+
+        ASSERT_EQ(arena_vector[999],
+                  999);
+    }
+    system_frame_arena_end_frame();
+
+    system_frame_arena_get_property(SYSTEM_FRAME_ARENA_PROPERTY_N_ALLOCATIONS_LAST_FRAME,
+                                   &n_allocations);
+
+    ASSERT_GT(n_allocations,
+              0);
+}
+
+TEST(FrameArenaTest, ThreadsUseTheirOwnArenas)
+{
+    thread_test_data data;
+    system_event     thread_wait_events[N_THREADS];
+
+    data.all_threads_done_event = system_event_create(true); /* manual_reset */
+    data.n_errors               = 0;
+    data.n_threads_done         = 0;
+    data.n_threads_started      = 0;
+
+    system_frame_arena_begin_frame();
+    {
+        for (unsigned int n_thread = 0;
+                          n_thread < N_THREADS;
+                        ++n_thread)
+        {
+            system_threads_spawn(_thread_entrypoint,
+                                &data,
+                                 thread_wait_events + n_thread,
+                                 system_hashed_ansi_string_create("Frame arena test thread") );
+        }
+
+        system_event_wait_multiple(thread_wait_events,
+                                   N_THREADS,
+                                   true, /* wait_on_all_objects */
+                                   SYSTEM_TIME_INFINITE,
+                                   NULL); /* out_result_ptr */
+    }
+    system_frame_arena_end_frame();
+
+    ASSERT_EQ(data.n_errors,
+              0);
+
+    system_event_release(data.all_threads_done_event);
+}
@@ -0,0 +1,373 @@
+/**
+ *
+ * Emerald (kbi/elude @2012-2015)
+ *
+ */
+#include "test_hash64map.h"
+#include "gtest/gtest.h"
+#include "shared.h"
+#include "system/system_hash64map.h"
+#include "system/system_log.h"
+#include "system/system_time.h"
+#include <map>
+
+#define BENCHMARK_MAX_N_OPS (100000)
+#define N_RANDOM_OPERATIONS (200000)
+
+
+PRIVATE void _on_entry_removed(void* arg)
+{
+    ++(*(unsigned int*) arg);
+}
+
+/** Generates a pseudo-random 64-bit key. Consecutive keys are used by most of the callers, so the benchmark
+ *  uses scrambled ones to avoid favouring any particular hash layout. */
+PRIVATE system_hash64 _get_benchmark_key(uint32_t n)
+{
+    return ((system_hash64) n * 0x9E3779B97F4A7C15ULL) ^ 0x5555555555555555ULL;
+}
+
+
+TEST(Hash64MapTest, InsertGetRemove)
+{
+    system_hash64map map        = system_hash64map_create(sizeof(uint32_t) );
+    uint32_t         n_elements = 0;
+
+    for (uint32_t n = 0;
+                  n < 1000;
+                ++n)
+    {
+        system_hash64map_insert(map,
+                                n * 3,
+                                (void*) (intptr_t) (n + 1),
+                                NULL,  /* callback */
+                                NULL); /* callback_argument */
+    }
+
+    system_hash64map_get_property(map,
+                                  SYSTEM_HASH64MAP_PROPERTY_N_ELEMENTS,
+                                 &n_elements);
+
+    ASSERT_EQ(n_elements,
+              1000);
+
+    for (uint32_t n = 0;
+                  n < 3000;
+                ++n)
+    {
+        uint32_t value = 0;
+
+        if ((n % 3) == 0)
+        {
+            ASSERT_TRUE(system_hash64map_contains(map,
+                                                  n) );
+            ASSERT_TRUE(system_hash64map_get     (map,
+                                                  n,
+                                                 &value) );
+            ASSERT_EQ  (value,
+                        n / 3 + 1);
+        }
+        else
+        {
+            ASSERT_FALSE(system_hash64map_get(map,
+                                              n,
+                                             &value) );
+        }
+    }
+
+    /* Remove every other entry */
+    for (uint32_t n = 0;
+                  n < 1000;
+                n += 2)
+    {
+        ASSERT_TRUE(system_hash64map_remove(map,
+                                            n * 3) );
+    }
+
+    ASSERT_FALSE(system_hash64map_remove(map,
+                                         0) );
+
+    for (uint32_t n = 0;
+                  n < 1000;
+                ++n)
+    {
+        uint32_t value = 0;
+
+        ASSERT_EQ(system_hash64map_get(map,
+                                       n * 3,
+                                      &value),
+                  (n % 2) != 0);
+    }
+
+    /* Iteration should visit all remaining entries exactly once */
+    std::map<system_hash64, uint32_t> visited_entries;
+
+    system_hash64map_get_property(map,
+                                  SYSTEM_HASH64MAP_PROPERTY_N_ELEMENTS,
+                                 &n_elements);
+
+    ASSERT_EQ(n_elements,
+              500);
+
+    for (uint32_t n_element = 0;
+                  n_element < n_elements;
+                ++n_element)
+    {
+        system_hash64 hash  = 0;
+        uint32_t      value = 0;
+
+        ASSERT_TRUE(system_hash64map_get_element_at(map,
+                                                    n_element,
+                                                   &value,
+                                                   &hash) );
+        ASSERT_EQ  (value,
+                    hash / 3 + 1);
+
+        visited_entries[hash]++;
+    }
+
+    ASSERT_EQ(visited_entries.size(),
+              500);
+    ASSERT_FALSE(system_hash64map_get_element_at(map,
+                                                 n_elements,
+                                                 NULL,
+                                                 NULL) );
+
+    system_hash64map_release(map);
+}
+
+TEST(Hash64MapTest, DuplicateHashes)
+{
+    system_hash64map map   = system_hash64map_create(sizeof(void*) );
+    void*            value = NULL;
+
+    system_hash64map_insert(map, 7, (void*) 1, NULL, NULL);
+    system_hash64map_insert(map, 7, (void*) 2, NULL, NULL);
+
+    ASSERT_TRUE(system_hash64map_get(map,
+                                     7,
+                                    &value) );
+    ASSERT_TRUE(value == (void*) 1 || value == (void*) 2);
+
+    ASSERT_TRUE (system_hash64map_remove  (map, 7) );
+    ASSERT_TRUE (system_hash64map_contains(map, 7) );
+    ASSERT_TRUE (system_hash64map_remove  (map, 7) );
+    ASSERT_FALSE(system_hash64map_contains(map, 7) );
+
+    system_hash64map_release(map);
+}
+
+TEST(Hash64MapTest, RemoveCallbacks)
+{
+    system_hash64map map         = system_hash64map_create(sizeof(void*),
+                                                           true); /* should_be_thread_safe */
+    unsigned int     n_callbacks = 0;
+
+    for (uint32_t n = 0;
+                  n < 100;
+                ++n)
+    {
+        system_hash64map_insert(map,
+                                n,
+                                NULL, /* element */
+                                _on_entry_removed,
+                               &n_callbacks);
+    }
+
+    system_hash64map_remove(map,
+                            50);
+
+    ASSERT_EQ(n_callbacks,
+              1);
+
+    system_hash64map_clear(map);
+
+    ASSERT_EQ   (n_callbacks,
+                 100);
+    ASSERT_FALSE(system_hash64map_contains(map,
+                                           0) );
+
+    /* The map should remain usable after being cleared */
+    system_hash64map_insert(map, 123, NULL, NULL, NULL);
+
+    ASSERT_TRUE(system_hash64map_contains(map,
+                                          123) );
+
+    system_hash64map_release(map);
+
+    ASSERT_EQ(n_callbacks,
+              100);
+}
+
+TEST(Hash64MapTest, IsEqual)
+{
+    system_hash64map map_1 = system_hash64map_create(sizeof(void*) );
+    system_hash64map map_2 = system_hash64map_create(sizeof(void*) );
+
+    for (uint32_t n = 0;
+                  n < 100;
+                ++n)
+    {
+        system_hash64map_insert(map_1, n,      (void*) (intptr_t) n, NULL, NULL);
+        system_hash64map_insert(map_2, 99 - n, (void*) (intptr_t) (99 - n), NULL, NULL);
+    }
+
+    ASSERT_TRUE(system_hash64map_is_equal(map_1,
+                                          map_2) );
+
+    system_hash64map_remove(map_2, 10);
+    system_hash64map_insert(map_2, 10, (void*) 11, NULL, NULL);
+
+    ASSERT_FALSE(system_hash64map_is_equal(map_1,
+                                           map_2) );
+
+    system_hash64map_release(map_1);
+    system_hash64map_release(map_2);
+}
+
+/* Exercises incremental growth with a random mix of operations and compares the outcome against std::map */
+TEST(Hash64MapTest, RandomOperations)
+{
+    system_hash64map             map = system_hash64map_create(sizeof(uint32_t) );
+    std::map<system_hash64, int> reference_map;
+
+    srand(0x1234);
+
+    for (uint32_t n_operation = 0;
+                  n_operation < N_RANDOM_OPERATIONS;
+                ++n_operation)
+    {
+        const system_hash64 hash = rand() % 20000;
+
+        if ((rand() % 3) != 0)
+        {
+            if (reference_map.find(hash) == reference_map.end() )
+            {
+                reference_map[hash] = n_operation;
+
+                system_hash64map_insert(map,
+                                        hash,
+                                        (void*) (intptr_t) n_operation,
+                                        NULL,
+                                        NULL);
+            }
+        }
+        else
+        {
+            ASSERT_EQ(system_hash64map_remove(map,
+                                              hash),
+                      reference_map.erase(hash) == 1);
+        }
+
+        if ((n_operation % 1000) == 0)
+        {
+            uint32_t n_elements = 0;
+
+            system_hash64map_get_property(map,
+                                          SYSTEM_HASH64MAP_PROPERTY_N_ELEMENTS,
+                                         &n_elements);
+
+            ASSERT_EQ(n_elements,
+                      reference_map.size() );
+
+            for (std::map<system_hash64, int>::const_iterator it  = reference_map.begin();
+                                                              it != reference_map.end();
+                                                            ++it)
+            {
+                uint32_t value = 0;
+
+                ASSERT_TRUE(system_hash64map_get(map,
+                                                 it->first,
+                                                &value) );
+                ASSERT_EQ  (value,
+                            (uint32_t) it->second);
+            }
+        }
+    }
+
+    system_hash64map_release(map);
+}
+
+/* Measures insertion, lookup and removal times for maps of growing sizes. Disabled by default, since
+ * it takes a while to complete. Run with --gtest_also_run_disabled_tests. */
+TEST(Hash64MapTest, DISABLED_Benchmark)
+{
+    const uint32_t n_entries_array[] =
+    {
+        1000,
+        10000,
+        100000,
+        1000000,
+        10000000
+    };
+    const uint32_t n_entries_array_size = sizeof(n_entries_array) / sizeof(n_entries_array[0]);
+
+    for (uint32_t n_size = 0;
+                  n_size < n_entries_array_size;
+                ++n_size)
+    {
+        const uint32_t   n_entries   = n_entries_array[n_size];
+        const uint32_t   n_ops       = (n_entries < BENCHMARK_MAX_N_OPS) ? n_entries : BENCHMARK_MAX_N_OPS;
+        system_hash64map map         = system_hash64map_create(sizeof(void*) );
+        uint32_t         n_found     = 0;
+        __uint64         time_start  = 0;
+        __uint64         time_insert = 0;
+        __uint64         time_get    = 0;
+        __uint64         time_remove = 0;
+        void*            value       = NULL;
+
+        /* Insertions */
+        time_start = system_time_now_usec();
+        {
+            for (uint32_t n = 0;
+                          n < n_entries;
+                        ++n)
+            {
+                system_hash64map_insert(map,
+                                        _get_benchmark_key(n),
+                                        (void*) (intptr_t) n,
+                                        NULL,
+                                        NULL);
+            }
+        }
+        time_insert = system_time_now_usec() - time_start;
+
+        /* Lookups */
+        time_start = system_time_now_usec();
+        {
+            for (uint32_t n = 0;
+                          n < n_ops;
+                        ++n)
+            {
+                n_found += system_hash64map_get(map,
+                                                _get_benchmark_key((n * 7919) % n_entries),
+                                               &value) ? 1 : 0;
+            }
+        }
+        time_get = system_time_now_usec() - time_start;
+
+        ASSERT_EQ(n_found,
+                  n_ops);
+
+        /* Removals */
+        time_start = system_time_now_usec();
+        {
+            for (uint32_t n = 0;
+                          n < n_ops;
+                        ++n)
+            {
+                system_hash64map_remove(map,
+                                        _get_benchmark_key(n) );
+            }
+        }
+        time_remove = system_time_now_usec() - time_start;
+
+        LOG_INFO("[%8u entries] ns per insert: %8.1f, get: %8.1f, remove: %8.1f",
+                 n_entries,
+                 double(time_insert) * 1000.0 / n_entries,
+                 double(time_get)    * 1000.0 / n_ops,
+                 double(time_remove) * 1000.0 / n_ops);
+
+        system_hash64map_release(map);
+    }
+}
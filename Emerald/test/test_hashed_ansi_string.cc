@@ -0,0 +1,328 @@
+/**
+ *
+ * Emerald (kbi/elude @2016)
+ *
+ */
+#include "test_hashed_ansi_string.h"
+#include "gtest/gtest.h"
+#include "shared.h"
+#include "system/system_atomics.h"
+#include "system/system_event.h"
+#include "system/system_hash64.h"
+#include "system/system_hashed_ansi_string.h"
+#include "system/system_log.h"
+#include "system/system_threads.h"
+#include "system/system_time.h"
+#include <set>
+#include <stdio.h>
+#include <string.h>
+#include <vector>
+
+#define BENCHMARK_N_ITERATIONS (64)
+#define BENCHMARK_N_STRINGS    (8192)
+#define N_STRINGS              (20000)
+#define N_THREADS              (4)
+
+
+typedef struct
+{
+    const std::vector<std::string>*        strings_ptr;
+    std::vector<system_hashed_ansi_string> results[N_THREADS];
+    unsigned int                           n_iterations;
+    volatile unsigned int                  n_threads_started;
+    system_event                           start_event;
+} thread_test_data;
+
+
+/** Interns all strings assigned to the test, starting from a thread-specific offset so that
+ *  threads race to create the same strings. */
+PRIVATE void _thread_entrypoint(system_threads_entry_point_argument arg)
+{
+    thread_test_data*  data_ptr     = (thread_test_data*) arg;
+    const unsigned int n_strings    = (unsigned int) data_ptr->strings_ptr->size();
+    const unsigned int thread_index = system_atomics_increment(&data_ptr->n_threads_started) - 1;
+
+    data_ptr->results[thread_index].resize(n_strings);
+
+    /* Make sure all threads start interning at the same time */
+    system_event_wait_single(data_ptr->start_event);
+
+    for (unsigned int n_iteration = 0;
+                      n_iteration < data_ptr->n_iterations;
+                    ++n_iteration)
+    {
+        for (unsigned int n = 0;
+                          n < n_strings;
+                        ++n)
+        {
+            const unsigned int n_string = (n + thread_index * n_strings / N_THREADS) % n_strings;
+
+            data_ptr->results[thread_index][n_string] = system_hashed_ansi_string_create( (*data_ptr->strings_ptr)[n_string].c_str() );
+        }
+    }
+}
+
+/** Runs _thread_entrypoint() on N_THREADS threads and waits until all of them finish. */
+PRIVATE void _run_threads(thread_test_data* data_ptr)
+{
+    system_event thread_wait_events[N_THREADS];
+
+    data_ptr->n_threads_started = 0;
+    data_ptr->start_event       = system_event_create(true); /* manual_reset */
+
+    for (unsigned int n_thread = 0;
+                      n_thread < N_THREADS;
+                    ++n_thread)
+    {
+        system_threads_spawn(_thread_entrypoint,
+                             data_ptr,
+                             thread_wait_events + n_thread,
+                             system_hashed_ansi_string_create("Hashed ansi string test thread") );
+    }
+
+    system_event_set(data_ptr->start_event);
+
+    system_event_wait_multiple(thread_wait_events,
+                               N_THREADS,
+                               true, /* wait_on_all_objects */
+                               SYSTEM_TIME_INFINITE,
+                               NULL); /* out_result_ptr */
+
+    system_event_release(data_ptr->start_event);
+}
+
+/** Generates @param n_strings unique strings, which look like typical asset names. */
+PRIVATE void _get_test_strings(const char*               prefix,
+                               unsigned int              n_strings,
+                               std::vector<std::string>* out_strings_ptr)
+{
+    char buffer[128];
+
+    out_strings_ptr->resize(n_strings);
+
+    for (unsigned int n_string = 0;
+                      n_string < n_strings;
+                    ++n_string)
+    {
+        snprintf(buffer,
+                 sizeof(buffer),
+                 "%s/mesh_%u/material_%u",
+                 prefix,
+                 n_string,
+                 n_string % 7);
+
+        (*out_strings_ptr)[n_string] = buffer;
+    }
+}
+
+
+TEST(HashedAnsiStringTest, ConcurrentCreatesReturnSameInstances)
+{
+    thread_test_data         data;
+    std::vector<std::string> strings;
+
+    _get_test_strings("concurrent",
+                      N_STRINGS,
+                     &strings);
+
+    data.n_iterations = 1;
+    data.strings_ptr  = &strings;
+
+    _run_threads(&data);
+
+    for (unsigned int n_string = 0;
+                      n_string < N_STRINGS;
+                    ++n_string)
+    {
+        const system_hashed_ansi_string expected_string = system_hashed_ansi_string_create(strings[n_string].c_str() );
+
+        ASSERT_STREQ(system_hashed_ansi_string_get_buffer(expected_string),
+                     strings[n_string].c_str() );
+
+        for (unsigned int n_thread = 0;
+                          n_thread < N_THREADS;
+                        ++n_thread)
+        {
+            ASSERT_EQ(expected_string,
+                      data.results[n_thread][n_string]);
+        }
+    }
+}
+
+TEST(HashedAnsiStringTest, EqualHashesDoNotMergeStrings)
+{
+    /* The strings below used to share their hashes. */
+    static const char* colliding_strings[] =
+    {
+        "Aa",
+        "BB",
+        "AaAa",
+        "AaBB",
+        "BBAa",
+        "BBBB"
+    };
+    static const unsigned int n_colliding_strings = sizeof(colliding_strings) / sizeof(colliding_strings[0]);
+
+    system_hashed_ansi_string strings[n_colliding_strings];
+
+    for (unsigned int n_string = 0;
+                      n_string < n_colliding_strings;
+                    ++n_string)
+    {
+        strings[n_string] = system_hashed_ansi_string_create(colliding_strings[n_string]);
+
+        ASSERT_STREQ(system_hashed_ansi_string_get_buffer(strings[n_string]),
+                     colliding_strings[n_string]);
+        ASSERT_TRUE (system_hashed_ansi_string_is_equal_to_raw_string(strings[n_string],
+                                                                      colliding_strings[n_string]) );
+
+        for (unsigned int n_prev_string = 0;
+                          n_prev_string < n_string;
+                        ++n_prev_string)
+        {
+            ASSERT_NE   (strings[n_prev_string],
+                         strings[n_string]);
+            ASSERT_FALSE(system_hashed_ansi_string_is_equal_to_hash_string(strings[n_prev_string],
+                                                                           strings[n_string]) );
+        }
+    }
+}
+
+TEST(HashedAnsiStringTest, HashesOfSimilarStringsDiffer)
+{
+    std::set<system_hash64>  hashes;
+    std::vector<std::string> strings;
+
+    _get_test_strings("hash",
+                      N_STRINGS,
+                     &strings);
+
+    /* Include strings of all lengths handled by separate code paths */
+    for (unsigned int length = 0;
+                      length < 128;
+                    ++length)
+    {
+        strings.push_back(std::string(length, 'a') );
+        strings.push_back(std::string(length, 'a') + "b");
+    }
+
+    for (unsigned int n_string = 0;
+                      n_string < strings.size();
+                    ++n_string)
+    {
+        hashes.insert(system_hash64_calculate(strings[n_string].c_str(),
+                                              (uint32_t) strings[n_string].length() ));
+    }
+
+    ASSERT_EQ(hashes.size(),
+              strings.size() );
+}
+
+TEST(HashedAnsiStringTest, SameTextReturnsSameInstance)
+{
+    std::vector<system_hashed_ansi_string> results(N_STRINGS);
+    std::vector<std::string>               strings;
+
+    _get_test_strings("same_text",
+                      N_STRINGS,
+                     &strings);
+
+    for (unsigned int n_string = 0;
+                      n_string < N_STRINGS;
+                    ++n_string)
+    {
+        results[n_string] = system_hashed_ansi_string_create(strings[n_string].c_str() );
+
+        ASSERT_EQ   (system_hashed_ansi_string_get_length(results[n_string]),
+                     strings[n_string].length() );
+        ASSERT_STREQ(system_hashed_ansi_string_get_buffer(results[n_string]),
+                     strings[n_string].c_str() );
+    }
+
+    /* Look the strings up again, after the tables have grown */
+    for (unsigned int n_string = 0;
+                      n_string < N_STRINGS;
+                    ++n_string)
+    {
+        std::string copy(strings[n_string]);
+
+        ASSERT_EQ(system_hashed_ansi_string_create(copy.c_str() ),
+                  results[n_string]);
+    }
+
+    ASSERT_EQ(system_hashed_ansi_string_create(""),
+              system_hashed_ansi_string_get_default_empty_string() );
+}
+
+TEST(HashedAnsiStringTest, StatisticsAreReported)
+{
+    float                     hit_rate          = 0.0f;
+    __uint64                  n_lookups_after   = 0;
+    __uint64                  n_lookups_before  = 0;
+    unsigned int              n_strings_after   = 0;
+    unsigned int              n_strings_before  = 0;
+    system_hashed_ansi_string string            = NULL;
+
+    system_hashed_ansi_string_get_property(SYSTEM_HASHED_ANSI_STRING_PROPERTY_N_LOOKUPS,
+                                          &n_lookups_before);
+    system_hashed_ansi_string_get_property(SYSTEM_HASHED_ANSI_STRING_PROPERTY_N_STRINGS,
+                                          &n_strings_before);
+
+    string = system_hashed_ansi_string_create("A string which is only created by the statistics test");
+
+    ASSERT_EQ(string,
+              system_hashed_ansi_string_create("A string which is only created by the statistics test") );
+
+    system_hashed_ansi_string_get_property(SYSTEM_HASHED_ANSI_STRING_PROPERTY_N_LOOKUPS,
+                                          &n_lookups_after);
+    system_hashed_ansi_string_get_property(SYSTEM_HASHED_ANSI_STRING_PROPERTY_N_STRINGS,
+                                          &n_strings_after);
+    system_hashed_ansi_string_get_property(SYSTEM_HASHED_ANSI_STRING_PROPERTY_HIT_RATE,
+                                          &hit_rate);
+
+    ASSERT_EQ(n_lookups_after,
+              n_lookups_before + 2);
+    ASSERT_EQ(n_strings_after,
+              n_strings_before + 1);
+    ASSERT_GT(hit_rate,
+              0.0f);
+    ASSERT_LT(hit_rate,
+              1.0f);
+}
+
+TEST(HashedAnsiStringTest, DISABLED_MultiThreadedInterningBenchmark)
+{
+    __uint64                 duration_usec;
+    thread_test_data         data;
+    float                    hit_rate       = 0.0f;
+    __uint64                 n_cache_hits   = 0;
+    __uint64                 n_lookups      = 0;
+    __uint64                 start_time_usec;
+    std::vector<std::string> strings;
+
+    _get_test_strings("benchmark",
+                      BENCHMARK_N_STRINGS,
+                     &strings);
+
+    data.n_iterations = BENCHMARK_N_ITERATIONS;
+    data.strings_ptr  = &strings;
+
+    start_time_usec = system_time_now_usec();
+    {
+        _run_threads(&data);
+    }
+    duration_usec = system_time_now_usec() - start_time_usec;
+
+    system_hashed_ansi_string_get_property(SYSTEM_HASHED_ANSI_STRING_PROPERTY_HIT_RATE,
+                                          &hit_rate);
+    system_hashed_ansi_string_get_property(SYSTEM_HASHED_ANSI_STRING_PROPERTY_N_CACHE_HITS,
+                                          &n_cache_hits);
+    system_hashed_ansi_string_get_property(SYSTEM_HASHED_ANSI_STRING_PROPERTY_N_LOOKUPS,
+                                          &n_lookups);
+
+    LOG_INFO("Interned strings per second on [%d] threads: %12.0f (hit rate: %.2f%%, thread cache hits: %.2f%%)",
+             N_THREADS,
+             double(N_THREADS * BENCHMARK_N_ITERATIONS * BENCHMARK_N_STRINGS) * 1000000.0 / double(duration_usec + 1),
+             hit_rate * 100.0f,
+             double(n_cache_hits) * 100.0 / double(n_lookups) );
+}
@@ -0,0 +1,315 @@
+/**
+ *
+ * Emerald (kbi/elude @2016)
+ *
+ */
+#include "test_log.h"
+#include "gtest/gtest.h"
+#include "shared.h"
+#include "system/system_atomics.h"
+#include "system/system_event.h"
+#include "system/system_hashed_ansi_string.h"
+#include "system/system_log.h"
+#include "system/system_threads.h"
+#include "system/system_time.h"
+#include <stdio.h>
+#include <string.h>
+#include <string>
+
+#define BENCHMARK_N_ENTRIES_PER_THREAD (100000)
+#define N_ENTRIES_PER_THREAD           (2000)
+#define N_THREADS                      (8)
+
+
+typedef struct
+{
+    unsigned int          n_entries_per_thread;
+    volatile unsigned int n_threads_started;
+    system_event          start_event;
+} thread_test_data;
+
+
+/** Returns contents of the log file. Only entries which have been flushed are guaranteed to be included. */
+PRIVATE std::string _get_log_file_contents()
+{
+    char        buffer[4096];
+    FILE*       file_handle;
+    size_t      n_bytes_read;
+    std::string result;
+
+    system_log_flush();
+
+    file_handle = fopen("log.txt",
+                        "rb");
+
+    if (file_handle == NULL)
+    {
+        return result;
+    }
+
+    while ( (n_bytes_read = fread(buffer,
+                                  1, /* _ElementSize */
+                                  sizeof(buffer),
+                                  file_handle)) > 0)
+    {
+        result.append(buffer,
+                      n_bytes_read);
+    }
+
+    fclose(file_handle);
+
+    return result;
+}
+
+/** Logs the requested number of entries. */
+PRIVATE void _thread_entrypoint(system_threads_entry_point_argument arg)
+{
+    thread_test_data*  data_ptr     = (thread_test_data*) arg;
+    const unsigned int thread_index = system_atomics_increment(&data_ptr->n_threads_started) - 1;
+
+    /* Make sure all threads start logging at the same time */
+    system_event_wait_single(data_ptr->start_event);
+
+    for (unsigned int n_entry = 0;
+                      n_entry < data_ptr->n_entries_per_thread;
+                    ++n_entry)
+    {
+        LOG_INFO("Log test thread [%u] entry [%u] value [%.3f] name [%s]",
+                 thread_index,
+                 n_entry,
+                 float(n_entry) * 0.5f,
+                 "entity");
+    }
+}
+
+/** Spawns N_THREADS threads logging concurrently and waits until they quit. */
+PRIVATE void _run_threads(thread_test_data* data_ptr)
+{
+    system_event thread_wait_events[N_THREADS];
+
+    data_ptr->n_threads_started = 0;
+    data_ptr->start_event       = system_event_create(true); /* manual_reset */
+
+    for (unsigned int n_thread = 0;
+                      n_thread < N_THREADS;
+                    ++n_thread)
+    {
+        system_threads_spawn(_thread_entrypoint,
+                             data_ptr,
+                             thread_wait_events + n_thread,
+                             system_hashed_ansi_string_create("Log test thread") );
+    }
+
+    system_event_set(data_ptr->start_event);
+
+    system_event_wait_multiple(thread_wait_events,
+                               N_THREADS,
+                               true, /* wait_on_all_objects */
+                               SYSTEM_TIME_INFINITE,
+                               NULL); /* out_result_ptr */
+
+    system_event_release(data_ptr->start_event);
+}
+
+
+TEST(LogTest, ArgumentsAreFormattedLikePrintf)
+{
+    char        expected_text[512];
+    const char* null_string   = NULL;
+    int         stack_value   = 0;
+    std::string log_contents;
+    char        mutable_string[32];
+
+    strcpy(mutable_string,
+           "mutable");
+
+    /* Entries logged by earlier tests may still fill this thread's ring, in which case the entry would be dropped */
+    system_log_flush();
+
+    LOG_RAW("Log format test: [%d] [%u] [%x] [%08X] [%5.2f] [%-6s] [%lld] [%c] [%%] [%*d] [%.*f] [%hd] [%s] [%s] [%p]",
+            -42,
+            4000000000u,
+            -1,
+            0xBEEFu,
+            3.14159,
+            "ab",
+            -1234567890123ll,
+            'q',
+            7,
+            13,
+            2,
+            2.71828,
+            70000,
+            mutable_string,
+            null_string,
+            &stack_value);
+
+    /* The entry has been captured. Make sure changes made afterward do not leak into the output. */
+    strcpy(mutable_string,
+           "changed");
+
+    snprintf(expected_text,
+             sizeof(expected_text),
+             "Log format test: [%d] [%u] [%x] [%08X] [%5.2f] [%-6s] [%lld] [%c] [%%] [%*d] [%.*f] [%hd] [%s] [%s] [%p]",
+             -42,
+             4000000000u,
+             -1,
+             0xBEEFu,
+             3.14159,
+             "ab",
+             -1234567890123ll,
+             'q',
+             7,
+             13,
+             2,
+             2.71828,
+             (short) 70000,
+             "mutable",
+             "(null)",
+             &stack_value);
+
+    log_contents = _get_log_file_contents();
+
+    ASSERT_NE(log_contents.find(expected_text),
+              std::string::npos);
+}
+
+TEST(LogTest, EntriesBelowLevelAreDropped)
+{
+    system_log_priority current_level = LOGLEVEL_TRACE;
+    system_log_priority new_level     = LOGLEVEL_TRACE;
+    std::string         log_contents;
+    __uint64            n_written_entries_after;
+    __uint64            n_written_entries_before;
+
+    system_log_get_property(SYSTEM_LOG_PROPERTY_LEVEL,
+                           &current_level);
+    system_log_set_level   (LOGLEVEL_ERROR);
+    system_log_get_property(SYSTEM_LOG_PROPERTY_LEVEL,
+                           &new_level);
+
+    ASSERT_EQ(new_level,
+              LOGLEVEL_ERROR);
+
+    system_log_flush       ();
+    system_log_get_property(SYSTEM_LOG_PROPERTY_N_WRITTEN_ENTRIES,
+                           &n_written_entries_before);
+
+    LOG_INFO ("Log level test: information entry [%d]",
+              1);
+    LOG_ERROR("Log level test: error entry [%d]",
+              2);
+
+    system_log_set_level(current_level);
+
+    log_contents = _get_log_file_contents();
+
+    system_log_get_property(SYSTEM_LOG_PROPERTY_N_WRITTEN_ENTRIES,
+                           &n_written_entries_after);
+
+    ASSERT_EQ(log_contents.find("Log level test: information entry [1]"),
+              std::string::npos);
+    ASSERT_NE(log_contents.find("Log level test: error entry [2]"),
+              std::string::npos);
+    ASSERT_EQ(n_written_entries_after - n_written_entries_before,
+              1);
+}
+
+TEST(LogTest, EntriesFromManyThreadsAreAllAccountedFor)
+{
+    thread_test_data data;
+    std::string      log_contents;
+    __uint64         n_dropped_entries_after;
+    __uint64         n_dropped_entries_before;
+    __uint64         n_written_entries_after;
+    __uint64         n_written_entries_before;
+    size_t           search_start_index = 0;
+
+    system_log_flush       ();
+    system_log_get_property(SYSTEM_LOG_PROPERTY_N_DROPPED_ENTRIES,
+                           &n_dropped_entries_before);
+    system_log_get_property(SYSTEM_LOG_PROPERTY_N_WRITTEN_ENTRIES,
+                           &n_written_entries_before);
+
+    data.n_entries_per_thread = N_ENTRIES_PER_THREAD;
+
+    _run_threads(&data);
+
+    log_contents = _get_log_file_contents();
+
+    system_log_get_property(SYSTEM_LOG_PROPERTY_N_DROPPED_ENTRIES,
+                           &n_dropped_entries_after);
+    system_log_get_property(SYSTEM_LOG_PROPERTY_N_WRITTEN_ENTRIES,
+                           &n_written_entries_after);
+
+    /* Each entry must have either been written or reported as dropped */
+    ASSERT_EQ((n_written_entries_after - n_written_entries_before) + (n_dropped_entries_after - n_dropped_entries_before),
+              N_THREADS * N_ENTRIES_PER_THREAD);
+
+    /* The very first entry of each thread always fits in its ring */
+    for (unsigned int n_thread = 0;
+                      n_thread < N_THREADS;
+                    ++n_thread)
+    {
+        char expected_text[128];
+
+        snprintf(expected_text,
+                 sizeof(expected_text),
+                 "Log test thread [%u] entry [0] value [0.000] name [entity]",
+                 n_thread);
+
+        ASSERT_NE(log_contents.find(expected_text),
+                  std::string::npos);
+    }
+
+    /* Entries reported by a single thread must be written in order */
+    for (unsigned int n_entry = 0;
+                      n_entry < LOG_RING_BUFFER_CAPACITY;
+                    ++n_entry)
+    {
+        char   expected_text[128];
+        size_t index;
+
+        snprintf(expected_text,
+                 sizeof(expected_text),
+                 "Log test thread [0] entry [%u] ",
+                 n_entry);
+
+        index = log_contents.find(expected_text,
+                                  search_start_index);
+
+        ASSERT_NE(index,
+                  std::string::npos);
+
+        search_start_index = index;
+    }
+}
+
+TEST(LogTest, DISABLED_MultiThreadedLoggingBenchmark)
+{
+    thread_test_data data;
+    __uint64         duration_usec;
+    __uint64         n_dropped_entries_after;
+    __uint64         n_dropped_entries_before;
+    __uint64         start_time_usec;
+
+    system_log_flush       ();
+    system_log_get_property(SYSTEM_LOG_PROPERTY_N_DROPPED_ENTRIES,
+                           &n_dropped_entries_before);
+
+    data.n_entries_per_thread = BENCHMARK_N_ENTRIES_PER_THREAD;
+
+    start_time_usec = system_time_now_usec();
+    {
+        _run_threads(&data);
+    }
+    duration_usec = system_time_now_usec() - start_time_usec;
+
+    system_log_get_property(SYSTEM_LOG_PROPERTY_N_DROPPED_ENTRIES,
+                           &n_dropped_entries_after);
+
+    LOG_INFO("Reported log entries per second on [%d] threads: %12.0f (dropped: %.2f%%)",
+             N_THREADS,
+             double(N_THREADS * BENCHMARK_N_ENTRIES_PER_THREAD) * 1000000.0 / double(duration_usec + 1),
+             double(n_dropped_entries_after - n_dropped_entries_before) * 100.0 / double(N_THREADS * BENCHMARK_N_ENTRIES_PER_THREAD) );
+}
@@ -0,0 +1,602 @@
+/**
+ *
+ * Emerald (kbi/elude @2016)
+ *
+ */
+#include "test_math_matrix4x4.h"
+#include "gtest/gtest.h"
+#include "shared.h"
+#include "system/system_log.h"
+#include "system/system_math_matrix4x4.h"
+#include "system/system_math_vector.h"
+#include "system/system_matrix4x4.h"
+#include "system/system_time.h"
+#include <math.h>
+#include <stdlib.h>
+
+#define BENCHMARK_N_FRAMES           (2000)
+#define BENCHMARK_N_NODES            (256)
+#define EPSILON                      (1e-4f)
+#define N_RANDOM_MATRICES            (1000)
+
+
+/** Returns a pseudo-random float from <-1, 1>. */
+PRIVATE float _get_random_float()
+{
+    return float(rand() ) / float(RAND_MAX) * 2.0f - 1.0f;
+}
+
+/** Fills a value matrix and a handle matrix with the same random affine transformation. */
+PRIVATE void _get_random_affine_matrix(system_math_matrix4x4* out_matrix_ptr,
+                                       system_matrix4x4       out_matrix_handle)
+{
+    for (unsigned int n_element = 0;
+                      n_element < 12;
+                    ++n_element)
+    {
+        out_matrix_ptr->data[n_element] = _get_random_float() * 4.0f;
+    }
+
+    out_matrix_ptr->data[12] = 0.0f;
+    out_matrix_ptr->data[13] = 0.0f;
+    out_matrix_ptr->data[14] = 0.0f;
+    out_matrix_ptr->data[15] = 1.0f;
+
+    system_matrix4x4_set_from_row_major_raw(out_matrix_handle,
+                                            out_matrix_ptr->data);
+}
+
+/** Checks if two sets of floats are equal, allowing for a relative error. */
+PRIVATE bool _is_equal(const float* a_ptr,
+                       const float* b_ptr,
+                       unsigned int n_values)
+{
+    for (unsigned int n_value = 0;
+                      n_value < n_values;
+                    ++n_value)
+    {
+        const float scale = fmaxf(1.0f,
+                                  fmaxf(fabsf(a_ptr[n_value]),
+                                        fabsf(b_ptr[n_value]) ));
+
+        if (fabsf(a_ptr[n_value] - b_ptr[n_value]) > EPSILON * scale)
+        {
+            return false;
+        }
+    }
+
+    return true;
+}
+
+
+TEST(MathMatrix4x4Test, AABBFrustumTestMatchesCornerTest)
+{
+    const float      camera_location[] = {0.0f, 0.0f, 5.0f};
+    const float      look_at_point  [] = {0.0f, 0.0f, 0.0f};
+    const float      up_vector      [] = {0.0f, 1.0f, 0.0f};
+    unsigned int     n_culled          = 0;
+    system_matrix4x4 model_handle      = system_matrix4x4_create();
+    system_matrix4x4 projection_handle = system_matrix4x4_create_perspective_projection_matrix(DEG_TO_RAD(60.0f),
+                                                                                                1.0f,   /* ar */
+                                                                                                0.1f,   /* z_near */
+                                                                                                10.0f); /* z_far */
+    system_matrix4x4 view_handle       = system_matrix4x4_create_lookat_matrix(camera_location,
+                                                                               look_at_point,
+                                                                               up_vector);
+    system_matrix4x4 vp_handle         = system_matrix4x4_create_by_mul(projection_handle,
+                                                                        view_handle);
+
+    srand(0x1234);
+
+    for (unsigned int n_iteration = 0;
+                      n_iteration < N_RANDOM_MATRICES;
+                    ++n_iteration)
+    {
+        float                 aabb_max[3];
+        float                 aabb_min[3];
+        system_math_matrix4x4 model;
+        system_math_matrix4x4 mvp;
+        bool                  is_outside_expected = false;
+        system_math_matrix4x4 vp;
+
+        _get_random_affine_matrix(&model,
+                                  model_handle);
+
+        for (unsigned int n_component = 0;
+                          n_component < 3;
+                        ++n_component)
+        {
+            aabb_min[n_component] = _get_random_float();
+            aabb_max[n_component] = aabb_min[n_component] + fabsf(_get_random_float() ) + 0.01f;
+        }
+
+        /* Reference: transform all corners into world space and test them against normalized world-space planes */
+        for (unsigned int n_plane = 0;
+                          n_plane < SYSTEM_MATH_MATRIX4X4_N_CLIPPING_PLANES && !is_outside_expected;
+                        ++n_plane)
+        {
+            unsigned int n_vertices_inside = 0;
+            float        plane[4];
+
+            system_matrix4x4_get_clipping_plane          (vp_handle,
+                                                          (system_matrix4x4_clipping_plane) n_plane,
+                                                          plane);
+            system_math_vector_normalize4_use_vec3_length(plane,
+                                                          plane);
+
+            for (unsigned int n_vertex = 0;
+                              n_vertex < 8;
+                            ++n_vertex)
+            {
+                float       world_vertex[4];
+                const float vertex      [4] =
+                {
+                    (n_vertex & 1) ? aabb_max[0] : aabb_min[0],
+                    (n_vertex & 2) ? aabb_max[1] : aabb_min[1],
+                    (n_vertex & 4) ? aabb_max[2] : aabb_min[2],
+                    1.0f
+                };
+
+                system_matrix4x4_multiply_by_vector4(model_handle,
+                                                     vertex,
+                                                     world_vertex);
+
+                if (plane[0] * world_vertex[0] + plane[1] * world_vertex[1] + plane[2] * world_vertex[2] + plane[3] >= 0.0f)
+                {
+                    n_vertices_inside++;
+                }
+            }
+
+            is_outside_expected = (n_vertices_inside == 0);
+        }
+
+        system_math_matrix4x4_set_from_row_major(system_matrix4x4_get_row_major_data(vp_handle),
+                                                &vp);
+        system_math_matrix4x4_mul               (&vp,
+                                                 &model,
+                                                 &mvp);
+
+        ASSERT_EQ(system_math_matrix4x4_is_aabb_outside_frustum(&mvp,
+                                                                aabb_min,
+                                                                aabb_max),
+                  is_outside_expected);
+
+        if (is_outside_expected)
+        {
+            n_culled++;
+        }
+    }
+
+    /* Make sure both outcomes have been exercised */
+    ASSERT_GT(n_culled,
+              0);
+    ASSERT_LT(n_culled,
+              N_RANDOM_MATRICES);
+
+    system_matrix4x4_release(model_handle);
+    system_matrix4x4_release(projection_handle);
+    system_matrix4x4_release(view_handle);
+    system_matrix4x4_release(vp_handle);
+}
+
+TEST(MathMatrix4x4Test, BuildersMatchHandleAPI)
+{
+    const float           axis       [] = {0.0f, 0.6f, 0.8f};
+    const float           scale      [] = {2.0f, -3.0f, 0.5f};
+    const float           translation[] = {1.0f, 2.0f, -3.0f};
+    system_math_matrix4x4 matrix;
+    system_matrix4x4      matrix_handle = system_matrix4x4_create();
+
+    system_matrix4x4_set_to_identity  (matrix_handle);
+    system_matrix4x4_rotate           (matrix_handle,
+                                       DEG_TO_RAD(37.0f),
+                                       axis);
+    system_math_matrix4x4_set_rotation(DEG_TO_RAD(37.0f),
+                                       axis,
+                                      &matrix);
+
+    ASSERT_TRUE(_is_equal(matrix.data,
+                          system_matrix4x4_get_row_major_data(matrix_handle),
+                          16) );
+
+    system_matrix4x4_set_to_identity(matrix_handle);
+    system_matrix4x4_scale          (matrix_handle,
+                                     scale);
+    system_math_matrix4x4_set_scale (scale,
+                                    &matrix);
+
+    ASSERT_TRUE(_is_equal(matrix.data,
+                          system_matrix4x4_get_row_major_data(matrix_handle),
+                          16) );
+
+    system_matrix4x4_set_to_identity     (matrix_handle);
+    system_matrix4x4_translate           (matrix_handle,
+                                          translation);
+    system_math_matrix4x4_set_translation(translation,
+                                         &matrix);
+
+    ASSERT_TRUE(_is_equal(matrix.data,
+                          system_matrix4x4_get_row_major_data(matrix_handle),
+                          16) );
+
+    system_matrix4x4_release(matrix_handle);
+}
+
+TEST(MathMatrix4x4Test, ClippingPlanesMatchHandleAPI)
+{
+    const float           camera_location[] = {1.0f, 2.0f, 3.0f};
+    const float           look_at_point  [] = {0.0f, 0.5f, 0.0f};
+    const float           up_vector      [] = {0.0f, 1.0f, 0.0f};
+    float                 planes[SYSTEM_MATH_MATRIX4X4_N_CLIPPING_PLANES][4];
+    system_matrix4x4      projection_handle = system_matrix4x4_create_perspective_projection_matrix(DEG_TO_RAD(45.0f),
+                                                                                                     1.5f,    /* ar */
+                                                                                                     0.1f,    /* z_near */
+                                                                                                     100.0f); /* z_far */
+    system_matrix4x4      view_handle       = system_matrix4x4_create_lookat_matrix(camera_location,
+                                                                                    look_at_point,
+                                                                                    up_vector);
+    system_matrix4x4      vp_handle         = system_matrix4x4_create_by_mul(projection_handle,
+                                                                             view_handle);
+    system_math_matrix4x4 vp;
+
+    system_math_matrix4x4_set_from_row_major (system_matrix4x4_get_row_major_data(vp_handle),
+                                             &vp);
+    system_math_matrix4x4_get_clipping_planes(&vp,
+                                              planes);
+
+    for (unsigned int n_plane = 0;
+                      n_plane < SYSTEM_MATH_MATRIX4X4_N_CLIPPING_PLANES;
+                    ++n_plane)
+    {
+        float expected_plane[4];
+
+        system_matrix4x4_get_clipping_plane          (vp_handle,
+                                                      (system_matrix4x4_clipping_plane) n_plane,
+                                                      expected_plane);
+        system_math_vector_normalize4_use_vec3_length(expected_plane,
+                                                      expected_plane);
+
+        ASSERT_TRUE(_is_equal(planes[n_plane],
+                              expected_plane,
+                              4) );
+    }
+
+    system_matrix4x4_release(projection_handle);
+    system_matrix4x4_release(view_handle);
+    system_matrix4x4_release(vp_handle);
+}
+
+TEST(MathMatrix4x4Test, InvertMatchesHandleAPI)
+{
+    system_math_matrix4x4 matrix;
+    system_matrix4x4      matrix_handle = system_matrix4x4_create();
+    system_math_matrix4x4 result;
+    system_math_matrix4x4 singular_matrix;
+
+    srand(0x4321);
+
+    for (unsigned int n_iteration = 0;
+                      n_iteration < N_RANDOM_MATRICES;
+                    ++n_iteration)
+    {
+        system_math_matrix4x4 identity;
+        system_math_matrix4x4 product;
+
+        /* Use full 4x4 matrices, so that the projective part of the inverse is also exercised */
+        for (unsigned int n_element = 0;
+                          n_element < 16;
+                        ++n_element)
+        {
+            matrix.data[n_element] = _get_random_float();
+        }
+
+        /* Keep the matrix well-conditioned */
+        for (unsigned int n_diagonal = 0;
+                          n_diagonal < 4;
+                        ++n_diagonal)
+        {
+            matrix.data[n_diagonal * 5] += 4.0f;
+        }
+
+        system_matrix4x4_set_from_row_major_raw(matrix_handle,
+                                                matrix.data);
+
+        ASSERT_TRUE(system_matrix4x4_invert    (matrix_handle) );
+        ASSERT_TRUE(system_math_matrix4x4_invert(&matrix,
+                                                 &result) );
+
+        ASSERT_TRUE(_is_equal(result.data,
+                              system_matrix4x4_get_row_major_data(matrix_handle),
+                              16) );
+
+        system_math_matrix4x4_mul         (&matrix,
+                                           &result,
+                                           &product);
+        system_math_matrix4x4_set_identity(&identity);
+
+        ASSERT_TRUE(_is_equal(product.data,
+                              identity.data,
+                              16) );
+
+        /* In-place inversion should give the same result */
+        ASSERT_TRUE(system_math_matrix4x4_invert(&matrix,
+                                                 &matrix) );
+        ASSERT_TRUE(_is_equal(matrix.data,
+                              result.data,
+                              16) );
+    }
+
+    /* Singular matrices should be reported and leave the result untouched */
+    memset(&singular_matrix,
+           0,
+           sizeof(singular_matrix) );
+
+    singular_matrix.data[0] = 1.0f;
+    singular_matrix.data[5] = 1.0f;
+
+    system_math_matrix4x4_set_identity(&result);
+
+    ASSERT_FALSE(system_math_matrix4x4_invert(&singular_matrix,
+                                              &result) );
+    ASSERT_EQ   (result.data[0],
+                 1.0f);
+    ASSERT_EQ   (result.data[15],
+                 1.0f);
+
+    system_matrix4x4_release(matrix_handle);
+}
+
+TEST(MathMatrix4x4Test, MulMatchesHandleAPI)
+{
+    system_math_matrix4x4 a;
+    system_matrix4x4      a_handle = system_matrix4x4_create();
+    system_math_matrix4x4 b;
+    system_matrix4x4      b_handle = system_matrix4x4_create();
+
+    srand(0x2345);
+
+    for (unsigned int n_iteration = 0;
+                      n_iteration < N_RANDOM_MATRICES;
+                    ++n_iteration)
+    {
+        system_math_matrix4x4 result;
+        system_matrix4x4      result_handle = nullptr;
+
+        for (unsigned int n_element = 0;
+                          n_element < 16;
+                        ++n_element)
+        {
+            a.data[n_element] = _get_random_float() * 10.0f;
+            b.data[n_element] = _get_random_float() * 10.0f;
+        }
+
+        system_matrix4x4_set_from_row_major_raw(a_handle,
+                                                a.data);
+        system_matrix4x4_set_from_row_major_raw(b_handle,
+                                                b.data);
+
+        result_handle = system_matrix4x4_create_by_mul(a_handle,
+                                                       b_handle);
+
+        system_math_matrix4x4_mul(&a,
+                                  &b,
+                                  &result);
+
+        ASSERT_TRUE(_is_equal(result.data,
+                              system_matrix4x4_get_row_major_data(result_handle),
+                              16) );
+
+        /* The result may alias either of the operands */
+        system_math_matrix4x4_mul(&a,
+                                  &b,
+                                  &a);
+
+        ASSERT_TRUE(_is_equal(a.data,
+                              result.data,
+                              16) );
+
+        system_matrix4x4_release(result_handle);
+    }
+
+    system_matrix4x4_release(a_handle);
+    system_matrix4x4_release(b_handle);
+}
+
+TEST(MathMatrix4x4Test, TransformsMatchHandleAPI)
+{
+    system_math_matrix4x4 matrix;
+    system_matrix4x4      matrix_handle = system_matrix4x4_create();
+
+    srand(0x3456);
+
+    for (unsigned int n_iteration = 0;
+                      n_iteration < N_RANDOM_MATRICES;
+                    ++n_iteration)
+    {
+        float aabb_max         [3];
+        float aabb_min         [3];
+        float expected_aabb_max[3];
+        float expected_aabb_min[3];
+        float result_aabb_max  [3];
+        float result_aabb_min  [3];
+
+        _get_random_affine_matrix(&matrix,
+                                  matrix_handle);
+
+        for (unsigned int n_component = 0;
+                          n_component < 3;
+                        ++n_component)
+        {
+            aabb_min[n_component] = _get_random_float();
+            aabb_max[n_component] = aabb_min[n_component] + fabsf(_get_random_float() );
+        }
+
+        for (unsigned int n_vertex = 0;
+                          n_vertex < 8;
+                        ++n_vertex)
+        {
+            float expected_vertex[4];
+            float result_vertex  [4];
+            float vertex         [4] =
+            {
+                (n_vertex & 1) ? aabb_max[0] : aabb_min[0],
+                (n_vertex & 2) ? aabb_max[1] : aabb_min[1],
+                (n_vertex & 4) ? aabb_max[2] : aabb_min[2],
+                1.0f
+            };
+
+            system_matrix4x4_multiply_by_vector4   (matrix_handle,
+                                                    vertex,
+                                                    expected_vertex);
+            system_math_matrix4x4_transform_vector4(&matrix,
+                                                    vertex,
+                                                    result_vertex);
+
+            ASSERT_TRUE(_is_equal(result_vertex,
+                                  expected_vertex,
+                                  4) );
+
+            for (unsigned int n_component = 0;
+                              n_component < 3;
+                            ++n_component)
+            {
+                if (n_vertex == 0 || expected_vertex[n_component] < expected_aabb_min[n_component])
+                {
+                    expected_aabb_min[n_component] = expected_vertex[n_component];
+                }
+
+                if (n_vertex == 0 || expected_vertex[n_component] > expected_aabb_max[n_component])
+                {
+                    expected_aabb_max[n_component] = expected_vertex[n_component];
+                }
+            }
+        }
+
+        system_math_matrix4x4_transform_aabb(&matrix,
+                                             aabb_min,
+                                             aabb_max,
+                                             result_aabb_min,
+                                             result_aabb_max);
+
+        ASSERT_TRUE(_is_equal(result_aabb_max,
+                              expected_aabb_max,
+                              3) );
+        ASSERT_TRUE(_is_equal(result_aabb_min,
+                              expected_aabb_min,
+                              3) );
+    }
+
+    system_matrix4x4_release(matrix_handle);
+}
+
+/** Mimics what scene_graph_compute() does for a chain of animated nodes, first with pooled
+ *  matrix handles (as it used to), then with value-type matrices. */
+TEST(MathMatrix4x4Test, DISABLED_SceneGraphComputeBenchmark)
+{
+    const float           axis       [] = {0.0f, 1.0f, 0.0f};
+    __uint64              duration_usec[2] = {0};
+    system_matrix4x4      node_handles [BENCHMARK_N_NODES];
+    system_math_matrix4x4 node_matrices[BENCHMARK_N_NODES];
+    float                 checksums    [2] = {0.0f};
+    const float           translation[] = {0.1f, 0.2f, 0.3f};
+
+    memset(node_handles,
+           0,
+           sizeof(node_handles) );
+
+    /* Handle API */
+    __uint64 start_time_usec = system_time_now_usec();
+
+    for (unsigned int n_frame = 0;
+                      n_frame < BENCHMARK_N_FRAMES;
+                    ++n_frame)
+    {
+        for (unsigned int n_node = 0;
+                          n_node < BENCHMARK_N_NODES;
+                        ++n_node)
+        {
+            system_matrix4x4 local_matrix = system_matrix4x4_create();
+
+            if (node_handles[n_node] != nullptr)
+            {
+                system_matrix4x4_release(node_handles[n_node]);
+            }
+
+            system_matrix4x4_set_to_identity(local_matrix);
+            system_matrix4x4_rotate         (local_matrix,
+                                             float(n_frame + n_node) * 0.01f,
+                                             axis);
+            system_matrix4x4_translate      (local_matrix,
+                                             translation);
+
+            if (n_node == 0)
+            {
+                node_handles[n_node] = local_matrix;
+            }
+            else
+            {
+                node_handles[n_node] = system_matrix4x4_create_by_mul(node_handles[n_node - 1],
+                                                                      local_matrix);
+
+                system_matrix4x4_release(local_matrix);
+            }
+        }
+
+        checksums[0] += system_matrix4x4_get_row_major_data(node_handles[BENCHMARK_N_NODES - 1])[3];
+    }
+
+    duration_usec[0] = system_time_now_usec() - start_time_usec;
+
+    /* Value-type API */
+    start_time_usec = system_time_now_usec();
+
+    for (unsigned int n_frame = 0;
+                      n_frame < BENCHMARK_N_FRAMES;
+                    ++n_frame)
+    {
+        for (unsigned int n_node = 0;
+                          n_node < BENCHMARK_N_NODES;
+                        ++n_node)
+        {
+            system_math_matrix4x4 local_matrix;
+            system_math_matrix4x4 translation_matrix;
+
+            system_math_matrix4x4_set_rotation   (float(n_frame + n_node) * 0.01f,
+                                                  axis,
+                                                 &local_matrix);
+            system_math_matrix4x4_set_translation(translation,
+                                                 &translation_matrix);
+            system_math_matrix4x4_mul            (&local_matrix,
+                                                  &translation_matrix,
+                                                  &local_matrix);
+
+            if (n_node == 0)
+            {
+                node_matrices[n_node] = local_matrix;
+            }
+            else
+            {
+                system_math_matrix4x4_mul(node_matrices + n_node - 1,
+                                         &local_matrix,
+                                          node_matrices + n_node);
+            }
+        }
+
+        checksums[1] += node_matrices[BENCHMARK_N_NODES - 1].data[3];
+    }
+
+    duration_usec[1] = system_time_now_usec() - start_time_usec;
+
+    for (unsigned int n_node = 0;
+                      n_node < BENCHMARK_N_NODES;
+                    ++n_node)
+    {
+        system_matrix4x4_release(node_handles[n_node]);
+    }
+
+    LOG_INFO("Node transformations per second: handle API: %12.0f, value-type API: %12.0f (checksums: %f, %f)",
+             double(BENCHMARK_N_FRAMES * BENCHMARK_N_NODES) * 1000000.0 / double(duration_usec[0]),
+             double(BENCHMARK_N_FRAMES * BENCHMARK_N_NODES) * 1000000.0 / double(duration_usec[1]),
+             checksums[0],
+             checksums[1]);
+}
@@ -0,0 +1,473 @@
+/**
+ *
+ * Emerald (kbi/elude @2016)
+ *
+ */
+#include "test_matrix4x4_kernels.h"
+#include "gtest/gtest.h"
+#include "shared.h"
+#include "system/system_log.h"
+#include "system/system_matrix4x4.h"
+#include "system/system_time.h"
+#include <math.h>
+#include <stdlib.h>
+#include <vector>
+
+#define BENCHMARK_N_ITERATIONS (200)
+#define BENCHMARK_N_ITEMS      (16384)
+#define EPSILON                (1e-4f)
+
+/* Odd, so that all kernels need to process a tail */
+#define N_ITEMS                (1027)
+
+
+/** Returns a pseudo-random float from <-1, 1>. */
+PRIVATE float _get_random_float()
+{
+    return float(rand() ) / float(RAND_MAX) * 2.0f - 1.0f;
+}
+
+/** Fills @param n_floats floats with pseudo-random values from <-scale, scale>. */
+PRIVATE void _get_random_floats(unsigned int n_floats,
+                                float        scale,
+                                float*       out_data_ptr)
+{
+    for (unsigned int n_float = 0;
+                      n_float < n_floats;
+                    ++n_float)
+    {
+        out_data_ptr[n_float] = _get_random_float() * scale;
+    }
+}
+
+/** Checks if two sets of floats are equal, allowing for a relative error. */
+PRIVATE bool _is_equal(const float* a_ptr,
+                       const float* b_ptr,
+                       unsigned int n_values)
+{
+    for (unsigned int n_value = 0;
+                      n_value < n_values;
+                    ++n_value)
+    {
+        const float scale = fmaxf(1.0f,
+                                  fmaxf(fabsf(a_ptr[n_value]),
+                                        fabsf(b_ptr[n_value]) ));
+
+        if (fabsf(a_ptr[n_value] - b_ptr[n_value]) > EPSILON * scale)
+        {
+            return false;
+        }
+    }
+
+    return true;
+}
+
+/** Creates a matrix handle holding a pseudo-random affine transformation. */
+PRIVATE system_matrix4x4 _create_random_affine_matrix()
+{
+    float            data[16];
+    system_matrix4x4 result = system_matrix4x4_create();
+
+    _get_random_floats(12,   /* n_floats */
+                       4.0f, /* scale    */
+                       data);
+
+    data[12] = 0.0f;
+    data[13] = 0.0f;
+    data[14] = 0.0f;
+    data[15] = 1.0f;
+
+    system_matrix4x4_set_from_row_major_raw(result,
+                                            data);
+
+    return result;
+}
+
+
+TEST(Matrix4x4KernelsTest, AABBsMatchScalarKernels)
+{
+    const system_matrix4x4_kernel_set default_kernel_set = system_matrix4x4_get_kernel_set();
+    system_matrix4x4                  matrix             = _create_random_affine_matrix();
+    std::vector<float>                aabb_max(N_ITEMS * 3);
+    std::vector<float>                aabb_min(N_ITEMS * 3);
+    std::vector<float>                reference_aabb_max(N_ITEMS * 3);
+    std::vector<float>                reference_aabb_min(N_ITEMS * 3);
+
+    for (unsigned int n_value = 0;
+                      n_value < N_ITEMS * 3;
+                    ++n_value)
+    {
+        const float a = _get_random_float() * 10.0f;
+        const float b = _get_random_float() * 10.0f;
+
+        aabb_max[n_value] = fmaxf(a, b);
+        aabb_min[n_value] = fminf(a, b);
+    }
+
+    ASSERT_TRUE(system_matrix4x4_set_kernel_set(SYSTEM_MATRIX4X4_KERNEL_SET_SCALAR) );
+
+    system_matrix4x4_transform_aabbs(matrix,
+                                     N_ITEMS,
+                                    &aabb_min[0],
+                                    &aabb_max[0],
+                                    &reference_aabb_min[0],
+                                    &reference_aabb_max[0]);
+
+    for (unsigned int kernel_set = SYSTEM_MATRIX4X4_KERNEL_SET_SCALAR;
+                      kernel_set < SYSTEM_MATRIX4X4_KERNEL_SET_COUNT;
+                    ++kernel_set)
+    {
+        std::vector<float> result_aabb_max(aabb_max);
+        std::vector<float> result_aabb_min(aabb_min);
+
+        if (!system_matrix4x4_set_kernel_set( (system_matrix4x4_kernel_set) kernel_set) )
+        {
+            continue;
+        }
+
+        /* Transform in-place to make sure aliasing is handled */
+        system_matrix4x4_transform_aabbs(matrix,
+                                         N_ITEMS,
+                                        &result_aabb_min[0],
+                                        &result_aabb_max[0],
+                                        &result_aabb_min[0],
+                                        &result_aabb_max[0]);
+
+        ASSERT_TRUE(_is_equal(&reference_aabb_max[0],
+                              &result_aabb_max[0],
+                              N_ITEMS * 3) )
+            << "Kernel set: " << kernel_set;
+        ASSERT_TRUE(_is_equal(&reference_aabb_min[0],
+                              &result_aabb_min[0],
+                              N_ITEMS * 3) )
+            << "Kernel set: " << kernel_set;
+    }
+
+    /* The scalar results must enclose all eight transformed corners */
+    for (unsigned int n_aabb = 0;
+                      n_aabb < N_ITEMS;
+                    ++n_aabb)
+    {
+        for (unsigned int n_corner = 0;
+                          n_corner < 8;
+                        ++n_corner)
+        {
+            const float corner[] =
+            {
+                (n_corner & 1) ? aabb_max[n_aabb * 3 + 0] : aabb_min[n_aabb * 3 + 0],
+                (n_corner & 2) ? aabb_max[n_aabb * 3 + 1] : aabb_min[n_aabb * 3 + 1],
+                (n_corner & 4) ? aabb_max[n_aabb * 3 + 2] : aabb_min[n_aabb * 3 + 2],
+                1.0f
+            };
+            float world_corner[4];
+
+            system_matrix4x4_multiply_by_vector4(matrix,
+                                                 corner,
+                                                 world_corner);
+
+            for (unsigned int n_component = 0;
+                              n_component < 3;
+                            ++n_component)
+            {
+                ASSERT_GE(world_corner[n_component], reference_aabb_min[n_aabb * 3 + n_component] - EPSILON * 100.0f);
+                ASSERT_LE(world_corner[n_component], reference_aabb_max[n_aabb * 3 + n_component] + EPSILON * 100.0f);
+            }
+        }
+    }
+
+    system_matrix4x4_set_kernel_set(default_kernel_set);
+    system_matrix4x4_release       (matrix);
+}
+
+TEST(Matrix4x4KernelsTest, DefaultKernelSetIsAvailable)
+{
+    const system_matrix4x4_kernel_set default_kernel_set = system_matrix4x4_get_kernel_set();
+
+    ASSERT_LT (default_kernel_set,
+               SYSTEM_MATRIX4X4_KERNEL_SET_COUNT);
+    ASSERT_TRUE(system_matrix4x4_set_kernel_set(SYSTEM_MATRIX4X4_KERNEL_SET_SCALAR) );
+    ASSERT_EQ  (SYSTEM_MATRIX4X4_KERNEL_SET_SCALAR,
+                system_matrix4x4_get_kernel_set() );
+    ASSERT_TRUE(system_matrix4x4_set_kernel_set(default_kernel_set) );
+    ASSERT_EQ  (default_kernel_set,
+                system_matrix4x4_get_kernel_set() );
+}
+
+TEST(Matrix4x4KernelsTest, MultiplyManyMatchesScalarKernels)
+{
+    const system_matrix4x4_kernel_set default_kernel_set = system_matrix4x4_get_kernel_set();
+    std::vector<float>                a                 (N_ITEMS * 16);
+    std::vector<float>                b                 (N_ITEMS * 16);
+    std::vector<float>                reference_result  (N_ITEMS * 16);
+
+    _get_random_floats(N_ITEMS * 16,
+                       4.0f, /* scale */
+                      &a[0]);
+    _get_random_floats(N_ITEMS * 16,
+                       4.0f, /* scale */
+                      &b[0]);
+
+    ASSERT_TRUE(system_matrix4x4_set_kernel_set(SYSTEM_MATRIX4X4_KERNEL_SET_SCALAR) );
+
+    system_matrix4x4_multiply_many(&a[0],
+                                   &b[0],
+                                   N_ITEMS,
+                                   &reference_result[0]);
+
+    for (unsigned int kernel_set = SYSTEM_MATRIX4X4_KERNEL_SET_SCALAR;
+                      kernel_set < SYSTEM_MATRIX4X4_KERNEL_SET_COUNT;
+                    ++kernel_set)
+    {
+        std::vector<float> result(a);
+
+        if (!system_matrix4x4_set_kernel_set( (system_matrix4x4_kernel_set) kernel_set) )
+        {
+            continue;
+        }
+
+        system_matrix4x4_multiply_many(&result[0],
+                                       &b[0],
+                                       N_ITEMS,
+                                       &result[0]);
+
+        ASSERT_TRUE(_is_equal(&reference_result[0],
+                              &result[0],
+                              N_ITEMS * 16) )
+            << "Kernel set: " << kernel_set;
+
+        /* The handle API should go through the same kernels */
+        system_matrix4x4 a_handle      = system_matrix4x4_create();
+        system_matrix4x4 b_handle      = system_matrix4x4_create();
+        system_matrix4x4 result_handle = nullptr;
+
+        system_matrix4x4_set_from_row_major_raw(a_handle,
+                                                &a[0]);
+        system_matrix4x4_set_from_row_major_raw(b_handle,
+                                                &b[0]);
+
+        result_handle = system_matrix4x4_create_by_mul(a_handle,
+                                                       b_handle);
+
+        ASSERT_TRUE(_is_equal(&reference_result[0],
+                              system_matrix4x4_get_row_major_data(result_handle),
+                              16) );
+
+        system_matrix4x4_multiply_by_matrix4x4(a_handle,
+                                               b_handle);
+
+        ASSERT_TRUE(_is_equal(&reference_result[0],
+                              system_matrix4x4_get_row_major_data(a_handle),
+                              16) );
+
+        system_matrix4x4_release(a_handle);
+        system_matrix4x4_release(b_handle);
+        system_matrix4x4_release(result_handle);
+    }
+
+    system_matrix4x4_set_kernel_set(default_kernel_set);
+}
+
+TEST(Matrix4x4KernelsTest, PointsMatchScalarKernels)
+{
+    const system_matrix4x4_kernel_set default_kernel_set = system_matrix4x4_get_kernel_set();
+    system_matrix4x4                  matrix             = _create_random_affine_matrix();
+    std::vector<float>                points[3];
+    std::vector<float>                reference_points[3];
+
+    for (unsigned int n_component = 0;
+                      n_component < 3;
+                    ++n_component)
+    {
+        points          [n_component].resize(N_ITEMS);
+        reference_points[n_component].resize(N_ITEMS);
+
+        _get_random_floats(N_ITEMS,
+                           10.0f, /* scale */
+                          &points[n_component][0]);
+    }
+
+    ASSERT_TRUE(system_matrix4x4_set_kernel_set(SYSTEM_MATRIX4X4_KERNEL_SET_SCALAR) );
+
+    system_matrix4x4_transform_points_soa(matrix,
+                                          N_ITEMS,
+                                         &points[0][0],
+                                         &points[1][0],
+                                         &points[2][0],
+                                         &reference_points[0][0],
+                                         &reference_points[1][0],
+                                         &reference_points[2][0]);
+
+    /* Compare against the generic matrix-vector path */
+    for (unsigned int n_point = 0;
+                      n_point < N_ITEMS;
+                    ++n_point)
+    {
+        const float point[] =
+        {
+            points[0][n_point],
+            points[1][n_point],
+            points[2][n_point],
+            1.0f
+        };
+        const float reference_point[] =
+        {
+            reference_points[0][n_point],
+            reference_points[1][n_point],
+            reference_points[2][n_point]
+        };
+        float world_point[4];
+
+        system_matrix4x4_multiply_by_vector4(matrix,
+                                             point,
+                                             world_point);
+
+        ASSERT_TRUE(_is_equal(world_point,
+                              reference_point,
+                              3) );
+    }
+
+    for (unsigned int kernel_set = SYSTEM_MATRIX4X4_KERNEL_SET_SCALAR;
+                      kernel_set < SYSTEM_MATRIX4X4_KERNEL_SET_COUNT;
+                    ++kernel_set)
+    {
+        std::vector<float> result_points[3] = {points[0], points[1], points[2]};
+
+        if (!system_matrix4x4_set_kernel_set( (system_matrix4x4_kernel_set) kernel_set) )
+        {
+            continue;
+        }
+
+        system_matrix4x4_transform_points_soa(matrix,
+                                              N_ITEMS,
+                                             &result_points[0][0],
+                                             &result_points[1][0],
+                                             &result_points[2][0],
+                                             &result_points[0][0],
+                                             &result_points[1][0],
+                                             &result_points[2][0]);
+
+        for (unsigned int n_component = 0;
+                          n_component < 3;
+                        ++n_component)
+        {
+            ASSERT_TRUE(_is_equal(&reference_points[n_component][0],
+                                  &result_points   [n_component][0],
+                                  N_ITEMS) )
+                << "Kernel set: " << kernel_set;
+        }
+    }
+
+    system_matrix4x4_set_kernel_set(default_kernel_set);
+    system_matrix4x4_release       (matrix);
+}
+
+TEST(Matrix4x4KernelsTest, DISABLED_KernelSetBenchmark)
+{
+    static const char* kernel_set_names[] =
+    {
+        "scalar",
+        "SSE2",
+        "AVX2"
+    };
+
+    const system_matrix4x4_kernel_set default_kernel_set = system_matrix4x4_get_kernel_set();
+    system_matrix4x4                  matrix             = _create_random_affine_matrix();
+    std::vector<float>                a                 (BENCHMARK_N_ITEMS * 16);
+    std::vector<float>                aabb_max          (BENCHMARK_N_ITEMS * 3);
+    std::vector<float>                b                 (BENCHMARK_N_ITEMS * 16);
+    std::vector<float>                result            (BENCHMARK_N_ITEMS * 16);
+    std::vector<float>                x                 (BENCHMARK_N_ITEMS);
+    std::vector<float>                y                 (BENCHMARK_N_ITEMS);
+    std::vector<float>                z                 (BENCHMARK_N_ITEMS);
+
+    _get_random_floats(BENCHMARK_N_ITEMS * 16, 1.0f, &a[0]);
+    _get_random_floats(BENCHMARK_N_ITEMS * 16, 1.0f, &b[0]);
+    _get_random_floats(BENCHMARK_N_ITEMS,      1.0f, &x[0]);
+    _get_random_floats(BENCHMARK_N_ITEMS,      1.0f, &y[0]);
+    _get_random_floats(BENCHMARK_N_ITEMS,      1.0f, &z[0]);
+
+    /* Reuse the first matrix set as minimum coordinates of the boxes */
+    for (unsigned int n_value = 0;
+                      n_value < BENCHMARK_N_ITEMS * 3;
+                    ++n_value)
+    {
+        aabb_max[n_value] = a[n_value] + 2.0f;
+    }
+
+    for (unsigned int kernel_set = SYSTEM_MATRIX4X4_KERNEL_SET_SCALAR;
+                      kernel_set < SYSTEM_MATRIX4X4_KERNEL_SET_COUNT;
+                    ++kernel_set)
+    {
+        __uint64 duration_usec[3];
+        __uint64 start_time_usec;
+
+        if (!system_matrix4x4_set_kernel_set( (system_matrix4x4_kernel_set) kernel_set) )
+        {
+            LOG_INFO("Kernel set [%s] is not supported, skipping.",
+                     kernel_set_names[kernel_set]);
+
+            continue;
+        }
+
+        /* Matrix multiplication */
+        start_time_usec = system_time_now_usec();
+
+        for (unsigned int n_iteration = 0;
+                          n_iteration < BENCHMARK_N_ITERATIONS;
+                        ++n_iteration)
+        {
+            system_matrix4x4_multiply_many(&a[0],
+                                           &b[0],
+                                           BENCHMARK_N_ITEMS,
+                                           &result[0]);
+        }
+
+        duration_usec[0] = system_time_now_usec() - start_time_usec;
+
+        /* Point transformation */
+        start_time_usec = system_time_now_usec();
+
+        for (unsigned int n_iteration = 0;
+                          n_iteration < BENCHMARK_N_ITERATIONS;
+                        ++n_iteration)
+        {
+            system_matrix4x4_transform_points_soa(matrix,
+                                                  BENCHMARK_N_ITEMS,
+                                                 &x[0],
+                                                 &y[0],
+                                                 &z[0],
+                                                 &result[0],
+                                                 &result[BENCHMARK_N_ITEMS],
+                                                 &result[BENCHMARK_N_ITEMS * 2]);
+        }
+
+        duration_usec[1] = system_time_now_usec() - start_time_usec;
+
+        /* AABB transformation */
+        start_time_usec = system_time_now_usec();
+
+        for (unsigned int n_iteration = 0;
+                          n_iteration < BENCHMARK_N_ITERATIONS;
+                        ++n_iteration)
+        {
+            system_matrix4x4_transform_aabbs(matrix,
+                                             BENCHMARK_N_ITEMS,
+                                            &a[0],
+                                            &aabb_max[0],
+                                            &result[0],
+                                            &result[BENCHMARK_N_ITEMS * 3]);
+        }
+
+        duration_usec[2] = system_time_now_usec() - start_time_usec;
+
+        LOG_INFO("Kernel set [%s]: matrices/s: %12.0f, points/s: %12.0f, AABBs/s: %12.0f (checksum: %f)",
+                 kernel_set_names[kernel_set],
+                 double(BENCHMARK_N_ITERATIONS * BENCHMARK_N_ITEMS) * 1000000.0 / double(duration_usec[0] + 1),
+                 double(BENCHMARK_N_ITERATIONS * BENCHMARK_N_ITEMS) * 1000000.0 / double(duration_usec[1] + 1),
+                 double(BENCHMARK_N_ITERATIONS * BENCHMARK_N_ITEMS) * 1000000.0 / double(duration_usec[2] + 1),
+                 result[0]);
+    }
+
+    system_matrix4x4_set_kernel_set(default_kernel_set);
+    system_matrix4x4_release       (matrix);
+}
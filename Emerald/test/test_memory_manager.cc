@@ -8,6 +8,9 @@
 #include "system/system_log.h"
 #include "system/system_memory_manager.h"
 #include "system/system_resizable_vector.h"
+#include "system/system_time.h"
+#include <map>
+#include <vector>
 
 
 struct _memory_block
@@ -760,3 +763,471 @@ TEST(MemoryManagerTest, FunctionalTest1)
 
     system_memory_manager_release(manager);
 }
+
+/** Memory operation trace used by the TLSF tests. Operations are generated with a fixed-seed
+ *  LCG, so that the very same trace can be replayed against each allocation policy (and on
+ *  each platform).
+ */
+struct _trace_op
+{
+    bool         is_alloc;
+    unsigned int alloc_op_index; /* free ops only: index of the alloc op, whose block should be freed */
+    unsigned int alignment;
+    unsigned int size;
+};
+
+PRIVATE unsigned int _get_next_trace_random_value(unsigned int* seed_ptr)
+{
+    *seed_ptr = *seed_ptr * 1664525u + 1013904223u;
+
+    return *seed_ptr >> 8;
+}
+
+/** Generates a trace mimicking a streaming workload: blocks of log-uniformly distributed sizes
+ *  are allocated until @param target_occupancy_percentage of the region is used, after which
+ *  randomly picked live blocks are freed and new ones are allocated in their place.
+ */
+PRIVATE void _generate_trace(unsigned int            n_ops,
+                             unsigned int            region_size,
+                             unsigned int            min_size_log2,
+                             unsigned int            max_size_log2,
+                             unsigned int            target_occupancy_percentage,
+                             std::vector<_trace_op>* out_trace_ptr)
+{
+    static const unsigned int alignments[] =
+    {
+        0, 1, 16, 32, 53, 256, 4096
+    };
+    const unsigned int n_alignments = sizeof(alignments) / sizeof(alignments[0]);
+
+    std::vector<unsigned int> live_alloc_op_indices;
+    uint64_t                  live_size = 0;
+    unsigned int              seed      = 0x1234;
+
+    out_trace_ptr->clear();
+
+    for (unsigned int n_op = 0;
+                      n_op < n_ops;
+                    ++n_op)
+    {
+        _trace_op op;
+
+        if (live_size * 100 < (uint64_t) region_size * target_occupancy_percentage ||
+            live_alloc_op_indices.size() == 0)
+        {
+            const unsigned int size_log2 = min_size_log2 + _get_next_trace_random_value(&seed) % (max_size_log2 - min_size_log2);
+
+            op.is_alloc       = true;
+            op.alloc_op_index = 0;
+            op.alignment      = alignments[_get_next_trace_random_value(&seed) % n_alignments];
+            op.size           = (1u << size_log2) + _get_next_trace_random_value(&seed) % (1u << size_log2);
+
+            live_alloc_op_indices.push_back(n_op);
+
+            live_size += op.size;
+        }
+        else
+        {
+            const unsigned int n_live_alloc = _get_next_trace_random_value(&seed) % live_alloc_op_indices.size();
+
+            op.is_alloc       = false;
+            op.alloc_op_index = live_alloc_op_indices[n_live_alloc];
+            op.alignment      = 0;
+            op.size           = 0;
+
+            live_size -= (*out_trace_ptr)[op.alloc_op_index].size;
+
+            live_alloc_op_indices[n_live_alloc] = live_alloc_op_indices.back();
+            live_alloc_op_indices.pop_back();
+        }
+
+        out_trace_ptr->push_back(op);
+    }
+}
+
+/** Page commitment tracker used by the TLSF tests */
+struct _page_tracker
+{
+    unsigned int               page_size;
+    std::vector<unsigned char> committed_pages;
+};
+
+static void _tracker_block_alloc_callback(system_memory_manager manager,
+                                          unsigned int          offset_aligned,
+                                          unsigned int          size,
+                                          void*                 user_arg)
+{
+    _page_tracker* tracker_ptr = (_page_tracker*) user_arg;
+
+    ASSERT_EQ(offset_aligned % tracker_ptr->page_size, 0);
+    ASSERT_EQ(size           % tracker_ptr->page_size, 0);
+
+    for (unsigned int n_page = offset_aligned          / tracker_ptr->page_size;
+                      n_page < (offset_aligned + size) / tracker_ptr->page_size;
+                    ++n_page)
+    {
+        ASSERT_EQ(tracker_ptr->committed_pages[n_page], 0);
+
+        tracker_ptr->committed_pages[n_page] = 1;
+    }
+}
+
+static void _tracker_block_freed_callback(system_memory_manager manager,
+                                          unsigned int          offset_aligned,
+                                          unsigned int          size,
+                                          void*                 user_arg)
+{
+    _page_tracker* tracker_ptr = (_page_tracker*) user_arg;
+
+    ASSERT_EQ(offset_aligned % tracker_ptr->page_size, 0);
+    ASSERT_EQ(size           % tracker_ptr->page_size, 0);
+
+    for (unsigned int n_page = offset_aligned          / tracker_ptr->page_size;
+                      n_page < (offset_aligned + size) / tracker_ptr->page_size;
+                    ++n_page)
+    {
+        ASSERT_EQ(tracker_ptr->committed_pages[n_page], 1);
+
+        tracker_ptr->committed_pages[n_page] = 0;
+    }
+}
+
+
+TEST(MemoryManagerTest, TLSFReleasedBlocksAreCoalesced)
+{
+    /* This test verifies that the TLSF policy can serve aligned allocations until the region
+     * is exhausted, and that released blocks are merged, so that the whole region can be
+     * allocated again afterward.
+     */
+    const unsigned int                         page_size            = 4096;
+    const unsigned int                         total_available_size = page_size * 16;
+    const unsigned int                         alloc_size           = total_available_size / 4;
+    const unsigned int                         free_order[]         = {1, 3, 0, 2};
+    system_memory_manager_fragmentation_report report;
+    unsigned int                               result_offsets[4];
+    unsigned int                               result_offset        = -1;
+
+    system_memory_manager manager = system_memory_manager_create(total_available_size,           /* memory_region_size */
+                                                                 page_size,
+                                                                 _mmanager_block_alloc_callback,
+                                                                 _mmanager_block_freed_callback,
+                                                                 NULL,                           /* user_arg */
+                                                                 false,                          /* should_be_thread_safe */
+                                                                 SYSTEM_MEMORY_MANAGER_POLICY_TLSF);
+
+    memory_blocks = system_resizable_vector_create(4 /* capacity */);
+
+    for (unsigned int n_allocation = 0;
+                      n_allocation < 4;
+                    ++n_allocation)
+    {
+        ASSERT_TRUE(system_memory_manager_alloc_block(manager,
+                                                      alloc_size,
+                                                      alloc_size, /* required_alignment */
+                                                     &result_offsets[n_allocation]) );
+        ASSERT_EQ  (result_offsets[n_allocation] % alloc_size,
+                    0);
+    }
+
+    ASSERT_FALSE(system_memory_manager_alloc_block(manager,
+                                                   1, /* size */
+                                                   0, /* required_alignment */
+                                                  &result_offset) );
+
+    system_memory_manager_get_fragmentation_report(manager,
+                                                  &report);
+
+    ASSERT_EQ(report.n_free_blocks,
+              0);
+
+    /* Release the blocks in an order, which requires merging with both neighbours */
+    for (unsigned int n_allocation = 0;
+                      n_allocation < 4;
+                    ++n_allocation)
+    {
+        system_memory_manager_free_block(manager,
+                                         result_offsets[free_order[n_allocation] ]);
+    }
+
+    uint32_t n_memory_blocks = 0;
+
+    system_resizable_vector_get_property(memory_blocks,
+                                         SYSTEM_RESIZABLE_VECTOR_PROPERTY_N_ELEMENTS,
+                                        &n_memory_blocks);
+
+    ASSERT_EQ(n_memory_blocks,
+              0);
+
+    system_memory_manager_get_fragmentation_report(manager,
+                                                  &report);
+
+    ASSERT_EQ(report.n_free_blocks,
+              1);
+    ASSERT_EQ(report.largest_free_block_size,
+              total_available_size);
+    ASSERT_EQ(report.total_free_size,
+              total_available_size);
+    ASSERT_EQ(report.n_free_blocks_per_size_log2[16],
+              1);
+
+    ASSERT_TRUE(system_memory_manager_alloc_block(manager,
+                                                  total_available_size,
+                                                  0, /* required_alignment */
+                                                 &result_offset) );
+    ASSERT_EQ  (result_offset,
+                0);
+
+    /* All done */
+    _free_memory_blocks();
+
+    system_memory_manager_release(manager);
+}
+
+TEST(MemoryManagerTest, TLSFRandomAllocFree)
+{
+    /* This test replays a random trace against the TLSF policy and verifies that:
+     *
+     * 1) the returned blocks respect the alignment requirements and never overlap.
+     * 2) the page commitment call-backs always describe exactly the set of pages touched by live blocks.
+     * 3) once all blocks are released, the region is a single free block again.
+     */
+    const unsigned int                         page_size   = 4096;
+    const unsigned int                         memory_size = 1024 * 1024;
+    std::map<unsigned int, unsigned int>       live_blocks; /* offset -> size */
+    std::vector<unsigned int>                  op_offsets;
+    system_memory_manager_fragmentation_report report;
+    _page_tracker                              tracker;
+    std::vector<_trace_op>                     trace;
+
+    tracker.page_size = page_size;
+    tracker.committed_pages.resize(memory_size / page_size,
+                                   0);
+
+    _generate_trace(20000,       /* n_ops */
+                    memory_size,
+                    0,           /* min_size_log2 */
+                    14,          /* max_size_log2 */
+                    90,          /* target_occupancy_percentage */
+                   &trace);
+
+    op_offsets.resize(trace.size(),
+                      UINT32_MAX);
+
+    system_memory_manager manager = system_memory_manager_create(memory_size,
+                                                                 page_size,
+                                                                 _tracker_block_alloc_callback,
+                                                                 _tracker_block_freed_callback,
+                                                                &tracker,
+                                                                 false, /* should_be_thread_safe */
+                                                                 SYSTEM_MEMORY_MANAGER_POLICY_TLSF);
+
+    for (unsigned int n_op = 0;
+                      n_op < trace.size();
+                    ++n_op)
+    {
+        const _trace_op& op = trace[n_op];
+
+        if (op.is_alloc)
+        {
+            unsigned int offset = 0;
+
+            if (!system_memory_manager_alloc_block(manager,
+                                                   op.size,
+                                                   op.alignment,
+                                                  &offset) )
+            {
+                continue;
+            }
+
+            if (op.alignment != 0)
+            {
+                ASSERT_EQ(offset % op.alignment,
+                          0);
+            }
+
+            ASSERT_TRUE(offset + op.size <= memory_size);
+
+            std::map<unsigned int, unsigned int>::iterator next_iterator = live_blocks.lower_bound(offset);
+
+            if (next_iterator != live_blocks.end() )
+            {
+                ASSERT_TRUE(next_iterator->first >= offset + op.size);
+            }
+
+            if (next_iterator != live_blocks.begin() )
+            {
+                std::map<unsigned int, unsigned int>::iterator prev_iterator = next_iterator;
+
+                --prev_iterator;
+
+                ASSERT_TRUE(prev_iterator->first + prev_iterator->second <= offset);
+            }
+
+            live_blocks[offset] = op.size;
+            op_offsets [n_op]   = offset;
+        }
+        else
+        if (op_offsets[op.alloc_op_index] != UINT32_MAX)
+        {
+            system_memory_manager_free_block(manager,
+                                             op_offsets[op.alloc_op_index]);
+
+            live_blocks.erase(op_offsets[op.alloc_op_index]);
+        }
+
+        if ((n_op % 97) == 0)
+        {
+            std::vector<unsigned char> expected_committed_pages(tracker.committed_pages.size(),
+                                                                0);
+
+            for (std::map<unsigned int, unsigned int>::iterator live_block_iterator  = live_blocks.begin();
+                                                                live_block_iterator != live_blocks.end();
+                                                              ++live_block_iterator)
+            {
+                for (unsigned int n_page  =  live_block_iterator->first                                    / page_size;
+                                  n_page <= (live_block_iterator->first + live_block_iterator->second - 1) / page_size;
+                                ++n_page)
+                {
+                    expected_committed_pages[n_page] = 1;
+                }
+            }
+
+            ASSERT_TRUE(expected_committed_pages == tracker.committed_pages);
+        }
+    }
+
+    /* Release all remaining blocks */
+    for (std::map<unsigned int, unsigned int>::iterator live_block_iterator  = live_blocks.begin();
+                                                        live_block_iterator != live_blocks.end();
+                                                      ++live_block_iterator)
+    {
+        system_memory_manager_free_block(manager,
+                                         live_block_iterator->first);
+    }
+
+    for (unsigned int n_page = 0;
+                      n_page < tracker.committed_pages.size();
+                    ++n_page)
+    {
+        ASSERT_EQ(tracker.committed_pages[n_page],
+                  0);
+    }
+
+    system_memory_manager_get_fragmentation_report(manager,
+                                                  &report);
+
+    ASSERT_EQ(report.n_free_blocks,
+              1);
+    ASSERT_EQ(report.largest_free_block_size,
+              memory_size);
+
+    system_memory_manager_release(manager);
+}
+
+TEST(MemoryManagerTest, DISABLED_FragmentationBenchmark)
+{
+    /* Replays the same streaming trace against both allocation policies and reports the time
+     * spent per operation, the number of allocations that could not be served, and the state
+     * of the free space at the end of the run.
+     */
+    const unsigned int     memory_size = 256 * 1024 * 1024;
+    const unsigned int     page_size   = 65536;
+    std::vector<_trace_op> trace;
+
+    static const system_memory_manager_policy policies[] =
+    {
+        SYSTEM_MEMORY_MANAGER_POLICY_FIRST_FIT,
+        SYSTEM_MEMORY_MANAGER_POLICY_TLSF
+    };
+    static const char* policy_names[] =
+    {
+        "first fit",
+        "TLSF"
+    };
+
+    _generate_trace(100000,      /* n_ops */
+                    memory_size,
+                    8,           /* min_size_log2 */
+                    20,          /* max_size_log2 */
+                    75,          /* target_occupancy_percentage */
+                   &trace);
+
+    for (unsigned int n_policy = 0;
+                      n_policy < sizeof(policies) / sizeof(policies[0]);
+                    ++n_policy)
+    {
+        unsigned int                               n_failed_allocs = 0;
+        std::vector<unsigned int>                  op_offsets(trace.size(),
+                                                              UINT32_MAX);
+        system_memory_manager_fragmentation_report report;
+        __uint64                                   time_start      = 0;
+        __uint64                                   time_total      = 0;
+
+        system_memory_manager manager = system_memory_manager_create(memory_size,
+                                                                     page_size,
+                                                                     NULL,  /* pfn_on_memory_block_alloced */
+                                                                     NULL,  /* pfn_on_memory_block_freed */
+                                                                     NULL,  /* user_arg */
+                                                                     false, /* should_be_thread_safe */
+                                                                     policies[n_policy]);
+
+        time_start = system_time_now_usec();
+        {
+            for (unsigned int n_op = 0;
+                              n_op < trace.size();
+                            ++n_op)
+            {
+                const _trace_op& op = trace[n_op];
+
+                if (op.is_alloc)
+                {
+                    if (!system_memory_manager_alloc_block(manager,
+                                                           op.size,
+                                                           op.alignment,
+                                                          &op_offsets[n_op]) )
+                    {
+                        op_offsets[n_op] = UINT32_MAX;
+
+                        n_failed_allocs++;
+                    }
+                }
+                else
+                if (op_offsets[op.alloc_op_index] != UINT32_MAX)
+                {
+                    system_memory_manager_free_block(manager,
+                                                     op_offsets[op.alloc_op_index]);
+                }
+            }
+        }
+        time_total = system_time_now_usec() - time_start;
+
+        system_memory_manager_get_fragmentation_report(manager,
+                                                      &report);
+
+        LOG_INFO("[%s]: %u ops, %.1f ns/op, %u failed allocs; %u free blocks, %u KB free, largest free block: %u KB (%.1f%% of free space)",
+                 policy_names[n_policy],
+                 (unsigned int) trace.size(),
+                 double(time_total) * 1000.0 / double(trace.size() ),
+                 n_failed_allocs,
+                 report.n_free_blocks,
+                 report.total_free_size         / 1024,
+                 report.largest_free_block_size / 1024,
+                 (report.total_free_size != 0) ? 100.0 * double(report.largest_free_block_size) / double(report.total_free_size)
+                                               : 100.0);
+
+        for (unsigned int n_bucket = 0;
+                          n_bucket < sizeof(report.n_free_blocks_per_size_log2) / sizeof(report.n_free_blocks_per_size_log2[0]);
+                        ++n_bucket)
+        {
+            if (report.n_free_blocks_per_size_log2[n_bucket] != 0)
+            {
+                LOG_INFO("    [2^%u, 2^%u): %u free block(s)",
+                         n_bucket,
+                         n_bucket + 1,
+                         report.n_free_blocks_per_size_log2[n_bucket]);
+            }
+        }
+
+        system_memory_manager_release(manager);
+    }
+}
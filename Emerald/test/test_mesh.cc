@@ -0,0 +1,1719 @@
+/**
+ *
+ * Emerald (kbi/elude @2014-2016)
+ *
+ */
+#include "test_mesh.h"
+#include "gtest/gtest.h"
+#include "shared.h"
+#include "demo/demo_app.h"
+#include "demo/demo_window.h"
+#include "mesh/mesh.h"
+#include "mesh/mesh_material.h"
+#include "ral/ral_context.h"
+#include "system/system_file_serializer.h"
+#include "system/system_hash64map.h"
+#include "system/system_hashed_ansi_string.h"
+#include "system/system_log.h"
+#include "system/system_math_vector.h"
+#include "system/system_time.h"
+#include <algorithm>
+#include <float.h>
+#include <map>
+#include <math.h>
+#include <vector>
+
+#define BENCHMARK_GRID_SIZE                 (708) /* 2 * 708 * 708 = ~1M triangles */
+#define ENCODED_MESH_FILE_NAME              ("test_mesh_encoded.mesh")
+#define LOD_GRID_SIZE                       (32)
+#define LOD_MESH_FILE_NAME                  ("test_mesh_lods.mesh")
+#define NORMAL_EPSILON                      (1e-5f)
+#define OCTAHEDRAL_EPSILON                  (1e-4f)
+#define RAW_MESH_FILE_NAME                  ("test_mesh_raw.mesh")
+#define SINGLE_INDEXED_BENCHMARK_N_ELEMENTS (3000000)
+#define TEST_WINDOW_NAME                    ("Test window")
+
+
+/** Creates an invisible window, whose rendering context is used to create materials. */
+PRIVATE ral_context create_test_context()
+{
+    ral_context             result = nullptr;
+    demo_window             window = nullptr;
+    demo_window_create_info window_create_info;
+
+    window_create_info.resolution[0] = 320;
+    window_create_info.resolution[1] = 240;
+    window_create_info.target_rate   = ~0;
+    window_create_info.visible       = false;
+
+    window = demo_app_create_window(system_hashed_ansi_string_create(TEST_WINDOW_NAME),
+                                    window_create_info,
+                                    RAL_BACKEND_TYPE_GL);
+
+    if (window != nullptr)
+    {
+        demo_window_get_property(window,
+                                 DEMO_WINDOW_PROPERTY_RENDERING_CONTEXT,
+                                &result);
+    }
+
+    return result;
+}
+
+/** Creates a single-layer, single-pass regular mesh out of the specified data, generates normals for it
+ *  and copies them to @param out_normals. */
+PRIVATE void generate_normals(ral_context           context,
+                              const float*          vertex_data,
+                              uint32_t              n_vertices,
+                              const uint32_t*       index_data,
+                              uint32_t              n_elements,
+                              float                 smoothing_angle,
+                              mesh_normal_weighting weighting,
+                              std::vector<float>&   out_normals)
+{
+    mesh_layer_pass_id layer_pass_id;
+    mesh_layer_id      layer_id;
+    mesh_material      material         = mesh_material_create(system_hashed_ansi_string_create("Test material"),
+                                                               context,
+                                                               nullptr); /* object_manager_path */
+    mesh               new_mesh         = mesh_create_regular_mesh(0, /* flags */
+                                                                   system_hashed_ansi_string_create("Test mesh") );
+    const float*       normal_data      = nullptr;
+    uint32_t           n_normals        = 0;
+
+    mesh_material_set_property(material,
+                               MESH_MATERIAL_PROPERTY_VERTEX_SMOOTHING_ANGLE,
+                              &smoothing_angle);
+
+    layer_id      = mesh_add_layer                              (new_mesh);
+    layer_pass_id = mesh_add_layer_pass_for_regular_mesh        (new_mesh,
+                                                                 layer_id,
+                                                                 material,
+                                                                 n_elements);
+
+    mesh_add_layer_data_stream_from_client_memory  (new_mesh,
+                                                    layer_id,
+                                                    MESH_LAYER_DATA_STREAM_TYPE_VERTICES,
+                                                    3, /* n_components */
+                                                    n_vertices,
+                                                    vertex_data);
+    mesh_add_layer_pass_index_data_for_regular_mesh(new_mesh,
+                                                    layer_id,
+                                                    layer_pass_id,
+                                                    MESH_LAYER_DATA_STREAM_TYPE_VERTICES,
+                                                    0, /* set_id */
+                                                    index_data,
+                                                    0, /* min_index */
+                                                    n_vertices - 1);
+
+    mesh_generate_normal_data(new_mesh,
+                              weighting);
+
+    ASSERT_TRUE(mesh_get_layer_data_stream_data(new_mesh,
+                                                layer_id,
+                                                MESH_LAYER_DATA_STREAM_TYPE_NORMALS,
+                                               &n_normals,
+                                                reinterpret_cast<const void**>(&normal_data) ));
+    ASSERT_EQ  (n_normals,
+                n_elements);
+
+    out_normals.assign(normal_data,
+                       normal_data + n_normals * 3);
+
+    mesh_release         (new_mesh);
+    mesh_material_release(material);
+}
+
+/** Describes a single layer pass of a mesh created by create_single_indexed_test_mesh(). */
+typedef struct
+{
+    uint32_t n_layer;
+    uint32_t n_material;
+    uint32_t n_elements;
+} single_indexed_test_pass;
+
+/** Per-stream data of a mesh created by create_single_indexed_test_mesh(). Stream data is stored
+ *  separately for each layer, index data is stored separately for each pass. */
+typedef struct
+{
+    uint32_t                            n_components;
+    uint32_t                            n_items;
+    std::vector<std::vector<float> >    layer_data;
+    std::vector<std::vector<uint32_t> > pass_index_data;
+    mesh_layer_data_stream_type         type;
+} single_indexed_test_stream;
+
+/** Creates a regular mesh with vertex, normal and texcoord streams, each indexed separately with
+ *  pseudo-random index data, so that many index tuples repeat within each pass.
+ *
+ *  @param materials    Materials to assign to layer passes.
+ *  @param passes       Layer passes to create. Layers must be listed in ascending order.
+ *  @param n_passes     Number of entries in @param passes.
+ *  @param n_vertices   Number of items in each layer's vertex stream.
+ *  @param out_streams  Deref will be set to the data used to fill the mesh. Must hold 3 entries.
+ *
+ *  @return The new mesh.
+ */
+PRIVATE mesh create_single_indexed_test_mesh(const mesh_material*            materials,
+                                             const single_indexed_test_pass* passes,
+                                             uint32_t                        n_passes,
+                                             uint32_t                        n_vertices,
+                                             single_indexed_test_stream*     out_streams)
+{
+    mesh     result = mesh_create_regular_mesh(0, /* flags */
+                                               system_hashed_ansi_string_create("Test mesh") );
+    uint32_t seed   = 1;
+
+    out_streams[0].n_components = 3;
+    out_streams[0].n_items      = n_vertices;
+    out_streams[0].type         = MESH_LAYER_DATA_STREAM_TYPE_VERTICES;
+    out_streams[1].n_components = 3;
+    out_streams[1].n_items      = 5;
+    out_streams[1].type         = MESH_LAYER_DATA_STREAM_TYPE_NORMALS;
+    out_streams[2].n_components = 2;
+    out_streams[2].n_items      = 4;
+    out_streams[2].type         = MESH_LAYER_DATA_STREAM_TYPE_TEXCOORDS;
+
+    for (uint32_t n_pass = 0;
+                  n_pass < n_passes;
+                ++n_pass)
+    {
+        mesh_layer_pass_id layer_pass_id;
+
+        if (n_pass == 0                                        ||
+            passes[n_pass - 1].n_layer != passes[n_pass].n_layer)
+        {
+            const mesh_layer_id layer_id = mesh_add_layer(result);
+
+            for (uint32_t n_stream = 0;
+                          n_stream < 3;
+                        ++n_stream)
+            {
+                std::vector<float> stream_data(out_streams[n_stream].n_components * out_streams[n_stream].n_items);
+
+                for (uint32_t n_value = 0;
+                              n_value < stream_data.size();
+                            ++n_value)
+                {
+                    stream_data[n_value] = float(layer_id * 1000000 + n_stream * 100000 + n_value) * 0.25f - 1000.0f;
+                }
+
+                mesh_add_layer_data_stream_from_client_memory(result,
+                                                              layer_id,
+                                                              out_streams[n_stream].type,
+                                                              out_streams[n_stream].n_components,
+                                                              out_streams[n_stream].n_items,
+                                                             &stream_data[0]);
+
+                out_streams[n_stream].layer_data.push_back(stream_data);
+            }
+        }
+
+        layer_pass_id = mesh_add_layer_pass_for_regular_mesh(result,
+                                                             passes[n_pass].n_layer,
+                                                             materials[passes[n_pass].n_material],
+                                                             passes[n_pass].n_elements);
+
+        for (uint32_t n_stream = 0;
+                      n_stream < 3;
+                    ++n_stream)
+        {
+            std::vector<uint32_t> index_data(passes[n_pass].n_elements);
+
+            for (uint32_t n_element = 0;
+                          n_element < passes[n_pass].n_elements;
+                        ++n_element)
+            {
+                seed                  = seed * 1664525 + 1013904223;
+                index_data[n_element] = (seed >> 8) % out_streams[n_stream].n_items;
+            }
+
+            mesh_add_layer_pass_index_data_for_regular_mesh(result,
+                                                            passes[n_pass].n_layer,
+                                                            layer_pass_id,
+                                                            out_streams[n_stream].type,
+                                                            0, /* set_id */
+                                                           &index_data[0],
+                                                            0, /* min_index */
+                                                            out_streams[n_stream].n_items - 1);
+
+            out_streams[n_stream].pass_index_data.push_back(index_data);
+        }
+    }
+
+    return result;
+}
+
+/** Loads a mesh stored by save_test_mesh().
+ *
+ *  @param context     Rendering context to use.
+ *  @param materials   Materials, as passed to save_test_mesh().
+ *  @param n_materials Number of entries in @param materials.
+ *  @param file_name   Name of the file to load the mesh from.
+ *  @param is_mapped   true to read the file through a mapping, false to read it into memory.
+ *
+ *  @return The loaded mesh. Processed data is retained.
+ */
+PRIVATE mesh load_test_mesh(ral_context          context,
+                            const mesh_material* materials,
+                            uint32_t             n_materials,
+                            const char*          file_name,
+                            bool                 is_mapped)
+{
+    system_hash64map       material_id_to_mesh_material_map = system_hash64map_create(sizeof(void*) );
+    system_hash64map       mesh_name_to_mesh_map            = system_hash64map_create(sizeof(void*) );
+    mesh                   result                           = nullptr;
+    system_file_serializer serializer                       = (is_mapped) ? system_file_serializer_create_for_reading_mapped_file(system_hashed_ansi_string_create(file_name) )
+                                                                          : system_file_serializer_create_for_reading           (system_hashed_ansi_string_create(file_name) );
+
+    for (uint32_t n_material = 0;
+                  n_material < n_materials;
+                ++n_material)
+    {
+        system_hash64map_insert(material_id_to_mesh_material_map,
+                                (system_hash64) n_material,
+                                materials[n_material],
+                                nullptr,  /* on_remove_callback          */
+                                nullptr); /* on_remove_callback_user_arg */
+    }
+
+    result = mesh_load_with_serializer(context,
+                                       MESH_CREATION_FLAGS_SAVE_SUPPORT,
+                                       serializer,
+                                       material_id_to_mesh_material_map,
+                                       mesh_name_to_mesh_map);
+
+    system_file_serializer_release(serializer);
+    system_hash64map_release      (material_id_to_mesh_material_map);
+    system_hash64map_release      (mesh_name_to_mesh_map);
+
+    return result;
+}
+
+/** Saves a mesh to a file. Materials are identified by their index in @param materials. */
+PRIVATE void save_test_mesh(mesh                 test_mesh,
+                            const mesh_material* materials,
+                            uint32_t             n_materials,
+                            const char*          file_name)
+{
+    system_hash64map       mesh_material_to_id_map = system_hash64map_create(sizeof(uint32_t) );
+    system_file_serializer serializer              = system_file_serializer_create_for_writing(system_hashed_ansi_string_create(file_name) );
+
+    for (uint32_t n_material = 0;
+                  n_material < n_materials;
+                ++n_material)
+    {
+        system_hash64map_insert(mesh_material_to_id_map,
+                                reinterpret_cast<system_hash64>(materials[n_material]),
+                                reinterpret_cast<void*>        (static_cast<intptr_t>(n_material) ),
+                                nullptr,  /* on_remove_callback          */
+                                nullptr); /* on_remove_callback_user_arg */
+    }
+
+    mesh_save_with_serializer(test_mesh,
+                              serializer,
+                              mesh_material_to_id_map);
+
+    /* Releasing the serializer flushes the file */
+    system_file_serializer_release(serializer);
+    system_hash64map_release      (mesh_material_to_id_map);
+}
+
+/** Returns the normalized cross product of (b - a) and (c - a). */
+PRIVATE void get_triangle_normal(const float* a,
+                                 const float* b,
+                                 const float* c,
+                                 float*       out_result)
+{
+    float b_minus_a[3];
+    float c_minus_a[3];
+
+    system_math_vector_minus3    (b,
+                                  a,
+                                  b_minus_a);
+    system_math_vector_minus3    (c,
+                                  a,
+                                  c_minus_a);
+    system_math_vector_cross3    (b_minus_a,
+                                  c_minus_a,
+                                  out_result);
+    system_math_vector_normalize3(out_result,
+                                  out_result);
+}
+
+PRIVATE void verify_normal(const float* normal,
+                           float        expected_x,
+                           float        expected_y,
+                           float        expected_z)
+{
+    float expected[3] =
+    {
+        expected_x,
+        expected_y,
+        expected_z
+    };
+
+    system_math_vector_normalize3(expected,
+                                  expected);
+
+    ASSERT_NEAR(normal[0], expected[0], NORMAL_EPSILON);
+    ASSERT_NEAR(normal[1], expected[1], NORMAL_EPSILON);
+    ASSERT_NEAR(normal[2], expected[2], NORMAL_EPSILON);
+}
+
+
+/* Two triangles folded along a shared edge. The edge's vertices are defined separately for each
+ * triangle, and their locations differ by less than the welding epsilon, on different sides of
+ * a welding grid cell boundary. */
+TEST(MeshTest, EncodedMeshSurvivesSaveLoadRoundTrip)
+{
+    const ral_context context = create_test_context();
+
+    ASSERT_NE(context,
+              (ral_context) nullptr);
+
+    const mesh_index_encoding         index_encoding = MESH_INDEX_ENCODING_DELTA_VARINT;
+    const single_indexed_test_pass    passes[]       =
+    {
+        {0, 0, 600},
+        {0, 1, 300},
+        {1, 0, 450}
+    };
+    const uint32_t                    n_passes       = sizeof(passes) / sizeof(passes[0]);
+    const mesh_layer_data_stream_type stream_types[] =
+    {
+        MESH_LAYER_DATA_STREAM_TYPE_NORMALS,
+        MESH_LAYER_DATA_STREAM_TYPE_TEXCOORDS,
+        MESH_LAYER_DATA_STREAM_TYPE_VERTICES
+    };
+
+    std::vector<uint32_t>      elements_offsets;
+    mesh_material              materials[2];
+    uint32_t                   n_vertices          = 0;
+    const void*                processed_data      = nullptr;
+    std::vector<unsigned char> processed_data_copy;
+    uint32_t                   processed_data_size = 0;
+    uint32_t                   stream_offsets[3];
+    single_indexed_test_stream streams[3];
+    uint32_t                   stride              = 0;
+    mesh                       test_mesh           = nullptr;
+    uint32_t                   total_elements      = 0;
+    float                      vertex_max[3]       = {-FLT_MAX, -FLT_MAX, -FLT_MAX};
+    float                      vertex_min[3]       = { FLT_MAX,  FLT_MAX,  FLT_MAX};
+
+    materials[0] = mesh_material_create(system_hashed_ansi_string_create("Test material 1"),
+                                        context,
+                                        nullptr); /* object_manager_path */
+    materials[1] = mesh_material_create(system_hashed_ansi_string_create("Test material 2"),
+                                        context,
+                                        nullptr); /* object_manager_path */
+
+    test_mesh = create_single_indexed_test_mesh(materials,
+                                                passes,
+                                                n_passes,
+                                                20, /* n_vertices */
+                                                streams);
+
+    mesh_create_single_indexed_representation(test_mesh);
+    mesh_optimize                            (test_mesh,
+                                              MESH_OPTIMIZATION_FLAGS_ALL);
+
+    mesh_set_processed_data_stream_encoding(test_mesh,
+                                            MESH_LAYER_DATA_STREAM_TYPE_NORMALS,
+                                            MESH_LAYER_DATA_STREAM_ENCODING_OCTAHEDRAL_SNORM16);
+    mesh_set_processed_data_stream_encoding(test_mesh,
+                                            MESH_LAYER_DATA_STREAM_TYPE_VERTICES,
+                                            MESH_LAYER_DATA_STREAM_ENCODING_SNORM16_BOUNDS);
+    mesh_set_property                      (test_mesh,
+                                            MESH_PROPERTY_BO_INDEX_ENCODING,
+                                           &index_encoding);
+
+    save_test_mesh(test_mesh,
+                   materials,
+                   2, /* n_materials */
+                   ENCODED_MESH_FILE_NAME);
+
+    /* Store the reference data. Loaded meshes use the same name, so the original mesh needs to go first. */
+    mesh_get_property(test_mesh,
+                      MESH_PROPERTY_BO_PROCESSED_DATA,
+                     &processed_data);
+    mesh_get_property(test_mesh,
+                      MESH_PROPERTY_BO_PROCESSED_DATA_SIZE,
+                     &processed_data_size);
+    mesh_get_property(test_mesh,
+                      MESH_PROPERTY_BO_STRIDE,
+                     &stride);
+    mesh_get_property(test_mesh,
+                      MESH_PROPERTY_BO_TOTAL_ELEMENTS,
+                     &total_elements);
+    mesh_get_property(test_mesh,
+                      MESH_PROPERTY_N_BO_UNIQUE_VERTICES,
+                     &n_vertices);
+
+    processed_data_copy.assign(reinterpret_cast<const unsigned char*>(processed_data),
+                               reinterpret_cast<const unsigned char*>(processed_data) + processed_data_size);
+
+    for (uint32_t n_stream = 0;
+                  n_stream < 3;
+                ++n_stream)
+    {
+        mesh_get_layer_data_stream_property(test_mesh,
+                                            0, /* layer_id */
+                                            stream_types[n_stream],
+                                            MESH_LAYER_DATA_STREAM_PROPERTY_START_OFFSET,
+                                           &stream_offsets[n_stream]);
+    }
+
+    for (uint32_t n_pass = 0,
+                  n_layer_pass = 0;
+                  n_pass < n_passes;
+                ++n_pass,
+                ++n_layer_pass)
+    {
+        uint32_t elements_offset = 0;
+
+        if (n_pass > 0                                         &&
+            passes[n_pass - 1].n_layer != passes[n_pass].n_layer)
+        {
+            n_layer_pass = 0;
+        }
+
+        mesh_get_layer_pass_property(test_mesh,
+                                     passes[n_pass].n_layer,
+                                     n_layer_pass,
+                                     MESH_LAYER_PROPERTY_BO_ELEMENTS_OFFSET,
+                                    &elements_offset);
+
+        elements_offsets.push_back(elements_offset);
+    }
+
+    for (uint32_t n_vertex = 0;
+                  n_vertex < n_vertices;
+                ++n_vertex)
+    {
+        const float* vertex_ptr = reinterpret_cast<const float*>(&processed_data_copy[stride * n_vertex + stream_offsets[2] ]);
+
+        for (uint32_t n_component = 0;
+                      n_component < 3;
+                    ++n_component)
+        {
+            vertex_max[n_component] = std::max(vertex_max[n_component], vertex_ptr[n_component]);
+            vertex_min[n_component] = std::min(vertex_min[n_component], vertex_ptr[n_component]);
+        }
+    }
+
+    mesh_release(test_mesh);
+
+    /* Load the mesh back, both from a mapped file and from a file read into memory. */
+    for (uint32_t n_iteration = 0;
+                  n_iteration < 2;
+                ++n_iteration)
+    {
+        mesh                            loaded_mesh           = load_test_mesh(context,
+                                                                               materials,
+                                                                               2, /* n_materials */
+                                                                               ENCODED_MESH_FILE_NAME,
+                                                                               (n_iteration == 0) );
+        mesh_index_encoding             loaded_index_encoding = MESH_INDEX_ENCODING_RAW;
+        const unsigned char*            loaded_data           = nullptr;
+        uint32_t                        loaded_data_size      = 0;
+        uint32_t                        loaded_n_vertices     = 0;
+        mesh_layer_data_stream_encoding loaded_normals_encoding;
+        uint32_t                        loaded_stride         = 0;
+        uint32_t                        loaded_total_elements = 0;
+
+        ASSERT_NE(loaded_mesh,
+                  (mesh) nullptr);
+
+        mesh_get_property                  (loaded_mesh,
+                                            MESH_PROPERTY_BO_INDEX_ENCODING,
+                                           &loaded_index_encoding);
+        mesh_get_property                  (loaded_mesh,
+                                            MESH_PROPERTY_BO_PROCESSED_DATA,
+                                           &loaded_data);
+        mesh_get_property                  (loaded_mesh,
+                                            MESH_PROPERTY_BO_PROCESSED_DATA_SIZE,
+                                           &loaded_data_size);
+        mesh_get_property                  (loaded_mesh,
+                                            MESH_PROPERTY_BO_STRIDE,
+                                           &loaded_stride);
+        mesh_get_property                  (loaded_mesh,
+                                            MESH_PROPERTY_BO_TOTAL_ELEMENTS,
+                                           &loaded_total_elements);
+        mesh_get_property                  (loaded_mesh,
+                                            MESH_PROPERTY_N_BO_UNIQUE_VERTICES,
+                                           &loaded_n_vertices);
+        mesh_get_layer_data_stream_property(loaded_mesh,
+                                            0, /* layer_id */
+                                            MESH_LAYER_DATA_STREAM_TYPE_NORMALS,
+                                            MESH_LAYER_DATA_STREAM_PROPERTY_ENCODING,
+                                           &loaded_normals_encoding);
+
+        ASSERT_EQ(loaded_data_size,        processed_data_size);
+        ASSERT_EQ(loaded_index_encoding,   index_encoding);
+        ASSERT_EQ(loaded_n_vertices,       n_vertices);
+        ASSERT_EQ(loaded_normals_encoding, MESH_LAYER_DATA_STREAM_ENCODING_OCTAHEDRAL_SNORM16);
+        ASSERT_EQ(loaded_stride,           stride);
+        ASSERT_EQ(loaded_total_elements,   total_elements);
+
+        for (uint32_t n_pass = 0,
+                      n_layer_pass = 0;
+                      n_pass < n_passes;
+                    ++n_pass,
+                    ++n_layer_pass)
+        {
+            uint32_t elements_offset = 0;
+
+            if (n_pass > 0                                         &&
+                passes[n_pass - 1].n_layer != passes[n_pass].n_layer)
+            {
+                n_layer_pass = 0;
+            }
+
+            mesh_get_layer_pass_property(loaded_mesh,
+                                         passes[n_pass].n_layer,
+                                         n_layer_pass,
+                                         MESH_LAYER_PROPERTY_BO_ELEMENTS_OFFSET,
+                                        &elements_offset);
+
+            ASSERT_EQ(elements_offset,
+                      elements_offsets[n_pass]);
+        }
+
+        /* Index data is stored losslessly */
+        ASSERT_EQ(memcmp(loaded_data                 + stride * n_vertices,
+                         &processed_data_copy[0]     + stride * n_vertices,
+                         processed_data_size - stride * n_vertices),
+                  0);
+
+        for (uint32_t n_vertex = 0;
+                      n_vertex < n_vertices;
+                    ++n_vertex)
+        {
+            const float* loaded_normal_ptr   = reinterpret_cast<const float*>(loaded_data             + stride * n_vertex + stream_offsets[0]);
+            const float* loaded_texcoord_ptr = reinterpret_cast<const float*>(loaded_data             + stride * n_vertex + stream_offsets[1]);
+            const float* loaded_vertex_ptr   = reinterpret_cast<const float*>(loaded_data             + stride * n_vertex + stream_offsets[2]);
+            const float* normal_ptr          = reinterpret_cast<const float*>(&processed_data_copy[0] + stride * n_vertex + stream_offsets[0]);
+            const float* texcoord_ptr        = reinterpret_cast<const float*>(&processed_data_copy[0] + stride * n_vertex + stream_offsets[1]);
+            const float* vertex_ptr          = reinterpret_cast<const float*>(&processed_data_copy[0] + stride * n_vertex + stream_offsets[2]);
+            const float  normal_length       = sqrtf(normal_ptr[0] * normal_ptr[0] + normal_ptr[1] * normal_ptr[1] + normal_ptr[2] * normal_ptr[2]);
+
+            /* Octahedral normals come back normalized. For unit vectors, the distance between both
+             * approximates the angle between them. */
+            for (uint32_t n_component = 0;
+                          n_component < 3;
+                        ++n_component)
+            {
+                ASSERT_NEAR(loaded_normal_ptr[n_component],
+                            normal_ptr       [n_component] / normal_length,
+                            OCTAHEDRAL_EPSILON);
+            }
+
+            /* Texture coordinates use the default encoding */
+            ASSERT_EQ(loaded_texcoord_ptr[0], texcoord_ptr[0]);
+            ASSERT_EQ(loaded_texcoord_ptr[1], texcoord_ptr[1]);
+
+            for (uint32_t n_component = 0;
+                          n_component < 3;
+                        ++n_component)
+            {
+                ASSERT_LE(fabsf(loaded_vertex_ptr[n_component] - vertex_ptr[n_component]),
+                          (vertex_max[n_component] - vertex_min[n_component]) * 0.5f / 32767.0f);
+            }
+        }
+
+        mesh_release(loaded_mesh);
+    }
+
+    mesh_material_release(materials[0]);
+    mesh_material_release(materials[1]);
+
+    ASSERT_TRUE(demo_app_destroy_window(system_hashed_ansi_string_create(TEST_WINDOW_NAME) ));
+}
+
+TEST(MeshTest, NormalGenerationWeldsVerticesAcrossCellBoundaries)
+{
+    const ral_context context = create_test_context();
+
+    ASSERT_NE(context,
+              (ral_context) nullptr);
+
+    const float vertex_data[] =
+    {
+        /* Triangle 1: in the XZ plane, normal pointing towards -Y */
+        -0.000003f, 0.0f, 0.0f,
+         1.0f,      0.0f, 0.0f,
+        -0.000003f, 0.0f, 1.0f,
+
+        /* Triangle 2: in the XY plane, normal pointing towards -Z */
+         0.000003f, 0.0f, 0.0f,
+         0.000003f, 1.0f, 0.0f,
+         1.0f,      0.0f, 0.0f
+    };
+    const uint32_t     index_data[] = {0, 1, 2, 3, 4, 5};
+    std::vector<float> normals;
+
+    generate_normals(context,
+                     vertex_data,
+                     6, /* n_vertices */
+                     index_data,
+                     6, /* n_elements */
+                     3.0f, /* smoothing_angle */
+                     MESH_NORMAL_WEIGHTING_UNIFORM,
+                     normals);
+
+    /* Vertices shared by both triangles */
+    verify_normal(&normals[0 * 3], 0.0f, -1.0f, -1.0f);
+    verify_normal(&normals[1 * 3], 0.0f, -1.0f, -1.0f);
+    verify_normal(&normals[3 * 3], 0.0f, -1.0f, -1.0f);
+    verify_normal(&normals[5 * 3], 0.0f, -1.0f, -1.0f);
+
+    /* Vertices only used by a single triangle */
+    verify_normal(&normals[2 * 3], 0.0f, -1.0f,  0.0f);
+    verify_normal(&normals[4 * 3], 0.0f,  0.0f, -1.0f);
+
+    ASSERT_TRUE(demo_app_destroy_window(system_hashed_ansi_string_create(TEST_WINDOW_NAME) ));
+}
+
+/* Same as above, but the shared edge's vertices are too far away from each other to be welded,
+ * or the smoothing angle is too small for the normals to be averaged. */
+TEST(MeshTest, NormalGenerationRespectsEpsilonAndSmoothingAngle)
+{
+    const ral_context context = create_test_context();
+
+    ASSERT_NE(context,
+              (ral_context) nullptr);
+
+    const float vertex_data[] =
+    {
+        0.0f,    0.0f, 0.0f,
+        1.0f,    0.0f, 0.0f,
+        0.0f,    0.0f, 1.0f,
+
+        0.0001f, 0.0f, 0.0f,
+        0.0001f, 1.0f, 0.0f,
+        1.0f,    0.0f, 0.0f
+    };
+    const uint32_t     index_data[] = {0, 1, 2, 3, 4, 5};
+    std::vector<float> normals;
+
+    generate_normals(context,
+                     vertex_data,
+                     6, /* n_vertices */
+                     index_data,
+                     6, /* n_elements */
+                     3.0f, /* smoothing_angle */
+                     MESH_NORMAL_WEIGHTING_UNIFORM,
+                     normals);
+
+    verify_normal(&normals[0 * 3], 0.0f, -1.0f,  0.0f);
+    verify_normal(&normals[1 * 3], 0.0f, -1.0f, -1.0f);
+    verify_normal(&normals[3 * 3], 0.0f,  0.0f, -1.0f);
+    verify_normal(&normals[5 * 3], 0.0f, -1.0f, -1.0f);
+
+    generate_normals(context,
+                     vertex_data,
+                     6, /* n_vertices */
+                     index_data,
+                     6, /* n_elements */
+                     1.0f, /* smoothing_angle: less than 90 degrees */
+                     MESH_NORMAL_WEIGHTING_UNIFORM,
+                     normals);
+
+    verify_normal(&normals[1 * 3], 0.0f, -1.0f,  0.0f);
+    verify_normal(&normals[5 * 3], 0.0f,  0.0f, -1.0f);
+
+    ASSERT_TRUE(demo_app_destroy_window(system_hashed_ansi_string_create(TEST_WINDOW_NAME) ));
+}
+
+/* Two triangles of different sizes and corner angles share the vertex at the origin. */
+TEST(MeshTest, NormalGenerationWeightingModes)
+{
+    const ral_context context = create_test_context();
+
+    ASSERT_NE(context,
+              (ral_context) nullptr);
+
+    const float vertex_data[] =
+    {
+        0.0f, 0.0f, 0.0f,
+        2.0f, 0.0f, 0.0f,
+        0.0f, 0.0f, 1.0f,
+        0.0f, 1.0f, 0.0f,
+    };
+    const uint32_t index_data[] =
+    {
+        0, 1, 2, /* area 1,   90 degrees at the origin, normal pointing towards -Y */
+        0, 3, 1  /* area 1,   90 degrees at the origin, normal pointing towards -Z */
+    };
+    const float vertex_data_2[] =
+    {
+        0.0f, 0.0f, 0.0f,
+        2.0f, 0.0f, 0.0f,
+        1.0f, 0.0f, 1.0f,
+        0.0f, 3.0f, 0.0f,
+    };
+    std::vector<float> normals;
+
+    /* Equal areas & angles: all modes yield the same result */
+    generate_normals(context,
+                     vertex_data,
+                     4, /* n_vertices */
+                     index_data,
+                     6, /* n_elements */
+                     3.0f, /* smoothing_angle */
+                     MESH_NORMAL_WEIGHTING_AREA,
+                     normals);
+
+    verify_normal(&normals[0 * 3], 0.0f, -1.0f, -1.0f);
+
+    /* Triangle 1: area 1, 45 degrees at the origin. Triangle 2: area 3, 90 degrees at the origin. */
+    generate_normals(context,
+                     vertex_data_2,
+                     4, /* n_vertices */
+                     index_data,
+                     6, /* n_elements */
+                     3.0f, /* smoothing_angle */
+                     MESH_NORMAL_WEIGHTING_UNIFORM,
+                     normals);
+
+    verify_normal(&normals[0 * 3], 0.0f, -1.0f, -1.0f);
+    verify_normal(&normals[3 * 3], 0.0f, -1.0f, -1.0f);
+
+    generate_normals(context,
+                     vertex_data_2,
+                     4, /* n_vertices */
+                     index_data,
+                     6, /* n_elements */
+                     3.0f, /* smoothing_angle */
+                     MESH_NORMAL_WEIGHTING_AREA,
+                     normals);
+
+    verify_normal(&normals[0 * 3], 0.0f, -1.0f, -3.0f);
+    verify_normal(&normals[3 * 3], 0.0f, -1.0f, -3.0f);
+
+    generate_normals(context,
+                     vertex_data_2,
+                     4, /* n_vertices */
+                     index_data,
+                     6, /* n_elements */
+                     3.0f, /* smoothing_angle */
+                     MESH_NORMAL_WEIGHTING_ANGLE,
+                     normals);
+
+    verify_normal(&normals[0 * 3], 0.0f, -1.0f, -2.0f);
+
+    /* The vertex at (2, 0, 0) spans 45 degrees in triangle 1 and atan(1.5) in triangle 2 */
+    verify_normal(&normals[1 * 3], 0.0f, -atan(1.0f), -atan(1.5f) );
+
+    ASSERT_TRUE(demo_app_destroy_window(system_hashed_ansi_string_create(TEST_WINDOW_NAME) ));
+}
+
+/* Measures the normal generation for a ~1M-triangle height field. */
+TEST(MeshTest, DISABLED_NormalGenerationBenchmark)
+{
+    const ral_context context = create_test_context();
+
+    ASSERT_NE(context,
+              (ral_context) nullptr);
+
+    std::vector<uint32_t> index_data;
+    const uint32_t        n_vertices      = (BENCHMARK_GRID_SIZE + 1) * (BENCHMARK_GRID_SIZE + 1);
+    const uint32_t        n_triangles     = BENCHMARK_GRID_SIZE * BENCHMARK_GRID_SIZE * 2;
+    std::vector<float>    normals;
+    const float           smoothing_angle = 0.8f;
+    __uint64              time_start      = 0;
+    __uint64              time_total      = 0;
+    std::vector<float>    vertex_data;
+
+    for (uint32_t n_row = 0;
+                  n_row <= BENCHMARK_GRID_SIZE;
+                ++n_row)
+    {
+        for (uint32_t n_column = 0;
+                      n_column <= BENCHMARK_GRID_SIZE;
+                    ++n_column)
+        {
+            vertex_data.push_back(float(n_column) );
+            vertex_data.push_back(sinf(float(n_column) * 0.1f) * cosf(float(n_row) * 0.07f) * 10.0f);
+            vertex_data.push_back(float(n_row) );
+        }
+    }
+
+    for (uint32_t n_row = 0;
+                  n_row < BENCHMARK_GRID_SIZE;
+                ++n_row)
+    {
+        for (uint32_t n_column = 0;
+                      n_column < BENCHMARK_GRID_SIZE;
+                    ++n_column)
+        {
+            const uint32_t top_left = n_row * (BENCHMARK_GRID_SIZE + 1) + n_column;
+
+            index_data.push_back(top_left);
+            index_data.push_back(top_left + BENCHMARK_GRID_SIZE + 1);
+            index_data.push_back(top_left + 1);
+
+            index_data.push_back(top_left + 1);
+            index_data.push_back(top_left + BENCHMARK_GRID_SIZE + 1);
+            index_data.push_back(top_left + BENCHMARK_GRID_SIZE + 2);
+        }
+    }
+
+    time_start = system_time_now_usec();
+    {
+        generate_normals(context,
+                         &vertex_data[0],
+                         n_vertices,
+                         &index_data[0],
+                         n_triangles * 3,
+                         smoothing_angle,
+                         MESH_NORMAL_WEIGHTING_UNIFORM,
+                         normals);
+    }
+    time_total = system_time_now_usec() - time_start;
+
+    LOG_INFO("[%u triangles] msec: %10.2f",
+             n_triangles,
+             double(time_total) / 1000.0);
+
+    ASSERT_TRUE(demo_app_destroy_window(system_hashed_ansi_string_create(TEST_WINDOW_NAME) ));
+}
+
+/* Index tuples are merged within each pass. Merged vertices are numbered in the order in which
+ * they are first used, starting from the first pass of the first layer, and each unique vertex
+ * is stored only once in the interleaved buffer. The whole buffer is built from the source data
+ * by hand and compared byte by byte against what the mesh has generated. */
+TEST(MeshTest, SingleIndexedRepresentationMatchesReference)
+{
+    const ral_context context = create_test_context();
+
+    ASSERT_NE(context,
+              (ral_context) nullptr);
+
+    const single_indexed_test_pass passes[] =
+    {
+        {0, 0, 600},
+        {0, 1, 300},
+        {1, 0, 450}
+    };
+    const uint32_t n_layers = 2;
+    const uint32_t n_passes = sizeof(passes) / sizeof(passes[0]);
+
+    std::vector<unsigned char> expected_data;
+    uint32_t                   index_size             = 0;
+    _mesh_index_type           index_type;
+    mesh_material              materials[2];
+    uint32_t                   n_expected_elements    = 0;
+    uint32_t                   n_mesh_unique_vertices = 0;
+    uint32_t                   n_unique_vertices      = 0;
+    std::vector<uint32_t>      pass_indices[n_passes];
+    const void*                processed_data         = nullptr;
+    uint32_t                   processed_data_size    = 0;
+    uint32_t                   stream_start_offsets[3];
+    single_indexed_test_stream streams[3];
+    uint32_t                   stride                 = 0;
+    std::vector<uint32_t>      unique_vertex_elements;
+    std::vector<uint32_t>      unique_vertex_passes;
+    mesh                       test_mesh              = nullptr;
+
+    materials[0] = mesh_material_create(system_hashed_ansi_string_create("Test material 1"),
+                                        context,
+                                        nullptr); /* object_manager_path */
+    materials[1] = mesh_material_create(system_hashed_ansi_string_create("Test material 2"),
+                                        context,
+                                        nullptr); /* object_manager_path */
+
+    test_mesh = create_single_indexed_test_mesh(materials,
+                                                passes,
+                                                n_passes,
+                                                20, /* n_vertices */
+                                                streams);
+
+    mesh_create_single_indexed_representation(test_mesh);
+
+    /* Merge the index tuples by hand */
+    for (uint32_t n_pass = 0;
+                  n_pass < n_passes;
+                ++n_pass)
+    {
+        std::map<std::vector<uint32_t>, uint32_t> tuple_to_vertex_map;
+
+        for (uint32_t n_element = 0;
+                      n_element < passes[n_pass].n_elements;
+                    ++n_element)
+        {
+            std::vector<uint32_t> tuple;
+
+            for (uint32_t n_stream = 0;
+                          n_stream < 3;
+                        ++n_stream)
+            {
+                tuple.push_back(streams[n_stream].pass_index_data[n_pass][n_element]);
+            }
+
+            if (tuple_to_vertex_map.find(tuple) == tuple_to_vertex_map.end() )
+            {
+                tuple_to_vertex_map[tuple] = n_unique_vertices++;
+
+                unique_vertex_elements.push_back(n_element);
+                unique_vertex_passes.push_back  (n_pass);
+            }
+
+            pass_indices[n_pass].push_back(tuple_to_vertex_map[tuple]);
+        }
+
+        n_expected_elements += passes[n_pass].n_elements;
+    }
+
+    /* Build the expected buffer */
+    mesh_get_property(test_mesh,
+                      MESH_PROPERTY_BO_INDEX_TYPE,
+                     &index_type);
+    mesh_get_property(test_mesh,
+                      MESH_PROPERTY_BO_PROCESSED_DATA,
+                     &processed_data);
+    mesh_get_property(test_mesh,
+                      MESH_PROPERTY_BO_PROCESSED_DATA_SIZE,
+                     &processed_data_size);
+    mesh_get_property(test_mesh,
+                      MESH_PROPERTY_BO_STRIDE,
+                     &stride);
+    mesh_get_property(test_mesh,
+                      MESH_PROPERTY_N_BO_UNIQUE_VERTICES,
+                     &n_mesh_unique_vertices);
+
+    ASSERT_EQ(n_mesh_unique_vertices,
+              n_unique_vertices);
+    ASSERT_EQ(index_type,
+              MESH_INDEX_TYPE_UNSIGNED_SHORT);
+    ASSERT_EQ(stride,
+              sizeof(float) * (3 + 3 + 2) );
+
+    index_size = sizeof(uint16_t);
+
+    ASSERT_EQ(processed_data_size,
+              n_unique_vertices * stride + n_expected_elements * index_size);
+
+    expected_data.resize(processed_data_size);
+
+    for (uint32_t n_stream = 0;
+                  n_stream < 3;
+                ++n_stream)
+    {
+        mesh_get_layer_data_stream_property(test_mesh,
+                                            0, /* layer_id */
+                                            streams[n_stream].type,
+                                            MESH_LAYER_DATA_STREAM_PROPERTY_START_OFFSET,
+                                           &stream_start_offsets[n_stream]);
+    }
+
+    for (uint32_t n_unique_vertex = 0;
+                  n_unique_vertex < n_unique_vertices;
+                ++n_unique_vertex)
+    {
+        const uint32_t n_element = unique_vertex_elements[n_unique_vertex];
+        const uint32_t n_pass    = unique_vertex_passes  [n_unique_vertex];
+
+        for (uint32_t n_stream = 0;
+                      n_stream < 3;
+                    ++n_stream)
+        {
+            const uint32_t n_source_item = streams[n_stream].pass_index_data[n_pass][n_element];
+
+            memcpy(&expected_data[0] + stride * n_unique_vertex + stream_start_offsets[n_stream],
+                   &streams[n_stream].layer_data[passes[n_pass].n_layer][0] + streams[n_stream].n_components * n_source_item,
+                   sizeof(float) * streams[n_stream].n_components);
+        }
+    }
+
+    for (uint32_t n_pass = 0,
+                  n_layer_pass = 0;
+                  n_pass < n_passes;
+                ++n_pass,
+                ++n_layer_pass)
+    {
+        uint32_t elements_offset = 0;
+        uint32_t max_index       = 0;
+        uint32_t min_index       = 0;
+
+        if (n_pass > 0                                         &&
+            passes[n_pass - 1].n_layer != passes[n_pass].n_layer)
+        {
+            n_layer_pass = 0;
+        }
+
+        mesh_get_layer_pass_property(test_mesh,
+                                     passes[n_pass].n_layer,
+                                     n_layer_pass,
+                                     MESH_LAYER_PROPERTY_BO_ELEMENTS_OFFSET,
+                                    &elements_offset);
+        mesh_get_layer_pass_property(test_mesh,
+                                     passes[n_pass].n_layer,
+                                     n_layer_pass,
+                                     MESH_LAYER_PROPERTY_BO_ELEMENTS_DATA_MAX_INDEX,
+                                    &max_index);
+        mesh_get_layer_pass_property(test_mesh,
+                                     passes[n_pass].n_layer,
+                                     n_layer_pass,
+                                     MESH_LAYER_PROPERTY_BO_ELEMENTS_DATA_MIN_INDEX,
+                                    &min_index);
+
+        ASSERT_EQ(max_index,
+                  *std::max_element(pass_indices[n_pass].begin(),
+                                    pass_indices[n_pass].end() ));
+        ASSERT_EQ(min_index,
+                  *std::min_element(pass_indices[n_pass].begin(),
+                                    pass_indices[n_pass].end() ));
+
+        for (uint32_t n_element = 0;
+                      n_element < passes[n_pass].n_elements;
+                    ++n_element)
+        {
+            const uint16_t index = static_cast<uint16_t>(pass_indices[n_pass][n_element]);
+
+            memcpy(&expected_data[0] + elements_offset + index_size * n_element,
+                   &index,
+                   index_size);
+        }
+    }
+
+    ASSERT_EQ(memcmp(&expected_data[0],
+                     processed_data,
+                     processed_data_size),
+              0);
+
+    /* Check the layer AABBs, too */
+    for (uint32_t n_layer = 0;
+                  n_layer < n_layers;
+                ++n_layer)
+    {
+        const float* aabb_max = nullptr;
+        const float* aabb_min = nullptr;
+
+        mesh_get_layer_pass_property(test_mesh,
+                                     n_layer,
+                                     0, /* n_pass */
+                                     MESH_LAYER_PROPERTY_MODEL_AABB_MAX,
+                                    &aabb_max);
+        mesh_get_layer_pass_property(test_mesh,
+                                     n_layer,
+                                     0, /* n_pass */
+                                     MESH_LAYER_PROPERTY_MODEL_AABB_MIN,
+                                    &aabb_min);
+
+        for (uint32_t n_dimension = 0;
+                      n_dimension < 3;
+                    ++n_dimension)
+        {
+            const std::vector<float>& vertex_data = streams[0].layer_data[n_layer];
+
+            ASSERT_EQ(aabb_min[n_dimension],
+                      vertex_data[n_dimension]);
+            ASSERT_EQ(aabb_max[n_dimension],
+                      vertex_data[vertex_data.size() - 3 + n_dimension]);
+        }
+    }
+
+    mesh_release         (test_mesh);
+    mesh_material_release(materials[0]);
+    mesh_material_release(materials[1]);
+
+    ASSERT_TRUE(demo_app_destroy_window(system_hashed_ansi_string_create(TEST_WINDOW_NAME) ));
+}
+
+/* Optimization may only reorder triangles within each pass and renumber vertices. Each pass must still
+ * draw the same triangles, built of the same vertex data, and vertices must end up stored in the order
+ * in which they are first used. */
+TEST(MeshTest, OptimizationRetainsTriangles)
+{
+    const ral_context context = create_test_context();
+
+    ASSERT_NE(context,
+              (ral_context) nullptr);
+
+    const single_indexed_test_pass passes[] =
+    {
+        {0, 0, 600},
+        {0, 1, 300},
+        {1, 0, 450}
+    };
+    const uint32_t n_passes = sizeof(passes) / sizeof(passes[0]);
+
+    std::vector<std::vector<float> > pass_triangles[2][n_passes];
+    mesh_material                    materials[2];
+    mesh_optimization_statistics     statistics;
+    single_indexed_test_stream       streams[3];
+    mesh                             test_mesh = nullptr;
+
+    materials[0] = mesh_material_create(system_hashed_ansi_string_create("Test material 1"),
+                                        context,
+                                        nullptr); /* object_manager_path */
+    materials[1] = mesh_material_create(system_hashed_ansi_string_create("Test material 2"),
+                                        context,
+                                        nullptr); /* object_manager_path */
+
+    test_mesh = create_single_indexed_test_mesh(materials,
+                                                passes,
+                                                n_passes,
+                                                20, /* n_vertices */
+                                                streams);
+
+    mesh_create_single_indexed_representation(test_mesh);
+
+    for (uint32_t n_iteration = 0;
+                  n_iteration < 2;
+                ++n_iteration)
+    {
+        uint32_t          n_next_vertex  = 0;
+        const void*       processed_data = nullptr;
+        uint32_t          stride         = 0;
+
+        if (n_iteration == 1)
+        {
+            mesh_optimize(test_mesh,
+                          MESH_OPTIMIZATION_FLAGS_ALL,
+                         &statistics);
+        }
+
+        mesh_get_property(test_mesh,
+                          MESH_PROPERTY_BO_PROCESSED_DATA,
+                         &processed_data);
+        mesh_get_property(test_mesh,
+                          MESH_PROPERTY_BO_STRIDE,
+                         &stride);
+
+        for (uint32_t n_pass = 0,
+                      n_layer_pass = 0;
+                      n_pass < n_passes;
+                    ++n_pass,
+                    ++n_layer_pass)
+        {
+            uint32_t        elements_offset = 0;
+            const uint16_t* index_data      = nullptr;
+            uint32_t        max_index       = 0;
+            uint32_t        min_index       = 0;
+
+            if (n_pass > 0                                         &&
+                passes[n_pass - 1].n_layer != passes[n_pass].n_layer)
+            {
+                n_layer_pass = 0;
+            }
+
+            mesh_get_layer_pass_property(test_mesh,
+                                         passes[n_pass].n_layer,
+                                         n_layer_pass,
+                                         MESH_LAYER_PROPERTY_BO_ELEMENTS_OFFSET,
+                                        &elements_offset);
+            mesh_get_layer_pass_property(test_mesh,
+                                         passes[n_pass].n_layer,
+                                         n_layer_pass,
+                                         MESH_LAYER_PROPERTY_BO_ELEMENTS_DATA_MAX_INDEX,
+                                        &max_index);
+            mesh_get_layer_pass_property(test_mesh,
+                                         passes[n_pass].n_layer,
+                                         n_layer_pass,
+                                         MESH_LAYER_PROPERTY_BO_ELEMENTS_DATA_MIN_INDEX,
+                                        &min_index);
+
+            index_data = reinterpret_cast<const uint16_t*>(reinterpret_cast<const char*>(processed_data) + elements_offset);
+
+            ASSERT_EQ(max_index,
+                      *std::max_element(index_data,
+                                        index_data + passes[n_pass].n_elements) );
+            ASSERT_EQ(min_index,
+                      *std::min_element(index_data,
+                                        index_data + passes[n_pass].n_elements) );
+
+            for (uint32_t n_element = 0;
+                          n_element < passes[n_pass].n_elements;
+                          n_element += 3)
+            {
+                std::vector<float> triangle;
+
+                for (uint32_t n_vertex = 0;
+                              n_vertex < 3;
+                            ++n_vertex)
+                {
+                    const uint32_t index      = index_data[n_element + n_vertex];
+                    const float*   vertex_ptr = reinterpret_cast<const float*>(reinterpret_cast<const char*>(processed_data) + stride * index);
+
+                    /* Vertices are stored in the order of first use */
+                    ASSERT_LE(index,
+                              n_next_vertex);
+
+                    if (index == n_next_vertex)
+                    {
+                        ++n_next_vertex;
+                    }
+
+                    triangle.insert(triangle.end(),
+                                    vertex_ptr,
+                                    vertex_ptr + stride / sizeof(float) );
+                }
+
+                pass_triangles[n_iteration][n_pass].push_back(triangle);
+            }
+
+            std::sort(pass_triangles[n_iteration][n_pass].begin(),
+                      pass_triangles[n_iteration][n_pass].end() );
+        }
+    }
+
+    for (uint32_t n_pass = 0;
+                  n_pass < n_passes;
+                ++n_pass)
+    {
+        ASSERT_TRUE(pass_triangles[0][n_pass] == pass_triangles[1][n_pass]);
+    }
+
+    ASSERT_LE(statistics.acmr_after,
+              statistics.acmr_before);
+    ASSERT_GE(statistics.atvr_after,
+              1.0f);
+
+    mesh_release         (test_mesh);
+    mesh_material_release(materials[0]);
+    mesh_material_release(materials[1]);
+
+    ASSERT_TRUE(demo_app_destroy_window(system_hashed_ansi_string_create(TEST_WINDOW_NAME) ));
+}
+
+TEST(MeshTest, LodsSurviveSaveLoadRoundTrip)
+{
+    const ral_context context = create_test_context();
+
+    ASSERT_NE(context,
+              (ral_context) nullptr);
+
+    const float    target_ratios[] = {0.5f, 0.25f, 0.1f};
+    const uint32_t n_levels        = sizeof(target_ratios) / sizeof(target_ratios[0]);
+
+    std::vector<uint32_t>      index_data;
+    std::vector<uint32_t>      lod_properties[n_levels + 1];
+    const float*               lod_errors          = nullptr;
+    std::vector<float>         lod_errors_copy;
+    mesh_layer_pass_id         layer_pass_id;
+    mesh_layer_id              layer_id;
+    mesh_material              material            = mesh_material_create(system_hashed_ansi_string_create("Test material"),
+                                                                          context,
+                                                                          nullptr); /* object_manager_path */
+    uint32_t                   n_lods              = 0;
+    const void*                processed_data      = nullptr;
+    std::vector<unsigned char> processed_data_copy;
+    uint32_t                   processed_data_size = 0;
+    mesh                       test_mesh           = mesh_create_regular_mesh(0, /* flags */
+                                                                              system_hashed_ansi_string_create("Test mesh") );
+    std::vector<float>         vertex_data;
+
+    /* Use a dome, so that the levels of detail have non-zero errors */
+    for (uint32_t y = 0;
+                  y <= LOD_GRID_SIZE;
+                ++y)
+    {
+        for (uint32_t x = 0;
+                      x <= LOD_GRID_SIZE;
+                    ++x)
+        {
+            const float fx = float(x) / float(LOD_GRID_SIZE);
+            const float fy = float(y) / float(LOD_GRID_SIZE);
+
+            vertex_data.push_back(fx);
+            vertex_data.push_back(fy);
+            vertex_data.push_back(0.25f * sinf(3.14159265f * fx) * sinf(3.14159265f * fy) );
+        }
+    }
+
+    for (uint32_t y = 0;
+                  y < LOD_GRID_SIZE;
+                ++y)
+    {
+        for (uint32_t x = 0;
+                      x < LOD_GRID_SIZE;
+                    ++x)
+        {
+            const uint32_t v0          = y * (LOD_GRID_SIZE + 1) + x;
+            const uint32_t triangles[] =
+            {
+                v0,     v0 + 1,                 v0 + LOD_GRID_SIZE + 1,
+                v0 + 1, v0 + LOD_GRID_SIZE + 2, v0 + LOD_GRID_SIZE + 1
+            };
+
+            index_data.insert(index_data.end(),
+                              triangles,
+                              triangles + sizeof(triangles) / sizeof(triangles[0]) );
+        }
+    }
+
+    layer_id      = mesh_add_layer                      (test_mesh);
+    layer_pass_id = mesh_add_layer_pass_for_regular_mesh(test_mesh,
+                                                         layer_id,
+                                                         material,
+                                                         static_cast<uint32_t>(index_data.size() ));
+
+    mesh_add_layer_data_stream_from_client_memory  (test_mesh,
+                                                    layer_id,
+                                                    MESH_LAYER_DATA_STREAM_TYPE_VERTICES,
+                                                    3, /* n_components */
+                                                    static_cast<uint32_t>(vertex_data.size() / 3),
+                                                   &vertex_data[0]);
+    mesh_add_layer_pass_index_data_for_regular_mesh(test_mesh,
+                                                    layer_id,
+                                                    layer_pass_id,
+                                                    MESH_LAYER_DATA_STREAM_TYPE_VERTICES,
+                                                    0, /* set_id */
+                                                   &index_data[0],
+                                                    0, /* min_index */
+                                                    static_cast<uint32_t>(vertex_data.size() / 3 - 1) );
+
+    mesh_create_single_indexed_representation(test_mesh);
+    mesh_optimize                            (test_mesh,
+                                              MESH_OPTIMIZATION_FLAGS_ALL);
+
+    ASSERT_TRUE(mesh_generate_lods(test_mesh,
+                                   n_levels,
+                                   target_ratios) );
+
+    mesh_get_property(test_mesh,
+                      MESH_PROPERTY_N_LODS,
+                     &n_lods);
+    mesh_get_property(test_mesh,
+                      MESH_PROPERTY_LOD_ERRORS,
+                     &lod_errors);
+
+    ASSERT_EQ(n_lods,
+              n_levels + 1);
+    ASSERT_EQ(lod_errors[0],
+              0.0f);
+
+    /* Store the reference data. Each level is described by its elements offset, number of elements, min and
+     * max index. */
+    for (uint32_t n_lod = 0;
+                  n_lod < n_lods;
+                ++n_lod)
+    {
+        const mesh_layer_property properties[] =
+        {
+            MESH_LAYER_PROPERTY_BO_ELEMENTS_OFFSET,
+            MESH_LAYER_PROPERTY_N_ELEMENTS,
+            MESH_LAYER_PROPERTY_BO_ELEMENTS_DATA_MIN_INDEX,
+            MESH_LAYER_PROPERTY_BO_ELEMENTS_DATA_MAX_INDEX
+        };
+        uint32_t                  n_triangles = 0;
+
+        for (uint32_t n_property = 0;
+                      n_property < sizeof(properties) / sizeof(properties[0]);
+                    ++n_property)
+        {
+            uint32_t value = 0;
+
+            ASSERT_TRUE(mesh_get_layer_pass_lod_property(test_mesh,
+                                                         0, /* n_layer */
+                                                         0, /* n_pass  */
+                                                         n_lod,
+                                                         properties[n_property],
+                                                        &value) );
+
+            lod_properties[n_lod].push_back(value);
+        }
+
+        mesh_get_layer_pass_lod_property(test_mesh,
+                                         0, /* n_layer */
+                                         0, /* n_pass  */
+                                         n_lod,
+                                         MESH_LAYER_PROPERTY_N_TRIANGLES,
+                                        &n_triangles);
+
+        ASSERT_EQ(n_triangles * 3,
+                  lod_properties[n_lod][1]);
+
+        if (n_lod > 0)
+        {
+            /* Each level meets its triangle budget and is at most as accurate as the previous one */
+            ASSERT_GT(n_triangles,
+                      0);
+            ASSERT_LE(n_triangles,
+                      static_cast<uint32_t>(index_data.size() / 3 * target_ratios[n_lod - 1]) );
+            ASSERT_GT(lod_errors[n_lod],
+                      0.0f);
+            ASSERT_GE(lod_errors[n_lod],
+                      lod_errors[n_lod - 1]);
+        }
+    }
+
+    /* Finer levels are picked as the mesh covers more of the screen */
+    ASSERT_EQ(mesh_select_lod(test_mesh,
+                              0.0f,  /* model_to_screen_scale  */
+                              1.0f), /* max_screen_space_error */
+              n_lods - 1);
+    ASSERT_EQ(mesh_select_lod(test_mesh,
+                              1e9f,  /* model_to_screen_scale  */
+                              1.0f), /* max_screen_space_error */
+              0);
+    ASSERT_EQ(mesh_select_lod(test_mesh,
+                              1.0f / lod_errors[1], /* model_to_screen_scale  */
+                              1.0f),                /* max_screen_space_error */
+              1);
+
+    save_test_mesh(test_mesh,
+                   &material,
+                   1, /* n_materials */
+                   LOD_MESH_FILE_NAME);
+
+    mesh_get_property(test_mesh,
+                      MESH_PROPERTY_BO_PROCESSED_DATA,
+                     &processed_data);
+    mesh_get_property(test_mesh,
+                      MESH_PROPERTY_BO_PROCESSED_DATA_SIZE,
+                     &processed_data_size);
+
+    lod_errors_copy.assign    (lod_errors,
+                               lod_errors + n_lods);
+    processed_data_copy.assign(reinterpret_cast<const unsigned char*>(processed_data),
+                               reinterpret_cast<const unsigned char*>(processed_data) + processed_data_size);
+
+    mesh_release(test_mesh);
+
+    /* Load the mesh back. Levels of detail share the processed data with the original mesh, so it must
+     * come back unchanged. */
+    {
+        const float*         loaded_lod_errors = nullptr;
+        const unsigned char* loaded_data       = nullptr;
+        uint32_t             loaded_data_size  = 0;
+        mesh                 loaded_mesh       = load_test_mesh(context,
+                                                                &material,
+                                                                1, /* n_materials */
+                                                                LOD_MESH_FILE_NAME,
+                                                                false); /* is_mapped */
+        uint32_t             loaded_n_lods     = 0;
+
+        ASSERT_NE(loaded_mesh,
+                  (mesh) nullptr);
+
+        mesh_get_property(loaded_mesh,
+                          MESH_PROPERTY_BO_PROCESSED_DATA,
+                         &loaded_data);
+        mesh_get_property(loaded_mesh,
+                          MESH_PROPERTY_BO_PROCESSED_DATA_SIZE,
+                         &loaded_data_size);
+        mesh_get_property(loaded_mesh,
+                          MESH_PROPERTY_LOD_ERRORS,
+                         &loaded_lod_errors);
+        mesh_get_property(loaded_mesh,
+                          MESH_PROPERTY_N_LODS,
+                         &loaded_n_lods);
+
+        ASSERT_EQ(loaded_data_size,
+                  processed_data_size);
+        ASSERT_EQ(memcmp(loaded_data,
+                         &processed_data_copy[0],
+                         processed_data_size),
+                  0);
+        ASSERT_EQ(loaded_n_lods,
+                  n_lods);
+
+        for (uint32_t n_lod = 0;
+                      n_lod < n_lods;
+                    ++n_lod)
+        {
+            const mesh_layer_property properties[] =
+            {
+                MESH_LAYER_PROPERTY_BO_ELEMENTS_OFFSET,
+                MESH_LAYER_PROPERTY_N_ELEMENTS,
+                MESH_LAYER_PROPERTY_BO_ELEMENTS_DATA_MIN_INDEX,
+                MESH_LAYER_PROPERTY_BO_ELEMENTS_DATA_MAX_INDEX
+            };
+
+            ASSERT_EQ(loaded_lod_errors[n_lod],
+                      lod_errors_copy  [n_lod]);
+
+            for (uint32_t n_property = 0;
+                          n_property < sizeof(properties) / sizeof(properties[0]);
+                        ++n_property)
+            {
+                uint32_t value = 0;
+
+                mesh_get_layer_pass_lod_property(loaded_mesh,
+                                                 0, /* n_layer */
+                                                 0, /* n_pass  */
+                                                 n_lod,
+                                                 properties[n_property],
+                                                &value);
+
+                ASSERT_EQ(value,
+                          lod_properties[n_lod][n_property]);
+            }
+        }
+
+        mesh_release(loaded_mesh);
+    }
+
+    mesh_material_release(material);
+
+    ASSERT_TRUE(demo_app_destroy_window(system_hashed_ansi_string_create(TEST_WINDOW_NAME) ));
+}
+
+TEST(MeshTest, DISABLED_SingleIndexedRepresentationBenchmark)
+{
+    const ral_context context = create_test_context();
+
+    ASSERT_NE(context,
+              (ral_context) nullptr);
+
+    mesh_material                  materials[2];
+    const single_indexed_test_pass passes[] =
+    {
+        {0, 0, SINGLE_INDEXED_BENCHMARK_N_ELEMENTS / 2},
+        {0, 1, SINGLE_INDEXED_BENCHMARK_N_ELEMENTS / 4},
+        {1, 0, SINGLE_INDEXED_BENCHMARK_N_ELEMENTS / 4}
+    };
+    uint32_t                       n_unique_vertices = 0;
+    single_indexed_test_stream     streams[3];
+    mesh                           test_mesh         = nullptr;
+    __uint64                       time_start        = 0;
+    __uint64                       time_total        = 0;
+
+    materials[0] = mesh_material_create(system_hashed_ansi_string_create("Test material 1"),
+                                        context,
+                                        nullptr); /* object_manager_path */
+    materials[1] = mesh_material_create(system_hashed_ansi_string_create("Test material 2"),
+                                        context,
+                                        nullptr); /* object_manager_path */
+
+    test_mesh = create_single_indexed_test_mesh(materials,
+                                                passes,
+                                                sizeof(passes) / sizeof(passes[0]),
+                                                SINGLE_INDEXED_BENCHMARK_N_ELEMENTS / 6,
+                                                streams);
+
+    time_start = system_time_now_usec();
+    {
+        mesh_create_single_indexed_representation(test_mesh);
+    }
+    time_total = system_time_now_usec() - time_start;
+
+    mesh_get_property(test_mesh,
+                      MESH_PROPERTY_N_BO_UNIQUE_VERTICES,
+                     &n_unique_vertices);
+
+    LOG_INFO("[%u elements, %u unique vertices] msec: %10.2f",
+             SINGLE_INDEXED_BENCHMARK_N_ELEMENTS,
+             n_unique_vertices,
+             double(time_total) / 1000.0);
+
+    mesh_release         (test_mesh);
+    mesh_material_release(materials[0]);
+    mesh_material_release(materials[1]);
+
+    ASSERT_TRUE(demo_app_destroy_window(system_hashed_ansi_string_create(TEST_WINDOW_NAME) ));
+}
+
+TEST(MeshTest, DISABLED_EncodedMeshLoadBenchmark)
+{
+    const ral_context context = create_test_context();
+
+    ASSERT_NE(context,
+              (ral_context) nullptr);
+
+    const char*                    file_names[]   =
+    {
+        RAW_MESH_FILE_NAME,
+        ENCODED_MESH_FILE_NAME
+    };
+    const mesh_index_encoding      index_encoding = MESH_INDEX_ENCODING_DELTA_VARINT;
+    mesh_material                  materials[2];
+    const single_indexed_test_pass passes[]       =
+    {
+        {0, 0, SINGLE_INDEXED_BENCHMARK_N_ELEMENTS / 2},
+        {0, 1, SINGLE_INDEXED_BENCHMARK_N_ELEMENTS / 4},
+        {1, 0, SINGLE_INDEXED_BENCHMARK_N_ELEMENTS / 4}
+    };
+    uint32_t                       processed_data_size = 0;
+    single_indexed_test_stream     streams[3];
+    mesh                           test_mesh           = nullptr;
+
+    materials[0] = mesh_material_create(system_hashed_ansi_string_create("Test material 1"),
+                                        context,
+                                        nullptr); /* object_manager_path */
+    materials[1] = mesh_material_create(system_hashed_ansi_string_create("Test material 2"),
+                                        context,
+                                        nullptr); /* object_manager_path */
+
+    test_mesh = create_single_indexed_test_mesh(materials,
+                                                passes,
+                                                sizeof(passes) / sizeof(passes[0]),
+                                                SINGLE_INDEXED_BENCHMARK_N_ELEMENTS / 6,
+                                                streams);
+
+    mesh_create_single_indexed_representation(test_mesh);
+    mesh_optimize                            (test_mesh,
+                                              MESH_OPTIMIZATION_FLAGS_ALL);
+    mesh_get_property                        (test_mesh,
+                                              MESH_PROPERTY_BO_PROCESSED_DATA_SIZE,
+                                             &processed_data_size);
+
+    save_test_mesh(test_mesh,
+                   materials,
+                   2, /* n_materials */
+                   RAW_MESH_FILE_NAME);
+
+    mesh_set_processed_data_stream_encoding(test_mesh,
+                                            MESH_LAYER_DATA_STREAM_TYPE_NORMALS,
+                                            MESH_LAYER_DATA_STREAM_ENCODING_OCTAHEDRAL_SNORM16);
+    mesh_set_processed_data_stream_encoding(test_mesh,
+                                            MESH_LAYER_DATA_STREAM_TYPE_TEXCOORDS,
+                                            MESH_LAYER_DATA_STREAM_ENCODING_SNORM16_BOUNDS);
+    mesh_set_processed_data_stream_encoding(test_mesh,
+                                            MESH_LAYER_DATA_STREAM_TYPE_VERTICES,
+                                            MESH_LAYER_DATA_STREAM_ENCODING_SNORM16_BOUNDS);
+    mesh_set_property                      (test_mesh,
+                                            MESH_PROPERTY_BO_INDEX_ENCODING,
+                                           &index_encoding);
+
+    save_test_mesh(test_mesh,
+                   materials,
+                   2, /* n_materials */
+                   ENCODED_MESH_FILE_NAME);
+
+    mesh_release(test_mesh);
+
+    for (uint32_t n_file = 0;
+                  n_file < sizeof(file_names) / sizeof(file_names[0]);
+                ++n_file)
+    {
+        uint32_t               file_size   = 0;
+        mesh                   loaded_mesh = nullptr;
+        system_file_serializer serializer  = system_file_serializer_create_for_reading(system_hashed_ansi_string_create(file_names[n_file]) );
+        __uint64               time_start  = 0;
+        __uint64               time_total  = 0;
+
+        system_file_serializer_get_property(serializer,
+                                            SYSTEM_FILE_SERIALIZER_PROPERTY_SIZE,
+                                           &file_size);
+        system_file_serializer_release     (serializer);
+
+        time_start = system_time_now_usec();
+        {
+            loaded_mesh = load_test_mesh(context,
+                                         materials,
+                                         2, /* n_materials */
+                                         file_names[n_file],
+                                         true); /* is_mapped */
+        }
+        time_total = system_time_now_usec() - time_start;
+
+        LOG_INFO("[%s] file size: %u bytes, processed data size: %u bytes, load msec: %10.2f, MB/s: %10.2f",
+                 file_names[n_file],
+                 file_size,
+                 processed_data_size,
+                 double(time_total) / 1000.0,
+                 double(processed_data_size) / double(time_total + 1) );
+
+        mesh_release(loaded_mesh);
+    }
+
+    mesh_material_release(materials[0]);
+    mesh_material_release(materials[1]);
+
+    ASSERT_TRUE(demo_app_destroy_window(system_hashed_ansi_string_create(TEST_WINDOW_NAME) ));
+}
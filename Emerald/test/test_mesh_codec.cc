@@ -0,0 +1,335 @@
+/**
+ *
+ * Emerald (kbi/elude @2016)
+ *
+ */
+#include "test_mesh_codec.h"
+#include "gtest/gtest.h"
+#include "shared.h"
+#include "mesh/mesh_codec.h"
+#include <math.h>
+#include <vector>
+
+#define OCTAHEDRAL_MAX_ERROR (1e-4f)
+#define TEST_N_ITEMS         (4096)
+
+
+/** Returns a pseudo-random float from <min_value, max_value>. */
+PRIVATE float get_random_float(uint32_t* seed_ptr,
+                               float     min_value,
+                               float     max_value)
+{
+    *seed_ptr = *seed_ptr * 1664525 + 1013904223;
+
+    return min_value + (max_value - min_value) * float(*seed_ptr >> 8) / float(0xFFFFFF);
+}
+
+/** Encodes @param data with @param encoding and decodes it back into @param out_data. Verifies that the
+ *  decoder consumes exactly as many bytes as the encoder produced.
+ */
+PRIVATE void round_trip_stream(mesh_layer_data_stream_encoding encoding,
+                               const std::vector<float>&       data,
+                               uint32_t                        n_components,
+                               std::vector<float>*             out_data)
+{
+    const uint32_t             n_items      = static_cast<uint32_t>(data.size() / n_components);
+    const uint32_t             encoded_size = mesh_codec_encode_stream(encoding,
+                                                                       &data[0],
+                                                                       n_components,
+                                                                       n_items,
+                                                                       sizeof(float) * n_components,
+                                                                       nullptr); /* out_data */
+    std::vector<unsigned char> encoded_data(encoded_size);
+
+    ASSERT_EQ(mesh_codec_encode_stream(encoding,
+                                       &data[0],
+                                       n_components,
+                                       n_items,
+                                       sizeof(float) * n_components,
+                                       &encoded_data[0]),
+              encoded_size);
+
+    out_data->resize(data.size() );
+
+    ASSERT_EQ(mesh_codec_decode_stream(encoding,
+                                       &encoded_data[0],
+                                       encoded_size,
+                                       n_components,
+                                       n_items,
+                                       sizeof(float) * n_components,
+                                       &(*out_data)[0]),
+              encoded_size);
+}
+
+
+TEST(MeshCodecTest, HalfFloatRoundTripStaysWithinBounds)
+{
+    std::vector<float> data;
+    std::vector<float> decoded_data;
+    uint32_t           seed = 1;
+
+    for (uint32_t n_item = 0;
+                  n_item < TEST_N_ITEMS;
+                ++n_item)
+    {
+        data.push_back(get_random_float(&seed, -1.0f,     1.0f) );
+        data.push_back(get_random_float(&seed, -65000.0f, 65000.0f) );
+    }
+
+    /* Values which can be represented exactly */
+    data.push_back(0.0f);
+    data.push_back(65504.0f);
+
+    round_trip_stream(MESH_LAYER_DATA_STREAM_ENCODING_HALF_FLOAT,
+                      data,
+                      2, /* n_components */
+                     &decoded_data);
+
+    for (uint32_t n_value = 0;
+                  n_value < data.size();
+                ++n_value)
+    {
+        /* Normalized half-floats carry 11 significant bits. Denormals are spaced 2^-24 apart. */
+        const float max_error = (fabsf(data[n_value]) >= 6.103515625e-5f) ? fabsf(data[n_value]) / 2048.0f
+                                                                           : 2.98023224e-8f;
+
+        ASSERT_LE(fabsf(decoded_data[n_value] - data[n_value]),
+                  max_error);
+    }
+
+    ASSERT_EQ(decoded_data[data.size() - 2], 0.0f);
+    ASSERT_EQ(decoded_data[data.size() - 1], 65504.0f);
+}
+
+TEST(MeshCodecTest, Snorm16BoundsRoundTripStaysWithinBounds)
+{
+    const float        bounds_max[] = {120.0f, 1.0f, 0.0f};
+    const float        bounds_min[] = {-50.0f, 0.0f, 0.0f};
+    std::vector<float> data;
+    std::vector<float> decoded_data;
+    uint32_t           seed         = 1;
+
+    for (uint32_t n_item = 0;
+                  n_item < TEST_N_ITEMS;
+                ++n_item)
+    {
+        for (uint32_t n_component = 0;
+                      n_component < 3;
+                    ++n_component)
+        {
+            data.push_back(get_random_float(&seed,
+                                            bounds_min[n_component],
+                                            bounds_max[n_component]) );
+        }
+    }
+
+    round_trip_stream(MESH_LAYER_DATA_STREAM_ENCODING_SNORM16_BOUNDS,
+                      data,
+                      3, /* n_components */
+                     &decoded_data);
+
+    for (uint32_t n_value = 0;
+                  n_value < data.size();
+                ++n_value)
+    {
+        /* Quantization error is at most half a step, plus float rounding. */
+        const float half_extent = 0.5f * (bounds_max[n_value % 3] - bounds_min[n_value % 3]);
+
+        ASSERT_LE(fabsf(decoded_data[n_value] - data[n_value]),
+                  half_extent / 32767.0f * 0.5f + 1e-5f);
+    }
+}
+
+TEST(MeshCodecTest, OctahedralRoundTripStaysWithinAngularBound)
+{
+    std::vector<float> data;
+    std::vector<float> decoded_data;
+    uint32_t           seed = 1;
+
+    for (uint32_t n_item = 0;
+                  n_item < TEST_N_ITEMS;
+                ++n_item)
+    {
+        float length;
+        float vector[3];
+
+        do
+        {
+            vector[0] = get_random_float(&seed, -1.0f, 1.0f);
+            vector[1] = get_random_float(&seed, -1.0f, 1.0f);
+            vector[2] = get_random_float(&seed, -1.0f, 1.0f);
+            length    = sqrtf(vector[0] * vector[0] + vector[1] * vector[1] + vector[2] * vector[2]);
+        }
+        while (length < 0.1f || length > 1.0f);
+
+        data.push_back(vector[0] / length);
+        data.push_back(vector[1] / length);
+        data.push_back(vector[2] / length);
+    }
+
+    /* Axes and the octahedron's edges are the corner cases of the mapping */
+    const float corner_cases[] =
+    {
+         1.0f,  0.0f,  0.0f,
+         0.0f, -1.0f,  0.0f,
+         0.0f,  0.0f, -1.0f,
+         0.0f,  0.0f,  1.0f,
+        -0.70710678f, 0.0f, -0.70710678f
+    };
+
+    data.insert(data.end(),
+                corner_cases,
+                corner_cases + sizeof(corner_cases) / sizeof(corner_cases[0]) );
+
+    round_trip_stream(MESH_LAYER_DATA_STREAM_ENCODING_OCTAHEDRAL_SNORM16,
+                      data,
+                      3, /* n_components */
+                     &decoded_data);
+
+    for (uint32_t n_value = 0;
+                  n_value < data.size();
+                  n_value += 3)
+    {
+        const float* decoded_vector = &decoded_data[n_value];
+        const float* vector         = &data        [n_value];
+        const float  delta[]        =
+        {
+            decoded_vector[0] - vector[0],
+            decoded_vector[1] - vector[1],
+            decoded_vector[2] - vector[2]
+        };
+
+        /* For unit vectors, the distance between both approximates the angle between them. 16-bit
+         * octahedral vectors are accurate to within a few thousandths of a degree. */
+        ASSERT_LE(sqrtf(delta[0] * delta[0] + delta[1] * delta[1] + delta[2] * delta[2]),
+                  OCTAHEDRAL_MAX_ERROR);
+        ASSERT_NEAR(decoded_vector[0] * decoded_vector[0] + decoded_vector[1] * decoded_vector[1] + decoded_vector[2] * decoded_vector[2],
+                    1.0f,
+                    1e-5f);
+    }
+}
+
+TEST(MeshCodecTest, DeltaVarintIndicesRoundTripLosslessly)
+{
+    const uint32_t index_sizes[] = {sizeof(unsigned char), sizeof(unsigned short), sizeof(unsigned int)};
+
+    for (uint32_t n_index_size = 0;
+                  n_index_size < sizeof(index_sizes) / sizeof(index_sizes[0]);
+                ++n_index_size)
+    {
+        const uint32_t             index_size   = index_sizes[n_index_size];
+        const uint32_t             max_index    = (index_size == sizeof(unsigned int) ) ? 0xFFFFFFFF
+                                                                                        : ( (1u << (index_size * 8)) - 1);
+        std::vector<unsigned char> decoded_data(TEST_N_ITEMS * index_size);
+        std::vector<unsigned char> encoded_data;
+        uint32_t                   encoded_size = 0;
+        std::vector<unsigned char> index_data  (TEST_N_ITEMS * index_size);
+        uint32_t                   seed         = 1;
+
+        /* Mostly local indices, as produced by mesh_optimize(), mixed with occasional far jumps
+         * and the extreme values. */
+        for (uint32_t n_index = 0;
+                      n_index < TEST_N_ITEMS;
+                    ++n_index)
+        {
+            uint32_t index = n_index / 2 + (n_index % 3);
+
+            if (n_index % 97 == 0)
+            {
+                seed  = seed * 1664525 + 1013904223;
+                index = seed;
+            }
+            else
+            if (n_index % 101 == 0)
+            {
+                index = max_index;
+            }
+
+            index &= max_index;
+
+            memcpy(&index_data[n_index * index_size],
+                   &index,
+                   index_size);
+        }
+
+        encoded_size = mesh_codec_encode_indices(MESH_INDEX_ENCODING_DELTA_VARINT,
+                                                 &index_data[0],
+                                                 index_size,
+                                                 TEST_N_ITEMS,
+                                                 nullptr); /* out_data */
+
+        encoded_data.resize(encoded_size);
+
+        ASSERT_EQ(mesh_codec_encode_indices(MESH_INDEX_ENCODING_DELTA_VARINT,
+                                            &index_data[0],
+                                            index_size,
+                                            TEST_N_ITEMS,
+                                            &encoded_data[0]),
+                  encoded_size);
+        ASSERT_EQ(mesh_codec_decode_indices(MESH_INDEX_ENCODING_DELTA_VARINT,
+                                            &encoded_data[0],
+                                            encoded_size,
+                                            TEST_N_ITEMS,
+                                            index_size,
+                                            &decoded_data[0]),
+                  encoded_size);
+
+        ASSERT_TRUE(decoded_data == index_data);
+
+        if (index_size > sizeof(unsigned char) )
+        {
+            ASSERT_LT(encoded_size,
+                      TEST_N_ITEMS * index_size);
+        }
+    }
+}
+
+TEST(MeshCodecTest, CorruptDataIsRejected)
+{
+    const unsigned char unterminated_varint[] = {0x80, 0x80};
+    const unsigned char too_long_varint[]     = {0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0x01};
+    float               decoded_data[8];
+    uint32_t            decoded_indices[2];
+    const float         data[]                = {1.0f, 2.0f, 3.0f, 4.0f};
+    unsigned char       encoded_data[64];
+    uint32_t            encoded_size          = 0;
+
+    ASSERT_EQ(mesh_codec_decode_indices(MESH_INDEX_ENCODING_DELTA_VARINT,
+                                        unterminated_varint,
+                                        sizeof(unterminated_varint),
+                                        1, /* n_indices */
+                                        sizeof(uint32_t),
+                                        decoded_indices),
+              0);
+    ASSERT_EQ(mesh_codec_decode_indices(MESH_INDEX_ENCODING_DELTA_VARINT,
+                                        too_long_varint,
+                                        sizeof(too_long_varint),
+                                        1, /* n_indices */
+                                        sizeof(uint32_t),
+                                        decoded_indices),
+              0);
+
+    /* Truncated streams must not be read past their end */
+    for (uint32_t n_encoding = 0;
+                  n_encoding < MESH_LAYER_DATA_STREAM_ENCODING_COUNT;
+                ++n_encoding)
+    {
+        const uint32_t n_components = (n_encoding == MESH_LAYER_DATA_STREAM_ENCODING_OCTAHEDRAL_SNORM16) ? 3 : 2;
+
+        encoded_size = mesh_codec_encode_stream( (mesh_layer_data_stream_encoding) n_encoding,
+                                                data,
+                                                n_components,
+                                                1, /* n_items */
+                                                sizeof(data),
+                                                encoded_data);
+
+        ASSERT_EQ(mesh_codec_decode_stream( (mesh_layer_data_stream_encoding) n_encoding,
+                                           encoded_data,
+                                           encoded_size - 1,
+                                           n_components,
+                                           1, /* n_items */
+                                           sizeof(decoded_data),
+                                           decoded_data),
+                  0);
+    }
+}
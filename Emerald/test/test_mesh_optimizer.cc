@@ -0,0 +1,338 @@
+/**
+ *
+ * Emerald (kbi/elude @2016)
+ *
+ */
+#include "test_mesh_optimizer.h"
+#include "gtest/gtest.h"
+#include "shared.h"
+#include "mesh/mesh_optimizer.h"
+#include "system/system_log.h"
+#include "system/system_time.h"
+#include <algorithm>
+#include <math.h>
+#include <vector>
+
+#define BENCHMARK_GRID_SIZE (708) /* 2 * 708 * 708 = ~1M triangles */
+#define TEST_GRID_SIZE      (64)
+
+
+/** Describes a triangle list, as used by the tests below. */
+typedef struct
+{
+    std::vector<uint32_t> index_data;
+    std::vector<float>    vertex_data;
+} test_triangle_list;
+
+/** Creates a (grid_size x grid_size) grid of quads, each split into two triangles. The grid is bent into
+ *  a half-cylinder, so that triangles face different directions.
+ *
+ *  @param grid_size   Number of quads along each edge.
+ *  @param shuffle     true to store the triangles in pseudo-random order.
+ *  @param out_list    Deref will be filled with the grid's data.
+ */
+PRIVATE void create_grid(uint32_t            grid_size,
+                         bool                shuffle,
+                         test_triangle_list* out_list)
+{
+    uint32_t seed = 1;
+
+    out_list->index_data.clear ();
+    out_list->vertex_data.clear();
+
+    for (uint32_t y = 0;
+                  y <= grid_size;
+                ++y)
+    {
+        for (uint32_t x = 0;
+                      x <= grid_size;
+                    ++x)
+        {
+            const float angle = 3.14159265f * float(x) / float(grid_size);
+
+            out_list->vertex_data.push_back(cosf(angle) );
+            out_list->vertex_data.push_back(float(y) / float(grid_size) );
+            out_list->vertex_data.push_back(sinf(angle) );
+        }
+    }
+
+    for (uint32_t y = 0;
+                  y < grid_size;
+                ++y)
+    {
+        for (uint32_t x = 0;
+                      x < grid_size;
+                    ++x)
+        {
+            const uint32_t v0 = y * (grid_size + 1) + x;
+            const uint32_t v1 = v0 + 1;
+            const uint32_t v2 = v0 + grid_size + 1;
+            const uint32_t v3 = v2 + 1;
+            const uint32_t triangles[] =
+            {
+                v0, v1, v2,
+                v1, v3, v2
+            };
+
+            out_list->index_data.insert(out_list->index_data.end(),
+                                        triangles,
+                                        triangles + sizeof(triangles) / sizeof(triangles[0]) );
+        }
+    }
+
+    if (shuffle)
+    {
+        const uint32_t n_triangles = static_cast<uint32_t>(out_list->index_data.size() / 3);
+
+        for (uint32_t n_triangle = n_triangles - 1;
+                      n_triangle > 0;
+                    --n_triangle)
+        {
+            uint32_t n_swapped_triangle;
+
+            seed               = seed * 1664525 + 1013904223;
+            n_swapped_triangle = (seed >> 8) % (n_triangle + 1);
+
+            for (uint32_t n_vertex = 0;
+                          n_vertex < 3;
+                        ++n_vertex)
+            {
+                std::swap(out_list->index_data[3 * n_triangle         + n_vertex],
+                          out_list->index_data[3 * n_swapped_triangle + n_vertex]);
+            }
+        }
+    }
+}
+
+/** Returns ACMR of a triangle list. */
+PRIVATE float get_acmr(const test_triangle_list& list)
+{
+    uint32_t n_transformed_vertices = 0;
+    uint32_t n_used_vertices        = 0;
+
+    mesh_optimizer_get_vertex_cache_statistics(&list.index_data[0],
+                                               static_cast<uint32_t>(list.index_data.size() ),
+                                               static_cast<uint32_t>(list.vertex_data.size() / 3),
+                                              &n_transformed_vertices,
+                                              &n_used_vertices);
+
+    return float(n_transformed_vertices) / float(list.index_data.size() / 3);
+}
+
+/** Returns triangles of a triangle list in a sorted order, so that lists can be compared regardless
+ *  of the triangle order. */
+PRIVATE std::vector<std::vector<uint32_t> > get_sorted_triangles(const std::vector<uint32_t>& index_data)
+{
+    std::vector<std::vector<uint32_t> > result;
+
+    for (uint32_t n_index = 0;
+                  n_index < index_data.size();
+                  n_index += 3)
+    {
+        result.push_back(std::vector<uint32_t>(index_data.begin() + n_index,
+                                               index_data.begin() + n_index + 3) );
+    }
+
+    std::sort(result.begin(),
+              result.end() );
+
+    return result;
+}
+
+
+TEST(MeshOptimizerTest, VertexCacheStatisticsSimulateFIFOCache)
+{
+    /* Two triangles sharing an edge */
+    std::vector<uint32_t> index_data;
+    uint32_t              n_transformed_vertices = 0;
+    uint32_t              n_used_vertices        = 0;
+    const uint32_t        quad_index_data[]      = {0, 1, 2, 2, 1, 3};
+
+    mesh_optimizer_get_vertex_cache_statistics(quad_index_data,
+                                               sizeof(quad_index_data) / sizeof(quad_index_data[0]),
+                                               5, /* n_vertices */
+                                              &n_transformed_vertices,
+                                              &n_used_vertices);
+
+    ASSERT_EQ(n_transformed_vertices, 4);
+    ASSERT_EQ(n_used_vertices,        4);
+
+    /* A vertex which is followed by MESH_OPTIMIZER_FIFO_CACHE_SIZE other vertices must be transformed again */
+    for (uint32_t n_vertex = 0;
+                  n_vertex < MESH_OPTIMIZER_FIFO_CACHE_SIZE + 2;
+                ++n_vertex)
+    {
+        index_data.push_back(n_vertex);
+    }
+
+    index_data.push_back(0);
+
+    while (index_data.size() % 3 != 0)
+    {
+        index_data.push_back(0);
+    }
+
+    mesh_optimizer_get_vertex_cache_statistics(&index_data[0],
+                                               static_cast<uint32_t>(index_data.size() ),
+                                               MESH_OPTIMIZER_FIFO_CACHE_SIZE + 2,
+                                              &n_transformed_vertices,
+                                              &n_used_vertices);
+
+    ASSERT_EQ(n_transformed_vertices, MESH_OPTIMIZER_FIFO_CACHE_SIZE + 3);
+    ASSERT_EQ(n_used_vertices,        MESH_OPTIMIZER_FIFO_CACHE_SIZE + 2);
+}
+
+TEST(MeshOptimizerTest, VertexCacheOptimizationImprovesACMR)
+{
+    float                               acmr_after;
+    float                               acmr_before;
+    test_triangle_list                  list;
+    std::vector<std::vector<uint32_t> > triangles_before;
+
+    create_grid(TEST_GRID_SIZE,
+                true, /* shuffle */
+               &list);
+
+    acmr_before      = get_acmr            (list);
+    triangles_before = get_sorted_triangles(list.index_data);
+
+    mesh_optimizer_optimize_vertex_cache(&list.index_data[0],
+                                         static_cast<uint32_t>(list.index_data.size() ),
+                                         static_cast<uint32_t>(list.vertex_data.size() / 3) );
+
+    acmr_after = get_acmr(list);
+
+    /* Shuffled triangles miss the cache for nearly every vertex. A well-ordered grid needs a bit more
+     * than 0.5 transformed vertices per triangle. */
+    ASSERT_GT(acmr_before, 2.5f);
+    ASSERT_LT(acmr_after,  0.8f);
+
+    ASSERT_TRUE(get_sorted_triangles(list.index_data) == triangles_before);
+}
+
+TEST(MeshOptimizerTest, OptimizationIsDeterministic)
+{
+    test_triangle_list lists[2];
+
+    for (uint32_t n_run = 0;
+                  n_run < 2;
+                ++n_run)
+    {
+        create_grid(TEST_GRID_SIZE,
+                    true, /* shuffle */
+                   &lists[n_run]);
+
+        mesh_optimizer_optimize_vertex_cache(&lists[n_run].index_data[0],
+                                             static_cast<uint32_t>(lists[n_run].index_data.size() ),
+                                             static_cast<uint32_t>(lists[n_run].vertex_data.size() / 3) );
+        mesh_optimizer_optimize_overdraw    (&lists[n_run].index_data[0],
+                                             static_cast<uint32_t>(lists[n_run].index_data.size() ),
+                                             static_cast<uint32_t>(lists[n_run].vertex_data.size() / 3),
+                                             &lists[n_run].vertex_data[0],
+                                             sizeof(float) * 3,
+                                             1.05f);
+    }
+
+    ASSERT_TRUE(lists[0].index_data == lists[1].index_data);
+}
+
+TEST(MeshOptimizerTest, OverdrawOptimizationRetainsCacheEfficiency)
+{
+    float                               acmr_after_cache_optimization;
+    float                               acmr_after_overdraw_optimization;
+    test_triangle_list                  list;
+    std::vector<std::vector<uint32_t> > triangles_before;
+
+    create_grid(TEST_GRID_SIZE,
+                true, /* shuffle */
+               &list);
+
+    triangles_before = get_sorted_triangles(list.index_data);
+
+    mesh_optimizer_optimize_vertex_cache(&list.index_data[0],
+                                         static_cast<uint32_t>(list.index_data.size() ),
+                                         static_cast<uint32_t>(list.vertex_data.size() / 3) );
+
+    acmr_after_cache_optimization = get_acmr(list);
+
+    mesh_optimizer_optimize_overdraw(&list.index_data[0],
+                                     static_cast<uint32_t>(list.index_data.size() ),
+                                     static_cast<uint32_t>(list.vertex_data.size() / 3),
+                                     &list.vertex_data[0],
+                                     sizeof(float) * 3,
+                                     1.05f);
+
+    acmr_after_overdraw_optimization = get_acmr(list);
+
+    ASSERT_LE(acmr_after_overdraw_optimization,
+              acmr_after_cache_optimization * 1.1f);
+
+    ASSERT_TRUE(get_sorted_triangles(list.index_data) == triangles_before);
+}
+
+TEST(MeshOptimizerTest, VertexFetchRemapFollowsFirstUse)
+{
+    const uint32_t index_data[] = {4, 2, 5, 5, 2, 0};
+    const uint32_t n_vertices   = 7;
+    uint32_t       n_used_vertices;
+    uint32_t       remap[n_vertices];
+
+    n_used_vertices = mesh_optimizer_get_vertex_fetch_remap(index_data,
+                                                            sizeof(index_data) / sizeof(index_data[0]),
+                                                            n_vertices,
+                                                            remap);
+
+    ASSERT_EQ(n_used_vertices, 4);
+
+    /* Used vertices first, in the order of first use.. */
+    ASSERT_EQ(remap[4], 0);
+    ASSERT_EQ(remap[2], 1);
+    ASSERT_EQ(remap[5], 2);
+    ASSERT_EQ(remap[0], 3);
+
+    /* ..followed by the unused ones, in their original order. */
+    ASSERT_EQ(remap[1], 4);
+    ASSERT_EQ(remap[3], 5);
+    ASSERT_EQ(remap[6], 6);
+}
+
+TEST(MeshOptimizerTest, DISABLED_OptimizationBenchmark)
+{
+    float              acmr_after;
+    float              acmr_before;
+    test_triangle_list list;
+    __uint64           time_cache;
+    __uint64           time_overdraw;
+    __uint64           time_start;
+
+    create_grid(BENCHMARK_GRID_SIZE,
+                true, /* shuffle */
+               &list);
+
+    acmr_before = get_acmr(list);
+    time_start  = system_time_now_usec();
+    {
+        mesh_optimizer_optimize_vertex_cache(&list.index_data[0],
+                                             static_cast<uint32_t>(list.index_data.size() ),
+                                             static_cast<uint32_t>(list.vertex_data.size() / 3) );
+    }
+    time_cache = system_time_now_usec() - time_start;
+    time_start = system_time_now_usec();
+    {
+        mesh_optimizer_optimize_overdraw(&list.index_data[0],
+                                         static_cast<uint32_t>(list.index_data.size() ),
+                                         static_cast<uint32_t>(list.vertex_data.size() / 3),
+                                         &list.vertex_data[0],
+                                         sizeof(float) * 3,
+                                         1.05f);
+    }
+    time_overdraw = system_time_now_usec() - time_start;
+    acmr_after    = get_acmr(list);
+
+    LOG_INFO("[%u triangles] ACMR: %.3f -> %.3f, vertex cache msec: %10.2f, overdraw msec: %10.2f",
+             static_cast<uint32_t>(list.index_data.size() / 3),
+             acmr_before,
+             acmr_after,
+             double(time_cache)    / 1000.0,
+             double(time_overdraw) / 1000.0);
+}
@@ -0,0 +1,412 @@
+/**
+ *
+ * Emerald (kbi/elude @2016)
+ *
+ */
+#include "test_mesh_simplifier.h"
+#include "gtest/gtest.h"
+#include "shared.h"
+#include "mesh/mesh_simplifier.h"
+#include "system/system_log.h"
+#include "system/system_time.h"
+#include <algorithm>
+#include <float.h>
+#include <math.h>
+#include <vector>
+
+#define BENCHMARK_GRID_SIZE (708) /* 2 * 708 * 708 = ~1M triangles */
+#define TEST_GRID_SIZE      (32)
+
+
+/** Describes a triangle list, as used by the tests below. */
+typedef struct
+{
+    std::vector<uint32_t> index_data;
+    std::vector<float>    vertex_data;
+} test_triangle_list;
+
+/** Creates a (grid_size x grid_size) grid of quads, each split into two triangles.
+ *
+ *  @param grid_size     Number of quads along each edge.
+ *  @param is_curved     true to raise the grid into a dome, so that it is curved along both axes. false
+ *                       to keep it flat.
+ *  @param seam_column   If not 0, vertices of this column are duplicated, so that quads to its left
+ *                       and quads to its right do not share any vertices. This is how attribute seams
+ *                       are represented in single-indexed data.
+ *  @param out_list      Deref will be filled with the grid's data.
+ */
+PRIVATE void create_grid(uint32_t            grid_size,
+                         bool                is_curved,
+                         uint32_t            seam_column,
+                         test_triangle_list* out_list)
+{
+    const uint32_t row_size = grid_size + 1 + ((seam_column != 0) ? 1 : 0);
+
+    out_list->index_data.clear ();
+    out_list->vertex_data.clear();
+
+    for (uint32_t y = 0;
+                  y <= grid_size;
+                ++y)
+    {
+        for (uint32_t n_column = 0;
+                      n_column < row_size;
+                    ++n_column)
+        {
+            const uint32_t x  = (seam_column != 0 && n_column > seam_column) ? n_column - 1 : n_column;
+            const float    fx = float(x) / float(grid_size);
+            const float    fy = float(y) / float(grid_size);
+
+            out_list->vertex_data.push_back(fx);
+            out_list->vertex_data.push_back(fy);
+            out_list->vertex_data.push_back((is_curved) ? 0.25f * sinf(3.14159265f * fx) * sinf(3.14159265f * fy)
+                                                        : 0.0f);
+        }
+    }
+
+    for (uint32_t y = 0;
+                  y < grid_size;
+                ++y)
+    {
+        for (uint32_t x = 0;
+                      x < grid_size;
+                    ++x)
+        {
+            const uint32_t n_column = (seam_column != 0 && x >= seam_column) ? x + 1 : x;
+            const uint32_t v0       = y * row_size + n_column;
+            const uint32_t v1       = v0 + 1;
+            const uint32_t v2       = v0 + row_size;
+            const uint32_t v3       = v2 + 1;
+            const uint32_t triangles[] =
+            {
+                v0, v1, v2,
+                v1, v3, v2
+            };
+
+            out_list->index_data.insert(out_list->index_data.end(),
+                                        triangles,
+                                        triangles + sizeof(triangles) / sizeof(triangles[0]) );
+        }
+    }
+}
+
+/** Returns the distance between a point and a triangle. */
+PRIVATE float get_point_triangle_distance(const float* point,
+                                          const float* a,
+                                          const float* b,
+                                          const float* c)
+{
+    const float ab[] = {b[0] - a[0],     b[1] - a[1],     b[2] - a[2]};
+    const float ac[] = {c[0] - a[0],     c[1] - a[1],     c[2] - a[2]};
+    const float ap[] = {point[0] - a[0], point[1] - a[1], point[2] - a[2]};
+    const float d00  = ab[0] * ab[0] + ab[1] * ab[1] + ab[2] * ab[2];
+    const float d01  = ab[0] * ac[0] + ab[1] * ac[1] + ab[2] * ac[2];
+    const float d11  = ac[0] * ac[0] + ac[1] * ac[1] + ac[2] * ac[2];
+    const float d20  = ap[0] * ab[0] + ap[1] * ab[1] + ap[2] * ab[2];
+    const float d21  = ap[0] * ac[0] + ap[1] * ac[1] + ap[2] * ac[2];
+    const float denom = d00 * d11 - d01 * d01;
+    float       result;
+
+    /* Try the projection onto the triangle's plane first.. */
+    if (denom > 0.0f)
+    {
+        const float v = (d11 * d20 - d01 * d21) / denom;
+        const float w = (d00 * d21 - d01 * d20) / denom;
+
+        if (v >= 0.0f && w >= 0.0f && v + w <= 1.0f)
+        {
+            const float delta[] =
+            {
+                ap[0] - v * ab[0] - w * ac[0],
+                ap[1] - v * ab[1] - w * ac[1],
+                ap[2] - v * ab[2] - w * ac[2]
+            };
+
+            return sqrtf(delta[0] * delta[0] + delta[1] * delta[1] + delta[2] * delta[2]);
+        }
+    }
+
+    /* ..and fall back to the closest edge otherwise. */
+    result = FLT_MAX;
+
+    for (uint32_t n_edge = 0;
+                  n_edge < 3;
+                ++n_edge)
+    {
+        const float* vertices[] = {a, b, c};
+        const float* p0         = vertices[n_edge];
+        const float* p1         = vertices[(n_edge + 1) % 3];
+        const float  edge[]     = {p1[0] - p0[0],       p1[1] - p0[1],       p1[2] - p0[2]};
+        const float  to_point[] = {point[0] - p0[0],    point[1] - p0[1],    point[2] - p0[2]};
+        const float  edge_len2  = edge[0] * edge[0] + edge[1] * edge[1] + edge[2] * edge[2];
+        float        t          = 0.0f;
+
+        if (edge_len2 > 0.0f)
+        {
+            t = (to_point[0] * edge[0] + to_point[1] * edge[1] + to_point[2] * edge[2]) / edge_len2;
+            t = std::max(0.0f,
+                         std::min(1.0f,
+                                  t) );
+        }
+
+        const float delta[] =
+        {
+            to_point[0] - t * edge[0],
+            to_point[1] - t * edge[1],
+            to_point[2] - t * edge[2]
+        };
+
+        result = std::min(result,
+                          sqrtf(delta[0] * delta[0] + delta[1] * delta[1] + delta[2] * delta[2]) );
+    }
+
+    return result;
+}
+
+/** Returns the largest distance between a vertex of the original triangle list and the surface
+ *  described by the simplified one. */
+PRIVATE float get_max_vertex_distance(const test_triangle_list&    list,
+                                      const std::vector<uint32_t>& simplified_index_data)
+{
+    std::vector<bool> is_vertex_used(list.vertex_data.size() / 3,
+                                     false);
+    float             result = 0.0f;
+
+    for (uint32_t n_index = 0;
+                  n_index < list.index_data.size();
+                ++n_index)
+    {
+        is_vertex_used[list.index_data[n_index] ] = true;
+    }
+
+    for (uint32_t n_vertex = 0;
+                  n_vertex < is_vertex_used.size();
+                ++n_vertex)
+    {
+        float min_distance = FLT_MAX;
+
+        if (!is_vertex_used[n_vertex])
+        {
+            continue;
+        }
+
+        for (uint32_t n_index = 0;
+                      n_index < simplified_index_data.size();
+                      n_index += 3)
+        {
+            min_distance = std::min(min_distance,
+                                    get_point_triangle_distance(&list.vertex_data[3 * n_vertex],
+                                                                &list.vertex_data[3 * simplified_index_data[n_index + 0] ],
+                                                                &list.vertex_data[3 * simplified_index_data[n_index + 1] ],
+                                                                &list.vertex_data[3 * simplified_index_data[n_index + 2] ]) );
+        }
+
+        result = std::max(result,
+                          min_distance);
+    }
+
+    return result;
+}
+
+/** Simplifies a triangle list.
+ *
+ *  @param list             Triangle list to simplify.
+ *  @param target_n_indices Number of indices the result should not exceed.
+ *  @param out_index_data   Deref will be filled with the simplified triangle list.
+ *
+ *  @return Error reported by the simplifier.
+ */
+PRIVATE float simplify(const test_triangle_list& list,
+                       uint32_t                  target_n_indices,
+                       std::vector<uint32_t>*    out_index_data)
+{
+    float    error     = -1.0f;
+    uint32_t n_indices = 0;
+
+    out_index_data->resize(list.index_data.size() );
+
+    n_indices = mesh_simplifier_simplify(&list.index_data[0],
+                                         static_cast<uint32_t>(list.index_data.size() ),
+                                         static_cast<uint32_t>(list.vertex_data.size() / 3),
+                                         &list.vertex_data[0],
+                                         sizeof(float) * 3,
+                                         target_n_indices,
+                                         &(*out_index_data)[0],
+                                         &error);
+
+    out_index_data->resize(n_indices);
+
+    return error;
+}
+
+
+TEST(MeshSimplifierTest, FlatGridSimplifiesWithoutError)
+{
+    float                 error;
+    std::vector<uint32_t> index_data;
+    test_triangle_list    list;
+
+    create_grid(TEST_GRID_SIZE,
+                false, /* is_curved   */
+                0,     /* seam_column */
+               &list);
+
+    error = simplify(list,
+                     static_cast<uint32_t>(list.index_data.size() / 10),
+                    &index_data);
+
+    /* Only the border vertices are locked, so the interior can be removed entirely */
+    ASSERT_GT(index_data.size(),
+              0);
+    ASSERT_LE(index_data.size(),
+              list.index_data.size() / 10);
+    ASSERT_LT(error,
+              1e-4f);
+    ASSERT_LT(get_max_vertex_distance(list,
+                                      index_data),
+              1e-4f);
+}
+
+TEST(MeshSimplifierTest, CurvedGridRespectsTargetAndErrorBound)
+{
+    float                 last_error = 0.0f;
+    test_triangle_list    list;
+    const float           ratios[]   = {0.5f, 0.25f, 0.1f};
+
+    create_grid(TEST_GRID_SIZE,
+                true, /* is_curved   */
+                0,    /* seam_column */
+               &list);
+
+    for (uint32_t n_ratio = 0;
+                  n_ratio < sizeof(ratios) / sizeof(ratios[0]);
+                ++n_ratio)
+    {
+        float                 error;
+        std::vector<uint32_t> index_data;
+        float                 max_distance;
+        const uint32_t        target_n_indices = static_cast<uint32_t>(list.index_data.size() / 3 * ratios[n_ratio]) * 3;
+
+        error        = simplify               (list,
+                                               target_n_indices,
+                                              &index_data);
+        max_distance = get_max_vertex_distance(list,
+                                               index_data);
+
+        ASSERT_GT(index_data.size(),
+                  0);
+        ASSERT_LE(index_data.size(),
+                  target_n_indices);
+        ASSERT_EQ(index_data.size() % 3,
+                  0);
+
+        /* The reported error accumulates distances between the kept vertices and the planes of the triangles
+         * they replace. On a smooth surface, it also bounds how far the removed vertices lie from the new
+         * triangles. */
+        ASSERT_GT(error,
+                  0.0f);
+        ASSERT_LE(max_distance,
+                  error * 1.25f);
+
+        /* Coarser levels can only be less accurate */
+        ASSERT_GE(error,
+                  last_error);
+
+        last_error = error;
+    }
+}
+
+TEST(MeshSimplifierTest, SeamAndBorderVerticesArePreserved)
+{
+    std::vector<uint32_t> index_data;
+    std::vector<bool>     is_vertex_used;
+    test_triangle_list    list;
+    const uint32_t        row_size = TEST_GRID_SIZE + 2;
+
+    create_grid(TEST_GRID_SIZE,
+                true,               /* is_curved   */
+                TEST_GRID_SIZE / 2, /* seam_column */
+               &list);
+
+    simplify(list,
+             static_cast<uint32_t>(list.index_data.size() / 10),
+            &index_data);
+
+    ASSERT_GT(index_data.size(),
+              0);
+
+    is_vertex_used.resize(list.vertex_data.size() / 3,
+                          false);
+
+    for (uint32_t n_index = 0;
+                  n_index < index_data.size();
+                ++n_index)
+    {
+        is_vertex_used[index_data[n_index] ] = true;
+    }
+
+    /* Both copies of every seam vertex must still be referenced, so that the attribute discontinuity is retained.. */
+    for (uint32_t y = 0;
+                  y <= TEST_GRID_SIZE;
+                ++y)
+    {
+        ASSERT_TRUE(is_vertex_used[y * row_size + TEST_GRID_SIZE / 2]);
+        ASSERT_TRUE(is_vertex_used[y * row_size + TEST_GRID_SIZE / 2 + 1]);
+    }
+
+    /* ..and so must the corners of the open borders. */
+    ASSERT_TRUE(is_vertex_used[0]);
+    ASSERT_TRUE(is_vertex_used[row_size - 1]);
+    ASSERT_TRUE(is_vertex_used[TEST_GRID_SIZE * row_size]);
+    ASSERT_TRUE(is_vertex_used[TEST_GRID_SIZE * row_size + row_size - 1]);
+}
+
+TEST(MeshSimplifierTest, SimplificationIsDeterministic)
+{
+    std::vector<uint32_t> index_data[2];
+    test_triangle_list    list;
+
+    create_grid(TEST_GRID_SIZE,
+                true, /* is_curved   */
+                0,    /* seam_column */
+               &list);
+
+    for (uint32_t n_run = 0;
+                  n_run < 2;
+                ++n_run)
+    {
+        simplify(list,
+                 static_cast<uint32_t>(list.index_data.size() / 4),
+                &index_data[n_run]);
+    }
+
+    ASSERT_TRUE(index_data[0] == index_data[1]);
+}
+
+TEST(MeshSimplifierTest, DISABLED_SimplificationBenchmark)
+{
+    float                 error;
+    std::vector<uint32_t> index_data;
+    test_triangle_list    list;
+    __uint64              time_simplify;
+    __uint64              time_start;
+
+    create_grid(BENCHMARK_GRID_SIZE,
+                true, /* is_curved   */
+                0,    /* seam_column */
+               &list);
+
+    time_start = system_time_now_usec();
+    {
+        error = simplify(list,
+                         static_cast<uint32_t>(list.index_data.size() / 4),
+                        &index_data);
+    }
+    time_simplify = system_time_now_usec() - time_start;
+
+    LOG_INFO("[%u -> %u triangles] error: %.5f, msec: %10.2f",
+             static_cast<uint32_t>(list.index_data.size() / 3),
+             static_cast<uint32_t>(index_data.size()      / 3),
+             error,
+             double(time_simplify) / 1000.0);
+}
@@ -6,8 +6,11 @@
 #include "test_resizable_vector.h"
 #include "gtest/gtest.h"
 #include "shared.h"
+#include "system/system_constants.h"
 #include "system/system_log.h"
 #include "system/system_resizable_vector.h"
+#include "system/system_time.h"
+#include <algorithm>
 
 #define N_OPERATIONS (100)
 
@@ -114,6 +117,50 @@ PRIVATE bool sort_comparator(void* value_1,
     return (int_1 <= int_2);
 }
 
+/** Strict flavour of sort_comparator() */
+PRIVATE bool sort_comparator_strict(const void* value_1,
+                                    const void* value_2)
+{
+    return (intptr_t) value_1 < (intptr_t) value_2;
+}
+
+typedef enum
+{
+    SORT_INPUT_PATTERN_RANDOM,
+    SORT_INPUT_PATTERN_SORTED,
+    SORT_INPUT_PATTERN_REVERSE_SORTED,
+    SORT_INPUT_PATTERN_FEW_UNIQUE,
+    SORT_INPUT_PATTERN_ORGAN_PIPE,
+
+    SORT_INPUT_PATTERN_COUNT
+} sort_input_pattern;
+
+PRIVATE const char* sort_input_pattern_names[] =
+{
+    "random",
+    "sorted",
+    "reverse-sorted",
+    "few unique",
+    "organ pipe"
+};
+
+/** Returns n-th value of a sort input of the specified pattern */
+PRIVATE intptr_t get_sort_input_value(sort_input_pattern pattern,
+                                      uint32_t           n_value,
+                                      uint32_t           n_values)
+{
+    switch (pattern)
+    {
+        case SORT_INPUT_PATTERN_RANDOM:         return (intptr_t) ( ( (__uint64) n_value * 0x9E3779B97F4A7C15ULL) >> 33);
+        case SORT_INPUT_PATTERN_SORTED:         return n_value;
+        case SORT_INPUT_PATTERN_REVERSE_SORTED: return n_values - n_value;
+        case SORT_INPUT_PATTERN_FEW_UNIQUE:     return (n_value * 7919) % 4;
+        case SORT_INPUT_PATTERN_ORGAN_PIPE:     return (n_value < n_values / 2) ? n_value : (n_values - n_value);
+    }
+
+    return 0;
+}
+
 TEST(ResizableVectorTest, RandomOperations)
 {
     system_resizable_vector vec = system_resizable_vector_create(4 /* capacity */);
@@ -241,3 +288,141 @@ TEST(ResizablevectorTest, Sort)
     /* Clean up */
     system_resizable_vector_release(test_vector);
 }
+
+/* Sorts vectors of various sizes holding data of various patterns, using both strict and non-strict
+ * comparators, and compares the outcome against std::sort(). Vectors large enough to take the
+ * parallel sort path are also covered. */
+TEST(ResizableVectorTest, SortPatterns)
+{
+    const uint32_t n_values_array[] =
+    {
+        0,
+        1,
+        2,
+        23,
+        100,
+        1000,
+        RESIZABLE_VECTOR_PARALLEL_SORT_THRESHOLD * 2 + 7
+    };
+    const uint32_t n_values_array_size = sizeof(n_values_array) / sizeof(n_values_array[0]);
+
+    for (uint32_t n_size = 0;
+                  n_size < n_values_array_size;
+                ++n_size)
+    {
+        for (uint32_t n_pattern = 0;
+                      n_pattern < SORT_INPUT_PATTERN_COUNT;
+                    ++n_pattern)
+        {
+            for (uint32_t n_comparator = 0;
+                          n_comparator < 2;
+                        ++n_comparator)
+            {
+                const uint32_t          n_values = n_values_array[n_size];
+                std::vector<intptr_t>   reference_values;
+                system_resizable_vector vector   = system_resizable_vector_create(n_values + 1);
+
+                for (uint32_t n_value = 0;
+                              n_value < n_values;
+                            ++n_value)
+                {
+                    const intptr_t value = get_sort_input_value( (sort_input_pattern) n_pattern,
+                                                                n_value,
+                                                                n_values);
+
+                    reference_values.push_back  (value);
+                    system_resizable_vector_push(vector,
+                                                 (void*) value);
+                }
+
+                std::sort(reference_values.begin(),
+                          reference_values.end  () );
+
+                system_resizable_vector_sort(vector,
+                                             (n_comparator == 0) ? sort_comparator_strict
+                                                                 : (bool (*)(const void*, const void*)) sort_comparator);
+
+                for (uint32_t n_value = 0;
+                              n_value < n_values;
+                            ++n_value)
+                {
+                    void* value = NULL;
+
+                    system_resizable_vector_get_element_at(vector,
+                                                           n_value,
+                                                          &value);
+
+                    ASSERT_EQ((intptr_t) value,
+                              reference_values[n_value]) << "Pattern: " << sort_input_pattern_names[n_pattern] << ", size: " << n_values;
+                }
+
+                system_resizable_vector_release(vector);
+            }
+        }
+    }
+}
+
+/* Measures system_resizable_vector_sort() for random, sorted and reverse-sorted input. Disabled by default,
+ * since it takes a while to complete. Run with --gtest_also_run_disabled_tests. */
+TEST(ResizableVectorTest, DISABLED_SortBenchmark)
+{
+    const uint32_t           n_values_array[] =
+    {
+        1000,
+        10000,
+        100000,
+        1000000,
+        10000000
+    };
+    const uint32_t           n_values_array_size = sizeof(n_values_array) / sizeof(n_values_array[0]);
+    const sort_input_pattern patterns[]          =
+    {
+        SORT_INPUT_PATTERN_RANDOM,
+        SORT_INPUT_PATTERN_SORTED,
+        SORT_INPUT_PATTERN_REVERSE_SORTED
+    };
+    const uint32_t           n_patterns          = sizeof(patterns) / sizeof(patterns[0]);
+
+    for (uint32_t n_pattern = 0;
+                  n_pattern < n_patterns;
+                ++n_pattern)
+    {
+        const sort_input_pattern pattern = patterns[n_pattern];
+
+        for (uint32_t n_size = 0;
+                      n_size < n_values_array_size;
+                    ++n_size)
+        {
+            const uint32_t          n_values   = n_values_array[n_size];
+            __uint64                time_start = 0;
+            __uint64                time_total = 0;
+            system_resizable_vector vector     = system_resizable_vector_create(n_values);
+
+            for (uint32_t n_value = 0;
+                          n_value < n_values;
+                        ++n_value)
+            {
+                void* value = (void*) get_sort_input_value(pattern,
+                                                           n_value,
+                                                           n_values);
+
+                system_resizable_vector_push(vector,
+                                             value);
+            }
+
+            time_start = system_time_now_usec();
+            {
+                system_resizable_vector_sort(vector,
+                                             (bool (*)(const void*, const void*)) sort_comparator);
+            }
+            time_total = system_time_now_usec() - time_start;
+
+            LOG_INFO("[%-14s %8u elements] ns per element: %8.1f",
+                     sort_input_pattern_names[pattern],
+                     n_values,
+                     double(time_total) * 1000.0 / n_values);
+
+            system_resizable_vector_release(vector);
+        }
+    }
+}
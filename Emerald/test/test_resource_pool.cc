@@ -0,0 +1,334 @@
+/**
+ *
+ * Emerald (kbi/elude @2012-2015)
+ *
+ */
+#include "test_resource_pool.h"
+#include "gtest/gtest.h"
+#include "shared.h"
+#include "system/system_atomics.h"
+#include "system/system_constants.h"
+#include "system/system_critical_section.h"
+#include "system/system_event.h"
+#include "system/system_hashed_ansi_string.h"
+#include "system/system_log.h"
+#include "system/system_resizable_vector.h"
+#include "system/system_resource_pool.h"
+#include "system/system_threads.h"
+#include "system/system_time.h"
+#include <set>
+
+#define BENCHMARK_MAX_N_THREADS          (32)
+#define BENCHMARK_N_OPERATIONS_PER_THREAD (200000)
+#define BENCHMARK_N_BLOCKS_PER_BURST     (8)
+#define STRESS_N_BLOCKS_PER_ROUND        (100)
+#define STRESS_N_ROUNDS                  (200)
+#define STRESS_N_THREADS                 (8)
+
+
+typedef struct
+{
+    volatile unsigned int is_in_use;
+    unsigned int          payload;
+} test_block;
+
+typedef struct
+{
+    system_critical_section exchange_cs;
+    system_resizable_vector exchange_vector;
+    volatile unsigned int   n_errors;
+    system_resource_pool    pool;
+} stress_test_data;
+
+typedef struct
+{
+    system_resource_pool pool;
+    system_event         start_event;
+} benchmark_data;
+
+
+volatile unsigned int n_blocks_deinitialized = 0;
+volatile unsigned int n_blocks_initialized   = 0;
+
+PRIVATE void _on_block_deinit(system_resource_pool_block block)
+{
+    system_atomics_increment(&n_blocks_deinitialized);
+}
+
+PRIVATE void _on_block_init(system_resource_pool_block block)
+{
+    ((test_block*) block)->is_in_use = 0;
+
+    system_atomics_increment(&n_blocks_initialized);
+}
+
+PRIVATE void _benchmark_thread_entrypoint(system_threads_entry_point_argument arg)
+{
+    benchmark_data* data_ptr = (benchmark_data*) arg;
+    void*           blocks[BENCHMARK_N_BLOCKS_PER_BURST];
+
+    system_event_wait_single(data_ptr->start_event);
+
+    for (unsigned int n_operation = 0;
+                      n_operation < BENCHMARK_N_OPERATIONS_PER_THREAD;
+                      n_operation += BENCHMARK_N_BLOCKS_PER_BURST)
+    {
+        for (unsigned int n_block = 0;
+                          n_block < BENCHMARK_N_BLOCKS_PER_BURST;
+                        ++n_block)
+        {
+            blocks[n_block] = system_resource_pool_get_from_pool(data_ptr->pool);
+        }
+
+        for (unsigned int n_block = 0;
+                          n_block < BENCHMARK_N_BLOCKS_PER_BURST;
+                        ++n_block)
+        {
+            system_resource_pool_return_to_pool(data_ptr->pool,
+                                                (system_resource_pool_block) blocks[n_block]);
+        }
+    }
+}
+
+/** Takes blocks from the pool, hands some of them over to other threads and returns blocks
+ *  handed over by other threads. Verifies no block is ever handed out twice. */
+PRIVATE void _stress_thread_entrypoint(system_threads_entry_point_argument arg)
+{
+    stress_test_data* data_ptr = (stress_test_data*) arg;
+    test_block*       blocks[STRESS_N_BLOCKS_PER_ROUND];
+
+    for (unsigned int n_round = 0;
+                      n_round < STRESS_N_ROUNDS;
+                    ++n_round)
+    {
+        for (unsigned int n_block = 0;
+                          n_block < STRESS_N_BLOCKS_PER_ROUND;
+                        ++n_block)
+        {
+            blocks[n_block] = (test_block*) system_resource_pool_get_from_pool(data_ptr->pool);
+
+            if (!system_atomics_compare_exchange(&blocks[n_block]->is_in_use,
+                                                 0,   /* expected_value */
+                                                 1) ) /* new_value      */
+            {
+                system_atomics_increment(&data_ptr->n_errors);
+            }
+        }
+
+        /* Return the first half directly and hand the other half over */
+        for (unsigned int n_block = 0;
+                          n_block < STRESS_N_BLOCKS_PER_ROUND;
+                        ++n_block)
+        {
+            if (n_block < STRESS_N_BLOCKS_PER_ROUND / 2)
+            {
+                blocks[n_block]->is_in_use = 0;
+
+                system_resource_pool_return_to_pool(data_ptr->pool,
+                                                    (system_resource_pool_block) blocks[n_block]);
+            }
+            else
+            {
+                system_critical_section_enter(data_ptr->exchange_cs);
+                {
+                    system_resizable_vector_push(data_ptr->exchange_vector,
+                                                 blocks[n_block]);
+                }
+                system_critical_section_leave(data_ptr->exchange_cs);
+            }
+        }
+
+        /* Return blocks handed over by other threads */
+        for (unsigned int n_block = 0;
+                          n_block < STRESS_N_BLOCKS_PER_ROUND / 2;
+                        ++n_block)
+        {
+            test_block* block_ptr = NULL;
+
+            system_critical_section_enter(data_ptr->exchange_cs);
+            {
+                system_resizable_vector_pop(data_ptr->exchange_vector,
+                                           &block_ptr);
+            }
+            system_critical_section_leave(data_ptr->exchange_cs);
+
+            if (block_ptr == NULL)
+            {
+                break;
+            }
+
+            block_ptr->is_in_use = 0;
+
+            system_resource_pool_return_to_pool(data_ptr->pool,
+                                                (system_resource_pool_block) block_ptr);
+        }
+    }
+}
+
+
+TEST(ResourcePoolTest, BlocksAreReused)
+{
+    std::set<void*>      blocks;
+    unsigned int         high_water_mark        = 0;
+    unsigned int         high_water_mark_before = 0;
+    __uint64             n_cache_hits           = 0;
+    __uint64             n_refills              = 0;
+    system_resource_pool pool                   = system_resource_pool_create(sizeof(test_block),
+                                                                              16, /* n_elements_per_blob */
+                                                                              _on_block_init,
+                                                                              _on_block_deinit);
+
+    n_blocks_deinitialized = 0;
+    n_blocks_initialized   = 0;
+
+    /* Retrieve a number of blocks. All of them must be unique. */
+    for (unsigned int n_block = 0;
+                      n_block < 1000;
+                    ++n_block)
+    {
+        blocks.insert(system_resource_pool_get_from_pool(pool) );
+    }
+
+    ASSERT_EQ(blocks.size(),
+              1000);
+
+    system_resource_pool_get_property(pool,
+                                      SYSTEM_RESOURCE_POOL_PROPERTY_HIGH_WATER_MARK,
+                                     &high_water_mark_before);
+
+    ASSERT_GE(high_water_mark_before,
+              1000);
+    ASSERT_EQ(n_blocks_initialized,
+              high_water_mark_before);
+
+    /* Return all blocks and take them again. No new blocks should be needed. */
+    for (std::set<void*>::iterator it  = blocks.begin();
+                                   it != blocks.end();
+                                 ++it)
+    {
+        system_resource_pool_return_to_pool(pool,
+                                            (system_resource_pool_block) *it);
+    }
+
+    for (unsigned int n_block = 0;
+                      n_block < 1000;
+                    ++n_block)
+    {
+        void* block = system_resource_pool_get_from_pool(pool);
+
+        ASSERT_TRUE(blocks.find(block) != blocks.end() );
+
+        system_resource_pool_return_to_pool(pool,
+                                            (system_resource_pool_block) block);
+    }
+
+    system_resource_pool_get_property(pool,
+                                      SYSTEM_RESOURCE_POOL_PROPERTY_HIGH_WATER_MARK,
+                                     &high_water_mark);
+    system_resource_pool_get_property(pool,
+                                      SYSTEM_RESOURCE_POOL_PROPERTY_N_CACHE_HITS,
+                                     &n_cache_hits);
+    system_resource_pool_get_property(pool,
+                                      SYSTEM_RESOURCE_POOL_PROPERTY_N_REFILLS,
+                                     &n_refills);
+
+    ASSERT_EQ(high_water_mark,
+              high_water_mark_before);
+    ASSERT_EQ(n_cache_hits + n_refills,
+              2000);
+    ASSERT_GT(n_cache_hits,
+              n_refills);
+
+    /* All initialized blocks are now cached by the pool, so all of them should be deinitialized */
+    system_resource_pool_release(pool);
+
+    ASSERT_EQ(n_blocks_deinitialized,
+              n_blocks_initialized);
+}
+
+TEST(ResourcePoolTest, CrossThreadReturns)
+{
+    stress_test_data data;
+    system_event     thread_wait_events[STRESS_N_THREADS];
+
+    data.exchange_cs     = system_critical_section_create();
+    data.exchange_vector = system_resizable_vector_create(STRESS_N_BLOCKS_PER_ROUND * STRESS_N_THREADS);
+    data.n_errors        = 0;
+    data.pool            = system_resource_pool_create(sizeof(test_block),
+                                                       64, /* n_elements_per_blob */
+                                                       _on_block_init,
+                                                       NULL); /* deinit_fn */
+
+    for (unsigned int n_thread = 0;
+                      n_thread < STRESS_N_THREADS;
+                    ++n_thread)
+    {
+        system_threads_spawn(_stress_thread_entrypoint,
+                            &data,
+                             thread_wait_events + n_thread,
+                             system_hashed_ansi_string_create("Resource pool stress thread") );
+    }
+
+    system_event_wait_multiple(thread_wait_events,
+                               STRESS_N_THREADS,
+                               true, /* wait_on_all_objects */
+                               SYSTEM_TIME_INFINITE,
+                               NULL); /* out_result_ptr */
+
+    ASSERT_EQ(data.n_errors,
+              0);
+
+    system_resizable_vector_release(data.exchange_vector);
+    system_critical_section_release(data.exchange_cs);
+    system_resource_pool_release   (data.pool);
+}
+
+/* Measures throughput of get/return call pairs issued from 1 to BENCHMARK_MAX_N_THREADS threads. Disabled
+ * by default, since it takes a while to complete. Run with --gtest_also_run_disabled_tests. */
+TEST(ResourcePoolTest, DISABLED_ContentionBenchmark)
+{
+    system_event thread_wait_events[BENCHMARK_MAX_N_THREADS];
+
+    for (unsigned int n_threads = 1;
+                      n_threads <= BENCHMARK_MAX_N_THREADS;
+                      n_threads *= 2)
+    {
+        benchmark_data data;
+        __uint64       duration_usec   = 0;
+        __uint64       start_time_usec = 0;
+
+        data.pool        = system_resource_pool_create(sizeof(test_block),
+                                                       64,    /* n_elements_per_blob */
+                                                       NULL,  /* init_fn */
+                                                       NULL); /* deinit_fn */
+        data.start_event = system_event_create(true); /* manual_reset */
+
+        for (unsigned int n_thread = 0;
+                          n_thread < n_threads;
+                        ++n_thread)
+        {
+            system_threads_spawn(_benchmark_thread_entrypoint,
+                                &data,
+                                 thread_wait_events + n_thread,
+                                 system_hashed_ansi_string_create("Resource pool benchmark thread") );
+        }
+
+        start_time_usec = system_time_now_usec();
+        {
+            system_event_set          (data.start_event);
+            system_event_wait_multiple(thread_wait_events,
+                                       n_threads,
+                                       true, /* wait_on_all_objects */
+                                       SYSTEM_TIME_INFINITE,
+                                       NULL); /* out_result_ptr */
+        }
+        duration_usec = system_time_now_usec() - start_time_usec;
+
+        system_event_release        (data.start_event);
+        system_resource_pool_release(data.pool);
+
+        LOG_INFO("[%2u thread(s)] get+return pairs per second: %12.0f",
+                 n_threads,
+                 double(n_threads * BENCHMARK_N_OPERATIONS_PER_THREAD) * 1000000.0 / double(duration_usec) );
+    }
+}
@@ -0,0 +1,5 @@
+/**
+ *
+ * Emerald (kbi/elude @2012-2015)
+ *
+ */
@@ -6,9 +6,21 @@
 #include "test_thread_pool.h"
 #include "gtest/gtest.h"
 #include "shared.h"
+#include "system/system_constants.h"
 #include "system/system_event.h"
 #include "system/system_threads.h"
 #include "system/system_thread_pool.h"
+#include "system/system_time.h"
+#include <algorithm>
+
+#define MULTIPLE_WAITERS_N_THREADS                (4)
+#define NESTED_JOB_TREE_DEPTH                     (10)
+#define PARALLEL_FOR_BENCHMARK_N_RUNS             (5)
+#define PARALLEL_FOR_GRAIN_SIZE                   (4096)
+#define PARALLEL_FOR_N_ITEMS                      (4 * 1024 * 1024)
+#define THROUGHPUT_BENCHMARK_N_TASKS_PER_PRODUCER (50000)
+#define UTILIZATION_N_TASKS                       (32)
+#define UTILIZATION_TASK_DURATION_USEC            (1000)
 
 struct few_simple_tasks_submitted_separately_argument
 {
@@ -58,6 +70,172 @@ THREAD_POOL_TASK_HANDLER void _few_complex_tasks_submitted_separately_worker(voi
     system_event_set(input->wait_event);
 }
 
+struct throughput_benchmark_data
+{
+    system_event          done_event;
+    volatile unsigned int n_tasks_executed;
+    unsigned int          n_tasks_total;
+    system_event          start_event;
+};
+
+
+THREAD_POOL_TASK_HANDLER void _throughput_benchmark_worker(void* arg)
+{
+    throughput_benchmark_data* data_ptr = (throughput_benchmark_data*) arg;
+
+    if (system_atomics_increment(&data_ptr->n_tasks_executed) == data_ptr->n_tasks_total)
+    {
+        system_event_set(data_ptr->done_event);
+    }
+}
+
+PRIVATE void _throughput_benchmark_producer_thread(void* arg)
+{
+    throughput_benchmark_data* data_ptr = (throughput_benchmark_data*) arg;
+
+    system_event_wait_single(data_ptr->start_event);
+
+    for (unsigned int n_task = 0;
+                      n_task < THROUGHPUT_BENCHMARK_N_TASKS_PER_PRODUCER;
+                    ++n_task)
+    {
+        system_thread_pool_task task = system_thread_pool_create_task_handler_only(THREAD_POOL_TASK_PRIORITY_NORMAL,
+                                                                                   _throughput_benchmark_worker,
+                                                                                   data_ptr);
+
+        system_thread_pool_submit_single_task(task);
+    }
+}
+
+struct job_isolation_argument
+{
+    system_event          gate_event;
+    volatile unsigned int n_blocking_tasks_started;
+    system_thread_id      job_task_thread_id;
+    system_event          unrelated_task_done_event;
+    system_thread_id      unrelated_task_thread_id;
+};
+
+struct multiple_waiters_argument
+{
+    system_event           gate_event;
+    system_thread_pool_job job;
+};
+
+struct nested_job_tree_node_argument
+{
+    unsigned int           depth;
+    system_thread_pool_job job;
+    volatile unsigned int* n_leaves_visited_ptr;
+};
+
+struct parallel_for_argument
+{
+    const float* input_data;
+    float*       output_data;
+    double*      partial_sums;
+};
+
+
+THREAD_POOL_TASK_HANDLER void _job_isolation_blocking_worker(void* arg)
+{
+    job_isolation_argument* arg_ptr = (job_isolation_argument*) arg;
+
+    system_atomics_increment(&arg_ptr->n_blocking_tasks_started);
+    system_event_wait_single(arg_ptr->gate_event);
+}
+
+THREAD_POOL_TASK_HANDLER void _job_isolation_job_task_worker(void* arg)
+{
+    job_isolation_argument* arg_ptr = (job_isolation_argument*) arg;
+
+    arg_ptr->job_task_thread_id = system_threads_get_thread_id();
+}
+
+THREAD_POOL_TASK_HANDLER void _job_isolation_unrelated_task_worker(void* arg)
+{
+    job_isolation_argument* arg_ptr = (job_isolation_argument*) arg;
+
+    arg_ptr->unrelated_task_thread_id = system_threads_get_thread_id();
+}
+
+THREAD_POOL_TASK_HANDLER void _multiple_waiters_task_worker(void* arg)
+{
+    multiple_waiters_argument* arg_ptr = (multiple_waiters_argument*) arg;
+
+    system_event_wait_single(arg_ptr->gate_event);
+}
+
+PRIVATE void _multiple_waiters_waiter_thread(void* arg)
+{
+    multiple_waiters_argument* arg_ptr = (multiple_waiters_argument*) arg;
+
+    system_thread_pool_wait_for_job(arg_ptr->job);
+}
+
+THREAD_POOL_TASK_HANDLER void _nested_job_tree_node_worker(void* arg)
+{
+    nested_job_tree_node_argument* node_ptr = (nested_job_tree_node_argument*) arg;
+
+    if (node_ptr->depth == NESTED_JOB_TREE_DEPTH)
+    {
+        system_atomics_increment(node_ptr->n_leaves_visited_ptr);
+    }
+    else
+    {
+        /* Fork two children off the same job, then wait for our own sub-job, so that
+         * both nested forks and nested waits get exercised. */
+        nested_job_tree_node_argument children[2];
+        system_thread_pool_job        sub_job = system_thread_pool_create_job();
+
+        for (unsigned int n_child = 0;
+                          n_child < 2;
+                        ++n_child)
+        {
+            children[n_child].depth                = node_ptr->depth + 1;
+            children[n_child].job                  = sub_job;
+            children[n_child].n_leaves_visited_ptr = node_ptr->n_leaves_visited_ptr;
+
+            system_thread_pool_fork_job_task(sub_job,
+                                             THREAD_POOL_TASK_PRIORITY_NORMAL,
+                                             _nested_job_tree_node_worker,
+                                             children + n_child);
+        }
+
+        system_thread_pool_wait_for_job(sub_job);
+        system_thread_pool_release_job (sub_job);
+    }
+}
+
+PRIVATE void _parallel_for_worker(uint32_t range_start,
+                                  uint32_t range_end,
+                                  void*    user_arg)
+{
+    parallel_for_argument* arg_ptr = (parallel_for_argument*) user_arg;
+    double                 sum     = 0.0;
+
+    for (uint32_t n_item = range_start;
+                  n_item < range_end;
+                ++n_item)
+    {
+        arg_ptr->output_data[n_item] = sqrtf(arg_ptr->input_data[n_item]) * sinf(arg_ptr->input_data[n_item]);
+
+        sum += arg_ptr->input_data[n_item];
+    }
+
+    arg_ptr->partial_sums[range_start / PARALLEL_FOR_GRAIN_SIZE] = sum;
+}
+
+THREAD_POOL_TASK_HANDLER void _utilization_worker(void* arg)
+{
+    const __uint64 start_time_usec = system_time_now_usec();
+
+    while (system_time_now_usec() - start_time_usec < UTILIZATION_TASK_DURATION_USEC)
+    {
+        /* Spin */
+    }
+}
+
 
 /****************************** TESTS ***********************************/
 TEST(ThreadPoolTest, FewSimpleTasksSubmittedSeparately)
@@ -318,3 +496,444 @@ TEST(ThreadPoolTest, FewComplexDistributableTasksInGroupTest)
         system_event_release(wait_events[n]);
     }
 }
+
+/* The scheduling mode is picked at thread pool initialization time, so run the benchmark with
+ * EMERALD_THREAD_POOL_WORK_STEALING set to 0 and to 1 to compare the two modes. */
+TEST(ThreadPoolTest, DISABLED_TaskThroughputWithMultipleProducers)
+{
+    unsigned int  n_workers            = 0;
+    system_event* producer_wait_events = NULL;
+    bool          uses_work_stealing   = false;
+
+    system_thread_pool_get_property(SYSTEM_THREAD_POOL_PROPERTY_N_WORKERS,
+                                   &n_workers);
+    system_thread_pool_get_property(SYSTEM_THREAD_POOL_PROPERTY_USES_WORK_STEALING,
+                                   &uses_work_stealing);
+
+    producer_wait_events = new system_event[n_workers];
+
+    for (unsigned int n_producers = 1;
+                      n_producers <= n_workers;
+                    ++n_producers)
+    {
+        throughput_benchmark_data data;
+        uint32_t                  duration_msec         = 0;
+        system_time               start_time;
+
+        data.done_event       = system_event_create(true); /* manual_reset */
+        data.n_tasks_executed = 0;
+        data.n_tasks_total    = n_producers * THROUGHPUT_BENCHMARK_N_TASKS_PER_PRODUCER;
+        data.start_event      = system_event_create(true); /* manual_reset */
+
+        for (unsigned int n_producer = 0;
+                          n_producer < n_producers;
+                        ++n_producer)
+        {
+            system_threads_spawn(_throughput_benchmark_producer_thread,
+                                &data,
+                                 producer_wait_events + n_producer,
+                                 system_hashed_ansi_string_create("TP producer") );
+        }
+
+        /* go */
+        start_time = system_time_now();
+
+        system_event_set        (data.start_event);
+        system_event_wait_single(data.done_event);
+
+        system_time_get_msec_for_time(system_time_now() - start_time,
+                                     &duration_msec);
+
+        system_event_wait_multiple(producer_wait_events,
+                                   n_producers,
+                                   true, /* wait_on_all_objects */
+                                   SYSTEM_TIME_INFINITE,
+                                   NULL); /* out_result_ptr */
+
+        ASSERT_EQ(data.n_tasks_executed,
+                  data.n_tasks_total);
+
+        printf("[%s, %d producer(s)]: %d tasks in %d ms (%.0f tasks/sec)\n",
+               uses_work_stealing ? "work stealing" : "shared queue",
+               n_producers,
+               data.n_tasks_total,
+               duration_msec,
+               (duration_msec != 0) ? double(data.n_tasks_total) * 1000.0 / double(duration_msec)
+                                    : 0.0);
+
+        /* clean up */
+        for (unsigned int n_producer = 0;
+                          n_producer < n_producers;
+                        ++n_producer)
+        {
+            system_event_release(producer_wait_events[n_producer]);
+        }
+
+        system_event_release(data.done_event);
+        system_event_release(data.start_event);
+    }
+
+    delete [] producer_wait_events;
+}
+
+TEST(ThreadPoolTest, JobWaitersDoNotExecuteUnrelatedTasks)
+{
+    job_isolation_argument arg;
+    system_thread_pool_job job       = NULL;
+    unsigned int           n_workers = 0;
+
+    system_thread_pool_get_property(SYSTEM_THREAD_POOL_PROPERTY_N_WORKERS,
+                                   &n_workers);
+
+    arg.gate_event                = system_event_create(true); /* manual_reset */
+    arg.job_task_thread_id        = 0;
+    arg.n_blocking_tasks_started  = 0;
+    arg.unrelated_task_done_event = system_event_create(true); /* manual_reset */
+    arg.unrelated_task_thread_id  = 0;
+
+    /* Keep all the workers busy, so that the tasks submitted below stay queued */
+    for (unsigned int n_worker = 0;
+                      n_worker < n_workers;
+                    ++n_worker)
+    {
+        system_thread_pool_task task = system_thread_pool_create_task_handler_only(THREAD_POOL_TASK_PRIORITY_NORMAL,
+                                                                                   _job_isolation_blocking_worker,
+                                                                                  &arg);
+
+        system_thread_pool_submit_single_task(task);
+    }
+
+    while (system_atomics_load_acquire(&arg.n_blocking_tasks_started) != n_workers)
+    {
+        system_threads_yield();
+    }
+
+    /* The unrelated task has a higher priority, so a thread helping out with anything would pick it up first */
+    system_thread_pool_submit_single_task(system_thread_pool_create_task_handler_with_event_signal(THREAD_POOL_TASK_PRIORITY_CRITICAL,
+                                                                                                   _job_isolation_unrelated_task_worker,
+                                                                                                  &arg,
+                                                                                                   arg.unrelated_task_done_event) );
+
+    job = system_thread_pool_create_job();
+
+    system_thread_pool_fork_job_task(job,
+                                     THREAD_POOL_TASK_PRIORITY_NORMAL,
+                                     _job_isolation_job_task_worker,
+                                    &arg);
+
+    system_thread_pool_wait_for_job(job);
+    system_thread_pool_release_job (job);
+
+    system_event_set        (arg.gate_event);
+    system_event_wait_single(arg.unrelated_task_done_event);
+
+    /* The workers are all blocked, so the waiting thread has executed the job's task itself */
+    ASSERT_EQ(arg.job_task_thread_id,
+              system_threads_get_thread_id() );
+    ASSERT_NE(arg.unrelated_task_thread_id,
+              system_threads_get_thread_id() );
+
+    /* clean up */
+    system_event_release(arg.gate_event);
+    system_event_release(arg.unrelated_task_done_event);
+}
+
+TEST(ThreadPoolTest, MultipleThreadsWaitForJob)
+{
+    multiple_waiters_argument arg;
+    bool                      has_timed_out = false;
+    system_event              waiter_thread_events[MULTIPLE_WAITERS_N_THREADS];
+
+    arg.gate_event = system_event_create(true); /* manual_reset */
+    arg.job        = system_thread_pool_create_job();
+
+    /* The task keeps the job busy until all the waiters have gone to sleep */
+    system_thread_pool_fork_job_task(arg.job,
+                                     THREAD_POOL_TASK_PRIORITY_NORMAL,
+                                     _multiple_waiters_task_worker,
+                                    &arg);
+
+    for (unsigned int n_thread = 0;
+                      n_thread < MULTIPLE_WAITERS_N_THREADS;
+                    ++n_thread)
+    {
+        system_threads_spawn(_multiple_waiters_waiter_thread,
+                            &arg,
+                             waiter_thread_events + n_thread,
+                             system_hashed_ansi_string_create("TP job waiter") );
+    }
+
+#ifdef _WIN32
+    ::Sleep(100);
+#else
+    usleep(100 * 1000);
+#endif
+
+    system_event_set               (arg.gate_event);
+    system_thread_pool_wait_for_job(arg.job);
+
+    /* Every waiter must wake up, not just one of them */
+    system_event_wait_multiple(waiter_thread_events,
+                               MULTIPLE_WAITERS_N_THREADS,
+                               true, /* wait_on_all_objects */
+                               system_time_get_time_for_s(10),
+                              &has_timed_out);
+
+    ASSERT_FALSE(has_timed_out);
+
+    /* clean up */
+    for (unsigned int n_thread = 0;
+                      n_thread < MULTIPLE_WAITERS_N_THREADS;
+                    ++n_thread)
+    {
+        system_event_release(waiter_thread_events[n_thread]);
+    }
+
+    system_thread_pool_release_job(arg.job);
+    system_event_release          (arg.gate_event);
+}
+
+TEST(ThreadPoolTest, NestedForkJoin)
+{
+    volatile unsigned int         n_leaves_visited = 0;
+    nested_job_tree_node_argument root;
+    system_thread_pool_job        job              = system_thread_pool_create_job();
+
+    root.depth                = 0;
+    root.job                  = job;
+    root.n_leaves_visited_ptr = &n_leaves_visited;
+
+    system_thread_pool_fork_job_task(job,
+                                     THREAD_POOL_TASK_PRIORITY_NORMAL,
+                                     _nested_job_tree_node_worker,
+                                    &root);
+
+    system_thread_pool_wait_for_job(job);
+    system_thread_pool_release_job (job);
+
+    ASSERT_EQ(n_leaves_visited,
+              1u << NESTED_JOB_TREE_DEPTH);
+}
+
+TEST(ThreadPoolTest, ParallelFor)
+{
+    const uint32_t        n_chunks     = (PARALLEL_FOR_N_ITEMS + PARALLEL_FOR_GRAIN_SIZE - 1) / PARALLEL_FOR_GRAIN_SIZE;
+    parallel_for_argument arg;
+    float*                input_data   = new float [PARALLEL_FOR_N_ITEMS];
+    float*                output_data  = new float [PARALLEL_FOR_N_ITEMS];
+    double*               partial_sums = new double[n_chunks];
+    double                sum          = 0.0;
+
+    for (uint32_t n_item = 0;
+                  n_item < PARALLEL_FOR_N_ITEMS;
+                ++n_item)
+    {
+        input_data[n_item] = float(n_item % 1024);
+    }
+
+    memset(output_data,
+           0,
+           sizeof(float) * PARALLEL_FOR_N_ITEMS);
+    memset(partial_sums,
+           0,
+           sizeof(double) * n_chunks);
+
+    arg.input_data   = input_data;
+    arg.output_data  = output_data;
+    arg.partial_sums = partial_sums;
+
+    system_thread_pool_parallel_for(0, /* range_start */
+                                    PARALLEL_FOR_N_ITEMS,
+                                    PARALLEL_FOR_GRAIN_SIZE,
+                                    _parallel_for_worker,
+                                   &arg);
+
+    /* verify */
+    for (uint32_t n_chunk = 0;
+                  n_chunk < n_chunks;
+                ++n_chunk)
+    {
+        sum += partial_sums[n_chunk];
+    }
+
+    ASSERT_EQ(sum,
+              double(PARALLEL_FOR_N_ITEMS / 1024) * (1023.0 * 1024.0 / 2.0) );
+
+    for (uint32_t n_item = 0;
+                  n_item < PARALLEL_FOR_N_ITEMS;
+                ++n_item)
+    {
+        ASSERT_EQ(output_data[n_item],
+                  sqrtf(input_data[n_item]) * sinf(input_data[n_item]) );
+    }
+
+    /* clean up */
+    delete [] input_data;
+    delete [] output_data;
+    delete [] partial_sums;
+}
+
+TEST(ThreadPoolTest, WorkerUtilizationCounters)
+{
+    __uint64     busy_time_usec_after      = 0;
+    __uint64     busy_time_usec_before     = 0;
+    unsigned int n_orders_executed_after   = 0;
+    unsigned int n_orders_executed_before  = 0;
+    unsigned int n_workers                 = 0;
+    system_event wait_events[UTILIZATION_N_TASKS];
+
+    system_thread_pool_get_property(SYSTEM_THREAD_POOL_PROPERTY_N_WORKERS,
+                                   &n_workers);
+
+    ASSERT_GE(n_workers,
+              1u);
+
+    for (unsigned int n_worker = 0;
+                      n_worker < n_workers;
+                    ++n_worker)
+    {
+        __uint64     busy_time_usec    = 0;
+        unsigned int n_orders_executed = 0;
+
+        system_thread_pool_get_worker_property(n_worker,
+                                               SYSTEM_THREAD_POOL_WORKER_PROPERTY_BUSY_TIME_USEC,
+                                              &busy_time_usec);
+        system_thread_pool_get_worker_property(n_worker,
+                                               SYSTEM_THREAD_POOL_WORKER_PROPERTY_N_ORDERS_EXECUTED,
+                                              &n_orders_executed);
+
+        busy_time_usec_before    += busy_time_usec;
+        n_orders_executed_before += n_orders_executed;
+    }
+
+    /* Submit tasks which keep the workers busy for a known period of time */
+    for (unsigned int n_task = 0;
+                      n_task < UTILIZATION_N_TASKS;
+                    ++n_task)
+    {
+        wait_events[n_task] = system_event_create(true) ; /* manual_reset */
+
+        system_thread_pool_task task = system_thread_pool_create_task_handler_with_event_signal(THREAD_POOL_TASK_PRIORITY_NORMAL,
+                                                                                                _utilization_worker,
+                                                                                                NULL, /* execution_handler_argument */
+                                                                                                wait_events[n_task]);
+
+        system_thread_pool_submit_single_task(task);
+    }
+
+    system_event_wait_multiple(wait_events,
+                               UTILIZATION_N_TASKS,
+                               true, /* wait_on_all_objects */
+                               SYSTEM_TIME_INFINITE,
+                               NULL); /* out_result_ptr */
+
+    /* The event is set before the counters are updated, so give the workers a moment to catch up. */
+    system_time start_time = system_time_now();
+
+    while (n_orders_executed_after - n_orders_executed_before < UTILIZATION_N_TASKS &&
+           system_time_now() - start_time                     < system_time_get_time_for_s(1) )
+    {
+        busy_time_usec_after    = 0;
+        n_orders_executed_after = 0;
+
+        for (unsigned int n_worker = 0;
+                          n_worker < n_workers;
+                        ++n_worker)
+        {
+            __uint64     busy_time_usec    = 0;
+            unsigned int n_orders_executed = 0;
+
+            system_thread_pool_get_worker_property(n_worker,
+                                                   SYSTEM_THREAD_POOL_WORKER_PROPERTY_BUSY_TIME_USEC,
+                                                  &busy_time_usec);
+            system_thread_pool_get_worker_property(n_worker,
+                                                   SYSTEM_THREAD_POOL_WORKER_PROPERTY_N_ORDERS_EXECUTED,
+                                                  &n_orders_executed);
+
+            busy_time_usec_after    += busy_time_usec;
+            n_orders_executed_after += n_orders_executed;
+        }
+    }
+
+    ASSERT_GE(n_orders_executed_after - n_orders_executed_before,
+              (unsigned int) UTILIZATION_N_TASKS);
+    ASSERT_GE(busy_time_usec_after - busy_time_usec_before,
+              (__uint64) (UTILIZATION_N_TASKS * UTILIZATION_TASK_DURATION_USEC) );
+
+    /* clean up */
+    for (unsigned int n_task = 0;
+                      n_task < UTILIZATION_N_TASKS;
+                    ++n_task)
+    {
+        system_event_release(wait_events[n_task]);
+    }
+}
+
+TEST(ThreadPoolTest, DISABLED_ParallelForBenchmark)
+{
+    const uint32_t        n_chunks      = (PARALLEL_FOR_N_ITEMS + PARALLEL_FOR_GRAIN_SIZE - 1) / PARALLEL_FOR_GRAIN_SIZE;
+    parallel_for_argument arg;
+    float*                input_data    = new float [PARALLEL_FOR_N_ITEMS];
+    unsigned int          n_workers     = 0;
+    float*                output_data   = new float [PARALLEL_FOR_N_ITEMS];
+    __uint64              parallel_usec = ~0ull;
+    double*               partial_sums  = new double[n_chunks];
+    __uint64              serial_usec   = ~0ull;
+
+    system_thread_pool_get_property(SYSTEM_THREAD_POOL_PROPERTY_N_WORKERS,
+                                   &n_workers);
+
+    for (uint32_t n_item = 0;
+                  n_item < PARALLEL_FOR_N_ITEMS;
+                ++n_item)
+    {
+        input_data[n_item] = float(n_item % 1024);
+    }
+
+    arg.input_data   = input_data;
+    arg.output_data  = output_data;
+    arg.partial_sums = partial_sums;
+
+    /* Report the best of a few runs, so that the first-touch page faults do not skew the results */
+    for (uint32_t n_run = 0;
+                  n_run < PARALLEL_FOR_BENCHMARK_N_RUNS;
+                ++n_run)
+    {
+        __uint64 start_time = system_time_now_usec();
+        {
+            for (uint32_t n_chunk = 0;
+                          n_chunk < n_chunks;
+                        ++n_chunk)
+            {
+                _parallel_for_worker(n_chunk * PARALLEL_FOR_GRAIN_SIZE,
+                                     (n_chunk + 1) * PARALLEL_FOR_GRAIN_SIZE,
+                                    &arg);
+            }
+        }
+        serial_usec = std::min(serial_usec,
+                               system_time_now_usec() - start_time);
+
+        start_time = system_time_now_usec();
+        {
+            system_thread_pool_parallel_for(0, /* range_start */
+                                            PARALLEL_FOR_N_ITEMS,
+                                            PARALLEL_FOR_GRAIN_SIZE,
+                                            _parallel_for_worker,
+                                           &arg);
+        }
+        parallel_usec = std::min(parallel_usec,
+                                 system_time_now_usec() - start_time);
+    }
+
+    printf("Parallel-for over %d items, %d worker(s): serial %.2f ms, parallel %.2f ms (%.2fx)\n",
+           PARALLEL_FOR_N_ITEMS,
+           n_workers,
+           double(serial_usec)   / 1000.0,
+           double(parallel_usec) / 1000.0,
+           double(serial_usec)   / double(parallel_usec) );
+
+    /* clean up */
+    delete [] input_data;
+    delete [] output_data;
+    delete [] partial_sums;
+}